@@ -0,0 +1,15 @@
+#ifndef BATCH_BENCH_H
+#define BATCH_BENCH_H
+
+/* This generated file contains includes for project dependencies */
+#include "batch_bench/bake_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+#include <batch_bench.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Compares batch() callbacks against each() callbacks. Every case adds the
+ * velocity of an entity to its position. The each() callback is invoked once
+ * per entity, the batch() callbacks once per table (or per range of entities
+ * for tables with shared components). Each measurement iterates the query
+ * multiple times, is repeated and the fastest run is reported. */
+
+#define ENTITIES_PER_MEASUREMENT (1 << 24)
+#define TRIAL_COUNT (5)
+
+struct Position {
+    float x, y;
+};
+
+struct Velocity {
+    float x, y;
+};
+
+/* Measure a callback, returns the fastest run in nanoseconds per entity */
+template <typename Func>
+static double measure(int32_t count, const Func& func) {
+    int32_t i, t, iterations = ENTITIES_PER_MEASUREMENT / count;
+    if (!iterations) {
+        iterations = 1;
+    }
+
+    double best = 0;
+    for (t = 0; t < TRIAL_COUNT; t ++) {
+        ecs_time_t start = {0, 0};
+        ecs_time_measure(&start);
+        for (i = 0; i < iterations; i ++) {
+            func();
+        }
+        double elapsed = ecs_time_measure(&start);
+        if (!t || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return best * 1000.0 * 1000.0 * 1000.0 /
+        (static_cast<double>(count) * iterations);
+}
+
+static void print_result(
+    const char *name, int32_t count, double each_ns, double batch_ns)
+{
+    printf("%-16s %9d %10.3f %10.3f %7.2fx\n",
+        name, count, each_ns, batch_ns, each_ns / batch_ns);
+    fflush(stdout);
+}
+
+/* Entities own both components */
+static void bench_owned(int32_t count) {
+    flecs::world ecs;
+
+    for (int32_t i = 0; i < count; i ++) {
+        ecs.entity()
+            .set<Position>({static_cast<float>(i), 0})
+            .set<Velocity>({1, 2});
+    }
+
+    auto q = ecs.query<Position, const Velocity>();
+
+    double each_ns = measure(count, [&]() {
+        q.each([](Position& p, const Velocity& v) {
+            p.x += v.x;
+            p.y += v.y;
+        });
+    });
+
+    double batch_ns = measure(count, [&]() {
+        q.batch([](size_t n, Position *p, const Velocity *v) {
+            for (size_t i = 0; i < n; i ++) {
+                p[i].x += v[i].x;
+                p[i].y += v[i].y;
+            }
+        });
+    });
+
+    double lanes_ns = measure(count, [&]() {
+        q.batch([](size_t n, Position *p, const Velocity *v) {
+            const size_t N = flecs::lanes<float>::value;
+            size_t i = 0;
+            for (; i + N <= n; i += N) {
+                float x[N], y[N], vx[N], vy[N];
+                flecs::load_lanes(x, &p[i], &Position::x);
+                flecs::load_lanes(y, &p[i], &Position::y);
+                flecs::load_lanes(vx, &v[i], &Velocity::x);
+                flecs::load_lanes(vy, &v[i], &Velocity::y);
+                for (size_t l = 0; l < N; l ++) {
+                    x[l] += vx[l];
+                    y[l] += vy[l];
+                }
+                flecs::store_lanes(&p[i], &Position::x, x);
+                flecs::store_lanes(&p[i], &Position::y, y);
+            }
+            for (; i < n; i ++) {
+                p[i].x += v[i].x;
+                p[i].y += v[i].y;
+            }
+        });
+    });
+
+    print_result("owned", count, each_ns, batch_ns);
+    print_result("owned lanes", count, each_ns, lanes_ns);
+}
+
+/* Entities inherit Velocity from a base */
+static void bench_shared(int32_t count) {
+    flecs::world ecs;
+
+    auto base = ecs.entity().set<Velocity>({1, 2});
+
+    for (int32_t i = 0; i < count; i ++) {
+        ecs.entity()
+            .set<Position>({static_cast<float>(i), 0})
+            .is_a(base);
+    }
+
+    auto q = ecs.query_builder<Position, const Velocity>()
+        .arg(2).set(flecs::Self | flecs::SuperSet)
+        .build();
+
+    double each_ns = measure(count, [&]() {
+        q.each([](Position& p, const Velocity& v) {
+            p.x += v.x;
+            p.y += v.y;
+        });
+    });
+
+    double batch_ns = measure(count, [&]() {
+        q.batch([](size_t n, Position *p, const Velocity *v) {
+            for (size_t i = 0; i < n; i ++) {
+                p[i].x += v[i].x;
+                p[i].y += v[i].y;
+            }
+        });
+    });
+
+    print_result("shared", count, each_ns, batch_ns);
+}
+
+int main(int argc, char *argv[]) {
+    int32_t max_count = 1 << 20;
+    if (argc > 1) {
+        max_count = atoi(argv[1]);
+        if (max_count < 1) {
+            fprintf(stderr, "usage: %s [max_count]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    printf("%-16s %9s %10s %10s %8s\n",
+        "case", "entities", "each ns", "batch ns", "speedup");
+
+    for (int32_t count = 16; count <= max_count; count *= 16) {
+        bench_owned(count);
+        bench_shared(count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef MAP_BENCH_H
+#define MAP_BENCH_H
+
+/* This generated file contains includes for project dependencies */
+#include "map_bench/bake_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Map implementation that was used before ecs_map_t switched to open
+ * addressing. Each bucket stores a separately allocated array of keys and an
+ * array of payloads. Kept only so the benchmark can compare against it. */
+
+typedef struct bucket_t {
+    ecs_map_key_t *keys;    /* Array with keys */
+    void *payload;          /* Payload array */
+    int32_t count;          /* Number of elements in bucket */
+} bucket_t;
+
+typedef struct bucket_map_t {
+    bucket_t *buckets;
+    int16_t elem_size;
+    uint8_t bucket_shift;
+    int32_t bucket_count;
+    int32_t count;
+} bucket_map_t;
+
+typedef struct bucket_map_iter_t {
+    const bucket_map_t *map;
+    bucket_t *bucket;
+    int32_t bucket_index;
+    int32_t element_index;
+} bucket_map_iter_t;
+
+void bucket_map_init(
+    bucket_map_t *map,
+    ecs_size_t elem_size,
+    int32_t elem_count);
+
+void bucket_map_fini(
+    bucket_map_t *map);
+
+void* bucket_map_get(
+    const bucket_map_t *map,
+    ecs_map_key_t key);
+
+void* bucket_map_set(
+    bucket_map_t *map,
+    ecs_map_key_t key,
+    const void *payload);
+
+int32_t bucket_map_remove(
+    bucket_map_t *map,
+    ecs_map_key_t key);
+
+bucket_map_iter_t bucket_map_iter(
+    const bucket_map_t *map);
+
+void* bucket_map_next(
+    bucket_map_iter_t *iter,
+    ecs_map_key_t *key_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,360 @@
+#include <map_bench.h>
+
+/* Copy of the bucket map implementation that ecs_map_t used before it was
+ * replaced with an open addressing map. Only the operations exercised by the
+ * benchmark are included. */
+
+/* The ratio used to determine whether the map should rehash. If
+ * (element_count * LOAD_FACTOR) > bucket_count, bucket count is increased. */
+#define LOAD_FACTOR (1.5f)
+#define KEY_SIZE (ECS_SIZEOF(ecs_map_key_t))
+#define GET_ELEM(array, elem_size, index) \
+    ECS_OFFSET(array, (elem_size) * (index))
+
+static
+int32_t next_pow_of_2(
+    int32_t n)
+{
+    n --;
+    n |= n >> 1;
+    n |= n >> 2;
+    n |= n >> 4;
+    n |= n >> 8;
+    n |= n >> 16;
+    n ++;
+
+    return n;
+}
+
+static
+uint8_t bucket_log2(uint32_t v) {
+    static const uint8_t log2table[32] =
+        {0, 9,  1,  10, 13, 21, 2,  29, 11, 14, 16, 18, 22, 25, 3, 30,
+         8, 12, 20, 28, 15, 17, 24, 7,  19, 27, 23, 6,  26, 5,  4, 31};
+
+    v |= v >> 1;
+    v |= v >> 2;
+    v |= v >> 4;
+    v |= v >> 8;
+    v |= v >> 16;
+    return log2table[(uint32_t)(v * 0x07C4ACDDU) >> 27];
+}
+
+/* Get bucket count for number of elements */
+static
+int32_t get_bucket_count(
+    int32_t element_count)
+{
+    return next_pow_of_2((int32_t)((float)element_count * LOAD_FACTOR));
+}
+
+/* Get bucket shift amount for a given bucket count */
+static
+uint8_t get_bucket_shift (
+    int32_t bucket_count)
+{
+    return (uint8_t)(64u - bucket_log2((uint32_t)bucket_count));
+}
+
+/* Get bucket index for provided map key */
+static
+int32_t get_bucket_index(
+    uint16_t bucket_shift,
+    ecs_map_key_t key)
+{
+    return (int32_t)((11400714819323198485ull * key) >> bucket_shift);
+}
+
+/* Get bucket for key */
+static
+bucket_t* get_bucket(
+    const bucket_map_t *map,
+    ecs_map_key_t key)
+{
+    int32_t bucket_id = get_bucket_index(map->bucket_shift, key);
+    return &map->buckets[bucket_id];
+}
+
+/* Ensure that map has at least new_count buckets */
+static
+void ensure_buckets(
+    bucket_map_t *map,
+    int32_t new_count)
+{
+    int32_t bucket_count = map->bucket_count;
+    new_count = next_pow_of_2(new_count);
+    if (new_count < 2) {
+        new_count = 2;
+    }
+
+    if (new_count && new_count > bucket_count) {
+        map->buckets = ecs_os_realloc(
+            map->buckets, new_count * ECS_SIZEOF(bucket_t));
+        map->bucket_count = new_count;
+        map->bucket_shift = get_bucket_shift(new_count);
+        ecs_os_memset(
+            ECS_OFFSET(map->buckets, bucket_count * ECS_SIZEOF(bucket_t)),
+            0, (new_count - bucket_count) * ECS_SIZEOF(bucket_t));
+    }
+}
+
+/* Free contents of bucket */
+static
+void clear_bucket(
+    bucket_t *bucket)
+{
+    ecs_os_free(bucket->keys);
+    ecs_os_free(bucket->payload);
+    bucket->keys = NULL;
+    bucket->payload = NULL;
+    bucket->count = 0;
+}
+
+/* Clear all buckets */
+static
+void clear_buckets(
+    bucket_map_t *map)
+{
+    bucket_t *buckets = map->buckets;
+    int32_t i, count = map->bucket_count;
+    for (i = 0; i < count; i ++) {
+        clear_bucket(&buckets[i]);
+    }
+    ecs_os_free(buckets);
+    map->buckets = NULL;
+    map->bucket_count = 0;
+}
+
+/* Add element to bucket */
+static
+int32_t add_to_bucket(
+    bucket_t *bucket,
+    ecs_size_t elem_size,
+    ecs_map_key_t key,
+    const void *payload)
+{
+    int32_t index = bucket->count ++;
+    int32_t bucket_count = index + 1;
+
+    bucket->keys = ecs_os_realloc(bucket->keys, KEY_SIZE * bucket_count);
+    bucket->keys[index] = key;
+
+    if (elem_size) {
+        bucket->payload = ecs_os_realloc(
+            bucket->payload, elem_size * bucket_count);
+        if (payload) {
+            void *elem = GET_ELEM(bucket->payload, elem_size, index);
+            ecs_os_memcpy(elem, payload, elem_size);
+        }
+    } else {
+        bucket->payload = NULL;
+    }
+
+    return index;
+}
+
+/*  Remove element from bucket */
+static
+void remove_from_bucket(
+    bucket_t *bucket,
+    ecs_size_t elem_size,
+    int32_t index)
+{
+    int32_t bucket_count = -- bucket->count;
+
+    if (index != bucket->count) {
+        bucket->keys[index] = bucket->keys[bucket_count];
+
+        void *elem = GET_ELEM(bucket->payload, elem_size, index);
+        void *last_elem = GET_ELEM(bucket->payload, elem_size, bucket->count);
+
+        ecs_os_memcpy(elem, last_elem, elem_size);
+    }
+}
+
+/* Get payload pointer for key from bucket */
+static
+void* get_from_bucket(
+    bucket_t *bucket,
+    ecs_map_key_t key,
+    ecs_size_t elem_size)
+{
+    ecs_map_key_t *keys = bucket->keys;
+    int32_t i, count = bucket->count;
+
+    for (i = 0; i < count; i ++) {
+        if (keys[i] == key) {
+            return GET_ELEM(bucket->payload, elem_size, i);
+        }
+    }
+    return NULL;
+}
+
+/* Grow number of buckets */
+static
+void rehash(
+    bucket_map_t *map,
+    int32_t bucket_count)
+{
+    ensure_buckets(map, bucket_count);
+
+    bucket_t *buckets = map->buckets;
+    ecs_size_t elem_size = map->elem_size;
+    uint16_t bucket_shift = map->bucket_shift;
+    int32_t bucket_id;
+
+    /* Iterate backwards as elements could otherwise be moved to existing
+     * buckets which could temporarily cause the number of elements in a
+     * bucket to exceed BUCKET_COUNT. */
+    for (bucket_id = bucket_count - 1; bucket_id >= 0; bucket_id --) {
+        bucket_t *bucket = &buckets[bucket_id];
+
+        int i, count = bucket->count;
+        ecs_map_key_t *key_array = bucket->keys;
+        void *payload_array = bucket->payload;
+
+        for (i = 0; i < count; i ++) {
+            ecs_map_key_t key = key_array[i];
+            void *elem = GET_ELEM(payload_array, elem_size, i);
+            int32_t new_bucket_id = get_bucket_index(bucket_shift, key);
+
+            if (new_bucket_id != bucket_id) {
+                bucket_t *new_bucket = &buckets[new_bucket_id];
+
+                add_to_bucket(new_bucket, elem_size, key, elem);
+                remove_from_bucket(bucket, elem_size, i);
+
+                count --;
+                i --;
+            }
+        }
+
+        if (!bucket->count) {
+            clear_bucket(bucket);
+        }
+    }
+}
+
+void bucket_map_init(
+    bucket_map_t *result,
+    ecs_size_t elem_size,
+    int32_t element_count)
+{
+    result->buckets = NULL;
+    result->bucket_count = 0;
+    result->count = 0;
+    result->elem_size = (int16_t)elem_size;
+
+    ensure_buckets(result, get_bucket_count(element_count));
+}
+
+void bucket_map_fini(
+    bucket_map_t *map)
+{
+    clear_buckets(map);
+}
+
+void* bucket_map_get(
+    const bucket_map_t *map,
+    ecs_map_key_t key)
+{
+    bucket_t *bucket = get_bucket(map, key);
+    return get_from_bucket(bucket, key, map->elem_size);
+}
+
+void* bucket_map_set(
+    bucket_map_t *map,
+    ecs_map_key_t key,
+    const void *payload)
+{
+    ecs_size_t elem_size = map->elem_size;
+    bucket_t *bucket = get_bucket(map, key);
+
+    void *elem = get_from_bucket(bucket, key, elem_size);
+    if (!elem) {
+        int32_t index = add_to_bucket(bucket, elem_size, key, payload);
+        int32_t map_count = ++map->count;
+        int32_t target_bucket_count = get_bucket_count(map_count);
+        int32_t map_bucket_count = map->bucket_count;
+
+        if (target_bucket_count > map_bucket_count) {
+            rehash(map, target_bucket_count);
+            bucket = get_bucket(map, key);
+            return get_from_bucket(bucket, key, elem_size);
+        } else {
+            return GET_ELEM(bucket->payload, elem_size, index);
+        }
+    } else {
+        if (payload) {
+            ecs_os_memcpy(elem, payload, elem_size);
+        }
+        return elem;
+    }
+}
+
+int32_t bucket_map_remove(
+    bucket_map_t *map,
+    ecs_map_key_t key)
+{
+    bucket_t *bucket = get_bucket(map, key);
+
+    int32_t i, bucket_count = bucket->count;
+    for (i = 0; i < bucket_count; i ++) {
+        if (bucket->keys[i] == key) {
+            remove_from_bucket(bucket, map->elem_size, i);
+            return --map->count;
+        }
+    }
+
+    return map->count;
+}
+
+bucket_map_iter_t bucket_map_iter(
+    const bucket_map_t *map)
+{
+    return (bucket_map_iter_t){
+        .map = map,
+        .bucket = NULL,
+        .bucket_index = 0,
+        .element_index = 0
+    };
+}
+
+void* bucket_map_next(
+    bucket_map_iter_t *iter,
+    ecs_map_key_t *key_out)
+{
+    const bucket_map_t *map = iter->map;
+    bucket_t *bucket = iter->bucket;
+    int32_t element_index = iter->element_index;
+
+    do {
+        if (!bucket) {
+            int32_t bucket_index = iter->bucket_index;
+            bucket_t *buckets = map->buckets;
+            if (bucket_index < map->bucket_count) {
+                bucket = &buckets[bucket_index];
+                iter->bucket = bucket;
+
+                element_index = 0;
+                iter->element_index = 0;
+            } else {
+                return NULL;
+            }
+        }
+
+        if (element_index < bucket->count) {
+            iter->element_index = element_index + 1;
+            break;
+        } else {
+            bucket = NULL;
+            iter->bucket_index ++;
+        }
+    } while (true);
+
+    if (key_out) {
+        *key_out = bucket->keys[element_index];
+    }
+
+    return GET_ELEM(bucket->payload, map->elem_size, element_index);
+}
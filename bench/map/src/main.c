@@ -0,0 +1,304 @@
+#include <map_bench.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Compares ecs_map_t against the bucket map it replaced. For each map size and
+ * key distribution the benchmark measures inserting keys into an empty map,
+ * looking up existing and missing keys, iterating and removing all keys.
+ * Operations are repeated on small maps so that every measurement performs
+ * roughly the same number of operations. Each measurement is repeated and the
+ * fastest run is reported. */
+
+#define OPS_PER_MEASUREMENT (1 << 20)
+#define TRIAL_COUNT (3)
+
+typedef enum op_kind_t {
+    OpInsert,
+    OpLookup,
+    OpLookupMissing,
+    OpIterate,
+    OpRemove,
+    OpCount
+} op_kind_t;
+
+static const char *op_names[] = {
+    "insert", "lookup", "lookup miss", "iterate", "remove"
+};
+
+static uint64_t sink;
+
+static
+uint64_t rnd_next(
+    uint64_t *state)
+{
+    /* splitmix64 */
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static
+void shuffle(
+    uint64_t *keys,
+    int32_t count,
+    uint64_t *state)
+{
+    int32_t i;
+    for (i = count - 1; i > 0; i --) {
+        int32_t j = (int32_t)(rnd_next(state) % (uint64_t)(i + 1));
+        uint64_t tmp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+/* Fill keys with either sequential ids (like entity ids) or random 64 bit
+ * values (like pair ids or hashes). The missing array contains keys that are
+ * not in the map. The lookup array contains the keys in a different order. */
+static
+void make_keys(
+    bool random,
+    int32_t count,
+    uint64_t *keys,
+    uint64_t *missing,
+    uint64_t *lookup)
+{
+    uint64_t state = 12345;
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        if (random) {
+            keys[i] = rnd_next(&state) | 1;
+            missing[i] = keys[i] ^ 1;
+        } else {
+            keys[i] = (uint64_t)i + 1;
+            missing[i] = (uint64_t)(i + count) + 1;
+        }
+        lookup[i] = keys[i];
+    }
+
+    shuffle(lookup, count, &state);
+}
+
+static
+double run_ecs_map(
+    op_kind_t op,
+    int32_t count,
+    int32_t rounds,
+    const uint64_t *keys,
+    const uint64_t *missing,
+    const uint64_t *lookup)
+{
+    ecs_time_t t = {0};
+    double elapsed = 0;
+    uint64_t sum = 0;
+    int32_t r, i;
+
+    if (op == OpInsert || op == OpRemove) {
+        /* Operations that modify the map start from a new map each round */
+        for (r = 0; r < rounds; r ++) {
+            ecs_map_t map;
+            ecs_map_init(&map, uint64_t, 0);
+
+            if (op == OpInsert) {
+                ecs_time_measure(&t);
+            }
+
+            for (i = 0; i < count; i ++) {
+                ecs_map_set(&map, keys[i], &keys[i]);
+            }
+
+            if (op == OpRemove) {
+                ecs_time_measure(&t);
+                for (i = 0; i < count; i ++) {
+                    sum += (uint64_t)ecs_map_remove(&map, lookup[i]);
+                }
+            }
+
+            elapsed += ecs_time_measure(&t);
+            ecs_map_fini(&map);
+        }
+    } else {
+        ecs_map_t map;
+        ecs_map_init(&map, uint64_t, 0);
+        for (i = 0; i < count; i ++) {
+            ecs_map_set(&map, keys[i], &keys[i]);
+        }
+
+        ecs_time_measure(&t);
+        for (r = 0; r < rounds; r ++) {
+            if (op == OpLookup) {
+                for (i = 0; i < count; i ++) {
+                    sum += *ecs_map_get(&map, uint64_t, lookup[i]);
+                }
+            } else if (op == OpLookupMissing) {
+                for (i = 0; i < count; i ++) {
+                    sum += ecs_map_get(&map, uint64_t, missing[i]) != NULL;
+                }
+            } else {
+                ecs_map_iter_t it = ecs_map_iter(&map);
+                uint64_t *v;
+                while ((v = ecs_map_next(&it, uint64_t, NULL))) {
+                    sum += *v;
+                }
+            }
+        }
+        elapsed = ecs_time_measure(&t);
+
+        ecs_map_fini(&map);
+    }
+
+    sink += sum;
+    return elapsed;
+}
+
+static
+double run_bucket_map(
+    op_kind_t op,
+    int32_t count,
+    int32_t rounds,
+    const uint64_t *keys,
+    const uint64_t *missing,
+    const uint64_t *lookup)
+{
+    ecs_time_t t = {0};
+    double elapsed = 0;
+    uint64_t sum = 0;
+    int32_t r, i;
+
+    if (op == OpInsert || op == OpRemove) {
+        /* Operations that modify the map start from a new map each round */
+        for (r = 0; r < rounds; r ++) {
+            bucket_map_t map;
+            bucket_map_init(&map, ECS_SIZEOF(uint64_t), 0);
+
+            if (op == OpInsert) {
+                ecs_time_measure(&t);
+            }
+
+            for (i = 0; i < count; i ++) {
+                bucket_map_set(&map, keys[i], &keys[i]);
+            }
+
+            if (op == OpRemove) {
+                ecs_time_measure(&t);
+                for (i = 0; i < count; i ++) {
+                    sum += (uint64_t)bucket_map_remove(&map, lookup[i]);
+                }
+            }
+
+            elapsed += ecs_time_measure(&t);
+            bucket_map_fini(&map);
+        }
+    } else {
+        bucket_map_t map;
+        bucket_map_init(&map, ECS_SIZEOF(uint64_t), 0);
+        for (i = 0; i < count; i ++) {
+            bucket_map_set(&map, keys[i], &keys[i]);
+        }
+
+        ecs_time_measure(&t);
+        for (r = 0; r < rounds; r ++) {
+            if (op == OpLookup) {
+                for (i = 0; i < count; i ++) {
+                    sum += *(uint64_t*)bucket_map_get(&map, lookup[i]);
+                }
+            } else if (op == OpLookupMissing) {
+                for (i = 0; i < count; i ++) {
+                    sum += bucket_map_get(&map, missing[i]) != NULL;
+                }
+            } else {
+                bucket_map_iter_t it = bucket_map_iter(&map);
+                uint64_t *v;
+                while ((v = bucket_map_next(&it, NULL))) {
+                    sum += *v;
+                }
+            }
+        }
+        elapsed = ecs_time_measure(&t);
+
+        bucket_map_fini(&map);
+    }
+
+    sink += sum;
+    return elapsed;
+}
+
+/* Returns the fastest time per operation in nanoseconds */
+static
+double measure(
+    bool bucket_map,
+    op_kind_t op,
+    int32_t count,
+    const uint64_t *keys,
+    const uint64_t *missing,
+    const uint64_t *lookup)
+{
+    int32_t rounds = ECS_MAX(OPS_PER_MEASUREMENT / count, 1);
+    double best = 0;
+    int32_t i;
+
+    for (i = 0; i < TRIAL_COUNT; i ++) {
+        double elapsed;
+        if (bucket_map) {
+            elapsed = run_bucket_map(op, count, rounds, keys, missing, lookup);
+        } else {
+            elapsed = run_ecs_map(op, count, rounds, keys, missing, lookup);
+        }
+
+        if (!i || elapsed < best) {
+            best = elapsed;
+        }
+    }
+
+    return (best * 1e9) / ((double)rounds * (double)count);
+}
+
+int main(int argc, char *argv[]) {
+    int32_t max_count = 1 << 20;
+    if (argc > 1) {
+        max_count = atoi(argv[1]);
+        if (max_count < 1) {
+            fprintf(stderr, "usage: %s [max_count]\n", argv[0]);
+            return -1;
+        }
+    }
+
+    ecs_os_set_api_defaults();
+
+    uint64_t *keys = ecs_os_malloc_n(uint64_t, max_count);
+    uint64_t *missing = ecs_os_malloc_n(uint64_t, max_count);
+    uint64_t *lookup = ecs_os_malloc_n(uint64_t, max_count);
+
+    printf("%-10s %-12s %8s %12s %12s %8s\n",
+        "keys", "operation", "count", "bucket ns", "ecs_map ns", "speedup");
+
+    int32_t k;
+    for (k = 0; k < 2; k ++) {
+        bool random = k == 1;
+        int32_t count;
+        for (count = 16; count <= max_count; count *= 16) {
+            make_keys(random, count, keys, missing, lookup);
+
+            int32_t op;
+            for (op = 0; op < OpCount; op ++) {
+                double old_ns = measure(
+                    true, (op_kind_t)op, count, keys, missing, lookup);
+                double new_ns = measure(
+                    false, (op_kind_t)op, count, keys, missing, lookup);
+
+                printf("%-10s %-12s %8d %12.2f %12.2f %7.2fx\n",
+                    random ? "random" : "sequential", op_names[op], count,
+                    old_ns, new_ns, old_ns / new_ns);
+                fflush(stdout);
+            }
+        }
+    }
+
+    ecs_os_free(keys);
+    ecs_os_free(missing);
+    ecs_os_free(lookup);
+
+    /* Prevent compiler from optimizing away the lookups */
+    return sink == 42;
+}
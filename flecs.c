@@ -58,6 +58,256 @@ extern "C" {
 
 #endif
 
+/**
+ * @file stack_allocator.h
+ * @brief Data structure used for temporary small allocations.
+ *
+ * The stack allocator hands out memory from a list of fixed size pages. Memory
+ * is not freed per allocation, instead the allocator is reset to a previously
+ * obtained cursor, which releases everything that was allocated after it. 
+ * Pages are kept around after a reset so they can be reused.
+ */
+
+#ifndef FLECS_STACK_ALLOCATOR_H
+#define FLECS_STACK_ALLOCATOR_H
+
+#define ECS_STACK_PAGE_SIZE (4096)
+
+typedef struct ecs_stack_page_t {
+    struct ecs_stack_page_t *next;
+    ecs_size_t size;             /* Usable size of page */
+} ecs_stack_page_t;
+
+typedef struct ecs_stack_cursor_t {
+    ecs_stack_page_t *page;
+    ecs_size_t sp;
+} ecs_stack_cursor_t;
+
+typedef struct ecs_stack_t {
+    ecs_stack_page_t *first;
+    ecs_stack_cursor_t top;
+    int32_t page_count;          /* Number of allocated pages */
+    int32_t alloc_count;         /* Number of allocations served by stack */
+} ecs_stack_t;
+
+void flecs_stack_init(
+    ecs_stack_t *stack);
+
+void flecs_stack_fini(
+    ecs_stack_t *stack);
+
+void* flecs_stack_alloc(
+    ecs_stack_t *stack,
+    ecs_size_t size,
+    ecs_size_t align);
+
+ecs_stack_cursor_t flecs_stack_get_cursor(
+    ecs_stack_t *stack);
+
+void flecs_stack_restore_cursor(
+    ecs_stack_t *stack,
+    ecs_stack_cursor_t cursor);
+
+void flecs_stack_reset(
+    ecs_stack_t *stack);
+
+#endif
+
+/**
+ * @file allocator.h
+ * @brief Pool allocator for datastructures that grow and shrink frequently.
+ *
+ * The block allocator hands out fixed size chunks from blocks that contain
+ * multiple chunks. Freed chunks are added to a free list, and are reused by
+ * the next allocation. Blocks are only released when the allocator is
+ * deinitialized.
+ *
+ * The allocator uses a block allocator for each of a set of size classes. A
+ * request is served from the smallest size class that can hold it, which means
+ * that growing an allocation within its size class doesn't have to move it.
+ * Allocations larger than the largest size class are forwarded to the OS API.
+ *
+ * Allocations must be freed with the size that was used to allocate them. All
+ * functions accept a NULL allocator, in which case memory is allocated with the
+ * OS API, so datastructures can use the same code for both cases.
+ */
+
+#ifndef FLECS_ALLOCATOR_H
+#define FLECS_ALLOCATOR_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of size classes. Classes are 16, 32 and then a power of 2 and 1.5
+ * times a power of 2, up to ECS_ALLOCATOR_MAX_SIZE. */
+#define ECS_ALLOCATOR_CLASS_COUNT (24)
+#define ECS_ALLOCATOR_MAX_SIZE (65536)
+
+/* Target size of a block. Blocks for larger chunks contain a single chunk. */
+#define ECS_BLOCK_ALLOCATOR_BLOCK_SIZE (16384)
+
+typedef struct ecs_block_allocator_chunk_t {
+    struct ecs_block_allocator_chunk_t *next;
+} ecs_block_allocator_chunk_t;
+
+typedef struct ecs_block_allocator_block_t {
+    struct ecs_block_allocator_block_t *next;
+} ecs_block_allocator_block_t;
+
+typedef struct ecs_block_allocator_t {
+    ecs_block_allocator_chunk_t *head;   /* Free list */
+    ecs_block_allocator_block_t *blocks; /* Allocated blocks */
+    ecs_size_t chunk_size;
+    int32_t chunks_per_block;
+    int32_t block_count;                 /* Number of allocated blocks */
+    int32_t alloc_count;                 /* Number of chunks in use */
+} ecs_block_allocator_t;
+
+typedef struct ecs_allocator_t {
+    ecs_block_allocator_t classes[ECS_ALLOCATOR_CLASS_COUNT];
+    int32_t block_count;                 /* Number of allocated blocks */
+    int32_t alloc_count;                 /* Number of allocations served */
+} ecs_allocator_t;
+
+FLECS_DBG_API
+void flecs_ballocator_init(
+    ecs_block_allocator_t *ba,
+    ecs_size_t chunk_size);
+
+FLECS_DBG_API
+void flecs_ballocator_fini(
+    ecs_block_allocator_t *ba);
+
+FLECS_DBG_API
+void* flecs_balloc(
+    ecs_block_allocator_t *ba);
+
+FLECS_DBG_API
+void flecs_bfree(
+    ecs_block_allocator_t *ba,
+    void *ptr);
+
+FLECS_DBG_API
+void flecs_allocator_init(
+    ecs_allocator_t *a);
+
+FLECS_DBG_API
+void flecs_allocator_fini(
+    ecs_allocator_t *a);
+
+FLECS_DBG_API
+void* flecs_alloc(
+    ecs_allocator_t *a,
+    ecs_size_t size);
+
+FLECS_DBG_API
+void* flecs_calloc(
+    ecs_allocator_t *a,
+    ecs_size_t size);
+
+FLECS_DBG_API
+void flecs_free(
+    ecs_allocator_t *a,
+    ecs_size_t size,
+    void *ptr);
+
+/* Resize allocation. Returns the same pointer if both sizes are in the same
+ * size class. */
+FLECS_DBG_API
+void* flecs_realloc(
+    ecs_allocator_t *a,
+    ecs_size_t dst_size,
+    ecs_size_t src_size,
+    void *ptr);
+
+/* Vector operations that allocate from an allocator. A vector created with one
+ * of these functions must only be grown and freed with these functions, using
+ * the same allocator. Operations that don't allocate (get, remove, count) use
+ * the regular vector API. */
+FLECS_DBG_API
+ecs_vector_t* _flecs_vector_new(
+    ecs_allocator_t *a,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_new(a, T, elem_count)\
+    _flecs_vector_new(a, ECS_VECTOR_T(T), elem_count)
+
+#define flecs_vector_new_t(a, size, alignment, elem_count)\
+    _flecs_vector_new(a, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+void _flecs_vector_free(
+    ecs_allocator_t *a,
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define flecs_vector_free_t(a, vector, size, alignment)\
+    _flecs_vector_free(a, vector, ECS_VECTOR_U(size, alignment))
+
+FLECS_DBG_API
+void* _flecs_vector_add(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define flecs_vector_add_t(a, vector, size, alignment)\
+    _flecs_vector_add(a, vector, ECS_VECTOR_U(size, alignment))
+
+FLECS_DBG_API
+void* _flecs_vector_addn(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_addn_t(a, vector, size, alignment, elem_count)\
+    _flecs_vector_addn(a, vector, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+int32_t _flecs_vector_set_size(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_set_size_t(a, vector, size, alignment, elem_count)\
+    _flecs_vector_set_size(a, vector, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+int32_t _flecs_vector_set_count(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_set_count_t(a, vector, size, alignment, elem_count)\
+    _flecs_vector_set_count(a, vector, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+ecs_vector_t* _flecs_vector_copy(
+    ecs_allocator_t *a,
+    const ecs_vector_t *src,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define flecs_vector_copy_t(a, src, size, alignment)\
+    _flecs_vector_copy(a, src, ECS_VECTOR_U(size, alignment))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
 /**
  * @file bitset.h
  * @brief Bitset datastructure.
@@ -283,6 +533,25 @@ extern "C" {
 #define ECS_MAX_JOBS_PER_WORKER (16)
 #define ECS_MAX_ADD_REMOVE (32)
 
+/* Max number of out of order rows for which a sorted query table is fixed up
+ * with an insertion sort instead of a quicksort */
+#define ECS_SORT_INSERTION_THRESHOLD (16)
+
+/* Min number of rows for which a table is sorted with a radix sort when
+ * ordering by a primitive value */
+#define ECS_SORT_RADIX_THRESHOLD (64)
+
+/* When rows of a sorted query table changed, the changed rows are merged into
+ * the unchanged rows if at most 1 / ECS_SORT_MERGE_RATIO rows changed. 
+ * Otherwise the table is sorted again. */
+#define ECS_SORT_MERGE_RATIO (8)
+
+/* Max number of filters for which matched tables are cached by the world */
+#define ECS_FILTER_CACHE_SIZE (64)
+
+/* Number of rows for which a zone map stores the min/max of a member */
+#define ECS_ZONE_BLOCK_SIZE (256)
+
 /* Magic number for a flecs object */
 #define ECS_OBJECT_MAGIC (0x6563736f)
 
@@ -409,6 +678,7 @@ struct ecs_data_t {
 #define EcsTableHasUnSet            32768u
 #define EcsTableHasSwitch           65536u
 #define EcsTableHasDisabled         131072u
+#define EcsTableHasClosure          262144u /* Does table have pairs for relation with closure index */
 
 /* Composite constants */
 #define EcsTableHasLifecycle        (EcsTableHasCtors | EcsTableHasDtors)
@@ -439,10 +709,16 @@ typedef struct ecs_graph_edge_t {
     ecs_id_t id;             /* Id associated with edge */
 } ecs_graph_edge_t;
 
-/* Edges to other tables. */
+/* Number of words in bitmask with a bit for each low id */
+#define ECS_GRAPH_LO_MASK_COUNT (ECS_HI_COMPONENT_ID / 64)
+
+/* Edges to other tables. Low edges are stored in an array ordered by id, that
+ * only contains the ids that have a bit set in lo_mask. The index of an edge is
+ * the number of bits set in the mask before the bit of the id. */
 typedef struct ecs_graph_edges_t {
-    ecs_graph_edge_t *lo; /* Small array optimized for low edges */
-    ecs_map_t hi;  /* Map for hi edges (map<id, edge_t>) */
+    uint64_t lo_mask[ECS_GRAPH_LO_MASK_COUNT]; /* Low ids with an edge */
+    ecs_graph_edge_t **lo; /* Edges for low ids */
+    ecs_map_t hi;  /* Map for hi edges (map<id, edge_t*>) */
 } ecs_graph_edges_t;
 
 /* Table graph node */
@@ -455,6 +731,35 @@ typedef struct ecs_graph_node_t {
     ecs_graph_edge_hdr_t refs;
 } ecs_graph_node_t;
 
+/** Min/max of member values for a range of rows */
+typedef struct ecs_zone_t {
+    double min;
+    double max;
+    bool dirty;                      /* Values changed since min/max computed */
+} ecs_zone_t;
+
+/** Min/max statistics for a primitive member of a table column. Statistics are
+ * stored for the entire table, and for each block of ECS_ZONE_BLOCK_SIZE rows,
+ * so that iterators can skip tables and blocks that can't match a range. */
+typedef struct ecs_zone_map_t {
+    int32_t column;                  /* Storage column */
+    int32_t offset;                  /* Offset of member in component */
+    int32_t kind;                    /* Primitive kind of member */
+    int32_t table_state;             /* Table dirty state at last update */
+    bool dirty;                      /* Does map have dirty blocks */
+    ecs_zone_t table;                /* Min/max of all rows in table */
+    ecs_vector_t *blocks;            /* vector<ecs_zone_t> */
+} ecs_zone_map_t;
+
+/** Dirty state of the rows of a table column. Row arrays are only resized when
+ * the table gains or loses entities, which doesn't happen while the table is
+ * iterated by worker threads. */
+typedef struct ecs_row_dirty_state_t {
+    ecs_vector_t *rows;              /* vector<int32_t>, state of each row */
+    int32_t column_state;            /* Column state when rows were marked */
+    int32_t untracked_state;         /* Last column state not marked in rows */
+} ecs_row_dirty_state_t;
+
 /** A table is the Flecs equivalent of an archetype. Tables store all entities
  * with a specific set of components. Tables are automatically created when an
  * entity has a set of components not previously observed before. When a new
@@ -479,8 +784,16 @@ struct ecs_table_t {
     ecs_type_info_t **c_info;        /* Cached pointers to component info */
 
     int32_t *dirty_state;            /* Keep track of changes in columns */
+    ecs_row_dirty_state_t *row_dirty_state; /* Per column state of rows */
+    ecs_vector_t *zone_maps;         /* vector<ecs_zone_map_t> */
     int32_t alloc_count;             /* Increases when columns are reallocd */
 
+    ecs_table_t *chunk_root;         /* Table that owns chunk (NULL if root) */
+    ecs_vector_t *chunks;            /* vector<ecs_table_t*> (root only) */
+    int32_t chunk_capacity;          /* Entities per chunk (0 if not chunked) */
+    int32_t chunk_index;             /* Index of chunk (0 for root) */
+    int32_t chunk_free;              /* Lowest chunk that may have space */
+
     int32_t sw_column_count;
     int32_t sw_column_offset;
     int32_t bs_column_count;
@@ -626,6 +939,7 @@ struct ecs_query_t {
     /* Used for sorting */
     ecs_entity_t order_by_component;
     ecs_order_by_action_t order_by;
+    int32_t order_by_kind; /* Primitive kind if ordering by primitive value */
     ecs_vector_t *table_slices;     
 
     /* Used for grouping */
@@ -723,6 +1037,12 @@ struct ecs_stage_t {
     /* Are operations deferred? */
     int32_t defer;
     ecs_vector_t *defer_queue;
+    ecs_stack_t defer_stack;     /* Temp memory used by deferred operations */
+    ecs_stack_cursor_t defer_cursor; /* Start of values for current queue */
+
+    ecs_stack_t frame_stack;     /* Temp memory, reset at end of frame */
+
+    int32_t job_cursor;          /* Next job in worker queue of stage */
 
     ecs_world_t *thread_ctx;     /* Points to stage when a thread stage */
     ecs_world_t *world;          /* Reference to world */
@@ -798,6 +1118,61 @@ typedef struct ecs_store_t {
     ecs_graph_edge_hdr_t *first_free;
 } ecs_store_t;
 
+/** Tables matched by a filter, stored in the world filter cache */
+typedef struct ecs_filter_cache_elem_t {
+    uint64_t hash;               /* Hash of signature */
+    ecs_vector_t *signature;     /* vector<uint64_t>, filter term ids & flags */
+    ecs_vector_t *tables;        /* vector<ecs_table_t*> */
+    int32_t generation;          /* Cache generation when tables were matched */
+    int32_t superset_generation; /* Superset generation when tables were matched */
+    int32_t version;             /* Increases when element is reused */
+    bool match_supersets;        /* Does filter match components of supersets */
+    int32_t prev, next;          /* Least recently used list */
+} ecs_filter_cache_elem_t;
+
+/** World cache with matched tables for filters. The cache is invalidated when
+ * tables are created or deleted. Elements of filters that match components of
+ * supersets are also invalidated when an entity that is used as the object of
+ * a pair changes tables. */
+typedef struct ecs_filter_cache_t {
+    ecs_map_t index;             /* map<hash, elem index> */
+    ecs_filter_cache_elem_t elems[ECS_FILTER_CACHE_SIZE];
+    int32_t count;
+    int32_t first, last;         /* Most/least recently used element */
+    int32_t generation;          /* Increases when tables are created/deleted */
+    int32_t superset_generation; /* Increases when pair objects change table */
+} ecs_filter_cache_t;
+
+/** Node in the superset closure of a table. Nodes are stored in depth first
+ * order, so that the nodes of the subtree of an ancestor directly follow it. */
+typedef struct ecs_closure_node_t {
+    ecs_entity_t entity;         /* Ancestor (object of relation) */
+    int32_t depth;               /* Distance to table (1 = direct object) */
+    int32_t end;                 /* Index after last node in subtree */
+} ecs_closure_node_t;
+
+/** Table in the subset closure of an entity */
+typedef struct ecs_closure_table_t {
+    ecs_table_t *table;          /* Table with (relation, subset/entity) */
+    int32_t column;              /* Column of pair in table type */
+} ecs_closure_table_t;
+
+typedef struct ecs_closure_elem_t {
+    ecs_vector_t *nodes;         /* vector<ecs_closure_node_t|table_t> */
+    int32_t generation;          /* Closure generation when elem was filled */
+    bool pruned;                 /* Were nodes reachable by more than one path */
+} ecs_closure_elem_t;
+
+/** Closure index for a single relation. Elements are filled on demand and 
+ * are invalidated when entities are added to or removed from tables that have
+ * the relation. */
+typedef struct ecs_closure_t {
+    ecs_entity_t relation;
+    ecs_map_t supersets;         /* map<table_id, ecs_closure_elem_t*> */
+    ecs_map_t subsets;           /* map<entity, ecs_closure_elem_t*> */
+    int32_t generation;          /* Increases when relation pairs change */
+} ecs_closure_t;
+
 /** Supporting type to store looked up or derived entity data */
 typedef struct ecs_entity_info_t {
     ecs_record_t *record;       /* Main stage record in entity index */
@@ -847,6 +1222,7 @@ struct ecs_world_t {
     /* --  Data storage -- */
 
     ecs_store_t store;
+    ecs_allocator_t allocator;     /* Pools for storage that grows/shrinks */
 
 
     /* --  Storages for API objects -- */
@@ -872,6 +1248,12 @@ struct ecs_world_t {
      * monitors are evaluated during a merge. */
     ecs_relation_monitor_t monitors;
 
+    /* Tables matched by cached filters */
+    ecs_filter_cache_t filter_cache;
+
+    /* Closure indices for traversed relations */
+    ecs_map_t closures;          /* map<relation, ecs_closure_t*> */
+
 
     /* -- Systems -- */
 
@@ -904,6 +1286,9 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;   /* Mutex for job_cond */
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
+    int32_t workers_parked;      /* Number of workers blocked on worker_cond */
+    int32_t sync_parked;         /* Main thread is blocked on sync_cond */
+    int32_t sync_gen;            /* Incremented each time workers are signaled */
 
 
     /* -- Time management -- */
@@ -940,12 +1325,15 @@ struct ecs_world_t {
     /* -- World state -- */
 
     bool quit_workers;           /* Signals worker threads to quit */
+    bool concurrent_systems;     /* Run single threaded systems concurrently */
     bool is_readonly;            /* Is world being progressed */
+    bool is_in_frame;            /* Is world between frame begin and end */
     bool is_fini;                /* Is the world being cleaned up? */
     bool measure_frame_time;     /* Time spent on each frame */
     bool measure_system_time;    /* Time spent by each system */
     bool should_quit;            /* Did a system signal that app should quit */
     bool locking_enabled;        /* Lock world when in progress */ 
+    bool merge_by_entity;        /* Merge stages in entity order */
 
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
@@ -966,7 +1354,8 @@ extern "C" {
 #endif
 
 void ecs_table_cache_init(
-    ecs_table_cache_t *cache);
+    ecs_table_cache_t *cache,
+    ecs_allocator_t *allocator);
 
 void ecs_table_cache_fini(
     ecs_table_cache_t *cache);
@@ -1494,6 +1883,7 @@ typedef struct {
     ecs_entity_t scope;
     ecs_entity_t with;
     ecs_vector_t *defer_queue;
+    ecs_stack_cursor_t defer_cursor;
     ecs_stage_t *stage;
 } ecs_suspend_readonly_state_t;
 
@@ -1618,6 +2008,14 @@ bool flecs_defer_purge(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+bool flecs_defer_sort(
+    ecs_stage_t *stage);
+
+void flecs_defer_flush_stages(
+    ecs_world_t *world,
+    ecs_stage_t **stages,
+    int32_t count);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Notifications
@@ -1649,6 +2047,18 @@ ecs_table_t* flecs_table_find_or_create(
     ecs_world_t *world,
     const ecs_ids_t *type);
 
+/** Create new chunk for chunked table */
+ecs_table_t* flecs_table_new_chunk(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/** Find chunk of chunked table with space for entities. If count is not NULL,
+ * it is decreased to the number of entities that fit in the chunk. */
+ecs_table_t* flecs_table_chunk_for_append(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t *count);
+
 /* Initialize columns for data */
 void flecs_table_init_data(
     ecs_world_t *world,
@@ -1696,6 +2106,16 @@ void flecs_table_delete(
     int32_t index,
     bool destruct);
 
+/* Delete a range of entities from the table. Rows from the end of the table
+ * are moved to the deleted range. */
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t index,
+    int32_t count,
+    bool destruct);
+
 /* Increase refcount of table (prevents deletion) */
 void flecs_table_claim(
     ecs_world_t *world,
@@ -1728,6 +2148,19 @@ void flecs_table_move(
     int32_t old_index,
     bool construct);
 
+/* Move a range of rows from one table to another. The rows must already have
+ * been appended to the new table, with the same entity ids. */
+void flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    int32_t new_index,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    int32_t old_index,
+    int32_t count,
+    bool construct);
+
 /* Grow table with specified number of records. Populate table with entities,
  * starting from specified entity id. */
 int32_t flecs_table_appendn(
@@ -1735,7 +2168,8 @@ int32_t flecs_table_appendn(
     ecs_table_t *table,
     ecs_data_t *data,
     int32_t count,
-    const ecs_entity_t *ids);
+    const ecs_entity_t *ids,
+    bool construct);
 
 /* Set table to a fixed size. Useful for preallocating memory in advance. */
 void flecs_table_set_size(
@@ -1748,6 +2182,17 @@ void flecs_table_set_size(
 int32_t* flecs_table_get_dirty_state(
     ecs_table_t *table);
 
+/* Get dirty state for rows in table column (storage index). Contains for each
+ * row the column dirty state at the time the row was last marked dirty. Rows
+ * are only tracked after this function has been called for the column. Returns
+ * NULL if the rows don't contain all changes made after the 'since' column 
+ * state, or if tracking can't be enabled because workers are iterating. */
+int32_t* flecs_table_get_row_dirty_state(
+    const ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t since);
+
 /* Get monitor for monitoring table changes */
 int32_t* flecs_table_get_monitor(
     ecs_table_t *table);
@@ -1791,6 +2236,18 @@ void flecs_table_swap(
     int32_t row_1,
     int32_t row_2);
 
+/* Reorder count table rows starting at offset, so that row offset + i 
+ * contains the data of row rows[i]. The rows array must be a permutation of
+ * the rows in the range. It is used as scratch space and is invalid after the
+ * call. */
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t *rows,
+    int32_t offset,
+    int32_t count);
+
 ecs_table_t *flecs_table_traverse_add(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -1806,7 +2263,16 @@ ecs_table_t *flecs_table_traverse_remove(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component);
+    ecs_entity_t component,
+    int32_t row);
+
+/* Mark range of rows in column (storage index) dirty */
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count);
 
 const EcsComponent* flecs_component_from_id(
     const ecs_world_t *world,
@@ -1826,6 +2292,12 @@ void flecs_table_clear_edges(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Get number of outgoing edges of table and memory used by them */
+void flecs_table_graph_memory(
+    const ecs_table_t *table,
+    int32_t *edge_count,
+    int32_t *allocd);
+
 void flecs_table_delete_entities(
     ecs_world_t *world,
     ecs_table_t *table);
@@ -1865,6 +2337,104 @@ bool flecs_filter_match_table(
     bool first,
     int32_t skip_term);
 
+/* Initialize world cache with tables matched by filters */
+void flecs_filter_cache_init(
+    ecs_filter_cache_t *cache);
+
+/* Free world cache with tables matched by filters */
+void flecs_filter_cache_fini(
+    ecs_filter_cache_t *cache);
+
+/* Invalidate cached filter results when tables are created or deleted */
+void flecs_filter_cache_invalidate(
+    ecs_world_t *world);
+
+/* Invalidate cached results of filters that match components of supersets */
+void flecs_filter_cache_invalidate_supersets(
+    ecs_world_t *world);
+
+/* Test if the tables matched by the filter can be cached */
+bool flecs_filter_is_cacheable(
+    const ecs_filter_t *filter);
+
+/* Get (or populate) cache element with tables that match the filter. Returns
+ * NULL when the element can't be used, for example while in readonly mode. */
+ecs_filter_cache_elem_t* flecs_filter_cache_get(
+    ecs_world_t *world,
+    const ecs_filter_t *filter);
+
+/* Get next table from the cache element of a filter iterator */
+ecs_table_t* flecs_filter_cache_next(
+    ecs_filter_iter_t *iter);
+
+/* Initialize world closure indices */
+void flecs_closure_init(
+    ecs_world_t *world);
+
+/* Free world closure indices */
+void flecs_closure_fini(
+    ecs_world_t *world);
+
+/* Test if relation has a closure index */
+bool flecs_closure_is_indexed(
+    const ecs_world_t *world,
+    ecs_entity_t relation);
+
+/* Invalidate closures of relations in table */
+void flecs_closure_table_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Invalidate closures when an entity moves between tables, if the move can
+ * change the closure of a relation in the source or destination table */
+void flecs_closure_entity_move(
+    ecs_world_t *world,
+    ecs_table_t *src_table,
+    ecs_table_t *dst_table,
+    uint32_t row_flags,
+    const ecs_table_diff_t *diff);
+
+/* Remove table from closure indices */
+void flecs_closure_table_free(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get (or populate) supersets of table for relation. Returns NULL when the
+ * relation isn't indexed, or when the element can't be populated. */
+ecs_closure_elem_t* flecs_closure_get_supersets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    const ecs_table_t *table);
+
+/* Get (or populate) tables of subsets of entity for relation. Returns NULL when
+ * the relation isn't indexed, or when the element can't be populated. */
+ecs_closure_elem_t* flecs_closure_get_subsets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    ecs_entity_t entity);
+
+/* Free zone maps of table */
+void flecs_table_zone_maps_fini(
+    ecs_table_t *table);
+
+/* Mark blocks of zone maps for table column (storage index) dirty */
+void flecs_table_zone_maps_mark_dirty(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count);
+
+#ifdef FLECS_META
+/* Get (or create) up to date zone map for primitive member of table column.
+ * Returns NULL if the zone map is out of date and can't be updated. */
+ecs_zone_map_t* flecs_table_get_zone_map(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    ecs_primitive_kind_t kind,
+    bool can_update);
+#endif
+
 bool flecs_query_match(
     const ecs_world_t *world,
     const ecs_table_t *table,
@@ -2285,6 +2855,13 @@ void flecs_table_init_data(
             storage->columns[i].size = flecs_itoi16(component->size);
             storage->columns[i].alignment = flecs_itoi16(component->alignment);
         }
+
+        /* Align arrays so they can be used with aligned SIMD loads */
+        for (i = 0; i < count; i ++) {
+            if (storage->columns[i].alignment < ECS_COLUMN_ALIGNMENT) {
+                storage->columns[i].alignment = ECS_COLUMN_ALIGNMENT;
+            }
+        }
     }
 
     if (sw_count) {
@@ -2681,6 +3258,19 @@ void dtor_all_components(
     }
 }
 
+/* Rows were removed from a chunk, so the next append can use the chunk */
+static
+void chunk_set_free(
+    ecs_table_t *table)
+{
+    if (table->chunk_capacity) {
+        ecs_table_t *root = table->chunk_root ? table->chunk_root : table;
+        if (table->chunk_index < root->chunk_free) {
+            root->chunk_free = table->chunk_index;
+        }
+    }
+}
+
 static
 void fini_data(
     ecs_world_t *world,
@@ -2707,6 +3297,7 @@ void fini_data(
     if (count) {
         dtor_all_components(world, table, data, 0, count, 
             update_entity_index, is_delete);
+        chunk_set_free(table);
     }
 
     /* Sanity check */
@@ -2721,7 +3312,8 @@ void fini_data(
             ecs_assert(!columns[c].data || (ecs_vector_count(columns[c].data) == 
                 ecs_vector_count(data->entities)), ECS_INTERNAL_ERROR, NULL);
 
-            ecs_vector_free(columns[c].data);
+            flecs_vector_free_t(&world->allocator, columns[c].data, 
+                columns[c].size, columns[c].alignment);
         }
         ecs_os_free(columns);
         data->columns = NULL;
@@ -2801,6 +3393,33 @@ void flecs_table_remove_actions(
     run_on_remove(world, table, &table->storage);
 }
 
+/* Remove chunk from the table that owns it. If the table that owns the chunks
+ * is deleted, the remaining chunks become regular tables. */
+static
+void chunks_fini(
+    ecs_table_t *table)
+{
+    ecs_table_t *root = table->chunk_root;
+    if (root) {
+        ecs_table_t **chunks = ecs_vector_first(root->chunks, ecs_table_t*);
+        int32_t i, count = ecs_vector_count(root->chunks);
+        for (i = table->chunk_index; i < count; i ++) {
+            chunks[i - 1] = chunks[i];
+            chunks[i - 1]->chunk_index = i;
+        }
+        ecs_vector_remove_last(root->chunks);
+        root->chunk_free = 0;
+    } else {
+        ecs_table_t **chunks = ecs_vector_first(table->chunks, ecs_table_t*);
+        int32_t i, count = ecs_vector_count(table->chunks);
+        for (i = 0; i < count; i ++) {
+            chunks[i]->chunk_root = NULL;
+            chunks[i]->chunk_capacity = 0;
+            chunks[i]->chunk_index = 0;
+        }
+    }
+}
+
 /* Free table resources. */
 void flecs_table_free(
     ecs_world_t *world,
@@ -2834,6 +3453,8 @@ void flecs_table_free(
     /* Cleanup data, no OnRemove, delete from entity index, don't deactivate */
     fini_data(world, table, &table->storage, false, true, true, false);
 
+    flecs_closure_table_free(world, table);
+
     flecs_table_clear_edges(world, table);
 
     if (!is_root) {
@@ -2842,12 +3463,32 @@ void flecs_table_free(
             .count = ecs_vector_count(table->type)
         };
 
-        flecs_hashmap_remove(&world->store.table_map, &ids, ecs_table_t*);
+        /* Chunks aren't stored in the hashmap */
+        ecs_table_t **elem = flecs_hashmap_get(
+            &world->store.table_map, &ids, ecs_table_t*);
+        if (elem && elem[0] == table) {
+            flecs_hashmap_remove(&world->store.table_map, &ids, ecs_table_t*);
+        }
     }
 
+    if (!world->is_fini) {
+        chunks_fini(table);
+    }
+    ecs_vector_free(table->chunks);
+
     ecs_os_free(table->dirty_state);
     ecs_os_free(table->storage_map);
 
+    if (table->row_dirty_state) {
+        int32_t i, count = ecs_vector_count(table->storage_type);
+        for (i = 0; i < count; i ++) {
+            ecs_vector_free(table->row_dirty_state[i].rows);
+        }
+        ecs_os_free(table->row_dirty_state);
+    }
+
+    flecs_table_zone_maps_fini(table);
+
     if (table->c_info) {
         ecs_os_free(table->c_info);
     }
@@ -2909,6 +3550,40 @@ void flecs_table_reset(
     flecs_table_clear_edges(world, table);
 }
 
+/* Resize row dirty state arrays to the number of entities in the table. New
+ * rows don't need a valid state, as the table dirty state changed. */
+static
+void sync_row_dirty_state(
+    ecs_table_t *table)
+{
+    int32_t i, column_count = ecs_vector_count(table->storage_type);
+    int32_t count = ecs_table_count(table);
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_vector_t **rows_ptr = &table->row_dirty_state[i].rows;
+        if (!*rows_ptr) {
+            continue;
+        }
+
+        int32_t to_add = count - ecs_vector_count(*rows_ptr);
+        if (to_add > 0) {
+            int32_t *new_rows = ecs_vector_addn(rows_ptr, int32_t, to_add);
+            ecs_os_memset_n(new_rows, 0, int32_t, to_add);
+        } else {
+            ecs_vector_set_count(rows_ptr, int32_t, count);
+        }
+    }
+}
+
+/* Row state can't be allocated or marked while worker threads are iterating,
+ * as multiple workers may write the same table. */
+static
+bool can_track_rows(
+    const ecs_world_t *world)
+{
+    return !world->is_readonly || ecs_get_stage_count(world) <= 1;
+}
+
 static
 void mark_table_dirty(
     ecs_world_t *world,
@@ -2918,13 +3593,18 @@ void mark_table_dirty(
     (void)world;
     if (table->dirty_state) {
         table->dirty_state[index] ++;
+
+        if (!index && table->row_dirty_state) {
+            sync_row_dirty_state(table);
+        }
     }
 }
 
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component)
+    ecs_entity_t component,
+    int32_t row)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -2932,7 +3612,57 @@ void flecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_search(world, table->storage_table, component, 0);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index + 1] ++;
+        flecs_table_mark_rows_dirty(world, table, index, row, 1);
+    }
+}
+
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+
+    if (!table->dirty_state) {
+        return;
+    }
+
+    int32_t state = ++ table->dirty_state[column + 1];
+    if (table->zone_maps) {
+        flecs_table_zone_maps_mark_dirty(table, column, offset, count);
+    }
+
+    if (!table->row_dirty_state) {
+        return;
+    }
+
+    ecs_row_dirty_state_t *rds = &table->row_dirty_state[column];
+    if (!rds->rows) {
+        /* Rows aren't tracked for column */
+        return;
+    }
+
+    /* Don't mark rows from worker threads. Because the column state no longer
+     * matches the state of the rows, all rows are reported as changed. */
+    if (!can_track_rows(world)) {
+        return;
+    }
+
+    if (rds->column_state != (state - 1)) {
+        /* Column changed since the last time rows were marked */
+        rds->untracked_state = state - 1;
+    }
+    rds->column_state = state;
+
+    ecs_assert(ecs_vector_count(rds->rows) >= (offset + count), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i, *rows = ecs_vector_first(rds->rows, int32_t);
+    for (i = offset; i < offset + count; i ++) {
+        rows[i] = state;
     }
 }
 
@@ -3048,6 +3778,7 @@ void grow_column(
     int32_t new_size,
     bool construct)
 {
+    ecs_allocator_t *a = &world->allocator;
     ecs_vector_t *vec = column->data;
     int16_t alignment = column->alignment;
 
@@ -3070,8 +3801,9 @@ void grow_column(
         ecs_assert(move_ctor != NULL, ECS_INTERNAL_ERROR, NULL);
 
         /* Create new vector */
-        ecs_vector_t *new_vec = ecs_vector_new_t(size, alignment, new_size);
-        ecs_vector_set_count_t(&new_vec, size, alignment, new_count);
+        ecs_vector_t *new_vec = flecs_vector_new_t(
+            a, size, alignment, new_size);
+        flecs_vector_set_count_t(a, &new_vec, size, alignment, new_count);
 
         void *old_buffer = ecs_vector_first_t(
             vec, size, alignment);
@@ -3094,16 +3826,16 @@ void grow_column(
         }
 
         /* Free old vector */
-        ecs_vector_free(vec);
+        flecs_vector_free_t(a, vec, size, alignment);
 
         column->data = new_vec;
     } else {
         /* If array won't realloc or has no move, simply add new elements */
         if (can_realloc) {
-            ecs_vector_set_size_t(&vec, size, alignment, new_size);
+            flecs_vector_set_size_t(a, &vec, size, alignment, new_size);
         }
 
-        void *elem = ecs_vector_addn_t(&vec, size, alignment, to_add);
+        void *elem = flecs_vector_addn_t(a, &vec, size, alignment, to_add);
 
         ecs_xtor_t ctor;
         if (construct && c_info && (ctor = c_info->lifecycle.ctor)) {
@@ -3127,7 +3859,8 @@ int32_t grow_data(
     ecs_data_t *data,
     int32_t to_add,
     int32_t size,
-    const ecs_entity_t *ids)
+    const ecs_entity_t *ids,
+    bool construct)
 {
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -3139,6 +3872,7 @@ int32_t grow_data(
     ecs_column_t *columns = data->columns;
     ecs_sw_column_t *sw_columns = data->sw_columns;
     ecs_bs_column_t *bs_columns = data->bs_columns; 
+    int32_t cur_size = ecs_vector_size(data->entities);
 
     /* Add record to record ptr array */
     ecs_vector_set_size(&data->record_ptrs, ecs_record_t*, size);
@@ -3177,7 +3911,7 @@ int32_t grow_data(
             c_info = c_info_array[i];
         }
 
-        grow_column(world, entities, column, c_info, to_add, size, true);
+        grow_column(world, entities, column, c_info, to_add, size, construct);
         ecs_assert(ecs_vector_size(columns[i].data) == size, 
             ECS_INTERNAL_ERROR, NULL);
     }
@@ -3201,7 +3935,8 @@ int32_t grow_data(
         flecs_table_set_empty(world, table);
     }
 
-    table->alloc_count ++;
+    /* Columns are only reallocated when the table grows beyond its size */
+    table->alloc_count += (size != cur_size);
 
     /* Return index of first added entity */
     return cur_count;
@@ -3209,17 +3944,19 @@ int32_t grow_data(
 
 static
 void fast_append(
+    ecs_world_t *world,
     ecs_column_t *columns,
     int32_t column_count)
 {
     /* Add elements to each column array */
+    ecs_allocator_t *a = &world->allocator;
     int32_t i;
     for (i = 0; i < column_count; i ++) {
         ecs_column_t *column = &columns[i];
         int16_t size = column->size;
         if (size) {
             int16_t alignment = column->alignment;
-            ecs_vector_add_t(&column->data, size, alignment);
+            flecs_vector_add_t(a, &column->data, size, alignment);
         }
     }
 }
@@ -3263,7 +4000,7 @@ int32_t flecs_table_append(
 
     /* Fast path: no switch columns, no lifecycle actions */
     if (!(table->flags & EcsTableIsComplex)) {
-        fast_append(columns, column_count);
+        fast_append(world, columns, column_count);
         if (!count) {
             flecs_table_set_empty(world, table); /* See below */
         }
@@ -3376,6 +4113,7 @@ void flecs_table_delete(
     ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
     count --;
     ecs_assert(index <= count, ECS_INTERNAL_ERROR, NULL);
+    chunk_set_free(table);
 
     /* Move last entity id to index */
     ecs_entity_t *entities = ecs_vector_first(v_entities, ecs_entity_t);
@@ -3505,6 +4243,131 @@ void flecs_table_delete(
     }
 }
 
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t index,
+    int32_t count,
+    bool destruct)
+{
+    ecs_assert(world != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t total = ecs_vector_count(data->entities);
+    ecs_assert(index + count <= total, ECS_INTERNAL_ERROR, NULL);
+    int32_t remaining = total - count;
+    chunk_set_free(table);
+
+    /* Like deleting a single row, rows are moved from the end of the table to
+     * the deleted range. Only rows after the range have to be moved. */
+    int32_t move_count = total - index - count;
+    if (move_count > count) {
+        move_count = count;
+    }
+    int32_t move_from = total - move_count;
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+    ecs_record_t **records = ecs_vector_first(data->record_ptrs, ecs_record_t*);
+
+    /* Move component data. This happens before the entity ids are moved, so
+     * that callbacks are invoked with the entity ids that own the data. */
+    ecs_type_info_t **c_info_array = table->c_info;
+    ecs_id_t *ids = ecs_vector_first(table->storage_type, ecs_id_t);
+    ecs_column_t *columns = data->columns;
+    int32_t i, column_count = ecs_vector_count(table->storage_type);
+    bool is_complex = table->flags & EcsTableIsComplex;
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_column_t *column = &columns[i];
+        int16_t size = column->size;
+        int16_t alignment = column->alignment;
+        ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+
+        ecs_type_info_t *c_info = NULL;
+        if (is_complex && c_info_array) {
+            c_info = c_info_array[i];
+        }
+
+        if (destruct) {
+            dtor_component(world, table, c_info, column, entities, ids[i],
+                index, count, true);
+        }
+
+        if (move_count) {
+            void *dst = ecs_vector_get_t(column->data, size, alignment, index);
+            void *src = ecs_vector_get_t(
+                column->data, size, alignment, move_from);
+
+            ecs_move_ctor_t move;
+            if (c_info && (move = c_info->lifecycle.ctor_move_dtor)) {
+                move(world, c_info->component, &c_info->lifecycle, 
+                    &entities[move_from], &entities[move_from], dst, src, 
+                    flecs_itosize(size), move_count, c_info->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, src, size * move_count);
+            }
+        }
+
+        flecs_vector_set_count_t(&world->allocator, &column->data, size, 
+            alignment, remaining);
+    }
+
+    /* Move entity ids & record ptrs, update records of moved entities */
+    for (i = 0; i < move_count; i ++) {
+        ecs_record_t *record = records[move_from + i];
+        entities[index + i] = entities[move_from + i];
+        records[index + i] = record;
+
+        if (record) {
+            uint32_t row_flags = record->row & ECS_ROW_FLAGS_MASK;
+            record->row = ECS_ROW_TO_RECORD(index + i, row_flags);
+            ecs_assert(record->table == table, ECS_INTERNAL_ERROR, NULL);
+        }
+    }
+
+    ecs_vector_set_count(&data->entities, ecs_entity_t, remaining);
+    ecs_vector_set_count(&data->record_ptrs, ecs_record_t*, remaining);
+
+    /* Move elements in switch columns, then remove elements from the end */
+    ecs_sw_column_t *sw_columns = data->sw_columns;
+    int32_t j, sw_column_count = table->sw_column_count;
+    for (i = 0; i < sw_column_count; i ++) {
+        ecs_switch_t *sw = sw_columns[i].data;
+        for (j = 0; j < move_count; j ++) {
+            flecs_switch_set(sw, index + j, flecs_switch_get(sw, move_from + j));
+        }
+        for (j = total - 1; j >= remaining; j --) {
+            flecs_switch_remove(sw, j);
+        }
+    }
+
+    /* Move elements in bitset columns, then remove elements from the end */
+    ecs_bs_column_t *bs_columns = data->bs_columns;
+    int32_t bs_column_count = table->bs_column_count;
+    for (i = 0; i < bs_column_count; i ++) {
+        ecs_bitset_t *bs = &bs_columns[i].data;
+        for (j = 0; j < move_count; j ++) {
+            flecs_bitset_set(bs, index + j, flecs_bitset_get(bs, move_from + j));
+        }
+        for (j = total - 1; j >= remaining; j --) {
+            flecs_bitset_remove(bs, j);
+        }
+    }
+
+    /* If the table is monitored indicate that there has been a change */
+    mark_table_dirty(world, table, 0);
+
+    /* If table is empty, deactivate it */
+    if (!remaining) {
+        flecs_table_set_empty(world, table);
+    }
+}
+
 static
 void fast_move(
     ecs_table_t *new_table,
@@ -3673,17 +4536,136 @@ void flecs_table_move(
     }
 }
 
+void flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    int32_t new_index,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    int32_t old_index,
+    int32_t count,
+    bool construct)
+{
+    ecs_assert(new_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!new_table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!old_table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(new_table != old_table, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_assert(old_index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_index + count <= ecs_vector_count(old_data->entities),
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_index + count <= ecs_vector_count(new_data->entities),
+        ECS_INTERNAL_ERROR, NULL);
+
+    bool is_complex = (new_table->flags | old_table->flags) & EcsTableIsComplex;
+    if (is_complex) {
+        move_switch_columns(new_table, new_data, new_index, 
+            old_table, old_data, old_index, count);
+
+        move_bitset_columns(new_table, new_data, new_index, 
+            old_table, old_data, old_index, count);
+    }
+
+    ecs_entity_t *new_entities = ecs_vector_first(
+        new_data->entities, ecs_entity_t);
+    ecs_entity_t *old_entities = ecs_vector_first(
+        old_data->entities, ecs_entity_t);
+
+    ecs_type_t new_type = new_table->storage_type;
+    ecs_type_t old_type = old_table->storage_type;
+
+    int32_t i_new = 0, new_column_count = ecs_vector_count(new_type);
+    int32_t i_old = 0, old_column_count = ecs_vector_count(old_type);
+    ecs_entity_t *new_components = ecs_vector_first(new_type, ecs_entity_t);
+    ecs_entity_t *old_components = ecs_vector_first(old_type, ecs_entity_t);
+
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+
+    ecs_type_info_t **new_c_info = is_complex ? new_table->c_info : NULL;
+    ecs_type_info_t **old_c_info = is_complex ? old_table->c_info : NULL;
+
+    for (; (i_new < new_column_count) && (i_old < old_column_count);) {
+        ecs_entity_t new_component = new_components[i_new];
+        ecs_entity_t old_component = old_components[i_old];
+
+        if (new_component == old_component) {
+            ecs_column_t *new_column = &new_columns[i_new];
+            ecs_column_t *old_column = &old_columns[i_old];
+            int16_t size = new_column->size;
+            int16_t alignment = new_column->alignment;
+
+            ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+
+            void *dst = ecs_vector_get_t(
+                new_column->data, size, alignment, new_index);
+            void *src = ecs_vector_get_t(
+                old_column->data, size, alignment, old_index);
+
+            ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
+            ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
+
+            /* Move the entire range of values at once */
+            ecs_type_info_t *cdata = new_c_info ? new_c_info[i_new] : NULL;
+            ecs_move_ctor_t callback;
+            if (cdata && (callback = cdata->lifecycle.ctor_move_dtor)) {
+                callback(world, new_component, &cdata->lifecycle, 
+                    &new_entities[new_index], &old_entities[old_index],
+                    dst, src, flecs_itosize(size), count, 
+                    cdata->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, src, size * count);
+            }
+        } else if (is_complex) {
+            if (new_component < old_component) {
+                if (construct && new_c_info) {
+                    ctor_component(world, new_c_info[i_new], 
+                        &new_columns[i_new], &new_entities[new_index], 
+                        new_index, count);
+                }
+            } else if (old_c_info) {
+                dtor_component(world, old_table, old_c_info[i_old],
+                    &old_columns[i_old], old_entities, old_component, 
+                    old_index, count, true);
+            }
+        }
+
+        i_new += new_component <= old_component;
+        i_old += new_component >= old_component;
+    }
+
+    if (construct && new_c_info) {
+        for (; (i_new < new_column_count); i_new ++) {
+            ctor_component(world, new_c_info[i_new], &new_columns[i_new], 
+                &new_entities[new_index], new_index, count);
+        }
+    }
+
+    if (old_c_info) {
+        for (; (i_old < old_column_count); i_old ++) {
+            dtor_component(world, old_table, old_c_info[i_old],
+                &old_columns[i_old], old_entities, old_components[i_old], 
+                    old_index, count, true);
+        }
+    }
+}
+
 int32_t flecs_table_appendn(
     ecs_world_t *world,
     ecs_table_t *table,
     ecs_data_t *data,
     int32_t to_add,
-    const ecs_entity_t *ids)
+    const ecs_entity_t *ids,
+    bool construct)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
 
     int32_t cur_count = flecs_table_data_count(data);
-    return grow_data(world, table, data, to_add, cur_count + to_add, ids);
+    return grow_data(
+        world, table, data, to_add, cur_count + to_add, ids, construct);
 }
 
 void flecs_table_set_size(
@@ -3697,7 +4679,7 @@ void flecs_table_set_size(
     int32_t cur_count = flecs_table_data_count(data);
 
     if (cur_count < size) {
-        grow_data(world, table, data, 0, size, NULL);
+        grow_data(world, table, data, 0, size, NULL, true);
     }
 }
 
@@ -3820,6 +4802,97 @@ void flecs_table_swap(
     }  
 }
 
+static
+void permute_array(
+    void *array,
+    void *tmp,
+    ecs_size_t size,
+    const int32_t *rows,
+    int32_t offset,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy(ECS_ELEM(tmp, size, i), 
+            ECS_ELEM(array, size, rows[i]), size);
+    }
+    ecs_os_memcpy(ECS_ELEM(array, size, offset), tmp, size * count);
+}
+
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t *rows,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(rows != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(offset >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(offset + count <= flecs_table_data_count(data), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i;
+    if (!count) {
+        return;
+    }
+
+    if (table->sw_column_count || table->bs_column_count) {
+        /* Switch and bitset columns can only be swapped, so move rows into
+         * place by following the cycles of the permutation. Each row that is
+         * swapped into place is marked as done. */
+        for (i = offset; i < offset + count; i ++) {
+            int32_t cur = i, next;
+            while ((next = rows[cur - offset]) != i) {
+                flecs_table_swap(world, table, data, cur, next);
+                rows[cur - offset] = cur;
+                cur = next;
+            }
+            rows[cur - offset] = cur;
+        }
+        return;
+    }
+
+    mark_table_dirty(world, table, 0);
+
+    /* Copy rows into a scratch buffer in their new order, and copy the buffer
+     * back. Unlike swapping, this moves each row only once. */
+    ecs_column_t *columns = data->columns;
+    int32_t column_count = ecs_vector_count(table->storage_type);
+    ecs_size_t tmp_size = ECS_SIZEOF(ecs_entity_t);
+    for (i = 0; i < column_count; i ++) {
+        tmp_size = ECS_MAX(tmp_size, columns[i].size);
+    }
+
+    void *tmp = ecs_os_malloc(tmp_size * count);
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+    permute_array(entities, tmp, ECS_SIZEOF(ecs_entity_t), rows, 
+        offset, count);
+
+    ecs_record_t **records = ecs_vector_first(
+        data->record_ptrs, ecs_record_t*);
+    permute_array(records, tmp, ECS_SIZEOF(ecs_record_t*), rows, 
+        offset, count);
+
+    for (i = offset; i < offset + count; i ++) {
+        ecs_record_t *r = records[i];
+        ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+        r->row = ECS_ROW_TO_RECORD(i, ECS_RECORD_TO_ROW_FLAGS(r->row));
+    }
+
+    for (i = 0; i < column_count; i ++) {
+        int16_t size = columns[i].size;
+        int16_t alignment = columns[i].alignment;
+        void *ptr = ecs_vector_first_t(columns[i].data, size, alignment);
+        permute_array(ptr, tmp, size, rows, offset, count);
+    }
+
+    ecs_os_free(tmp);
+}
+
 static
 void merge_vector(
     ecs_vector_t **dst_out,
@@ -3872,17 +4945,15 @@ void merge_column(
     int32_t dst_count = ecs_vector_count(dst);
 
     if (!dst_count) {
-        if (dst) {
-            ecs_vector_free(dst);
-        }
-
+        flecs_vector_free_t(&world->allocator, dst, size, alignment);
         column->data = src;
     
     /* If the new table is not empty, copy the contents from the
      * src into the dst. */
     } else {
         int32_t src_count = ecs_vector_count(src);
-        ecs_vector_set_count_t(&dst, size, alignment, dst_count + src_count);
+        flecs_vector_set_count_t(&world->allocator, &dst, size, alignment, 
+            dst_count + src_count);
         column->data = dst;
 
         /* Construct new values */
@@ -3906,7 +4977,7 @@ void merge_column(
             ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
         }
 
-        ecs_vector_free(src);
+        flecs_vector_free_t(&world->allocator, src, size, alignment);
     }
 }
 
@@ -3975,8 +5046,8 @@ void merge_table_data(
             /* New column does not occur in old table, make sure vector is large
              * enough. */
             ecs_column_t *column = &new_columns[i_new];
-            ecs_vector_set_count_t(&column->data, size, alignment,
-                old_count + new_count);
+            flecs_vector_set_count_t(&world->allocator, &column->data, size, 
+                alignment, old_count + new_count);
 
             /* Construct new values */
             ecs_type_info_t *c_info = new_table->c_info[i_new];
@@ -3997,7 +5068,8 @@ void merge_table_data(
             }
 
             /* Old column does not occur in new table, remove */
-            ecs_vector_free(column->data);
+            flecs_vector_free_t(&world->allocator, column->data, 
+                column->size, column->alignment);
             column->data = NULL;
 
             i_old ++;
@@ -4014,8 +5086,8 @@ void merge_table_data(
         int16_t alignment = column->alignment;
         ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
 
-        ecs_vector_set_count_t(&column->data, size, alignment,
-            old_count + new_count);
+        flecs_vector_set_count_t(&world->allocator, &column->data, size, 
+            alignment, old_count + new_count);
 
         /* Construct new values */
         ecs_type_info_t *c_info = new_table->c_info[i_new];
@@ -4037,7 +5109,8 @@ void merge_table_data(
         }
 
         /* Old column does not occur in new table, remove */
-        ecs_vector_free(column->data);
+        flecs_vector_free_t(&world->allocator, column->data, 
+            column->size, column->alignment);
         column->data = NULL;
     }    
 
@@ -4052,6 +5125,49 @@ int32_t ecs_table_count(
     return flecs_table_data_count(&table->storage);
 }
 
+/* Merge entities into chunked table. Entities are moved to chunks with space
+ * instead of growing the columns of the destination table. */
+static
+void merge_chunked(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data)
+{
+    int32_t i, old_count;
+    while ((old_count = ecs_vector_count(old_data->entities))) {
+        int32_t count = old_count;
+        ecs_table_t *chunk = flecs_table_chunk_for_append(
+            world, new_table, &count);
+        ecs_data_t *new_data = &chunk->storage;
+        int32_t old_index = old_count - count;
+
+        ecs_entity_t *old_entities = ecs_vector_first(
+            old_data->entities, ecs_entity_t);
+        int32_t new_index = flecs_table_appendn(world, chunk, new_data, count,
+            &old_entities[old_index], false);
+
+        flecs_table_move_range(world, chunk, new_data, new_index, 
+            old_table, old_data, old_index, count, true);
+
+        ecs_record_t **old_records = ecs_vector_first(
+            old_data->record_ptrs, ecs_record_t*);
+        ecs_record_t **new_records = ecs_vector_first(
+            new_data->record_ptrs, ecs_record_t*);
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *record = old_records[old_index + i];
+            ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+            uint32_t flags = ECS_RECORD_TO_ROW_FLAGS(record->row);
+            record->row = ECS_ROW_TO_RECORD(new_index + i, flags);
+            record->table = chunk;
+            new_records[new_index + i] = record;
+        }
+
+        flecs_table_delete_range(
+            world, old_table, old_data, old_index, count, false);
+    }
+}
+
 void flecs_table_merge(
     ecs_world_t *world,
     ecs_table_t *new_table,
@@ -4084,6 +5200,11 @@ void flecs_table_merge(
         }
     }
 
+    if (new_table->chunk_capacity && new_table != old_table) {
+        merge_chunked(world, new_table, old_table, old_data);
+        return;
+    }
+
     ecs_entity_t *old_entities = ecs_vector_first(old_data->entities, ecs_entity_t);
     int32_t old_count = ecs_vector_count(old_data->entities);
     int32_t new_count = ecs_vector_count(new_data->entities);
@@ -4171,6 +5292,62 @@ int32_t* flecs_table_get_dirty_state(
     return table->dirty_state;
 }
 
+int32_t* flecs_table_get_row_dirty_state(
+    const ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t since)
+{
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t *dirty_state = flecs_table_get_dirty_state(table);
+    int32_t column_count = ecs_vector_count(table->storage_type);
+    ecs_assert(column < column_count, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t count = ecs_table_count(table);
+    ecs_row_dirty_state_t *rds = NULL;
+    if (table->row_dirty_state) {
+        rds = &table->row_dirty_state[column];
+    }
+
+    if (!rds || !rds->rows) {
+        if (!can_track_rows(world)) {
+            return NULL;
+        }
+
+        if (!table->row_dirty_state) {
+            table->row_dirty_state = ecs_os_calloc_n(
+                ecs_row_dirty_state_t, column_count);
+            rds = &table->row_dirty_state[column];
+        }
+
+        /* Initialize rows with the current column state, as it's unknown 
+         * whether they changed before row tracking was enabled. */
+        int32_t i, state = dirty_state[column + 1];
+        rds->rows = ecs_vector_new(int32_t, count);
+        ecs_vector_set_count(&rds->rows, int32_t, count);
+        int32_t *rows = ecs_vector_first(rds->rows, int32_t);
+        for (i = 0; i < count; i ++) {
+            rows[i] = state;
+        }
+
+        rds->column_state = state;
+    }
+
+    ecs_assert(ecs_vector_count(rds->rows) == count, 
+        ECS_INTERNAL_ERROR, NULL);
+
+    /* If the column changed without marking rows after 'since', rows can't be
+     * used to find which rows changed */
+    if (rds->column_state != dirty_state[column + 1] || 
+        since < rds->untracked_state) 
+    {
+        return NULL;
+    }
+
+    return ecs_vector_first(rds->rows, int32_t);
+}
+
 int32_t* flecs_table_get_monitor(
     ecs_table_t *table)
 {
@@ -4225,6 +5402,128 @@ void ecs_table_unlock(
     }
 }
 
+void ecs_dim_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t entity_count)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity_count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!world->is_readonly, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    ecs_data_t *data = &table->storage;
+    if (ecs_vector_size(data->entities) < entity_count) {
+        flecs_table_set_size(world, table, data, entity_count);
+    }
+error:
+    return;
+}
+
+void ecs_table_set_chunk_size(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t chunk_size)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(table->type != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!world->is_readonly, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    if (table->chunk_root) {
+        table = table->chunk_root;
+    }
+
+    /* The largest column determines how many entities fit in a chunk */
+    ecs_size_t elem_size = ECS_SIZEOF(ecs_entity_t);
+    ecs_column_t *columns = table->storage.columns;
+    int32_t i, column_count = ecs_vector_count(table->storage_type);
+    for (i = 0; i < column_count; i ++) {
+        if (columns[i].size > elem_size) {
+            elem_size = columns[i].size;
+        }
+    }
+
+    /* Vectors grow in powers of two, round down so chunks don't exceed the
+     * specified size */
+    int32_t capacity = chunk_size / elem_size;
+    if (!capacity) {
+        capacity = 1;
+    }
+    while (capacity & (capacity - 1)) {
+        capacity &= capacity - 1;
+    }
+
+    table->chunk_capacity = capacity;
+    table->chunk_free = 0;
+
+    ecs_table_t **chunks = ecs_vector_first(table->chunks, ecs_table_t*);
+    int32_t count = ecs_vector_count(table->chunks);
+    for (i = 0; i < count; i ++) {
+        chunks[i]->chunk_capacity = capacity;
+    }
+error:
+    return;
+}
+
+/* A chunk has space if entities can be added without reallocating its columns.
+ * Empty chunks are dimensioned for the chunk capacity. */
+static
+int32_t chunk_space(
+    ecs_world_t *world,
+    ecs_table_t *chunk)
+{
+    ecs_data_t *data = &chunk->storage;
+    int32_t count = ecs_vector_count(data->entities);
+    if (!count && ecs_vector_size(data->entities) < chunk->chunk_capacity) {
+        flecs_table_set_size(world, chunk, data, chunk->chunk_capacity);
+    }
+
+    return ecs_vector_size(data->entities) - count;
+}
+
+ecs_table_t* flecs_table_chunk_for_append(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t *count)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (!table->chunk_capacity) {
+        return table;
+    }
+
+    ecs_table_t *root = table->chunk_root ? table->chunk_root : table;
+    ecs_table_t **chunks = ecs_vector_first(root->chunks, ecs_table_t*);
+    int32_t i, chunk_count = ecs_vector_count(root->chunks);
+    ecs_table_t *result = NULL;
+    int32_t space = 0;
+
+    /* Chunks before chunk_free are full, start searching from there */
+    for (i = root->chunk_free; i <= chunk_count; i ++) {
+        result = i ? chunks[i - 1] : root;
+        if ((space = chunk_space(world, result))) {
+            break;
+        }
+    }
+
+    root->chunk_free = i;
+
+    if (!space) {
+        result = flecs_table_new_chunk(world, root);
+        space = chunk_space(world, result);
+    }
+
+    ecs_assert(space > 0, ECS_INTERNAL_ERROR, NULL);
+
+    if (count && *count > space) {
+        *count = space;
+    }
+
+    return result;
+}
+
 bool ecs_table_has_module(
     ecs_table_t *table)
 {
@@ -4796,6 +6095,22 @@ error:
     return NULL;
 }
 
+static
+ecs_table_t* table_remove(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_id_t id,
+    ecs_table_diff_t *diff)
+{
+    ecs_table_diff_t temp_diff;
+    table = flecs_table_traverse_remove(world, table, &id, &temp_diff);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    diff_append(diff, &temp_diff);
+    return table;
+error:
+    return NULL;
+}
+
 static
 void notify(
     ecs_world_t *world,
@@ -4940,15 +6255,30 @@ void instantiate_children(
 
         /* Create children */
         int32_t child_row; 
-        new_w_data(world, i_table, NULL, &components, child_count, 
-            component_data, false, &child_row, &diff);
+        const ecs_entity_t *i_children = new_w_data(world, i_table, NULL, 
+            &components, child_count, component_data, false, &child_row, 
+            &diff);
         diff_free(&diff);
 
         /* If prefab child table has children itself, recursively instantiate */
-        ecs_data_t *i_data = &i_table->storage;
-        for (j = 0; j < child_count; j ++) {
-            ecs_entity_t child = children[j];
-            instantiate(world, child, i_table, i_data, child_row + j, 1);
+        if (!i_table->chunk_capacity) {
+            ecs_data_t *i_data = &i_table->storage;
+            for (j = 0; j < child_count; j ++) {
+                ecs_entity_t child = children[j];
+                instantiate(world, child, i_table, i_data, child_row + j, 1);
+            }
+        } else {
+            /* Children of a chunked table can be stored in different chunks.
+             * Copy the ids, as instantiating can create new entities. */
+            ecs_entity_t *i_ids = ecs_os_memdup_n(
+                i_children, ecs_entity_t, child_count);
+            for (j = 0; j < child_count; j ++) {
+                ecs_record_t *r = ecs_eis_get(world, i_ids[j]);
+                ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+                instantiate(world, children[j], r->table, &r->table->storage,
+                    (int32_t)ECS_RECORD_TO_ROW(r->row), 1);
+            }
+            ecs_os_free(i_ids);
         }
     }   
 error:
@@ -5416,9 +6746,16 @@ static
 void update_component_monitors(
     ecs_world_t *world,
     ecs_entity_t entity,
+    uint32_t row_flags,
     ecs_ids_t *added,
     ecs_ids_t *removed)
 {
+    /* If the entity is used as pair object, tables with the pair can start or
+     * stop matching cached filters that match components of supersets */
+    if (row_flags & ECS_FLAG_OBSERVED_OBJECT) {
+        flecs_filter_cache_invalidate_supersets(world);
+    }
+
     update_component_monitor_w_array(world, entity, 0, added);
     update_component_monitor_w_array(world, entity, 0, removed);
 }
@@ -5451,9 +6788,15 @@ void commit(
         return;
     }
 
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Entities are added to a chunk with space if the table is chunked */
+    if (dst_table->chunk_capacity) {
+        dst_table = flecs_table_chunk_for_append(world, dst_table, NULL);
+    }
+
     if (src_table) {
         ecs_data_t *src_data = info->data;
-        ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
 
         if (dst_table->type) { 
             info->row = move_entity(world, entity, info, src_table, 
@@ -5474,13 +6817,17 @@ void commit(
         }        
     }
 
+    flecs_closure_entity_move(
+        world, src_table, dst_table, info->row_flags, diff);
+
     /* If the entity is being watched, it is being monitored for changes and
      * requires rematching systems when components are added or removed. This
      * ensures that systems that rely on components from containers or prefabs
      * update the matched tables when the application adds or removes a 
      * component from, for example, a container. */
     if (info->row_flags) {
-        update_component_monitors(world, entity, &diff->added, &diff->removed);
+        update_component_monitors(world, entity, info->row_flags, 
+            &diff->added, &diff->removed);
     }
 
     if ((!src_table || !src_table->type) && world->range_check_enabled) {
@@ -5508,47 +6855,32 @@ void new(
         table = table_append(world, table, to_add->array[i], &diff);
     }
 
+    if (table->chunk_capacity) {
+        table = flecs_table_chunk_for_append(world, table, NULL);
+    }
+
     new_entity(world, entity, &info, table, &diff, true, true);
 
     diff_free(&diff);
 }
 
+/* Add entities with component data to a table. The offset is the index of the
+ * first entity in the component data arrays. */
 static
-const ecs_entity_t* new_w_data(
+int32_t append_w_data(
     ecs_world_t *world,
     ecs_table_t *table,
     const ecs_entity_t *entities,
     ecs_ids_t *component_ids,
     int32_t count,
     void **component_data,
+    int32_t offset,
     bool is_move,
-    int32_t *row_out,
     ecs_table_diff_t *diff)
 {
-    int32_t sparse_count = 0;
-    if (!entities) {
-        sparse_count = ecs_eis_count(world);
-        entities = flecs_sparse_new_ids(ecs_eis(world), count);
-    }
-
-    if (!table) {
-        return entities;
-    }
-
-    ecs_type_t type = table->type;   
-    if (!type) {
-        return entities;        
-    }
-
-    ecs_ids_t component_array = { 0 };
-    if (!component_ids) {
-        component_ids = &component_array;
-        component_array.array = ecs_vector_first(type, ecs_entity_t);
-        component_array.count = ecs_vector_count(type);
-    }
-
     ecs_data_t *data = &table->storage;
-    int32_t row = flecs_table_appendn(world, table, data, count, entities);
+    int32_t row = flecs_table_appendn(
+        world, table, data, count, entities, true);
     
     /* Update entity index. */
     int i;
@@ -5561,6 +6893,8 @@ const ecs_entity_t* new_w_data(
             });
     }
 
+    flecs_closure_entity_move(world, NULL, table, 0, diff);
+
     flecs_defer_none(world, &world->stage);
 
     flecs_notify_on_add(world, table, NULL, data, row, count, diff, 
@@ -5588,6 +6922,7 @@ const ecs_entity_t* new_w_data(
             int16_t alignment = column->alignment;
             void *ptr = ecs_vector_first_t(column->data, size, alignment);
             ptr = ECS_OFFSET(ptr, size * row);
+            src_ptr = ECS_OFFSET(src_ptr, size * offset);
 
             const ecs_type_info_t *cdata = get_c_info(world, id);
             ecs_copy_t copy;
@@ -5611,8 +6946,64 @@ const ecs_entity_t* new_w_data(
 
     flecs_defer_flush(world, &world->stage);
 
-    if (row_out) {
-        *row_out = row;
+    return row;
+}
+
+static
+const ecs_entity_t* new_w_data(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const ecs_entity_t *entities,
+    ecs_ids_t *component_ids,
+    int32_t count,
+    void **component_data,
+    bool is_move,
+    int32_t *row_out,
+    ecs_table_diff_t *diff)
+{
+    int32_t sparse_count = 0;
+    if (!entities) {
+        sparse_count = ecs_eis_count(world);
+        entities = flecs_sparse_new_ids(ecs_eis(world), count);
+    }
+
+    if (!table) {
+        return entities;
+    }
+
+    ecs_type_t type = table->type;   
+    if (!type) {
+        return entities;        
+    }
+
+    ecs_ids_t component_array = { 0 };
+    if (!component_ids) {
+        component_ids = &component_array;
+        component_array.array = ecs_vector_first(type, ecs_entity_t);
+        component_array.count = ecs_vector_count(type);
+    }
+
+    /* If the table is chunked, add the entities in as many chunks as needed */
+    int32_t offset = 0;
+    while (offset < count) {
+        int32_t n = count - offset;
+        ecs_table_t *dst_table = table;
+        if (table->chunk_capacity) {
+            dst_table = flecs_table_chunk_for_append(world, table, &n);
+        }
+
+        /* Reobtain ids, as observers may have created entities */
+        if (sparse_count && offset) {
+            entities = &flecs_sparse_ids(ecs_eis(world))[sparse_count];
+        }
+
+        int32_t row = append_w_data(world, dst_table, &entities[offset], 
+            component_ids, n, component_data, offset, is_move, diff);
+        if (row_out && !offset) {
+            *row_out = row;
+        }
+
+        offset += n;
     }
 
     if (sparse_count) {
@@ -6846,6 +8237,7 @@ void ecs_clear(
         };
 
         delete_entity(world, table, &table->storage, info.row, &diff);
+        flecs_closure_entity_move(world, table, NULL, info.row_flags, &diff);
         info.record->table = NULL;
         info.record->row = 0;
     }    
@@ -6937,6 +8329,14 @@ void remove_from_table(
             }
             flecs_table_merge(world, dst_table, src_table, 
                 &dst_table->storage, src_data);
+
+            /* Entities in the table can be pair objects */
+            if (src_table->flags & EcsTableHasClosure) {
+                flecs_closure_table_dirty(world, src_table);
+            }
+            if (dst_table->flags & EcsTableHasClosure) {
+                flecs_closure_table_dirty(world, dst_table);
+            }
         }
     }
 
@@ -7230,13 +8630,14 @@ void ecs_delete(
             table_id = table->id;
         }
 
-        if (info.row_flags) {
+        uint32_t row_flags = info.row_flags;
+        if (row_flags) {
             /* Prevent infinite recursion in case of cyclic delete actions */
             r->row &= ECS_ROW_MASK;
 
             /* Ensure that the store contains no dangling references to the
              * deleted entity (as a component, or as part of a relation) */
-            on_delete_any_w_entity(world, entity, 0, info.row_flags);
+            on_delete_any_w_entity(world, entity, 0, row_flags);
 
             /* Refetch data. In case of circular relations, the entity may have
              * moved to a different table. */
@@ -7251,7 +8652,8 @@ void ecs_delete(
 
             if (r->table) {
                 ecs_ids_t to_remove = flecs_type_to_ids(r->table->type);
-                update_component_monitors(world, entity, NULL, &to_remove);
+                update_component_monitors(
+                    world, entity, row_flags, NULL, &to_remove);
             }
         }
 
@@ -7266,6 +8668,7 @@ void ecs_delete(
             };
 
             delete_entity(world, table, info.data, info.row, &diff);
+            flecs_closure_entity_move(world, table, NULL, row_flags, &diff);
             r->table = NULL;
         }
 
@@ -7307,6 +8710,387 @@ error:
     return;
 }
 
+/* Move entities that are stored next to each other in the same table to the
+ * destination table. Entities that are not yet stored in a table are appended
+ * to the destination table. Returns the row of the first entity in the 
+ * destination table. */
+static
+int32_t bulk_move(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_table_t *src_table,
+    int32_t src_row,
+    ecs_table_t *dst_table,
+    ecs_table_diff_t *diff,
+    bool construct,
+    bool notify_on_set)
+{
+    ecs_data_t *dst_data = &dst_table->storage;
+    ecs_record_t **dst_records;
+    uint32_t all_row_flags = 0;
+    int32_t i, dst_row = 0;
+
+    if (!src_table) {
+        ecs_assert(dst_table->type != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        dst_row = flecs_table_appendn(
+            world, dst_table, dst_data, count, entities, construct);
+        dst_records = ecs_vector_first(dst_data->record_ptrs, ecs_record_t*);
+
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = ecs_eis_ensure(world, entities[i]);
+            uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+            r->table = dst_table;
+            r->row = ECS_ROW_TO_RECORD(dst_row + i, row_flags);
+            dst_records[dst_row + i] = r;
+            all_row_flags |= row_flags;
+        }
+
+        if (dst_table->flags & EcsTableHasAddActions) {
+            flecs_notify_on_add(world, dst_table, NULL, dst_data, dst_row, 
+                count, diff, notify_on_set);
+        }
+    } else {
+        ecs_data_t *src_data = &src_table->storage;
+        ecs_record_t **src_records = ecs_vector_first(
+            src_data->record_ptrs, ecs_record_t*);
+
+        if (!dst_table->type) {
+            if (src_table->flags & EcsTableHasRemoveActions) {
+                flecs_notify_on_remove(
+                    world, src_table, NULL, src_row, count, diff);
+            }
+
+            for (i = 0; i < count; i ++) {
+                ecs_record_t *r = src_records[src_row + i];
+                uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+                r->table = NULL;
+                r->row = row_flags;
+                all_row_flags |= row_flags;
+            }
+
+            flecs_table_delete_range(
+                world, src_table, src_data, src_row, count, true);
+        } else {
+            ecs_entity_t *src_entities = ecs_vector_first(
+                src_data->entities, ecs_entity_t);
+            dst_row = flecs_table_appendn(world, dst_table, dst_data, count, 
+                &src_entities[src_row], false);
+
+            flecs_notify_on_remove(
+                world, src_table, dst_table, src_row, count, diff);
+
+            flecs_table_move_range(world, dst_table, dst_data, dst_row, 
+                src_table, src_data, src_row, count, construct);
+
+            /* Update entity index & delete old data after running remove 
+             * actions */
+            dst_records = ecs_vector_first(
+                dst_data->record_ptrs, ecs_record_t*);
+            for (i = 0; i < count; i ++) {
+                ecs_record_t *r = src_records[src_row + i];
+                uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+                r->table = dst_table;
+                r->row = ECS_ROW_TO_RECORD(dst_row + i, row_flags);
+                dst_records[dst_row + i] = r;
+                all_row_flags |= row_flags;
+            }
+
+            flecs_table_delete_range(
+                world, src_table, src_data, src_row, count, false);
+
+            if (diff->added.count && 
+               (dst_table->flags & EcsTableHasAddActions)) 
+            {
+                flecs_notify_on_add(world, dst_table, src_table, dst_data, 
+                    dst_row, count, diff, notify_on_set);
+            }
+        }
+    }
+
+    flecs_closure_entity_move(
+        world, src_table, dst_table, all_row_flags, diff);
+
+    /* Update component monitors for entities that are being watched */
+    if (all_row_flags) {
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = ecs_eis_get(world, entities[i]);
+            uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+            if (row_flags) {
+                update_component_monitors(world, entities[i], row_flags, 
+                    &diff->added, &diff->removed);
+            }
+        }
+    }
+
+    return dst_row;
+}
+
+/* Copy component values for a range of entities & invoke OnSet. If move_values
+ * is set, values are moved from the pointers in the array instead. */
+static
+void bulk_assign(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_table_t *table,
+    int32_t row,
+    ecs_id_t id,
+    ecs_size_t size,
+    const void *values,
+    void **move_values)
+{
+    ecs_column_t *column = ecs_table_column_for_id(world, table, id);
+    ecs_check(column != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(column->size == size, ECS_INVALID_PARAMETER, NULL);
+
+    void *ptr = ecs_vector_get_t(column->data, size, column->alignment, row);
+    ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_entity_t real_id = ecs_get_typeid(world, id);
+    const ecs_type_info_t *cdata = get_c_info(world, real_id);
+    if (move_values) {
+        ecs_move_t move = cdata ? cdata->lifecycle.move : NULL;
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            void *dst = ECS_OFFSET(ptr, size * i);
+            if (move) {
+                move(world, real_id, &entities[i], &entities[i], dst, 
+                    move_values[i], flecs_itosize(size), 1, 
+                    cdata->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, move_values[i], size);
+            }
+        }
+    } else {
+        ecs_copy_t copy;
+        if (cdata && (copy = cdata->lifecycle.copy)) {
+            copy(world, real_id, entities, entities, ptr, values, 
+                flecs_itosize(size), count, cdata->lifecycle.ctx);
+        } else {
+            ecs_os_memcpy(ptr, values, size * count);
+        }
+    }
+
+    flecs_table_mark_rows_dirty(world, table, 
+        (int32_t)(column - table->storage.columns), row, count);
+
+    ecs_ids_t ids = { .array = &id, .count = 1 };
+    flecs_notify_on_set(world, table, row, count, &ids, true);
+error:
+    return;
+}
+
+static
+void bulk_commit(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    bool remove,
+    ecs_size_t size,
+    const void *values,
+    void **move_values)
+{
+    ecs_world_t *stage_world = world;
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    bool has_values = values || move_values;
+
+    /* If operations are deferred, enqueue an operation for each entity */
+    if (stage->defer) {
+        ecs_assert(move_values == NULL, ECS_INTERNAL_ERROR, NULL);
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            if (remove) {
+                ecs_remove_id(stage_world, entities[i], id);
+            } else if (values) {
+                ecs_set_id(stage_world, entities[i], id, flecs_itosize(size),
+                    ECS_OFFSET(values, size * i));
+            } else {
+                ecs_add_id(stage_world, entities[i], id);
+            }
+        }
+        return;
+    }
+
+    flecs_defer_none(world, stage);
+
+    ecs_table_t *root = &world->store.root;
+    int32_t i = 0;
+    while (i < count) {
+        ecs_entity_t e = entities[i];
+        ecs_check(ecs_is_valid(world, e), ECS_INVALID_PARAMETER, NULL);
+
+        ecs_record_t *r = ecs_eis_get(world, e);
+        ecs_table_t *src_table = r ? r->table : NULL;
+        int32_t src_row = src_table ? (int32_t)ECS_RECORD_TO_ROW(r->row) : 0;
+
+        /* Find entities that are stored next to each other in the same 
+         * table, or that are not stored in a table */
+        int32_t n;
+        for (n = 1; (i + n) < count; n ++) {
+            ecs_record_t *next = ecs_eis_get(world, entities[i + n]);
+            if (src_table) {
+                if (!next || next->table != src_table || 
+                    (int32_t)ECS_RECORD_TO_ROW(next->row) != (src_row + n)) 
+                {
+                    break;
+                }
+            } else {
+                if (next && next->table) {
+                    break;
+                }
+                ecs_check(ecs_is_valid(world, entities[i + n]), 
+                    ECS_INVALID_PARAMETER, NULL);
+            }
+        }
+
+        if (!src_table && world->range_check_enabled) {
+            int32_t j;
+            for (j = i; j < (i + n); j ++) {
+                ecs_check(!world->stats.max_id || 
+                    entities[j] <= world->stats.max_id, ECS_OUT_OF_RANGE, 0);
+                ecs_check(entities[j] >= world->stats.min_id, 
+                    ECS_OUT_OF_RANGE, 0);
+            }
+        }
+
+        ecs_table_diff_t diff;
+        ecs_table_t *table = src_table ? src_table : root;
+        ecs_table_t *dst_table;
+        if (remove) {
+            dst_table = flecs_table_traverse_remove(world, table, &id, &diff);
+        } else {
+            dst_table = flecs_table_traverse_add(world, table, &id, &diff);
+        }
+        ecs_check(dst_table != NULL, ECS_INVALID_PARAMETER, NULL);
+
+        /* Only move as many entities as fit in a chunk */
+        if (dst_table != table && dst_table->chunk_capacity) {
+            dst_table = flecs_table_chunk_for_append(world, dst_table, &n);
+        }
+
+        int32_t row = src_row;
+        if (dst_table != table) {
+            row = bulk_move(world, &entities[i], n, src_table, src_row, 
+                dst_table, &diff, true, !has_values);
+        } else if (src_table && (src_table->flags & EcsTableHasSwitch) &&
+            (diff.added.count || diff.removed.count))
+        {
+            ecs_components_switch(world, src_table, &src_table->storage, 
+                src_row, n, &diff.added, &diff.removed);
+        }
+
+        if (has_values && dst_table->type) {
+            bulk_assign(world, &entities[i], n, dst_table, row, id, size, 
+                values ? ECS_OFFSET(values, size * i) : NULL, 
+                move_values ? &move_values[i] : NULL);
+        }
+
+        i += n;
+    }
+
+error:
+    flecs_defer_flush(world, stage);
+}
+
+static
+void bulk_commit_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id,
+    bool remove)
+{
+    /* Collect entities before moving them, as moving entities invalidates
+     * the iterator. Entities of the same table are stored next to each other,
+     * so that each table is moved in a single operation. */
+    ecs_vector_t *entities = NULL;
+    ecs_iter_t it = ecs_filter_iter(world, filter);
+    while (ecs_filter_next(&it)) {
+        ecs_entity_t *ids = ecs_vector_addn(&entities, ecs_entity_t, it.count);
+        ecs_os_memcpy_n(ids, it.entities, ecs_entity_t, it.count);
+    }
+
+    bulk_commit(world, ecs_vector_first(entities, ecs_entity_t), 
+        ecs_vector_count(entities), id, remove, 0, NULL, NULL);
+
+    ecs_vector_free(entities);
+}
+
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || entities != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit(world, entities, count, id, false, 0, NULL, NULL);
+error:
+    return;
+}
+
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || entities != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit(world, entities, count, id, true, 0, NULL, NULL);
+error:
+    return;
+}
+
+void ecs_bulk_set_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    size_t size,
+    const void *values)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || entities != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || values != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit(world, entities, count, id, false, flecs_utosize(size), 
+        values, NULL);
+error:
+    return;
+}
+
+void ecs_bulk_add_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit_w_filter(world, filter, id, false);
+error:
+    return;
+}
+
+void ecs_bulk_remove_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit_w_filter(world, filter, id, true);
+error:
+    return;
+}
+
 ecs_entity_t ecs_clone(
     ecs_world_t *world,
     ecs_entity_t dst,
@@ -7338,15 +9122,22 @@ ecs_entity_t ecs_clone(
     ecs_type_t src_type = src_table->type;
     ecs_table_diff_t diff = {.added = flecs_type_to_ids(src_type)};
 
+    /* If the table is chunked the clone can be stored in another chunk */
+    ecs_table_t *dst_table = src_table;
+    if (dst_table->chunk_capacity) {
+        dst_table = flecs_table_chunk_for_append(world, dst_table, NULL);
+    }
+
     ecs_entity_info_t dst_info = {0};
-    dst_info.row = new_entity(world, dst, &dst_info, src_table, &diff, 
+    dst_info.row = new_entity(world, dst, &dst_info, dst_table, &diff, 
         true, true);
+    flecs_closure_entity_move(world, NULL, dst_table, 0, &diff);
 
     if (copy_value) {
-        flecs_table_move(world, dst, src, src_table, dst_info.data, 
+        flecs_table_move(world, dst, src, dst_table, dst_info.data, 
             dst_info.row, src_table, src_info.data, src_info.row, true);
 
-        flecs_notify_on_set(world, src_table, dst_info.row, 1, NULL, true);
+        flecs_notify_on_set(world, dst_table, dst_info.row, 1, NULL, true);
     }
 
 done:
@@ -7576,7 +9367,7 @@ void ecs_modified_id(
         flecs_notify_on_set(world, info.table, info.row, 1, &ids, true);
     }
 
-    flecs_table_mark_dirty(world, info.table, id);
+    flecs_table_mark_dirty(world, info.table, id, info.row);
     flecs_defer_flush(world, stage);
 error:
     return;
@@ -7641,7 +9432,7 @@ ecs_entity_t assign_ptr_w_id(
         memset(dst, 0, size);
     }
 
-    flecs_table_mark_dirty(world, info.table, id);
+    flecs_table_mark_dirty(world, info.table, id, info.row);
 
     if (notify) {
         ecs_ids_t ids = { .array = &id, .count = 1 };
@@ -8497,14 +10288,13 @@ void flush_bulk_new(
 {
     ecs_entity_t *entities = op->is._n.entities;
 
+    /* Entities are not yet stored in a table, so they can be moved to the
+     * destination table with a single operation, which emits OnAdd once for 
+     * the entire range instead of for each entity. */
     if (op->id) {
-        int i, count = op->is._n.count;
-        for (i = 0; i < count; i ++) {
-            add_id(world, entities[i], op->id);
-        }
+        bulk_commit(world, entities, op->is._n.count, op->id, false, 0, NULL,
+            NULL);
     }
-
-    ecs_os_free(entities);
 }
 
 static
@@ -8539,10 +10329,7 @@ void discard_op(
         void *value = op->is._1.value;
         if (value) {
             free_value(world, &op->is._1.entity, op->id, op->is._1.value, 1);
-            ecs_os_free(value);
         }
-    } else {
-        ecs_os_free(op->is._n.entities);
     }
 }
 
@@ -8609,6 +10396,427 @@ bool remove_invalid(
     return true;
 }
 
+static
+bool is_add_op(
+    ecs_defer_op_t *op)
+{
+    return op->kind == EcsOpNew || op->kind == EcsOpAdd;
+}
+
+/* Apply a sequence of add or remove operations for the same entity with a 
+ * single table move, instead of moving the entity for each operation. Returns
+ * the number of operations that were consumed from the queue. */
+static
+int32_t flush_add_remove(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    ecs_entity_t e = ops[0].is._1.entity;
+    bool is_add = is_add_op(&ops[0]);
+
+    ecs_entity_info_t info;
+    flecs_get_info(world, e, &info);
+
+    ecs_table_t *table = info.table;
+    ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+    bool deleted = false;
+    int32_t i;
+
+    for (i = 0; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        if (op->is._1.entity != e) {
+            break;
+        }
+
+        if (is_add) {
+            if (!is_add_op(op)) {
+                break;
+            }
+
+            ecs_assert(op->id != 0, ECS_INTERNAL_ERROR, NULL);
+            if (!remove_invalid(world, &op->id)) {
+                if (!i) {
+                    /* Entity should be deleted */
+                    ecs_delete(world, e);
+                    deleted = true;
+                    i ++;
+                }
+
+                /* Apply collected operations before the entity is deleted */
+                break;
+            }
+
+            if (op->id) {
+                world->add_count ++;
+                table = table_append(world, table, op->id, &diff);
+            }
+        } else {
+            if (op->kind != EcsOpRemove) {
+                break;
+            }
+
+            table = table_remove(world, table, op->id, &diff);
+        }
+    }
+
+    if (!deleted) {
+        flecs_defer_none(world, stage);
+        commit(world, e, &info, table, &diff, true, true);
+        flecs_defer_flush(world, stage);
+    }
+
+    diff_free(&diff);
+
+    return i;
+}
+
+/* Count operations that apply the same add, remove or set to different
+ * entities, like the operations that are enqueued when adding a component to
+ * all entities of a query while deferred. */
+static
+int32_t batch_count(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_defer_op_t *first = &ops[0];
+    bool is_add = is_add_op(first);
+    int32_t i;
+
+    for (i = 1; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        if (op->id != first->id) {
+            break;
+        }
+
+        if (is_add) {
+            if (!is_add_op(op)) {
+                break;
+            }
+        } else if (op->kind != first->kind) {
+            break;
+        }
+
+        ecs_entity_t e = op->is._1.entity;
+        if (e == ops[i - 1].is._1.entity) {
+            break;
+        }
+
+        /* Operations for deleted entities are discarded by the flush */
+        if (!ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            break;
+        }
+    }
+
+    /* If the next operation is for the last entity, leave it to
+     * flush_add_remove so that both are applied with a single commit */
+    if (i < count && ops[i].is._1.entity == ops[i - 1].is._1.entity) {
+        i --;
+    }
+
+    return i;
+}
+
+/* Apply a sequence of operations that add, remove or set the same id for 
+ * different entities with a single bulk operation. Entities that are stored
+ * next to each other are moved together, and observers are notified once for 
+ * each table range. Returns the number of operations that were consumed from 
+ * the queue, or 0 if the operations should be applied one by one. */
+static
+int32_t flush_batch(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    int32_t i, n = batch_count(world, ops, count);
+    if (n < 2) {
+        return 0;
+    }
+
+    ecs_id_t id = ops[0].id;
+    bool remove = ops[0].kind == EcsOpRemove;
+    bool set = ops[0].kind == EcsOpSet;
+    ecs_size_t size = 0;
+    void **values = NULL;
+
+    if (is_add_op(&ops[0])) {
+        ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
+        if (!remove_invalid(world, &id)) {
+            /* Entities should be deleted, which is done for each operation */
+            return 0;
+        }
+
+        if (!id) {
+            /* Id is no longer valid, ignore the operations */
+            return n;
+        }
+
+        world->add_count += n;
+    }
+
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, n);
+    for (i = 0; i < n; i ++) {
+        entities[i] = ops[i].is._1.entity;
+    }
+
+    if (set) {
+        /* Values are moved from where they are stored in the queue, the same 
+         * as when the operations are applied one by one. Values can't be 
+         * copied to a contiguous array, as components are not guaranteed to 
+         * be trivially relocatable. */
+        size = ops[0].is._1.size;
+        values = ecs_os_malloc_n(void*, n);
+        for (i = 0; i < n; i ++) {
+            ecs_assert(ops[i].is._1.size == size, ECS_INTERNAL_ERROR, NULL);
+            values[i] = ops[i].is._1.value;
+        }
+    }
+
+    bulk_commit(world, entities, n, id, remove, size, NULL, values);
+
+    ecs_os_free(values);
+    ecs_os_free(entities);
+
+    return n;
+}
+
+/* Count operations of a sequence of add or remove operations for the same
+ * entity, which flush_add_remove applies with a single table move. */
+static
+int32_t add_remove_count(
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_entity_t e = ops[0].is._1.entity;
+    bool is_add = is_add_op(&ops[0]);
+    int32_t i;
+
+    for (i = 1; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        if (op->is._1.entity != e) {
+            break;
+        }
+        if (is_add ? !is_add_op(op) : (op->kind != EcsOpRemove)) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/* Apply sequences of add or remove operations for different entities that add
+ * or remove the same ids with a single bulk operation. Queues that are sorted
+ * by entity contain such sequences, for example when a stage added a tag to the
+ * entities of a table and another stage added a different tag to the same 
+ * entities. Returns the number of operations that were consumed from the 
+ * queue, or 0 if the operations should be applied one entity at a time. */
+static
+int32_t flush_add_remove_batch(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    int32_t i, n = add_remove_count(ops, count);
+    if (n < 2) {
+        /* Single operations are batched by flush_batch */
+        return 0;
+    }
+
+    ecs_record_t *r = ecs_eis_get(world, ops[0].is._1.entity);
+    ecs_table_t *src_table = r ? r->table : NULL;
+    int32_t src_row = src_table ? (int32_t)ECS_RECORD_TO_ROW(r->row) : 0;
+
+    /* Find entities with the same sequence of operations that are stored next
+     * to each other in the same table, or that are not stored in a table */
+    int32_t entity_count;
+    for (entity_count = 1; (entity_count + 1) * n <= count; entity_count ++) {
+        ecs_defer_op_t *first = &ops[entity_count * n];
+        ecs_entity_t e = first->is._1.entity;
+        if (e == first[-1].is._1.entity) {
+            break;
+        }
+
+        if (add_remove_count(first, count - entity_count * n) != n) {
+            break;
+        }
+
+        for (i = 0; i < n; i ++) {
+            if (first[i].kind != ops[i].kind || first[i].id != ops[i].id) {
+                break;
+            }
+        }
+        if (i != n) {
+            break;
+        }
+
+        /* Operations for deleted entities are discarded by the flush */
+        if (!ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            break;
+        }
+
+        ecs_record_t *next = ecs_eis_get(world, e);
+        if (src_table) {
+            if (!next || next->table != src_table || 
+                (int32_t)ECS_RECORD_TO_ROW(next->row) != 
+                    (src_row + entity_count)) 
+            {
+                break;
+            }
+        } else if (next && next->table) {
+            break;
+        }
+    }
+
+    if (entity_count < 2) {
+        return 0;
+    }
+
+    ecs_table_t *table = src_table ? src_table : &world->store.root;
+    ecs_table_t *dst_table = table;
+    ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+    bool is_add = is_add_op(&ops[0]);
+    int32_t add_count = 0;
+
+    for (i = 0; i < n; i ++) {
+        ecs_id_t id = ops[i].id;
+        if (is_add) {
+            ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
+            if (!remove_invalid(world, &id)) {
+                /* Entities should be deleted, which is done for each entity */
+                diff_free(&diff);
+                return 0;
+            }
+
+            if (id) {
+                add_count ++;
+                dst_table = table_append(world, dst_table, id, &diff);
+            }
+        } else {
+            dst_table = table_remove(world, dst_table, id, &diff);
+        }
+    }
+
+    /* Only move as many entities as fit in a chunk */
+    if (dst_table != table && dst_table->chunk_capacity) {
+        dst_table = flecs_table_chunk_for_append(
+            world, dst_table, &entity_count);
+    }
+
+    world->add_count += add_count * entity_count;
+
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, entity_count);
+    for (i = 0; i < entity_count; i ++) {
+        entities[i] = ops[i * n].is._1.entity;
+    }
+
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    flecs_defer_none(world, stage);
+
+    if (dst_table != table) {
+        bulk_move(world, entities, entity_count, src_table, src_row, 
+            dst_table, &diff, true, true);
+    } else if (src_table && (src_table->flags & EcsTableHasSwitch) &&
+        (diff.added.count || diff.removed.count))
+    {
+        ecs_components_switch(world, src_table, &src_table->storage, 
+            src_row, entity_count, &diff.added, &diff.removed);
+    }
+
+    flecs_defer_flush(world, stage);
+
+    ecs_os_free(entities);
+    diff_free(&diff);
+
+    return entity_count * n;
+}
+
+/* Apply deferred commands */
+static
+void flush_ops(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        ecs_entity_t e = op->is._1.entity;
+        if (op->kind == EcsOpBulkNew) {
+            e = 0;
+        }
+
+        /* If entity is no longer alive, this could be because the queue
+         * contained both a delete and a subsequent add/remove/set which
+         * should be ignored. */
+        if (e && !ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            ecs_assert(op->kind != EcsOpNew && op->kind != EcsOpClone, 
+                ECS_INTERNAL_ERROR, NULL);
+            world->discard_count ++;
+            discard_op(world, op);
+            continue;
+        }
+
+        switch(op->kind) {
+        case EcsOpNew:
+        case EcsOpAdd:
+        case EcsOpRemove: {
+            int32_t n = flush_batch(world, op, count - i);
+            if (!n) {
+                n = flush_add_remove_batch(world, op, count - i);
+            }
+            if (!n) {
+                n = flush_add_remove(world, op, count - i);
+            }
+            i += n - 1;
+            break;
+        }
+        case EcsOpClone:
+            ecs_clone(world, e, op->id, op->is._1.clone_value);
+            break;
+        case EcsOpSet: {
+            int32_t n = flush_batch(world, op, count - i);
+            if (n) {
+                i += n - 1;
+                break;
+            }
+            assign_ptr_w_id(world, e, 
+                op->id, flecs_itosize(op->is._1.size), 
+                op->is._1.value, true, true);
+            break;
+        }
+        case EcsOpMut:
+            assign_ptr_w_id(world, e, 
+                op->id, flecs_itosize(op->is._1.size), 
+                op->is._1.value, true, false);
+            break;
+        case EcsOpModified:
+            ecs_modified_id(world, e, op->id);
+            break;
+        case EcsOpDelete: {
+            ecs_delete(world, e);
+            break;
+        }
+        case EcsOpClear:
+            ecs_clear(world, e);
+            break;
+        case EcsOpOnDeleteAction:
+            on_delete_action(world, op->id, e);
+            break;
+        case EcsOpEnable:
+            ecs_enable_component_w_id(world, e, op->id, true);
+            break;
+        case EcsOpDisable:
+            ecs_enable_component_w_id(world, e, op->id, false);
+            break;
+        case EcsOpBulkNew:
+            flush_bulk_new(world, op);
+            continue;
+        }
+    }
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool flecs_defer_flush(
     ecs_world_t *world,
@@ -8627,88 +10835,25 @@ bool flecs_defer_flush(
 
         if (defer_queue) {
             ecs_defer_op_t *ops = ecs_vector_first(defer_queue, ecs_defer_op_t);
-            int32_t i, count = ecs_vector_count(defer_queue);
+            int32_t count = ecs_vector_count(defer_queue);
+
+            /* Values of the queue are stored in the stage stack. Values for
+             * commands that are enqueued while processing the queue are 
+             * allocated after the current top, so the memory of the queue
+             * that's being processed remains valid until it is done. */
+            ecs_stack_cursor_t defer_cursor = stage->defer_cursor;
+            stage->defer_cursor = flecs_stack_get_cursor(&stage->defer_stack);
             
-            for (i = 0; i < count; i ++) {
-                ecs_defer_op_t *op = &ops[i];
-                ecs_entity_t e = op->is._1.entity;
-                if (op->kind == EcsOpBulkNew) {
-                    e = 0;
-                }
-
-                /* If entity is no longer alive, this could be because the queue
-                 * contained both a delete and a subsequent add/remove/set which
-                 * should be ignored. */
-                if (e && !ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
-                    ecs_assert(op->kind != EcsOpNew && op->kind != EcsOpClone, 
-                        ECS_INTERNAL_ERROR, NULL);
-                    world->discard_count ++;
-                    discard_op(world, op);
-                    continue;
-                }
-
-                switch(op->kind) {
-                case EcsOpNew:
-                case EcsOpAdd:
-                    ecs_assert(op->id != 0, ECS_INTERNAL_ERROR, NULL);
-                    if (remove_invalid(world, &op->id)) {
-                        if (op->id) {
-                            world->add_count ++;
-                            add_id(world, e, op->id);
-                        }
-                    } else {
-                        ecs_delete(world, e);
-                    }
-                    break;
-                case EcsOpRemove:
-                    remove_id(world, e, op->id);
-                    break;
-                case EcsOpClone:
-                    ecs_clone(world, e, op->id, op->is._1.clone_value);
-                    break;
-                case EcsOpSet:
-                    assign_ptr_w_id(world, e, 
-                        op->id, flecs_itosize(op->is._1.size), 
-                        op->is._1.value, true, true);
-                    break;
-                case EcsOpMut:
-                    assign_ptr_w_id(world, e, 
-                        op->id, flecs_itosize(op->is._1.size), 
-                        op->is._1.value, true, false);
-                    break;
-                case EcsOpModified:
-                    ecs_modified_id(world, e, op->id);
-                    break;
-                case EcsOpDelete: {
-                    ecs_delete(world, e);
-                    break;
-                }
-                case EcsOpClear:
-                    ecs_clear(world, e);
-                    break;
-                case EcsOpOnDeleteAction:
-                    on_delete_action(world, op->id, e);
-                    break;
-                case EcsOpEnable:
-                    ecs_enable_component_w_id(world, e, op->id, true);
-                    break;
-                case EcsOpDisable:
-                    ecs_enable_component_w_id(world, e, op->id, false);
-                    break;
-                case EcsOpBulkNew:
-                    flush_bulk_new(world, op);
-                    continue;
-                }
-
-                if (op->is._1.value) {
-                    ecs_os_free(op->is._1.value);
-                }                  
-            }
+            flush_ops(world, ops, count);
 
             if (stage->defer_queue) {
                 ecs_vector_free(stage->defer_queue);
             }
 
+            /* Release memory of values for processed queue */
+            flecs_stack_restore_cursor(&stage->defer_stack, defer_cursor);
+            stage->defer_cursor = defer_cursor;
+
             /* Restore defer queue */
             ecs_vector_clear(defer_queue);
             stage->defer_queue = defer_queue;
@@ -8721,6 +10866,85 @@ error:
     return false;
 }
 
+/* Leave safe section of multiple stages. The command queues of the stages must
+ * be sorted by entity (see flecs_defer_sort), and are merged into a single 
+ * queue that is applied at once. Commands for the same entity are applied in
+ * stage order, so that the result does not depend on which stage enqueued a
+ * command first. */
+void flecs_defer_flush_stages(
+    ecs_world_t *world,
+    ecs_stage_t **stages,
+    int32_t count)
+{
+    ecs_vector_t **queues = ecs_os_malloc_n(ecs_vector_t*, count);
+    ecs_stack_cursor_t *cursors = ecs_os_malloc_n(ecs_stack_cursor_t, count);
+    int32_t *heads = ecs_os_calloc_n(int32_t, count);
+    int32_t i, op_count = 0;
+
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *stage = stages[i];
+        ecs_assert(stage->defer == 1, ECS_INTERNAL_ERROR, NULL);
+        stage->defer --;
+
+        /* Same as flecs_defer_flush, values of the queues must remain valid
+         * until all queues are processed. */
+        queues[i] = stage->defer_queue;
+        stage->defer_queue = NULL;
+        cursors[i] = stage->defer_cursor;
+        stage->defer_cursor = flecs_stack_get_cursor(&stage->defer_stack);
+        op_count += ecs_vector_count(queues[i]);
+    }
+
+    if (op_count) {
+        ecs_defer_op_t *ops = ecs_os_malloc_n(ecs_defer_op_t, op_count);
+        int32_t op;
+
+        for (op = 0; op < op_count; op ++) {
+            ecs_defer_op_t *next = NULL;
+            int32_t next_stage = 0;
+
+            /* Take the command with the lowest entity. For equal entities the 
+             * command from the first stage is taken. */
+            for (i = 0; i < count; i ++) {
+                if (heads[i] == ecs_vector_count(queues[i])) {
+                    continue;
+                }
+
+                ecs_defer_op_t *head = ecs_vector_get(
+                    queues[i], ecs_defer_op_t, heads[i]);
+                if (!next || head->is._1.entity < next->is._1.entity) {
+                    next = head;
+                    next_stage = i;
+                }
+            }
+
+            ecs_assert(next != NULL, ECS_INTERNAL_ERROR, NULL);
+            ops[op] = *next;
+            heads[next_stage] ++;
+        }
+
+        flush_ops(world, ops, op_count);
+        ecs_os_free(ops);
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *stage = stages[i];
+        if (stage->defer_queue) {
+            ecs_vector_free(stage->defer_queue);
+        }
+
+        flecs_stack_restore_cursor(&stage->defer_stack, cursors[i]);
+        stage->defer_cursor = cursors[i];
+
+        ecs_vector_clear(queues[i]);
+        stage->defer_queue = queues[i];
+    }
+
+    ecs_os_free(heads);
+    ecs_os_free(cursors);
+    ecs_os_free(queues);
+}
+
 /* Delete operations from queue without executing them. */
 bool flecs_defer_purge(
     ecs_world_t *world,
@@ -8744,6 +10968,9 @@ bool flecs_defer_purge(
                 ecs_vector_free(stage->defer_queue);
             }
 
+            flecs_stack_restore_cursor(&stage->defer_stack, 
+                stage->defer_cursor);
+
             /* Restore defer queue */
             ecs_vector_clear(defer_queue);
             stage->defer_queue = defer_queue;
@@ -8798,6 +11025,138 @@ bool defer_add_remove(
     return false;
 }
 
+/* Commands that only modify the entity they were enqueued for. Applying these
+ * commands for different entities in a different order has the same result. */
+static
+bool defer_op_is_local(
+    ecs_defer_op_t *op)
+{
+    switch(op->kind) {
+    case EcsOpNew:
+    case EcsOpAdd:
+    case EcsOpRemove:
+    case EcsOpSet:
+    case EcsOpMut:
+    case EcsOpModified:
+    case EcsOpEnable:
+    case EcsOpDisable:
+        /* Adding an IsA pair copies components from the base */
+        return !ECS_HAS_RELATION(op->id, EcsIsA);
+    default:
+        return false;
+    }
+}
+
+/* Stable merge sort of commands by entity */
+static
+void defer_sort_ops(
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_defer_op_t *buffer = ecs_os_malloc_n(ecs_defer_op_t, count);
+    ecs_defer_op_t *src = ops, *dst = buffer;
+    int32_t width;
+
+    for (width = 1; width < count; width *= 2) {
+        int32_t start;
+        for (start = 0; start < count; start += 2 * width) {
+            int32_t mid = ECS_MIN(start + width, count);
+            int32_t end = ECS_MIN(start + 2 * width, count);
+            int32_t l = start, r = mid, i = start;
+
+            while (l < mid && r < end) {
+                if (src[r].is._1.entity < src[l].is._1.entity) {
+                    dst[i ++] = src[r ++];
+                } else {
+                    dst[i ++] = src[l ++];
+                }
+            }
+            while (l < mid) {
+                dst[i ++] = src[l ++];
+            }
+            while (r < end) {
+                dst[i ++] = src[r ++];
+            }
+        }
+
+        ecs_defer_op_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != ops) {
+        ecs_os_memcpy_n(ops, src, ecs_defer_op_t, count);
+    }
+
+    ecs_os_free(buffer);
+}
+
+/* Sort command queue of stage by entity. Returns false if the queue contains
+ * commands that can't be reordered, in which case the queue is not modified. */
+bool flecs_defer_sort(
+    ecs_stage_t *stage)
+{
+    ecs_defer_op_t *ops = ecs_vector_first(stage->defer_queue, ecs_defer_op_t);
+    int32_t i, count = ecs_vector_count(stage->defer_queue);
+    bool is_sorted = true;
+
+    for (i = 0; i < count; i ++) {
+        if (!defer_op_is_local(&ops[i])) {
+            return false;
+        }
+        if (i && ops[i].is._1.entity < ops[i - 1].is._1.entity) {
+            is_sorted = false;
+        }
+    }
+
+    if (!is_sorted) {
+        defer_sort_ops(ops, count);
+    }
+
+    return true;
+}
+
+/* Merge stages in entity order. Returns false if the stages can't be merged in
+ * entity order, in which case they should be merged one at a time. */
+static
+bool merge_stages_by_entity(
+    ecs_world_t *world,
+    bool force_merge)
+{
+    int32_t i, merge_count = 0, count = ecs_get_stage_count(world);
+    if (count < 2) {
+        return false;
+    }
+
+    ecs_stage_t **stages = ecs_os_malloc_n(ecs_stage_t*, count);
+    bool result = true;
+
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *s = (ecs_stage_t*)ecs_get_stage(world, i);
+        ecs_poly_assert(s, ecs_stage_t);
+        if (!force_merge && !s->auto_merge) {
+            continue;
+        }
+
+        /* Queues are usually already sorted by the worker threads, in which
+         * case this only checks whether the queue is sorted. */
+        if (s->defer != 1 || !flecs_defer_sort(s)) {
+            result = false;
+            break;
+        }
+
+        stages[merge_count ++] = s;
+    }
+
+    if (result) {
+        flecs_defer_flush_stages(world, stages, merge_count);
+    }
+
+    ecs_os_free(stages);
+
+    return result;
+}
+
 static
 void merge_stages(
     ecs_world_t *world,
@@ -8821,14 +11180,28 @@ void merge_stages(
             ecs_defer_end((ecs_world_t*)stage);
         }
     } else {
-        /* Merge stages. Only merge if the stage has auto_merging turned on, or 
-         * if this is a forced merge (like when ecs_merge is called) */
-        int32_t i, count = ecs_get_stage_count(world);
-        for (i = 0; i < count; i ++) {
-            ecs_stage_t *s = (ecs_stage_t*)ecs_get_stage(world, i);
-            ecs_poly_assert(s, ecs_stage_t);
-            if (force_merge || s->auto_merge) {
-                ecs_defer_end((ecs_world_t*)s);
+        /* Merge stages. Only merge if the stage has auto_merging turned on, or
+         * if this is a forced merge (like when ecs_merge is called)
+         *
+         * Stages are merged one at a time in stage order. Applying commands
+         * moves entities between tables, creates tables and invokes
+         * observers, none of which can safely run on multiple threads. This
+         * also guarantees that observers are notified in a deterministic
+         * order, regardless of how systems were distributed over workers.
+         *
+         * When merging in entity order, the queues of all stages are merged
+         * into a single queue that is applied at once. This lets commands for
+         * the same entity from different stages share a table move. */
+        if (!world->merge_by_entity || 
+            !merge_stages_by_entity(world, force_merge)) 
+        {
+            int32_t i, count = ecs_get_stage_count(world);
+            for (i = 0; i < count; i ++) {
+                ecs_stage_t *s = (ecs_stage_t*)ecs_get_stage(world, i);
+                ecs_poly_assert(s, ecs_stage_t);
+                if (force_merge || s->auto_merge) {
+                    ecs_defer_end((ecs_world_t*)s);
+                }
             }
         }
     }
@@ -8995,7 +11368,8 @@ bool flecs_defer_bulk_new(
     const ecs_entity_t **ids_out)
 {
     if (stage->defer) {
-        ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+        ecs_entity_t *ids = flecs_stack_alloc(&stage->defer_stack, 
+            count * ECS_SIZEOF(ecs_entity_t), ECS_ALIGNOF(ecs_entity_t));
         world->bulk_new_count ++;
 
         /* Use ecs_new_id as this is thread safe */
@@ -9072,7 +11446,7 @@ bool flecs_defer_set(
         op->id = id;
         op->is._1.entity = entity;
         op->is._1.size = size;
-        op->is._1.value = ecs_os_malloc(size);
+        op->is._1.value = flecs_stack_alloc(&stage->defer_stack, size, 16);
 
         if (!value) {
             value = ecs_get_id(world, entity, id);
@@ -9142,6 +11516,9 @@ void flecs_stage_init(
     stage->thread_ctx = world;
     stage->auto_merge = true;
     stage->asynchronous = false;
+
+    flecs_stack_init(&stage->defer_stack);
+    flecs_stack_init(&stage->frame_stack);
 }
 
 void flecs_stage_deinit(
@@ -9159,6 +11536,8 @@ void flecs_stage_deinit(
     ecs_poly_fini(stage, ecs_stage_t);
 
     ecs_vector_free(stage->defer_queue);
+    flecs_stack_fini(&stage->defer_stack);
+    flecs_stack_fini(&stage->frame_stack);
 }
 
 void ecs_set_stages(
@@ -9333,6 +11712,14 @@ void ecs_set_automerge(
     }
 }
 
+void ecs_set_merge_by_entity(
+    ecs_world_t *world,
+    bool merge_by_entity)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    world->merge_by_entity = merge_by_entity;
+}
+
 bool ecs_stage_is_readonly(
     const ecs_world_t *stage)
 {
@@ -9421,26 +11808,29 @@ struct ecs_vector_t {
 /** Resize the vector buffer */
 static
 ecs_vector_t* resize(
+    ecs_allocator_t *a,
     ecs_vector_t *vector,
     int16_t offset,
+    int32_t old_size,
     int32_t size)
 {
-    ecs_vector_t *result = ecs_os_realloc(vector, offset + size);
+    ecs_vector_t *result = flecs_realloc(a, offset + size, offset + old_size, 
+        vector);
     ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
     return result;
 }
 
-/* -- Public functions -- */
+/* -- Allocator functions -- */
 
-ecs_vector_t* _ecs_vector_new(
+ecs_vector_t* _flecs_vector_new(
+    ecs_allocator_t *a,
     ecs_size_t elem_size,
     int16_t offset,
     int32_t elem_count)
 {
     ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
     
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
+    ecs_vector_t *result = flecs_alloc(a, offset + elem_size * elem_count);
     ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
 
     result->count = 0;
@@ -9451,63 +11841,20 @@ ecs_vector_t* _ecs_vector_new(
     return result;
 }
 
-ecs_vector_t* _ecs_vector_from_array(
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count,
-    void *array)
-{
-    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
-    
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
-
-    ecs_os_memcpy(ECS_OFFSET(result, offset), array, elem_size * elem_count);
-
-    result->count = elem_count;
-    result->size = elem_count;
-#ifndef NDEBUG
-    result->elem_size = elem_size;
-#endif
-    return result;   
-}
-
-void ecs_vector_free(
-    ecs_vector_t *vector)
-{
-    ecs_os_free(vector);
-}
-
-void ecs_vector_clear(
-    ecs_vector_t *vector)
-{
-    if (vector) {
-        vector->count = 0;
-    }
-}
-
-void _ecs_vector_zero(
+void _flecs_vector_free(
+    ecs_allocator_t *a,
     ecs_vector_t *vector,
     ecs_size_t elem_size,
     int16_t offset)
 {
-    void *array = ECS_OFFSET(vector, offset);
-    ecs_os_memset(array, 0, elem_size * vector->count);
-}
-
-void ecs_vector_assert_size(
-    ecs_vector_t *vector,
-    ecs_size_t elem_size)
-{
-    (void)elem_size;
-    
     if (vector) {
         ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+        flecs_free(a, offset + elem_size * vector->size, vector);
     }
 }
 
-void* _ecs_vector_addn(
+void* _flecs_vector_addn(
+    ecs_allocator_t *a,
     ecs_vector_t **array_inout,
     ecs_size_t elem_size,
     int16_t offset,
@@ -9516,12 +11863,12 @@ void* _ecs_vector_addn(
     ecs_assert(array_inout != NULL, ECS_INTERNAL_ERROR, NULL);
     
     if (elem_count == 1) {
-        return _ecs_vector_add(array_inout, elem_size, offset);
+        return _flecs_vector_add(a, array_inout, elem_size, offset);
     }
     
     ecs_vector_t *vector = *array_inout;
     if (!vector) {
-        vector = _ecs_vector_new(elem_size, offset, 1);
+        vector = _flecs_vector_new(a, elem_size, offset, 1);
         *array_inout = vector;
     }
 
@@ -9540,7 +11887,8 @@ void* _ecs_vector_addn(
             }
         }
 
-        vector = resize(vector, offset, max_count * elem_size);
+        vector = resize(a, vector, offset, vector->size * elem_size, 
+            max_count * elem_size);
         vector->size = max_count;
         *array_inout = vector;
     }
@@ -9550,7 +11898,8 @@ void* _ecs_vector_addn(
     return ECS_OFFSET(vector, offset + elem_size * old_count);
 }
 
-void* _ecs_vector_add(
+void* _flecs_vector_add(
+    ecs_allocator_t *a,
     ecs_vector_t **array_inout,
     ecs_size_t elem_size,
     int16_t offset)
@@ -9569,7 +11918,8 @@ void* _ecs_vector_add(
             if (!size) {
                 size = 2;
             }
-            vector = resize(vector, offset, size * elem_size);
+            vector = resize(a, vector, offset, vector->size * elem_size, 
+                size * elem_size);
             *array_inout = vector;
             vector->size = size;
         }
@@ -9578,13 +11928,164 @@ void* _ecs_vector_add(
         return ECS_OFFSET(vector, offset + elem_size * count);
     }
 
-    vector = _ecs_vector_new(elem_size, offset, 2);
+    vector = _flecs_vector_new(a, elem_size, offset, 2);
     *array_inout = vector;
     vector->count = 1;
     vector->size = 2;
     return ECS_OFFSET(vector, offset);
 }
 
+int32_t _flecs_vector_set_size(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    ecs_vector_t *vector = *array_inout;
+
+    if (!vector) {
+        *array_inout = _flecs_vector_new(a, elem_size, offset, elem_count);
+        return elem_count;
+    } else {
+        ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+        int32_t result = vector->size;
+
+        if (elem_count < vector->count) {
+            elem_count = vector->count;
+        }
+
+        if (result < elem_count) {
+            elem_count = flecs_next_pow_of_2(elem_count);
+            vector = resize(a, vector, offset, result * elem_size, 
+                elem_count * elem_size);
+            vector->size = elem_count;
+            *array_inout = vector;
+            result = elem_count;
+        }
+
+        return result;
+    }
+}
+
+int32_t _flecs_vector_set_count(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    if (!*array_inout) {
+        *array_inout = _flecs_vector_new(a, elem_size, offset, elem_count);
+    }
+
+    ecs_dbg_assert((*array_inout)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+    (*array_inout)->count = elem_count;
+    ecs_size_t size = _flecs_vector_set_size(
+        a, array_inout, elem_size, offset, elem_count);
+    return size;
+}
+
+ecs_vector_t* _flecs_vector_copy(
+    ecs_allocator_t *a,
+    const ecs_vector_t *src,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    if (!src) {
+        return NULL;
+    }
+
+    ecs_vector_t *dst = _flecs_vector_new(a, elem_size, offset, src->size);
+    ecs_os_memcpy(dst, src, offset + elem_size * src->count);
+    return dst;
+}
+
+/* -- Public functions -- */
+
+ecs_vector_t* _ecs_vector_new(
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    return _flecs_vector_new(NULL, elem_size, offset, elem_count);
+}
+
+ecs_vector_t* _ecs_vector_from_array(
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count,
+    void *array)
+{
+    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
+    
+    ecs_vector_t *result =
+        ecs_os_malloc(offset + elem_size * elem_count);
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    ecs_os_memcpy(ECS_OFFSET(result, offset), array, elem_size * elem_count);
+
+    result->count = elem_count;
+    result->size = elem_count;
+#ifndef NDEBUG
+    result->elem_size = elem_size;
+#endif
+    return result;   
+}
+
+void ecs_vector_free(
+    ecs_vector_t *vector)
+{
+    ecs_os_free(vector);
+}
+
+void ecs_vector_clear(
+    ecs_vector_t *vector)
+{
+    if (vector) {
+        vector->count = 0;
+    }
+}
+
+void _ecs_vector_zero(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    void *array = ECS_OFFSET(vector, offset);
+    ecs_os_memset(array, 0, elem_size * vector->count);
+}
+
+void ecs_vector_assert_size(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size)
+{
+    (void)elem_size;
+    
+    if (vector) {
+        ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+void* _ecs_vector_addn(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    return _flecs_vector_addn(NULL, array_inout, elem_size, offset, elem_count);
+}
+
+void* _ecs_vector_add(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    return _flecs_vector_add(NULL, array_inout, elem_size, offset);
+}
+
 void* _ecs_vector_insert_at(
     ecs_vector_t **vec,
     ecs_size_t elem_size,
@@ -9701,7 +12202,8 @@ void _ecs_vector_reclaim(
 
     if (count < size) {
         size = count;
-        vector = resize(vector, offset, size * elem_size);
+        vector = resize(NULL, vector, offset, vector->size * elem_size, 
+            size * elem_size);
         vector->size = size;
         *array_inout = vector;
     }
@@ -9731,30 +12233,8 @@ int32_t _ecs_vector_set_size(
     int16_t offset,
     int32_t elem_count)
 {
-    ecs_vector_t *vector = *array_inout;
-
-    if (!vector) {
-        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
-        return elem_count;
-    } else {
-        ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-
-        int32_t result = vector->size;
-
-        if (elem_count < vector->count) {
-            elem_count = vector->count;
-        }
-
-        if (result < elem_count) {
-            elem_count = flecs_next_pow_of_2(elem_count);
-            vector = resize(vector, offset, elem_count * elem_size);
-            vector->size = elem_count;
-            *array_inout = vector;
-            result = elem_count;
-        }
-
-        return result;
-    }
+    return _flecs_vector_set_size(
+        NULL, array_inout, elem_size, offset, elem_count);
 }
 
 int32_t _ecs_vector_grow(
@@ -9773,15 +12253,8 @@ int32_t _ecs_vector_set_count(
     int16_t offset,
     int32_t elem_count)
 {
-    if (!*array_inout) {
-        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
-    }
-
-    ecs_dbg_assert((*array_inout)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-
-    (*array_inout)->count = elem_count;
-    ecs_size_t size = _ecs_vector_set_size(array_inout, elem_size, offset, elem_count);
-    return size;
+    return _flecs_vector_set_count(
+        NULL, array_inout, elem_size, offset, elem_count);
 }
 
 void* _ecs_vector_first(
@@ -9906,13 +12379,7 @@ ecs_vector_t* _ecs_vector_copy(
     ecs_size_t elem_size,
     int16_t offset)
 {
-    if (!src) {
-        return NULL;
-    }
-
-    ecs_vector_t *dst = _ecs_vector_new(elem_size, offset, src->size);
-    ecs_os_memcpy(dst, src, offset + elem_size * src->count);
-    return dst;
+    return _flecs_vector_copy(NULL, src, elem_size, offset);
 }
 
 
@@ -9960,12 +12427,13 @@ chunk_t* chunk_new(
      * sparse element has not been paired with a dense element. Use zero
      * as this means we can take advantage of calloc having a possibly better 
      * performance than malloc + memset. */
-    result->sparse = ecs_os_calloc(ECS_SIZEOF(int32_t) * CHUNK_COUNT);
+    result->sparse = flecs_calloc(sparse->allocator, 
+        ECS_SIZEOF(int32_t) * CHUNK_COUNT);
 
     /* Initialize the data array with zero's to guarantee that data is 
      * always initialized. When an entry is removed, data is reset back to
      * zero. Initialize now, as this can take advantage of calloc. */
-    result->data = ecs_os_calloc(sparse->size * CHUNK_COUNT);
+    result->data = flecs_calloc(sparse->allocator, sparse->size * CHUNK_COUNT);
 
     ecs_assert(result->sparse != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(result->data != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -9975,10 +12443,12 @@ chunk_t* chunk_new(
 
 static
 void chunk_free(
+    ecs_sparse_t *sparse,
     chunk_t *chunk)
 {
-    ecs_os_free(chunk->sparse);
-    ecs_os_free(chunk->data);
+    ecs_allocator_t *a = sparse->allocator;
+    flecs_free(a, ECS_SIZEOF(int32_t) * CHUNK_COUNT, chunk->sparse);
+    flecs_free(a, sparse->size * CHUNK_COUNT, chunk->data);
 }
 
 static
@@ -10225,6 +12695,7 @@ void _flecs_sparse_init(
     result->size = size;
     result->max_id_local = UINT64_MAX;
     result->max_id = &result->max_id_local;
+    result->allocator = NULL;
 
     /* Consume first value in dense array as 0 is used in the sparse array to
      * indicate that a sparse element hasn't been paired yet. */
@@ -10234,6 +12705,15 @@ void _flecs_sparse_init(
     result->count = 1;
 }
 
+void _flecs_sparse_init_w_allocator(
+    ecs_sparse_t *result,
+    ecs_size_t size,
+    ecs_allocator_t *allocator)
+{
+    _flecs_sparse_init(result, size);
+    result->allocator = allocator;
+}
+
 ecs_sparse_t* _flecs_sparse_new(
     ecs_size_t size)
 {
@@ -10258,7 +12738,7 @@ void flecs_sparse_clear(
     ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
 
     ecs_vector_each(sparse->chunks, chunk_t, chunk, {
-        chunk_free(chunk);
+        chunk_free(sparse, chunk);
     });
 
     ecs_vector_free(sparse->chunks);
@@ -11177,16 +13657,10 @@ const uint64_t* flecs_name_index_find_ptr(
 {
     ecs_hashed_string_t hs = flecs_get_hashed_string(name, length, hash);
 
-    ecs_hm_bucket_t *b = flecs_hashmap_get_bucket(map, hs.hash);
-    if (!b) {
-        return NULL;
-    }
-
-    ecs_hashed_string_t *keys = ecs_vector_first(b->keys, ecs_hashed_string_t);
-    int32_t i, count = ecs_vector_count(b->keys);
-
-    for (i = 0; i < count; i ++) {
-        ecs_hashed_string_t *key = &keys[i];
+    int32_t i = flecs_hashmap_get_index(map, hs.hash);
+    for (; i != -1; i = flecs_hashmap_next_index(map, i)) {
+        ecs_hashed_string_t *key = flecs_hashmap_key_at(
+            map, ecs_hashed_string_t, i);
         ecs_assert(key->hash == hs.hash, ECS_INTERNAL_ERROR, NULL);
 
         if (hs.length != key->length) {
@@ -11194,9 +13668,7 @@ const uint64_t* flecs_name_index_find_ptr(
         }
 
         if (!ecs_os_strcmp(name, key->value)) {
-            uint64_t *e = ecs_vector_get(b->values, uint64_t, i);
-            ecs_assert(e != NULL, ECS_INTERNAL_ERROR, NULL);
-            return e;
+            return flecs_hashmap_value_at(map, uint64_t, i);
         }
     }
 
@@ -11221,17 +13693,10 @@ void flecs_name_index_remove(
     uint64_t e,
     uint64_t hash)
 {
-    ecs_hm_bucket_t *b = flecs_hashmap_get_bucket(map, hash);
-    if (!b) {
-        return;
-    }
-
-    uint64_t *ids = ecs_vector_first(b->values, uint64_t);
-    int32_t i, count = ecs_vector_count(b->values);
-
-    for (i = 0; i < count; i ++) {
-        if (ids[i] == e) {
-            flecs_hm_bucket_remove(map, b, hash, i);
+    int32_t i = flecs_hashmap_get_index(map, hash);
+    for (; i != -1; i = flecs_hashmap_next_index(map, i)) {
+        if (*flecs_hashmap_value_at(map, uint64_t, i) == e) {
+            flecs_hashmap_remove_index(map, i);
             break;
         }
     }
@@ -11243,18 +13708,15 @@ void flecs_name_index_update_name(
     uint64_t hash,
     const char *name)
 {
-    ecs_hm_bucket_t *b = flecs_hashmap_get_bucket(map, hash);
-    if (!b) {
+    int32_t i = flecs_hashmap_get_index(map, hash);
+    if (i == -1) {
         return;
     }
 
-    uint64_t *ids = ecs_vector_first(b->values, uint64_t);
-    int32_t i, count = ecs_vector_count(b->values);
-
-    for (i = 0; i < count; i ++) {
-        if (ids[i] == e) {
-            ecs_hashed_string_t *key = ecs_vector_get(
-                b->keys, ecs_hashed_string_t, i);
+    for (; i != -1; i = flecs_hashmap_next_index(map, i)) {
+        if (*flecs_hashmap_value_at(map, uint64_t, i) == e) {
+            ecs_hashed_string_t *key = flecs_hashmap_key_at(
+                map, ecs_hashed_string_t, i);
             key->value = (char*)name;
             ecs_assert(ecs_os_strlen(name) == key->length,
                 ECS_INTERNAL_ERROR, NULL);
@@ -12473,30 +14935,147 @@ int32_t ecs_strbuf_written(
     return b->size + b->current->pos;
 }
 
-#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLECS_MAP_SSE2
+#endif
 
 /* The ratio used to determine whether the map should rehash. If
- * (element_count * LOAD_FACTOR) > bucket_count, bucket count is increased. */
+ * (element_count * LOAD_FACTOR) > slot_count, slot count is increased. */
 #define LOAD_FACTOR (1.5f)
 #define KEY_SIZE (ECS_SIZEOF(ecs_map_key_t))
 #define GET_ELEM(array, elem_size, index) \
     ECS_OFFSET(array, (elem_size) * (index))
 
+/* Number of slots for which control bytes are tested at the same time */
+#define GROUP_SIZE (16)
+
+/* Control byte values. The control byte of a slot with an element contains 7
+ * bits of the key hash, and therefore never has the high bit set. Sentinels
+ * pad the control bytes of maps with less slots than GROUP_SIZE. */
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+#define CTRL_SENTINEL ((uint8_t)0xFF)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MAP_NOINLINE __attribute__((noinline))
+#else
+#define MAP_NOINLINE
+#endif
+
+#ifdef FLECS_MAP_SSE2
+
+/* Get mask with a bit set for each slot in group with control byte h2 */
 static
-uint8_t ecs_log2(uint32_t v) {
-    static const uint8_t log2table[32] = 
-        {0, 9,  1,  10, 13, 21, 2,  29, 11, 14, 16, 18, 22, 25, 3, 30,
-         8, 12, 20, 28, 15, 17, 24, 7,  19, 27, 23, 6,  26, 5,  4, 31};
+uint32_t group_match(
+    const uint8_t *ctrl,
+    uint8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8((char)h2), group));
+}
 
-    v |= v >> 1;
-    v |= v >> 2;
-    v |= v >> 4;
-    v |= v >> 8;
-    v |= v >> 16;
-    return log2table[(uint32_t)(v * 0x07C4ACDDU) >> 27];
+/* Get mask with a bit set for each empty or deleted slot in group. These are
+ * the only control bytes that are smaller than the sentinel when signed. */
+static
+uint32_t group_match_free(
+    const uint8_t *ctrl)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8((char)CTRL_SENTINEL), group));
 }
 
-/* Get bucket count for number of elements */
+/* Get mask with a bit set for each slot in group that has an element */
+static
+uint32_t group_match_full(
+    const uint8_t *ctrl)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return ~(uint32_t)_mm_movemask_epi8(group) & 0xFFFF;
+}
+
+#else
+
+static
+uint32_t group_match(
+    const uint8_t *ctrl,
+    uint8_t h2)
+{
+    uint32_t result = 0;
+    int32_t i;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)(ctrl[i] == h2) << i;
+    }
+    return result;
+}
+
+static
+uint32_t group_match_free(
+    const uint8_t *ctrl)
+{
+    uint32_t result = 0;
+    int32_t i;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)(ctrl[i] == CTRL_EMPTY ||
+            ctrl[i] == CTRL_DELETED) << i;
+    }
+    return result;
+}
+
+static
+uint32_t group_match_full(
+    const uint8_t *ctrl)
+{
+    uint32_t result = 0;
+    int32_t i;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)!(ctrl[i] & CTRL_EMPTY) << i;
+    }
+    return result;
+}
+
+#endif
+
+static
+uint32_t group_match_empty(
+    const uint8_t *ctrl)
+{
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+/* Get index of lowest bit that is set */
+static
+int32_t map_ctz(
+    uint32_t v)
+{
+    ecs_assert(v != 0, ECS_INTERNAL_ERROR, NULL);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(v);
+#else
+    int32_t result = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        result ++;
+    }
+    return result;
+#endif
+}
+
+/* Mix bits of key, as keys (like entity ids) often only differ in a few bits.
+ * The multiplication moves the entropy of the key to the upper bits. The top
+ * bits select the home slot, and 7 bits from the middle of the hash are stored
+ * in the control byte. */
+static
+uint64_t map_hash(
+    ecs_map_key_t key)
+{
+    return key * 0x9e3779b97f4a7c15ull;
+}
+
+/* Get slot count for number of elements */
 static
 int32_t get_bucket_count(
     int32_t element_count)
@@ -12504,219 +15083,304 @@ int32_t get_bucket_count(
     return flecs_next_pow_of_2((int32_t)((float)element_count * LOAD_FACTOR));
 }
 
-/* Get bucket shift amount for a given bucket count */
 static
-uint8_t get_bucket_shift (
-    int32_t bucket_count)
+int32_t get_group_mask(
+    const ecs_map_t *map)
 {
-    return (uint8_t)(64u - ecs_log2((uint32_t)bucket_count));
+    if (map->slot_count <= GROUP_SIZE) {
+        return 0;
+    }
+    return map->slot_count / GROUP_SIZE - 1;
 }
 
-/* Get bucket index for provided map key */
+/* Get hash bits stored in the control byte of a slot */
 static
-int32_t get_bucket_index(
-    const ecs_map_t *map,
-    uint16_t bucket_shift,
-    ecs_map_key_t key) 
+uint8_t get_h2(
+    uint64_t hash)
 {
-    ecs_assert(bucket_shift != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(map->bucket_shift == bucket_shift, ECS_INTERNAL_ERROR, NULL);
-    (void)map;
-    return (int32_t)((11400714819323198485ull * key) >> bucket_shift);
+    return (uint8_t)((hash >> 32) & 0x7F);
 }
 
-/* Get bucket for key */
+/* Get home slot of hash. Elements are stored in their home slot when it is
+ * free, which allows most lookups to test a single key. */
 static
-ecs_bucket_t* get_bucket(
+int32_t get_home_slot(
     const ecs_map_t *map,
-    ecs_map_key_t key)
+    uint64_t hash)
 {
-    ecs_assert(map->bucket_shift == get_bucket_shift(map->bucket_count), 
-        ECS_INTERNAL_ERROR, NULL);
-    int32_t bucket_id = get_bucket_index(map, map->bucket_shift, key);
-    ecs_assert(bucket_id < map->bucket_count, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
+    return (int32_t)(hash >> (64 - map_ctz((uint32_t)map->slot_count)));
 }
 
-/* Ensure that map has at least new_count buckets */
+/* Size of the control bytes, padded to a whole group */
 static
-void ensure_buckets(
-    ecs_map_t *map,
-    int32_t new_count)
+ecs_size_t get_ctrl_size(
+    int32_t slot_count)
 {
-    int32_t bucket_count = map->bucket_count;
-    new_count = flecs_next_pow_of_2(new_count);
-    if (new_count < 2) {
-        new_count = 2;
-    }
-
-    if (new_count && new_count > bucket_count) {
-        map->buckets = ecs_os_realloc(map->buckets, new_count * ECS_SIZEOF(ecs_bucket_t));
-        map->bucket_count = new_count;
-        map->bucket_shift = get_bucket_shift(new_count);
-        ecs_os_memset(
-            ECS_OFFSET(map->buckets, bucket_count * ECS_SIZEOF(ecs_bucket_t)), 
-            0, (new_count - bucket_count) * ECS_SIZEOF(ecs_bucket_t));
-    }
+    return ECS_MAX(slot_count, GROUP_SIZE);
 }
 
-/* Free contents of bucket */
+/* Size of the bitset that marks home slots for which an element is stored in
+ * another slot, padded to a multiple of 16 bytes. Flags are not cleared when
+ * elements are removed, only when the map is rehashed. */
 static
-void clear_bucket(
-    ecs_bucket_t *bucket)
+ecs_size_t get_displaced_size(
+    int32_t slot_count)
 {
-    ecs_os_free(bucket->keys);
-    ecs_os_free(bucket->payload);
-    bucket->keys = NULL;
-    bucket->payload = NULL;
-    bucket->count = 0;
+    return ECS_MAX(slot_count / 8, 16);
 }
 
-/* Clear all buckets */
+/* Get bitset with displaced flags, which is stored after the control bytes */
 static
-void clear_buckets(
-    ecs_map_t *map)
+uint8_t* get_displaced(
+    const ecs_map_t *map)
 {
-    ecs_bucket_t *buckets = map->buckets;
-    int32_t i, count = map->bucket_count;
-    for (i = 0; i < count; i ++) {
-        clear_bucket(&buckets[i]);
-    }
-    ecs_os_free(buckets);
-    map->buckets = NULL;
-    map->bucket_count = 0;
+    return &map->ctrl[get_ctrl_size(map->slot_count)];
 }
 
-/* Find or create bucket for specified key */
+/* Test if an element with this home slot was stored in another slot */
 static
-ecs_bucket_t* ensure_bucket(
-    ecs_map_t *map,
-    ecs_map_key_t key)
+bool is_displaced(
+    const ecs_map_t *map,
+    int32_t home)
 {
-    ecs_assert(map->bucket_count >= 2, ECS_INTERNAL_ERROR, NULL);
-    int32_t bucket_id = get_bucket_index(map, map->bucket_shift, key);
-    ecs_assert(bucket_id >= 0, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
+    return (get_displaced(map)[home >> 3] & (1 << (home & 7))) != 0;
 }
 
-/* Add element to bucket */
+/* Find slot for key in groups, returns -1 if the key isn't found. Groups are 
+ * probed in triangular order, starting from the group of the home slot, which
+ * visits each group once when the number of groups is a power of 2. Probing 
+ * stops at a group with an empty slot, as an element is always inserted in the
+ * first group with a free slot. */
 static
-int32_t add_to_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
+int32_t map_probe(
+    const ecs_map_t *map,
     ecs_map_key_t key,
-    const void *payload)
+    uint64_t hash)
 {
-    int32_t index = bucket->count ++;
-    int32_t bucket_count = index + 1;
+    const uint8_t *ctrl = map->ctrl;
+    const ecs_map_key_t *keys = map->keys;
+    uint8_t h2 = get_h2(hash);
+    int32_t mask = get_group_mask(map);
+    int32_t group = get_home_slot(map, hash) / GROUP_SIZE;
+    int32_t step = 0;
 
-    bucket->keys = ecs_os_realloc(bucket->keys, KEY_SIZE * bucket_count);
-    bucket->keys[index] = key;
+    do {
+        int32_t first = group * GROUP_SIZE;
+        uint32_t match = group_match(&ctrl[first], h2);
+        while (match) {
+            int32_t slot = first + map_ctz(match);
+            if (keys[slot] == key) {
+                return slot;
+            }
+            match &= match - 1;
+        }
 
-    if (elem_size) {
-        bucket->payload = ecs_os_realloc(bucket->payload, elem_size * bucket_count);
-        if (payload) {
-            void *elem = GET_ELEM(bucket->payload, elem_size, index);
-            ecs_os_memcpy(elem, payload, elem_size);
+        if (group_match_empty(&ctrl[first])) {
+            return -1;
         }
-    } else {
-        bucket->payload = NULL;
-    }
 
-    return index;
+        group = (group + (++ step)) & mask;
+    } while (step <= mask);
+
+    return -1;
 }
 
-/*  Remove element from bucket */
+/* Find slot for key, returns -1 if the key isn't found. Only keys of which the
+ * home slot is marked as displaced require probing. */
 static
-void remove_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
+int32_t map_find(
+    const ecs_map_t *map,
     ecs_map_key_t key,
-    int32_t index)
+    uint64_t hash)
 {
-    (void)key;
+    int32_t home = get_home_slot(map, hash);
+    if (map->keys[home] == key && map->ctrl[home] == get_h2(hash)) {
+        return home;
+    }
 
-    ecs_assert(bucket->count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(index < bucket->count, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t bucket_count = -- bucket->count;
+    if (!is_displaced(map, home)) {
+        return -1;
+    }
 
-    if (index != bucket->count) {
-        ecs_assert(key == bucket->keys[index], ECS_INTERNAL_ERROR, NULL);
-        bucket->keys[index] = bucket->keys[bucket_count];
+    return map_probe(map, key, hash);
+}
 
-        ecs_map_key_t *elem = GET_ELEM(bucket->payload, elem_size, index);
-        ecs_map_key_t *last_elem = GET_ELEM(bucket->payload, elem_size, bucket->count);
+/* Find free slot for hash. This is the home slot if it is empty or deleted.
+ * Otherwise the home slot is marked as displaced, and the element is stored in
+ * the neighbour of the home slot, or in the first empty or deleted slot of the
+ * probe sequence. The neighbour is in the same group as the home slot, so it is
+ * always found by probing. */
+static
+int32_t map_find_free(
+    ecs_map_t *map,
+    uint64_t hash)
+{
+    uint8_t *ctrl = map->ctrl;
+    int32_t home = get_home_slot(map, hash);
+    if (ctrl[home] & CTRL_EMPTY) {
+        return home;
+    }
 
-        ecs_os_memcpy(elem, last_elem, elem_size);
+    get_displaced(map)[home >> 3] |= (uint8_t)(1 << (home & 7));
+    if (ctrl[home ^ 1] & CTRL_EMPTY) {
+        return home ^ 1;
     }
+
+    int32_t mask = get_group_mask(map);
+    int32_t group = home / GROUP_SIZE;
+    int32_t step = 0;
+
+    do {
+        int32_t first = group * GROUP_SIZE;
+        uint32_t match = group_match_free(&ctrl[first]);
+        if (match) {
+            return first + map_ctz(match);
+        }
+
+        group = (group + (++ step)) & mask;
+    } while (step <= mask);
+
+    /* The load factor guarantees that there always is a free slot */
+    ecs_abort(ECS_INTERNAL_ERROR, NULL);
 }
 
-/* Get payload pointer for key from bucket */
+/* Size of the block with control bytes, keys and payload */
 static
-void* get_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_map_key_t key,
-    ecs_size_t elem_size)
+ecs_size_t map_alloc_size(
+    const ecs_map_t *map,
+    int32_t slot_count)
 {
-    ecs_map_key_t *keys = bucket->keys;
-    int32_t i, count = bucket->count;
-
-    for (i = 0; i < count; i ++) {
-        if (keys[i] == key) {
-            return GET_ELEM(bucket->payload, elem_size, i);
-        }
-    }
-    return NULL;
+    return get_ctrl_size(slot_count) + get_displaced_size(slot_count) +
+        (KEY_SIZE + map->elem_size) * slot_count;
 }
 
-/* Grow number of buckets */
+/* Allocate control bytes, displaced flags, keys and payload for slots in a 
+ * single block. The control bytes are padded to a whole group, so that a group
+ * can always be loaded. The padded control bytes, displaced flags and the key
+ * array are multiples of 16 bytes, which keeps the payload aligned. */
 static
-void rehash(
+void map_alloc(
     ecs_map_t *map,
-    int32_t bucket_count)
+    int32_t slot_count)
 {
-    ecs_assert(bucket_count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(bucket_count > map->bucket_count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(slot_count >= 2, ECS_INTERNAL_ERROR, NULL);
 
-    ensure_buckets(map, bucket_count);
+    ecs_size_t ctrl_size = get_ctrl_size(slot_count);
+    ecs_size_t displaced_size = get_displaced_size(slot_count);
+    ecs_size_t keys_size = KEY_SIZE * slot_count;
+    uint8_t *ctrl = flecs_alloc(map->allocator, 
+        map_alloc_size(map, slot_count));
+    ecs_assert(ctrl != NULL, ECS_OUT_OF_MEMORY, NULL);
 
-    ecs_bucket_t *buckets = map->buckets;
-    ecs_assert(buckets != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_size_t elem_size = map->elem_size;
-    uint16_t bucket_shift = map->bucket_shift;
-    int32_t bucket_id;
+    ecs_os_memset(ctrl, CTRL_EMPTY, slot_count);
+    ecs_os_memset(&ctrl[slot_count], CTRL_SENTINEL, ctrl_size - slot_count);
+    ecs_os_memset(&ctrl[ctrl_size], 0, displaced_size);
 
-    /* Iterate backwards as elements could otherwise be moved to existing
-     * buckets which could temporarily cause the number of elements in a
-     * bucket to exceed BUCKET_COUNT. */
-    for (bucket_id = bucket_count - 1; bucket_id >= 0; bucket_id --) {
-        ecs_bucket_t *bucket = &buckets[bucket_id];
+    map->ctrl = ctrl;
+    map->keys = ECS_OFFSET(ctrl, ctrl_size + displaced_size);
+    map->payload = map->elem_size ? ECS_OFFSET(map->keys, keys_size) : NULL;
+    map->slot_count = slot_count;
+    map->deleted = 0;
+}
 
-        int i, count = bucket->count;
-        ecs_map_key_t *key_array = bucket->keys;
-        void *payload_array = bucket->payload;
+/* Free slots */
+static
+void map_free(
+    ecs_map_t *map)
+{
+    flecs_free(map->allocator, map_alloc_size(map, map->slot_count), 
+        map->ctrl);
+    map->ctrl = NULL;
+    map->keys = NULL;
+    map->payload = NULL;
+    map->slot_count = 0;
+    map->deleted = 0;
+}
 
-        for (i = 0; i < count; i ++) {
-            ecs_map_key_t key = key_array[i];
-            void *elem = GET_ELEM(payload_array, elem_size, i);
-            int32_t new_bucket_id = get_bucket_index(map, bucket_shift, key);
+/* Reinsert elements in new slots. This also removes deleted slots. */
+static
+void rehash(
+    ecs_map_t *map,
+    int32_t slot_count)
+{
+    ecs_assert(slot_count != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(slot_count >= map->slot_count, ECS_INTERNAL_ERROR, NULL);
 
-            if (new_bucket_id != bucket_id) {
-                ecs_bucket_t *new_bucket = &buckets[new_bucket_id];
+    uint8_t *old_ctrl = map->ctrl;
+    ecs_map_key_t *old_keys = map->keys;
+    void *old_payload = map->payload;
+    int32_t i, old_count = map->slot_count;
+    ecs_size_t elem_size = map->elem_size;
+    ecs_size_t old_size = map_alloc_size(map, old_count);
 
-                add_to_bucket(new_bucket, elem_size, key, elem);
-                remove_from_bucket(bucket, elem_size, key, i);
+    map_alloc(map, slot_count);
 
-                count --;
-                i --;
-            }
+    for (i = 0; i < old_count; i ++) {
+        if (old_ctrl[i] & CTRL_EMPTY) {
+            continue;
         }
 
-        if (!bucket->count) {
-            clear_bucket(bucket);
+        ecs_map_key_t key = old_keys[i];
+        uint64_t hash = map_hash(key);
+        int32_t slot = map_find_free(map, hash);
+        map->ctrl[slot] = get_h2(hash);
+        map->keys[slot] = key;
+        if (elem_size) {
+            ecs_os_memcpy(GET_ELEM(map->payload, elem_size, slot),
+                GET_ELEM(old_payload, elem_size, i), elem_size);
         }
     }
+
+    flecs_free(map->allocator, old_size, old_ctrl);
+}
+
+/* Add key that isn't in the map yet, returns slot */
+static
+int32_t map_insert(
+    ecs_map_t *map,
+    ecs_map_key_t key,
+    uint64_t hash)
+{
+    int32_t count = map->count + 1;
+    int32_t slot_count = get_bucket_count(count);
+    if (slot_count > map->slot_count) {
+        rehash(map, slot_count);
+    }
+
+    int32_t slot = map_find_free(map, hash);
+    if (map->ctrl[slot] == CTRL_DELETED) {
+        map->deleted --;
+    } else if ((count + map->deleted) >= map->slot_count) {
+        /* Filling the last empty slot would prevent probing from terminating,
+         * so remove deleted slots first */
+        rehash(map, map->slot_count);
+        slot = map_find_free(map, hash);
+    }
+
+    map->ctrl[slot] = get_h2(hash);
+    map->keys[slot] = key;
+    map->count = count;
+
+    return slot;
+}
+
+/* Remove element from slot. If the group of the slot has an empty slot, no
+ * probe sequence continues past the group, and the slot can be marked empty.
+ * Otherwise it must be marked as deleted, so that probing continues. */
+static
+void map_erase(
+    ecs_map_t *map,
+    int32_t slot)
+{
+    int32_t first = slot & ~(GROUP_SIZE - 1);
+    if (group_match_empty(&map->ctrl[first])) {
+        map->ctrl[slot] = CTRL_EMPTY;
+    } else {
+        map->ctrl[slot] = CTRL_DELETED;
+        map->deleted ++;
+    }
+
+    map->count --;
 }
 
 void _ecs_map_init(
@@ -12728,8 +15392,24 @@ void _ecs_map_init(
 
     result->count = 0;
     result->elem_size = (int16_t)elem_size;
+    result->allocator = NULL;
+
+    map_alloc(result, ECS_MAX(get_bucket_count(element_count), 2));
+}
+
+void _ecs_map_init_w_allocator(
+    ecs_map_t *result,
+    ecs_size_t elem_size,
+    int32_t element_count,
+    ecs_allocator_t *allocator)
+{
+    ecs_assert(elem_size < INT16_MAX, ECS_INVALID_PARAMETER, NULL);
+
+    result->count = 0;
+    result->elem_size = (int16_t)elem_size;
+    result->allocator = allocator;
 
-    ensure_buckets(result, get_bucket_count(element_count));
+    map_alloc(result, ECS_MAX(get_bucket_count(element_count), 2));
 }
 
 ecs_map_t* _ecs_map_new(
@@ -12747,14 +15427,14 @@ ecs_map_t* _ecs_map_new(
 bool ecs_map_is_initialized(
     const ecs_map_t *result)
 {
-    return result != NULL && result->bucket_count != 0;
+    return result != NULL && result->ctrl != NULL;
 }
 
 void ecs_map_fini(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
-    clear_buckets(map);
+    map_free(map);
 }
 
 void ecs_map_free(
@@ -12766,6 +15446,24 @@ void ecs_map_free(
     }
 }
 
+/* Lookup for key that is not in its home slot. This is kept out of the
+ * lookup function, so that a lookup in the home slot doesn't have to set up a
+ * stack frame. */
+static MAP_NOINLINE
+void* map_get_displaced(
+    const ecs_map_t *map,
+    ecs_size_t elem_size,
+    ecs_map_key_t key,
+    uint64_t hash)
+{
+    int32_t slot = map_probe(map, key, hash);
+    if (slot == -1) {
+        return NULL;
+    }
+
+    return GET_ELEM(map->payload, elem_size, slot);
+}
+
 void* _ecs_map_get(
     const ecs_map_t *map,
     ecs_size_t elem_size,
@@ -12779,12 +15477,22 @@ void* _ecs_map_get(
 
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    uint64_t hash = map_hash(key);
+    int32_t home = get_home_slot(map, hash);
+    if (map->keys[home] == key && map->ctrl[home] == get_h2(hash)) {
+        return GET_ELEM(map->payload, elem_size, home);
+    }
+
+    if (!is_displaced(map, home)) {
         return NULL;
     }
 
-    return get_from_bucket(bucket, key, elem_size);
+    int32_t next = home ^ 1;
+    if (map->keys[next] == key && map->ctrl[next] == get_h2(hash)) {
+        return GET_ELEM(map->payload, elem_size, next);
+    }
+
+    return map_get_displaced(map, elem_size, key, hash);
 }
 
 void* _ecs_map_get_ptr(
@@ -12808,12 +15516,7 @@ bool ecs_map_has(
         return false;
     }
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
-        return false;
-    }
-
-    return get_from_bucket(bucket, key, 0) != NULL;
+    return map_find(map, key, map_hash(key)) != -1;
 }
 
 void* _ecs_map_ensure(
@@ -12841,30 +15544,20 @@ void* _ecs_map_set(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(ecs_map_is_initialized(map), ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = ensure_bucket(map, key);
-    ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
+    uint64_t hash = map_hash(key);
+    int32_t slot = map_find(map, key, hash);
+    if (slot == -1) {
+        slot = map_insert(map, key, hash);
+    }
 
-    void *elem = get_from_bucket(bucket, key, elem_size);
-    if (!elem) {
-        int32_t index = add_to_bucket(bucket, elem_size, key, payload);        
-        int32_t map_count = ++map->count;
-        int32_t target_bucket_count = get_bucket_count(map_count);
-        int32_t map_bucket_count = map->bucket_count;
-
-        if (target_bucket_count > map_bucket_count) {
-            rehash(map, target_bucket_count);
-            bucket = ensure_bucket(map, key);
-            return get_from_bucket(bucket, key, elem_size);
-        } else {
-            return GET_ELEM(bucket->payload, elem_size, index);
-        }       
-    } else {
-        if (payload) {
-            ecs_os_memcpy(elem, payload, elem_size);
-        }
-        return elem;
+    void *elem = GET_ELEM(map->payload, elem_size, slot);
+    if (payload && elem_size) {
+        ecs_os_memcpy(elem, payload, elem_size);
     }
+
+    return elem;
 }
 
 int32_t ecs_map_remove(
@@ -12873,17 +15566,13 @@ int32_t ecs_map_remove(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    if (!ecs_map_is_initialized(map)) {
         return map->count;
     }
 
-    int32_t i, bucket_count = bucket->count;
-    for (i = 0; i < bucket_count; i ++) {
-        if (bucket->keys[i] == key) {
-            remove_from_bucket(bucket, map->elem_size, key, i);
-            return --map->count;
-        }
+    int32_t slot = map_find(map, key, map_hash(key));
+    if (slot != -1) {
+        map_erase(map, slot);
     }
 
     return map->count;
@@ -12898,16 +15587,16 @@ int32_t ecs_map_count(
 int32_t ecs_map_bucket_count(
     const ecs_map_t *map)
 {
-    return map ? map->bucket_count : 0;
+    return map ? map->slot_count : 0;
 }
 
 void ecs_map_clear(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
-    clear_buckets(map);
+    map_free(map);
     map->count = 0;
-    ensure_buckets(map, 2);
+    map_alloc(map, 2);
 }
 
 ecs_map_iter_t ecs_map_iter(
@@ -12915,9 +15604,7 @@ ecs_map_iter_t ecs_map_iter(
 {
     return (ecs_map_iter_t){
         .map = map,
-        .bucket = NULL,
-        .bucket_index = 0,
-        .element_index = 0
+        .index = 0
     };
 }
 
@@ -12926,47 +15613,42 @@ void* _ecs_map_next(
     ecs_size_t elem_size,
     ecs_map_key_t *key_out)
 {
+    (void)elem_size;
+
     const ecs_map_t *map = iter->map;
     if (!ecs_map_is_initialized(map)) {
         return NULL;
     }
-    
-    ecs_assert(!elem_size || elem_size == map->elem_size, 
+
+    ecs_assert(!elem_size || elem_size == map->elem_size,
         ECS_INVALID_PARAMETER, NULL);
- 
-    ecs_bucket_t *bucket = iter->bucket;
-    int32_t element_index = iter->element_index;
-    elem_size = map->elem_size;
 
-    do {
-        if (!bucket) {
-            int32_t bucket_index = iter->bucket_index;
-            ecs_bucket_t *buckets = map->buckets;
-            if (bucket_index < map->bucket_count) {
-                bucket = &buckets[bucket_index];
-                iter->bucket = bucket;
-
-                element_index = 0;
-                iter->element_index = 0;
-            } else {
-                return NULL;
-            }
-        }
+    const uint8_t *ctrl = map->ctrl;
+    int32_t index = iter->index, slot_count = map->slot_count;
 
-        if (element_index < bucket->count) {
-            iter->element_index = element_index + 1;
+    while (index < slot_count) {
+        int32_t first = index & ~(GROUP_SIZE - 1);
+        uint32_t match = group_match_full(&ctrl[first]) &
+            (0xFFFFu << (index - first));
+        if (match) {
+            index = first + map_ctz(match);
             break;
-        } else {
-            bucket = NULL;
-            iter->bucket_index ++;
         }
-    } while (true);
-    
+        index = first + GROUP_SIZE;
+    }
+
+    if (index >= slot_count) {
+        iter->index = slot_count;
+        return NULL;
+    }
+
+    iter->index = index + 1;
+
     if (key_out) {
-        *key_out = bucket->keys[element_index];
+        *key_out = map->keys[index];
     }
 
-    return GET_ELEM(bucket->payload, elem_size, element_index);
+    return GET_ELEM(map->payload, map->elem_size, index);
 }
 
 void* _ecs_map_next_ptr(
@@ -12982,27 +15664,27 @@ void* _ecs_map_next_ptr(
 }
 
 void ecs_map_grow(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     int32_t target_count = map->count + element_count;
-    int32_t bucket_count = get_bucket_count(target_count);
+    int32_t slot_count = get_bucket_count(target_count);
 
-    if (bucket_count > map->bucket_count) {
-        rehash(map, bucket_count);
+    if (slot_count > map->slot_count) {
+        rehash(map, slot_count);
     }
 }
 
 void ecs_map_set_size(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
-{    
+{
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
-    int32_t bucket_count = get_bucket_count(element_count);
+    int32_t slot_count = get_bucket_count(element_count);
 
-    if (bucket_count) {
-        rehash(map, bucket_count);
+    if (slot_count > map->slot_count) {
+        rehash(map, slot_count);
     }
 }
 
@@ -13027,7 +15709,7 @@ ecs_map_t* ecs_map_copy(
 }
 
 void ecs_map_memory(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t *allocd,
     int32_t *used)
 {
@@ -13040,36 +15722,103 @@ void ecs_map_memory(
     if (allocd) {
         *allocd += ECS_SIZEOF(ecs_map_t);
 
-        int i, bucket_count = map->bucket_count;
-        for (i = 0; i < bucket_count; i ++) {
-            ecs_bucket_t *bucket = &map->buckets[i];
-            *allocd += KEY_SIZE * bucket->count;
-            *allocd += map->elem_size * bucket->count;
+        int32_t slot_count = map->slot_count;
+        if (slot_count) {
+            *allocd += get_ctrl_size(slot_count);
+            *allocd += get_displaced_size(slot_count);
+            *allocd += (KEY_SIZE + map->elem_size) * slot_count;
         }
-
-        *allocd += ECS_SIZEOF(ecs_bucket_t) * bucket_count;
     }
 }
 
 
+#define HM_ELEM_ALIGN (8)
+
+static
+ecs_hm_elem_t* hm_elem(
+    const ecs_hashmap_t *map,
+    int32_t index)
+{
+    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(index < ecs_vector_count(map->elems), ECS_INTERNAL_ERROR, NULL);
+    return ECS_OFFSET(ecs_vector_first_t(map->elems, map->elem_size,
+        HM_ELEM_ALIGN), map->elem_size * index);
+}
+
+static
+void* hm_elem_key(
+    ecs_hm_elem_t *elem)
+{
+    return ECS_OFFSET(elem, ECS_SIZEOF(ecs_hm_elem_t));
+}
+
+static
+void* hm_elem_value(
+    const ecs_hashmap_t *map,
+    ecs_hm_elem_t *elem)
+{
+    return ECS_OFFSET(elem, map->value_offset);
+}
+
+/* Get index of first element with hash */
+static
+int32_t hm_first(
+    const ecs_hashmap_t *map,
+    uint64_t hash)
+{
+    int32_t *first = ecs_map_get(&map->impl, int32_t, hash);
+    if (!first) {
+        return -1;
+    }
+    return *first;
+}
+
+/* Find element for key, starting from the first element with the hash of the
+ * key. Elements with a different hash are never compared with the key. */
 static
 int32_t find_key(
     const ecs_hashmap_t *map,
-    ecs_vector_t *keys,
-    ecs_size_t key_size, 
+    int32_t index,
+    uint64_t hash,
     const void *key)
 {
-    int32_t i, count = ecs_vector_count(keys);
-    void *key_array = ecs_vector_first_t(keys, key_size, 8);
-    for (i = 0; i < count; i ++) {
-        void *key_ptr = ECS_OFFSET(key_array, key_size * i);
-        if (map->compare(key_ptr, key) == 0) {
-            return i;
+    (void)hash;
+    while (index != -1) {
+        ecs_hm_elem_t *elem = hm_elem(map, index);
+        ecs_assert(elem->hash == hash, ECS_INTERNAL_ERROR, NULL);
+        if (map->compare(hm_elem_key(elem), key) == 0) {
+            return index;
         }
+        index = elem->next;
     }
+
     return -1;
 }
 
+/* Replace reference to element in list of elements with hash */
+static
+void relink(
+    ecs_hashmap_t *map,
+    uint64_t hash,
+    int32_t from,
+    int32_t to)
+{
+    int32_t *first = ecs_map_get(&map->impl, int32_t, hash);
+    ecs_assert(first != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (*first == from) {
+        *first = to;
+        return;
+    }
+
+    ecs_hm_elem_t *prev = hm_elem(map, *first);
+    while (prev->next != from) {
+        prev = hm_elem(map, prev->next);
+    }
+
+    prev->next = to;
+}
+
 void _flecs_hashmap_init(
     ecs_hashmap_t *map,
     ecs_size_t key_size,
@@ -13079,22 +15828,22 @@ void _flecs_hashmap_init(
 {
     map->key_size = key_size;
     map->value_size = value_size;
+    map->value_offset = ECS_SIZEOF(ecs_hm_elem_t) +
+        ECS_ALIGN(key_size, HM_ELEM_ALIGN);
+    map->elem_size = map->value_offset +
+        ECS_ALIGN(value_size, HM_ELEM_ALIGN);
     map->hash = hash;
     map->compare = compare;
-    ecs_map_init(&map->impl, ecs_hm_bucket_t, 0);
+    map->elems = NULL;
+    ecs_map_init(&map->impl, int32_t, 0);
 }
 
 void flecs_hashmap_fini(
     ecs_hashmap_t *map)
 {
-    ecs_map_iter_t it = ecs_map_iter(&map->impl);
-    ecs_hm_bucket_t *bucket;
-    while ((bucket = ecs_map_next(&it, ecs_hm_bucket_t, NULL))) {
-        ecs_vector_free(bucket->keys);
-        ecs_vector_free(bucket->values);
-    }
-
     ecs_map_fini(&map->impl);
+    ecs_vector_free(map->elems);
+    map->elems = NULL;
 }
 
 void flecs_hashmap_copy(
@@ -13104,17 +15853,12 @@ void flecs_hashmap_copy(
     if (dst != src) {
         *dst = *src;
     }
-    
+
     ecs_map_t *impl = ecs_map_copy(&dst->impl);
     dst->impl = *impl;
     ecs_os_free(impl);
 
-    ecs_map_iter_t it = ecs_map_iter(&dst->impl);
-    ecs_hm_bucket_t *bucket;
-    while ((bucket = ecs_map_next(&it, ecs_hm_bucket_t, NULL))) {
-        bucket->keys = ecs_vector_copy_t(bucket->keys, dst->key_size, 8);
-        bucket->values = ecs_vector_copy_t(bucket->values, dst->value_size, 8);
-    }
+    dst->elems = ecs_vector_copy_t(dst->elems, dst->elem_size, HM_ELEM_ALIGN);
 }
 
 void* _flecs_hashmap_get(
@@ -13125,19 +15869,16 @@ void* _flecs_hashmap_get(
 {
     ecs_assert(map->key_size == key_size, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
+    (void)value_size;
 
     uint64_t hash = map->hash(key);
-    ecs_hm_bucket_t *bucket = ecs_map_get(&map->impl, ecs_hm_bucket_t, hash);
-    if (!bucket) {
-        return NULL;
-    }
-
-    int32_t index = find_key(map, bucket->keys, key_size, key);
+    int32_t index = find_key(map, hm_first(map, hash), hash, key);
     if (index == -1) {
         return NULL;
     }
 
-    return ecs_vector_get_t(bucket->values, value_size, 8, index);
+    return hm_elem_value(map, hm_elem(map, index));
 }
 
 flecs_hashmap_result_t _flecs_hashmap_ensure(
@@ -13150,36 +15891,28 @@ flecs_hashmap_result_t _flecs_hashmap_ensure(
     ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
 
     uint64_t hash = map->hash(key);
-    ecs_hm_bucket_t *bucket = ecs_map_ensure(&map->impl, ecs_hm_bucket_t, hash);
-    ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
-
-    void *value_ptr, *key_ptr;
-
-    ecs_vector_t *keys = bucket->keys;
-    if (!keys) {
-        bucket->keys = ecs_vector_new_t(key_size, 8, 1);
-        bucket->values = ecs_vector_new_t(value_size, 8, 1);
-        key_ptr = ecs_vector_add_t(&bucket->keys, key_size, 8);
-        ecs_os_memcpy(key_ptr, key, key_size);
-        value_ptr = ecs_vector_add_t(&bucket->values, value_size, 8);
-        ecs_os_memset(value_ptr, 0, value_size);
-    } else {
-        int32_t index = find_key(map, keys, key_size, key);
-        if (index == -1) {
-            key_ptr = ecs_vector_add_t(&bucket->keys, key_size, 8);
-            ecs_os_memcpy(key_ptr, key, key_size);
-            value_ptr = ecs_vector_add_t(&bucket->values, value_size, 8);
-            ecs_assert(value_ptr != NULL, ECS_INTERNAL_ERROR, NULL);
-            ecs_os_memset(value_ptr, 0, value_size);
-        } else {
-            key_ptr = ecs_vector_get_t(bucket->keys, key_size, 8, index);
-            value_ptr = ecs_vector_get_t(bucket->values, value_size, 8, index);
-        }
+    ecs_hm_elem_t *elem;
+
+    int32_t first = hm_first(map, hash);
+    int32_t index = find_key(map, first, hash, key);
+    if (index != -1) {
+        elem = hm_elem(map, index);
+    } else {
+        /* Insert element at the start of the elements with the same hash */
+        index = ecs_vector_count(map->elems);
+        elem = ecs_vector_add_t(&map->elems, map->elem_size, HM_ELEM_ALIGN);
+        ecs_assert(elem != NULL, ECS_INTERNAL_ERROR, NULL);
+        elem->hash = hash;
+        elem->next = first;
+        ecs_os_memcpy(hm_elem_key(elem), key, key_size);
+        ecs_os_memset(hm_elem_value(map, elem), 0, value_size);
+
+        ecs_map_set(&map->impl, hash, &index);
     }
 
     return (flecs_hashmap_result_t){
-        .key = key_ptr,
-        .value = value_ptr,
+        .key = hm_elem_key(elem),
+        .value = hm_elem_value(map, elem),
         .hash = hash
     };
 }
@@ -13196,28 +15929,69 @@ void _flecs_hashmap_set(
     ecs_os_memcpy(value_ptr, value, value_size);
 }
 
-ecs_hm_bucket_t* flecs_hashmap_get_bucket(
+int32_t flecs_hashmap_get_index(
     const ecs_hashmap_t *map,
     uint64_t hash)
 {
     ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
-    return ecs_map_get(&map->impl, ecs_hm_bucket_t, hash);
+    return hm_first(map, hash);
+}
+
+int32_t flecs_hashmap_next_index(
+    const ecs_hashmap_t *map,
+    int32_t index)
+{
+    ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
+    return hm_elem(map, index)->next;
+}
+
+void* _flecs_hashmap_key_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t key_size,
+    int32_t index)
+{
+    ecs_assert(map->key_size == key_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
+    return hm_elem_key(hm_elem(map, index));
+}
+
+void* _flecs_hashmap_value_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t value_size,
+    int32_t index)
+{
+    ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)value_size;
+    return hm_elem_value(map, hm_elem(map, index));
 }
 
-void flecs_hm_bucket_remove(
+void flecs_hashmap_remove_index(
     ecs_hashmap_t *map,
-    ecs_hm_bucket_t *bucket,
-    uint64_t hash,
     int32_t index)
 {
-    ecs_vector_remove_t(bucket->keys, map->key_size, 8, index);
-    ecs_vector_remove_t(bucket->values, map->value_size, 8, index);
+    ecs_hm_elem_t *elem = hm_elem(map, index);
+    uint64_t hash = elem->hash;
 
-    if (!ecs_vector_count(bucket->keys)) {
-        ecs_vector_free(bucket->keys);
-        ecs_vector_free(bucket->values);
+    /* Remove element from list of elements with the same hash */
+    if (hm_first(map, hash) == index && elem->next == -1) {
         ecs_map_remove(&map->impl, hash);
+    } else {
+        relink(map, hash, index, elem->next);
+    }
+
+    /* The last element is moved to the index of the removed element */
+    int32_t last = ecs_vector_count(map->elems) - 1;
+    if (last != index) {
+        relink(map, hm_elem(map, last)->hash, last, index);
     }
+
+    ecs_vector_remove_t(map->elems, map->elem_size, HM_ELEM_ALIGN, index);
+}
+
+int32_t flecs_hashmap_count(
+    const ecs_hashmap_t *map)
+{
+    return ecs_vector_count(map->elems);
 }
 
 void _flecs_hashmap_remove_w_hash(
@@ -13229,19 +16003,15 @@ void _flecs_hashmap_remove_w_hash(
 {
     ecs_assert(map->key_size == key_size, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
     (void)value_size;
 
-    ecs_hm_bucket_t *bucket = ecs_map_get(&map->impl, ecs_hm_bucket_t, hash);
-    if (!bucket) {
-        return;
-    }
-
-    int32_t index = find_key(map, bucket->keys, key_size, key);
+    int32_t index = find_key(map, hm_first(map, hash), hash, key);
     if (index == -1) {
         return;
     }
 
-    flecs_hm_bucket_remove(map, bucket, hash, index);
+    flecs_hashmap_remove_index(map, index);
 }
 
 void _flecs_hashmap_remove(
@@ -13261,7 +16031,7 @@ flecs_hashmap_iter_t flecs_hashmap_iter(
     ecs_hashmap_t *map)
 {
     return (flecs_hashmap_iter_t){
-        .it = ecs_map_iter(&map->impl)
+        .map = map
     };
 }
 
@@ -13271,21 +16041,26 @@ void* _flecs_hashmap_next(
     void *key_out,
     ecs_size_t value_size)
 {
-    int32_t index = ++ it->index;
-    ecs_hm_bucket_t *bucket = it->bucket;
-    while (!bucket || it->index >= ecs_vector_count(bucket->keys)) {
-        bucket = it->bucket = ecs_map_next(&it->it, ecs_hm_bucket_t, NULL);
-        if (!bucket) {
-            return NULL;
-        }
-        index = it->index = 0;
+    ecs_hashmap_t *map = it->map;
+    ecs_assert(!key_out || map->key_size == key_size,
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
+    (void)value_size;
+
+    int32_t index = it->index;
+    if (index >= ecs_vector_count(map->elems)) {
+        return NULL;
     }
 
+    it->index = index + 1;
+
+    ecs_hm_elem_t *elem = hm_elem(map, index);
     if (key_out) {
-        *(void**)key_out = ecs_vector_get_t(bucket->keys, key_size, 8, index);
+        *(void**)key_out = hm_elem_key(elem);
     }
-    
-    return ecs_vector_get_t(bucket->values, value_size, 8, index);
+
+    return hm_elem_value(map, elem);
 }
 
 
@@ -13811,6 +16586,8 @@ typedef struct EcsSystem {
     /* Schedule parameters */
     bool multi_threaded;
     bool no_staging;
+    int32_t chunk_size;             /* See ecs_system_desc_t */
+    bool partition_groups;          /* See ecs_system_desc_t */
 
     int32_t invoke_count;           /* Number of times system is invoked */
     float time_spent;               /* Time spent on running system */
@@ -13835,7 +16612,9 @@ void ecs_system_activate(
     bool activate,
     const EcsSystem *system_data);
 
-/* Internal function to run a system */
+/* Internal function to run a system. If chunk_cursor is provided, multi threaded
+ * systems with a chunk size claim chunks from the cursor. The caller must reset
+ * the cursor after all workers finished running the system. */
 ecs_entity_t ecs_run_intern(
     ecs_world_t *world,
     ecs_stage_t *stage,
@@ -13843,6 +16622,7 @@ ecs_entity_t ecs_run_intern(
     EcsSystem *system_data,
     int32_t stage_current,
     int32_t stage_count,
+    int32_t *chunk_cursor,
     FLECS_FLOAT delta_time,
     int32_t offset,
     int32_t limit,
@@ -13861,10 +16641,17 @@ ecs_entity_t ecs_run_intern(
 /** Instruction data for pipeline.
  * This type is the element type in the "ops" vector of a pipeline and contains
  * information about the set of systems that need to be ran before a merge. */
+typedef struct ecs_pipeline_op_system_t {
+    ecs_entity_t system;        /* System entity */
+    int32_t chunk_cursor;       /* Next chunk to claim by worker threads */
+    int32_t group;              /* Concurrency group of system in op */
+} ecs_pipeline_op_system_t;
+
 typedef struct ecs_pipeline_op_t {
     int32_t count;              /* Number of systems to run before merge */
     bool multi_threaded;        /* Whether systems can be ran multi threaded */
     bool no_staging;            /* Whether systems are staged or not */
+    ecs_pipeline_op_system_t *systems; /* Data for each system in op */
 } ecs_pipeline_op_t;
 
 typedef struct EcsPipelineQuery {
@@ -13919,6 +16706,7 @@ void ecs_worker_begin(
 
 int32_t ecs_worker_sync(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     const EcsPipelineQuery *pq,
     ecs_iter_t *it,
     int32_t i,
@@ -13928,6 +16716,12 @@ int32_t ecs_worker_sync(
 void ecs_worker_end(
     ecs_world_t *world);
 
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_pipeline_op_t *op,
+    FLECS_FLOAT delta_time);
+
 void ecs_workers_progress(
     ecs_world_t *world,
     ecs_entity_t pipeline,
@@ -13936,6 +16730,84 @@ void ecs_workers_progress(
 #endif
 
 
+/* Number of times a thread polls a sync variable before it blocks on a
+ * condition variable. Most pipeline ops are short, so spinning for a while lets
+ * threads pass a sync point with a few atomic operations instead of a full
+ * condition variable round trip. */
+#define ECS_WORKER_SPIN_COUNT (4096)
+
+/* Number of jobs in the queue of each worker for multi threaded ops. A job runs
+ * the systems of an op for a slice of their entities. Having more jobs than
+ * workers lets workers that are done steal jobs from workers that are behind. */
+#define ECS_WORKER_JOB_COUNT (4)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Load sync variable with acquire semantics. A thread that observes a new value
+ * must also observe the pipeline and stage state that was written before the
+ * value was published. Values are published with ecs_os_ainc/ecs_os_adec,
+ * which are full barriers in the OS API implementations. */
+static
+int32_t sync_load(
+    int32_t *ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return (int32_t)_InterlockedOr((volatile long*)ptr, 0);
+#else
+    return *(volatile int32_t*)ptr;
+#endif
+}
+
+/* Tell the CPU that the thread is in a spin loop, which reduces power usage and
+ * frees up resources for the other hardware thread on the same core. */
+static
+void sync_relax(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+    __asm__ __volatile__("yield");
+#endif
+#elif defined(_MSC_VER)
+#if defined(_M_IX86) || defined(_M_X64)
+    _mm_pause();
+#elif defined(_M_ARM) || defined(_M_ARM64)
+    __yield();
+#endif
+#endif
+}
+
+/* Wait until the main thread bumps the sync generation */
+static
+void wait_for_signal(
+    ecs_world_t *world,
+    int32_t sync_gen)
+{
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (sync_load(&world->sync_gen) != sync_gen) {
+            return;
+        }
+        sync_relax();
+    }
+
+    /* Park thread. The main thread checks workers_parked after bumping the
+     * generation, so either it sees this thread as parked, or this thread sees
+     * the new generation before it starts waiting. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while (sync_load(&world->sync_gen) == sync_gen) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
 /* Worker thread */
 static
 void* worker(void *arg) {
@@ -13946,13 +16818,13 @@ void* worker(void *arg) {
      * workers are ready */
     ecs_os_mutex_lock(world->sync_mutex);
     world->workers_running ++;
+    int32_t sync_gen = sync_load(&world->sync_gen);
+    ecs_os_mutex_unlock(world->sync_mutex);
 
     if (!world->quit_workers) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+        wait_for_signal(world, sync_gen);
     }
 
-    ecs_os_mutex_unlock(world->sync_mutex);
-
     while (!world->quit_workers) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
  
@@ -14013,20 +16885,34 @@ void wait_for_workers(
 /* Synchronize worker threads */
 static
 void sync_worker(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t stage_count = ecs_get_stage_count(world);
 
-    /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == stage_count) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    /* If stages are merged in entity order, sort the commands of the stage
+     * before synchronizing, so that queues are sorted in parallel instead of
+     * by the main thread during the merge. */
+    if (world->merge_by_entity) {
+        flecs_defer_sort(stage);
+    }
+
+    /* Read generation before signaling, as the main thread can only bump it
+     * after all workers are waiting */
+    int32_t sync_gen = sync_load(&world->sync_gen);
+
+    /* Signal that thread is waiting. Only wake up the main thread when all
+     * threads are waiting and the main thread stopped spinning. */
+    if (ecs_os_ainc(&world->workers_waiting) == stage_count) {
+        if (sync_load(&world->sync_parked)) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            ecs_os_cond_signal(world->sync_cond);
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
     }
 
     /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    wait_for_signal(world, sync_gen);
 }
 
 /* Wait until all threads are waiting on sync point */
@@ -14036,10 +16922,20 @@ void wait_for_sync(
 {
     int32_t stage_count = ecs_get_stage_count(world);
 
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (sync_load(&world->workers_waiting) == stage_count) {
+            return;
+        }
+        sync_relax();
+    }
+
     ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != stage_count) {
+    ecs_os_ainc(&world->sync_parked);
+    while (sync_load(&world->workers_waiting) != stage_count) {
         ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
     }
+    ecs_os_adec(&world->sync_parked);
     
     /* We should have been signalled unless all workers are waiting on sync */
     ecs_assert(world->workers_waiting == stage_count, 
@@ -14048,14 +16944,39 @@ void wait_for_sync(
     ecs_os_mutex_unlock(world->sync_mutex);
 }
 
+/* Reset the job queues of the workers and the chunk cursors of the systems in
+ * an op. This happens while all workers are waiting on the sync point, so no
+ * worker can claim a job or chunk. */
+static
+void reset_op_jobs(
+    ecs_world_t *world,
+    ecs_pipeline_op_t *op)
+{
+    if (op->multi_threaded) {
+        int32_t i;
+        for (i = 0; i < op->count; i ++) {
+            op->systems[i].chunk_cursor = 0;
+        }
+
+        ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+            stage->job_cursor = 0;
+        });
+    }
+}
+
 /* Signal workers that they can start/resume work */
 static
 void signal_workers(
     ecs_world_t *world)
 {
-    ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    ecs_os_ainc(&world->sync_gen);
+
+    /* Only take the lock if a worker stopped spinning */
+    if (sync_load(&world->workers_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_broadcast(world->worker_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
 }
 
 /** Stop worker threads */
@@ -14104,8 +17025,117 @@ bool ecs_stop_threads(
     return true;
 }
 
+/* Claim job from the queue of a worker. The queues are filled when an op
+ * starts and no jobs are added while the op runs, so both the worker that owns
+ * the queue and workers that steal from it take jobs from the front, with a
+ * single atomic increment. Returns -1 if the queue is empty. */
+static
+int32_t claim_job(
+    ecs_stage_t *queue)
+{
+    if (sync_load(&queue->job_cursor) >= ECS_WORKER_JOB_COUNT) {
+        return -1;
+    }
+
+    int32_t job = ecs_os_ainc(&queue->job_cursor) - 1;
+    if (job >= ECS_WORKER_JOB_COUNT) {
+        return -1;
+    }
+
+    return job;
+}
+
+/* Systems that use chunks or partition their groups distribute their entities
+ * over the workers themselves, and are ran once by each worker. Other multi
+ * threaded systems are divided into slices that are ran by jobs. */
+static
+bool is_sliced(
+    const EcsSystem *sys)
+{
+    return !sys->chunk_size && !sys->partition_groups;
+}
+
+/* Run the systems of an op for the slice of entities that belongs to a job.
+ * All systems of the op are ran for the same slice, in pipeline order. This
+ * ensures that an entity is processed by the systems of the op in order, as
+ * a slice contains the same entities for systems that match the same table. */
+static
+void run_job(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_pipeline_op_t *op,
+    int32_t job,
+    int32_t job_count,
+    FLECS_FLOAT delta_time)
+{
+    ecs_stage_t *s = NULL;
+    if (!op->no_staging) {
+        s = stage;
+    }
+
+    int32_t i;
+    for (i = 0; i < op->count; i ++) {
+        ecs_pipeline_op_system_t *op_sys = &op->systems[i];
+        EcsSystem *sys = (EcsSystem*)ecs_get(world, op_sys->system, EcsSystem);
+        ecs_assert(sys != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        if (is_sliced(sys)) {
+            ecs_run_intern(world, s, op_sys->system, sys, job, job_count, 
+                NULL, delta_time, 0, 0, NULL);
+        }
+    }
+}
+
 /* -- Private functions -- */
 
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_pipeline_op_t *op,
+    FLECS_FLOAT delta_time)
+{
+    ecs_stage_t *stages = ecs_vector_first(world->worker_stages, ecs_stage_t);
+    int32_t stage_count = ecs_vector_count(world->worker_stages);
+    int32_t stage_index = ecs_get_stage_id(stage->thread_ctx);
+    int32_t job_count = stage_count * ECS_WORKER_JOB_COUNT;
+    ecs_assert(stage_count > 1, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_stage_t *s = NULL;
+    if (!op->no_staging) {
+        s = stage;
+    }
+
+    /* Run systems that distribute their own entities first. Other workers can
+     * meanwhile steal jobs from the queue of this worker. */
+    int32_t i, job, sliced_count = 0;
+    for (i = 0; i < op->count; i ++) {
+        ecs_pipeline_op_system_t *op_sys = &op->systems[i];
+        EcsSystem *sys = (EcsSystem*)ecs_get(world, op_sys->system, EcsSystem);
+        ecs_assert(sys != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        if (is_sliced(sys)) {
+            sliced_count ++;
+        } else {
+            ecs_run_intern(world, s, op_sys->system, sys, stage_index, 
+                stage_count, &op_sys->chunk_cursor, delta_time, 0, 0, NULL);
+        }
+    }
+
+    if (!sliced_count) {
+        return;
+    }
+
+    /* Run the jobs in the queue of this worker first, then steal jobs from the
+     * queues of the other workers */
+    for (i = 0; i < stage_count; i ++) {
+        int32_t w = (stage_index + i) % stage_count;
+        while ((job = claim_job(&stages[w])) != -1) {
+            run_job(world, stage, op, w * ECS_WORKER_JOB_COUNT + job, 
+                job_count, delta_time);
+        }
+    }
+}
+
 void ecs_worker_begin(
     ecs_world_t *world)
 {
@@ -14127,6 +17157,7 @@ void ecs_worker_begin(
 
 int32_t ecs_worker_sync(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     const EcsPipelineQuery *pq,
     ecs_iter_t *it,
     int32_t i,
@@ -14148,7 +17179,7 @@ int32_t ecs_worker_sync(
     /* Synchronize all workers. The last worker to reach the sync point will
      * signal the main thread, which will perform the merge. */
     } else {
-        sync_worker(world);
+        sync_worker(world, stage);
     }
 
     if (build_count != world->stats.pipeline_build_count_total) {
@@ -14169,7 +17200,7 @@ int32_t ecs_worker_sync(
 void ecs_worker_end(
     ecs_world_t *world)
 {
-    flecs_stage_from_world(&world);
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
 
     int32_t stage_count = ecs_get_stage_count(world);
     ecs_assert(stage_count != 0, ECS_INTERNAL_ERROR, NULL);
@@ -14183,7 +17214,7 @@ void ecs_worker_end(
     /* Synchronize all workers. The last worker to reach the sync point will
      * signal the main thread, which will perform the merge. */
     } else {
-        sync_worker(world);
+        sync_worker(world, stage);
     }
 }
 
@@ -14230,6 +17261,8 @@ void ecs_workers_progress(
             /* Wait until all workers are waiting on sync point */
             wait_for_sync(world);
 
+            reset_op_jobs(world, op);
+
             /* Merge */
             if (!op->no_staging) {
                 ecs_staging_end(world);
@@ -14277,18 +17310,41 @@ void ecs_set_threads(
             world->worker_cond = ecs_os_cond_new();
             world->sync_cond = ecs_os_cond_new();
             world->sync_mutex = ecs_os_mutex_new();
+            world->workers_parked = 0;
+            world->sync_parked = 0;
             start_workers(world, threads);
         }
     }
 }
 
+void ecs_set_concurrent_systems(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!world->is_readonly, ECS_INVALID_WHILE_ITERATING, NULL);
+    world->concurrent_systems = enable;
+error:
+    return;
+}
+
 #endif
 
 
 #ifdef FLECS_PIPELINE
 
+static
+void free_ops(
+    ecs_vector_t *ops)
+{
+    ecs_vector_each(ops, ecs_pipeline_op_t, op, {
+        ecs_os_free(op->systems);
+    });
+    ecs_vector_free(ops);
+}
+
 static ECS_DTOR(EcsPipelineQuery, ptr, {
-    ecs_vector_free(ptr->ops);
+    free_ops(ptr->ops);
 })
 
 static
@@ -14536,6 +17592,168 @@ bool check_terms(
     return needs_merge;
 }
 
+static
+bool is_term_write(
+    ecs_term_t *term)
+{
+    ecs_term_id_t *subj = &term->subj;
+
+    switch(term->inout) {
+    case EcsInOut:
+    case EcsOut:
+        return true;
+    case EcsInOutDefault:
+        /* Default inout behavior is [inout] for This terms, and [in] for terms
+         * that match other entities */
+        return (subj->set.mask & EcsSelf) && (subj->entity == EcsThis);
+    default:
+        return false;
+    }
+}
+
+static
+bool is_term_access(
+    ecs_term_t *term)
+{
+    return term->oper != EcsNot && term->inout != EcsInOutFilter;
+}
+
+/* Two systems conflict if they access the same (component) id, and at least
+ * one of the systems writes it */
+static
+bool check_system_conflict(
+    ecs_filter_t *f1,
+    ecs_filter_t *f2)
+{
+    int32_t t1, t2;
+    for (t1 = 0; t1 < f1->term_count; t1 ++) {
+        ecs_term_t *term1 = &f1->terms[t1];
+        if (!is_term_access(term1)) {
+            continue;
+        }
+
+        bool write1 = is_term_write(term1);
+        ecs_id_t id1 = term1->id;
+
+        for (t2 = 0; t2 < f2->term_count; t2 ++) {
+            ecs_term_t *term2 = &f2->terms[t2];
+            if (!is_term_access(term2)) {
+                continue;
+            }
+
+            if (!write1 && !is_term_write(term2)) {
+                continue;
+            }
+
+            ecs_id_t id2 = term2->id;
+            if (ecs_id_match(id1, id2) || ecs_id_match(id2, id1)) {
+                return true;
+            }
+
+            /* Two wildcards can match the same id, even if they don't match
+             * each other, for example (Likes, *) and (*, Apples) */
+            if (ecs_id_is_wildcard(id1) && ecs_id_is_wildcard(id2)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Assign the systems of an op to groups that can run concurrently. Systems that
+ * conflict with each other are added to the same group, so that they're ran on
+ * the same thread in pipeline order. Groups are numbered in order of their
+ * first system, so that they can be divided round robin over the workers. 
+ * Groups are stored with the op, as a system can be part of more than one
+ * pipeline. */
+static
+void group_op_systems(
+    ecs_pipeline_op_t *op,
+    ecs_vector_t *systems)
+{
+    EcsSystem **sys = ecs_vector_first(systems, EcsSystem*);
+    ecs_pipeline_op_system_t *op_sys = op->systems;
+    int32_t i, j, k, count = ecs_vector_count(systems), group_count = 0;
+
+    for (i = 0; i < count; i ++) {
+        int32_t group = -1;
+
+        for (j = 0; j < i; j ++) {
+            int32_t other = op_sys[j].group;
+            if (other == group) {
+                continue;
+            }
+
+            if (!check_system_conflict(
+                &sys[i]->query->filter, &sys[j]->query->filter)) 
+            {
+                continue;
+            }
+
+            if (group == -1) {
+                group = other;
+            } else {
+                /* System conflicts with systems in two groups, merge them */
+                int32_t from = group > other ? group : other;
+                int32_t to = group < other ? group : other;
+                for (k = 0; k < i; k ++) {
+                    if (op_sys[k].group == from) {
+                        op_sys[k].group = to;
+                    }
+                }
+                group = to;
+            }
+        }
+
+        if (group == -1) {
+            group = group_count ++;
+        }
+
+        op_sys[i].group = group;
+    }
+
+    /* Merging groups can leave gaps. Renumber groups in order of appearance. */
+    int32_t next = 0;
+    for (i = 0; i < count; i ++) {
+        int32_t group = op_sys[i].group;
+        if (group < next) {
+            continue; /* Already renumbered */
+        }
+
+        for (k = i; k < count; k ++) {
+            if (op_sys[k].group == group) {
+                op_sys[k].group = next;
+            }
+        }
+        next ++;
+    }
+}
+
+/* Allocate data for the systems of an op once all systems have been added */
+static
+void finish_op(
+    ecs_pipeline_op_t *op,
+    ecs_vector_t *systems,
+    ecs_vector_t *entities)
+{
+    if (op && op->count) {
+        ecs_assert(op->count == ecs_vector_count(systems), 
+            ECS_INTERNAL_ERROR, NULL);
+        op->systems = ecs_os_calloc_n(ecs_pipeline_op_system_t, op->count);
+        group_op_systems(op, systems);
+
+        ecs_entity_t *e = ecs_vector_first(entities, ecs_entity_t);
+        int32_t i;
+        for (i = 0; i < op->count; i ++) {
+            op->systems[i].system = e[i];
+        }
+    }
+
+    ecs_vector_clear(systems);
+    ecs_vector_clear(entities);
+}
+
 static
 bool build_pipeline(
     ecs_world_t *world,
@@ -14561,10 +17779,12 @@ bool build_pipeline(
 
     ecs_pipeline_op_t *op = NULL;
     ecs_vector_t *ops = NULL;
+    ecs_vector_t *op_systems = NULL;
+    ecs_vector_t *op_entities = NULL;
     ecs_query_t *query = pq->build_query;
 
     if (pq->ops) {
-        ecs_vector_free(pq->ops);
+        free_ops(pq->ops);
     }
 
     bool multi_threaded = false;
@@ -14608,6 +17828,7 @@ bool build_pipeline(
             if (needs_merge) {
                 /* After merge all components will be merged, so reset state */
                 reset_write_state(&ws);
+                finish_op(op, op_systems, op_entities);
                 op = NULL;
 
                 /* Re-evaluate columns to set write flags if system is active.
@@ -14628,6 +17849,7 @@ bool build_pipeline(
                 op->count = 0;
                 op->multi_threaded = false;
                 op->no_staging = false;
+                op->systems = NULL;
             }
 
             /* Don't increase count for inactive systems, as they are ignored by
@@ -14638,10 +17860,19 @@ bool build_pipeline(
                     op->no_staging = no_staging;
                 }
                 op->count ++;
+
+                EcsSystem **elem = ecs_vector_add(&op_systems, EcsSystem*);
+                *elem = &sys[i];
+
+                ecs_entity_t *e = ecs_vector_add(&op_entities, ecs_entity_t);
+                *e = it.entities[i];
             }
         }
     }
 
+    finish_op(op, op_systems, op_entities);
+    ecs_vector_free(op_systems);
+    ecs_vector_free(op_entities);
     ecs_map_free(ws.components);
 
     /* Find the system ran last this frame (helps workers reset iter) */
@@ -14827,14 +18058,40 @@ void ecs_run_pipeline(
                 ecs_dbg_3("pipeline: run system %s", ecs_get_name(world, e));
             }
 
-            if (!stage_index || op->multi_threaded) {
+            /* Multi threaded systems run as jobs that are divided over the
+             * workers. Other systems run on the first worker, unless concurrent
+             * systems are enabled, in which case groups of systems are divided
+             * over the workers. */
+            bool run_system;
+            if (op->multi_threaded && stage_count > 1) {
+                if (!ran_since_merge) {
+                    ecs_worker_run_jobs(world, stage, op, delta_time);
+                }
+                run_system = false;
+            } else if (op->multi_threaded) {
+                run_system = true;
+            } else if (world->concurrent_systems && !op->no_staging) {
+                int32_t group = op->systems[ran_since_merge].group;
+                run_system = (group % stage_count) == stage_index;
+            } else {
+                run_system = !stage_index;
+            }
+
+            if (run_system) {
                 ecs_stage_t *s = NULL;
                 if (!op->no_staging) {
                     s = stage;
                 }
 
+                /* Chunk cursors are reset by the main thread at the sync point
+                 * that follows the op */
+                int32_t *chunk_cursor = NULL;
+                if (op->multi_threaded) {
+                    chunk_cursor = &op->systems[ran_since_merge].chunk_cursor;
+                }
+
                 ecs_run_intern(world, s, e, &sys[i], stage_index, 
-                    stage_count, delta_time, 0, 0, NULL);
+                    stage_count, chunk_cursor, delta_time, 0, 0, NULL);
             }
 
             sys[i].last_frame = world->stats.frame_count_total + 1;
@@ -14854,7 +18111,7 @@ void ecs_run_pipeline(
                  * current position (system). If there are a lot of systems
                  * in the pipeline this can be an expensive operation, but
                  * should happen infrequently. */
-                i = ecs_worker_sync(world, pq, &it, i, &op, &op_last);
+                i = ecs_worker_sync(world, stage, pq, &it, i, &op, &op_last);
                 sys = ecs_term(&it, EcsSystem, 1);
             }
         }
@@ -17475,10 +20732,15 @@ error:
  * - it improves the average performance of all queries
  * - it makes performance less dependent on how an application orders the terms
  * 
- * A possible improvement would be for the query engine to also consider
- * the number of tables that need to be evaluated for each term, as starting
- * with the smallest term reduces the amount of work. Other than static variable
- * analysis however, this can only be determined when the query is executed.
+ * The static variable analysis is combined with an estimate of the number of
+ * entities that each term matches at the time the rule is created, as starting
+ * with the smallest term reduces the amount of work. If a variable other than
+ * the elected root matches fewer entities, that variable becomes the root. Terms
+ * for the same variable are inserted in order of their estimate, so that the
+ * select operation for a variable iterates the smallest set of tables. If one
+ * of the terms can't be estimated, for example because it has a transitive
+ * relation, the estimates are not used. The estimates and the actual number of
+ * rows produced by each operation can be inspected with ecs_rule_plan_str.
  * 
  * Rules are "compiled" into a set of instructions that encode the operations
  * the query needs to perform in order to find the right set of entities.
@@ -17672,6 +20934,7 @@ typedef struct ecs_rule_with_ctx_t {
     ecs_id_record_t *idr;      /* Currently evaluated table set */
     ecs_table_cache_iter_t it;
     int32_t column;
+    int32_t table_index;       /* Index of table in set, used for partitioning */
 } ecs_rule_with_ctx_t;
 
 /* Subset context */
@@ -17686,6 +20949,8 @@ typedef struct ecs_rule_subset_ctx_t {
     ecs_rule_subset_frame_t storage[16]; /* Alloc-free array for small trees */
     ecs_rule_subset_frame_t *stack;
     int32_t sp;
+    ecs_closure_elem_t *closure;         /* Set when relation is indexed */
+    int32_t closure_index;
 } ecs_rule_subset_ctx_t;
 
 /* Superset context */
@@ -17699,6 +20964,8 @@ typedef struct ecs_rule_superset_ctx_t {
     ecs_rule_superset_frame_t *stack;
     ecs_id_record_t *idr;
     int32_t sp;
+    ecs_closure_elem_t *closure;           /* Set when relation is indexed */
+    int32_t closure_index;
 } ecs_rule_superset_ctx_t;
 
 /* Each context */
@@ -17731,6 +20998,7 @@ typedef struct ecs_rule_var_t {
     int32_t other;    /* Id to table variable (-1 if none exists) */
     int32_t occurs;   /* Number of occurrences (used for operation ordering) */
     int32_t depth;  /* Depth in dependency tree (used for operation ordering) */
+    int32_t estimate; /* Estimated number of entities (used for operation ordering) */
     bool marked;      /* Used for cycle detection */
 } ecs_rule_var_t;
 
@@ -17741,6 +21009,29 @@ typedef struct ecs_rule_term_vars_t {
     int32_t obj;
 } ecs_rule_term_vars_t;
 
+/* Result stored in rule cache */
+typedef struct ecs_rule_result_t {
+    ecs_table_t *table;
+    int32_t offset;
+    int32_t count;
+} ecs_rule_result_t;
+
+/* Cache with results of a rule, used when the rule is created with cached set
+ * to true. The cache is refilled when one of the tables that can contribute to
+ * the rule results is created, deleted or changed structurally. */
+typedef struct ecs_rule_cache_t {
+    ecs_vector_t *results;     /* vector<ecs_rule_result_t> */
+    ecs_vector_t *variables;   /* vector<ecs_entity_t>, var_count per result */
+    ecs_vector_t *ids;         /* vector<ecs_id_t>, term_count per result */
+    ecs_vector_t *subjects;    /* vector<ecs_entity_t>, term_count per result */
+    ecs_vector_t *columns;     /* vector<int32_t>, term_count per result */
+
+    int64_t dirty_state;       /* Sum of dirty state of watched tables */
+    int32_t table_generation;  /* Generation of table set at time of fill */
+    int32_t version;           /* Incremented each time cache is refilled */
+    bool valid;                /* Has the cache been filled */
+} ecs_rule_cache_t;
+
 /* Top-level rule datastructure */
 struct ecs_rule_t {
     ecs_header_t hdr;
@@ -17755,6 +21046,21 @@ struct ecs_rule_t {
     /* Variable ids used in terms */
     ecs_rule_term_vars_t term_vars[ECS_RULE_MAX_VAR_COUNT];
 
+    /* Estimated number of entities matched by each term when rule was created */
+    int32_t term_estimates[ECS_RULE_MAX_VAR_COUNT];
+
+    /* Order in which terms are inserted into the program */
+    int32_t term_order[ECS_RULE_MAX_VAR_COUNT];
+
+    /* Are estimates used to order operations */
+    bool use_estimates;
+
+    /* Cached results, if rule is cached */
+    ecs_rule_cache_t cache;
+
+    /* Operation of which the tables are divided across worker iterators */
+    int32_t partition_op;
+
     /* Variable array */
     ecs_rule_var_t vars[ECS_RULE_MAX_VAR_COUNT];
 
@@ -17860,6 +21166,7 @@ ecs_rule_var_t* create_variable(
     var->depth = UINT8_MAX;
     var->marked = false;
     var->occurs = 0;
+    var->estimate = INT32_MAX;
 
     return var;
 }
@@ -18738,7 +22045,8 @@ int32_t get_variable_depth(
 }
 
 /* Compare function used for qsort. It ensures that variables are first ordered
- * by depth, followed by how often they occur. */
+ * by depth, followed by their estimated number of entities and how often they
+ * occur. */
 static
 int compare_variable(
     const void* ptr1, 
@@ -18759,6 +22067,12 @@ int compare_variable(
         return 1;
     }
 
+    if (v1->estimate < v2->estimate) {
+        return -1;
+    } else if (v1->estimate > v2->estimate) {
+        return 1;
+    }
+
     if (v1->occurs < v2->occurs) {
         return 1;
     } else {
@@ -18811,6 +22125,166 @@ void ensure_all_variables(
     }    
 }
 
+/* Get id that matches all tables that can match the term, by replacing the
+ * variables in the term with wildcards. If wildcard_obj is true, the object of
+ * a pair is always replaced with a wildcard. */
+static
+ecs_id_t term_match_id(
+    ecs_term_t *term,
+    bool wildcard_obj)
+{
+    ecs_entity_t pred = term->pred.entity;
+    if (term_id_is_variable(&term->pred)) {
+        pred = EcsWildcard;
+    }
+
+    if (!obj_is_set(term)) {
+        return pred;
+    }
+
+    ecs_entity_t obj = term->obj.entity;
+    if (wildcard_obj || term_id_is_variable(&term->obj)) {
+        obj = EcsWildcard;
+    }
+
+    return ecs_pair(pred, obj);
+}
+
+/* Estimate the number of entities that match a term, by counting the entities
+ * in the tables of the id record for the term. Variables are replaced with
+ * wildcards, so the estimate is an upper bound for terms of which variables
+ * are resolved by other terms. Returns INT32_MAX if the term can't be
+ * estimated. */
+static
+int32_t estimate_term(
+    ecs_rule_t *rule,
+    ecs_term_t *term)
+{
+    if (term->subj.var == EcsVarIsEntity) {
+        /* Term with literal subject matches at most one entity */
+        return 1;
+    }
+
+    if (!term_id_is_variable(&term->pred) && obj_is_set(term) && 
+        ecs_has_id(rule->world, term->pred.entity, EcsTransitive)) 
+    {
+        /* Transitive terms also match subsets and supersets of the object,
+         * which are not included in the id record of the term. */
+        return INT32_MAX;
+    }
+
+    ecs_id_t id = term_match_id(term, false);
+    ecs_id_record_t *idr = flecs_get_id_record(rule->world, id);
+    if (!idr) {
+        return 0;
+    }
+
+    int64_t result = 0;
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            result += ecs_table_count(tr->hdr.table);
+        }
+    }
+
+    if (result > INT32_MAX) {
+        result = INT32_MAX;
+    }
+
+    return (int32_t)result;
+}
+
+/* Compute estimates for all terms, and the order in which the terms should be
+ * inserted into the program. Terms with the smallest estimates go first, so
+ * that the first operation for a variable iterates the smallest set. */
+static
+void estimate_terms(
+    ecs_rule_t *rule)
+{
+    ecs_term_t *terms = rule->filter.terms;
+    int32_t i, j, count = rule->filter.term_count;
+
+    rule->use_estimates = true;
+
+    for (i = 0; i < count; i ++) {
+        int32_t estimate = rule->term_estimates[i] = 
+            estimate_term(rule, &terms[i]);
+
+        /* If one of the terms can't be estimated, the estimates don't say 
+         * anything about which order is better. Keep the order of the terms
+         * as specified by the application. */
+        if (estimate == INT32_MAX) {
+            rule->use_estimates = false;
+        }
+
+        /* Insertion sort, so that terms with equal estimates keep the order in
+         * which they were specified */
+        for (j = i; j > 0; j --) {
+            int32_t prev = rule->term_order[j - 1];
+            if (rule->term_estimates[prev] <= estimate) {
+                break;
+            }
+            rule->term_order[j] = prev;
+        }
+        rule->term_order[j] = i;
+    }
+
+    if (!rule->use_estimates) {
+        for (i = 0; i < count; i ++) {
+            rule->term_order[i] = i;
+        }
+    }
+}
+
+/* Compute the depth of variables in the dependency tree with the provided
+ * root. Returns false if not all subject variables are reachable from root. */
+static
+bool compute_variable_depths(
+    ecs_rule_t *rule,
+    ecs_rule_var_t *root)
+{
+    ecs_term_t *terms = rule->filter.terms;
+    int32_t i, term_count = rule->filter.term_count;
+
+    for (i = 0; i < rule->var_count; i ++) {
+        rule->vars[i].depth = UINT8_MAX;
+        rule->vars[i].marked = false;
+    }
+
+    /* Variables in a term with a literal subject have depth 0 */
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &terms[i];
+
+        if (term->subj.var == EcsVarIsEntity) {
+            ecs_rule_var_t 
+            *pred = term_pred(rule, term),
+            *obj = term_obj(rule, term);
+
+            if (pred) {
+                pred->depth = 0;
+            }
+            if (obj) {
+                obj->depth = 0;
+            }
+        }
+    }
+
+    if (!root) {
+        return true;
+    }
+
+    root->depth = get_variable_depth(rule, root, root, 0);
+
+    for (i = 0; i < rule->subj_var_count; i ++) {
+        if (rule->vars[i].depth == UINT8_MAX) {
+            return false;
+        } 
+    }
+
+    return true;
+}
+
 /* Scan for variables, put them in optimal dependency order. */
 static
 int scan_variables(
@@ -18857,6 +22331,17 @@ int scan_variables(
                 max_occur = subj->occurs;
                 max_occur_var = subj->id;
             }
+
+            /* The estimate of a variable is the estimate of its most selective
+             * term. Optional terms don't constrain the variable. */
+            if (rule->use_estimates && !skip_term(term) && 
+                term->oper != EcsOptional) 
+            {
+                int32_t estimate = rule->term_estimates[i];
+                if (estimate < subj->estimate) {
+                    subj->estimate = estimate;
+                }
+            }
         }
     }
 
@@ -18864,24 +22349,6 @@ int scan_variables(
 
     ensure_all_variables(rule);
 
-    /* Variables in a term with a literal subject have depth 0 */
-    for (i = 0; i < term_count; i ++) {
-        ecs_term_t *term = &terms[i];
-
-        if (term->subj.var == EcsVarIsEntity) {
-            ecs_rule_var_t 
-            *pred = term_pred(rule, term),
-            *obj = term_obj(rule, term);
-
-            if (pred) {
-                pred->depth = 0;
-            }
-            if (obj) {
-                obj->depth = 0;
-            }
-        }
-    }
-
     /* Elect a root. This is either this (.) or the variable with the most
      * occurrences. */
     int32_t root_var = this_var;
@@ -18891,12 +22358,27 @@ int scan_variables(
             /* If no subject variables have been found, the rule expression only
              * operates on a fixed set of entities, in which case no root 
              * election is required. */
+            compute_variable_depths(rule, NULL);
             goto done;
         }
     }
 
-    ecs_rule_var_t *root = &rule->vars[root_var];
-    root->depth = get_variable_depth(rule, root, root, 0);
+    /* If another variable matches fewer entities than the elected root, start
+     * evaluating from that variable instead. This prevents the rule from first
+     * iterating a large set of entities that is then narrowed down by a term
+     * for a different variable. */
+    int32_t cost_root_var = root_var;
+    for (i = 0; i < rule->subj_var_count; i ++) {
+        if (rule->vars[i].estimate < rule->vars[cost_root_var].estimate) {
+            cost_root_var = i;
+        }
+    }
+
+    if (!compute_variable_depths(rule, &rule->vars[cost_root_var])) {
+        /* Not all variables can be reached from the cheapest variable, fall
+         * back to root election without estimates. */
+        compute_variable_depths(rule, &rule->vars[root_var]);
+    }
 
     /* Verify that there are no unconstrained variables. Unconstrained variables
      * are variables that are unreachable from the root. */
@@ -19916,7 +23398,7 @@ void compile_program(
     bool written[ECS_RULE_MAX_VAR_COUNT] = { false };
 
     ecs_term_t *terms = rule->filter.terms;
-    int32_t v, c, term_count = rule->filter.term_count;
+    int32_t v, c, t, term_count = rule->filter.term_count;
     ecs_rule_op_t *op;
 
     /* Insert input, which is always the first instruction */
@@ -19925,7 +23407,8 @@ void compile_program(
     /* First insert all instructions that do not have a variable subject. Such
      * instructions iterate the type of an entity literal and are usually good
      * candidates for quickly narrowing down the set of potential results. */
-    for (c = 0; c < term_count; c ++) {
+    for (t = 0; t < term_count; t ++) {
+        c = rule->term_order[t];
         ecs_term_t *term = &terms[c];
         if (skip_term(term)) {
             continue;
@@ -19949,7 +23432,10 @@ void compile_program(
 
         ecs_assert(var->kind == EcsRuleVarKindTable, ECS_INTERNAL_ERROR, NULL);
 
-        for (c = 0; c < term_count; c ++) {
+        /* Terms are inserted in order of estimated entity count, so that the
+         * term that selects the tables for the variable is the smallest */
+        for (t = 0; t < term_count; t ++) {
+            c = rule->term_order[t];
             ecs_term_t *term = &terms[c];
             if (skip_term(term)) {
                 continue;
@@ -20149,12 +23635,19 @@ ecs_rule_t* ecs_rule_init(
 {
     ecs_rule_t *result = ecs_poly_new(ecs_rule_t);
 
+    /* Rules cache their results instead of the tables matched by the filter,
+     * so the filter doesn't have to be cacheable */
+    ecs_filter_desc_t filter_desc = *desc;
+    filter_desc.cached = false;
+
     /* Parse the signature expression. This initializes the columns array which
      * contains the information about which components/pairs are requested. */
-    if (ecs_filter_init(world, &result->filter, desc)) {
+    if (ecs_filter_init(world, &result->filter, &filter_desc)) {
         goto error;
     }
 
+    result->filter.cached = desc->cached;
+
     result->world = world;
 
     /* Rule has no terms */
@@ -20178,6 +23671,11 @@ ecs_rule_t* ecs_rule_init(
         goto error;
     }
 
+    /* Estimate number of entities matched by terms, used to order operations.
+     * Make sure that tables are registered as (non) empty before estimating. */
+    flecs_process_pending_tables(world);
+    estimate_terms(result);
+
     /* Find all variables & resolve dependencies */
     if (scan_variables(result) != 0) {
         goto error;
@@ -20195,6 +23693,16 @@ ecs_rule_t* ecs_rule_init(
     /* Generate the opcode array */
     compile_program(result);
 
+    /* The first select operation is used to divide work between workers. Each
+     * worker evaluates the remainder of the program for its own tables. */
+    result->partition_op = -1;
+    for (i = 0; i < result->operation_count; i ++) {
+        if (result->operations[i].kind == EcsRuleSelect) {
+            result->partition_op = i;
+            break;
+        }
+    }
+
     /* Create array with variable names so this can be easily accessed by 
      * iterators without requiring access to the ecs_rule_t */
     create_variable_name_array(result);
@@ -20211,6 +23719,17 @@ error:
     return NULL;
 }
 
+static
+void rule_cache_fini(
+    ecs_rule_cache_t *cache)
+{
+    ecs_vector_free(cache->results);
+    ecs_vector_free(cache->variables);
+    ecs_vector_free(cache->ids);
+    ecs_vector_free(cache->subjects);
+    ecs_vector_free(cache->columns);
+}
+
 void ecs_rule_fini(
     ecs_rule_t *rule)
 {
@@ -20220,6 +23739,7 @@ void ecs_rule_fini(
     }
 
     ecs_filter_fini(&rule->filter);
+    rule_cache_fini(&rule->cache);
 
     ecs_os_free(rule->operations);
     ecs_os_free(rule);
@@ -20244,13 +23764,13 @@ ecs_rule_var_t* get_variable(
     return (ecs_rule_var_t*)&rule->vars[var_id];
 }
 
-/* Convert the program to a string. This can be useful to analyze how a rule is
- * being evaluated. */
-char* ecs_rule_str(
-    ecs_rule_t *rule)
+/* Convert the program to a string. If rows is provided, the string includes
+ * the estimated and actual number of rows for each operation. */
+static
+char* rule_str(
+    ecs_rule_t *rule,
+    const int64_t *rows)
 {
-    ecs_check(rule != NULL, ECS_INVALID_PARAMETER, NULL);
-    
     ecs_world_t *world = rule->world;
     ecs_strbuf_t buf = ECS_STRBUF_INIT;
     char filter_expr[256];
@@ -20287,6 +23807,25 @@ char* ecs_rule_str(
         ecs_strbuf_append(&buf, "%2d: [S:%2d, P:%2d, F:%2d, T:%2d] ", i, 
             op->frame, op->on_pass, op->on_fail, op->term);
 
+        if (rows) {
+            /* Only operations that evaluate a term have an estimate */
+            char estimate[16] = "-";
+            bool has_estimate = op->term != -1 && (
+                op->kind == EcsRuleSelect || op->kind == EcsRuleWith ||
+                op->kind == EcsRuleSubSet || op->kind == EcsRuleSuperSet);
+            if (has_estimate) {
+                int32_t e = rule->term_estimates[op->term];
+                if (e != INT32_MAX) {
+                    ecs_os_sprintf(estimate, "%d", e);
+                } else {
+                    ecs_os_strcpy(estimate, "?");
+                }
+            }
+
+            ecs_strbuf_append(&buf, "[E:%8s, A:%8lld] ", estimate, 
+                (long long)rows[i]);
+        }
+
         bool has_filter = false;
 
         switch(op->kind) {
@@ -20382,6 +23921,42 @@ char* ecs_rule_str(
     }
 
     return ecs_strbuf_get(&buf);
+}
+
+/* Convert the program to a string. This can be useful to analyze how a rule is
+ * being evaluated. */
+char* ecs_rule_str(
+    ecs_rule_t *rule)
+{
+    ecs_check(rule != NULL, ECS_INVALID_PARAMETER, NULL);
+    return rule_str(rule, NULL);
+error:
+    return NULL;
+}
+
+static
+ecs_iter_t rule_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule);
+
+/* Evaluate the rule and convert the program to a string that includes for each
+ * operation the estimated and the actual number of rows. This can be used to
+ * find out whether the estimates picked a good order for the operations. */
+char* ecs_rule_plan_str(
+    ecs_rule_t *rule)
+{
+    ecs_check(rule != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int64_t *rows = ecs_os_calloc_n(int64_t, rule->operation_count);
+
+    /* Always evaluate program, even if rule is cached */
+    ecs_iter_t it = rule_iter(rule->world, rule);
+    it.priv.iter.rule.profile = rows;
+    while (ecs_rule_next_instanced(&it)) { }
+
+    char *result = rule_str(rule, rows);
+    ecs_os_free(rows);
+    return result;
 error:
     return NULL;
 }
@@ -20434,6 +24009,12 @@ ecs_entity_t ecs_rule_get_var(
 
     /* We can only return entity variables */
     if (rule->vars[var_id].kind == EcsRuleVarKindEntity) {
+        if (it->cached) {
+            /* Registers aren't used when returning cached results */
+            ecs_entity_t e = iter->variables[var_id];
+            return e ? e : EcsWildcard;
+        }
+
         ecs_rule_reg_t *regs = get_register_frame(it, rule->frame_count - 1);
         return entity_reg_get(rule, regs, var_id);
     } else {
@@ -20460,6 +24041,10 @@ void ecs_rule_set_var(
     const ecs_rule_t *r = iter->rule;
     ecs_check(var_id < r->var_count, ECS_INVALID_PARAMETER, NULL);
 
+    /* Cache contains results for unconstrained variables, so the program must
+     * be evaluated when a variable is set */
+    iter->cached = false;
+
     entity_reg_set(r, iter->registers, var_id, value);
 
     /* Also set table variable if it exists */
@@ -20490,8 +24075,9 @@ void ecs_rule_iter_free(
     it->op_ctx = NULL;
 }
 
-/* Create rule iterator */
-ecs_iter_t ecs_rule_iter(
+/* Create rule iterator that evaluates the rule program */
+static
+ecs_iter_t rule_iter(
     const ecs_world_t *world,
     const ecs_rule_t *rule)
 {
@@ -20551,6 +24137,244 @@ ecs_iter_t ecs_rule_iter(
     return result;
 }
 
+/* Compute sum of the dirty state of all tables that can contribute to the rule
+ * results. Because dirty state only increases, the sum changes when entities 
+ * are added to or removed from any of these tables. Returns false if the state
+ * could not be determined without modifying tables in readonly mode. */
+static
+bool rule_cache_dirty_state(
+    ecs_rule_t *rule,
+    bool readonly,
+    int64_t *dirty_state_out)
+{
+    ecs_world_t *world = rule->world;
+    int64_t dirty_state = 0;
+    int32_t i, count = rule->filter.term_count;
+
+    for (i = 0; i <= count; i ++) {
+        ecs_id_t id;
+        if (i == count) {
+            /* Predicates and objects can match through IsA relations */
+            id = ecs_pair(EcsIsA, EcsWildcard);
+        } else {
+            ecs_term_t *term = &rule->filter.terms[i];
+
+            /* Transitive terms can match tables with any object */
+            bool transitive = !term_id_is_variable(&term->pred) && 
+                obj_is_set(term) && ecs_has_id(
+                    world, term->pred.entity, EcsTransitive);
+
+            id = term_match_id(term, transitive);
+        }
+
+        ecs_id_record_t *idr = flecs_get_id_record(world, id);
+        if (!idr) {
+            continue;
+        }
+
+        ecs_table_cache_iter_t it;
+        int32_t empty;
+        for (empty = 0; empty < 2; empty ++) {
+            if (empty) {
+                if (!flecs_table_cache_empty_iter(&idr->cache, &it)) {
+                    continue;
+                }
+            } else if (!flecs_table_cache_iter(&idr->cache, &it)) {
+                continue;
+            }
+
+            const ecs_table_record_t *tr;
+            while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+                ecs_table_t *table = tr->hdr.table;
+                if (!table->dirty_state && readonly) {
+                    return false;
+                }
+
+                dirty_state += flecs_table_get_dirty_state(table)[0];
+            }
+        }
+    }
+
+    *dirty_state_out = dirty_state;
+
+    return true;
+}
+
+/* Evaluate rule program and store results in cache */
+static
+void rule_cache_fill(
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = &rule->cache;
+    int32_t var_count = rule->var_count;
+    int32_t term_count = rule->filter.term_count;
+
+    ecs_vector_clear(cache->results);
+    ecs_vector_clear(cache->variables);
+    ecs_vector_clear(cache->ids);
+    ecs_vector_clear(cache->subjects);
+    ecs_vector_clear(cache->columns);
+
+    ecs_iter_t it = rule_iter(rule->world, rule);
+    while (ecs_rule_next_instanced(&it)) {
+        ecs_rule_result_t *result = ecs_vector_add(
+            &cache->results, ecs_rule_result_t);
+        result->table = it.table;
+        result->offset = it.offset;
+        result->count = it.count;
+
+        if (var_count) {
+            ecs_entity_t *variables = ecs_vector_addn(
+                &cache->variables, ecs_entity_t, var_count);
+            ecs_os_memcpy_n(variables, it.variables, ecs_entity_t, var_count);
+        }
+
+        ecs_id_t *ids = ecs_vector_addn(&cache->ids, ecs_id_t, term_count);
+        ecs_os_memcpy_n(ids, it.ids, ecs_id_t, term_count);
+
+        ecs_entity_t *subjects = ecs_vector_addn(
+            &cache->subjects, ecs_entity_t, term_count);
+        ecs_os_memcpy_n(subjects, it.subjects, ecs_entity_t, term_count);
+
+        int32_t *columns = ecs_vector_addn(
+            &cache->columns, int32_t, term_count);
+        ecs_os_memcpy_n(columns, it.columns, int32_t, term_count);
+    }
+
+    cache->version ++;
+    cache->valid = true;
+}
+
+/* Make sure cache is up to date. Returns false if the cache can't be used. */
+static
+bool rule_cache_update(
+    ecs_rule_t *rule)
+{
+    ecs_world_t *world = (ecs_world_t*)ecs_get_world(rule->world);
+    ecs_rule_cache_t *cache = &rule->cache;
+    int32_t table_generation = world->filter_cache.generation;
+    int64_t dirty_state;
+
+    /* The cache can't be refilled while iterators on other threads may be
+     * using it. When the world is readonly with a single stage, the only
+     * iterators are on the current thread. */
+    bool readonly = world->is_readonly && ecs_get_stage_count(world) > 1;
+
+    if (!rule_cache_dirty_state(rule, readonly, &dirty_state)) {
+        return false;
+    }
+
+    if (cache->valid && cache->table_generation == table_generation &&
+        cache->dirty_state == dirty_state)
+    {
+        return true;
+    }
+
+    if (readonly) {
+        return false;
+    }
+
+    rule_cache_fill(rule);
+    cache->table_generation = table_generation;
+    cache->dirty_state = dirty_state;
+
+    return true;
+}
+
+/* Return next result from rule cache */
+static
+bool rule_cache_next(
+    ecs_iter_t *it)
+{
+    ecs_rule_iter_t *iter = &it->priv.iter.rule;
+    const ecs_rule_t *rule = iter->rule;
+    const ecs_rule_cache_t *cache = &rule->cache;
+    ecs_check(cache->version == iter->cache_version, ECS_INVALID_OPERATION,
+        "rule cache was refilled while iterating");
+
+    int32_t i = iter->cache_index ++;
+
+    /* Cached results are distributed round-robin across workers */
+    if (iter->partition_count > 1) {
+        while (i % iter->partition_count != iter->partition_index) {
+            i = iter->cache_index ++;
+        }
+    }
+
+    if (i >= ecs_vector_count(cache->results)) {
+        iter->op = -1;
+        ecs_iter_fini(it);
+        return false;
+    }
+
+    int32_t var_count = rule->var_count;
+    int32_t term_count = rule->filter.term_count;
+    ecs_rule_result_t *result = ecs_vector_get(
+        cache->results, ecs_rule_result_t, i);
+
+    it->variables = iter->variables;
+    if (var_count) {
+        ecs_os_memcpy_n(it->variables, ecs_vector_get(cache->variables, 
+            ecs_entity_t, i * var_count), ecs_entity_t, var_count);
+    }
+
+    ecs_os_memcpy_n(it->ids, ecs_vector_get(cache->ids, 
+        ecs_id_t, i * term_count), ecs_id_t, term_count);
+    ecs_os_memcpy_n(it->subjects, ecs_vector_get(cache->subjects, 
+        ecs_entity_t, i * term_count), ecs_entity_t, term_count);
+
+    it->columns = rule_get_columns_frame(iter, 0);
+    ecs_os_memcpy_n(it->columns, ecs_vector_get(cache->columns, 
+        int32_t, i * term_count), int32_t, term_count);
+
+    flecs_iter_populate_data(rule->world, it, result->table, result->offset, 
+        result->count, it->ptrs, it->sizes);
+
+    return true;
+error:
+    return false;
+}
+
+/* Create rule iterator */
+ecs_iter_t ecs_rule_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    ecs_iter_t result = rule_iter(world, rule);
+
+    /* If rule is cached, iterator returns results from cache. The cache is
+     * logically part of the rule state, which is why it may be updated here */
+    if (rule->filter.cached && rule_cache_update((ecs_rule_t*)rule)) {
+        ecs_rule_iter_t *it = &result.priv.iter.rule;
+        it->cached = true;
+        it->cache_index = 0;
+        it->cache_version = rule->cache.version;
+    }
+
+    return result;
+}
+
+/* Create rule iterator for worker */
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count)
+{
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t result = ecs_rule_iter(world, rule);
+    ecs_rule_iter_t *it = &result.priv.iter.rule;
+    it->partition_index = index;
+    it->partition_count = count;
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
 /* Edge case: if the filter has the same variable for both predicate and
  * object, they are both resolved at the same time but at the time of 
  * evaluating the filter they're still wildcards which would match columns
@@ -20655,6 +24479,33 @@ ecs_table_record_t find_next_table(
 }
 
 
+/* Same as find_next_table, but skips tables that belong to other workers if
+ * the operation is used for partitioning. */
+static
+ecs_table_record_t find_next_partition_table(
+    ecs_rule_iter_t *iter,
+    int32_t op_index,
+    ecs_rule_filter_t *filter,
+    ecs_rule_with_ctx_t *op_ctx)
+{
+    bool partition = iter->partition_count > 1 && 
+        op_index == iter->rule->partition_op;
+
+    do {
+        ecs_table_record_t tr = find_next_table(filter, op_ctx);
+        if (!partition || !tr.hdr.table) {
+            return tr;
+        }
+
+        /* Tables are distributed round-robin across workers */
+        if ((op_ctx->table_index ++ % iter->partition_count) == 
+            iter->partition_index) 
+        {
+            return tr;
+        }
+    } while (true);
+}
+
 static
 ecs_id_record_t* find_tables(
     ecs_world_t *world,
@@ -20743,6 +24594,27 @@ bool eval_input(
     }
 }
 
+/* Yield next superset from closure index */
+static
+bool superset_closure_next(
+    const ecs_rule_t *rule,
+    ecs_rule_reg_t *regs,
+    int32_t r,
+    ecs_rule_superset_ctx_t *op_ctx)
+{
+    ecs_closure_elem_t *elem = op_ctx->closure;
+    int32_t index = op_ctx->closure_index;
+    if (index >= ecs_vector_count(elem->nodes)) {
+        return false;
+    }
+
+    ecs_closure_node_t *node = ecs_vector_get(
+        elem->nodes, ecs_closure_node_t, index);
+    reg_set_entity(rule, regs, r, node->entity);
+
+    return true;
+}
+
 static
 bool eval_superset(
     ecs_iter_t *it,
@@ -20799,6 +24671,16 @@ bool eval_superset(
             table = table_from_entity(world, obj).table;
         }
 
+        /* If the relation is indexed, iterate supersets from the closure */
+        op_ctx->closure = NULL;
+        if (!output_is_input && table) {
+            op_ctx->closure = flecs_closure_get_supersets(world, rel, table);
+            if (op_ctx->closure) {
+                op_ctx->closure_index = 0;
+                return superset_closure_next(rule, regs, r, op_ctx);
+            }
+        }
+
         int32_t column;
 
         /* If output variable is already set, check if it matches */
@@ -20834,6 +24716,9 @@ bool eval_superset(
         return true;
     } else if (output_is_input) {
         return false;
+    } else if (op_ctx->closure) {
+        op_ctx->closure_index ++;
+        return superset_closure_next(rule, regs, r, op_ctx);
     }
 
     sp = op_ctx->sp;
@@ -20873,6 +24758,30 @@ bool eval_superset(
     return false;
 }
 
+/* Yield next table with subsets from closure index */
+static
+bool subset_closure_next(
+    const ecs_rule_t *rule,
+    ecs_rule_reg_t *regs,
+    int32_t r,
+    int32_t term,
+    ecs_rule_subset_ctx_t *op_ctx)
+{
+    ecs_closure_elem_t *elem = op_ctx->closure;
+    int32_t index = op_ctx->closure_index;
+    if (index >= ecs_vector_count(elem->nodes)) {
+        return false;
+    }
+
+    ecs_closure_table_t *node = ecs_vector_get(
+        elem->nodes, ecs_closure_table_t, index);
+    table_reg_set(rule, regs, r, node->table);
+    set_term_vars(rule, regs, term, ecs_vector_get(node->table->type,
+        ecs_id_t, node->column)[0]);
+
+    return true;
+}
+
 static
 bool eval_subset(
     ecs_iter_t *it,
@@ -20900,6 +24809,19 @@ bool eval_subset(
     ecs_table_t *table = NULL;
 
     if (!redo) {
+        /* If the relation is indexed, iterate subsets from the closure */
+        op_ctx->closure = NULL;
+        if (!filter.same_var && ECS_HAS_ROLE(filter.mask, PAIR) && 
+            !ecs_id_is_wildcard(filter.mask)) 
+        {
+            op_ctx->closure = flecs_closure_get_subsets(world, 
+                ECS_PAIR_FIRST(filter.mask), ECS_PAIR_SECOND(filter.mask));
+            if (op_ctx->closure) {
+                op_ctx->closure_index = 0;
+                return subset_closure_next(rule, regs, r, op->term, op_ctx);
+            }
+        }
+
         op_ctx->stack = op_ctx->storage;
         sp = op_ctx->sp = 0;
         frame = &op_ctx->stack[sp];
@@ -20920,6 +24842,9 @@ bool eval_subset(
         frame->column = table_record.column;
         table_reg_set(rule, regs, r, (frame->table = table_record.hdr.table));
         goto yield;
+    } else if (op_ctx->closure) {
+        op_ctx->closure_index ++;
+        return subset_closure_next(rule, regs, r, op->term, op_ctx);
     }
 
     do {
@@ -21079,6 +25004,12 @@ bool eval_select(
         ecs_assert(regs[r].table.table == iter->registers[r].table.table, 
             ECS_INTERNAL_ERROR, NULL);
 
+        /* A table set by the application can't be divided across workers, so
+         * only the first worker evaluates it */
+        if (iter->partition_index && op_index == rule->partition_op) {
+            return false;
+        }
+
         table = iter->registers[r].table.table;
 
         /* Check if table can be found in the id record. If not, the provided 
@@ -21095,9 +25026,11 @@ bool eval_select(
     if (!redo) {
         if (!table) {
             flecs_table_cache_iter(&idr->cache, &op_ctx->it);
+            op_ctx->table_index = 0;
 
             /* Return the first table_record in the table set. */
-            table_record = find_next_table(&filter, op_ctx);
+            table_record = find_next_partition_table(
+                iter, op_index, &filter, op_ctx);
         
             /* If no table record was found, there are no results. */
             if (!table_record.hdr.table) {
@@ -21132,7 +25065,8 @@ bool eval_select(
                 return false;
             }
 
-            table_record = find_next_table(&filter, op_ctx);
+            table_record = find_next_partition_table(
+                iter, op_index, &filter, op_ctx);
             if (!table_record.hdr.table) {
                 return false;
             }
@@ -21792,6 +25726,35 @@ void populate_iterator(
         iter->ptrs, iter->sizes);
 }
 
+/* Number of rows produced by an operation, used for profiling */
+static
+int64_t op_row_count(
+    const ecs_rule_t *rule,
+    ecs_rule_iter_t *it,
+    ecs_rule_op_t *op)
+{
+    int32_t r = UINT8_MAX;
+    if (op->has_out) {
+        r = op->r_out;
+    } else if (op->has_in) {
+        r = op->r_in;
+    }
+
+    if (r == UINT8_MAX || rule->vars[r].kind != EcsRuleVarKindTable) {
+        return 1;
+    }
+
+    ecs_rule_reg_t *regs = get_register_frame(it, op->frame);
+    ecs_table_slice_t slice = table_reg_get(rule, regs, r);
+    if (slice.count) {
+        return slice.count;
+    } else if (slice.table) {
+        return ecs_table_count(slice.table);
+    }
+
+    return 0;
+}
+
 static
 bool is_control_flow(
     ecs_rule_op_t *op)
@@ -21841,6 +25804,18 @@ bool ecs_rule_next_instanced(
 
     flecs_iter_init(it);
 
+    if (iter->cached) {
+        return rule_cache_next(it);
+    }
+
+    /* If the program has no operation that can be divided across workers, the
+     * first worker evaluates the entire program */
+    if (iter->partition_index && rule->partition_op == -1) {
+        iter->op = -1;
+        ecs_iter_fini(it);
+        return false;
+    }
+
     /* Make sure that if there are any terms with literal subjects, they're
      * initialized in the subjects array */
     if (init_subjects) {
@@ -21889,6 +25864,11 @@ bool ecs_rule_next_instanced(
         bool result = eval_op(it, op, op_index, redo);
         iter->op = result ? op->on_pass : op->on_fail;
 
+        /* Yield returns false to make the program backtrack */
+        if (iter->profile && (result || op->kind == EcsRuleYield)) {
+            iter->profile[op_index] += op_row_count(rule, iter, op);
+        }
+
         /* If the current operation is yield, return results */
         if (op->kind == EcsRuleYield) {
             populate_iterator(rule, it, iter, op);
@@ -25211,6 +29191,34 @@ error:
     return -1;
 }
 
+/* Find the bitmask constant with the lowest value larger than prev that is
+ * contained in value. Constants are appended in the order of their values, so
+ * that the output doesn't depend on the order in which the map stores them. */
+static
+ecs_bitmask_constant_t* expr_ser_bitmask_next(
+    const EcsBitmask *bitmask_type,
+    uint32_t value,
+    bool first,
+    ecs_map_key_t prev,
+    ecs_map_key_t *key_out)
+{
+    ecs_bitmask_constant_t *result = NULL, *constant;
+    ecs_map_key_t key;
+
+    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
+    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
+        if ((!first && key <= prev) || ((value & key) != key)) {
+            continue;
+        }
+        if (!result || key < *key_out) {
+            result = constant;
+            *key_out = key;
+        }
+    }
+
+    return result;
+}
+
 /* Serialize bitmask */
 static
 int expr_ser_bitmask(
@@ -25223,22 +29231,23 @@ int expr_ser_bitmask(
     ecs_check(bitmask_type != NULL, ECS_INVALID_PARAMETER, NULL);
 
     uint32_t value = *(uint32_t*)ptr;
-    ecs_map_key_t key;
+    ecs_map_key_t key = 0;
     ecs_bitmask_constant_t *constant;
     int count = 0;
 
     ecs_strbuf_list_push(str, "", "|");
 
-    /* Multiple flags can be set at a given time. Iterate through all the flags
-     * and append the ones that are set. */
-    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
-    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
-        if ((value & key) == key) {
-            ecs_strbuf_list_appendstr(str, 
-                ecs_get_name(world, constant->constant));
-            count ++;
-            value -= (uint32_t)key;
-        }
+    /* Multiple flags can be set at a given time. Append the ones that are set,
+     * in order of their values. */
+    bool first = true;
+    while ((constant = expr_ser_bitmask_next(
+        bitmask_type, value, first, key, &key)))
+    {
+        ecs_strbuf_list_appendstr(str, 
+            ecs_get_name(world, constant->constant));
+        value -= (uint32_t)key;
+        first = false;
+        count ++;
     }
 
     if (value != 0) {
@@ -25989,6 +29998,12 @@ void ecs_get_world_stats(
     record_counter(&s->merge_count_total, t, world->stats.merge_count_total);
     record_counter(&s->pipeline_build_count_total, t, world->stats.pipeline_build_count_total);
     record_counter(&s->systems_ran_frame, t, world->stats.systems_ran_frame);
+    record_gauge(&s->stack_page_count, t, world->stats.stack_page_count);
+    record_counter(&s->stack_alloc_count_total, t, 
+        world->stats.stack_alloc_count_total);
+    record_gauge(&s->pool_block_count, t, world->stats.pool_block_count);
+    record_counter(&s->pool_alloc_count_total, t, 
+        world->stats.pool_alloc_count_total);
 
     if (delta_world_time != 0.0f && delta_frame_count != 0.0f) {
         record_gauge(
@@ -26015,6 +30030,9 @@ void ecs_get_world_stats(
     int32_t empty_table_count = 0;
     int32_t singleton_table_count = 0;
     int32_t matched_table_count = 0, matched_entity_count = 0;
+    int32_t edge_count = 0, edge_memory = 0;
+
+    flecs_table_graph_memory(&world->store.root, &edge_count, &edge_memory);
 
     int32_t i, count = flecs_sparse_count(&world->store.tables);
     for (i = 0; i < count; i ++) {
@@ -26022,6 +30040,8 @@ void ecs_get_world_stats(
             ecs_table_t, i);
         int32_t entity_count = ecs_table_count(table);
 
+        flecs_table_graph_memory(table, &edge_count, &edge_memory);
+
         if (!entity_count) {
             empty_table_count ++;
         }
@@ -26045,6 +30065,8 @@ void ecs_get_world_stats(
     record_gauge(&s->table_count, t, count);
     record_gauge(&s->empty_table_count, t, empty_table_count);
     record_gauge(&s->singleton_table_count, t, singleton_table_count);
+    record_gauge(&s->table_edge_count, t, edge_count);
+    record_gauge(&s->table_edge_memory, t, edge_memory);
 
 error:
     return;
@@ -26260,6 +30282,8 @@ void ecs_dump_world_stats(
     print_gauge("table count", t, &s->table_count);
     print_gauge("singleton table count", t, &s->singleton_table_count);
     print_gauge("empty table count", t, &s->empty_table_count);
+    print_gauge("table edge count", t, &s->table_edge_count);
+    print_gauge("table edge memory", t, &s->table_edge_memory);
     printf("\n");
     print_counter("deferred new operations", t, &s->new_count);
     print_counter("deferred bulk_new operations", t, &s->bulk_new_count);
@@ -27302,6 +31326,10 @@ ecs_data_t* duplicate_data(
 
     ecs_data_t *result = ecs_os_calloc(ECS_SIZEOF(ecs_data_t));
 
+    /* Columns are allocated from the world, as restoring the snapshot moves
+     * them into the table */
+    ecs_allocator_t *a = &((ecs_world_t*)world)->allocator;
+
     ecs_type_t storage_type = table->storage_type;
     int32_t i, column_count = ecs_vector_count(storage_type);
     ecs_entity_t *components = ecs_vector_first(storage_type, ecs_entity_t);
@@ -27330,8 +31358,9 @@ ecs_data_t* duplicate_data(
 
         if (cdata && (copy = cdata->lifecycle.copy)) {
             int32_t count = ecs_vector_count(column->data);
-            ecs_vector_t *dst_vec = ecs_vector_new_t(size, alignment, count);
-            ecs_vector_set_count_t(&dst_vec, size, alignment, count);
+            ecs_vector_t *dst_vec = flecs_vector_new_t(
+                a, size, alignment, count);
+            flecs_vector_set_count_t(a, &dst_vec, size, alignment, count);
             void *dst_ptr = ecs_vector_first_t(dst_vec, size, alignment);
             void *ctx = cdata->lifecycle.ctx;
             
@@ -27347,7 +31376,8 @@ ecs_data_t* duplicate_data(
 
             column->data = dst_vec;
         } else {
-            column->data = ecs_vector_copy_t(column->data, size, alignment);
+            column->data = flecs_vector_copy_t(
+                a, column->data, size, alignment);
         }
     }
 
@@ -27587,6 +31617,9 @@ void restore_filtered(
             ecs_entity_t e = entities[i];
             ecs_record_t *r = ecs_eis_get(world, e);
             if (r && r->table) {
+                if (r->table->flags & EcsTableHasClosure) {
+                    flecs_closure_table_dirty(world, r->table);
+                }
                 flecs_table_delete(world, r->table, &r->table->storage, 
                     ECS_RECORD_TO_ROW(r->row), true);
             } else {
@@ -27601,6 +31634,11 @@ void restore_filtered(
 
         flecs_table_merge(world, table, table, &table->storage, snapshot_table->data);
 
+        /* Restored entities can be pair objects */
+        if (table->flags & EcsTableHasClosure) {
+            flecs_closure_table_dirty(world, table);
+        }
+
         /* Run OnSet systems for merged entities */
         if (new_count) {
             flecs_notify_on_set(
@@ -27813,7 +31851,8 @@ ecs_entity_t ecs_run_intern(
     ecs_entity_t system,
     EcsSystem *system_data,
     int32_t stage_current,
-    int32_t stage_count,    
+    int32_t stage_count,
+    int32_t *chunk_cursor,
     FLECS_FLOAT delta_time,
     int32_t offset,
     int32_t limit,
@@ -27862,7 +31901,17 @@ ecs_entity_t ecs_run_intern(
     ecs_defer_begin(thread_ctx);
 
     /* Prepare the query iterator */
-    ecs_iter_t pit, wit, qit = ecs_query_iter(thread_ctx, system_data->query);
+    ecs_iter_t pit, wit, qit;
+    bool multi_threaded = stage_count > 1 && system_data->multi_threaded;
+    if (multi_threaded && system_data->partition_groups) {
+        /* Each worker iterates its own groups of the query */
+        qit = ecs_query_group_worker_iter(thread_ctx, system_data->query,
+            stage_current, stage_count);
+        multi_threaded = false;
+    } else {
+        qit = ecs_query_iter(thread_ctx, system_data->query);
+    }
+
     ecs_iter_t *it = &qit;
 
     if (offset || limit) {
@@ -27870,8 +31919,14 @@ ecs_entity_t ecs_run_intern(
         it = &pit;
     }
 
-    if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_current, stage_count);
+    bool chunked = false;
+    if (multi_threaded) {
+        if (system_data->chunk_size && chunk_cursor) {
+            wit = ecs_chunk_iter(it, chunk_cursor, system_data->chunk_size);
+            chunked = true;
+        } else {
+            wit = ecs_worker_iter(it, stage_current, stage_count);
+        }
         it = &wit;
     }
 
@@ -27902,6 +31957,11 @@ ecs_entity_t ecs_run_intern(
         }
     }
 
+    /* A run callback may stop before all chunks are iterated */
+    if (chunked && wit.is_valid) {
+        ecs_iter_fini(&wit);
+    }
+
     if (measure_time) {
         system_data->time_spent += (float)ecs_time_measure(&time_start);
     }
@@ -27929,8 +31989,8 @@ ecs_entity_t ecs_run_w_filter(
         world, system, EcsSystem);
     assert(system_data != NULL);
 
-    return ecs_run_intern(world, stage, system, system_data, 0, 0, delta_time, 
-        offset, limit, param);
+    return ecs_run_intern(world, stage, system, system_data, 0, 0, NULL, 
+        delta_time, offset, limit, param);
 }
 
 ecs_entity_t ecs_run_worker(
@@ -27948,7 +32008,7 @@ ecs_entity_t ecs_run_worker(
     assert(system_data != NULL);
 
     return ecs_run_intern(
-        world, stage, system, system_data, stage_current, stage_count, 
+        world, stage, system, system_data, stage_current, stage_count, NULL,
         delta_time, 0, 0, param);
 }
 
@@ -28129,6 +32189,9 @@ ecs_entity_t ecs_system_init(
             return 0;
         }
 
+        ecs_check(!desc->partition_groups || query->group_by, 
+            ECS_INVALID_PARAMETER, "partition_groups requires group_by");
+
         /* Re-obtain pointer, as query may have added components */
         system = ecs_get_mut(world, result, EcsSystem, &added);
         ecs_assert(added == false, ECS_INTERNAL_ERROR, NULL);
@@ -28156,6 +32219,8 @@ ecs_entity_t ecs_system_init(
 
         system->multi_threaded = desc->multi_threaded;
         system->no_staging = desc->no_staging;
+        system->chunk_size = desc->chunk_size;
+        system->partition_groups = desc->partition_groups;
 
         /* If tables have been matched with this system it is active, and we
          * should activate the in terms, if any. This will ensure that any
@@ -28257,6 +32322,12 @@ ecs_entity_t ecs_system_init(
         if (desc->no_staging) {
             system->no_staging = desc->no_staging;
         }
+        if (desc->chunk_size) {
+            system->chunk_size = desc->chunk_size;
+        }
+        if (desc->partition_groups) {
+            system->partition_groups = desc->partition_groups;
+        }
     }
 
     return result;
@@ -28559,6 +32630,34 @@ error:
     return -1;
 }
 
+/* Find the bitmask constant with the lowest value larger than prev that is
+ * contained in value. Constants are appended in the order of their values, so
+ * that the output doesn't depend on the order in which the map stores them. */
+static
+ecs_bitmask_constant_t* json_ser_bitmask_next(
+    const EcsBitmask *bitmask_type,
+    uint32_t value,
+    bool first,
+    ecs_map_key_t prev,
+    ecs_map_key_t *key_out)
+{
+    ecs_bitmask_constant_t *result = NULL, *constant;
+    ecs_map_key_t key;
+
+    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
+    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
+        if ((!first && key <= prev) || ((value & key) != key)) {
+            continue;
+        }
+        if (!result || key < *key_out) {
+            result = constant;
+            *key_out = key;
+        }
+    }
+
+    return result;
+}
+
 /* Serialize bitmask */
 static
 int json_ser_bitmask(
@@ -28571,7 +32670,7 @@ int json_ser_bitmask(
     ecs_check(bitmask_type != NULL, ECS_INVALID_PARAMETER, NULL);
 
     uint32_t value = *(uint32_t*)ptr;
-    ecs_map_key_t key;
+    ecs_map_key_t key = 0;
     ecs_bitmask_constant_t *constant;
 
     if (!value) {
@@ -28581,15 +32680,16 @@ int json_ser_bitmask(
 
     ecs_strbuf_list_push(str, "\"", "|");
 
-    /* Multiple flags can be set at a given time. Iterate through all the flags
-     * and append the ones that are set. */
-    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
-    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
-        if ((value & key) == key) {
-            ecs_strbuf_list_appendstr(str, 
-                ecs_get_name(world, constant->constant));
-            value -= (uint32_t)key;
-        }
+    /* Multiple flags can be set at a given time. Append the ones that are set,
+     * in order of their values. */
+    bool first = true;
+    while ((constant = json_ser_bitmask_next(
+        bitmask_type, value, first, key, &key)))
+    {
+        ecs_strbuf_list_appendstr(str, 
+            ecs_get_name(world, constant->constant));
+        value -= (uint32_t)key;
+        first = false;
     }
 
     if (value != 0) {
@@ -34198,10 +38298,12 @@ ecs_world_t* flecs_suspend_readonly(
     ecs_stage_t *stage = flecs_stage_from_world(&temp_world);
     state->defer_count = stage->defer;
     state->defer_queue = stage->defer_queue;
+    state->defer_cursor = stage->defer_cursor;
     state->scope = world->stage.scope;
     state->with = world->stage.with;
     stage->defer = 0;
     stage->defer_queue = NULL;
+    stage->defer_cursor = flecs_stack_get_cursor(&stage->defer_stack);
 
     if (&world->stage != (ecs_stage_t*)stage_world) {
         world->stage.scope = stage->scope;
@@ -34230,6 +38332,7 @@ void flecs_resume_readonly(
         world->is_readonly = state->is_readonly;
         stage->defer = state->defer_count;
         stage->defer_queue = state->defer_queue;
+        stage->defer_cursor = state->defer_cursor;
         world->stage.scope = state->scope;
         world->stage.with = state->with;
     }
@@ -34411,12 +38514,14 @@ void init_store(
     ecs_os_memset(&world->store, 0, ECS_SIZEOF(ecs_store_t));
     
     /* Initialize entity index */
-    flecs_sparse_init(&world->store.entity_index, ecs_record_t);
+    flecs_sparse_init_w_allocator(&world->store.entity_index, ecs_record_t,
+        &world->allocator);
     flecs_sparse_set_id_source(&world->store.entity_index, 
         &world->stats.last_id);
 
     /* Initialize root table */
-    flecs_sparse_init(&world->store.tables, ecs_table_t);
+    flecs_sparse_init_w_allocator(&world->store.tables, ecs_table_t,
+        &world->allocator);
 
     /* Initialize table map */
     flecs_table_hashmap_init(&world->store.table_map);
@@ -34629,8 +38734,10 @@ ecs_world_t *ecs_mini(void) {
     ecs_poly_init(world, ecs_world_t);
 
     world->self = world;
+    flecs_allocator_init(&world->allocator);
     world->type_info = flecs_sparse_new(ecs_type_info_t);
-    ecs_map_init(&world->id_index, ecs_id_record_t*, ECS_HI_COMPONENT_ID);
+    ecs_map_init_w_allocator(&world->id_index, ecs_id_record_t*, 
+        ECS_HI_COMPONENT_ID, &world->allocator);
     flecs_observable_init(&world->observable);
     world->iterable.init = world_iter_init;
 
@@ -34649,6 +38756,8 @@ ecs_world_t *ecs_mini(void) {
     world->stats.time_scale = 1.0;
     
     monitors_init(&world->monitors);
+    flecs_filter_cache_init(&world->filter_cache);
+    flecs_closure_init(world);
 
     if (ecs_os_has_time()) {
         ecs_os_get_time(&world->world_start_time);
@@ -35145,7 +39254,7 @@ ecs_id_record_t* new_id_record(
     ecs_id_t id)
 {
     ecs_id_record_t *idr = ecs_os_calloc_t(ecs_id_record_t);
-    ecs_table_cache_init(&idr->cache);
+    ecs_table_cache_init(&idr->cache, &world->allocator);
 
     ecs_entity_t rel = 0, obj = 0;
     if (ECS_HAS_ROLE(id, PAIR)) {
@@ -35282,6 +39391,8 @@ void fini_misc(
 {
     ecs_map_fini(&world->type_handles);
     ecs_vector_free(world->fini_tasks);
+    flecs_filter_cache_fini(&world->filter_cache);
+    flecs_closure_fini(world);
 }
 
 /* The destroyer of worlds */
@@ -35347,6 +39458,9 @@ int ecs_fini(
     
     fini_misc(world);
 
+    /* Storage allocated from the pools has been freed at this point */
+    flecs_allocator_fini(&world->allocator);
+
     ecs_os_enable_high_timer_resolution(false);
 
     /* End of the world */
@@ -35691,11 +39805,33 @@ FLECS_FLOAT ecs_frame_begin(
 
     ecs_force_aperiodic(world);
 
+    world->is_in_frame = true;
+
     return world->stats.delta_time;
 error:
     return (FLECS_FLOAT)0;
 }
 
+static
+void stage_collect_stack_stats(
+    ecs_world_t *world,
+    ecs_stack_t *stack)
+{
+    world->stats.stack_page_count += stack->page_count;
+    world->stats.stack_alloc_count_total += stack->alloc_count;
+    stack->alloc_count = 0;
+}
+
+static
+void stage_frame_end(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    stage_collect_stack_stats(world, &stage->defer_stack);
+    stage_collect_stack_stats(world, &stage->frame_stack);
+    flecs_stack_reset(&stage->frame_stack);
+}
+
 void ecs_frame_end(
     ecs_world_t *world)
 {
@@ -35706,7 +39842,18 @@ void ecs_frame_end(
 
     ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
         flecs_stage_merge_post_frame(world, stage);
-    });        
+    });
+
+    /* Collect allocator statistics from stages, release frame memory */
+    world->stats.stack_page_count = 0;
+    stage_frame_end(world, &world->stage);
+    ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+        stage_frame_end(world, stage);
+    });
+
+    world->is_in_frame = false;
+    world->stats.pool_block_count = world->allocator.block_count;
+    world->stats.pool_alloc_count_total = world->allocator.alloc_count;
 
     if (world->locking_enabled) {
         ecs_unlock(world);
@@ -35734,6 +39881,12 @@ void flecs_notify_queries(
 {
     ecs_poly_assert(world, ecs_world_t); 
 
+    if (event->kind == EcsQueryTableMatch || 
+        event->kind == EcsQueryTableUnmatch) 
+    {
+        flecs_filter_cache_invalidate(world);
+    }
+
     int32_t i, count = flecs_sparse_count(world->queries);
     for (i = 0; i < count; i ++) {
         ecs_query_t *query = flecs_sparse_get_dense(
@@ -35807,6 +39960,11 @@ void flecs_process_pending_tables(
             /* For each id in the table, add it to the empty/non empty list
              * based on its current state */
             if (flecs_table_records_update_empty(table)) {
+                /* Closures only contain non-empty tables */
+                if (table->flags & EcsTableHasClosure) {
+                    flecs_closure_table_dirty(world, table);
+                }
+
                 /* Only emit an event when there was a change in the 
                  * administration. It is possible that a table ended up in the
                  * pending_tables list by going from empty->non-empty, but then
@@ -37026,6 +41184,7 @@ int ecs_filter_init(
     f.filter = desc->filter;
     f.instanced = desc->instanced;
     f.match_empty_tables = desc->match_empty_tables;
+    f.cached = desc->cached;
     f.match_anything = true;
 
     if (terms) {
@@ -37121,6 +41280,13 @@ int ecs_filter_init(
         goto error;
     }
 
+    if (f.cached && !flecs_filter_is_cacheable(&f)) {
+        char *filter_str = ecs_filter_str(world, &f);
+        ecs_warn("cannot cache filter '%s': only terms that match This or "
+            "supersets of This can be cached", filter_str);
+        ecs_os_free(filter_str);
+    }
+
     *filter_out = f;
     if (f.term_cache_used) {
         filter_out->terms = filter_out->term_cache;
@@ -37675,13 +41841,25 @@ void term_iter_init_no_data(
 static
 void term_iter_init_wildcard(
     const ecs_world_t *world,
-    ecs_term_iter_t *iter)
+    ecs_term_iter_t *iter,
+    bool empty_tables)
 {
     iter->term = (ecs_term_t){ .index = -1 };
     iter->self_index = flecs_get_id_record(world, EcsAny);
     iter->cur = iter->self_index;
-    flecs_table_cache_iter(&iter->self_index->cache, &iter->it);
     iter->index = 0;
+
+    if (empty_tables) {
+        if ((empty_tables = flecs_table_cache_empty_iter(
+            &iter->self_index->cache, &iter->it)))
+        {
+            iter->empty_tables = true;
+        }
+    }
+
+    if (!empty_tables) {
+        flecs_table_cache_iter(&iter->self_index->cache, &iter->it);
+    }
 }
 
 static
@@ -38065,8 +42243,20 @@ ecs_iter_t ecs_filter_iter(
 
     filter = init_filter_iter(world, &it, filter);
 
+    ecs_filter_cache_elem_t *cache_elem = NULL;
+    if (filter->cached && flecs_filter_is_cacheable(filter)) {
+        cache_elem = flecs_filter_cache_get((ecs_world_t*)world, filter);
+    }
+
+    if (cache_elem) {
+        /* Tables matching the filter were found by a previous iterator */
+        iter->kind = EcsIterEvalCache;
+        iter->cache_elem = cache_elem;
+        iter->cache_version = cache_elem->version;
+        iter->cache_index = 0;
+
     /* Find term that represents smallest superset */
-    if (filter->match_this) {
+    } else if (filter->match_this) {
         ecs_term_t *terms = filter->terms;
         int32_t pivot_term = -1;
         ecs_check(terms != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -38082,14 +42272,13 @@ ecs_iter_t ecs_filter_iter(
         } else if (pivot_term == -1) {
             /* No terms meet the criteria to be a pivot term, evaluate filter
              * against all tables */
-            term_iter_init_wildcard(world, &iter->term_iter);
+            term_iter_init_wildcard(world, &iter->term_iter, 
+                filter->match_empty_tables);
         } else {
             ecs_assert(pivot_term >= 0, ECS_INTERNAL_ERROR, NULL);
             term_iter_init(world, &terms[pivot_term], &iter->term_iter,
                 filter->match_empty_tables);
         }
-
-        iter->term_iter.empty_tables = filter->match_empty_tables;
     } else {
         if (!filter->match_anything) {
             iter->kind = EcsIterEvalCondition;
@@ -38192,17 +42381,28 @@ bool ecs_filter_next_instanced(
         } while (!match);
 
         goto yield;
-    } else if (kind == EcsIterEvalIndex || kind == EcsIterEvalCondition) {
+    } else if (kind == EcsIterEvalIndex || kind == EcsIterEvalCondition ||
+        kind == EcsIterEvalCache) 
+    {
         ecs_term_iter_t *term_iter = &iter->term_iter;
         ecs_term_t *term = &term_iter->term;
-        int32_t pivot_term = term->index;
+        int32_t pivot_term = kind == EcsIterEvalCache ? -1 : term->index;
         bool first;
 
         do {
             first = iter->matches_left == 0;
 
             if (first) {
-                if (kind != EcsIterEvalCondition) {
+                if (kind == EcsIterEvalCache) {
+                    /* Cached tables are known to match the filter, but the
+                     * columns for the terms still need to be resolved */
+                    table = flecs_filter_cache_next(iter);
+                    if (!table) {
+                        goto done;
+                    }
+
+                    iter->matches_left = 1;
+                } else if (kind != EcsIterEvalCondition) {
                     /* Find new match, starting with the leading term */
                     if (!term_iter_next(world, term_iter, 
                         filter->match_prefab, filter->match_disabled)) 
@@ -38467,6 +42667,123 @@ int32_t type_search_relation(
     return -1;
 }
 
+/* Search subtree of ancestor in closure. Produces the same result as
+ * type_search_relation, without having to find the relation pairs in the type
+ * of each traversed table. */
+static
+int32_t closure_search_node(
+    const ecs_world_t *world,
+    ecs_closure_node_t *nodes,
+    int32_t index,
+    int32_t offset,
+    ecs_id_t id,
+    ecs_id_record_t *idr,
+    bool is_a,
+    int32_t min_depth,
+    int32_t max_depth,
+    ecs_entity_t *subject_out,
+    ecs_id_t *id_out,
+    ecs_table_record_t **tr_out)
+{
+    ecs_closure_node_t *node = &nodes[index];
+    ecs_entity_t obj = node->entity;
+    int32_t r, depth = node->depth;
+
+    ecs_record_t *rec = ecs_eis_get_any(world, obj);
+    ecs_assert(rec != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_table_t *table = rec->table;
+    if (!table) {
+        return -1;
+    }
+
+    if (depth >= min_depth) {
+        ecs_type_t type = table->type;
+        ecs_id_t *ids = ecs_vector_first(type, ecs_id_t);
+
+        if (offset) {
+            r = type_offset_search(offset, id, ids, ecs_vector_count(type), 
+                id_out);
+        } else {
+            r = type_search(table, idr, ids, id_out, tr_out);
+        }
+
+        if (r != -1) {
+            goto found;
+        }
+    }
+
+    if (depth < max_depth && (!is_a || 
+        type_can_inherit_id(world, table, idr, id))) 
+    {
+        int32_t child = index + 1;
+        while (child < node->end) {
+            r = closure_search_node(world, nodes, child, offset, id, idr, is_a,
+                min_depth, max_depth, subject_out, id_out, tr_out);
+            if (r != -1) {
+                goto found;
+            }
+            child = nodes[child].end;
+        }
+    }
+
+    if (!is_a) {
+        r = type_search_relation(world, table, offset, id, idr, 
+            ecs_pair(EcsIsA, EcsWildcard), world->idr_isa_wildcard, 
+                1, INT_MAX, subject_out, id_out, tr_out);
+        if (r != -1) {
+            goto found;
+        }
+    }
+
+    return -1;
+found:
+    if (subject_out && !subject_out[0]) {
+        subject_out[0] = ecs_get_alive(world, obj);
+    }
+    return r;
+}
+
+static
+int32_t closure_search_relation(
+    const ecs_world_t *world,
+    const ecs_table_t *table,
+    ecs_closure_elem_t *elem,
+    int32_t offset,
+    ecs_id_t id,
+    ecs_id_record_t *idr,
+    bool is_a,
+    int32_t min_depth,
+    int32_t max_depth,
+    ecs_entity_t *subject_out,
+    ecs_id_t *id_out,
+    ecs_table_record_t **tr_out)
+{
+    int32_t r = type_search_relation(world, table, offset, id, idr, 0, NULL, 
+        min_depth, max_depth, subject_out, id_out, tr_out);
+    if (r != -1) {
+        return r;
+    }
+
+    if (is_a && !type_can_inherit_id(world, table, idr, id)) {
+        return -1;
+    }
+
+    ecs_closure_node_t *nodes = ecs_vector_first(
+        elem->nodes, ecs_closure_node_t);
+    int32_t i = 0, count = ecs_vector_count(elem->nodes);
+    while (i < count) {
+        r = closure_search_node(world, nodes, i, offset, id, idr, is_a,
+            min_depth, max_depth, subject_out, id_out, tr_out);
+        if (r != -1) {
+            return r;
+        }
+        i = nodes[i].end;
+    }
+
+    return -1;
+}
+
 int32_t ecs_search_relation(
     const ecs_world_t *world,
     const ecs_table_t *table,
@@ -38494,6 +42811,22 @@ int32_t ecs_search_relation(
 
     max_depth = INT_MAX * !max_depth + max_depth * !!max_depth;
 
+    if (rel && max_depth) {
+        ecs_closure_elem_t *elem = flecs_closure_get_supersets(
+            world, rel, table);
+
+        /* Supersets that can be reached by more than one path are only stored
+         * for the first path, which could be at the wrong depth when the 
+         * search is limited to a range of depths. */
+        if (elem && (!elem->pruned || (min_depth <= 1 && 
+            max_depth == INT_MAX))) 
+        {
+            return closure_search_relation(world, table, elem, offset, id, idr, 
+                rel == EcsIsA, min_depth, max_depth, subject_out, id_out, 
+                    tr_out);
+        }
+    }
+
     int32_t result = type_search_relation(world, table, offset, id, idr, 
         ecs_pair(rel, EcsWildcard), NULL, min_depth, max_depth, subject_out, 
             id_out, tr_out);
@@ -39016,10 +43349,12 @@ void table_cache_list_insert(
 }
 
 void ecs_table_cache_init(
-    ecs_table_cache_t *cache)
+    ecs_table_cache_t *cache,
+    ecs_allocator_t *allocator)
 {
     ecs_assert(cache != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_map_init(&cache->index, ecs_table_cache_hdr_t*, 0);
+    ecs_map_init_w_allocator(&cache->index, ecs_table_cache_hdr_t*, 0, 
+        allocator);
 }
 
 void ecs_table_cache_fini(
@@ -39610,7 +43945,9 @@ bool ecs_os_has_threading(void) {
         (ecs_os_api.cond_signal_ != NULL) &&
         (ecs_os_api.cond_broadcast_ != NULL) &&
         (ecs_os_api.thread_new_ != NULL) &&
-        (ecs_os_api.thread_join_ != NULL);   
+        (ecs_os_api.thread_join_ != NULL) &&
+        (ecs_os_api.ainc_ != NULL) &&
+        (ecs_os_api.adec_ != NULL);   
 }
 
 bool ecs_os_has_time(void) {
@@ -41101,22 +45438,481 @@ void qsort_array(
     qsort_array(world, table, data, entities, ptr, size, p + 1, hi, compare); 
 }
 
+#ifdef FLECS_META
+
+/* Comparators returned by ecs_meta_order_by. Queries that use one of these
+ * sort large tables with a radix sort. */
+#define FLECS_COMPARE_PRIMITIVE(T)\
+    static\
+    int compare_##T(\
+        ecs_entity_t e1,\
+        const void *ptr1,\
+        ecs_entity_t e2,\
+        const void *ptr2)\
+    {\
+        (void)e1; (void)e2;\
+        T v1 = *(const T*)ptr1;\
+        T v2 = *(const T*)ptr2;\
+        return (v1 > v2) - (v1 < v2);\
+    }
+
+FLECS_COMPARE_PRIMITIVE(ecs_bool_t)
+FLECS_COMPARE_PRIMITIVE(ecs_char_t)
+FLECS_COMPARE_PRIMITIVE(ecs_byte_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u8_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u16_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u32_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u64_t)
+FLECS_COMPARE_PRIMITIVE(ecs_uptr_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i8_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i16_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i32_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i64_t)
+FLECS_COMPARE_PRIMITIVE(ecs_iptr_t)
+FLECS_COMPARE_PRIMITIVE(ecs_f32_t)
+FLECS_COMPARE_PRIMITIVE(ecs_f64_t)
+FLECS_COMPARE_PRIMITIVE(ecs_entity_t)
+
+/* Find primitive kind of component, or of the first member of a struct */
+static
+ecs_primitive_kind_t order_by_primitive_kind(
+    const ecs_world_t *world,
+    ecs_entity_t component)
+{
+    const EcsPrimitive *ptr = ecs_get(world, component, EcsPrimitive);
+    if (!ptr) {
+        const EcsStruct *st = ecs_get(world, component, EcsStruct);
+        if (st && ecs_vector_count(st->members)) {
+            ecs_member_t *m = ecs_vector_first(st->members, ecs_member_t);
+            if (!m->offset && m->count == 1) {
+                ptr = ecs_get(world, m->type, EcsPrimitive);
+            }
+        }
+    }
+
+    if (!ptr || ptr->kind == EcsString) {
+        return 0;
+    }
+
+    return ptr->kind;
+}
+
+static
+ecs_order_by_action_t order_by_primitive_compare(
+    ecs_primitive_kind_t kind)
+{
+    switch(kind) {
+    case EcsBool: return compare_ecs_bool_t;
+    case EcsChar: return compare_ecs_char_t;
+    case EcsByte: return compare_ecs_byte_t;
+    case EcsU8: return compare_ecs_u8_t;
+    case EcsU16: return compare_ecs_u16_t;
+    case EcsU32: return compare_ecs_u32_t;
+    case EcsU64: return compare_ecs_u64_t;
+    case EcsUPtr: return compare_ecs_uptr_t;
+    case EcsI8: return compare_ecs_i8_t;
+    case EcsI16: return compare_ecs_i16_t;
+    case EcsI32: return compare_ecs_i32_t;
+    case EcsI64: return compare_ecs_i64_t;
+    case EcsIPtr: return compare_ecs_iptr_t;
+    case EcsF32: return compare_ecs_f32_t;
+    case EcsF64: return compare_ecs_f64_t;
+    case EcsEntity: return compare_ecs_entity_t;
+    default: return NULL;
+    }
+}
+
+ecs_order_by_action_t ecs_meta_order_by(
+    const ecs_world_t *world,
+    ecs_entity_t type)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(type != 0, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    return order_by_primitive_compare(order_by_primitive_kind(world, type));
+error:
+    return NULL;
+}
+
+/* Convert primitive value to unsigned key with the same ordering */
+static
+uint64_t radix_key(
+    ecs_primitive_kind_t kind,
+    const void *ptr)
+{
+    const uint64_t sign = 1ull << 63;
+
+    switch(kind) {
+    case EcsBool: return *(const ecs_bool_t*)ptr;
+    case EcsByte: return *(const ecs_byte_t*)ptr;
+    case EcsU8: return *(const ecs_u8_t*)ptr;
+    case EcsU16: return *(const ecs_u16_t*)ptr;
+    case EcsU32: return *(const ecs_u32_t*)ptr;
+    case EcsU64: return *(const ecs_u64_t*)ptr;
+    case EcsUPtr: return *(const ecs_uptr_t*)ptr;
+    case EcsEntity: return *(const ecs_entity_t*)ptr;
+    case EcsChar: return (uint64_t)(int64_t)*(const ecs_char_t*)ptr ^ sign;
+    case EcsI8: return (uint64_t)(int64_t)*(const ecs_i8_t*)ptr ^ sign;
+    case EcsI16: return (uint64_t)(int64_t)*(const ecs_i16_t*)ptr ^ sign;
+    case EcsI32: return (uint64_t)(int64_t)*(const ecs_i32_t*)ptr ^ sign;
+    case EcsI64: return (uint64_t)*(const ecs_i64_t*)ptr ^ sign;
+    case EcsIPtr: return (uint64_t)(int64_t)*(const ecs_iptr_t*)ptr ^ sign;
+    case EcsF32:
+    case EcsF64: {
+        /* Flip all bits of negative numbers, and the sign bit of positive
+         * numbers so that the bit pattern sorts like the value */
+        ecs_f64_t v;
+        if (kind == EcsF32) {
+            v = (ecs_f64_t)*(const ecs_f32_t*)ptr;
+        } else {
+            v = *(const ecs_f64_t*)ptr;
+        }
+        uint64_t bits;
+        ecs_os_memcpy(&bits, &v, ECS_SIZEOF(uint64_t));
+        if (bits & sign) {
+            return ~bits;
+        } else {
+            return bits | sign;
+        }
+    }
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Sort table with an LSD radix sort on the primitive value of the order_by
+ * component. The sort computes a permutation of row indices first, so that
+ * table rows only have to be moved once. */
 static
-void sort_table(
+void radix_sort_table(
     ecs_world_t *world,
     ecs_table_t *table,
-    int32_t column_index,
+    ecs_data_t *data,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_primitive_kind_t kind)
+{
+    uint64_t *keys = ecs_os_malloc_n(uint64_t, count * 2);
+    int32_t *rows = ecs_os_malloc_n(int32_t, count * 2);
+    uint64_t *keys_tmp = &keys[count];
+    int32_t *rows_tmp = &rows[count];
+    int32_t i, shift;
+
+    /* Compute histograms for all digits in a single pass over the keys */
+    int32_t histogram[8][256] = {{0}};
+    for (i = 0; i < count; i ++) {
+        uint64_t key = keys[i] = radix_key(kind, ECS_ELEM(ptr, size, i));
+        rows[i] = i;
+        for (shift = 0; shift < 8; shift ++) {
+            histogram[shift][(key >> (shift * 8)) & 0xFF] ++;
+        }
+    }
+
+    for (shift = 0; shift < 64; shift += 8) {
+        int32_t *offsets = histogram[shift / 8];
+
+        /* Skip pass if all keys have the same digit */
+        if (offsets[(keys[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        int32_t b, offset = 0;
+        for (b = 0; b < 256; b ++) {
+            int32_t b_count = offsets[b];
+            offsets[b] = offset;
+            offset += b_count;
+        }
+
+        for (i = 0; i < count; i ++) {
+            int32_t dst = offsets[(keys[i] >> shift) & 0xFF] ++;
+            keys_tmp[dst] = keys[i];
+            rows_tmp[dst] = rows[i];
+        }
+
+        uint64_t *keys_swap = keys; keys = keys_tmp; keys_tmp = keys_swap;
+        int32_t *rows_swap = rows; rows = rows_tmp; rows_tmp = rows_swap;
+    }
+
+    flecs_table_permute(world, table, data, rows, 0, count);
+
+    ecs_os_free(ECS_MIN(keys, keys_tmp));
+    ecs_os_free(ECS_MIN(rows, rows_tmp));
+}
+
+#endif
+
+/* Sort all rows of a table. The radix sort and insertion sort preserve the
+ * order of rows with equal keys, the quicksort does not. The order of rows that
+ * compare equal is therefore undefined after a sort. */
+static
+void sort_table_rows(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare,
+    int32_t kind)
+{
+#ifdef FLECS_META
+    if (kind && count >= ECS_SORT_RADIX_THRESHOLD) {
+        radix_sort_table(world, table, data, ptr, size, count, 
+            (ecs_primitive_kind_t)kind);
+        return;
+    }
+#else
+    (void)kind;
+#endif
+
+    qsort_array(world, table, data, entities, ptr, size, 0, count - 1, compare);
+}
+
+static
+void insertion_sort_array(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t first,
+    int32_t count,
+    ecs_order_by_action_t compare)
+{
+    int32_t i, j;
+    for (i = first; i < count; i ++) {
+        for (j = i; j > 0; j --) {
+            void *el_1 = ECS_ELEM(ptr, size, j - 1);
+            void *el_2 = ECS_ELEM(ptr, size, j);
+            if (compare(entities[j - 1], el_1, entities[j], el_2) <= 0) {
+                break;
+            }
+
+            flecs_table_swap(world, table, data, j - 1, j);
+        }
+    }
+}
+
+/* Sort row indices by value with a merge sort */
+static
+void sort_rows(
+    const ecs_entity_t *entities,
+    const void *ptr,
+    int32_t size,
+    int32_t *rows,
+    int32_t *tmp,
+    int32_t count,
+    ecs_order_by_action_t compare)
+{
+    if (count < 2) {
+        return;
+    }
+
+    int32_t half = count / 2;
+    sort_rows(entities, ptr, size, rows, tmp, half, compare);
+    sort_rows(entities, ptr, size, &rows[half], tmp, count - half, compare);
+
+    int32_t i = 0, j = half, k = 0;
+    while (i < half && j < count) {
+        int32_t r1 = rows[i], r2 = rows[j];
+        if (compare(entities[r2], ECS_ELEM(ptr, size, r2), 
+            entities[r1], ECS_ELEM(ptr, size, r1)) < 0) 
+        {
+            tmp[k ++] = r2;
+            j ++;
+        } else {
+            tmp[k ++] = r1;
+            i ++;
+        }
+    }
+
+    while (i < half) {
+        tmp[k ++] = rows[i ++];
+    }
+    while (j < count) {
+        tmp[k ++] = rows[j ++];
+    }
+
+    ecs_os_memcpy_n(rows, tmp, int32_t, count);
+}
+
+/* Find index in sorted rows before which row should be inserted */
+static
+int32_t find_insert_row(
+    const ecs_entity_t *entities,
+    const void *ptr,
+    int32_t size,
+    const int32_t *rows,
+    int32_t count,
+    int32_t row,
     ecs_order_by_action_t compare)
+{
+    const void *el = ECS_ELEM(ptr, size, row);
+    int32_t lo = 0, hi = count;
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2, cur = rows[mid];
+        if (compare(entities[row], el, 
+            entities[cur], ECS_ELEM(ptr, size, cur)) < 0) 
+        {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/* Rows of a table that moved after merging changed rows into unchanged rows.
+ * Used to patch sorted table slices without comparing all rows again. */
+typedef struct sort_patch_t {
+    ecs_query_table_match_t *match;
+    int32_t *new_rows;      /* New row for each old row, -1 if row changed */
+    int32_t *changed;       /* New rows of changed rows, in sorted order */
+    int32_t changed_count;
+} sort_patch_t;
+
+/* Sort table of which only rows with a row state newer than 'since' changed
+ * since the last sort. The other rows are still in order. The algorithm is
+ * selected by the number of changed rows:
+ * - no changed rows: the table is left untouched, without comparing rows
+ * - up to count / ECS_SORT_MERGE_RATIO: the changed rows are sorted, and their
+ *   positions among the unchanged rows are found with a binary search. Only
+ *   the range of rows that moved is then reordered. The new rows are stored in
+ *   patch, which is used to patch the sorted table slices.
+ * - otherwise: the table is sorted again with sort_table_rows.
+ * Returns whether rows were moved. */
+static
+bool sort_changed_rows(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare,
+    int32_t kind,
+    const int32_t *row_states,
+    int32_t since,
+    sort_patch_t *patch)
+{
+    int32_t i, changed_count = 0;
+    for (i = 0; i < count; i ++) {
+        changed_count += row_states[i] > since;
+    }
+
+    if (!changed_count) {
+        return false;
+    }
+
+    if (changed_count > count / ECS_SORT_MERGE_RATIO) {
+        sort_table_rows(
+            world, table, data, entities, ptr, size, count, compare, kind);
+        return true;
+    }
+
+    /* Split rows in unchanged rows, which are still in order, and changed 
+     * rows. The second half of the buffer holds the new order of the rows. */
+    int32_t unchanged_count = count - changed_count;
+    int32_t *rows = ecs_os_malloc_n(int32_t, count * 2);
+    int32_t *unchanged = rows, *changed = &rows[unchanged_count];
+    int32_t *order = &rows[count];
+    int32_t u = 0, c = 0;
+    for (i = 0; i < count; i ++) {
+        if (row_states[i] > since) {
+            changed[c ++] = i;
+        } else {
+            unchanged[u ++] = i;
+        }
+    }
+
+    sort_rows(entities, ptr, size, changed, order, changed_count, compare);
+
+    /* Merge changed rows into unchanged rows */
+    int32_t prev = 0, out = 0;
+    for (c = 0; c < changed_count; c ++) {
+        int32_t row = changed[c];
+        int32_t pos = prev + find_insert_row(entities, ptr, size, 
+            &unchanged[prev], unchanged_count - prev, row, compare);
+        for (; prev < pos; prev ++) {
+            order[out ++] = unchanged[prev];
+        }
+        order[out ++] = row;
+    }
+    for (; prev < unchanged_count; prev ++) {
+        order[out ++] = unchanged[prev];
+    }
+
+    /* Store new rows before order is used to permute the table */
+    patch->new_rows = ecs_os_malloc_n(int32_t, count + changed_count);
+    patch->changed = &patch->new_rows[count];
+    patch->changed_count = changed_count;
+    for (i = 0, c = 0; i < count; i ++) {
+        int32_t row = order[i];
+        if (row_states[row] > since) {
+            patch->new_rows[row] = -1;
+            patch->changed[c ++] = i;
+        } else {
+            patch->new_rows[row] = i;
+        }
+    }
+
+    /* Only reorder the range of rows that moved */
+    int32_t first = 0, last = count - 1;
+    while (first < count && order[first] == first) {
+        first ++;
+    }
+    while (last > first && order[last] == last) {
+        last --;
+    }
+
+    bool moved = first < count;
+    if (moved) {
+        flecs_table_permute(world, table, data, &order[first], first, 
+            last - first + 1);
+    }
+
+    ecs_os_free(rows);
+
+    return moved;
+}
+
+/* Sort table. When only component values changed since the last sort
+ * (incremental is true) the table is often still (almost) in order. If the
+ * table tracks which rows changed (row_states is not NULL), the algorithm is
+ * selected by sort_changed_rows, which may store the new rows in patch.
+ * Otherwise first count the number of rows that
+ * are out of order. If there are none the table is left untouched, if there 
+ * are only a few the table is fixed up with an insertion sort, which only moves
+ * the rows that are out of place. Other tables fall back to sort_table_rows,
+ * which does not preserve the order of rows with equal keys. Returns whether
+ * rows were moved. */
+static
+bool sort_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column_index,
+    ecs_order_by_action_t compare,
+    int32_t kind,
+    bool incremental,
+    const int32_t *row_states,
+    int32_t since,
+    sort_patch_t *patch)
 {
     ecs_data_t *data = &table->storage;
     if (!data->entities) {
         /* Nothing to sort */
-        return;
+        return false;
     }
 
     int32_t count = flecs_table_data_count(data);
     if (count < 2) {
-        return;
+        return false;
     }
 
     ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
@@ -41129,7 +45925,44 @@ void sort_table(
         ptr = ecs_vector_first_t(column->data, size, column->alignment);
     }
 
-    qsort_array(world, table, data, entities, ptr, size, 0, count - 1, compare);
+    if (!incremental) {
+        sort_table_rows(
+            world, table, data, entities, ptr, size, count, compare, kind);
+        return true;
+    }
+
+    if (row_states) {
+        return sort_changed_rows(world, table, data, entities, ptr, size, 
+            count, compare, kind, row_states, since, patch);
+    }
+
+    int32_t i, first = 0, unsorted = 0;
+    for (i = 1; i < count; i ++) {
+        void *el_1 = ECS_ELEM(ptr, size, i - 1);
+        void *el_2 = ECS_ELEM(ptr, size, i);
+        if (compare(entities[i - 1], el_1, entities[i], el_2) > 0) {
+            if (!unsorted) {
+                first = i;
+            }
+            if (++ unsorted > ECS_SORT_INSERTION_THRESHOLD) {
+                break;
+            }
+        }
+    }
+
+    if (!unsorted) {
+        return false;
+    }
+
+    if (unsorted <= ECS_SORT_INSERTION_THRESHOLD) {
+        insertion_sort_array(
+            world, table, data, entities, ptr, size, first, count, compare);
+    } else {
+        sort_table_rows(
+            world, table, data, entities, ptr, size, count, compare, kind);
+    }
+
+    return true;
 }
 
 /* Helper struct for building sorted table ranges */
@@ -41168,75 +46001,78 @@ ecs_entity_t e_from_helper(
     }
 }
 
+/* Initialize helper for the rows of a table match. Returns false if the table
+ * has no entities. */
 static
-void build_sorted_table_range(
+bool init_sort_helper(
     ecs_query_t *query,
-    ecs_query_table_list_t *list)
+    ecs_query_table_match_t *match,
+    sort_helper_t *helper)
 {
     ecs_world_t *world = query->world;
     ecs_entity_t id = query->order_by_component;
-    ecs_order_by_action_t compare = query->order_by;
-    
-    if (!list->count) {
-        return;
-    }
+    ecs_table_t *table = match->table;
+    ecs_data_t *data = &table->storage;
+    ecs_vector_t *entities;
 
-    int to_sort = 0;
+    if (!(entities = data->entities) || !ecs_table_count(table)) {
+        return false;
+    }
 
-    sort_helper_t *helper = ecs_os_malloc_n(sort_helper_t, list->count);
-    ecs_query_table_node_t *cur, *end = list->last->next;
-    for (cur = list->first; cur != end; cur = cur->next) {
-        ecs_query_table_match_t *match = cur->match;
-        ecs_table_t *table = match->table;
-        ecs_data_t *data = &table->storage;
-        ecs_vector_t *entities;
+    int32_t index = -1;
+    if (id) {
+        index = ecs_search(world, table->storage_table, id, 0);
+    }
 
-        if (!(entities = data->entities) || !ecs_table_count(table)) {
-            continue;
-        }
+    if (index != -1) {
+        ecs_column_t *column = &data->columns[index];
+        int16_t size = column->size;
+        int16_t align = column->alignment;
+        helper->ptr = ecs_vector_first_t(column->data, size, align);
+        helper->elem_size = size;
+        helper->shared = false;
+    } else if (id) {
+        /* Find component in prefab */
+        ecs_entity_t base = 0;
+        ecs_search_relation(world, table, 0, id, 
+            EcsIsA, 1, 0, &base, NULL, NULL);
 
-        int32_t index = -1;
-        if (id) {
-            index = ecs_search(world, table->storage_table, id, 0);
-        }
+        /* If a base was not found, the query should not have allowed using
+         * the component for sorting */
+        ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
 
-        if (index != -1) {
-            ecs_column_t *column = &data->columns[index];
-            int16_t size = column->size;
-            int16_t align = column->alignment;
-            helper[to_sort].ptr = ecs_vector_first_t(column->data, size, align);
-            helper[to_sort].elem_size = size;
-            helper[to_sort].shared = false;
-        } else if (id) {
-            /* Find component in prefab */
-            ecs_entity_t base = 0;
-            ecs_search_relation(world, table, 0, id, 
-                EcsIsA, 1, 0, &base, NULL, NULL);
-
-            /* If a base was not found, the query should not have allowed using
-             * the component for sorting */
-            ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
-
-            const EcsComponent *cptr = ecs_get(world, id, EcsComponent);
-            ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
-
-            helper[to_sort].ptr = ecs_get_id(world, base, id);
-            helper[to_sort].elem_size = cptr->size;
-            helper[to_sort].shared = true;
-        } else {
-            helper[to_sort].ptr = NULL;
-            helper[to_sort].elem_size = 0;
-            helper[to_sort].shared = false;
-        }
+        const EcsComponent *cptr = ecs_get(world, id, EcsComponent);
+        ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
 
-        helper[to_sort].match = match;
-        helper[to_sort].entities = ecs_vector_first(entities, ecs_entity_t);
-        helper[to_sort].row = 0;
-        helper[to_sort].count = ecs_table_count(table);
-        to_sort ++;      
+        helper->ptr = ecs_get_id(world, base, id);
+        helper->elem_size = cptr->size;
+        helper->shared = true;
+    } else {
+        helper->ptr = NULL;
+        helper->elem_size = 0;
+        helper->shared = false;
     }
 
-    ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
+    helper->match = match;
+    helper->entities = ecs_vector_first(entities, ecs_entity_t);
+    helper->row = 0;
+    helper->count = ecs_table_count(table);
+
+    return true;
+}
+
+/* Merge the remaining rows of helpers into slices, which are appended to the
+ * vector with sorted table slices. Rows that continue the last slice in the
+ * vector are added to that slice. */
+static
+void merge_sorted_rows(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t to_sort)
+{
+    ecs_order_by_action_t compare = query->order_by;
+    ecs_query_table_node_t *cur = ecs_vector_last(
+        query->table_slices, ecs_query_table_node_t);
 
     bool proceed;
     do {
@@ -41272,7 +46108,9 @@ void build_sorted_table_range(
         }
 
         sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->match != cur_helper->match) {
+        if (!cur || cur->match != cur_helper->match || 
+            (cur->offset + cur->count) != cur_helper->row) 
+        {
             cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
             ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
             cur->match = cur_helper->match;
@@ -41284,10 +46122,19 @@ void build_sorted_table_range(
 
         cur_helper->row ++;
     } while (proceed);
+}
+
+/* Iterate through the vector of slices to set the prev/next ptrs. This can't be
+ * done while building the vector, as reallocs may occur */
+static
+void link_sorted_slices(
+    ecs_query_t *query)
+{
+    int32_t i, count = ecs_vector_count(query->table_slices);
+    if (!count) {
+        return;
+    }
 
-    /* Iterate through the vector of slices to set the prev/next ptrs. This
-     * can't be done while building the vector, as reallocs may occur */
-    int32_t i, count = ecs_vector_count(query->table_slices);    
     ecs_query_table_node_t *nodes = ecs_vector_first(
         query->table_slices, ecs_query_table_node_t);
     for (i = 0; i < count; i ++) {
@@ -41297,6 +46144,31 @@ void build_sorted_table_range(
 
     nodes[0].prev = NULL;
     nodes[i - 1].next = NULL;
+}
+
+static
+void build_sorted_table_range(
+    ecs_query_t *query,
+    ecs_query_table_list_t *list)
+{
+    if (!list->count) {
+        return;
+    }
+
+    int to_sort = 0;
+
+    sort_helper_t *helper = ecs_os_malloc_n(sort_helper_t, list->count);
+    ecs_query_table_node_t *cur, *end = list->last->next;
+    for (cur = list->first; cur != end; cur = cur->next) {
+        if (init_sort_helper(query, cur->match, &helper[to_sort])) {
+            to_sort ++;
+        }
+    }
+
+    ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
+
+    merge_sorted_rows(query, helper, to_sort);
+    link_sorted_slices(query);
 
     ecs_os_free(helper);
 }
@@ -41332,6 +46204,237 @@ void build_sorted_tables(
     }
 }
 
+/* Row of a table match, used when patching sorted table slices */
+typedef struct sort_row_t {
+    ecs_query_table_match_t *match;
+    int32_t row;
+} sort_row_t;
+
+/* Get helper for table match. Helpers are initialized once per match. */
+static
+void get_slice_helper(
+    ecs_query_t *query,
+    ecs_map_t *helpers,
+    ecs_query_table_match_t *match,
+    sort_helper_t *out)
+{
+    ecs_map_key_t key = (ecs_map_key_t)(uintptr_t)match;
+    sort_helper_t *helper = ecs_map_get(helpers, sort_helper_t, key);
+    if (!helper) {
+        helper = ecs_map_ensure(helpers, sort_helper_t, key);
+        bool has_rows = init_sort_helper(query, match, helper);
+        ecs_assert(has_rows, ECS_INTERNAL_ERROR, NULL);
+        (void)has_rows;
+    }
+    *out = *helper;
+}
+
+static
+int compare_sort_rows(
+    ecs_query_t *query,
+    ecs_map_t *helpers,
+    sort_row_t r1,
+    sort_row_t r2)
+{
+    sort_helper_t h1, h2;
+    get_slice_helper(query, helpers, r1.match, &h1);
+    get_slice_helper(query, helpers, r2.match, &h2);
+    h1.row = r1.row;
+    h2.row = r2.row;
+    return query->order_by(e_from_helper(&h1), ptr_from_helper(&h1), 
+        e_from_helper(&h2), ptr_from_helper(&h2));
+}
+
+/* Sort rows of table matches by value with a merge sort */
+static
+void sort_match_rows(
+    ecs_query_t *query,
+    ecs_map_t *helpers,
+    sort_row_t *rows,
+    sort_row_t *tmp,
+    int32_t count)
+{
+    if (count < 2) {
+        return;
+    }
+
+    int32_t half = count / 2;
+    sort_match_rows(query, helpers, rows, tmp, half);
+    sort_match_rows(query, helpers, &rows[half], tmp, count - half);
+
+    int32_t i = 0, j = half, k = 0;
+    while (i < half && j < count) {
+        if (compare_sort_rows(query, helpers, rows[j], rows[i]) < 0) {
+            tmp[k ++] = rows[j ++];
+        } else {
+            tmp[k ++] = rows[i ++];
+        }
+    }
+
+    while (i < half) {
+        tmp[k ++] = rows[i ++];
+    }
+    while (j < count) {
+        tmp[k ++] = rows[j ++];
+    }
+
+    ecs_os_memcpy_n(rows, tmp, sort_row_t, count);
+}
+
+/* Append rows to sorted table slices. Rows that continue the last slice are
+ * added to that slice. */
+static
+void add_sorted_slice(
+    ecs_vector_t **slices,
+    ecs_query_table_match_t *match,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_query_table_node_t *last = ecs_vector_last(
+        *slices, ecs_query_table_node_t);
+    if (last && last->match == match && 
+        (last->offset + last->count) == offset) 
+    {
+        last->count += count;
+    } else {
+        ecs_query_table_node_t *slice = ecs_vector_add(
+            slices, ecs_query_table_node_t);
+        slice->match = match;
+        slice->offset = offset;
+        slice->count = count;
+    }
+}
+
+/* Patch sorted table slices after values changed, when no entities were added
+ * or removed. Tables in patches merged their changed rows into their unchanged
+ * rows, which kept their order. The slices are patched in two steps:
+ * - rows of slices are moved to their new row in the table, and changed rows
+ *   are left out. This doesn't compare rows, as the unchanged rows of all 
+ *   tables are still in order.
+ * - the changed rows of all tables are sorted, and inserted into the slices.
+ *   The slice and row before which a row is inserted are found with a binary
+ *   search.
+ * This avoids comparing all rows of all tables, which build_sorted_tables 
+ * does. */
+static
+void patch_sorted_tables(
+    ecs_query_t *query,
+    ecs_map_t *patches)
+{
+    ecs_vector_t *slices = query->table_slices;
+    int32_t i, s, count = ecs_vector_count(slices);
+    ecs_query_table_node_t *nodes = ecs_vector_first(
+        slices, ecs_query_table_node_t);
+    ecs_vector_t *unchanged = ecs_vector_new(ecs_query_table_node_t, count);
+    int32_t changed_count = 0;
+
+    /* Move slice rows to their new rows, leave out changed rows */
+    for (s = 0; s < count; s ++) {
+        ecs_query_table_node_t *slice = &nodes[s];
+        ecs_query_table_match_t *match = slice->match;
+        sort_patch_t *patch = ecs_map_get(patches, sort_patch_t, 
+            (ecs_map_key_t)(uintptr_t)match->table);
+        if (!patch) {
+            add_sorted_slice(&unchanged, match, slice->offset, slice->count);
+            continue;
+        }
+
+        for (i = slice->offset; i < slice->offset + slice->count; i ++) {
+            int32_t row = patch->new_rows[i];
+            if (row != -1) {
+                add_sorted_slice(&unchanged, match, row, 1);
+            }
+        }
+    }
+
+    /* Collect and sort changed rows of all tables */
+    ecs_map_iter_t it = ecs_map_iter(patches);
+    sort_patch_t *patch;
+    while ((patch = ecs_map_next(&it, sort_patch_t, NULL))) {
+        changed_count += patch->changed_count;
+    }
+
+    sort_row_t *changed = ecs_os_malloc_n(sort_row_t, changed_count * 2);
+    sort_row_t *tmp = &changed[changed_count];
+    int32_t c = 0;
+    it = ecs_map_iter(patches);
+    while ((patch = ecs_map_next(&it, sort_patch_t, NULL))) {
+        for (i = 0; i < patch->changed_count; i ++) {
+            changed[c].match = patch->match;
+            changed[c].row = patch->changed[i];
+            c ++;
+        }
+    }
+
+    ecs_map_t *helpers = ecs_map_new(sort_helper_t, 0);
+    sort_match_rows(query, helpers, changed, tmp, changed_count);
+
+    /* Insert changed rows. The first row of each slice is not smaller than the
+     * last row of the slice before it, so the slice with the first row that is
+     * larger than the changed row can be found with a binary search. */
+    int32_t unchanged_count = ecs_vector_count(unchanged);
+    nodes = ecs_vector_first(unchanged, ecs_query_table_node_t);
+    query->table_slices = ecs_vector_new(ecs_query_table_node_t, 
+        unchanged_count + changed_count);
+    s = 0;
+
+    for (c = 0; c < changed_count; c ++) {
+        sort_row_t row = changed[c];
+        int32_t lo = s, hi = unchanged_count;
+        while (lo < hi) {
+            int32_t mid = (lo + hi) / 2;
+            ecs_query_table_node_t *slice = &nodes[mid];
+            sort_row_t last = { slice->match, slice->offset + slice->count - 1};
+            if (compare_sort_rows(query, helpers, row, last) < 0) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        for (; s < lo; s ++) {
+            add_sorted_slice(&query->table_slices, nodes[s].match, 
+                nodes[s].offset, nodes[s].count);
+        }
+
+        if (s < unchanged_count) {
+            /* Split slice at the first row that is larger than the row */
+            ecs_query_table_node_t *slice = &nodes[s];
+            int32_t first = 0, last = slice->count - 1;
+            while (first < last) {
+                int32_t mid = (first + last) / 2;
+                sort_row_t cur = { slice->match, slice->offset + mid };
+                if (compare_sort_rows(query, helpers, row, cur) < 0) {
+                    last = mid;
+                } else {
+                    first = mid + 1;
+                }
+            }
+
+            if (first) {
+                add_sorted_slice(&query->table_slices, slice->match, 
+                    slice->offset, first);
+                slice->offset += first;
+                slice->count -= first;
+            }
+        }
+
+        add_sorted_slice(&query->table_slices, row.match, row.row, 1);
+    }
+
+    for (; s < unchanged_count; s ++) {
+        add_sorted_slice(&query->table_slices, nodes[s].match, 
+            nodes[s].offset, nodes[s].count);
+    }
+
+    link_sorted_slices(query);
+
+    ecs_map_free(helpers);
+    ecs_os_free(changed);
+    ecs_vector_free(unchanged);
+    ecs_vector_free(slices);
+}
+
 static
 void sort_tables(
     ecs_world_t *world,
@@ -41367,7 +46470,10 @@ void sort_tables(
     /* Iterate over non-empty tables. Don't bother with empty tables as they
      * have nothing to sort */
 
-    bool tables_sorted = false;
+    bool tables_sorted = false, values_changed = false;
+    bool entities_changed = false, can_patch = true;
+    int32_t table_count = 0;
+    ecs_map_t *patches = NULL;
 
     ecs_table_cache_iter_t it;
     ecs_query_table_t *qt;
@@ -41375,10 +46481,13 @@ void sort_tables(
 
     while ((qt = flecs_table_cache_next(&it, ecs_query_table_t))) {
         ecs_table_t *table = qt->hdr.table;
-        bool dirty = false;
+        bool dirty = false, incremental = true;
+        table_count ++;
 
         if (check_table_monitor(query, qt, 0)) {
+            /* Table gained or lost entities, do a full sort */
             dirty = true;
+            incremental = false;
         }
 
         int32_t column = -1;
@@ -41407,14 +46516,78 @@ void sort_tables(
             continue;
         }
 
+        /* If only values changed, find the rows that changed since the query
+         * last iterated the table. This enables row tracking for the column. */
+        const int32_t *row_states = NULL;
+        int32_t since = -1;
+        if (incremental && column != -1) {
+            int32_t *monitor = qt->first->monitor;
+            if (monitor) {
+                since = monitor[order_by_term + 1];
+            }
+            if (since != -1) {
+                row_states = flecs_table_get_row_dirty_state(
+                    world, table, column, since);
+            }
+        }
+
         /* Something has changed, sort the table */
-        sort_table(world, table, column, compare);
-        tables_sorted = true;
+        sort_patch_t patch = { .match = qt->first };
+        bool moved = sort_table(world, table, column, compare, 
+            query->order_by_kind, incremental, row_states, since, &patch);
+        if (moved || !incremental) {
+            tables_sorted = true;
+        }
+
+        if (!incremental) {
+            entities_changed = true;
+        }
+
+        if (patch.new_rows) {
+            if (!patches) {
+                patches = ecs_map_new(sort_patch_t, 0);
+            }
+            ecs_map_set(patches, (ecs_map_key_t)(uintptr_t)table, &patch);
+
+            /* Slices of tables with multiple matches can't be patched */
+            if (qt->first != qt->last) {
+                can_patch = false;
+            }
+        } else if (moved || !row_states) {
+            /* Without a patch it's not known which rows changed */
+            can_patch = false;
+        }
+
+        values_changed = true;
     }
 
-    if (tables_sorted || query->match_count != query->prev_match_count) {
+    if (entities_changed || !query->table_slices ||
+        query->match_count != query->prev_match_count) 
+    {
         build_sorted_tables(query);
         query->match_count ++; /* Increase version if tables changed */
+    } else if (values_changed && table_count > 1) {
+        /* The order between tables may have changed */
+        if (!can_patch) {
+            build_sorted_tables(query);
+            query->match_count ++;
+        } else if (patches) {
+            patch_sorted_tables(query, patches);
+            query->match_count ++;
+        } else if (tables_sorted) {
+            query->match_count ++;
+        }
+    } else if (tables_sorted) {
+        query->match_count ++;
+    }
+
+    if (patches) {
+        ecs_map_iter_t pit = ecs_map_iter(patches);
+        sort_patch_t *patch;
+        while ((patch = ecs_map_next(&pit, sort_patch_t, NULL))) {
+            ecs_os_free(patch->new_rows);
+        }
+        ecs_map_free(patches);
     }
 }
 
@@ -42024,6 +47197,19 @@ void query_order_by(
 
     query->order_by_component = order_by_component;
     query->order_by = order_by;
+    query->order_by_kind = 0;
+
+#ifdef FLECS_META
+    /* If the callback is the comparator for the primitive value of the 
+     * component, tables can be sorted with a radix sort */
+    if (order_by && order_by_component) {
+        ecs_primitive_kind_t kind = order_by_primitive_kind(
+            world, order_by_component);
+        if (order_by == order_by_primitive_compare(kind)) {
+            query->order_by_kind = kind;
+        }
+    }
+#endif
 
     ecs_vector_free(query->table_slices);
     query->table_slices = NULL;
@@ -42154,7 +47340,7 @@ ecs_query_t* ecs_query_init(
         }
     }
 
-    ecs_table_cache_init(&result->cache);
+    ecs_table_cache_init(&result->cache, &world->allocator);
 
     result->world = world;
     result->iterable.init = query_iter_init;
@@ -42368,6 +47554,205 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
+/* Find the first node after the group of the provided node */
+static
+ecs_query_table_node_t* skip_group(
+    ecs_query_t *query,
+    ecs_query_table_node_t *node)
+{
+    uint64_t group_id = node->match->group_id;
+
+    if (!query->order_by) {
+        ecs_query_table_list_t *group = get_group(query, group_id);
+        ecs_assert(group != NULL, ECS_INTERNAL_ERROR, NULL);
+        return group->last->next;
+    }
+
+    /* Sorted slices of a group are not tracked by the group list, but are
+     * stored contiguously */
+    do {
+        node = node->next;
+    } while (node && node->match->group_id == group_id);
+
+    return node;
+}
+
+/* Skip groups that are iterated by other workers */
+static
+ecs_query_table_node_t* next_partition_node(
+    ecs_query_t *query,
+    ecs_query_iter_t *iter,
+    ecs_query_table_node_t *node)
+{
+    while (node) {
+        uint64_t group_id = node->match->group_id;
+        if (iter->group_index && group_id == iter->group_id) {
+            /* Still iterating the current group */
+            return node;
+        }
+
+        int32_t index = iter->group_index ++;
+        iter->group_id = group_id;
+        if ((index % iter->partition_count) == iter->partition_index) {
+            return node;
+        }
+
+        node = skip_group(query, node);
+    }
+
+    return NULL;
+}
+
+static
+ecs_query_table_node_t* next_node(
+    ecs_query_iter_t *iter,
+    ecs_query_table_node_t *node)
+{
+    if (node == iter->last) {
+        return NULL;
+    }
+    return node->next;
+}
+
+void ecs_query_set_group(
+    ecs_iter_t *it,
+    uint64_t group_id)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_t *query = iter->query;
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(iter->prev == NULL, ECS_INVALID_OPERATION, 
+        "cannot set group after iteration has started");
+
+    ecs_query_table_list_t *group = get_group(query, group_id);
+    if (!group) {
+        iter->node = NULL;
+        iter->last = NULL;
+        return;
+    }
+
+    ecs_query_table_node_t *first = group->first, *last = group->last;
+
+    if (query->order_by) {
+        /* Find sorted slices of group */
+        first = iter->node;
+        while (first && first->match->group_id != group_id) {
+            first = first->next;
+        }
+
+        last = first;
+        while (last && last->next && last->next->match->group_id == group_id) {
+            last = last->next;
+        }
+    }
+
+    iter->node = first;
+    iter->last = last;
+error:
+    return;
+}
+
+ecs_iter_t ecs_query_group_worker_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query,
+    int32_t index,
+    int32_t count)
+{
+    ecs_poly_assert(query, ecs_query_t);
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, query);
+    it.priv.iter.query.partition_index = index;
+    it.priv.iter.query.partition_count = count;
+    return it;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+static
+void query_group_info(
+    const ecs_query_table_list_t *group,
+    uint64_t group_id,
+    ecs_query_group_info_t *info)
+{
+    info->id = group_id;
+    info->table_count = group->count;
+    info->entity_count = 0;
+
+    ecs_query_table_node_t *node, *end = group->last->next;
+    for (node = group->first; node != end; node = node->next) {
+        info->entity_count += ecs_table_count(node->match->table);
+    }
+}
+
+bool ecs_query_get_group_info(
+    const ecs_query_t *query,
+    uint64_t group_id,
+    ecs_query_group_info_t *info)
+{
+    ecs_poly_assert(query, ecs_query_t);
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(info != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    flecs_process_pending_tables(query->world);
+
+    const ecs_query_table_list_t *group = ecs_map_get(
+        &query->groups, ecs_query_table_list_t, group_id);
+    if (!group || !group->first) {
+        return false;
+    }
+
+    query_group_info(group, group_id, info);
+
+    return true;
+error:
+    return false;
+}
+
+int32_t ecs_query_groups(
+    const ecs_query_t *query,
+    ecs_query_group_info_t *groups,
+    int32_t count)
+{
+    ecs_poly_assert(query, ecs_query_t);
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(!count || groups != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    flecs_process_pending_tables(query->world);
+
+    int32_t result = 0;
+    ecs_query_table_node_t *node = query->list.first;
+
+    /* Groups are stored in order, so walk the list group by group */
+    while (node) {
+        uint64_t group_id = node->match->group_id;
+        const ecs_query_table_list_t *group = ecs_map_get(
+            &query->groups, ecs_query_table_list_t, group_id);
+        ecs_assert(group != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        if (result < count) {
+            query_group_info(group, group_id, &groups[result]);
+        }
+
+        result ++;
+        node = group->last->next;
+    }
+
+    return result;
+error:
+    return 0;
+}
+
 static
 int find_smallest_column(
     ecs_table_t *table,
@@ -42697,11 +48082,17 @@ done:
 static
 void mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *table_data)
+    ecs_query_table_node_t *node)
 {
+    ecs_query_table_match_t *table_data = node->match;
     ecs_table_t *table = table_data->table;
 
     if (table && table->dirty_state) {
+        int32_t offset = node->offset, row_count = node->count;
+        if (!row_count) {
+            row_count = ecs_table_count(table);
+        }
+
         ecs_term_t *terms = query->filter.terms;
         int32_t i, count = query->filter.term_count_actual;
         for (i = 0; i < count; i ++) {
@@ -42728,7 +48119,8 @@ void mark_columns_dirty(
             int32_t storage_index = ecs_table_type_to_storage_index(
                 table, index - 1);
             if (storage_index >= 0) {
-                table->dirty_state[storage_index + 1] ++;
+                flecs_table_mark_rows_dirty(query->world, table, 
+                    storage_index, offset, row_count);
             }
         }
     }
@@ -42777,17 +48169,24 @@ bool ecs_query_next_instanced(
             sync_match_monitor(query, prev->match);
         }
         if (flags & EcsQueryHasOutColumns) {
-            mark_columns_dirty(query, prev->match);
+            mark_columns_dirty(query, prev);
         }
     }
 
     iter->skip_count = 0;
 
-    for (node = iter->node; node != NULL; node = next) {     
+    for (node = iter->node; node != NULL; node = next) {
+        if (iter->partition_count > 1) {
+            node = next_partition_node(query, iter, node);
+            if (!node) {
+                break;
+            }
+        }
+
         ecs_query_table_match_t *match = node->match;
         ecs_table_t *table = match->table;
 
-        next = node->next;
+        next = next_node(iter, node);
 
         if (table) {
             cur.first = node->offset;
@@ -42828,7 +48227,7 @@ bool ecs_query_next_instanced(
                             /* No more elements in sparse column */
                             if (found) {
                                 /* Try again */
-                                next = node->next;
+                                next = next_node(iter, node);
                                 found = false;
                             } else {
                                 /* Nothing found */
@@ -42925,6 +48324,114 @@ error:
     return false;
 }
 
+/* Test if row of iterator result changed for any of the monitored terms */
+static
+bool check_row_monitor(
+    int32_t **row_states,
+    int32_t *monitor_states,
+    int32_t count,
+    int32_t row)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        if (row_states[i][row] > monitor_states[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int32_t ecs_query_changed_range(
+    const ecs_iter_t *it,
+    int32_t *row)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->is_valid, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(row != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t first = *row, count = it->count;
+    ecs_check(first >= 0, ECS_INVALID_PARAMETER, NULL);
+    if (first >= count) {
+        return 0;
+    }
+
+    ecs_query_t *query = it->priv.iter.query.query;
+    ecs_poly_assert(query, ecs_query_t);
+
+    ecs_query_table_node_t *node = it->priv.iter.query.prev;
+    ecs_assert(node != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_query_table_match_t *match = node->match;
+
+    if (get_match_monitor(query, match)) {
+        return count - first; /* Monitor didn't exist yet */
+    }
+
+    ecs_table_t *table = match->table;
+    int32_t *monitor = match->monitor;
+    int32_t *dirty_state = flecs_table_get_dirty_state(table);
+    if (monitor[0] != dirty_state[0]) {
+        return count - first; /* Table gained/lost entities */
+    }
+
+    /* Collect row dirty states for monitored terms */
+    const ecs_filter_t *f = &query->filter;
+    int32_t i, state_count = 0, term_count = f->term_count_actual;
+    int32_t **row_states = ecs_os_alloca_n(int32_t*, term_count);
+    int32_t *monitor_states = ecs_os_alloca_n(int32_t, term_count);
+    table_dirty_state_t cur;
+
+    for (i = 0; i < term_count; i ++) {
+        int32_t t = f->terms[i].index;
+        if (monitor[t + 1] == -1) {
+            continue;
+        }
+
+        get_dirty_state(query, match, t, &cur);
+        ecs_assert(cur.column != -1, ECS_INTERNAL_ERROR, NULL);
+
+        int32_t *rows = NULL;
+        if (cur.table == table) {
+            /* Always get row state, as this enables tracking for the column */
+            rows = flecs_table_get_row_dirty_state(
+                it->real_world, table, cur.column, monitor[t + 1]);
+        }
+
+        if (monitor[t + 1] == cur.dirty_state[cur.column + 1]) {
+            continue; /* Nothing changed for term */
+        }
+
+        if (!rows) {
+            /* Component is not owned or rows weren't tracked for all changes,
+             * all rows changed */
+            return count - first;
+        }
+
+        row_states[state_count] = &rows[it->offset];
+        monitor_states[state_count] = monitor[t + 1];
+        state_count ++;
+    }
+
+    /* Find first changed row, and then the first unchanged row after it */
+    for (; first < count; first ++) {
+        if (check_row_monitor(row_states, monitor_states, state_count, first)) {
+            break;
+        }
+    }
+
+    int32_t last;
+    for (last = first; last < count; last ++) {
+        if (!check_row_monitor(row_states, monitor_states, state_count, last)){
+            break;
+        }
+    }
+
+    *row = first;
+    return last - first;
+error:
+    return 0;
+}
+
 void ecs_query_skip(
     ecs_iter_t *it)
 {
@@ -43103,6 +48610,94 @@ void graph_edge_free(
     }
 }
 
+/* Count number of bits set in value */
+static
+int32_t edge_popcount(
+    uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (int32_t)((v * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* Get index of low edge in array, which is the number of edges with a lower id */
+static
+int32_t lo_edge_index(
+    const ecs_graph_edges_t *edges,
+    ecs_id_t id)
+{
+    int32_t i, word = (int32_t)(id >> 6), result = 0;
+    for (i = 0; i < word; i ++) {
+        result += edge_popcount(edges->lo_mask[i]);
+    }
+
+    return result + edge_popcount(
+        edges->lo_mask[word] & ((1ull << (id & 63)) - 1));
+}
+
+static
+int32_t lo_edge_count(
+    const ecs_graph_edges_t *edges)
+{
+    int32_t i, result = 0;
+    for (i = 0; i < ECS_GRAPH_LO_MASK_COUNT; i ++) {
+        result += edge_popcount(edges->lo_mask[i]);
+    }
+    return result;
+}
+
+static
+ecs_graph_edge_t* ensure_lo_edge(
+    ecs_world_t *world,
+    ecs_graph_edges_t *edges,
+    ecs_id_t id)
+{
+    int32_t index = lo_edge_index(edges, id);
+    uint64_t *word = &edges->lo_mask[id >> 6];
+    uint64_t bit = 1ull << (id & 63);
+    if (*word & bit) {
+        return edges->lo[index];
+    }
+
+    /* Edges are not often added, so grow array by one to keep it small */
+    int32_t count = lo_edge_count(edges);
+    edges->lo = ecs_os_realloc_n(edges->lo, ecs_graph_edge_t*, count + 1);
+    ecs_os_memmove(&edges->lo[index + 1], &edges->lo[index],
+        (count - index) * ECS_SIZEOF(ecs_graph_edge_t*));
+
+    ecs_graph_edge_t *edge = graph_edge_new(world);
+    edges->lo[index] = edge;
+    *word |= bit;
+
+    return edge;
+}
+
+static
+void remove_lo_edge(
+    ecs_graph_edges_t *edges,
+    ecs_id_t id)
+{
+    uint64_t *word = &edges->lo_mask[id >> 6];
+    uint64_t bit = 1ull << (id & 63);
+    ecs_assert(*word & bit, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t index = lo_edge_index(edges, id);
+    int32_t count = lo_edge_count(edges);
+    ecs_os_memmove(&edges->lo[index], &edges->lo[index + 1],
+        (count - index - 1) * ECS_SIZEOF(ecs_graph_edge_t*));
+    *word &= ~bit;
+
+    if (count == 1) {
+        ecs_os_free(edges->lo);
+        edges->lo = NULL;
+    }
+}
+
 static
 ecs_graph_edge_t* ensure_hi_edge(
     ecs_world_t *world,
@@ -43110,22 +48705,16 @@ ecs_graph_edge_t* ensure_hi_edge(
     ecs_id_t id)
 {
     if (!ecs_map_is_initialized(&edges->hi)) {
-        ecs_map_init(&edges->hi, ecs_graph_edge_t*, 1);
+        ecs_map_init_w_allocator(&edges->hi, ecs_graph_edge_t*, 1, 
+            &world->allocator);
     }
 
     ecs_graph_edge_t **ep = ecs_map_ensure(&edges->hi, ecs_graph_edge_t*, id);
     ecs_graph_edge_t *edge = ep[0];
-    if (edge) {
-        return edge;
+    if (!edge) {
+        edge = ep[0] = graph_edge_new(world);
     }
 
-    if (id < ECS_HI_COMPONENT_ID) {
-        edge = &edges->lo[id];
-    } else {
-        edge = graph_edge_new(world);
-    }
-
-    ep[0] = edge;
     return edge;
 }
 
@@ -43135,21 +48724,11 @@ ecs_graph_edge_t* ensure_edge(
     ecs_graph_edges_t *edges,
     ecs_id_t id)
 {
-    ecs_graph_edge_t *edge;
-    
     if (id < ECS_HI_COMPONENT_ID) {
-        if (!edges->lo) {
-            edges->lo = ecs_os_calloc_n(ecs_graph_edge_t, ECS_HI_COMPONENT_ID);
-        }
-        edge = &edges->lo[id];
+        return ensure_lo_edge(world, edges, id);
     } else {
-        if (!ecs_map_is_initialized(&edges->hi)) {
-            ecs_map_init(&edges->hi, ecs_graph_edge_t*, 1);
-        }
-        edge = ensure_hi_edge(world, edges, id);
+        return ensure_hi_edge(world, edges, id);
     }
-
-    return edge;
 }
 
 static
@@ -43179,12 +48758,7 @@ void disconnect_edge(
         table_diff_free(diff);
     }
 
-    /* If edge id is low, clear it from fast lookup array */
-    if (id < ECS_HI_COMPONENT_ID) {
-        edge->from = NULL;
-    } else {
-        graph_edge_free(world, edge);
-    }
+    graph_edge_free(world, edge);
 }
 
 static
@@ -43195,17 +48769,22 @@ void remove_edge(
     ecs_graph_edge_t *edge)
 {
     ecs_assert(edges != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(ecs_map_is_initialized(&edges->hi), ECS_INTERNAL_ERROR, NULL);
     disconnect_edge(world, id, edge);
-    ecs_map_remove(&edges->hi, id);
+
+    if (id < ECS_HI_COMPONENT_ID) {
+        remove_lo_edge(edges, id);
+    } else {
+        ecs_assert(ecs_map_is_initialized(&edges->hi), 
+            ECS_INTERNAL_ERROR, NULL);
+        ecs_map_remove(&edges->hi, id);
+    }
 }
 
 static
 void init_edges(
     ecs_graph_edges_t *edges)
 {
-    edges->lo = NULL;
-    ecs_os_zeromem(&edges->hi);
+    ecs_os_zeromem(edges);
 }
 
 static
@@ -43216,6 +48795,47 @@ void init_node(
     init_edges(&node->remove);
 }
 
+static
+void edge_memory(
+    ecs_graph_edge_t *edge,
+    int32_t *edge_count,
+    int32_t *allocd)
+{
+    *allocd += ECS_SIZEOF(ecs_graph_edge_t);
+    (*edge_count) ++;
+
+    ecs_table_diff_t *diff = edge->diff;
+    if (diff && diff != &ecs_table_edge_is_component) {
+        *allocd += ECS_SIZEOF(ecs_table_diff_t) + ECS_SIZEOF(ecs_id_t) * (
+            diff->added.size + diff->removed.size + 
+            diff->on_set.size + diff->un_set.size);
+    }
+}
+
+static
+void edges_memory(
+    const ecs_graph_edges_t *edges,
+    int32_t *edge_count,
+    int32_t *allocd)
+{
+    int32_t i, count = lo_edge_count(edges);
+    for (i = 0; i < count; i ++) {
+        edge_memory(edges->lo[i], edge_count, allocd);
+    }
+
+    *allocd += count * ECS_SIZEOF(ecs_graph_edge_t*);
+
+    if (ecs_map_is_initialized(&edges->hi)) {
+        ecs_map_iter_t it = ecs_map_iter(&edges->hi);
+        ecs_graph_edge_t *edge;
+        while ((edge = ecs_map_next_ptr(&it, ecs_graph_edge_t*, NULL))) {
+            edge_memory(edge, edge_count, allocd);
+        }
+
+        ecs_map_memory((ecs_map_t*)&edges->hi, allocd, NULL);
+    }
+}
+
 typedef struct {
     int32_t first;
     int32_t count;
@@ -43486,6 +49106,13 @@ void init_flags(
             table->flags |= EcsTableHasPairs;
         }
 
+        /* Does table have pairs for a relation with a closure index */
+        if (ECS_HAS_ROLE(id, PAIR) && 
+            flecs_closure_is_indexed(world, ECS_PAIR_FIRST(id))) 
+        {
+            table->flags |= EcsTableHasClosure;
+        }
+
         /* Does table have IsA relations */
         if (ECS_HAS_RELATION(id, EcsIsA)) {
             table->flags |= EcsTableHasIsA;
@@ -43531,6 +49158,7 @@ void init_table(
     table->c_info = NULL;
     table->flags = 0;
     table->dirty_state = NULL;
+    table->row_dirty_state = NULL;
     table->alloc_count = 0;
     table->lock = 0;
     table->refcount = 1;
@@ -43563,6 +49191,18 @@ ecs_table_t *create_table(
     result->id = flecs_sparse_last_id(&world->store.tables);
     result->type = type;
 
+    /* Store table in table hashmap. This must happen before the table is
+     * initialized, which can add elements to the hashmap and invalidate the
+     * pointers in table_elem. */
+    *(ecs_table_t**)table_elem.value = result;
+
+    /* Set keyvalue to one that has the same lifecycle as the table */
+    ecs_ids_t key = {
+        .array = ecs_vector_first(result->type, ecs_id_t),
+        .count = ecs_vector_count(result->type)
+    };
+    *(ecs_ids_t*)table_elem.key = key;
+
     init_table(world, result);
 
     if (ecs_should_log_2()) {
@@ -43575,16 +49215,6 @@ ecs_table_t *create_table(
 
     ecs_log_push_2();
 
-    /* Store table in table hashmap */
-    *(ecs_table_t**)table_elem.value = result;
-
-    /* Set keyvalue to one that has the same lifecycle as the table */
-    ecs_ids_t key = {
-        .array = ecs_vector_first(result->type, ecs_id_t),
-        .count = ecs_vector_count(result->type)
-    };
-    *(ecs_ids_t*)table_elem.key = key;
-
     flecs_notify_queries(world, &(ecs_query_event_t) {
         .kind = EcsQueryTableMatch,
         .table = result
@@ -44157,8 +49787,6 @@ void init_add_edge(
 {
     init_edge(table, edge, id, to);
 
-    ensure_hi_edge(world, &table->node.add, id);
-
     if (table != to) {
         /* Add edges are appended to refs.next */
         ecs_graph_edge_hdr_t *to_refs = &to->node.refs;
@@ -44186,8 +49814,6 @@ void init_remove_edge(
 {
     init_edge(table, edge, id, to);
 
-    ensure_hi_edge(world, &table->node.remove, id);
-
     if (table != to) {
         /* Remove edges are appended to refs.prev */
         ecs_graph_edge_hdr_t *to_refs = &to->node.refs;
@@ -44295,6 +49921,12 @@ ecs_table_t* flecs_table_traverse_remove(
     ecs_check(id_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(id_ptr[0] != 0, ECS_INVALID_PARAMETER, NULL);
 
+    /* Chunks share the graph node of the table that owns them */
+    ecs_table_t *chunk = node;
+    if (node->chunk_root) {
+        node = node->chunk_root;
+    }
+
     ecs_id_t id = id_ptr[0];
     ecs_graph_edge_t *edge = ensure_edge(world, &node->node.remove, id);
     ecs_table_t *to = edge->to;
@@ -44307,6 +49939,11 @@ ecs_table_t* flecs_table_traverse_remove(
 
     populate_diff(edge, NULL, id_ptr, diff);
 
+    /* If the type doesn't change the entity stays in its chunk */
+    if (to == node) {
+        return chunk;
+    }
+
     return to;
 error:
     return NULL;
@@ -44326,6 +49963,12 @@ ecs_table_t* flecs_table_traverse_add(
     ecs_check(id_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(id_ptr[0] != 0, ECS_INVALID_PARAMETER, NULL);
 
+    /* Chunks share the graph node of the table that owns them */
+    ecs_table_t *chunk = node;
+    if (node->chunk_root) {
+        node = node->chunk_root;
+    }
+
     ecs_id_t id = id_ptr[0];
     ecs_graph_edge_t *edge = ensure_edge(world, &node->node.add, id);
     ecs_table_t *to = edge->to;
@@ -44338,6 +49981,11 @@ ecs_table_t* flecs_table_traverse_add(
 
     populate_diff(edge, id_ptr, NULL, diff);
 
+    /* If the type doesn't change the entity stays in its chunk */
+    if (to == node) {
+        return chunk;
+    }
+
     return to;
 error:
     return NULL;
@@ -44351,6 +49999,51 @@ ecs_table_t* flecs_table_find_or_create(
     return find_or_create(world, ids, NULL);
 }
 
+ecs_table_t* flecs_table_new_chunk(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table->chunk_root == NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table->chunk_capacity != 0, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_table_t *result = flecs_sparse_add(&world->store.tables, ecs_table_t);
+    ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Chunks are not stored in the table hashmap, so that lookups by type
+     * always return the table that owns the chunks */
+    result->id = flecs_sparse_last_id(&world->store.tables);
+    result->type = ecs_vector_copy(table->type, ecs_id_t);
+    result->chunk_root = table;
+    result->chunk_capacity = table->chunk_capacity;
+    result->chunk_index = ecs_vector_count(table->chunks) + 1;
+
+    init_table(world, result);
+
+    ecs_table_t **elem = ecs_vector_add(&table->chunks, ecs_table_t*);
+    *elem = result;
+
+    if (ecs_should_log_2()) {
+        char *expr = ecs_type_str(world, result->type);
+        ecs_dbg_2(
+            "#[green]chunk#[normal] [%s] #[green]created#[normal] with id %d",
+            expr, result->id);
+        ecs_os_free(expr);
+    }
+
+    ecs_log_push_2();
+
+    flecs_notify_queries(world, &(ecs_query_event_t) {
+        .kind = EcsQueryTableMatch,
+        .table = result
+    });
+
+    ecs_log_pop_2();
+
+    return result;
+}
+
 void flecs_init_root_table(
     ecs_world_t *world)
 {
@@ -44388,8 +50081,21 @@ void flecs_table_clear_edges(
     ecs_graph_edge_hdr_t *node_refs = &table_node->refs;
     ecs_graph_edge_t *edge;
     uint64_t key;
+    int32_t i, count;
 
     /* Cleanup outgoing edges */
+    count = lo_edge_count(node_add);
+    for (i = 0; i < count; i ++) {
+        edge = node_add->lo[i];
+        disconnect_edge(world, edge->id, edge);
+    }
+
+    count = lo_edge_count(node_remove);
+    for (i = 0; i < count; i ++) {
+        edge = node_remove->lo[i];
+        disconnect_edge(world, edge->id, edge);
+    }
+
     it = ecs_map_iter(add_hi);
     while ((edge = ecs_map_next_ptr(&it, ecs_graph_edge_t*, &key))) {
         disconnect_edge(world, key, edge);
@@ -44428,12 +50134,21 @@ void flecs_table_clear_edges(
     ecs_os_free(node_remove->lo);
     ecs_map_fini(add_hi);
     ecs_map_fini(remove_hi);
-    table_node->add.lo = NULL;
-    table_node->remove.lo = NULL;
+    init_edges(node_add);
+    init_edges(node_remove);
 
     ecs_log_pop_1();
 }
 
+void flecs_table_graph_memory(
+    const ecs_table_t *table,
+    int32_t *edge_count,
+    int32_t *allocd)
+{
+    edges_memory(&table->node.add, edge_count, allocd);
+    edges_memory(&table->node.remove, edge_count, allocd);
+}
+
 /* Public convenience functions for traversing table graph */
 ecs_table_t* ecs_table_add_id(
     ecs_world_t *world,
@@ -44453,11 +50168,16 @@ ecs_table_t* ecs_table_remove_id(
 
 #include <stddef.h>
 
-#define INIT_CACHE(it, f, term_count)\
+#define INIT_CACHE(it, stack, f, term_count)\
     if (!it->f && term_count) {\
         if (term_count <= ECS_TERM_CACHE_SIZE) {\
             it->f = it->priv.cache.f;\
             it->priv.cache.f##_alloc = false;\
+        } else if (stack) {\
+            ecs_size_t f##_size = ECS_SIZEOF(*(it->f)) * term_count;\
+            it->f = flecs_stack_alloc(stack, f##_size, 8);\
+            ecs_os_memset((void*)it->f, 0, f##_size);\
+            it->priv.cache.f##_alloc = false;\
         } else {\
             it->f = ecs_os_calloc(ECS_SIZEOF(*(it->f)) * term_count);\
             it->priv.cache.f##_alloc = true;\
@@ -44471,17 +50191,47 @@ ecs_table_t* ecs_table_remove_id(
         }\
     }   
 
+/* Iterators that are created during a frame get their term arrays from the
+ * frame allocator of their stage, which is reset by ecs_frame_end. */
+static
+ecs_stack_t* iter_frame_stack(
+    ecs_iter_t *it)
+{
+    if (it->term_count <= ECS_TERM_CACHE_SIZE || !it->world) {
+        return NULL;
+    }
+
+    ecs_world_t *world = it->world;
+    ecs_stage_t *stage;
+    if (ecs_poly_is(world, ecs_stage_t)) {
+        stage = (ecs_stage_t*)world;
+        world = stage->world;
+    } else if (!world->is_readonly) {
+        stage = &world->stage;
+    } else {
+        /* Stage of thread is not known */
+        return NULL;
+    }
+
+    if (!world->is_in_frame) {
+        return NULL;
+    }
+
+    return &stage->frame_stack;
+}
+
 void flecs_iter_init(
     ecs_iter_t *it)
 {
-    INIT_CACHE(it, ids, it->term_count);
-    INIT_CACHE(it, subjects, it->term_count);
-    INIT_CACHE(it, match_indices, it->term_count);
-    INIT_CACHE(it, columns, it->term_count);
+    ecs_stack_t *stack = iter_frame_stack(it);
+    INIT_CACHE(it, stack, ids, it->term_count);
+    INIT_CACHE(it, stack, subjects, it->term_count);
+    INIT_CACHE(it, stack, match_indices, it->term_count);
+    INIT_CACHE(it, stack, columns, it->term_count);
     
     if (!it->is_filter) {
-        INIT_CACHE(it, sizes, it->term_count);
-        INIT_CACHE(it, ptrs, it->term_count);
+        INIT_CACHE(it, stack, sizes, it->term_count);
+        INIT_CACHE(it, stack, ptrs, it->term_count);
     } else {
         it->sizes = NULL;
         it->ptrs = NULL;
@@ -44868,6 +50618,23 @@ error:
     return false;
 }
 
+bool ecs_term_is_aligned(
+    const ecs_iter_t *it,
+    int32_t index)
+{
+    ecs_check(it->is_valid, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index > 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!it->ptrs || it->columns[index - 1] <= 0) {
+        return false;
+    }
+
+    void *ptr = it->ptrs[index - 1];
+    return ptr && !((uintptr_t)ptr & (ECS_COLUMN_ALIGNMENT - 1));
+error:
+    return false;
+}
+
 void* ecs_iter_column_w_size(
     const ecs_iter_t *it,
     size_t size,
@@ -45287,6 +51054,440 @@ error:
     return false;
 }
 
+/* Free term data storage of a chunk iterator. This is also called when the
+ * iterator is finalized before it has returned all results, in which case the
+ * chained iterator is finalized as well. */
+static
+void chunk_iter_fini(
+    ecs_iter_t *it)
+{
+    ecs_chunk_iter_t *iter = &it->priv.iter.chunk;
+    ecs_os_free(iter->ptrs);
+    iter->ptrs = NULL;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    if (chain_it && chain_it->is_valid) {
+        ecs_iter_fini(chain_it);
+    }
+}
+
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t *cursor,
+    int32_t size)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(cursor != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_os_api.ainc_ != NULL, ECS_MISSING_OS_API, "ainc");
+
+    return (ecs_iter_t){
+        .real_world = it->real_world,
+        .world = it->world,
+        .priv.iter.chunk = {
+            .cursor = cursor,
+            .size = size
+        },
+        .next = ecs_chunk_next,
+        .fini = chunk_iter_fini,
+        .chain_it = (ecs_iter_t*)it,
+        .is_instanced = it->is_instanced
+    };
+
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+/* Copy term data pointers of chained iterator, so that iterators that return
+ * multiple results for a single result of the chained iterator can offset the
+ * pointers without modifying the data of the chained iterator. */
+static
+void copy_chain_ptrs(
+    ecs_iter_t *it,
+    void ***storage)
+{
+    if (!it->ptrs) {
+        return;
+    }
+
+    int32_t term_count = it->term_count;
+    void **ptrs = it->priv.cache.ptrs;
+    if (term_count > ECS_TERM_CACHE_SIZE) {
+        if (!*storage) {
+            *storage = ecs_os_malloc_n(void*, term_count);
+        }
+        ptrs = *storage;
+    }
+
+    ecs_os_memcpy_n(ptrs, it->ptrs, void*, term_count);
+    it->ptrs = ptrs;
+}
+
+static
+bool ecs_chunk_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_chunk_next, ECS_INVALID_PARAMETER, NULL);
+
+    bool instanced = it->is_instanced;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_chunk_iter_t *iter = &it->priv.iter.chunk;
+    int32_t size = iter->size;
+
+    /* Claim the next chunk. Chunk indices are global across all tables of the
+     * chained iterator, so that resources that share the cursor never claim
+     * the same entities. */
+    int32_t claimed = ecs_os_ainc(iter->cursor) - 1;
+
+    /* Skip tables until the table that contains the claimed chunk is found */
+    while (claimed >= (iter->first + iter->count)) {
+        iter->first += iter->count;
+
+        if (!ecs_iter_next(chain_it)) {
+            goto done;
+        }
+
+        if (chain_it->table) {
+            iter->count = (chain_it->count + size - 1) / size;
+        } else {
+            iter->count = 1; /* Task query */
+        }
+    }
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+    it->is_instanced = instanced;
+
+    if (!it->table) {
+        return true;
+    }
+
+    /* Multiple chunks can be returned for the same result of the chained 
+     * iterator, so don't offset the term data of the chained iterator. */
+    copy_chain_ptrs(it, &iter->ptrs);
+
+    int32_t first = (claimed - iter->first) * size;
+    int32_t count = it->count - first;
+    if (count > size) {
+        count = size;
+    }
+
+    it->frame_offset += first;
+
+    offset_iter(it, first);
+    it->count = count;
+
+    if (it->is_instanced) {
+        it->offset += first;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+done:
+    chunk_iter_fini(it);
+error:
+    return false;
+}
+
+bool ecs_chunk_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_chunk_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    it->chain_it->is_instanced = true;
+
+    if (flecs_iter_next_row(it)) {
+        return true;
+    }
+
+    return flecs_iter_next_instanced(it, ecs_chunk_next_instanced(it));
+error:
+    return false;
+}
+
+#ifdef FLECS_META
+
+/* Free term data storage of a range iterator. This is also called when the
+ * iterator is finalized before it has returned all results, in which case the
+ * chained iterator is finalized as well. */
+static
+void range_iter_fini(
+    ecs_iter_t *it)
+{
+    ecs_range_iter_t *iter = &it->priv.iter.range;
+    ecs_os_free(iter->ptrs);
+    iter->ptrs = NULL;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    if (chain_it && chain_it->is_valid) {
+        ecs_iter_fini(chain_it);
+    }
+}
+
+ecs_iter_t ecs_range_iter(
+    const ecs_iter_t *it,
+    int32_t term,
+    const char *member,
+    double min,
+    double max)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(term > 0, ECS_INVALID_PARAMETER, NULL);
+
+    return (ecs_iter_t){
+        .real_world = it->real_world,
+        .world = it->world,
+        .priv.iter.range = {
+            .member = member,
+            .min = min,
+            .max = max,
+            .term = term,
+            .offset = -1,
+            .zone_map = -1
+        },
+        .next = ecs_range_next,
+        .fini = range_iter_fini,
+        .chain_it = (ecs_iter_t*)it,
+        .is_instanced = it->is_instanced
+    };
+
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+/* Find offset and primitive kind of the member for a component */
+static
+void range_resolve_member(
+    const ecs_world_t *world,
+    ecs_range_iter_t *iter,
+    ecs_id_t id)
+{
+    iter->id = id;
+    iter->offset = -1;
+
+    ecs_entity_t type = ecs_get_typeid(world, id);
+    if (!type) {
+        return;
+    }
+
+    int32_t offset = 0;
+    if (iter->member) {
+        const EcsStruct *st = ecs_get(world, type, EcsStruct);
+        if (!st) {
+            return;
+        }
+
+        ecs_member_t *members = ecs_vector_first(st->members, ecs_member_t);
+        int32_t i, count = ecs_vector_count(st->members);
+        for (i = 0; i < count; i ++) {
+            if (!ecs_os_strcmp(members[i].name, iter->member)) {
+                break;
+            }
+        }
+
+        if (i == count || members[i].count > 1) {
+            return;
+        }
+
+        type = members[i].type;
+        offset = members[i].offset;
+    }
+
+    const EcsPrimitive *ptr = ecs_get(world, type, EcsPrimitive);
+    if (!ptr || ptr->kind == EcsString) {
+        return;
+    }
+
+    iter->offset = offset;
+    iter->kind = ptr->kind;
+}
+
+/* Get zone map for member in current result of chained iterator */
+static
+int32_t range_get_zone_map(
+    ecs_iter_t *it,
+    ecs_range_iter_t *iter)
+{
+    ecs_table_t *table = it->table;
+    int32_t t = iter->term - 1;
+    if (!table || t >= it->term_count) {
+        return -1;
+    }
+
+    /* Only owned components are stored in the table */
+    if (it->subjects[t] || it->columns[t] <= 0) {
+        return -1;
+    }
+
+    ecs_id_t id = it->ids[t];
+    if (id != iter->id) {
+        range_resolve_member(it->real_world, iter, id);
+    }
+
+    if (iter->offset == -1) {
+        return -1;
+    }
+
+    int32_t column = ecs_table_type_to_storage_index(
+        table, it->columns[t] - 1);
+    if (column < 0) {
+        return -1;
+    }
+
+    /* Zone maps can't be updated when multiple threads could be iterating the
+     * same table */
+    ecs_world_t *world = it->real_world;
+    bool can_update = !world->is_readonly || ecs_get_stage_count(world) <= 1;
+
+    ecs_zone_map_t *map = flecs_table_get_zone_map(table, column, 
+        iter->offset, (ecs_primitive_kind_t)iter->kind, can_update);
+    if (!map) {
+        return -1;
+    }
+
+    return (int32_t)(map - ecs_vector_first(table->zone_maps, ecs_zone_map_t));
+}
+
+static
+bool range_overlaps(
+    const ecs_range_iter_t *iter,
+    const ecs_zone_t *zone)
+{
+    /* If min > max the zone has no values */
+    return zone->min <= zone->max && 
+        zone->min <= iter->max && zone->max >= iter->min;
+}
+
+static
+bool ecs_range_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_range_next, ECS_INVALID_PARAMETER, NULL);
+
+    bool instanced = it->is_instanced;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_range_iter_t *iter = &it->priv.iter.range;
+    ecs_zone_map_t *map;
+    int32_t first, end;
+
+    do {
+        if (iter->block >= iter->block_end) {
+            if (!ecs_iter_next(chain_it)) {
+                goto done;
+            }
+
+            iter->block = iter->block_end = 0;
+            iter->zone_map = range_get_zone_map(chain_it, iter);
+            if (iter->zone_map == -1) {
+                /* Values can't be tested, return result as is */
+                ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+                it->is_instanced = instanced;
+                if (!it->is_instanced) {
+                    it->offset = 0;
+                }
+                return true;
+            }
+
+            map = ecs_vector_get(chain_it->table->zone_maps, 
+                ecs_zone_map_t, iter->zone_map);
+            if (!range_overlaps(iter, &map->table)) {
+                first = iter->block; /* No blocks to return */
+                continue;
+            }
+
+            first = chain_it->offset;
+            end = first + chain_it->count;
+            iter->block = first / ECS_ZONE_BLOCK_SIZE;
+            iter->block_end = (end + ECS_ZONE_BLOCK_SIZE - 1) / 
+                ECS_ZONE_BLOCK_SIZE;
+        } else {
+            map = ecs_vector_get(chain_it->table->zone_maps, 
+                ecs_zone_map_t, iter->zone_map);
+        }
+
+        /* Find next sequence of blocks that overlap with the range */
+        ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+        int32_t b = iter->block, b_end = iter->block_end;
+        while (b < b_end && !range_overlaps(iter, &blocks[b])) {
+            b ++;
+        }
+
+        first = b;
+        while (b < b_end && range_overlaps(iter, &blocks[b])) {
+            b ++;
+        }
+
+        iter->block = b;
+    } while (first == iter->block);
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+    it->is_instanced = instanced;
+
+    /* Multiple ranges can be returned for the same result of the chained 
+     * iterator, so don't offset the term data of the chained iterator. */
+    copy_chain_ptrs(it, &iter->ptrs);
+
+    end = iter->block * ECS_ZONE_BLOCK_SIZE;
+    if (end > (chain_it->offset + chain_it->count)) {
+        end = chain_it->offset + chain_it->count;
+    }
+
+    first *= ECS_ZONE_BLOCK_SIZE;
+    if (first < chain_it->offset) {
+        first = chain_it->offset;
+    }
+
+    int32_t offset = first - chain_it->offset;
+    it->frame_offset += offset;
+
+    offset_iter(it, offset);
+    it->count = end - first;
+
+    if (it->is_instanced) {
+        it->offset += offset;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+done:
+    range_iter_fini(it);
+error:
+    return false;
+}
+
+bool ecs_range_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_range_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    it->chain_it->is_instanced = true;
+
+    if (flecs_iter_next_row(it)) {
+        return true;
+    }
+
+    return flecs_iter_next_instanced(it, ecs_range_next_instanced(it));
+error:
+    return false;
+}
+
+#endif
+
 #include <stddef.h>
 
 static
@@ -46854,7 +53055,8 @@ void _bootstrap_component(
         entity, record, false);
     record->row = ECS_ROW_TO_RECORD(index, 0);
 
-    EcsComponent *component = ecs_vector_first(columns[0].data, EcsComponent);
+    EcsComponent *component = ecs_vector_first_t(
+        columns[0].data, columns[0].size, columns[0].alignment);
     component[index].size = size;
     component[index].alignment = alignment;
 
@@ -46862,14 +53064,16 @@ void _bootstrap_component(
     ecs_size_t symbol_length = ecs_os_strlen(symbol);
     ecs_size_t name_length = symbol_length - 3;
 
-    EcsIdentifier *name_col = ecs_vector_first(columns[1].data, EcsIdentifier);
+    EcsIdentifier *name_col = ecs_vector_first_t(
+        columns[1].data, columns[1].size, columns[1].alignment);
     name_col[index].value = ecs_os_strdup(name);
     name_col[index].length = name_length;
     name_col[index].hash = flecs_hash(name, name_length);
     name_col[index].index_hash = 0;
     name_col[index].index = NULL;
 
-    EcsIdentifier *symbol_col = ecs_vector_first(columns[2].data, EcsIdentifier);
+    EcsIdentifier *symbol_col = ecs_vector_first_t(
+        columns[2].data, columns[2].size, columns[2].alignment);
     symbol_col[index].value = ecs_os_strdup(symbol);
     symbol_col[index].length = symbol_length;
     symbol_col[index].hash = flecs_hash(symbol, symbol_length);    
@@ -46932,9 +53136,10 @@ ecs_table_t* bootstrap_component_table(
     data->entities = ecs_vector_new(ecs_entity_t, EcsFirstUserComponentId);
     data->record_ptrs = ecs_vector_new(ecs_record_t*, EcsFirstUserComponentId);
 
-    data->columns[0].data = ecs_vector_new(EcsComponent, EcsFirstUserComponentId);
-    data->columns[1].data = ecs_vector_new(EcsIdentifier, EcsFirstUserComponentId);
-    data->columns[2].data = ecs_vector_new(EcsIdentifier, EcsFirstUserComponentId);
+    ecs_allocator_t *a = &world->allocator;
+    data->columns[0].data = flecs_vector_new(a, EcsComponent, EcsFirstUserComponentId);
+    data->columns[1].data = flecs_vector_new(a, EcsIdentifier, EcsFirstUserComponentId);
+    data->columns[2].data = flecs_vector_new(a, EcsIdentifier, EcsFirstUserComponentId);
     
     return result;
 }
@@ -47449,6 +53654,7 @@ ecs_entity_t ecs_lookup_child(
     const char *name)
 {
     ecs_check(world != NULL, ECS_INTERNAL_ERROR, NULL);
+    world = ecs_get_world(world);
 
     if (is_number(name)) {
         return name_to_id(world, name);
@@ -47804,3 +54010,1312 @@ ecs_entity_t ecs_new_from_path_w_sep(
     return ecs_add_path_w_sep(world, 0, parent, path, sep, prefix);
 }
 
+
+static
+ecs_closure_t* closure_get(
+    const ecs_world_t *world,
+    ecs_entity_t relation)
+{
+    if (!ecs_map_count(&world->closures)) {
+        return NULL;
+    }
+
+    return ecs_map_get_ptr(&world->closures, ecs_closure_t*,
+        ecs_entity_t_lo(relation));
+}
+
+static
+void closure_elems_free(
+    ecs_map_t *elems)
+{
+    ecs_map_iter_t it = ecs_map_iter(elems);
+    ecs_closure_elem_t *elem;
+    while ((elem = ecs_map_next_ptr(&it, ecs_closure_elem_t*, NULL))) {
+        ecs_vector_free(elem->nodes);
+        ecs_os_free(elem);
+    }
+
+    ecs_map_fini(elems);
+}
+
+static
+void closure_free(
+    ecs_closure_t *closure)
+{
+    closure_elems_free(&closure->supersets);
+    closure_elems_free(&closure->subsets);
+    ecs_os_free(closure);
+}
+
+/* Get element for key. If the element doesn't exist or is out of date, it is
+ * cleared and must be filled by the caller. */
+static
+ecs_closure_elem_t* closure_elem_get(
+    const ecs_world_t *world,
+    ecs_closure_t *closure,
+    ecs_map_t *elems,
+    uint64_t key,
+    bool *fill)
+{
+    ecs_closure_elem_t *elem = ecs_map_get_ptr(elems, ecs_closure_elem_t*, key);
+    if (elem && elem->generation == closure->generation) {
+        *fill = false;
+        return elem;
+    }
+
+    /* Index can't be modified while iterating in readonly mode, as multiple
+     * threads could be accessing it. With a single stage, the only iterators
+     * are on the current thread. */
+    if (world->is_readonly && ecs_get_stage_count(world) > 1) {
+        return NULL;
+    }
+
+    if (!elem) {
+        elem = ecs_os_calloc_t(ecs_closure_elem_t);
+        ecs_map_set_ptr(elems, key, elem);
+    }
+
+    ecs_vector_clear(elem->nodes);
+    elem->generation = closure->generation;
+    elem->pruned = false;
+    *fill = true;
+
+    return elem;
+}
+
+/* Returns true if key was visited before, marks key as visited otherwise */
+static
+bool closure_visit(
+    ecs_map_t *visited,
+    uint64_t key)
+{
+    if (ecs_map_has(visited, key)) {
+        return true;
+    }
+
+    ecs_map_ensure(visited, bool, key);
+    return false;
+}
+
+/* Add supersets of table in the same order in which they are visited when
+ * walking the relation depth first. Each superset is added once, which
+ * prevents infinite recursion for cycles. Supersets that can be reached by more
+ * than one path are only added for the first path. */
+static
+void closure_fill_supersets(
+    const ecs_world_t *world,
+    ecs_closure_elem_t *elem,
+    ecs_map_t *visited,
+    ecs_closure_t *closure,
+    const ecs_table_t *table,
+    int32_t depth)
+{
+    ecs_vector_t **nodes = &elem->nodes;
+    ecs_table_record_t *tr = flecs_get_table_record(world, table,
+        ecs_pair(closure->relation, EcsWildcard));
+    if (!tr) {
+        return;
+    }
+
+    ecs_id_t *ids = ecs_vector_first(table->type, ecs_id_t);
+    int32_t i, end = tr->column + tr->count;
+
+    for (i = tr->column; i < end; i ++) {
+        ecs_entity_t obj = ECS_PAIR_SECOND(ids[i]);
+        ecs_assert(obj != 0, ECS_INTERNAL_ERROR, NULL);
+
+        if (closure_visit(visited, obj)) {
+            elem->pruned = true;
+            continue;
+        }
+
+        int32_t index = ecs_vector_count(*nodes);
+        ecs_closure_node_t *node = ecs_vector_add(nodes, ecs_closure_node_t);
+        node->entity = obj;
+        node->depth = depth;
+
+        ecs_record_t *r = ecs_eis_get_any(world, obj);
+        if (r && r->table) {
+            closure_fill_supersets(
+                world, elem, visited, closure, r->table, depth + 1);
+        }
+
+        node = ecs_vector_get(*nodes, ecs_closure_node_t, index);
+        node->end = ecs_vector_count(*nodes);
+    }
+}
+
+/* Add non-empty tables with (relation, entity), each followed by the tables
+ * of the subsets of the entities in the table. Tables and entities are visited
+ * once, which prevents infinite recursion for cycles and prevents adding a 
+ * table more than once if it has pairs for more than one entity. */
+static
+void closure_fill_subsets(
+    const ecs_world_t *world,
+    ecs_closure_elem_t *elem,
+    ecs_map_t *visited,
+    ecs_closure_t *closure,
+    ecs_entity_t entity)
+{
+    ecs_id_record_t *idr = flecs_get_id_record(world,
+        ecs_pair(closure->relation, entity));
+    if (!idr) {
+        return;
+    }
+
+    ecs_table_cache_iter_t it;
+    if (!flecs_table_cache_iter(&idr->cache, &it)) {
+        return;
+    }
+
+    const ecs_table_record_t *tr;
+    while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+        ecs_table_t *table = tr->hdr.table;
+
+        /* Table ids and entity ids can overlap, so use a key that can't be
+         * an entity id for tables */
+        if (closure_visit(visited, ecs_pair(EcsWildcard, table->id))) {
+            elem->pruned = true;
+            continue;
+        }
+
+        ecs_closure_table_t *node = ecs_vector_add(
+            &elem->nodes, ecs_closure_table_t);
+        node->table = table;
+        node->column = tr->column;
+
+        ecs_entity_t *entities = ecs_vector_first(
+            table->storage.entities, ecs_entity_t);
+        int32_t i, count = ecs_table_count(table);
+        for (i = 0; i < count; i ++) {
+            ecs_entity_t e = entities[i];
+            if (closure_visit(visited, e)) {
+                elem->pruned = true;
+                continue;
+            }
+
+            closure_fill_subsets(world, elem, visited, closure, e);
+        }
+    }
+}
+
+static
+void closure_mark_tables(
+    ecs_world_t *world,
+    ecs_entity_t relation)
+{
+    ecs_id_record_t *idr = flecs_get_id_record(world,
+        ecs_pair(relation, EcsWildcard));
+    if (!idr) {
+        return;
+    }
+
+    ecs_table_cache_iter_t it;
+    const ecs_table_record_t *tr;
+
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            tr->hdr.table->flags |= EcsTableHasClosure;
+        }
+    }
+
+    if (flecs_table_cache_empty_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            tr->hdr.table->flags |= EcsTableHasClosure;
+        }
+    }
+}
+
+void flecs_closure_init(
+    ecs_world_t *world)
+{
+    ecs_map_init(&world->closures, ecs_closure_t*, 0);
+}
+
+void flecs_closure_fini(
+    ecs_world_t *world)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->closures);
+    ecs_closure_t *closure;
+    while ((closure = ecs_map_next_ptr(&it, ecs_closure_t*, NULL))) {
+        closure_free(closure);
+    }
+
+    ecs_map_fini(&world->closures);
+}
+
+bool flecs_closure_is_indexed(
+    const ecs_world_t *world,
+    ecs_entity_t relation)
+{
+    return closure_get(world, relation) != NULL;
+}
+
+void flecs_closure_table_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->closures);
+    ecs_closure_t *closure;
+    while ((closure = ecs_map_next_ptr(&it, ecs_closure_t*, NULL))) {
+        if (flecs_get_table_record(world, table,
+            ecs_pair(closure->relation, EcsWildcard)))
+        {
+            closure->generation ++;
+        }
+    }
+}
+
+/* Returns true if ids contain a pair for an indexed relation */
+static
+bool closure_has_indexed_pair(
+    const ecs_world_t *world,
+    const ecs_ids_t *ids)
+{
+    int32_t i, count = ids->count;
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids->array[i];
+        if (ECS_HAS_ROLE(id, PAIR) && closure_get(world, ECS_PAIR_FIRST(id))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void flecs_closure_entity_move(
+    ecs_world_t *world,
+    ecs_table_t *src_table,
+    ecs_table_t *dst_table,
+    uint32_t row_flags,
+    const ecs_table_diff_t *diff)
+{
+    bool src_closure = src_table && (src_table->flags & EcsTableHasClosure);
+    bool dst_closure = dst_table && (dst_table->flags & EcsTableHasClosure);
+    if (!src_closure && !dst_closure) {
+        return;
+    }
+
+    /* Adding an entity to or removing it from a table that stays non-empty
+     * doesn't change which tables are in a closure. The closure only changes
+     * when the entity gains or loses pairs for the relation, or when it is the
+     * object of a pair, in which case tables in the closure may depend on the
+     * table of the entity. Tables that become empty or non-empty are handled
+     * when the table administration is updated. */
+    if (!(row_flags & ECS_FLAG_OBSERVED_OBJECT) && (!diff || 
+        (!closure_has_indexed_pair(world, &diff->added) && 
+         !closure_has_indexed_pair(world, &diff->removed))))
+    {
+        return;
+    }
+
+    if (src_closure) {
+        flecs_closure_table_dirty(world, src_table);
+    }
+    if (dst_closure) {
+        flecs_closure_table_dirty(world, dst_table);
+    }
+}
+
+void flecs_closure_table_free(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->closures);
+    ecs_closure_t *closure;
+    while ((closure = ecs_map_next_ptr(&it, ecs_closure_t*, NULL))) {
+        /* Table id can be recycled, so remove the supersets of the table */
+        ecs_closure_elem_t *elem = ecs_map_get_ptr(
+            &closure->supersets, ecs_closure_elem_t*, table->id);
+        if (elem) {
+            ecs_vector_free(elem->nodes);
+            ecs_os_free(elem);
+            ecs_map_remove(&closure->supersets, table->id);
+        }
+
+        /* Subsets may contain the table */
+        if (table->flags & EcsTableHasClosure) {
+            closure->generation ++;
+        }
+    }
+}
+
+ecs_closure_elem_t* flecs_closure_get_supersets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    const ecs_table_t *table)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_closure_t *closure = closure_get(world, relation);
+    if (!closure) {
+        return NULL;
+    }
+
+    bool fill;
+    ecs_closure_elem_t *elem = closure_elem_get(
+        world, closure, &closure->supersets, table->id, &fill);
+    if (elem && fill) {
+        ecs_map_t visited;
+        ecs_map_init(&visited, bool, 0);
+        closure_fill_supersets(world, elem, &visited, closure, table, 1);
+        ecs_map_fini(&visited);
+    }
+
+    return elem;
+}
+
+ecs_closure_elem_t* flecs_closure_get_subsets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    ecs_entity_t entity)
+{
+    ecs_closure_t *closure = closure_get(world, relation);
+    if (!closure) {
+        return NULL;
+    }
+
+    bool fill;
+    ecs_closure_elem_t *elem = closure_elem_get(
+        world, closure, &closure->subsets, ecs_entity_t_lo(entity), &fill);
+    if (elem && fill) {
+        ecs_map_t visited;
+        ecs_map_init(&visited, bool, 0);
+        closure_visit(&visited, entity);
+        closure_fill_subsets(world, elem, &visited, closure, entity);
+        ecs_map_fini(&visited);
+    }
+
+    return elem;
+}
+
+bool ecs_enable_closure_index(
+    ecs_world_t *world,
+    ecs_entity_t relation,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(relation != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!world->is_readonly, ECS_INVALID_OPERATION, NULL);
+
+    ecs_closure_t *closure = closure_get(world, relation);
+    bool prev = closure != NULL;
+
+    if (enable && !closure) {
+        closure = ecs_os_calloc_t(ecs_closure_t);
+        closure->relation = relation;
+        ecs_map_init(&closure->supersets, ecs_closure_elem_t*, 0);
+        ecs_map_init(&closure->subsets, ecs_closure_elem_t*, 0);
+        ecs_map_set_ptr(&world->closures, ecs_entity_t_lo(relation), closure);
+
+        /* Tables created after this are marked when they're initialized */
+        closure_mark_tables(world, relation);
+    } else if (!enable && closure) {
+        /* Table flags are not reset, as tables can have pairs for more than
+         * one indexed relation. Stale flags only add a lookup when the table
+         * changes. */
+        ecs_map_remove(&world->closures, ecs_entity_t_lo(relation));
+        closure_free(closure);
+    }
+
+    return prev;
+error:
+    return false;
+}
+
+
+#define ECS_BLOCK_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_block_allocator_block_t), 16)
+
+static
+void ballocator_add_block(
+    ecs_block_allocator_t *ba)
+{
+    ecs_size_t chunk_size = ba->chunk_size;
+    int32_t i, chunk_count = ba->chunks_per_block;
+
+    ecs_block_allocator_block_t *block = ecs_os_malloc(
+        ECS_BLOCK_OFFSET + chunk_size * chunk_count);
+    ecs_assert(block != NULL, ECS_OUT_OF_MEMORY, NULL);
+    block->next = ba->blocks;
+    ba->blocks = block;
+    ba->block_count ++;
+
+    /* Add chunks to free list in address order */
+    ecs_block_allocator_chunk_t *first = ECS_OFFSET(block, ECS_BLOCK_OFFSET);
+    ecs_block_allocator_chunk_t *chunk = first;
+    for (i = 0; i < chunk_count - 1; i ++) {
+        chunk->next = ECS_OFFSET(chunk, chunk_size);
+        chunk = chunk->next;
+    }
+
+    chunk->next = ba->head;
+    ba->head = first;
+}
+
+void flecs_ballocator_init(
+    ecs_block_allocator_t *ba,
+    ecs_size_t chunk_size)
+{
+    ecs_assert(ba != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_os_zeromem(ba);
+    ba->chunk_size = ECS_ALIGN(chunk_size, 16);
+    ba->chunks_per_block = ECS_MAX(
+        ECS_BLOCK_ALLOCATOR_BLOCK_SIZE / ba->chunk_size, 1);
+}
+
+void flecs_ballocator_fini(
+    ecs_block_allocator_t *ba)
+{
+    ecs_assert(ba != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_block_allocator_block_t *next, *cur = ba->blocks;
+    while (cur) {
+        next = cur->next;
+        ecs_os_free(cur);
+        cur = next;
+    }
+
+    ba->head = NULL;
+    ba->blocks = NULL;
+    ba->block_count = 0;
+    ba->alloc_count = 0;
+}
+
+void* flecs_balloc(
+    ecs_block_allocator_t *ba)
+{
+    if (!ba->head) {
+        ballocator_add_block(ba);
+    }
+
+    ecs_block_allocator_chunk_t *result = ba->head;
+    ba->head = result->next;
+    ba->alloc_count ++;
+
+    return result;
+}
+
+void flecs_bfree(
+    ecs_block_allocator_t *ba,
+    void *ptr)
+{
+    ecs_assert(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(ba->alloc_count > 0, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_block_allocator_chunk_t *chunk = ptr;
+    chunk->next = ba->head;
+    ba->head = chunk;
+    ba->alloc_count --;
+}
+
+/* Get the size class for an allocation. Sizes up to 32 bytes use a class of 16
+ * or 32 bytes, after that each power of 2 is split in two classes. */
+static
+int32_t allocator_class(
+    ecs_size_t size)
+{
+    if (size <= 32) {
+        return size > 16;
+    }
+
+    int32_t index = 2;
+    ecs_size_t pow = 64;
+    while (pow < size) {
+        pow *= 2;
+        index += 2;
+    }
+
+    return index + 1 - (size <= ((pow >> 1) + (pow >> 2)));
+}
+
+static
+ecs_size_t allocator_class_size(
+    int32_t index)
+{
+    if (index < 2) {
+        return 16 << index;
+    }
+
+    ecs_size_t pow = 64 << ((index - 2) >> 1);
+    if (index & 1) {
+        return pow;
+    } else {
+        return (pow >> 1) + (pow >> 2);
+    }
+}
+
+void flecs_allocator_init(
+    ecs_allocator_t *a)
+{
+    ecs_assert(a != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(allocator_class_size(ECS_ALLOCATOR_CLASS_COUNT - 1) ==
+        ECS_ALLOCATOR_MAX_SIZE, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i;
+    for (i = 0; i < ECS_ALLOCATOR_CLASS_COUNT; i ++) {
+        flecs_ballocator_init(&a->classes[i], allocator_class_size(i));
+    }
+
+    a->block_count = 0;
+    a->alloc_count = 0;
+}
+
+void flecs_allocator_fini(
+    ecs_allocator_t *a)
+{
+    ecs_assert(a != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t i;
+    for (i = 0; i < ECS_ALLOCATOR_CLASS_COUNT; i ++) {
+        flecs_ballocator_fini(&a->classes[i]);
+    }
+
+    a->block_count = 0;
+    a->alloc_count = 0;
+}
+
+void* flecs_alloc(
+    ecs_allocator_t *a,
+    ecs_size_t size)
+{
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!a || size > ECS_ALLOCATOR_MAX_SIZE) {
+        void *result = ecs_os_malloc(size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+        return result;
+    }
+
+    ecs_block_allocator_t *ba = &a->classes[allocator_class(size)];
+    int32_t block_count = ba->block_count;
+    void *result = flecs_balloc(ba);
+    a->block_count += ba->block_count - block_count;
+    a->alloc_count ++;
+    return result;
+}
+
+void* flecs_calloc(
+    ecs_allocator_t *a,
+    ecs_size_t size)
+{
+    if (!a || size > ECS_ALLOCATOR_MAX_SIZE) {
+        void *result = ecs_os_calloc(size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+        return result;
+    }
+
+    void *result = flecs_alloc(a, size);
+    ecs_os_memset(result, 0, size);
+    return result;
+}
+
+void flecs_free(
+    ecs_allocator_t *a,
+    ecs_size_t size,
+    void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    if (!a || size > ECS_ALLOCATOR_MAX_SIZE) {
+        ecs_os_free(ptr);
+        return;
+    }
+
+    flecs_bfree(&a->classes[allocator_class(size)], ptr);
+}
+
+void* flecs_realloc(
+    ecs_allocator_t *a,
+    ecs_size_t dst_size,
+    ecs_size_t src_size,
+    void *ptr)
+{
+    if (!ptr) {
+        return flecs_alloc(a, dst_size);
+    }
+
+    if (!a || (dst_size > ECS_ALLOCATOR_MAX_SIZE &&
+        src_size > ECS_ALLOCATOR_MAX_SIZE))
+    {
+        void *result = ecs_os_realloc(ptr, dst_size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+        return result;
+    }
+
+    if (dst_size <= ECS_ALLOCATOR_MAX_SIZE &&
+        src_size <= ECS_ALLOCATOR_MAX_SIZE &&
+        allocator_class(dst_size) == allocator_class(src_size))
+    {
+        return ptr;
+    }
+
+    void *result = flecs_alloc(a, dst_size);
+    ecs_os_memcpy(result, ptr, ECS_MIN(dst_size, src_size));
+    flecs_free(a, src_size, ptr);
+    return result;
+}
+
+
+#define ECS_STACK_PAGE_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_stack_page_t), 16)
+
+static
+ecs_stack_page_t* stack_page_new(
+    ecs_stack_t *stack,
+    ecs_size_t size)
+{
+    ecs_stack_page_t *result = ecs_os_malloc(ECS_STACK_PAGE_OFFSET + size);
+    result->next = NULL;
+    result->size = size;
+    stack->page_count ++;
+    return result;
+}
+
+void flecs_stack_init(
+    ecs_stack_t *stack)
+{
+    ecs_os_zeromem(stack);
+}
+
+void flecs_stack_fini(
+    ecs_stack_t *stack)
+{
+    ecs_stack_page_t *next, *cur = stack->first;
+    while (cur) {
+        next = cur->next;
+        ecs_os_free(cur);
+        cur = next;
+    }
+    ecs_os_zeromem(stack);
+}
+
+void* flecs_stack_alloc(
+    ecs_stack_t *stack,
+    ecs_size_t size,
+    ecs_size_t align)
+{
+    ecs_assert(size > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(align > 0 && align <= 16, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_stack_page_t *page = stack->top.page;
+    ecs_size_t sp = stack->top.sp ? ECS_ALIGN(stack->top.sp, align) : 0;
+
+    if (!page || (sp + size) > page->size) {
+        /* Find next page that is large enough. Pages that are too small to
+         * hold the value are replaced, so that large values don't cause the
+         * allocator to skip over the remaining pages. */
+        ecs_stack_page_t **next_ptr = page ? &page->next : &stack->first;
+        ecs_stack_page_t *next = *next_ptr;
+        if (next && next->size < size) {
+            ecs_stack_page_t *after = next->next;
+            ecs_os_free(next);
+            stack->page_count --;
+            next = NULL;
+            *next_ptr = after;
+        }
+
+        if (!next) {
+            ecs_size_t page_size = ECS_STACK_PAGE_SIZE;
+            if (size > page_size) {
+                page_size = size;
+            }
+            next = stack_page_new(stack, page_size);
+            next->next = *next_ptr;
+            *next_ptr = next;
+        }
+
+        page = next;
+        sp = 0;
+    }
+
+    stack->top.page = page;
+    stack->top.sp = sp + size;
+    stack->alloc_count ++;
+
+    return ECS_OFFSET(page, ECS_STACK_PAGE_OFFSET + sp);
+}
+
+ecs_stack_cursor_t flecs_stack_get_cursor(
+    ecs_stack_t *stack)
+{
+    return stack->top;
+}
+
+void flecs_stack_restore_cursor(
+    ecs_stack_t *stack,
+    ecs_stack_cursor_t cursor)
+{
+    stack->top = cursor;
+}
+
+void flecs_stack_reset(
+    ecs_stack_t *stack)
+{
+    stack->top.page = NULL;
+    stack->top.sp = 0;
+}
+
+
+/* Number of signature elements for each term */
+#define ECS_FILTER_CACHE_TERM_SIZE (4)
+
+/* Signature contains for each term the id, operator and substitution 
+ * settings, and the filter flags that affect which tables are matched */
+static
+int32_t filter_cache_signature(
+    const ecs_filter_t *filter,
+    uint64_t *signature)
+{
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        ecs_term_set_t *set = &term->subj.set;
+        uint64_t *term_sig = &signature[i * ECS_FILTER_CACHE_TERM_SIZE];
+        term_sig[0] = term->id;
+        term_sig[1] = (uint64_t)term->oper | ((uint64_t)set->mask << 32);
+        term_sig[2] = set->relation;
+        term_sig[3] = (uint64_t)(uint32_t)set->min_depth | 
+            ((uint64_t)(uint32_t)set->max_depth << 32);
+    }
+
+    signature[count * ECS_FILTER_CACHE_TERM_SIZE] = 
+        (uint64_t)filter->match_prefab |
+        ((uint64_t)filter->match_disabled << 1);
+
+    return count * ECS_FILTER_CACHE_TERM_SIZE + 1;
+}
+
+/* Test if term can match components of supersets */
+static
+bool filter_cache_match_supersets(
+    const ecs_filter_t *filter)
+{
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        if (filter->terms[i].subj.set.mask & EcsSuperSet) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static
+void filter_cache_list_remove(
+    ecs_filter_cache_t *cache,
+    int32_t index)
+{
+    ecs_filter_cache_elem_t *elem = &cache->elems[index];
+
+    if (elem->prev != -1) {
+        cache->elems[elem->prev].next = elem->next;
+    } else {
+        cache->first = elem->next;
+    }
+
+    if (elem->next != -1) {
+        cache->elems[elem->next].prev = elem->prev;
+    } else {
+        cache->last = elem->prev;
+    }
+
+    elem->prev = -1;
+    elem->next = -1;
+}
+
+static
+void filter_cache_list_insert(
+    ecs_filter_cache_t *cache,
+    int32_t index)
+{
+    ecs_filter_cache_elem_t *elem = &cache->elems[index];
+
+    elem->prev = -1;
+    elem->next = cache->first;
+
+    if (cache->first != -1) {
+        cache->elems[cache->first].prev = index;
+    } else {
+        cache->last = index;
+    }
+
+    cache->first = index;
+}
+
+/* Find all tables (including empty tables) that match the filter */
+static
+void filter_cache_fill(
+    ecs_world_t *world,
+    ecs_filter_cache_elem_t *elem,
+    const ecs_filter_t *filter)
+{
+    ecs_filter_t f = *filter;
+    if (f.term_cache_used) {
+        f.terms = f.term_cache;
+    }
+
+    f.cached = false;
+    f.match_empty_tables = true;
+    f.instanced = true;
+    f.filter = true;
+
+    ecs_vector_clear(elem->tables);
+
+    ecs_table_t *last = NULL;
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    while (ecs_filter_next_instanced(&it)) {
+        /* Wildcard filters can return the same table multiple times */
+        if (it.table != last) {
+            ecs_table_t **ptr = ecs_vector_add(&elem->tables, ecs_table_t*);
+            *ptr = last = it.table;
+        }
+    }
+
+    elem->generation = world->filter_cache.generation;
+    elem->superset_generation = world->filter_cache.superset_generation;
+}
+
+/* Test if tables were created or deleted, or if supersets of matched tables
+ * changed since element was filled */
+static
+bool filter_cache_is_valid(
+    const ecs_filter_cache_t *cache,
+    const ecs_filter_cache_elem_t *elem)
+{
+    if (elem->generation != cache->generation) {
+        return false;
+    }
+
+    if (elem->match_supersets && 
+        elem->superset_generation != cache->superset_generation) 
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void flecs_filter_cache_init(
+    ecs_filter_cache_t *cache)
+{
+    ecs_map_init(&cache->index, int32_t, 0);
+    cache->count = 0;
+    cache->first = -1;
+    cache->last = -1;
+    cache->generation = 0;
+    cache->superset_generation = 0;
+}
+
+void flecs_filter_cache_fini(
+    ecs_filter_cache_t *cache)
+{
+    int32_t i;
+    for (i = 0; i < cache->count; i ++) {
+        ecs_filter_cache_elem_t *elem = &cache->elems[i];
+        ecs_vector_free(elem->signature);
+        ecs_vector_free(elem->tables);
+    }
+
+    ecs_map_fini(&cache->index);
+}
+
+void flecs_filter_cache_invalidate(
+    ecs_world_t *world)
+{
+    world->filter_cache.generation ++;
+}
+
+void flecs_filter_cache_invalidate_supersets(
+    ecs_world_t *world)
+{
+    world->filter_cache.superset_generation ++;
+}
+
+bool flecs_filter_is_cacheable(
+    const ecs_filter_t *filter)
+{
+    if (!filter->match_this) {
+        return false;
+    }
+
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+
+        /* Terms for other entities depend on the data of those entities */
+        if (term->subj.entity != EcsThis) {
+            return false;
+        }
+
+        /* Terms that match components of supersets are cached, as the cache
+         * is invalidated when an entity used as pair object changes tables.
+         * Subsets are not tracked. */
+        if (term->subj.set.mask & ~(EcsSelf | EcsSuperSet)) {
+            return false;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper == EcsAndFrom || oper == EcsOrFrom || oper == EcsNotFrom) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ecs_filter_cache_elem_t* flecs_filter_cache_get(
+    ecs_world_t *world,
+    const ecs_filter_t *filter)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(filter != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_filter_cache_t *cache = &world->filter_cache;
+
+    /* Elements can't be modified while iterating in readonly mode, as multiple
+     * threads could be accessing the cache. With a single stage, the only 
+     * iterators are on the current thread. */
+    bool readonly = world->is_readonly && ecs_get_stage_count(world) > 1;
+
+    uint64_t *signature = ecs_os_alloca_n(uint64_t, 
+        filter->term_count * ECS_FILTER_CACHE_TERM_SIZE + 1);
+    int32_t signature_count = filter_cache_signature(filter, signature);
+    ecs_size_t signature_size = signature_count * ECS_SIZEOF(uint64_t);
+    uint64_t hash = flecs_hash(signature, signature_size);
+
+    ecs_filter_cache_elem_t *elem = NULL;
+    int32_t *index_ptr = ecs_map_get(&cache->index, int32_t, hash);
+    int32_t index;
+
+    if (index_ptr) {
+        index = *index_ptr;
+        elem = &cache->elems[index];
+
+        if (ecs_vector_count(elem->signature) == signature_count &&
+            !ecs_os_memcmp(ecs_vector_first(elem->signature, uint64_t),
+                signature, signature_size))
+        {
+            if (!filter_cache_is_valid(cache, elem)) {
+                /* Tables were created or deleted, or supersets changed since
+                 * element was filled */
+                if (readonly) {
+                    return NULL;
+                }
+                filter_cache_fill(world, elem, filter);
+            }
+
+            if (!readonly) {
+                filter_cache_list_remove(cache, index);
+                filter_cache_list_insert(cache, index);
+            }
+
+            return elem;
+        }
+
+        /* Different filter with same hash, replace element */
+        if (readonly) {
+            return NULL;
+        }
+
+        filter_cache_list_remove(cache, index);
+    } else {
+        if (readonly) {
+            return NULL;
+        }
+
+        if (cache->count < ECS_FILTER_CACHE_SIZE) {
+            index = cache->count ++;
+            elem = &cache->elems[index];
+            ecs_os_zeromem(elem);
+        } else {
+            /* Cache is full, evict least recently used element */
+            index = cache->last;
+            elem = &cache->elems[index];
+            ecs_map_remove(&cache->index, elem->hash);
+            filter_cache_list_remove(cache, index);
+        }
+
+        ecs_map_set(&cache->index, hash, &index);
+    }
+
+    /* Iterators that still point to the element can detect that the element
+     * was reused for a different filter */
+    elem->version ++;
+    elem->hash = hash;
+    elem->match_supersets = filter_cache_match_supersets(filter);
+
+    ecs_vector_set_count(&elem->signature, uint64_t, signature_count);
+    ecs_os_memcpy(ecs_vector_first(elem->signature, uint64_t), signature,
+        signature_size);
+
+    filter_cache_fill(world, elem, filter);
+    filter_cache_list_insert(cache, index);
+
+    return elem;
+}
+
+ecs_table_t* flecs_filter_cache_next(
+    ecs_filter_iter_t *iter)
+{
+    ecs_filter_cache_elem_t *elem = iter->cache_elem;
+    ecs_assert(elem != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_check(elem->version == iter->cache_version, ECS_INVALID_OPERATION,
+        "cached filter was evicted while iterating");
+
+    bool match_empty = iter->filter.match_empty_tables;
+    int32_t count = ecs_vector_count(elem->tables);
+    ecs_table_t **tables = ecs_vector_first(elem->tables, ecs_table_t*);
+
+    while (iter->cache_index < count) {
+        ecs_table_t *table = tables[iter->cache_index ++];
+        if (match_empty || ecs_table_count(table)) {
+            return table;
+        }
+    }
+
+error:
+    return NULL;
+}
+
+
+void flecs_table_zone_maps_fini(
+    ecs_table_t *table)
+{
+    ecs_zone_map_t *maps = ecs_vector_first(table->zone_maps, ecs_zone_map_t);
+    int32_t i, count = ecs_vector_count(table->zone_maps);
+    for (i = 0; i < count; i ++) {
+        ecs_vector_free(maps[i].blocks);
+    }
+
+    ecs_vector_free(table->zone_maps);
+    table->zone_maps = NULL;
+}
+
+void flecs_table_zone_maps_mark_dirty(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_zone_map_t *maps = ecs_vector_first(table->zone_maps, ecs_zone_map_t);
+    int32_t i, map_count = ecs_vector_count(table->zone_maps);
+    for (i = 0; i < map_count; i ++) {
+        ecs_zone_map_t *map = &maps[i];
+        if (map->column != column) {
+            continue;
+        }
+
+        map->dirty = true;
+
+        /* Rows past the last block were added after the map was updated, which
+         * changed the table dirty state, so they don't need to be marked. */
+        ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+        int32_t b = offset / ECS_ZONE_BLOCK_SIZE;
+        int32_t end = (offset + count + ECS_ZONE_BLOCK_SIZE - 1) /
+            ECS_ZONE_BLOCK_SIZE;
+        int32_t block_count = ecs_vector_count(map->blocks);
+        if (end > block_count) {
+            end = block_count;
+        }
+
+        for (; b < end; b ++) {
+            blocks[b].dirty = true;
+        }
+    }
+}
+
+#ifdef FLECS_META
+
+/* Compute min/max of a primitive member for a range of rows. NaN values are
+ * ignored, as they never match a range. If no values are found, min is larger
+ * than max. */
+#define FLECS_ZONE_COMPUTE(T)\
+    static\
+    void zone_compute_##T(\
+        ecs_zone_t *zone,\
+        const void *ptr,\
+        ecs_size_t size,\
+        int32_t count)\
+    {\
+        double min = 1, max = 0;\
+        int32_t i;\
+        for (i = 0; i < count; i ++) {\
+            double v = (double)*(const T*)ECS_OFFSET(ptr, i * size);\
+            if (v != v) {\
+                continue;\
+            }\
+            if (min > max) {\
+                min = max = v;\
+            } else if (v < min) {\
+                min = v;\
+            } else if (v > max) {\
+                max = v;\
+            }\
+        }\
+        zone->min = min;\
+        zone->max = max;\
+    }
+
+FLECS_ZONE_COMPUTE(ecs_bool_t)
+FLECS_ZONE_COMPUTE(ecs_char_t)
+FLECS_ZONE_COMPUTE(ecs_byte_t)
+FLECS_ZONE_COMPUTE(ecs_u8_t)
+FLECS_ZONE_COMPUTE(ecs_u16_t)
+FLECS_ZONE_COMPUTE(ecs_u32_t)
+FLECS_ZONE_COMPUTE(ecs_u64_t)
+FLECS_ZONE_COMPUTE(ecs_uptr_t)
+FLECS_ZONE_COMPUTE(ecs_i8_t)
+FLECS_ZONE_COMPUTE(ecs_i16_t)
+FLECS_ZONE_COMPUTE(ecs_i32_t)
+FLECS_ZONE_COMPUTE(ecs_i64_t)
+FLECS_ZONE_COMPUTE(ecs_iptr_t)
+FLECS_ZONE_COMPUTE(ecs_f32_t)
+FLECS_ZONE_COMPUTE(ecs_f64_t)
+FLECS_ZONE_COMPUTE(ecs_entity_t)
+
+static
+void zone_compute(
+    ecs_zone_t *zone,
+    const void *ptr,
+    ecs_size_t size,
+    int32_t count,
+    ecs_primitive_kind_t kind)
+{
+    switch(kind) {
+    case EcsBool: zone_compute_ecs_bool_t(zone, ptr, size, count); break;
+    case EcsChar: zone_compute_ecs_char_t(zone, ptr, size, count); break;
+    case EcsByte: zone_compute_ecs_byte_t(zone, ptr, size, count); break;
+    case EcsU8: zone_compute_ecs_u8_t(zone, ptr, size, count); break;
+    case EcsU16: zone_compute_ecs_u16_t(zone, ptr, size, count); break;
+    case EcsU32: zone_compute_ecs_u32_t(zone, ptr, size, count); break;
+    case EcsU64: zone_compute_ecs_u64_t(zone, ptr, size, count); break;
+    case EcsUPtr: zone_compute_ecs_uptr_t(zone, ptr, size, count); break;
+    case EcsI8: zone_compute_ecs_i8_t(zone, ptr, size, count); break;
+    case EcsI16: zone_compute_ecs_i16_t(zone, ptr, size, count); break;
+    case EcsI32: zone_compute_ecs_i32_t(zone, ptr, size, count); break;
+    case EcsI64: zone_compute_ecs_i64_t(zone, ptr, size, count); break;
+    case EcsIPtr: zone_compute_ecs_iptr_t(zone, ptr, size, count); break;
+    case EcsF32: zone_compute_ecs_f32_t(zone, ptr, size, count); break;
+    case EcsF64: zone_compute_ecs_f64_t(zone, ptr, size, count); break;
+    case EcsEntity: zone_compute_ecs_entity_t(zone, ptr, size, count); break;
+    default: ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+
+    zone->dirty = false;
+}
+
+static
+void zone_map_update(
+    ecs_table_t *table,
+    ecs_zone_map_t *map,
+    int32_t table_state)
+{
+    int32_t i, count = ecs_table_count(table);
+    int32_t block_count = (count + ECS_ZONE_BLOCK_SIZE - 1) /
+        ECS_ZONE_BLOCK_SIZE;
+
+    /* If entities were added, removed or moved all blocks must be updated */
+    if (map->table_state != table_state) {
+        ecs_vector_set_count(&map->blocks, ecs_zone_t, block_count);
+        ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+        for (i = 0; i < block_count; i ++) {
+            blocks[i].dirty = true;
+        }
+        map->table_state = table_state;
+    }
+
+    ecs_column_t *column = &table->storage.columns[map->column];
+    ecs_size_t size = column->size;
+    void *ptr = ECS_OFFSET(ecs_vector_first_t(
+        column->data, size, column->alignment), map->offset);
+
+    ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+    ecs_zone_t *zone = &map->table;
+    zone->min = 1;
+    zone->max = 0;
+
+    for (i = 0; i < block_count; i ++) {
+        ecs_zone_t *block = &blocks[i];
+        if (block->dirty) {
+            int32_t first = i * ECS_ZONE_BLOCK_SIZE;
+            int32_t block_rows = count - first;
+            if (block_rows > ECS_ZONE_BLOCK_SIZE) {
+                block_rows = ECS_ZONE_BLOCK_SIZE;
+            }
+
+            zone_compute(block, ECS_OFFSET(ptr, first * size), size,
+                block_rows, (ecs_primitive_kind_t)map->kind);
+        }
+
+        if (block->min > block->max) {
+            continue;
+        }
+
+        if (zone->min > zone->max) {
+            zone->min = block->min;
+            zone->max = block->max;
+        } else {
+            if (block->min < zone->min) {
+                zone->min = block->min;
+            }
+            if (block->max > zone->max) {
+                zone->max = block->max;
+            }
+        }
+    }
+
+    map->dirty = false;
+}
+
+ecs_zone_map_t* flecs_table_get_zone_map(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    ecs_primitive_kind_t kind,
+    bool can_update)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_zone_map_t *map = NULL, *maps = ecs_vector_first(
+        table->zone_maps, ecs_zone_map_t);
+    int32_t i, count = ecs_vector_count(table->zone_maps);
+    for (i = 0; i < count; i ++) {
+        if (maps[i].column == column && maps[i].offset == offset) {
+            map = &maps[i];
+            break;
+        }
+    }
+
+    if (!map) {
+        if (!can_update) {
+            return NULL;
+        }
+
+        map = ecs_vector_add(&table->zone_maps, ecs_zone_map_t);
+        map->column = column;
+        map->offset = offset;
+        map->kind = kind;
+        map->table_state = 0; /* Dirty state starts at 1, forces update */
+        map->dirty = true;
+        map->blocks = NULL;
+    }
+
+    /* Ensure the table tracks changes, so that blocks are marked dirty */
+    int32_t table_state = flecs_table_get_dirty_state(table)[0];
+    if (map->table_state != table_state || map->dirty) {
+        if (!can_update) {
+            return NULL;
+        }
+
+        zone_map_update(table, map, table_state);
+    }
+
+    return map;
+}
+
+#endif
+
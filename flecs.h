@@ -1535,14 +1535,21 @@ private:
  * a 64-bit key. While it is not as fast as the sparse set, it is better at
  * handling randomly distributed values.
  *
- * Payload is stored in bucket arrays. A bucket is computed from an id by
- * using the (bucket_count - 1) as an AND-mask. The number of buckets is always
- * a power of 2. Multiple keys will be stored in the same bucket. As a result
- * the worst case retrieval performance of the map is O(n), though this is rare.
- * On average lookup performance should equal O(1).
- *
- * The datastructure will automatically grow the number of buckets when the
- * ratio between elements and buckets exceeds a certain threshold (LOAD_FACTOR).
+ * The map uses open addressing. Keys and payload are stored inline in arrays
+ * with a slot for each element, and for each slot the map stores a control 
+ * byte that contains 7 bits of the key hash, or whether the slot is empty or
+ * deleted. The upper bits of the key hash select a home slot for the key. An
+ * element is stored in its home slot when it is free, so that most lookups
+ * only test a single key. When the home slot is taken, it is marked as 
+ * displaced and slots are probed in groups of 16, where the control bytes of a
+ * group are compared in parallel (with SSE2 when available), so that keys are
+ * only compared for slots with matching hash bits. The number of slots is 
+ * always a power of 2.
+ *
+ * The datastructure will automatically grow the number of slots when the
+ * ratio between elements and slots exceeds a certain threshold (LOAD_FACTOR).
+ * Payload pointers remain valid until an element is added that causes the map
+ * to grow. Removing elements (also while iterating) does not move elements.
  *
  * Note that while the implementation is a hashmap, it can only compute hashes
  * for the provided 64 bit keys. This means that the provided keys must always
@@ -1563,27 +1570,23 @@ extern "C" {
 
 typedef uint64_t ecs_map_key_t;
 
-/* Map type */
-typedef struct ecs_bucket_t {
-    ecs_map_key_t *keys;    /* Array with keys */
-    void *payload;          /* Payload array */
-    int32_t count;          /* Number of elements in bucket */
-} ecs_bucket_t;
+struct ecs_allocator_t;
 
+/* Map type */
 typedef struct ecs_map_t {
-    ecs_bucket_t *buckets;
+    uint8_t *ctrl;          /* Control byte for each slot */
+    ecs_map_key_t *keys;    /* Key for each slot */
+    void *payload;          /* Payload for each slot */
+    struct ecs_allocator_t *allocator; /* Allocator for slots (optional) */
     int16_t elem_size;
-    uint8_t bucket_shift;
-    int32_t bucket_count;
-    int32_t count;
+    int32_t slot_count;     /* Number of slots */
+    int32_t count;          /* Number of elements */
+    int32_t deleted;        /* Number of slots marked as deleted */
 } ecs_map_t;
 
 typedef struct ecs_map_iter_t {
     const ecs_map_t *map;
-    struct ecs_bucket_t *bucket;
-    int32_t bucket_index;
-    int32_t element_index;
-    void *payload;
+    int32_t index;
 } ecs_map_iter_t;
 
 #define ECS_MAP_INIT(T) { .elem_size = ECS_SIZEOF(T) }
@@ -1598,6 +1601,17 @@ void _ecs_map_init(
 #define ecs_map_init(map, T, elem_count)\
     _ecs_map_init(map, sizeof(T), elem_count)
 
+/** Initialize new map that allocates slots from an allocator. */
+FLECS_DBG_API
+void _ecs_map_init_w_allocator(
+    ecs_map_t *map,
+    ecs_size_t elem_size,
+    int32_t elem_count,
+    struct ecs_allocator_t *allocator);
+
+#define ecs_map_init_w_allocator(map, T, elem_count, allocator)\
+    _ecs_map_init_w_allocator(map, sizeof(T), elem_count, allocator)
+
 /** Deinitialize map. */
 FLECS_API
 void ecs_map_fini(
@@ -1691,7 +1705,7 @@ FLECS_API
 int32_t ecs_map_count(
     const ecs_map_t *map);
 
-/** Return number of buckets in map. */
+/** Return number of slots in map. */
 FLECS_API
 int32_t ecs_map_bucket_count(
     const ecs_map_t *map);
@@ -1720,13 +1734,13 @@ void* _ecs_map_next_ptr(
 #define ecs_map_next_ptr(iter, T, key) \
     (T)_ecs_map_next_ptr(iter, key)
 
-/** Grow number of buckets in the map for specified number of elements. */
+/** Grow number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_grow(
     ecs_map_t *map,
     int32_t elem_count);
 
-/** Set number of buckets in the map for specified number of elements. */
+/** Set number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_set_size(
     ecs_map_t *map,
@@ -2555,6 +2569,14 @@ typedef struct ecs_mixins_t ecs_mixins_t;
 /* Maximum number of terms cached in static arrays */
 #define ECS_TERM_CACHE_SIZE (4)
 
+/* Minimum alignment of component arrays in tables. Arrays are aligned to this
+ * value when the OS allocator returns memory that is aligned to at least this
+ * value, which allows for aligned SIMD loads on owned terms. This is 16 and not
+ * a cache line (64), as the OS API has no aligned allocation function and
+ * malloc only guarantees 16 byte alignment. Array capacity is not padded to a
+ * multiple of the SIMD width, so kernels must handle a remainder. */
+#define ECS_COLUMN_ALIGNMENT (16)
+
 /* Maximum number of terms in desc (larger, as these are temp objects) */
 #define ECS_TERM_DESC_CACHE_SIZE (16)
 
@@ -2788,6 +2810,7 @@ struct ecs_filter_t {
     bool filter;               /* When true, data fields won't be populated */
     bool instanced;            /* See ecs_filter_desc_t */
     bool match_empty_tables;   /* See ecs_filter_desc_t */
+    bool cached;               /* See ecs_filter_desc_t */
     
     char *name;                /* Name of filter (optional) */
     char *expr;                /* Expression of filter (if provided) */
@@ -2957,6 +2980,30 @@ typedef struct ecs_worker_iter_t {
     int32_t count;
 } ecs_worker_iter_t;
 
+/* Chunk-iterator specific data */
+typedef struct ecs_chunk_iter_t {
+    int32_t *cursor;     /* Shared index of next chunk that can be claimed */
+    int32_t size;        /* Number of entities per chunk */
+    int32_t first;       /* Index of first chunk in current table */
+    int32_t count;       /* Number of chunks in current table */
+    void **ptrs;         /* Storage for term data if term_count > cache size */
+} ecs_chunk_iter_t;
+
+/* Range-iterator specific data */
+typedef struct ecs_range_iter_t {
+    const char *member;  /* Member to test, NULL if component is primitive */
+    double min;          /* Lower bound of range */
+    double max;          /* Upper bound of range */
+    int32_t term;        /* Term with component */
+    ecs_id_t id;         /* Component for which member was resolved */
+    int32_t offset;      /* Offset of member, -1 if member can't be tested */
+    int32_t kind;        /* Primitive kind of member */
+    int32_t zone_map;    /* Zone map of current table, -1 if not available */
+    int32_t block;       /* Next block to test in current table */
+    int32_t block_end;   /* End of blocks in current result */
+    void **ptrs;         /* Storage for term data if term_count > cache size */
+} ecs_range_iter_t;
+
 /* Convenience struct to iterate table array for id */
 typedef struct ecs_table_cache_iter_t {
     struct ecs_table_cache_hdr_t *cur, *next;
@@ -2991,6 +3038,7 @@ typedef enum ecs_iter_kind_t {
     EcsIterEvalIndex,
     EcsIterEvalChain,
     EcsIterEvalCondition,
+    EcsIterEvalCache,
     EcsIterEvalNone
 } ecs_iter_kind_t;
 
@@ -3000,16 +3048,26 @@ typedef struct ecs_filter_iter_t {
     ecs_iter_kind_t kind; 
     ecs_term_iter_t term_iter;
     int32_t matches_left;
+
+    /* Used when iterating tables from the world filter cache */
+    struct ecs_filter_cache_elem_t *cache_elem;
+    int32_t cache_version;
+    int32_t cache_index;
 } ecs_filter_iter_t;
 
 /** Query-iterator specific data */
 typedef struct ecs_query_iter_t {
     ecs_query_t *query;
     ecs_query_table_node_t *node, *prev;
+    ecs_query_table_node_t *last;  /* Last node to iterate (group iterators) */
     int32_t sparse_smallest;
     int32_t sparse_first;
     int32_t bitset_first;
     int32_t skip_count;
+    uint64_t group_id;             /* Id of current group */
+    int32_t group_index;           /* Number of groups visited */
+    int32_t partition_index;       /* Worker index when partitioning groups */
+    int32_t partition_count;       /* Number of workers */
 } ecs_query_iter_t;
 
 /** Snapshot-iterator specific data */
@@ -3034,6 +3092,7 @@ typedef struct ecs_rule_iter_t {
     struct ecs_rule_reg_t *registers;    /* Variable storage (tables, entities) */
     ecs_entity_t *variables;             /* Variable storage for iterator (entities only) */
     struct ecs_rule_op_ctx_t *op_ctx;    /* Operation-specific state */
+    int64_t *profile;                    /* Rows per operation (optional) */
     
     int32_t *columns;                    /* Column indices */
     
@@ -3042,6 +3101,13 @@ typedef struct ecs_rule_iter_t {
     bool redo;
     int32_t op;
     int32_t sp;
+
+    bool cached;                         /* Return results from rule cache */
+    int32_t cache_index;                 /* Index of next cached result */
+    int32_t cache_version;               /* Version of cache when iterating */
+
+    int32_t partition_index;             /* Index of worker (see ecs_rule_worker_iter) */
+    int32_t partition_count;             /* Number of workers */
 } ecs_rule_iter_t;
 
 /* Inline arrays for queries with small number of components */
@@ -3072,6 +3138,8 @@ typedef struct ecs_iter_private_t {
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
+        ecs_chunk_iter_t chunk;
+        ecs_range_iter_t range;
     } iter;                       /* Iterator specific data */
 
     ecs_iter_cache_t cache;       /* Inline arrays to reduce allocations */
@@ -3348,6 +3416,8 @@ void ecs_default_ctor(
 extern "C" {
 #endif
 
+struct ecs_allocator_t;
+
 struct ecs_sparse_t {
     ecs_vector_t *dense;        /* Dense array with indices to sparse array. The
                                  * dense array stores both alive and not alive
@@ -3359,6 +3429,7 @@ struct ecs_sparse_t {
     int32_t count;              /* Number of alive entries */
     uint64_t max_id_local;      /* Local max index (if no global is set) */
     uint64_t *max_id;           /* Maximum issued sparse index */
+    struct ecs_allocator_t *allocator; /* Allocator for chunks (optional) */
 };
 
 /** Initialize sparse set */
@@ -3370,6 +3441,16 @@ void _flecs_sparse_init(
 #define flecs_sparse_init(sparse, T)\
     _flecs_sparse_init(sparse, ECS_SIZEOF(T))
 
+/** Initialize sparse set that allocates chunks from an allocator */
+FLECS_DBG_API
+void _flecs_sparse_init_w_allocator(
+    ecs_sparse_t *sparse,
+    ecs_size_t elem_size,
+    struct ecs_allocator_t *allocator);
+
+#define flecs_sparse_init_w_allocator(sparse, T, allocator)\
+    _flecs_sparse_init_w_allocator(sparse, ECS_SIZEOF(T), allocator)
+
 /** Create new sparse set */
 FLECS_DBG_API
 ecs_sparse_t* _flecs_sparse_new(
@@ -3637,6 +3718,14 @@ void* _ecs_sparse_get(
  *
  * Datastructure that computes a hash to store & retrieve values. Similar to
  * ecs_map_t, but allows for arbitrary keytypes.
+ *
+ * Elements are stored in a single flat array. Each element stores the full
+ * hash of its key, and elements with the same hash are linked together. A map
+ * from hash to the first element with that hash is used to find elements, so
+ * that keys are only compared when their hashes are equal.
+ *
+ * Pointers to keys and values are invalidated when an element is added to or
+ * removed from the hashmap.
  */
 
 #ifndef FLECS_HASHMAP_H
@@ -3647,22 +3736,25 @@ void* _ecs_sparse_get(
 extern "C" {
 #endif
 
+/* Header of element. The key and value are stored after the header. */
 typedef struct {
-    ecs_vector_t *keys;
-    ecs_vector_t *values;
-} ecs_hm_bucket_t;
+    uint64_t hash;
+    int32_t next;         /* Next element with same hash, -1 if last */
+} ecs_hm_elem_t;
 
 typedef struct {
     ecs_hash_value_action_t hash;
     ecs_compare_action_t compare;
     ecs_size_t key_size;
     ecs_size_t value_size;
-    ecs_map_t impl;
+    ecs_size_t value_offset; /* Offset of value in element */
+    ecs_size_t elem_size;
+    ecs_map_t impl;          /* map<hash, int32_t> first element with hash */
+    ecs_vector_t *elems;
 } ecs_hashmap_t;
 
 typedef struct {
-    ecs_map_iter_t it;
-    ecs_hm_bucket_t *bucket;
+    ecs_hashmap_t *map;
     int32_t index;
 } flecs_hashmap_iter_t;
 
@@ -3739,18 +3831,46 @@ void _flecs_hashmap_remove_w_hash(
 #define flecs_hashmap_remove_w_hash(map, key, V, hash)\
     _flecs_hashmap_remove_w_hash(map, ECS_SIZEOF(*key), key, ECS_SIZEOF(V), hash)
 
+/* Get index of first element with hash, returns -1 if there is none */
 FLECS_DBG_API
-ecs_hm_bucket_t* flecs_hashmap_get_bucket(
+int32_t flecs_hashmap_get_index(
     const ecs_hashmap_t *map,
     uint64_t hash);
 
+/* Get index of next element with the same hash, returns -1 if there is none */
+FLECS_DBG_API
+int32_t flecs_hashmap_next_index(
+    const ecs_hashmap_t *map,
+    int32_t index);
+
+FLECS_DBG_API
+void* _flecs_hashmap_key_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t key_size,
+    int32_t index);
+
+#define flecs_hashmap_key_at(map, K, index)\
+    (K*)_flecs_hashmap_key_at(map, ECS_SIZEOF(K), index)
+
+FLECS_DBG_API
+void* _flecs_hashmap_value_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t value_size,
+    int32_t index);
+
+#define flecs_hashmap_value_at(map, V, index)\
+    (V*)_flecs_hashmap_value_at(map, ECS_SIZEOF(V), index)
+
+/* Remove element at index. The last element is moved to the index. */
 FLECS_DBG_API
-void flecs_hm_bucket_remove(
+void flecs_hashmap_remove_index(
     ecs_hashmap_t *map,
-    ecs_hm_bucket_t *bucket,
-    uint64_t hash,
     int32_t index);
 
+FLECS_DBG_API
+int32_t flecs_hashmap_count(
+    const ecs_hashmap_t *map);
+
 FLECS_DBG_API
 void flecs_hashmap_copy(
     const ecs_hashmap_t *src,
@@ -3895,6 +4015,29 @@ typedef struct ecs_filter_desc_t {
     /* Match empty tables. By default empty tables are not returned. */ 
     bool match_empty_tables;
 
+    /* When true, the tables matched by the filter are stored in a cache of the
+     * world, so that iterating a filter with the same terms again only has to
+     * visit matching tables. Cache entries are shared between filters with the
+     * same terms, are invalidated when tables are created or deleted, and the
+     * least recently used entry is evicted when the cache is full. Entries of
+     * filters that match components of supersets (the default for This) are
+     * also invalidated when an entity used as a pair object changes tables.
+     * The cache is not used for filters with terms that match entities other
+     * than This or that match subsets, in which case a warning is logged.
+     * While the world is readonly with more than one stage, the cache is not
+     * modified. A filter that has no valid entry in that case, for example
+     * because its entry was evicted or because another filter has the same
+     * signature hash, is iterated without the cache.
+     * 
+     * When used with ecs_rule_init, the rule stores its results (including the
+     * values of its variables) and returns them from the cache until one of
+     * the tables that can contribute to the results is created, deleted or
+     * has entities added or removed. A stale cache is refilled by evaluating
+     * the whole program again. While the world is readonly with more than one
+     * stage, a stale cache is not refilled and the program is evaluated 
+     * without the cache. */
+    bool cached;
+
     /* Filter expression. Should not be set at the same time as terms array */
     const char *expr;
 
@@ -3916,7 +4059,10 @@ typedef struct ecs_query_desc_t {
 
     /* Callback used for ordering query results. If order_by_id is 0, the 
      * pointer provided to the callback will be NULL. If the callback is not
-     * set, results will not be ordered. */
+     * set, results will not be ordered. When the callback is obtained with
+     * ecs_meta_order_by for order_by_component, large tables are sorted with a
+     * (faster) radix sort. That sort is not stable: the order of entities that
+     * compare equal is undefined. */
     ecs_order_by_action_t order_by;
 
     /* Id to be used by group_by. This id is passed to the group_by function and
@@ -4170,8 +4316,20 @@ typedef struct ecs_world_info_t {
     int32_t merge_count_total;        /* Total number of merges */
     int32_t pipeline_build_count_total; /* Total number of pipeline builds */
     int32_t systems_ran_frame;  /* Total number of systems ran in last frame */
+
+    int32_t stack_page_count;         /* Pages allocated by stage allocators */
+    int32_t stack_alloc_count_total;  /* Total number of stage allocations */
+    int32_t pool_block_count;         /* Blocks allocated by storage pools */
+    int32_t pool_alloc_count_total;   /* Total number of pool allocations */
 } ecs_world_info_t;
 
+/** Type that contains information about a query group. */
+typedef struct ecs_query_group_info_t {
+    uint64_t id;                      /* Group id */
+    int32_t table_count;              /* Number of non-empty tables in group */
+    int32_t entity_count;             /* Number of entities in group */
+} ecs_query_group_info_t;
+
 /** @} */
 
 /* Only include deprecated definitions if deprecated addon is required */
@@ -4642,6 +4800,51 @@ void ecs_dim(
     ecs_world_t *world,
     int32_t entity_count);
 
+/** Dimension a table for a specified number of entities.
+ * This operation will preallocate the component arrays of a table for the
+ * specified number of entities. Adding entities to the table will not
+ * reallocate its storage until the table grows beyond the specified number,
+ * which means that pointers to components in the table remain valid.
+ * Specifying a number lower than the current size of the table will have no
+ * effect.
+ *
+ * The component arrays remain contiguous. Once the table grows beyond the
+ * specified number of entities the arrays are reallocated as usual, which
+ * moves existing components and invalidates pointers to them.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param entity_count The number of entities to preallocate.
+ */
+FLECS_API
+void ecs_dim_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t entity_count);
+
+/** Store a table in fixed size chunks.
+ * By default the component arrays of a table are contiguous, and are
+ * reallocated when the table grows. This operation lets a table store its
+ * entities in chunks, where each component array of a chunk is at most
+ * chunk_size bytes. When a chunk is full, entities are added to the next chunk
+ * with space, or to a new chunk. Existing entities are never moved when the
+ * table grows, so pointers to their components (and refs) remain valid.
+ *
+ * A chunk is a table with the same type as the chunked table. Queries and
+ * iterators return each chunk as a separate table, so that a single result
+ * never spans multiple chunks. Storage that is already allocated for a chunk
+ * is kept, the chunk size is applied when an entity is added to an empty chunk.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param chunk_size The maximum size in bytes of a component array in a chunk.
+ */
+FLECS_API
+void ecs_table_set_chunk_size(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t chunk_size);
+
 /** Set a range for issueing new entity ids.
  * This function constrains the entity identifiers returned by ecs_new to the 
  * specified range. This operation can be used to ensure that multiple processes
@@ -5033,6 +5236,95 @@ void ecs_remove_id(
     ecs_entity_t entity,
     ecs_id_t id);
 
+/** Add an id to multiple entities.
+ * This operation has the same effect as calling ecs_add_id for each entity in
+ * the array, but moves entities that are stored next to each other in the same
+ * table with a single operation. OnAdd events are emitted once for each moved
+ * range of entities, instead of once per entity.
+ *
+ * The operation is most efficient when the array contains entities in the
+ * order in which they are stored, as is the case for entities created by
+ * ecs_bulk_new_w_id or entities returned by an iterator.
+ *
+ * @param world The world.
+ * @param entities The entities.
+ * @param count The number of entities.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id);
+
+/** Remove an id from multiple entities.
+ * Same as ecs_bulk_add_id, but removes the id. OnRemove events are emitted once
+ * for each moved range of entities.
+ *
+ * @param world The world.
+ * @param entities The entities.
+ * @param count The number of entities.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id);
+
+/** Set a component for multiple entities.
+ * Same as ecs_bulk_add_id, but also copies a value into the component for each
+ * entity. The values array must contain a value for each entity in the
+ * entities array. OnSet events are emitted once for each range of entities.
+ *
+ * @param world The world.
+ * @param entities The entities.
+ * @param count The number of entities.
+ * @param id The component to set.
+ * @param size The size of the component.
+ * @param values Array with count component values.
+ */
+FLECS_API
+void ecs_bulk_set_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    size_t size,
+    const void *values);
+
+/** Add an id to all entities that match a filter.
+ * The entities are moved per matched table, which makes this operation a lot
+ * faster than iterating the filter and adding the id to each entity. Entities
+ * that are matched by the filter are collected before any entities are moved,
+ * which means that entities that start matching the filter as a result of the
+ * operation are not affected.
+ *
+ * @param world The world.
+ * @param filter The filter.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
+/** Remove an id from all entities that match a filter.
+ * Same as ecs_bulk_add_id_w_filter, but removes the id.
+ *
+ * @param world The world.
+ * @param filter The filter.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
 /** @} */
 
 
@@ -6512,6 +6804,43 @@ bool ecs_query_changed(
     ecs_query_t *query,
     const ecs_iter_t *it);
 
+/** Find next range of changed rows in iterator result.
+ * This operation finds the first range of rows at or after the provided row
+ * that changed since the last time the query iterated the table. A row is 
+ * changed if any of the components for the terms monitored by change detection
+ * (see ecs_query_changed) were modified for that row.
+ * 
+ * Changes are tracked per row for components that are modified with 
+ * ecs_modified, ecs_set or by writing to the component in a query/system. When
+ * entities were added to or removed from the table, or when a component is
+ * not owned by the table, all rows are reported as changed. Row tracking for
+ * a component starts the first time this operation is called for the table,
+ * so the first call may report all rows as changed.
+ * 
+ * Rows are not tracked while the world is progressed with multiple threads, as
+ * worker threads may write the same table. Changes made by multi threaded 
+ * systems cause all rows of the table to be reported as changed.
+ * 
+ * The row is relative to the iterator result (0 is the first entity in it), 
+ * and is set to the first changed row when a range is found:
+ * 
+ *   int32_t row = 0, count;
+ *   while ((count = ecs_query_changed_range(&it, &row))) {
+ *     for (int32_t i = row; i < row + count; i ++) { ... }
+ *     row += count;
+ *   }
+ * 
+ * The same preconditions as for ecs_query_changed apply.
+ * 
+ * @param it The iterator result.
+ * @param row The row to start searching from, set to the first changed row.
+ * @return The number of changed rows in the range, or 0 if none were found.
+ */
+FLECS_API
+int32_t ecs_query_changed_range(
+    const ecs_iter_t *it,
+    int32_t *row);
+
 /** Skip a table while iterating.
  * This operation lets the query iterator know that a table was skipped while
  * iterating. A skipped table will not reset its changed state, and the query
@@ -6538,6 +6867,74 @@ FLECS_API
 bool ecs_query_orphaned(
     ecs_query_t *query);
 
+/** Iterate a single group of a query.
+ * This operation limits the iterator to the tables of the group with the 
+ * specified id, as computed by the group_by callback of the query. Only the
+ * tables of the group are visited, which lets an application skip entire
+ * groups (for example spatial cells that are not visible) without testing
+ * individual tables. If the group does not exist, the iterator won't return
+ * any results.
+ * 
+ * The operation must be called after ecs_query_iter, before ecs_query_next is
+ * called for the first time. The query must have been created with group_by.
+ * 
+ * @param it The query iterator.
+ * @param group_id The group to iterate.
+ */
+FLECS_API
+void ecs_query_set_group(
+    ecs_iter_t *it,
+    uint64_t group_id);
+
+/** Create query iterator that iterates a subset of the query groups.
+ * The groups of the query are distributed over the workers, where worker 
+ * 'index' iterates the groups at positions index, index + count, ... in group
+ * order. Each group is iterated by exactly one worker, which guarantees that
+ * a worker only accesses entities of its own groups.
+ * 
+ * @param world The world or stage, when iterating in readonly mode.
+ * @param query The query to iterate.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ * @return The query iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_query_group_worker_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query,
+    int32_t index,
+    int32_t count);
+
+/** Get information about a query group.
+ * 
+ * @param query The query.
+ * @param group_id The group id.
+ * @param info Out parameter for the group information.
+ * @return True if the group exists, false if it has no matched tables.
+ */
+FLECS_API
+bool ecs_query_get_group_info(
+    const ecs_query_t *query,
+    uint64_t group_id,
+    ecs_query_group_info_t *info);
+
+/** Get information about the groups of a query.
+ * This operation populates the provided array with information for the 
+ * (non-empty) groups of the query, in iteration order. If the array is smaller
+ * than the number of groups, only the first 'count' groups are returned. To 
+ * get the number of groups, use NULL for the array and 0 for the count.
+ * 
+ * @param query The query.
+ * @param groups Array that receives the group information (optional).
+ * @param count The number of elements in the array.
+ * @return The number of groups of the query.
+ */
+FLECS_API
+int32_t ecs_query_groups(
+    const ecs_query_t *query,
+    ecs_query_group_info_t *groups,
+    int32_t count);
+
 /** @} */
 
 
@@ -6874,6 +7271,50 @@ FLECS_API
 bool ecs_worker_next(
     ecs_iter_t *it);
 
+/** Create a chunk iterator.
+ * Chunk iterators divide the matched entities dynamically across N resources
+ * (usually threads). Each resource claims chunks of 'size' entities by 
+ * atomically incrementing a shared cursor, so that a resource that finishes
+ * early picks up more work. Tables with no more than 'size' entities are never
+ * split up across resources.
+ * 
+ * Each resource must create its own chunk iterator from an iterator that
+ * returns the same results in the same order (for example, an iterator for the
+ * same query). All resources must share the same cursor, which must be set to 
+ * 0 before any of the resources starts iterating. Chunks are claimed with the
+ * atomic increment operation of the OS API. The cursor must only be reset after
+ * all resources are done iterating.
+ *
+ * An iterator that is not iterated until the end must be cleaned up with 
+ * ecs_iter_fini.
+ * 
+ * The iterator must be iterated with ecs_chunk_next.
+ * 
+ * A chunk iterator acts as a passthrough for data exposed by the parent
+ * iterator, so that any data provided by the parent will also be provided by
+ * the chunk iterator.
+ * 
+ * @param it The source iterator.
+ * @param cursor The cursor shared between resources.
+ * @param size The number of entities in a chunk.
+ * @return A chunk iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t *cursor,
+    int32_t size);
+
+/** Progress a chunk iterator.
+ * Progresses an iterator created by ecs_chunk_iter.
+ * 
+ * @param it The iterator.
+ * @return true if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_chunk_next(
+    ecs_iter_t *it);
+
 /** Obtain data for a query term.
  * This operation retrieves a pointer to an array of data that belongs to the
  * term in the query. The index refers to the location of the term in the query,
@@ -6956,6 +7397,23 @@ bool ecs_term_is_owned(
     const ecs_iter_t *it,
     int32_t index);
 
+/** Test whether the term data is aligned.
+ * This operation returns whether the array for the term is owned and starts at
+ * an address that is a multiple of ECS_COLUMN_ALIGNMENT. Iterators that return
+ * all entities of a table starting from the first row always return aligned
+ * arrays, provided that the OS allocator returns memory with at least the same
+ * alignment. Iterators that split up tables, like worker iterators or iterators
+ * that are not instanced and have shared terms, may return unaligned arrays.
+ *
+ * @param it The iterator.
+ * @param index The index of the term in the query.
+ * @return Whether the term data is aligned.
+ */
+FLECS_API
+bool ecs_term_is_aligned(
+    const ecs_iter_t *it,
+    int32_t index);
+
 /** Convert iterator to string.
  * Prints the contents of an iterator to a string. Useful for debugging and/or
  * testing the output of an iterator.
@@ -7075,6 +7533,11 @@ FLECS_FLOAT ecs_frame_begin(
  * This operation must be called at the end of the frame, and always after
  * ecs_frame_begin.
  *
+ * Temporary memory that stages allocated during the frame is released, which
+ * includes the term arrays of iterators with more than ECS_TERM_CACHE_SIZE
+ * terms. Iterators created during the frame must not be used after the frame
+ * has ended.
+ *
  * @param world The world.
  */
 FLECS_API
@@ -7186,6 +7649,32 @@ void ecs_set_automerge(
     ecs_world_t *world,
     bool automerge);
 
+/** Enable/disable merging stages in entity order.
+ * By default the command queues of stages are merged one at a time, in stage
+ * order. When merging in entity order, the queues are sorted by entity (by the
+ * worker threads, before they synchronize) and then merged into a single queue.
+ * Commands for the same entity that were enqueued by different stages are then
+ * applied with a single table move, and observers are notified in entity order
+ * instead of stage order. Commands for the same entity are applied in stage
+ * order, and in the order in which they were enqueued by a stage.
+ *
+ * Only queues with commands that modify a single entity (add, remove, set,
+ * modified, enable, disable and new) can be reordered. If a queue contains
+ * other commands (like delete, clear, bulk new or adding an IsA pair), the
+ * stages are merged in stage order.
+ *
+ * An application should only enable this when the order in which commands for
+ * different entities are applied doesn't matter, for example when observers
+ * don't depend on the state of other entities.
+ *
+ * @param world The world.
+ * @param merge_by_entity Whether to enable or disable merging in entity order.
+ */
+FLECS_API
+void ecs_set_merge_by_entity(
+    ecs_world_t *world,
+    bool merge_by_entity);
+
 /** Configure world to have N stages.
  * This initializes N stages, which allows applications to defer operations to
  * multiple isolated defer queues. This is typically used for applications with
@@ -7425,6 +7914,28 @@ int32_t ecs_search_relation(
     ecs_id_t *id_out,
     struct ecs_table_record_t **tr_out);
 
+/** Enable/disable closure index for relation.
+ * A closure index stores for each table the entities that can be reached by
+ * traversing the relation, and for each entity the tables that can reach it.
+ * When a relation is indexed, ecs_search_relation and the superset/subset 
+ * operations of rules no longer walk the relation table by table, which 
+ * improves performance for deep hierarchies.
+ * 
+ * The index is populated on demand, and is invalidated when entities are added
+ * to or removed from tables with the relation. Indexing a relation is therefore
+ * most useful when the relation pairs of entities change infrequently.
+ * 
+ * @param world The world.
+ * @param relation The relation to index.
+ * @param enable True to enable the index, false to disable.
+ * @return The previous value.
+ */
+FLECS_API
+bool ecs_enable_closure_index(
+    ecs_world_t *world,
+    ecs_entity_t relation,
+    bool enable);
+
 /** @} */
 
 /**
@@ -7758,6 +8269,25 @@ void* ecs_record_get_column(
     ecs_remove_id(world, subject, ecs_pair(relation, object))
 
 
+/* -- Bulk add/remove/set -- */
+
+#define ecs_bulk_add(world, entities, count, T)\
+    ecs_bulk_add_id(world, entities, count, ecs_id(T))
+
+#define ecs_bulk_add_pair(world, entities, count, relation, object)\
+    ecs_bulk_add_id(world, entities, count, ecs_pair(relation, object))
+
+#define ecs_bulk_remove(world, entities, count, T)\
+    ecs_bulk_remove_id(world, entities, count, ecs_id(T))
+
+#define ecs_bulk_remove_pair(world, entities, count, relation, object)\
+    ecs_bulk_remove_id(world, entities, count, ecs_pair(relation, object))
+
+#define ecs_bulk_set(world, entities, count, component, values)\
+    ecs_bulk_set_id(world, entities, count, ecs_id(component),\
+        sizeof(component), values)
+
+
 /* -- Bulk remove/delete -- */
 
 #define ecs_delete_children(world, parent)\
@@ -8622,6 +9152,26 @@ void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads);
 
+/** Run single threaded systems concurrently.
+ * When enabled, systems that are not multi threaded and that run between the
+ * same two merges are distributed across worker threads. Systems whose queries
+ * access the same component, where at least one of the systems writes the
+ * component, are always ran on the same thread in pipeline order.
+ *
+ * Only data accessed through the system query is taken into account. Systems
+ * that access components in other ways (for example with ecs_get on an entity
+ * that is not matched by the query) should be marked as no_staging, or this
+ * feature should not be enabled. Systems that don't use staging are never ran
+ * concurrently.
+ *
+ * @param world The world.
+ * @param enable Whether to run single threaded systems concurrently.
+ */
+FLECS_API
+void ecs_set_concurrent_systems(
+    ecs_world_t *world,
+    bool enable);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Module
 ////////////////////////////////////////////////////////////////////////////////
@@ -8774,6 +9324,19 @@ typedef struct ecs_system_desc_t {
     /* If true, system will be ran on multiple threads */
     bool multi_threaded;
 
+    /* If set to a value larger than 0, a multi threaded system distributes its
+     * entities dynamically across threads in chunks of chunk_size entities,
+     * instead of dividing each table equally between threads. Chunks are only
+     * used when the system is ran by a pipeline, which resets the claimed
+     * chunks at the sync point after the system. When ran with ecs_run_worker,
+     * each table is divided equally between threads. */
+    int32_t chunk_size;
+
+    /* If true, a multi threaded system with a grouped query (see group_by)
+     * distributes its groups across threads, instead of dividing each table
+     * between threads. Each group is iterated by a single thread. */
+    bool partition_groups;
+
     /* If true, system will have access to actuall world. Cannot be true at the
      * same time as multi_threaded. */
     bool no_staging;
@@ -10082,6 +10645,78 @@ ecs_entity_t ecs_meta_get_entity(
     const ecs_meta_cursor_t *cursor);
 
 
+/** Range iterator */
+
+/** Create a range iterator.
+ * A range iterator skips tables, and blocks of rows within tables, for which
+ * none of the values of a member are in the [min, max] range. This lets an
+ * application that tests a range (e.g. health below zero, or a position inside
+ * of a region) avoid visiting tables that can't contain matching entities.
+ * 
+ * Tables are skipped by testing min/max statistics of the member, which are 
+ * stored per table and per block of rows. Statistics are created the first 
+ * time a table is iterated with a range iterator for the member, and are 
+ * updated for blocks in which values changed. Changes are detected in the same
+ * way as ecs_query_changed: values must be written with ecs_set, ecs_modified
+ * or by a query term that is not readonly. When the world is readonly and has
+ * multiple stages, statistics are not updated and out of date tables are not 
+ * skipped.
+ * 
+ * The member must have a primitive type. If member is NULL, the component must
+ * be a primitive type. Results for which the term is not owned, or for which 
+ * the member can't be found, are not skipped.
+ * 
+ * Individual values are not tested: the returned results can still contain
+ * entities for which the member is not in the range. 
+ * 
+ * The iterator must be iterated with ecs_range_next.
+ * 
+ * @param it The source iterator.
+ * @param term The index of the term with the component (starts from 1).
+ * @param member The name of the member (optional).
+ * @param min The lower bound of the range.
+ * @param max The upper bound of the range.
+ * @return A range iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_range_iter(
+    const ecs_iter_t *it,
+    int32_t term,
+    const char *member,
+    double min,
+    double max);
+
+/** Progress a range iterator.
+ * Progresses an iterator created by ecs_range_iter.
+ * 
+ * @param it The iterator.
+ * @return true if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_range_next(
+    ecs_iter_t *it);
+
+
+/** Ordering */
+
+/** Get comparator that orders by the value of a type.
+ * The type must be a primitive type, or a struct of which the first member is
+ * a primitive type. Structs are ordered by the value of that member.
+ * 
+ * When the comparator is used as order_by callback of a query, with the type
+ * as order_by_component, large tables are sorted with a radix sort instead of
+ * a comparison sort. The order of entities with equal values is undefined.
+ * 
+ * @param world The world.
+ * @param type The type to order by.
+ * @return The comparator, or NULL if the type can't be ordered by value.
+ */
+FLECS_API
+ecs_order_by_action_t ecs_meta_order_by(
+    const ecs_world_t *world,
+    ecs_entity_t type);
+
+
 /** API functions for creating meta types */
 
 /** Used with ecs_primitive_init. */
@@ -10900,6 +11535,33 @@ ecs_iter_t ecs_rule_iter(
     const ecs_world_t *world,
     const ecs_rule_t *rule);
 
+/** Iterate a rule for a worker.
+ * Worker rule iterators divide the work of evaluating a rule across N 
+ * resources (usually threads). The tables found by the first select operation
+ * of the rule program are distributed round-robin across workers, and each
+ * worker evaluates the remainder of the program for its own tables. Together
+ * the workers return the same results as a regular rule iterator, where each
+ * result is returned by exactly one worker.
+ * 
+ * For cached rules, the cached results are distributed across workers. If the
+ * variable of the first select operation is set with ecs_rule_set_var, only
+ * the first worker returns results.
+ * 
+ * The iterator must be iterated with ecs_rule_next.
+ * 
+ * @param world The world (or stage of the worker).
+ * @param rule The rule.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ * @return An iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count);
+
 /** Progress rule iterator.
  * 
  * @param it The iterator.
@@ -10930,6 +11592,26 @@ FLECS_API
 char* ecs_rule_str(
     ecs_rule_t *rule);
 
+/** Convert rule plan to a string.
+ * This evaluates the rule and converts the rule program to a string which for
+ * each operation contains the estimated (E) and actual (A) number of rows. The
+ * estimate is the number of entities matched by the term of the operation when
+ * the rule was created. The actual number is the number of entities that the
+ * operation produced while evaluating the rule.
+ * 
+ * The rule compiler uses the estimates to decide in which order terms are
+ * evaluated. Comparing the estimates with the actual numbers can help with
+ * finding out why a rule is slow.
+ * 
+ * The returned string must be freed with ecs_os_free.
+ * 
+ * @param rule The rule.
+ * @return The string
+ */
+FLECS_API
+char* ecs_rule_plan_str(
+    ecs_rule_t *rule);
+
 
 #ifdef __cplusplus
 }
@@ -11113,6 +11795,14 @@ typedef struct ecs_world_stats_t {
     ecs_counter_t pipeline_build_count_total; /* Number of system pipeline rebuilds (occurs when an inactive system becomes active). */
     ecs_counter_t systems_ran_frame;          /* Number of systems ran in the last frame. */
 
+    /* Memory */
+    ecs_gauge_t stack_page_count;             /* Number of pages allocated by stage allocators. */
+    ecs_counter_t stack_alloc_count_total;    /* Number of allocations served by stage allocators. */
+    ecs_gauge_t pool_block_count;             /* Number of blocks allocated by storage pools. */
+    ecs_counter_t pool_alloc_count_total;     /* Number of allocations served by storage pools. */
+    ecs_gauge_t table_edge_count;             /* Number of edges between tables in the table graph. */
+    ecs_gauge_t table_edge_memory;            /* Memory (in bytes) allocated for table graph edges. */
+
     /** Current position in ringbuffer */
     int32_t t;
 } ecs_world_stats_t;
@@ -12782,6 +13472,111 @@ using first_arg_t = typename first_arg<Func>::type;
 
 } // flecs
 
+////////////////////////////////////////////////////////////////////////////////
+//// Utilities for batch callbacks
+////////////////////////////////////////////////////////////////////////////////
+
+// Width in bytes of the vector registers that lanes are sized for. The default
+// matches 256 bit registers (AVX/AVX2). Define before including flecs to
+// target other instruction sets.
+#ifndef FLECS_BATCH_WIDTH
+#define FLECS_BATCH_WIDTH (32)
+#endif
+
+// Size of the buffer that batch callbacks use to pass shared components as an
+// array. The buffer is allocated on the stack of the invoker.
+#ifndef FLECS_BATCH_SHARED_SIZE
+#define FLECS_BATCH_SHARED_SIZE (4096)
+#endif
+
+namespace flecs
+{
+
+/** Number of values of type T that fit in a vector register.
+ * Use this as the size of lane arrays in a batch callback, for example:
+ *   float x[flecs::lanes<float>::value];
+ */
+template <typename T>
+struct lanes : std::integral_constant<size_t,
+    (sizeof(T) < FLECS_BATCH_WIDTH) ? (FLECS_BATCH_WIDTH / sizeof(T)) : 1> { };
+
+/** Load member of consecutive components into lanes.
+ * Components are stored as arrays of structs. A loop that accesses a single
+ * member of each element reads memory with a stride, which compilers often
+ * don't vectorize. Loading the member of N elements into an array of N lanes
+ * first lets the loop that processes the lanes use vector instructions:
+ *
+ *   q.batch([](size_t count, Position *p, const Velocity *v) {
+ *       const size_t N = flecs::lanes<float>::value;
+ *       size_t i = 0;
+ *       for (; i + N <= count; i += N) {
+ *           float x[N], vx[N];
+ *           flecs::load_lanes(x, &p[i], &Position::x);
+ *           flecs::load_lanes(vx, &v[i], &Velocity::x);
+ *           for (size_t l = 0; l < N; l ++) {
+ *               x[l] += vx[l];
+ *           }
+ *           flecs::store_lanes(&p[i], &Position::x, x);
+ *       }
+ *       for (; i < count; i ++) {
+ *           p[i].x += v[i].x;
+ *       }
+ *   });
+ *
+ * @param lanes The array to load the values into.
+ * @param elems Pointer to the first element. Must have at least N elements.
+ * @param member The member to load.
+ */
+template <typename T, typename M, size_t N>
+inline void load_lanes(M (&lanes)[N], const T *elems, M T::*member) {
+    for (size_t i = 0; i < N; i ++) {
+        lanes[i] = elems[i].*member;
+    }
+}
+
+/** Store lanes into member of consecutive components.
+ * Counterpart of load_lanes.
+ *
+ * @param elems Pointer to the first element. Must have at least N elements.
+ * @param member The member to store.
+ * @param lanes The array with the values to store.
+ */
+template <typename T, typename M, size_t N>
+inline void store_lanes(T *elems, M T::*member, const M (&lanes)[N]) {
+    for (size_t i = 0; i < N; i ++) {
+        elems[i].*member = lanes[i];
+    }
+}
+
+/** Load member of consecutive components into a partial set of lanes.
+ * Same as load_lanes, but loads count values. Use this for the remaining
+ * elements of an array that are not a multiple of the number of lanes.
+ */
+template <typename T, typename M, size_t N>
+inline void load_lanes(M (&lanes)[N], const T *elems, M T::*member,
+    size_t count)
+{
+    ecs_assert(count <= N, ECS_INVALID_PARAMETER, NULL);
+    for (size_t i = 0; i < count; i ++) {
+        lanes[i] = elems[i].*member;
+    }
+}
+
+/** Store a partial set of lanes into member of consecutive components.
+ * Counterpart of load_lanes with a count.
+ */
+template <typename T, typename M, size_t N>
+inline void store_lanes(T *elems, M T::*member, const M (&lanes)[N],
+    size_t count)
+{
+    ecs_assert(count <= N, ECS_INVALID_PARAMETER, NULL);
+    for (size_t i = 0; i < count; i ++) {
+        elems[i].*member = lanes[i];
+    }
+}
+
+}
+
 
 
 // Mixin forward declarations
@@ -14768,6 +15563,30 @@ struct world {
         ecs_enable_range_check(m_world, enabled);
     }
 
+    /** Enable/disable closure index for relation.
+     * See ecs_enable_closure_index.
+     *
+     * @param relation The relation to index.
+     * @param enabled True if the index should be enabled, false if not.
+     * @return The previous value.
+     */
+    bool enable_closure_index(entity_t relation, bool enabled = true) const {
+        return ecs_enable_closure_index(m_world, relation, enabled);
+    }
+
+    /** Enable/disable closure index for relation.
+     * See ecs_enable_closure_index.
+     *
+     * @tparam Relation The relation to index.
+     * @param enabled True if the index should be enabled, false if not.
+     * @return The previous value.
+     */
+    template <typename Relation>
+    bool enable_closure_index(bool enabled = true) const {
+        return ecs_enable_closure_index(m_world, 
+            _::cpp_type<Relation>::id(m_world), enabled);
+    }
+
     /** Set current scope.
      *
      * @param scope The scope to set.
@@ -15406,6 +16225,11 @@ void deactivate_systems() const;
  */
 void set_threads(int32_t threads) const;
 
+/** Run single threaded systems concurrently.
+ * @see ecs_set_concurrent_systems
+ */
+void set_concurrent_systems(bool enable = true) const;
+
 /** Set number of threads.
  * @see ecs_get_threads
  */
@@ -18071,6 +18895,179 @@ private:
 };
 
 
+////////////////////////////////////////////////////////////////////////////////
+//// Utility class to invoke a system batch action
+////////////////////////////////////////////////////////////////////////////////
+
+// Batch invokers pass the number of entities and a plain pointer to the array
+// of each term to the callback. Because the callback body only deals with
+// pointers and a count, compilers are able to vectorize loops over the arrays.
+template <typename Func, typename ... Components>
+struct batch_invoker : invoker {
+private:
+    using Terms = typename term_ptrs<Components ...>::array;
+    using Sizes = flecs::array<size_t, sizeof...(Components)>;
+
+    static_assert(arity<Func>::value == (sizeof...(Components) + 1),
+        "batch() must have a count argument and one argument per component");
+
+public:
+    template < if_not_t< is_same< void(Func), void(Func)& >::value > = 0>
+    explicit batch_invoker(Func&& func) noexcept 
+        : m_func(FLECS_MOV(func)) { }
+
+    explicit batch_invoker(const Func& func) noexcept 
+        : m_func(func) { }
+
+    // Invoke object directly. This operation is useful when the calling
+    // function has just constructed the invoker, such as what happens when
+    // iterating a query.
+    void invoke(ecs_iter_t *iter) const {
+        term_ptrs<Components...> terms;
+        if (terms.populate(iter)) {
+            invoke_shared(iter, terms.m_terms);
+        } else {
+            invoke_callback(iter, m_func, static_cast<size_t>(iter->count), 
+                0, terms.m_terms);
+        }
+    }
+
+    // Static function that can be used as callback for systems/triggers
+    static void run(ecs_iter_t *iter) {
+        auto self = static_cast<const batch_invoker*>(iter->binding_ctx);
+        ecs_assert(self != nullptr, ECS_INTERNAL_ERROR, NULL);
+        self->invoke(iter);
+    }
+
+    // Batch invokers are instanced, so that tables with shared components are
+    // not iterated one entity at a time. The invoker passes shared components
+    // as arrays (see invoke_shared).
+    static bool instanced() {
+        return true;
+    }
+
+private:
+    // Shared components point to a single value instead of an array. Shared 
+    // components that are const and trivially copyable are copied to a buffer
+    // with one value per entity, and the callback is invoked for as many 
+    // entities as fit in the buffer. If a shared component can't be copied the
+    // callback is invoked for each entity.
+    void invoke_shared(ecs_iter_t *iter, Terms& terms) const {
+        alignas(16) unsigned char buffer[FLECS_BATCH_SHARED_SIZE];
+        size_t i, count = static_cast<size_t>(iter->count);
+        size_t entity_size = 0, chunk = 1;
+        Sizes sizes;
+        Terms chunk_terms = terms;
+
+        if (shared_sizes(terms, sizes, entity_size, 0, static_cast<
+            remove_reference_t<
+                remove_pointer_t<
+                    actual_type_t<Components> > >*>(nullptr)...)) 
+        {
+            if (!entity_size) {
+                /* Only shared tags, nothing to copy */
+                chunk = count;
+            } else {
+                /* Round down to a multiple of 16, so arrays remain aligned */
+                chunk = (FLECS_BATCH_SHARED_SIZE / entity_size) & ~size_t(15);
+            }
+        }
+
+        if (chunk > 1) {
+            size_t elem_count = count < chunk ? count : chunk;
+            unsigned char *ptr = buffer;
+            for (i = 0; i < sizeof...(Components); i ++) {
+                if (!terms[i].is_ref || !sizes[i]) {
+                    continue;
+                }
+
+                /* Copy value, then keep doubling the copied range */
+                size_t copied = 1;
+                ecs_os_memcpy(ptr, terms[i].ptr, 
+                    static_cast<ecs_size_t>(sizes[i]));
+                while (copied < elem_count) {
+                    size_t n = elem_count - copied;
+                    n = n < copied ? n : copied;
+                    ecs_os_memcpy(&ptr[copied * sizes[i]], ptr,
+                        static_cast<ecs_size_t>(n * sizes[i]));
+                    copied += n;
+                }
+
+                chunk_terms[i].ptr = ptr;
+                ptr += chunk * sizes[i];
+            }
+        } else {
+            chunk = 1;
+        }
+
+        for (size_t offset = 0; offset < count; offset += chunk) {
+            for (i = 0; i < sizeof...(Components); i ++) {
+                if (!terms[i].is_ref && terms[i].ptr) {
+                    chunk_terms[i].ptr = ECS_OFFSET(
+                        terms[i].ptr, sizes[i] * offset);
+                }
+            }
+
+            size_t remaining = count - offset;
+            invoke_callback(iter, m_func, remaining < chunk ? remaining : chunk,
+                0, chunk_terms);
+        }
+    }
+
+    // Get component sizes and the number of bytes to copy per entity. Returns
+    // false if a shared component can't be copied to the buffer.
+    static bool shared_sizes(Terms&, Sizes&, size_t&, size_t) {
+        return true;
+    }
+
+    template <typename T, typename... Targs>
+    static bool shared_sizes(Terms& terms, Sizes& sizes, size_t& entity_size,
+        size_t index, T*, Targs... comps) 
+    {
+        bool result = true;
+        sizes[index] = is_empty<T>::value ? 0 : sizeof(T);
+        if (terms[index].is_ref && sizes[index]) {
+            if (!is_const<T>::value || 
+                !std::is_trivially_copyable<T>::value || alignof(T) > 16) 
+            {
+                result = false;
+            }
+            entity_size += sizeof(T);
+        }
+        return shared_sizes(terms, sizes, entity_size, index + 1, comps...) && 
+            result;
+    }
+
+    template <typename... Targs, 
+        if_t<sizeof...(Targs) == sizeof...(Components)> = 0>
+    static void invoke_callback(ecs_iter_t *iter, const Func& func, 
+        size_t count, size_t, Terms&, Targs... comps) 
+    {
+        (void)iter;
+        ECS_TABLE_LOCK(iter->world, iter->table);
+
+        func(count, ( static_cast< 
+            remove_reference_t< 
+                remove_pointer_t< 
+                    actual_type_t<Components> > >* >
+                        (comps.ptr))...);
+
+        ECS_TABLE_UNLOCK(iter->world, iter->table);
+    }
+
+    template <typename... Targs, 
+        if_t<sizeof...(Targs) != sizeof...(Components)> = 0>
+    static void invoke_callback(ecs_iter_t *iter, const Func& func, 
+        size_t count, size_t index, Terms& columns, Targs... comps) 
+    {
+        invoke_callback(iter, func, count, index + 1, columns, comps..., 
+            columns[index]);
+    }
+
+    Func m_func;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Utility to invoke callback on entity if it has components in signature
 ////////////////////////////////////////////////////////////////////////////////
@@ -18306,6 +19303,28 @@ struct iterable {
         iterate<_::iter_invoker>(FLECS_FWD(func), this->next_action());
     }
 
+    /** Batch iterator.
+     * The "batch" iterator accepts a function that is invoked for each matching
+     * table with the number of entities and a pointer to the array of each
+     * component. The following function signature is valid:
+     *  - func(size_t count, Components* ...)
+     * 
+     * Each pointer points to an array with count elements. Because the 
+     * callback only receives plain arrays, loops in the callback are easy to
+     * vectorize. The flecs::load_lanes and flecs::store_lanes helpers load a
+     * member of consecutive elements into an array of lanes, and back.
+     *
+     * Batch iterators are instanced. Shared components that are const and
+     * trivially copyable are copied to an array of up to 
+     * FLECS_BATCH_SHARED_SIZE bytes, so the callback is invoked for ranges of
+     * entities. Results with other shared components invoke the callback for
+     * each entity.
+     */
+    template <typename Func>
+    void batch(Func&& func) const { 
+        iterate<_::batch_invoker>(FLECS_FWD(func), this->next_action());
+    }
+
     /** Create iterator.
      * Create an iterator object that can be modified before iterating.
      */
@@ -20970,6 +21989,10 @@ inline query_base::operator query<>() const {
 #pragma once
 
 namespace flecs {
+
+template<typename Base, typename ... Components>
+struct filter_builder_i;
+
 namespace _ {
 
 // Macros for template types so we don't go cross-eyed
@@ -21011,6 +22034,17 @@ public:
         return build<Invoker>(FLECS_FWD(func));
     }
 
+    /* Batch is similar to iter, but passes the number of entities and plain
+     * component arrays to the function */
+    template <typename Func>
+    T batch(Func&& func) {
+        using Invoker = typename _::batch_invoker<
+            typename std::decay<Func>::type, Components...>;
+        m_instanced = true;
+        enable_instanced(this);
+        return build<Invoker>(FLECS_FWD(func));
+    }
+
 protected:
     flecs::world_t* world_v() override { return m_world; }
     TDesc m_desc;
@@ -21018,6 +22052,13 @@ protected:
     bool m_instanced;
 
 private:
+    // Enable instancing for nodes that have a filter
+    static void enable_instanced(filter_builder_i<Base, Components...> *b) {
+        b->instanced();
+    }
+
+    static void enable_instanced(...) { }
+
     template <typename Invoker, typename Func>
     T build(Func&& func) {
         auto ctx = FLECS_NEW(Invoker)(FLECS_FWD(func));
@@ -21412,6 +22453,28 @@ public:
         return *this;
     }
 
+    /** Distribute entities of a multi threaded system in chunks.
+     * Threads claim chunks of entities until all entities have been iterated,
+     * instead of each thread iterating an equal part of each table.
+     *
+     * @param size The number of entities in a chunk.
+     */
+    Base& chunk_size(int32_t size) {
+        m_desc->chunk_size = size;
+        return *this;
+    }
+
+    /** Distribute the groups of a multi threaded system across threads.
+     * Each group is iterated by a single thread. Requires a query that uses
+     * group_by.
+     *
+     * @param value If true, groups are distributed across threads.
+     */
+    Base& partition_groups(bool value = true) {
+        m_desc->partition_groups = value;
+        return *this;
+    }
+
     /** Specify whether system should be ran in staged context.
      *
      * @param value If false system will always run staged.
@@ -21763,6 +22826,10 @@ inline void world::set_threads(int32_t threads) const {
     ecs_set_threads(m_world, threads);
 }
 
+inline void world::set_concurrent_systems(bool enable) const {
+    ecs_set_concurrent_systems(m_world, enable);
+}
+
 inline int32_t world::get_threads() const {
     return ecs_get_threads(m_world);
 }
@@ -169,6 +169,14 @@ typedef struct ecs_mixins_t ecs_mixins_t;
 /* Maximum number of terms cached in static arrays */
 #define ECS_TERM_CACHE_SIZE (4)
 
+/* Minimum alignment of component arrays in tables. Arrays are aligned to this
+ * value when the OS allocator returns memory that is aligned to at least this
+ * value, which allows for aligned SIMD loads on owned terms. This is 16 and not
+ * a cache line (64), as the OS API has no aligned allocation function and
+ * malloc only guarantees 16 byte alignment. Array capacity is not padded to a
+ * multiple of the SIMD width, so kernels must handle a remainder. */
+#define ECS_COLUMN_ALIGNMENT (16)
+
 /* Maximum number of terms in desc (larger, as these are temp objects) */
 #define ECS_TERM_DESC_CACHE_SIZE (16)
 
@@ -402,6 +410,7 @@ struct ecs_filter_t {
     bool filter;               /* When true, data fields won't be populated */
     bool instanced;            /* See ecs_filter_desc_t */
     bool match_empty_tables;   /* See ecs_filter_desc_t */
+    bool cached;               /* See ecs_filter_desc_t */
     
     char *name;                /* Name of filter (optional) */
     char *expr;                /* Expression of filter (if provided) */
@@ -594,6 +603,29 @@ typedef struct ecs_filter_desc_t {
     /* Match empty tables. By default empty tables are not returned. */ 
     bool match_empty_tables;
 
+    /* When true, the tables matched by the filter are stored in a cache of the
+     * world, so that iterating a filter with the same terms again only has to
+     * visit matching tables. Cache entries are shared between filters with the
+     * same terms, are invalidated when tables are created or deleted, and the
+     * least recently used entry is evicted when the cache is full. Entries of
+     * filters that match components of supersets (the default for This) are
+     * also invalidated when an entity used as a pair object changes tables.
+     * The cache is not used for filters with terms that match entities other
+     * than This or that match subsets, in which case a warning is logged.
+     * While the world is readonly with more than one stage, the cache is not
+     * modified. A filter that has no valid entry in that case, for example
+     * because its entry was evicted or because another filter has the same
+     * signature hash, is iterated without the cache.
+     * 
+     * When used with ecs_rule_init, the rule stores its results (including the
+     * values of its variables) and returns them from the cache until one of
+     * the tables that can contribute to the results is created, deleted or
+     * has entities added or removed. A stale cache is refilled by evaluating
+     * the whole program again. While the world is readonly with more than one
+     * stage, a stale cache is not refilled and the program is evaluated 
+     * without the cache. */
+    bool cached;
+
     /* Filter expression. Should not be set at the same time as terms array */
     const char *expr;
 
@@ -615,7 +647,10 @@ typedef struct ecs_query_desc_t {
 
     /* Callback used for ordering query results. If order_by_id is 0, the 
      * pointer provided to the callback will be NULL. If the callback is not
-     * set, results will not be ordered. */
+     * set, results will not be ordered. When the callback is obtained with
+     * ecs_meta_order_by for order_by_component, large tables are sorted with a
+     * (faster) radix sort. That sort is not stable: the order of entities that
+     * compare equal is undefined. */
     ecs_order_by_action_t order_by;
 
     /* Id to be used by group_by. This id is passed to the group_by function and
@@ -869,8 +904,20 @@ typedef struct ecs_world_info_t {
     int32_t merge_count_total;        /* Total number of merges */
     int32_t pipeline_build_count_total; /* Total number of pipeline builds */
     int32_t systems_ran_frame;  /* Total number of systems ran in last frame */
+
+    int32_t stack_page_count;         /* Pages allocated by stage allocators */
+    int32_t stack_alloc_count_total;  /* Total number of stage allocations */
+    int32_t pool_block_count;         /* Blocks allocated by storage pools */
+    int32_t pool_alloc_count_total;   /* Total number of pool allocations */
 } ecs_world_info_t;
 
+/** Type that contains information about a query group. */
+typedef struct ecs_query_group_info_t {
+    uint64_t id;                      /* Group id */
+    int32_t table_count;              /* Number of non-empty tables in group */
+    int32_t entity_count;             /* Number of entities in group */
+} ecs_query_group_info_t;
+
 /** @} */
 
 /* Only include deprecated definitions if deprecated addon is required */
@@ -1320,6 +1367,51 @@ void ecs_dim(
     ecs_world_t *world,
     int32_t entity_count);
 
+/** Dimension a table for a specified number of entities.
+ * This operation will preallocate the component arrays of a table for the
+ * specified number of entities. Adding entities to the table will not
+ * reallocate its storage until the table grows beyond the specified number,
+ * which means that pointers to components in the table remain valid.
+ * Specifying a number lower than the current size of the table will have no
+ * effect.
+ *
+ * The component arrays remain contiguous. Once the table grows beyond the
+ * specified number of entities the arrays are reallocated as usual, which
+ * moves existing components and invalidates pointers to them.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param entity_count The number of entities to preallocate.
+ */
+FLECS_API
+void ecs_dim_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t entity_count);
+
+/** Store a table in fixed size chunks.
+ * By default the component arrays of a table are contiguous, and are
+ * reallocated when the table grows. This operation lets a table store its
+ * entities in chunks, where each component array of a chunk is at most
+ * chunk_size bytes. When a chunk is full, entities are added to the next chunk
+ * with space, or to a new chunk. Existing entities are never moved when the
+ * table grows, so pointers to their components (and refs) remain valid.
+ *
+ * A chunk is a table with the same type as the chunked table. Queries and
+ * iterators return each chunk as a separate table, so that a single result
+ * never spans multiple chunks. Storage that is already allocated for a chunk
+ * is kept, the chunk size is applied when an entity is added to an empty chunk.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param chunk_size The maximum size in bytes of a component array in a chunk.
+ */
+FLECS_API
+void ecs_table_set_chunk_size(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t chunk_size);
+
 /** Set a range for issueing new entity ids.
  * This function constrains the entity identifiers returned by ecs_new to the 
  * specified range. This operation can be used to ensure that multiple processes
@@ -1711,6 +1803,95 @@ void ecs_remove_id(
     ecs_entity_t entity,
     ecs_id_t id);
 
+/** Add an id to multiple entities.
+ * This operation has the same effect as calling ecs_add_id for each entity in
+ * the array, but moves entities that are stored next to each other in the same
+ * table with a single operation. OnAdd events are emitted once for each moved
+ * range of entities, instead of once per entity.
+ *
+ * The operation is most efficient when the array contains entities in the
+ * order in which they are stored, as is the case for entities created by
+ * ecs_bulk_new_w_id or entities returned by an iterator.
+ *
+ * @param world The world.
+ * @param entities The entities.
+ * @param count The number of entities.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id);
+
+/** Remove an id from multiple entities.
+ * Same as ecs_bulk_add_id, but removes the id. OnRemove events are emitted once
+ * for each moved range of entities.
+ *
+ * @param world The world.
+ * @param entities The entities.
+ * @param count The number of entities.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id);
+
+/** Set a component for multiple entities.
+ * Same as ecs_bulk_add_id, but also copies a value into the component for each
+ * entity. The values array must contain a value for each entity in the
+ * entities array. OnSet events are emitted once for each range of entities.
+ *
+ * @param world The world.
+ * @param entities The entities.
+ * @param count The number of entities.
+ * @param id The component to set.
+ * @param size The size of the component.
+ * @param values Array with count component values.
+ */
+FLECS_API
+void ecs_bulk_set_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    size_t size,
+    const void *values);
+
+/** Add an id to all entities that match a filter.
+ * The entities are moved per matched table, which makes this operation a lot
+ * faster than iterating the filter and adding the id to each entity. Entities
+ * that are matched by the filter are collected before any entities are moved,
+ * which means that entities that start matching the filter as a result of the
+ * operation are not affected.
+ *
+ * @param world The world.
+ * @param filter The filter.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
+/** Remove an id from all entities that match a filter.
+ * Same as ecs_bulk_add_id_w_filter, but removes the id.
+ *
+ * @param world The world.
+ * @param filter The filter.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id);
+
 /** @} */
 
 
@@ -3190,6 +3371,43 @@ bool ecs_query_changed(
     ecs_query_t *query,
     const ecs_iter_t *it);
 
+/** Find next range of changed rows in iterator result.
+ * This operation finds the first range of rows at or after the provided row
+ * that changed since the last time the query iterated the table. A row is 
+ * changed if any of the components for the terms monitored by change detection
+ * (see ecs_query_changed) were modified for that row.
+ * 
+ * Changes are tracked per row for components that are modified with 
+ * ecs_modified, ecs_set or by writing to the component in a query/system. When
+ * entities were added to or removed from the table, or when a component is
+ * not owned by the table, all rows are reported as changed. Row tracking for
+ * a component starts the first time this operation is called for the table,
+ * so the first call may report all rows as changed.
+ * 
+ * Rows are not tracked while the world is progressed with multiple threads, as
+ * worker threads may write the same table. Changes made by multi threaded 
+ * systems cause all rows of the table to be reported as changed.
+ * 
+ * The row is relative to the iterator result (0 is the first entity in it), 
+ * and is set to the first changed row when a range is found:
+ * 
+ *   int32_t row = 0, count;
+ *   while ((count = ecs_query_changed_range(&it, &row))) {
+ *     for (int32_t i = row; i < row + count; i ++) { ... }
+ *     row += count;
+ *   }
+ * 
+ * The same preconditions as for ecs_query_changed apply.
+ * 
+ * @param it The iterator result.
+ * @param row The row to start searching from, set to the first changed row.
+ * @return The number of changed rows in the range, or 0 if none were found.
+ */
+FLECS_API
+int32_t ecs_query_changed_range(
+    const ecs_iter_t *it,
+    int32_t *row);
+
 /** Skip a table while iterating.
  * This operation lets the query iterator know that a table was skipped while
  * iterating. A skipped table will not reset its changed state, and the query
@@ -3216,6 +3434,74 @@ FLECS_API
 bool ecs_query_orphaned(
     ecs_query_t *query);
 
+/** Iterate a single group of a query.
+ * This operation limits the iterator to the tables of the group with the 
+ * specified id, as computed by the group_by callback of the query. Only the
+ * tables of the group are visited, which lets an application skip entire
+ * groups (for example spatial cells that are not visible) without testing
+ * individual tables. If the group does not exist, the iterator won't return
+ * any results.
+ * 
+ * The operation must be called after ecs_query_iter, before ecs_query_next is
+ * called for the first time. The query must have been created with group_by.
+ * 
+ * @param it The query iterator.
+ * @param group_id The group to iterate.
+ */
+FLECS_API
+void ecs_query_set_group(
+    ecs_iter_t *it,
+    uint64_t group_id);
+
+/** Create query iterator that iterates a subset of the query groups.
+ * The groups of the query are distributed over the workers, where worker 
+ * 'index' iterates the groups at positions index, index + count, ... in group
+ * order. Each group is iterated by exactly one worker, which guarantees that
+ * a worker only accesses entities of its own groups.
+ * 
+ * @param world The world or stage, when iterating in readonly mode.
+ * @param query The query to iterate.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ * @return The query iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_query_group_worker_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query,
+    int32_t index,
+    int32_t count);
+
+/** Get information about a query group.
+ * 
+ * @param query The query.
+ * @param group_id The group id.
+ * @param info Out parameter for the group information.
+ * @return True if the group exists, false if it has no matched tables.
+ */
+FLECS_API
+bool ecs_query_get_group_info(
+    const ecs_query_t *query,
+    uint64_t group_id,
+    ecs_query_group_info_t *info);
+
+/** Get information about the groups of a query.
+ * This operation populates the provided array with information for the 
+ * (non-empty) groups of the query, in iteration order. If the array is smaller
+ * than the number of groups, only the first 'count' groups are returned. To 
+ * get the number of groups, use NULL for the array and 0 for the count.
+ * 
+ * @param query The query.
+ * @param groups Array that receives the group information (optional).
+ * @param count The number of elements in the array.
+ * @return The number of groups of the query.
+ */
+FLECS_API
+int32_t ecs_query_groups(
+    const ecs_query_t *query,
+    ecs_query_group_info_t *groups,
+    int32_t count);
+
 /** @} */
 
 
@@ -3552,6 +3838,50 @@ FLECS_API
 bool ecs_worker_next(
     ecs_iter_t *it);
 
+/** Create a chunk iterator.
+ * Chunk iterators divide the matched entities dynamically across N resources
+ * (usually threads). Each resource claims chunks of 'size' entities by 
+ * atomically incrementing a shared cursor, so that a resource that finishes
+ * early picks up more work. Tables with no more than 'size' entities are never
+ * split up across resources.
+ * 
+ * Each resource must create its own chunk iterator from an iterator that
+ * returns the same results in the same order (for example, an iterator for the
+ * same query). All resources must share the same cursor, which must be set to 
+ * 0 before any of the resources starts iterating. Chunks are claimed with the
+ * atomic increment operation of the OS API. The cursor must only be reset after
+ * all resources are done iterating.
+ *
+ * An iterator that is not iterated until the end must be cleaned up with 
+ * ecs_iter_fini.
+ * 
+ * The iterator must be iterated with ecs_chunk_next.
+ * 
+ * A chunk iterator acts as a passthrough for data exposed by the parent
+ * iterator, so that any data provided by the parent will also be provided by
+ * the chunk iterator.
+ * 
+ * @param it The source iterator.
+ * @param cursor The cursor shared between resources.
+ * @param size The number of entities in a chunk.
+ * @return A chunk iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t *cursor,
+    int32_t size);
+
+/** Progress a chunk iterator.
+ * Progresses an iterator created by ecs_chunk_iter.
+ * 
+ * @param it The iterator.
+ * @return true if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_chunk_next(
+    ecs_iter_t *it);
+
 /** Obtain data for a query term.
  * This operation retrieves a pointer to an array of data that belongs to the
  * term in the query. The index refers to the location of the term in the query,
@@ -3634,6 +3964,23 @@ bool ecs_term_is_owned(
     const ecs_iter_t *it,
     int32_t index);
 
+/** Test whether the term data is aligned.
+ * This operation returns whether the array for the term is owned and starts at
+ * an address that is a multiple of ECS_COLUMN_ALIGNMENT. Iterators that return
+ * all entities of a table starting from the first row always return aligned
+ * arrays, provided that the OS allocator returns memory with at least the same
+ * alignment. Iterators that split up tables, like worker iterators or iterators
+ * that are not instanced and have shared terms, may return unaligned arrays.
+ *
+ * @param it The iterator.
+ * @param index The index of the term in the query.
+ * @return Whether the term data is aligned.
+ */
+FLECS_API
+bool ecs_term_is_aligned(
+    const ecs_iter_t *it,
+    int32_t index);
+
 /** Convert iterator to string.
  * Prints the contents of an iterator to a string. Useful for debugging and/or
  * testing the output of an iterator.
@@ -3753,6 +4100,11 @@ FLECS_FLOAT ecs_frame_begin(
  * This operation must be called at the end of the frame, and always after
  * ecs_frame_begin.
  *
+ * Temporary memory that stages allocated during the frame is released, which
+ * includes the term arrays of iterators with more than ECS_TERM_CACHE_SIZE
+ * terms. Iterators created during the frame must not be used after the frame
+ * has ended.
+ *
  * @param world The world.
  */
 FLECS_API
@@ -3864,6 +4216,32 @@ void ecs_set_automerge(
     ecs_world_t *world,
     bool automerge);
 
+/** Enable/disable merging stages in entity order.
+ * By default the command queues of stages are merged one at a time, in stage
+ * order. When merging in entity order, the queues are sorted by entity (by the
+ * worker threads, before they synchronize) and then merged into a single queue.
+ * Commands for the same entity that were enqueued by different stages are then
+ * applied with a single table move, and observers are notified in entity order
+ * instead of stage order. Commands for the same entity are applied in stage
+ * order, and in the order in which they were enqueued by a stage.
+ *
+ * Only queues with commands that modify a single entity (add, remove, set,
+ * modified, enable, disable and new) can be reordered. If a queue contains
+ * other commands (like delete, clear, bulk new or adding an IsA pair), the
+ * stages are merged in stage order.
+ *
+ * An application should only enable this when the order in which commands for
+ * different entities are applied doesn't matter, for example when observers
+ * don't depend on the state of other entities.
+ *
+ * @param world The world.
+ * @param merge_by_entity Whether to enable or disable merging in entity order.
+ */
+FLECS_API
+void ecs_set_merge_by_entity(
+    ecs_world_t *world,
+    bool merge_by_entity);
+
 /** Configure world to have N stages.
  * This initializes N stages, which allows applications to defer operations to
  * multiple isolated defer queues. This is typically used for applications with
@@ -4103,6 +4481,28 @@ int32_t ecs_search_relation(
     ecs_id_t *id_out,
     struct ecs_table_record_t **tr_out);
 
+/** Enable/disable closure index for relation.
+ * A closure index stores for each table the entities that can be reached by
+ * traversing the relation, and for each entity the tables that can reach it.
+ * When a relation is indexed, ecs_search_relation and the superset/subset 
+ * operations of rules no longer walk the relation table by table, which 
+ * improves performance for deep hierarchies.
+ * 
+ * The index is populated on demand, and is invalidated when entities are added
+ * to or removed from tables with the relation. Indexing a relation is therefore
+ * most useful when the relation pairs of entities change infrequently.
+ * 
+ * @param world The world.
+ * @param relation The relation to index.
+ * @param enable True to enable the index, false to disable.
+ * @return The previous value.
+ */
+FLECS_API
+bool ecs_enable_closure_index(
+    ecs_world_t *world,
+    ecs_entity_t relation,
+    bool enable);
+
 /** @} */
 
 /**
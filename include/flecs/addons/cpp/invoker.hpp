@@ -347,6 +347,179 @@ private:
 };
 
 
+////////////////////////////////////////////////////////////////////////////////
+//// Utility class to invoke a system batch action
+////////////////////////////////////////////////////////////////////////////////
+
+// Batch invokers pass the number of entities and a plain pointer to the array
+// of each term to the callback. Because the callback body only deals with
+// pointers and a count, compilers are able to vectorize loops over the arrays.
+template <typename Func, typename ... Components>
+struct batch_invoker : invoker {
+private:
+    using Terms = typename term_ptrs<Components ...>::array;
+    using Sizes = flecs::array<size_t, sizeof...(Components)>;
+
+    static_assert(arity<Func>::value == (sizeof...(Components) + 1),
+        "batch() must have a count argument and one argument per component");
+
+public:
+    template < if_not_t< is_same< void(Func), void(Func)& >::value > = 0>
+    explicit batch_invoker(Func&& func) noexcept 
+        : m_func(FLECS_MOV(func)) { }
+
+    explicit batch_invoker(const Func& func) noexcept 
+        : m_func(func) { }
+
+    // Invoke object directly. This operation is useful when the calling
+    // function has just constructed the invoker, such as what happens when
+    // iterating a query.
+    void invoke(ecs_iter_t *iter) const {
+        term_ptrs<Components...> terms;
+        if (terms.populate(iter)) {
+            invoke_shared(iter, terms.m_terms);
+        } else {
+            invoke_callback(iter, m_func, static_cast<size_t>(iter->count), 
+                0, terms.m_terms);
+        }
+    }
+
+    // Static function that can be used as callback for systems/triggers
+    static void run(ecs_iter_t *iter) {
+        auto self = static_cast<const batch_invoker*>(iter->binding_ctx);
+        ecs_assert(self != nullptr, ECS_INTERNAL_ERROR, NULL);
+        self->invoke(iter);
+    }
+
+    // Batch invokers are instanced, so that tables with shared components are
+    // not iterated one entity at a time. The invoker passes shared components
+    // as arrays (see invoke_shared).
+    static bool instanced() {
+        return true;
+    }
+
+private:
+    // Shared components point to a single value instead of an array. Shared 
+    // components that are const and trivially copyable are copied to a buffer
+    // with one value per entity, and the callback is invoked for as many 
+    // entities as fit in the buffer. If a shared component can't be copied the
+    // callback is invoked for each entity.
+    void invoke_shared(ecs_iter_t *iter, Terms& terms) const {
+        alignas(16) unsigned char buffer[FLECS_BATCH_SHARED_SIZE];
+        size_t i, count = static_cast<size_t>(iter->count);
+        size_t entity_size = 0, chunk = 1;
+        Sizes sizes;
+        Terms chunk_terms = terms;
+
+        if (shared_sizes(terms, sizes, entity_size, 0, static_cast<
+            remove_reference_t<
+                remove_pointer_t<
+                    actual_type_t<Components> > >*>(nullptr)...)) 
+        {
+            if (!entity_size) {
+                /* Only shared tags, nothing to copy */
+                chunk = count;
+            } else {
+                /* Round down to a multiple of 16, so arrays remain aligned */
+                chunk = (FLECS_BATCH_SHARED_SIZE / entity_size) & ~size_t(15);
+            }
+        }
+
+        if (chunk > 1) {
+            size_t elem_count = count < chunk ? count : chunk;
+            unsigned char *ptr = buffer;
+            for (i = 0; i < sizeof...(Components); i ++) {
+                if (!terms[i].is_ref || !sizes[i]) {
+                    continue;
+                }
+
+                /* Copy value, then keep doubling the copied range */
+                size_t copied = 1;
+                ecs_os_memcpy(ptr, terms[i].ptr, 
+                    static_cast<ecs_size_t>(sizes[i]));
+                while (copied < elem_count) {
+                    size_t n = elem_count - copied;
+                    n = n < copied ? n : copied;
+                    ecs_os_memcpy(&ptr[copied * sizes[i]], ptr,
+                        static_cast<ecs_size_t>(n * sizes[i]));
+                    copied += n;
+                }
+
+                chunk_terms[i].ptr = ptr;
+                ptr += chunk * sizes[i];
+            }
+        } else {
+            chunk = 1;
+        }
+
+        for (size_t offset = 0; offset < count; offset += chunk) {
+            for (i = 0; i < sizeof...(Components); i ++) {
+                if (!terms[i].is_ref && terms[i].ptr) {
+                    chunk_terms[i].ptr = ECS_OFFSET(
+                        terms[i].ptr, sizes[i] * offset);
+                }
+            }
+
+            size_t remaining = count - offset;
+            invoke_callback(iter, m_func, remaining < chunk ? remaining : chunk,
+                0, chunk_terms);
+        }
+    }
+
+    // Get component sizes and the number of bytes to copy per entity. Returns
+    // false if a shared component can't be copied to the buffer.
+    static bool shared_sizes(Terms&, Sizes&, size_t&, size_t) {
+        return true;
+    }
+
+    template <typename T, typename... Targs>
+    static bool shared_sizes(Terms& terms, Sizes& sizes, size_t& entity_size,
+        size_t index, T*, Targs... comps) 
+    {
+        bool result = true;
+        sizes[index] = is_empty<T>::value ? 0 : sizeof(T);
+        if (terms[index].is_ref && sizes[index]) {
+            if (!is_const<T>::value || 
+                !std::is_trivially_copyable<T>::value || alignof(T) > 16) 
+            {
+                result = false;
+            }
+            entity_size += sizeof(T);
+        }
+        return shared_sizes(terms, sizes, entity_size, index + 1, comps...) && 
+            result;
+    }
+
+    template <typename... Targs, 
+        if_t<sizeof...(Targs) == sizeof...(Components)> = 0>
+    static void invoke_callback(ecs_iter_t *iter, const Func& func, 
+        size_t count, size_t, Terms&, Targs... comps) 
+    {
+        (void)iter;
+        ECS_TABLE_LOCK(iter->world, iter->table);
+
+        func(count, ( static_cast< 
+            remove_reference_t< 
+                remove_pointer_t< 
+                    actual_type_t<Components> > >* >
+                        (comps.ptr))...);
+
+        ECS_TABLE_UNLOCK(iter->world, iter->table);
+    }
+
+    template <typename... Targs, 
+        if_t<sizeof...(Targs) != sizeof...(Components)> = 0>
+    static void invoke_callback(ecs_iter_t *iter, const Func& func, 
+        size_t count, size_t index, Terms& columns, Targs... comps) 
+    {
+        invoke_callback(iter, func, count, index + 1, columns, comps..., 
+            columns[index]);
+    }
+
+    Func m_func;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Utility to invoke callback on entity if it has components in signature
 ////////////////////////////////////////////////////////////////////////////////
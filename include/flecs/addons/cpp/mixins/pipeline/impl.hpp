@@ -80,6 +80,10 @@ inline void world::set_threads(int32_t threads) const {
     ecs_set_threads(m_world, threads);
 }
 
+inline void world::set_concurrent_systems(bool enable) const {
+    ecs_set_concurrent_systems(m_world, enable);
+}
+
 inline int32_t world::get_threads() const {
     return ecs_get_threads(m_world);
 }
@@ -81,6 +81,11 @@ void deactivate_systems() const;
  */
 void set_threads(int32_t threads) const;
 
+/** Run single threaded systems concurrently.
+ * @see ecs_set_concurrent_systems
+ */
+void set_concurrent_systems(bool enable = true) const;
+
 /** Set number of threads.
  * @see ecs_get_threads
  */
@@ -44,6 +44,28 @@ public:
         return *this;
     }
 
+    /** Distribute entities of a multi threaded system in chunks.
+     * Threads claim chunks of entities until all entities have been iterated,
+     * instead of each thread iterating an equal part of each table.
+     *
+     * @param size The number of entities in a chunk.
+     */
+    Base& chunk_size(int32_t size) {
+        m_desc->chunk_size = size;
+        return *this;
+    }
+
+    /** Distribute the groups of a multi threaded system across threads.
+     * Each group is iterated by a single thread. Requires a query that uses
+     * group_by.
+     *
+     * @param value If true, groups are distributed across threads.
+     */
+    Base& partition_groups(bool value = true) {
+        m_desc->partition_groups = value;
+        return *this;
+    }
+
     /** Specify whether system should be ran in staged context.
      *
      * @param value If false system will always run staged.
@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+//// Utilities for batch callbacks
+////////////////////////////////////////////////////////////////////////////////
+
+// Width in bytes of the vector registers that lanes are sized for. The default
+// matches 256 bit registers (AVX/AVX2). Define before including flecs to
+// target other instruction sets.
+#ifndef FLECS_BATCH_WIDTH
+#define FLECS_BATCH_WIDTH (32)
+#endif
+
+// Size of the buffer that batch callbacks use to pass shared components as an
+// array. The buffer is allocated on the stack of the invoker.
+#ifndef FLECS_BATCH_SHARED_SIZE
+#define FLECS_BATCH_SHARED_SIZE (4096)
+#endif
+
+namespace flecs
+{
+
+/** Number of values of type T that fit in a vector register.
+ * Use this as the size of lane arrays in a batch callback, for example:
+ *   float x[flecs::lanes<float>::value];
+ */
+template <typename T>
+struct lanes : std::integral_constant<size_t,
+    (sizeof(T) < FLECS_BATCH_WIDTH) ? (FLECS_BATCH_WIDTH / sizeof(T)) : 1> { };
+
+/** Load member of consecutive components into lanes.
+ * Components are stored as arrays of structs. A loop that accesses a single
+ * member of each element reads memory with a stride, which compilers often
+ * don't vectorize. Loading the member of N elements into an array of N lanes
+ * first lets the loop that processes the lanes use vector instructions:
+ *
+ *   q.batch([](size_t count, Position *p, const Velocity *v) {
+ *       const size_t N = flecs::lanes<float>::value;
+ *       size_t i = 0;
+ *       for (; i + N <= count; i += N) {
+ *           float x[N], vx[N];
+ *           flecs::load_lanes(x, &p[i], &Position::x);
+ *           flecs::load_lanes(vx, &v[i], &Velocity::x);
+ *           for (size_t l = 0; l < N; l ++) {
+ *               x[l] += vx[l];
+ *           }
+ *           flecs::store_lanes(&p[i], &Position::x, x);
+ *       }
+ *       for (; i < count; i ++) {
+ *           p[i].x += v[i].x;
+ *       }
+ *   });
+ *
+ * @param lanes The array to load the values into.
+ * @param elems Pointer to the first element. Must have at least N elements.
+ * @param member The member to load.
+ */
+template <typename T, typename M, size_t N>
+inline void load_lanes(M (&lanes)[N], const T *elems, M T::*member) {
+    for (size_t i = 0; i < N; i ++) {
+        lanes[i] = elems[i].*member;
+    }
+}
+
+/** Store lanes into member of consecutive components.
+ * Counterpart of load_lanes.
+ *
+ * @param elems Pointer to the first element. Must have at least N elements.
+ * @param member The member to store.
+ * @param lanes The array with the values to store.
+ */
+template <typename T, typename M, size_t N>
+inline void store_lanes(T *elems, M T::*member, const M (&lanes)[N]) {
+    for (size_t i = 0; i < N; i ++) {
+        elems[i].*member = lanes[i];
+    }
+}
+
+/** Load member of consecutive components into a partial set of lanes.
+ * Same as load_lanes, but loads count values. Use this for the remaining
+ * elements of an array that are not a multiple of the number of lanes.
+ */
+template <typename T, typename M, size_t N>
+inline void load_lanes(M (&lanes)[N], const T *elems, M T::*member,
+    size_t count)
+{
+    ecs_assert(count <= N, ECS_INVALID_PARAMETER, NULL);
+    for (size_t i = 0; i < count; i ++) {
+        lanes[i] = elems[i].*member;
+    }
+}
+
+/** Store a partial set of lanes into member of consecutive components.
+ * Counterpart of load_lanes with a count.
+ */
+template <typename T, typename M, size_t N>
+inline void store_lanes(T *elems, M T::*member, const M (&lanes)[N],
+    size_t count)
+{
+    ecs_assert(count <= N, ECS_INVALID_PARAMETER, NULL);
+    for (size_t i = 0; i < count; i ++) {
+        elems[i].*member = lanes[i];
+    }
+}
+
+}
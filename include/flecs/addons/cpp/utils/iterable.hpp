@@ -43,6 +43,28 @@ struct iterable {
         iterate<_::iter_invoker>(FLECS_FWD(func), this->next_action());
     }
 
+    /** Batch iterator.
+     * The "batch" iterator accepts a function that is invoked for each matching
+     * table with the number of entities and a pointer to the array of each
+     * component. The following function signature is valid:
+     *  - func(size_t count, Components* ...)
+     * 
+     * Each pointer points to an array with count elements. Because the 
+     * callback only receives plain arrays, loops in the callback are easy to
+     * vectorize. The flecs::load_lanes and flecs::store_lanes helpers load a
+     * member of consecutive elements into an array of lanes, and back.
+     *
+     * Batch iterators are instanced. Shared components that are const and
+     * trivially copyable are copied to an array of up to 
+     * FLECS_BATCH_SHARED_SIZE bytes, so the callback is invoked for ranges of
+     * entities. Results with other shared components invoke the callback for
+     * each entity.
+     */
+    template <typename Func>
+    void batch(Func&& func) const { 
+        iterate<_::batch_invoker>(FLECS_FWD(func), this->next_action());
+    }
+
     /** Create iterator.
      * Create an iterator object that can be modified before iterating.
      */
@@ -1,6 +1,10 @@
 #pragma once
 
 namespace flecs {
+
+template<typename Base, typename ... Components>
+struct filter_builder_i;
+
 namespace _ {
 
 // Macros for template types so we don't go cross-eyed
@@ -42,6 +46,17 @@ public:
         return build<Invoker>(FLECS_FWD(func));
     }
 
+    /* Batch is similar to iter, but passes the number of entities and plain
+     * component arrays to the function */
+    template <typename Func>
+    T batch(Func&& func) {
+        using Invoker = typename _::batch_invoker<
+            typename std::decay<Func>::type, Components...>;
+        m_instanced = true;
+        enable_instanced(this);
+        return build<Invoker>(FLECS_FWD(func));
+    }
+
 protected:
     flecs::world_t* world_v() override { return m_world; }
     TDesc m_desc;
@@ -49,6 +64,13 @@ protected:
     bool m_instanced;
 
 private:
+    // Enable instancing for nodes that have a filter
+    static void enable_instanced(filter_builder_i<Base, Components...> *b) {
+        b->instanced();
+    }
+
+    static void enable_instanced(...) { }
+
     template <typename Invoker, typename Func>
     T build(Func&& func) {
         auto ctx = FLECS_NEW(Invoker)(FLECS_FWD(func));
@@ -137,3 +137,4 @@ struct always_false {
 #include "enum.hpp"
 #include "stringstream.hpp"
 #include "function_traits.hpp"
+#include "batch.hpp"
@@ -470,6 +470,30 @@ struct world {
         ecs_enable_range_check(m_world, enabled);
     }
 
+    /** Enable/disable closure index for relation.
+     * See ecs_enable_closure_index.
+     *
+     * @param relation The relation to index.
+     * @param enabled True if the index should be enabled, false if not.
+     * @return The previous value.
+     */
+    bool enable_closure_index(entity_t relation, bool enabled = true) const {
+        return ecs_enable_closure_index(m_world, relation, enabled);
+    }
+
+    /** Enable/disable closure index for relation.
+     * See ecs_enable_closure_index.
+     *
+     * @tparam Relation The relation to index.
+     * @param enabled True if the index should be enabled, false if not.
+     * @return The previous value.
+     */
+    template <typename Relation>
+    bool enable_closure_index(bool enabled = true) const {
+        return ecs_enable_closure_index(m_world, 
+            _::cpp_type<Relation>::id(m_world), enabled);
+    }
+
     /** Set current scope.
      *
      * @param scope The scope to set.
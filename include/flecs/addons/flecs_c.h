@@ -153,6 +153,25 @@
     ecs_remove_id(world, subject, ecs_pair(relation, object))
 
 
+/* -- Bulk add/remove/set -- */
+
+#define ecs_bulk_add(world, entities, count, T)\
+    ecs_bulk_add_id(world, entities, count, ecs_id(T))
+
+#define ecs_bulk_add_pair(world, entities, count, relation, object)\
+    ecs_bulk_add_id(world, entities, count, ecs_pair(relation, object))
+
+#define ecs_bulk_remove(world, entities, count, T)\
+    ecs_bulk_remove_id(world, entities, count, ecs_id(T))
+
+#define ecs_bulk_remove_pair(world, entities, count, relation, object)\
+    ecs_bulk_remove_id(world, entities, count, ecs_pair(relation, object))
+
+#define ecs_bulk_set(world, entities, count, component, values)\
+    ecs_bulk_set_id(world, entities, count, ecs_id(component),\
+        sizeof(component), values)
+
+
 /* -- Bulk remove/delete -- */
 
 #define ecs_delete_children(world, parent)\
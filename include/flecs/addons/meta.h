@@ -508,6 +508,78 @@ ecs_entity_t ecs_meta_get_entity(
     const ecs_meta_cursor_t *cursor);
 
 
+/** Range iterator */
+
+/** Create a range iterator.
+ * A range iterator skips tables, and blocks of rows within tables, for which
+ * none of the values of a member are in the [min, max] range. This lets an
+ * application that tests a range (e.g. health below zero, or a position inside
+ * of a region) avoid visiting tables that can't contain matching entities.
+ * 
+ * Tables are skipped by testing min/max statistics of the member, which are 
+ * stored per table and per block of rows. Statistics are created the first 
+ * time a table is iterated with a range iterator for the member, and are 
+ * updated for blocks in which values changed. Changes are detected in the same
+ * way as ecs_query_changed: values must be written with ecs_set, ecs_modified
+ * or by a query term that is not readonly. When the world is readonly and has
+ * multiple stages, statistics are not updated and out of date tables are not 
+ * skipped.
+ * 
+ * The member must have a primitive type. If member is NULL, the component must
+ * be a primitive type. Results for which the term is not owned, or for which 
+ * the member can't be found, are not skipped.
+ * 
+ * Individual values are not tested: the returned results can still contain
+ * entities for which the member is not in the range. 
+ * 
+ * The iterator must be iterated with ecs_range_next.
+ * 
+ * @param it The source iterator.
+ * @param term The index of the term with the component (starts from 1).
+ * @param member The name of the member (optional).
+ * @param min The lower bound of the range.
+ * @param max The upper bound of the range.
+ * @return A range iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_range_iter(
+    const ecs_iter_t *it,
+    int32_t term,
+    const char *member,
+    double min,
+    double max);
+
+/** Progress a range iterator.
+ * Progresses an iterator created by ecs_range_iter.
+ * 
+ * @param it The iterator.
+ * @return true if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_range_next(
+    ecs_iter_t *it);
+
+
+/** Ordering */
+
+/** Get comparator that orders by the value of a type.
+ * The type must be a primitive type, or a struct of which the first member is
+ * a primitive type. Structs are ordered by the value of that member.
+ * 
+ * When the comparator is used as order_by callback of a query, with the type
+ * as order_by_component, large tables are sorted with a radix sort instead of
+ * a comparison sort. The order of entities with equal values is undefined.
+ * 
+ * @param world The world.
+ * @param type The type to order by.
+ * @return The comparator, or NULL if the type can't be ordered by value.
+ */
+FLECS_API
+ecs_order_by_action_t ecs_meta_order_by(
+    const ecs_world_t *world,
+    ecs_entity_t type);
+
+
 /** API functions for creating meta types */
 
 /** Used with ecs_primitive_init. */
@@ -169,6 +169,26 @@ void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads);
 
+/** Run single threaded systems concurrently.
+ * When enabled, systems that are not multi threaded and that run between the
+ * same two merges are distributed across worker threads. Systems whose queries
+ * access the same component, where at least one of the systems writes the
+ * component, are always ran on the same thread in pipeline order.
+ *
+ * Only data accessed through the system query is taken into account. Systems
+ * that access components in other ways (for example with ecs_get on an entity
+ * that is not matched by the query) should be marked as no_staging, or this
+ * feature should not be enabled. Systems that don't use staging are never ran
+ * concurrently.
+ *
+ * @param world The world.
+ * @param enable Whether to run single threaded systems concurrently.
+ */
+FLECS_API
+void ecs_set_concurrent_systems(
+    ecs_world_t *world,
+    bool enable);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Module
 ////////////////////////////////////////////////////////////////////////////////
@@ -209,6 +209,33 @@ ecs_iter_t ecs_rule_iter(
     const ecs_world_t *world,
     const ecs_rule_t *rule);
 
+/** Iterate a rule for a worker.
+ * Worker rule iterators divide the work of evaluating a rule across N 
+ * resources (usually threads). The tables found by the first select operation
+ * of the rule program are distributed round-robin across workers, and each
+ * worker evaluates the remainder of the program for its own tables. Together
+ * the workers return the same results as a regular rule iterator, where each
+ * result is returned by exactly one worker.
+ * 
+ * For cached rules, the cached results are distributed across workers. If the
+ * variable of the first select operation is set with ecs_rule_set_var, only
+ * the first worker returns results.
+ * 
+ * The iterator must be iterated with ecs_rule_next.
+ * 
+ * @param world The world (or stage of the worker).
+ * @param rule The rule.
+ * @param index The index of the current worker.
+ * @param count The total number of workers.
+ * @return An iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count);
+
 /** Progress rule iterator.
  * 
  * @param it The iterator.
@@ -239,6 +266,26 @@ FLECS_API
 char* ecs_rule_str(
     ecs_rule_t *rule);
 
+/** Convert rule plan to a string.
+ * This evaluates the rule and converts the rule program to a string which for
+ * each operation contains the estimated (E) and actual (A) number of rows. The
+ * estimate is the number of entities matched by the term of the operation when
+ * the rule was created. The actual number is the number of entities that the
+ * operation produced while evaluating the rule.
+ * 
+ * The rule compiler uses the estimates to decide in which order terms are
+ * evaluated. Comparing the estimates with the actual numbers can help with
+ * finding out why a rule is slow.
+ * 
+ * The returned string must be freed with ecs_os_free.
+ * 
+ * @param rule The rule.
+ * @return The string
+ */
+FLECS_API
+char* ecs_rule_plan_str(
+    ecs_rule_t *rule);
+
 
 #ifdef __cplusplus
 }
@@ -69,6 +69,14 @@ typedef struct ecs_world_stats_t {
     ecs_counter_t pipeline_build_count_total; /* Number of system pipeline rebuilds (occurs when an inactive system becomes active). */
     ecs_counter_t systems_ran_frame;          /* Number of systems ran in the last frame. */
 
+    /* Memory */
+    ecs_gauge_t stack_page_count;             /* Number of pages allocated by stage allocators. */
+    ecs_counter_t stack_alloc_count_total;    /* Number of allocations served by stage allocators. */
+    ecs_gauge_t pool_block_count;             /* Number of blocks allocated by storage pools. */
+    ecs_counter_t pool_alloc_count_total;     /* Number of allocations served by storage pools. */
+    ecs_gauge_t table_edge_count;             /* Number of edges between tables in the table graph. */
+    ecs_gauge_t table_edge_memory;            /* Memory (in bytes) allocated for table graph edges. */
+
     /** Current position in ringbuffer */
     int32_t t;
 } ecs_world_stats_t;
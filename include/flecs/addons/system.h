@@ -132,6 +132,19 @@ typedef struct ecs_system_desc_t {
     /* If true, system will be ran on multiple threads */
     bool multi_threaded;
 
+    /* If set to a value larger than 0, a multi threaded system distributes its
+     * entities dynamically across threads in chunks of chunk_size entities,
+     * instead of dividing each table equally between threads. Chunks are only
+     * used when the system is ran by a pipeline, which resets the claimed
+     * chunks at the sync point after the system. When ran with ecs_run_worker,
+     * each table is divided equally between threads. */
+    int32_t chunk_size;
+
+    /* If true, a multi threaded system with a grouped query (see group_by)
+     * distributes its groups across threads, instead of dividing each table
+     * between threads. Each group is iterated by a single thread. */
+    bool partition_groups;
+
     /* If true, system will have access to actuall world. Cannot be true at the
      * same time as multi_threaded. */
     bool no_staging;
@@ -0,0 +1,196 @@
+/**
+ * @file allocator.h
+ * @brief Pool allocator for datastructures that grow and shrink frequently.
+ *
+ * The block allocator hands out fixed size chunks from blocks that contain
+ * multiple chunks. Freed chunks are added to a free list, and are reused by
+ * the next allocation. Blocks are only released when the allocator is
+ * deinitialized.
+ *
+ * The allocator uses a block allocator for each of a set of size classes. A
+ * request is served from the smallest size class that can hold it, which means
+ * that growing an allocation within its size class doesn't have to move it.
+ * Allocations larger than the largest size class are forwarded to the OS API.
+ *
+ * Allocations must be freed with the size that was used to allocate them. All
+ * functions accept a NULL allocator, in which case memory is allocated with the
+ * OS API, so datastructures can use the same code for both cases.
+ */
+
+#ifndef FLECS_ALLOCATOR_H
+#define FLECS_ALLOCATOR_H
+
+#include "api_defines.h"
+#include "vector.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of size classes. Classes are 16, 32 and then a power of 2 and 1.5
+ * times a power of 2, up to ECS_ALLOCATOR_MAX_SIZE. */
+#define ECS_ALLOCATOR_CLASS_COUNT (24)
+#define ECS_ALLOCATOR_MAX_SIZE (65536)
+
+/* Target size of a block. Blocks for larger chunks contain a single chunk. */
+#define ECS_BLOCK_ALLOCATOR_BLOCK_SIZE (16384)
+
+typedef struct ecs_block_allocator_chunk_t {
+    struct ecs_block_allocator_chunk_t *next;
+} ecs_block_allocator_chunk_t;
+
+typedef struct ecs_block_allocator_block_t {
+    struct ecs_block_allocator_block_t *next;
+} ecs_block_allocator_block_t;
+
+typedef struct ecs_block_allocator_t {
+    ecs_block_allocator_chunk_t *head;   /* Free list */
+    ecs_block_allocator_block_t *blocks; /* Allocated blocks */
+    ecs_size_t chunk_size;
+    int32_t chunks_per_block;
+    int32_t block_count;                 /* Number of allocated blocks */
+    int32_t alloc_count;                 /* Number of chunks in use */
+} ecs_block_allocator_t;
+
+typedef struct ecs_allocator_t {
+    ecs_block_allocator_t classes[ECS_ALLOCATOR_CLASS_COUNT];
+    int32_t block_count;                 /* Number of allocated blocks */
+    int32_t alloc_count;                 /* Number of allocations served */
+} ecs_allocator_t;
+
+FLECS_DBG_API
+void flecs_ballocator_init(
+    ecs_block_allocator_t *ba,
+    ecs_size_t chunk_size);
+
+FLECS_DBG_API
+void flecs_ballocator_fini(
+    ecs_block_allocator_t *ba);
+
+FLECS_DBG_API
+void* flecs_balloc(
+    ecs_block_allocator_t *ba);
+
+FLECS_DBG_API
+void flecs_bfree(
+    ecs_block_allocator_t *ba,
+    void *ptr);
+
+FLECS_DBG_API
+void flecs_allocator_init(
+    ecs_allocator_t *a);
+
+FLECS_DBG_API
+void flecs_allocator_fini(
+    ecs_allocator_t *a);
+
+FLECS_DBG_API
+void* flecs_alloc(
+    ecs_allocator_t *a,
+    ecs_size_t size);
+
+FLECS_DBG_API
+void* flecs_calloc(
+    ecs_allocator_t *a,
+    ecs_size_t size);
+
+FLECS_DBG_API
+void flecs_free(
+    ecs_allocator_t *a,
+    ecs_size_t size,
+    void *ptr);
+
+/* Resize allocation. Returns the same pointer if both sizes are in the same
+ * size class. */
+FLECS_DBG_API
+void* flecs_realloc(
+    ecs_allocator_t *a,
+    ecs_size_t dst_size,
+    ecs_size_t src_size,
+    void *ptr);
+
+/* Vector operations that allocate from an allocator. A vector created with one
+ * of these functions must only be grown and freed with these functions, using
+ * the same allocator. Operations that don't allocate (get, remove, count) use
+ * the regular vector API. */
+FLECS_DBG_API
+ecs_vector_t* _flecs_vector_new(
+    ecs_allocator_t *a,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_new(a, T, elem_count)\
+    _flecs_vector_new(a, ECS_VECTOR_T(T), elem_count)
+
+#define flecs_vector_new_t(a, size, alignment, elem_count)\
+    _flecs_vector_new(a, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+void _flecs_vector_free(
+    ecs_allocator_t *a,
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define flecs_vector_free_t(a, vector, size, alignment)\
+    _flecs_vector_free(a, vector, ECS_VECTOR_U(size, alignment))
+
+FLECS_DBG_API
+void* _flecs_vector_add(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define flecs_vector_add_t(a, vector, size, alignment)\
+    _flecs_vector_add(a, vector, ECS_VECTOR_U(size, alignment))
+
+FLECS_DBG_API
+void* _flecs_vector_addn(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_addn_t(a, vector, size, alignment, elem_count)\
+    _flecs_vector_addn(a, vector, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+int32_t _flecs_vector_set_size(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_set_size_t(a, vector, size, alignment, elem_count)\
+    _flecs_vector_set_size(a, vector, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+int32_t _flecs_vector_set_count(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count);
+
+#define flecs_vector_set_count_t(a, vector, size, alignment, elem_count)\
+    _flecs_vector_set_count(a, vector, ECS_VECTOR_U(size, alignment), elem_count)
+
+FLECS_DBG_API
+ecs_vector_t* _flecs_vector_copy(
+    ecs_allocator_t *a,
+    const ecs_vector_t *src,
+    ecs_size_t elem_size,
+    int16_t offset);
+
+#define flecs_vector_copy_t(a, src, size, alignment)\
+    _flecs_vector_copy(a, src, ECS_VECTOR_U(size, alignment))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
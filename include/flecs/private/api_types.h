@@ -96,6 +96,30 @@ typedef struct ecs_worker_iter_t {
     int32_t count;
 } ecs_worker_iter_t;
 
+/* Chunk-iterator specific data */
+typedef struct ecs_chunk_iter_t {
+    int32_t *cursor;     /* Shared index of next chunk that can be claimed */
+    int32_t size;        /* Number of entities per chunk */
+    int32_t first;       /* Index of first chunk in current table */
+    int32_t count;       /* Number of chunks in current table */
+    void **ptrs;         /* Storage for term data if term_count > cache size */
+} ecs_chunk_iter_t;
+
+/* Range-iterator specific data */
+typedef struct ecs_range_iter_t {
+    const char *member;  /* Member to test, NULL if component is primitive */
+    double min;          /* Lower bound of range */
+    double max;          /* Upper bound of range */
+    int32_t term;        /* Term with component */
+    ecs_id_t id;         /* Component for which member was resolved */
+    int32_t offset;      /* Offset of member, -1 if member can't be tested */
+    int32_t kind;        /* Primitive kind of member */
+    int32_t zone_map;    /* Zone map of current table, -1 if not available */
+    int32_t block;       /* Next block to test in current table */
+    int32_t block_end;   /* End of blocks in current result */
+    void **ptrs;         /* Storage for term data if term_count > cache size */
+} ecs_range_iter_t;
+
 /* Convenience struct to iterate table array for id */
 typedef struct ecs_table_cache_iter_t {
     struct ecs_table_cache_hdr_t *cur, *next;
@@ -130,6 +154,7 @@ typedef enum ecs_iter_kind_t {
     EcsIterEvalIndex,
     EcsIterEvalChain,
     EcsIterEvalCondition,
+    EcsIterEvalCache,
     EcsIterEvalNone
 } ecs_iter_kind_t;
 
@@ -139,16 +164,26 @@ typedef struct ecs_filter_iter_t {
     ecs_iter_kind_t kind; 
     ecs_term_iter_t term_iter;
     int32_t matches_left;
+
+    /* Used when iterating tables from the world filter cache */
+    struct ecs_filter_cache_elem_t *cache_elem;
+    int32_t cache_version;
+    int32_t cache_index;
 } ecs_filter_iter_t;
 
 /** Query-iterator specific data */
 typedef struct ecs_query_iter_t {
     ecs_query_t *query;
     ecs_query_table_node_t *node, *prev;
+    ecs_query_table_node_t *last;  /* Last node to iterate (group iterators) */
     int32_t sparse_smallest;
     int32_t sparse_first;
     int32_t bitset_first;
     int32_t skip_count;
+    uint64_t group_id;             /* Id of current group */
+    int32_t group_index;           /* Number of groups visited */
+    int32_t partition_index;       /* Worker index when partitioning groups */
+    int32_t partition_count;       /* Number of workers */
 } ecs_query_iter_t;
 
 /** Snapshot-iterator specific data */
@@ -173,6 +208,7 @@ typedef struct ecs_rule_iter_t {
     struct ecs_rule_reg_t *registers;    /* Variable storage (tables, entities) */
     ecs_entity_t *variables;             /* Variable storage for iterator (entities only) */
     struct ecs_rule_op_ctx_t *op_ctx;    /* Operation-specific state */
+    int64_t *profile;                    /* Rows per operation (optional) */
     
     int32_t *columns;                    /* Column indices */
     
@@ -181,6 +217,13 @@ typedef struct ecs_rule_iter_t {
     bool redo;
     int32_t op;
     int32_t sp;
+
+    bool cached;                         /* Return results from rule cache */
+    int32_t cache_index;                 /* Index of next cached result */
+    int32_t cache_version;               /* Version of cache when iterating */
+
+    int32_t partition_index;             /* Index of worker (see ecs_rule_worker_iter) */
+    int32_t partition_count;             /* Number of workers */
 } ecs_rule_iter_t;
 
 /* Inline arrays for queries with small number of components */
@@ -211,6 +254,8 @@ typedef struct ecs_iter_private_t {
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
+        ecs_chunk_iter_t chunk;
+        ecs_range_iter_t range;
     } iter;                       /* Iterator specific data */
 
     ecs_iter_cache_t cache;       /* Inline arrays to reduce allocations */
@@ -4,6 +4,14 @@
  *
  * Datastructure that computes a hash to store & retrieve values. Similar to
  * ecs_map_t, but allows for arbitrary keytypes.
+ *
+ * Elements are stored in a single flat array. Each element stores the full
+ * hash of its key, and elements with the same hash are linked together. A map
+ * from hash to the first element with that hash is used to find elements, so
+ * that keys are only compared when their hashes are equal.
+ *
+ * Pointers to keys and values are invalidated when an element is added to or
+ * removed from the hashmap.
  */
 
 #ifndef FLECS_HASHMAP_H
@@ -15,22 +23,25 @@
 extern "C" {
 #endif
 
+/* Header of element. The key and value are stored after the header. */
 typedef struct {
-    ecs_vector_t *keys;
-    ecs_vector_t *values;
-} ecs_hm_bucket_t;
+    uint64_t hash;
+    int32_t next;         /* Next element with same hash, -1 if last */
+} ecs_hm_elem_t;
 
 typedef struct {
     ecs_hash_value_action_t hash;
     ecs_compare_action_t compare;
     ecs_size_t key_size;
     ecs_size_t value_size;
-    ecs_map_t impl;
+    ecs_size_t value_offset; /* Offset of value in element */
+    ecs_size_t elem_size;
+    ecs_map_t impl;          /* map<hash, int32_t> first element with hash */
+    ecs_vector_t *elems;
 } ecs_hashmap_t;
 
 typedef struct {
-    ecs_map_iter_t it;
-    ecs_hm_bucket_t *bucket;
+    ecs_hashmap_t *map;
     int32_t index;
 } flecs_hashmap_iter_t;
 
@@ -107,18 +118,46 @@ void _flecs_hashmap_remove_w_hash(
 #define flecs_hashmap_remove_w_hash(map, key, V, hash)\
     _flecs_hashmap_remove_w_hash(map, ECS_SIZEOF(*key), key, ECS_SIZEOF(V), hash)
 
+/* Get index of first element with hash, returns -1 if there is none */
 FLECS_DBG_API
-ecs_hm_bucket_t* flecs_hashmap_get_bucket(
+int32_t flecs_hashmap_get_index(
     const ecs_hashmap_t *map,
     uint64_t hash);
 
+/* Get index of next element with the same hash, returns -1 if there is none */
 FLECS_DBG_API
-void flecs_hm_bucket_remove(
+int32_t flecs_hashmap_next_index(
+    const ecs_hashmap_t *map,
+    int32_t index);
+
+FLECS_DBG_API
+void* _flecs_hashmap_key_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t key_size,
+    int32_t index);
+
+#define flecs_hashmap_key_at(map, K, index)\
+    (K*)_flecs_hashmap_key_at(map, ECS_SIZEOF(K), index)
+
+FLECS_DBG_API
+void* _flecs_hashmap_value_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t value_size,
+    int32_t index);
+
+#define flecs_hashmap_value_at(map, V, index)\
+    (V*)_flecs_hashmap_value_at(map, ECS_SIZEOF(V), index)
+
+/* Remove element at index. The last element is moved to the index. */
+FLECS_DBG_API
+void flecs_hashmap_remove_index(
     ecs_hashmap_t *map,
-    ecs_hm_bucket_t *bucket,
-    uint64_t hash,
     int32_t index);
 
+FLECS_DBG_API
+int32_t flecs_hashmap_count(
+    const ecs_hashmap_t *map);
+
 FLECS_DBG_API
 void flecs_hashmap_copy(
     const ecs_hashmap_t *src,
@@ -6,14 +6,21 @@
  * a 64-bit key. While it is not as fast as the sparse set, it is better at
  * handling randomly distributed values.
  *
- * Payload is stored in bucket arrays. A bucket is computed from an id by
- * using the (bucket_count - 1) as an AND-mask. The number of buckets is always
- * a power of 2. Multiple keys will be stored in the same bucket. As a result
- * the worst case retrieval performance of the map is O(n), though this is rare.
- * On average lookup performance should equal O(1).
+ * The map uses open addressing. Keys and payload are stored inline in arrays
+ * with a slot for each element, and for each slot the map stores a control 
+ * byte that contains 7 bits of the key hash, or whether the slot is empty or
+ * deleted. The upper bits of the key hash select a home slot for the key. An
+ * element is stored in its home slot when it is free, so that most lookups
+ * only test a single key. When the home slot is taken, it is marked as 
+ * displaced and slots are probed in groups of 16, where the control bytes of a
+ * group are compared in parallel (with SSE2 when available), so that keys are
+ * only compared for slots with matching hash bits. The number of slots is 
+ * always a power of 2.
  *
- * The datastructure will automatically grow the number of buckets when the
- * ratio between elements and buckets exceeds a certain threshold (LOAD_FACTOR).
+ * The datastructure will automatically grow the number of slots when the
+ * ratio between elements and slots exceeds a certain threshold (LOAD_FACTOR).
+ * Payload pointers remain valid until an element is added that causes the map
+ * to grow. Removing elements (also while iterating) does not move elements.
  *
  * Note that while the implementation is a hashmap, it can only compute hashes
  * for the provided 64 bit keys. This means that the provided keys must always
@@ -35,27 +42,23 @@ extern "C" {
 
 typedef uint64_t ecs_map_key_t;
 
-/* Map type */
-typedef struct ecs_bucket_t {
-    ecs_map_key_t *keys;    /* Array with keys */
-    void *payload;          /* Payload array */
-    int32_t count;          /* Number of elements in bucket */
-} ecs_bucket_t;
+struct ecs_allocator_t;
 
+/* Map type */
 typedef struct ecs_map_t {
-    ecs_bucket_t *buckets;
+    uint8_t *ctrl;          /* Control byte for each slot */
+    ecs_map_key_t *keys;    /* Key for each slot */
+    void *payload;          /* Payload for each slot */
+    struct ecs_allocator_t *allocator; /* Allocator for slots (optional) */
     int16_t elem_size;
-    uint8_t bucket_shift;
-    int32_t bucket_count;
-    int32_t count;
+    int32_t slot_count;     /* Number of slots */
+    int32_t count;          /* Number of elements */
+    int32_t deleted;        /* Number of slots marked as deleted */
 } ecs_map_t;
 
 typedef struct ecs_map_iter_t {
     const ecs_map_t *map;
-    struct ecs_bucket_t *bucket;
-    int32_t bucket_index;
-    int32_t element_index;
-    void *payload;
+    int32_t index;
 } ecs_map_iter_t;
 
 #define ECS_MAP_INIT(T) { .elem_size = ECS_SIZEOF(T) }
@@ -70,6 +73,17 @@ void _ecs_map_init(
 #define ecs_map_init(map, T, elem_count)\
     _ecs_map_init(map, sizeof(T), elem_count)
 
+/** Initialize new map that allocates slots from an allocator. */
+FLECS_DBG_API
+void _ecs_map_init_w_allocator(
+    ecs_map_t *map,
+    ecs_size_t elem_size,
+    int32_t elem_count,
+    struct ecs_allocator_t *allocator);
+
+#define ecs_map_init_w_allocator(map, T, elem_count, allocator)\
+    _ecs_map_init_w_allocator(map, sizeof(T), elem_count, allocator)
+
 /** Deinitialize map. */
 FLECS_API
 void ecs_map_fini(
@@ -163,7 +177,7 @@ FLECS_API
 int32_t ecs_map_count(
     const ecs_map_t *map);
 
-/** Return number of buckets in map. */
+/** Return number of slots in map. */
 FLECS_API
 int32_t ecs_map_bucket_count(
     const ecs_map_t *map);
@@ -192,13 +206,13 @@ void* _ecs_map_next_ptr(
 #define ecs_map_next_ptr(iter, T, key) \
     (T)_ecs_map_next_ptr(iter, key)
 
-/** Grow number of buckets in the map for specified number of elements. */
+/** Grow number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_grow(
     ecs_map_t *map,
     int32_t elem_count);
 
-/** Set number of buckets in the map for specified number of elements. */
+/** Set number of slots in the map for specified number of elements. */
 FLECS_API
 void ecs_map_set_size(
     ecs_map_t *map,
@@ -42,6 +42,8 @@
 extern "C" {
 #endif
 
+struct ecs_allocator_t;
+
 struct ecs_sparse_t {
     ecs_vector_t *dense;        /* Dense array with indices to sparse array. The
                                  * dense array stores both alive and not alive
@@ -53,6 +55,7 @@ struct ecs_sparse_t {
     int32_t count;              /* Number of alive entries */
     uint64_t max_id_local;      /* Local max index (if no global is set) */
     uint64_t *max_id;           /* Maximum issued sparse index */
+    struct ecs_allocator_t *allocator; /* Allocator for chunks (optional) */
 };
 
 /** Initialize sparse set */
@@ -64,6 +67,16 @@ void _flecs_sparse_init(
 #define flecs_sparse_init(sparse, T)\
     _flecs_sparse_init(sparse, ECS_SIZEOF(T))
 
+/** Initialize sparse set that allocates chunks from an allocator */
+FLECS_DBG_API
+void _flecs_sparse_init_w_allocator(
+    ecs_sparse_t *sparse,
+    ecs_size_t elem_size,
+    struct ecs_allocator_t *allocator);
+
+#define flecs_sparse_init_w_allocator(sparse, T, allocator)\
+    _flecs_sparse_init_w_allocator(sparse, ECS_SIZEOF(T), allocator)
+
 /** Create new sparse set */
 FLECS_DBG_API
 ecs_sparse_t* _flecs_sparse_new(
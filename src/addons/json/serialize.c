@@ -56,6 +56,34 @@ error:
     return -1;
 }
 
+/* Find the bitmask constant with the lowest value larger than prev that is
+ * contained in value. Constants are appended in the order of their values, so
+ * that the output doesn't depend on the order in which the map stores them. */
+static
+ecs_bitmask_constant_t* json_ser_bitmask_next(
+    const EcsBitmask *bitmask_type,
+    uint32_t value,
+    bool first,
+    ecs_map_key_t prev,
+    ecs_map_key_t *key_out)
+{
+    ecs_bitmask_constant_t *result = NULL, *constant;
+    ecs_map_key_t key;
+
+    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
+    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
+        if ((!first && key <= prev) || ((value & key) != key)) {
+            continue;
+        }
+        if (!result || key < *key_out) {
+            result = constant;
+            *key_out = key;
+        }
+    }
+
+    return result;
+}
+
 /* Serialize bitmask */
 static
 int json_ser_bitmask(
@@ -68,7 +96,7 @@ int json_ser_bitmask(
     ecs_check(bitmask_type != NULL, ECS_INVALID_PARAMETER, NULL);
 
     uint32_t value = *(uint32_t*)ptr;
-    ecs_map_key_t key;
+    ecs_map_key_t key = 0;
     ecs_bitmask_constant_t *constant;
 
     if (!value) {
@@ -78,15 +106,16 @@ int json_ser_bitmask(
 
     ecs_strbuf_list_push(str, "\"", "|");
 
-    /* Multiple flags can be set at a given time. Iterate through all the flags
-     * and append the ones that are set. */
-    ecs_map_iter_t it = ecs_map_iter(bitmask_type->constants);
-    while ((constant = ecs_map_next(&it, ecs_bitmask_constant_t, &key))) {
-        if ((value & key) == key) {
-            ecs_strbuf_list_appendstr(str, 
-                ecs_get_name(world, constant->constant));
-            value -= (uint32_t)key;
-        }
+    /* Multiple flags can be set at a given time. Append the ones that are set,
+     * in order of their values. */
+    bool first = true;
+    while ((constant = json_ser_bitmask_next(
+        bitmask_type, value, first, key, &key)))
+    {
+        ecs_strbuf_list_appendstr(str, 
+            ecs_get_name(world, constant->constant));
+        value -= (uint32_t)key;
+        first = false;
     }
 
     if (value != 0) {
@@ -4,8 +4,18 @@
 #ifdef FLECS_PIPELINE
 #include "pipeline.h"
 
+static
+void free_ops(
+    ecs_vector_t *ops)
+{
+    ecs_vector_each(ops, ecs_pipeline_op_t, op, {
+        ecs_os_free(op->systems);
+    });
+    ecs_vector_free(ops);
+}
+
 static ECS_DTOR(EcsPipelineQuery, ptr, {
-    ecs_vector_free(ptr->ops);
+    free_ops(ptr->ops);
 })
 
 static
@@ -253,6 +263,168 @@ bool check_terms(
     return needs_merge;
 }
 
+static
+bool is_term_write(
+    ecs_term_t *term)
+{
+    ecs_term_id_t *subj = &term->subj;
+
+    switch(term->inout) {
+    case EcsInOut:
+    case EcsOut:
+        return true;
+    case EcsInOutDefault:
+        /* Default inout behavior is [inout] for This terms, and [in] for terms
+         * that match other entities */
+        return (subj->set.mask & EcsSelf) && (subj->entity == EcsThis);
+    default:
+        return false;
+    }
+}
+
+static
+bool is_term_access(
+    ecs_term_t *term)
+{
+    return term->oper != EcsNot && term->inout != EcsInOutFilter;
+}
+
+/* Two systems conflict if they access the same (component) id, and at least
+ * one of the systems writes it */
+static
+bool check_system_conflict(
+    ecs_filter_t *f1,
+    ecs_filter_t *f2)
+{
+    int32_t t1, t2;
+    for (t1 = 0; t1 < f1->term_count; t1 ++) {
+        ecs_term_t *term1 = &f1->terms[t1];
+        if (!is_term_access(term1)) {
+            continue;
+        }
+
+        bool write1 = is_term_write(term1);
+        ecs_id_t id1 = term1->id;
+
+        for (t2 = 0; t2 < f2->term_count; t2 ++) {
+            ecs_term_t *term2 = &f2->terms[t2];
+            if (!is_term_access(term2)) {
+                continue;
+            }
+
+            if (!write1 && !is_term_write(term2)) {
+                continue;
+            }
+
+            ecs_id_t id2 = term2->id;
+            if (ecs_id_match(id1, id2) || ecs_id_match(id2, id1)) {
+                return true;
+            }
+
+            /* Two wildcards can match the same id, even if they don't match
+             * each other, for example (Likes, *) and (*, Apples) */
+            if (ecs_id_is_wildcard(id1) && ecs_id_is_wildcard(id2)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Assign the systems of an op to groups that can run concurrently. Systems that
+ * conflict with each other are added to the same group, so that they're ran on
+ * the same thread in pipeline order. Groups are numbered in order of their
+ * first system, so that they can be divided round robin over the workers. 
+ * Groups are stored with the op, as a system can be part of more than one
+ * pipeline. */
+static
+void group_op_systems(
+    ecs_pipeline_op_t *op,
+    ecs_vector_t *systems)
+{
+    EcsSystem **sys = ecs_vector_first(systems, EcsSystem*);
+    ecs_pipeline_op_system_t *op_sys = op->systems;
+    int32_t i, j, k, count = ecs_vector_count(systems), group_count = 0;
+
+    for (i = 0; i < count; i ++) {
+        int32_t group = -1;
+
+        for (j = 0; j < i; j ++) {
+            int32_t other = op_sys[j].group;
+            if (other == group) {
+                continue;
+            }
+
+            if (!check_system_conflict(
+                &sys[i]->query->filter, &sys[j]->query->filter)) 
+            {
+                continue;
+            }
+
+            if (group == -1) {
+                group = other;
+            } else {
+                /* System conflicts with systems in two groups, merge them */
+                int32_t from = group > other ? group : other;
+                int32_t to = group < other ? group : other;
+                for (k = 0; k < i; k ++) {
+                    if (op_sys[k].group == from) {
+                        op_sys[k].group = to;
+                    }
+                }
+                group = to;
+            }
+        }
+
+        if (group == -1) {
+            group = group_count ++;
+        }
+
+        op_sys[i].group = group;
+    }
+
+    /* Merging groups can leave gaps. Renumber groups in order of appearance. */
+    int32_t next = 0;
+    for (i = 0; i < count; i ++) {
+        int32_t group = op_sys[i].group;
+        if (group < next) {
+            continue; /* Already renumbered */
+        }
+
+        for (k = i; k < count; k ++) {
+            if (op_sys[k].group == group) {
+                op_sys[k].group = next;
+            }
+        }
+        next ++;
+    }
+}
+
+/* Allocate data for the systems of an op once all systems have been added */
+static
+void finish_op(
+    ecs_pipeline_op_t *op,
+    ecs_vector_t *systems,
+    ecs_vector_t *entities)
+{
+    if (op && op->count) {
+        ecs_assert(op->count == ecs_vector_count(systems), 
+            ECS_INTERNAL_ERROR, NULL);
+        op->systems = ecs_os_calloc_n(ecs_pipeline_op_system_t, op->count);
+        group_op_systems(op, systems);
+
+        ecs_entity_t *e = ecs_vector_first(entities, ecs_entity_t);
+        int32_t i;
+        for (i = 0; i < op->count; i ++) {
+            op->systems[i].system = e[i];
+        }
+    }
+
+    ecs_vector_clear(systems);
+    ecs_vector_clear(entities);
+}
+
 static
 bool build_pipeline(
     ecs_world_t *world,
@@ -278,10 +450,12 @@ bool build_pipeline(
 
     ecs_pipeline_op_t *op = NULL;
     ecs_vector_t *ops = NULL;
+    ecs_vector_t *op_systems = NULL;
+    ecs_vector_t *op_entities = NULL;
     ecs_query_t *query = pq->build_query;
 
     if (pq->ops) {
-        ecs_vector_free(pq->ops);
+        free_ops(pq->ops);
     }
 
     bool multi_threaded = false;
@@ -325,6 +499,7 @@ bool build_pipeline(
             if (needs_merge) {
                 /* After merge all components will be merged, so reset state */
                 reset_write_state(&ws);
+                finish_op(op, op_systems, op_entities);
                 op = NULL;
 
                 /* Re-evaluate columns to set write flags if system is active.
@@ -345,6 +520,7 @@ bool build_pipeline(
                 op->count = 0;
                 op->multi_threaded = false;
                 op->no_staging = false;
+                op->systems = NULL;
             }
 
             /* Don't increase count for inactive systems, as they are ignored by
@@ -355,10 +531,19 @@ bool build_pipeline(
                     op->no_staging = no_staging;
                 }
                 op->count ++;
+
+                EcsSystem **elem = ecs_vector_add(&op_systems, EcsSystem*);
+                *elem = &sys[i];
+
+                ecs_entity_t *e = ecs_vector_add(&op_entities, ecs_entity_t);
+                *e = it.entities[i];
             }
         }
     }
 
+    finish_op(op, op_systems, op_entities);
+    ecs_vector_free(op_systems);
+    ecs_vector_free(op_entities);
     ecs_map_free(ws.components);
 
     /* Find the system ran last this frame (helps workers reset iter) */
@@ -544,14 +729,40 @@ void ecs_run_pipeline(
                 ecs_dbg_3("pipeline: run system %s", ecs_get_name(world, e));
             }
 
-            if (!stage_index || op->multi_threaded) {
+            /* Multi threaded systems run as jobs that are divided over the
+             * workers. Other systems run on the first worker, unless concurrent
+             * systems are enabled, in which case groups of systems are divided
+             * over the workers. */
+            bool run_system;
+            if (op->multi_threaded && stage_count > 1) {
+                if (!ran_since_merge) {
+                    ecs_worker_run_jobs(world, stage, op, delta_time);
+                }
+                run_system = false;
+            } else if (op->multi_threaded) {
+                run_system = true;
+            } else if (world->concurrent_systems && !op->no_staging) {
+                int32_t group = op->systems[ran_since_merge].group;
+                run_system = (group % stage_count) == stage_index;
+            } else {
+                run_system = !stage_index;
+            }
+
+            if (run_system) {
                 ecs_stage_t *s = NULL;
                 if (!op->no_staging) {
                     s = stage;
                 }
 
+                /* Chunk cursors are reset by the main thread at the sync point
+                 * that follows the op */
+                int32_t *chunk_cursor = NULL;
+                if (op->multi_threaded) {
+                    chunk_cursor = &op->systems[ran_since_merge].chunk_cursor;
+                }
+
                 ecs_run_intern(world, s, e, &sys[i], stage_index, 
-                    stage_count, delta_time, 0, 0, NULL);
+                    stage_count, chunk_cursor, delta_time, 0, 0, NULL);
             }
 
             sys[i].last_frame = world->stats.frame_count_total + 1;
@@ -571,7 +782,7 @@ void ecs_run_pipeline(
                  * current position (system). If there are a lot of systems
                  * in the pipeline this can be an expensive operation, but
                  * should happen infrequently. */
-                i = ecs_worker_sync(world, pq, &it, i, &op, &op_last);
+                i = ecs_worker_sync(world, stage, pq, &it, i, &op, &op_last);
                 sys = ecs_term(&it, EcsSystem, 1);
             }
         }
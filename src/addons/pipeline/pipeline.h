@@ -6,10 +6,17 @@
 /** Instruction data for pipeline.
  * This type is the element type in the "ops" vector of a pipeline and contains
  * information about the set of systems that need to be ran before a merge. */
+typedef struct ecs_pipeline_op_system_t {
+    ecs_entity_t system;        /* System entity */
+    int32_t chunk_cursor;       /* Next chunk to claim by worker threads */
+    int32_t group;              /* Concurrency group of system in op */
+} ecs_pipeline_op_system_t;
+
 typedef struct ecs_pipeline_op_t {
     int32_t count;              /* Number of systems to run before merge */
     bool multi_threaded;        /* Whether systems can be ran multi threaded */
     bool no_staging;            /* Whether systems are staged or not */
+    ecs_pipeline_op_system_t *systems; /* Data for each system in op */
 } ecs_pipeline_op_t;
 
 typedef struct EcsPipelineQuery {
@@ -64,6 +71,7 @@ void ecs_worker_begin(
 
 int32_t ecs_worker_sync(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     const EcsPipelineQuery *pq,
     ecs_iter_t *it,
     int32_t i,
@@ -73,6 +81,12 @@ int32_t ecs_worker_sync(
 void ecs_worker_end(
     ecs_world_t *world);
 
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_pipeline_op_t *op,
+    FLECS_FLOAT delta_time);
+
 void ecs_workers_progress(
     ecs_world_t *world,
     ecs_entity_t pipeline,
@@ -4,6 +4,84 @@
 #ifdef FLECS_PIPELINE
 #include "pipeline.h"
 
+/* Number of times a thread polls a sync variable before it blocks on a
+ * condition variable. Most pipeline ops are short, so spinning for a while lets
+ * threads pass a sync point with a few atomic operations instead of a full
+ * condition variable round trip. */
+#define ECS_WORKER_SPIN_COUNT (4096)
+
+/* Number of jobs in the queue of each worker for multi threaded ops. A job runs
+ * the systems of an op for a slice of their entities. Having more jobs than
+ * workers lets workers that are done steal jobs from workers that are behind. */
+#define ECS_WORKER_JOB_COUNT (4)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Load sync variable with acquire semantics. A thread that observes a new value
+ * must also observe the pipeline and stage state that was written before the
+ * value was published. Values are published with ecs_os_ainc/ecs_os_adec,
+ * which are full barriers in the OS API implementations. */
+static
+int32_t sync_load(
+    int32_t *ptr)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER)
+    return (int32_t)_InterlockedOr((volatile long*)ptr, 0);
+#else
+    return *(volatile int32_t*)ptr;
+#endif
+}
+
+/* Tell the CPU that the thread is in a spin loop, which reduces power usage and
+ * frees up resources for the other hardware thread on the same core. */
+static
+void sync_relax(void)
+{
+#if defined(__GNUC__) || defined(__clang__)
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+    __asm__ __volatile__("yield");
+#endif
+#elif defined(_MSC_VER)
+#if defined(_M_IX86) || defined(_M_X64)
+    _mm_pause();
+#elif defined(_M_ARM) || defined(_M_ARM64)
+    __yield();
+#endif
+#endif
+}
+
+/* Wait until the main thread bumps the sync generation */
+static
+void wait_for_signal(
+    ecs_world_t *world,
+    int32_t sync_gen)
+{
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (sync_load(&world->sync_gen) != sync_gen) {
+            return;
+        }
+        sync_relax();
+    }
+
+    /* Park thread. The main thread checks workers_parked after bumping the
+     * generation, so either it sees this thread as parked, or this thread sees
+     * the new generation before it starts waiting. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while (sync_load(&world->sync_gen) == sync_gen) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+}
+
 /* Worker thread */
 static
 void* worker(void *arg) {
@@ -14,13 +92,13 @@ void* worker(void *arg) {
      * workers are ready */
     ecs_os_mutex_lock(world->sync_mutex);
     world->workers_running ++;
+    int32_t sync_gen = sync_load(&world->sync_gen);
+    ecs_os_mutex_unlock(world->sync_mutex);
 
     if (!world->quit_workers) {
-        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+        wait_for_signal(world, sync_gen);
     }
 
-    ecs_os_mutex_unlock(world->sync_mutex);
-
     while (!world->quit_workers) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
  
@@ -81,20 +159,34 @@ void wait_for_workers(
 /* Synchronize worker threads */
 static
 void sync_worker(
-    ecs_world_t *world)
+    ecs_world_t *world,
+    ecs_stage_t *stage)
 {
     int32_t stage_count = ecs_get_stage_count(world);
 
-    /* Signal that thread is waiting */
-    ecs_os_mutex_lock(world->sync_mutex);
-    if (++ world->workers_waiting == stage_count) {
-        /* Only signal main thread when all threads are waiting */
-        ecs_os_cond_signal(world->sync_cond);
+    /* If stages are merged in entity order, sort the commands of the stage
+     * before synchronizing, so that queues are sorted in parallel instead of
+     * by the main thread during the merge. */
+    if (world->merge_by_entity) {
+        flecs_defer_sort(stage);
+    }
+
+    /* Read generation before signaling, as the main thread can only bump it
+     * after all workers are waiting */
+    int32_t sync_gen = sync_load(&world->sync_gen);
+
+    /* Signal that thread is waiting. Only wake up the main thread when all
+     * threads are waiting and the main thread stopped spinning. */
+    if (ecs_os_ainc(&world->workers_waiting) == stage_count) {
+        if (sync_load(&world->sync_parked)) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            ecs_os_cond_signal(world->sync_cond);
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
     }
 
     /* Wait until main thread signals that thread can continue */
-    ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    wait_for_signal(world, sync_gen);
 }
 
 /* Wait until all threads are waiting on sync point */
@@ -104,10 +196,20 @@ void wait_for_sync(
 {
     int32_t stage_count = ecs_get_stage_count(world);
 
+    int32_t i;
+    for (i = 0; i < ECS_WORKER_SPIN_COUNT; i ++) {
+        if (sync_load(&world->workers_waiting) == stage_count) {
+            return;
+        }
+        sync_relax();
+    }
+
     ecs_os_mutex_lock(world->sync_mutex);
-    if (world->workers_waiting != stage_count) {
+    ecs_os_ainc(&world->sync_parked);
+    while (sync_load(&world->workers_waiting) != stage_count) {
         ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
     }
+    ecs_os_adec(&world->sync_parked);
     
     /* We should have been signalled unless all workers are waiting on sync */
     ecs_assert(world->workers_waiting == stage_count, 
@@ -116,14 +218,39 @@ void wait_for_sync(
     ecs_os_mutex_unlock(world->sync_mutex);
 }
 
+/* Reset the job queues of the workers and the chunk cursors of the systems in
+ * an op. This happens while all workers are waiting on the sync point, so no
+ * worker can claim a job or chunk. */
+static
+void reset_op_jobs(
+    ecs_world_t *world,
+    ecs_pipeline_op_t *op)
+{
+    if (op->multi_threaded) {
+        int32_t i;
+        for (i = 0; i < op->count; i ++) {
+            op->systems[i].chunk_cursor = 0;
+        }
+
+        ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+            stage->job_cursor = 0;
+        });
+    }
+}
+
 /* Signal workers that they can start/resume work */
 static
 void signal_workers(
     ecs_world_t *world)
 {
-    ecs_os_mutex_lock(world->sync_mutex);
-    ecs_os_cond_broadcast(world->worker_cond);
-    ecs_os_mutex_unlock(world->sync_mutex);
+    ecs_os_ainc(&world->sync_gen);
+
+    /* Only take the lock if a worker stopped spinning */
+    if (sync_load(&world->workers_parked)) {
+        ecs_os_mutex_lock(world->sync_mutex);
+        ecs_os_cond_broadcast(world->worker_cond);
+        ecs_os_mutex_unlock(world->sync_mutex);
+    }
 }
 
 /** Stop worker threads */
@@ -172,8 +299,117 @@ bool ecs_stop_threads(
     return true;
 }
 
+/* Claim job from the queue of a worker. The queues are filled when an op
+ * starts and no jobs are added while the op runs, so both the worker that owns
+ * the queue and workers that steal from it take jobs from the front, with a
+ * single atomic increment. Returns -1 if the queue is empty. */
+static
+int32_t claim_job(
+    ecs_stage_t *queue)
+{
+    if (sync_load(&queue->job_cursor) >= ECS_WORKER_JOB_COUNT) {
+        return -1;
+    }
+
+    int32_t job = ecs_os_ainc(&queue->job_cursor) - 1;
+    if (job >= ECS_WORKER_JOB_COUNT) {
+        return -1;
+    }
+
+    return job;
+}
+
+/* Systems that use chunks or partition their groups distribute their entities
+ * over the workers themselves, and are ran once by each worker. Other multi
+ * threaded systems are divided into slices that are ran by jobs. */
+static
+bool is_sliced(
+    const EcsSystem *sys)
+{
+    return !sys->chunk_size && !sys->partition_groups;
+}
+
+/* Run the systems of an op for the slice of entities that belongs to a job.
+ * All systems of the op are ran for the same slice, in pipeline order. This
+ * ensures that an entity is processed by the systems of the op in order, as
+ * a slice contains the same entities for systems that match the same table. */
+static
+void run_job(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_pipeline_op_t *op,
+    int32_t job,
+    int32_t job_count,
+    FLECS_FLOAT delta_time)
+{
+    ecs_stage_t *s = NULL;
+    if (!op->no_staging) {
+        s = stage;
+    }
+
+    int32_t i;
+    for (i = 0; i < op->count; i ++) {
+        ecs_pipeline_op_system_t *op_sys = &op->systems[i];
+        EcsSystem *sys = (EcsSystem*)ecs_get(world, op_sys->system, EcsSystem);
+        ecs_assert(sys != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        if (is_sliced(sys)) {
+            ecs_run_intern(world, s, op_sys->system, sys, job, job_count, 
+                NULL, delta_time, 0, 0, NULL);
+        }
+    }
+}
+
 /* -- Private functions -- */
 
+void ecs_worker_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_pipeline_op_t *op,
+    FLECS_FLOAT delta_time)
+{
+    ecs_stage_t *stages = ecs_vector_first(world->worker_stages, ecs_stage_t);
+    int32_t stage_count = ecs_vector_count(world->worker_stages);
+    int32_t stage_index = ecs_get_stage_id(stage->thread_ctx);
+    int32_t job_count = stage_count * ECS_WORKER_JOB_COUNT;
+    ecs_assert(stage_count > 1, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_stage_t *s = NULL;
+    if (!op->no_staging) {
+        s = stage;
+    }
+
+    /* Run systems that distribute their own entities first. Other workers can
+     * meanwhile steal jobs from the queue of this worker. */
+    int32_t i, job, sliced_count = 0;
+    for (i = 0; i < op->count; i ++) {
+        ecs_pipeline_op_system_t *op_sys = &op->systems[i];
+        EcsSystem *sys = (EcsSystem*)ecs_get(world, op_sys->system, EcsSystem);
+        ecs_assert(sys != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        if (is_sliced(sys)) {
+            sliced_count ++;
+        } else {
+            ecs_run_intern(world, s, op_sys->system, sys, stage_index, 
+                stage_count, &op_sys->chunk_cursor, delta_time, 0, 0, NULL);
+        }
+    }
+
+    if (!sliced_count) {
+        return;
+    }
+
+    /* Run the jobs in the queue of this worker first, then steal jobs from the
+     * queues of the other workers */
+    for (i = 0; i < stage_count; i ++) {
+        int32_t w = (stage_index + i) % stage_count;
+        while ((job = claim_job(&stages[w])) != -1) {
+            run_job(world, stage, op, w * ECS_WORKER_JOB_COUNT + job, 
+                job_count, delta_time);
+        }
+    }
+}
+
 void ecs_worker_begin(
     ecs_world_t *world)
 {
@@ -195,6 +431,7 @@ void ecs_worker_begin(
 
 int32_t ecs_worker_sync(
     ecs_world_t *world,
+    ecs_stage_t *stage,
     const EcsPipelineQuery *pq,
     ecs_iter_t *it,
     int32_t i,
@@ -216,7 +453,7 @@ int32_t ecs_worker_sync(
     /* Synchronize all workers. The last worker to reach the sync point will
      * signal the main thread, which will perform the merge. */
     } else {
-        sync_worker(world);
+        sync_worker(world, stage);
     }
 
     if (build_count != world->stats.pipeline_build_count_total) {
@@ -237,7 +474,7 @@ int32_t ecs_worker_sync(
 void ecs_worker_end(
     ecs_world_t *world)
 {
-    flecs_stage_from_world(&world);
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
 
     int32_t stage_count = ecs_get_stage_count(world);
     ecs_assert(stage_count != 0, ECS_INTERNAL_ERROR, NULL);
@@ -251,7 +488,7 @@ void ecs_worker_end(
     /* Synchronize all workers. The last worker to reach the sync point will
      * signal the main thread, which will perform the merge. */
     } else {
-        sync_worker(world);
+        sync_worker(world, stage);
     }
 }
 
@@ -298,6 +535,8 @@ void ecs_workers_progress(
             /* Wait until all workers are waiting on sync point */
             wait_for_sync(world);
 
+            reset_op_jobs(world, op);
+
             /* Merge */
             if (!op->no_staging) {
                 ecs_staging_end(world);
@@ -345,9 +584,22 @@ void ecs_set_threads(
             world->worker_cond = ecs_os_cond_new();
             world->sync_cond = ecs_os_cond_new();
             world->sync_mutex = ecs_os_mutex_new();
+            world->workers_parked = 0;
+            world->sync_parked = 0;
             start_workers(world, threads);
         }
     }
 }
 
+void ecs_set_concurrent_systems(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!world->is_readonly, ECS_INVALID_WHILE_ITERATING, NULL);
+    world->concurrent_systems = enable;
+error:
+    return;
+}
+
 #endif
@@ -75,10 +75,15 @@
  * - it improves the average performance of all queries
  * - it makes performance less dependent on how an application orders the terms
  * 
- * A possible improvement would be for the query engine to also consider
- * the number of tables that need to be evaluated for each term, as starting
- * with the smallest term reduces the amount of work. Other than static variable
- * analysis however, this can only be determined when the query is executed.
+ * The static variable analysis is combined with an estimate of the number of
+ * entities that each term matches at the time the rule is created, as starting
+ * with the smallest term reduces the amount of work. If a variable other than
+ * the elected root matches fewer entities, that variable becomes the root. Terms
+ * for the same variable are inserted in order of their estimate, so that the
+ * select operation for a variable iterates the smallest set of tables. If one
+ * of the terms can't be estimated, for example because it has a transitive
+ * relation, the estimates are not used. The estimates and the actual number of
+ * rows produced by each operation can be inspected with ecs_rule_plan_str.
  * 
  * Rules are "compiled" into a set of instructions that encode the operations
  * the query needs to perform in order to find the right set of entities.
@@ -272,6 +277,7 @@ typedef struct ecs_rule_with_ctx_t {
     ecs_id_record_t *idr;      /* Currently evaluated table set */
     ecs_table_cache_iter_t it;
     int32_t column;
+    int32_t table_index;       /* Index of table in set, used for partitioning */
 } ecs_rule_with_ctx_t;
 
 /* Subset context */
@@ -286,6 +292,8 @@ typedef struct ecs_rule_subset_ctx_t {
     ecs_rule_subset_frame_t storage[16]; /* Alloc-free array for small trees */
     ecs_rule_subset_frame_t *stack;
     int32_t sp;
+    ecs_closure_elem_t *closure;         /* Set when relation is indexed */
+    int32_t closure_index;
 } ecs_rule_subset_ctx_t;
 
 /* Superset context */
@@ -299,6 +307,8 @@ typedef struct ecs_rule_superset_ctx_t {
     ecs_rule_superset_frame_t *stack;
     ecs_id_record_t *idr;
     int32_t sp;
+    ecs_closure_elem_t *closure;           /* Set when relation is indexed */
+    int32_t closure_index;
 } ecs_rule_superset_ctx_t;
 
 /* Each context */
@@ -331,6 +341,7 @@ typedef struct ecs_rule_var_t {
     int32_t other;    /* Id to table variable (-1 if none exists) */
     int32_t occurs;   /* Number of occurrences (used for operation ordering) */
     int32_t depth;  /* Depth in dependency tree (used for operation ordering) */
+    int32_t estimate; /* Estimated number of entities (used for operation ordering) */
     bool marked;      /* Used for cycle detection */
 } ecs_rule_var_t;
 
@@ -341,6 +352,29 @@ typedef struct ecs_rule_term_vars_t {
     int32_t obj;
 } ecs_rule_term_vars_t;
 
+/* Result stored in rule cache */
+typedef struct ecs_rule_result_t {
+    ecs_table_t *table;
+    int32_t offset;
+    int32_t count;
+} ecs_rule_result_t;
+
+/* Cache with results of a rule, used when the rule is created with cached set
+ * to true. The cache is refilled when one of the tables that can contribute to
+ * the rule results is created, deleted or changed structurally. */
+typedef struct ecs_rule_cache_t {
+    ecs_vector_t *results;     /* vector<ecs_rule_result_t> */
+    ecs_vector_t *variables;   /* vector<ecs_entity_t>, var_count per result */
+    ecs_vector_t *ids;         /* vector<ecs_id_t>, term_count per result */
+    ecs_vector_t *subjects;    /* vector<ecs_entity_t>, term_count per result */
+    ecs_vector_t *columns;     /* vector<int32_t>, term_count per result */
+
+    int64_t dirty_state;       /* Sum of dirty state of watched tables */
+    int32_t table_generation;  /* Generation of table set at time of fill */
+    int32_t version;           /* Incremented each time cache is refilled */
+    bool valid;                /* Has the cache been filled */
+} ecs_rule_cache_t;
+
 /* Top-level rule datastructure */
 struct ecs_rule_t {
     ecs_header_t hdr;
@@ -355,6 +389,21 @@ struct ecs_rule_t {
     /* Variable ids used in terms */
     ecs_rule_term_vars_t term_vars[ECS_RULE_MAX_VAR_COUNT];
 
+    /* Estimated number of entities matched by each term when rule was created */
+    int32_t term_estimates[ECS_RULE_MAX_VAR_COUNT];
+
+    /* Order in which terms are inserted into the program */
+    int32_t term_order[ECS_RULE_MAX_VAR_COUNT];
+
+    /* Are estimates used to order operations */
+    bool use_estimates;
+
+    /* Cached results, if rule is cached */
+    ecs_rule_cache_t cache;
+
+    /* Operation of which the tables are divided across worker iterators */
+    int32_t partition_op;
+
     /* Variable array */
     ecs_rule_var_t vars[ECS_RULE_MAX_VAR_COUNT];
 
@@ -460,6 +509,7 @@ ecs_rule_var_t* create_variable(
     var->depth = UINT8_MAX;
     var->marked = false;
     var->occurs = 0;
+    var->estimate = INT32_MAX;
 
     return var;
 }
@@ -1338,7 +1388,8 @@ int32_t get_variable_depth(
 }
 
 /* Compare function used for qsort. It ensures that variables are first ordered
- * by depth, followed by how often they occur. */
+ * by depth, followed by their estimated number of entities and how often they
+ * occur. */
 static
 int compare_variable(
     const void* ptr1, 
@@ -1359,6 +1410,12 @@ int compare_variable(
         return 1;
     }
 
+    if (v1->estimate < v2->estimate) {
+        return -1;
+    } else if (v1->estimate > v2->estimate) {
+        return 1;
+    }
+
     if (v1->occurs < v2->occurs) {
         return 1;
     } else {
@@ -1411,6 +1468,166 @@ void ensure_all_variables(
     }    
 }
 
+/* Get id that matches all tables that can match the term, by replacing the
+ * variables in the term with wildcards. If wildcard_obj is true, the object of
+ * a pair is always replaced with a wildcard. */
+static
+ecs_id_t term_match_id(
+    ecs_term_t *term,
+    bool wildcard_obj)
+{
+    ecs_entity_t pred = term->pred.entity;
+    if (term_id_is_variable(&term->pred)) {
+        pred = EcsWildcard;
+    }
+
+    if (!obj_is_set(term)) {
+        return pred;
+    }
+
+    ecs_entity_t obj = term->obj.entity;
+    if (wildcard_obj || term_id_is_variable(&term->obj)) {
+        obj = EcsWildcard;
+    }
+
+    return ecs_pair(pred, obj);
+}
+
+/* Estimate the number of entities that match a term, by counting the entities
+ * in the tables of the id record for the term. Variables are replaced with
+ * wildcards, so the estimate is an upper bound for terms of which variables
+ * are resolved by other terms. Returns INT32_MAX if the term can't be
+ * estimated. */
+static
+int32_t estimate_term(
+    ecs_rule_t *rule,
+    ecs_term_t *term)
+{
+    if (term->subj.var == EcsVarIsEntity) {
+        /* Term with literal subject matches at most one entity */
+        return 1;
+    }
+
+    if (!term_id_is_variable(&term->pred) && obj_is_set(term) && 
+        ecs_has_id(rule->world, term->pred.entity, EcsTransitive)) 
+    {
+        /* Transitive terms also match subsets and supersets of the object,
+         * which are not included in the id record of the term. */
+        return INT32_MAX;
+    }
+
+    ecs_id_t id = term_match_id(term, false);
+    ecs_id_record_t *idr = flecs_get_id_record(rule->world, id);
+    if (!idr) {
+        return 0;
+    }
+
+    int64_t result = 0;
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            result += ecs_table_count(tr->hdr.table);
+        }
+    }
+
+    if (result > INT32_MAX) {
+        result = INT32_MAX;
+    }
+
+    return (int32_t)result;
+}
+
+/* Compute estimates for all terms, and the order in which the terms should be
+ * inserted into the program. Terms with the smallest estimates go first, so
+ * that the first operation for a variable iterates the smallest set. */
+static
+void estimate_terms(
+    ecs_rule_t *rule)
+{
+    ecs_term_t *terms = rule->filter.terms;
+    int32_t i, j, count = rule->filter.term_count;
+
+    rule->use_estimates = true;
+
+    for (i = 0; i < count; i ++) {
+        int32_t estimate = rule->term_estimates[i] = 
+            estimate_term(rule, &terms[i]);
+
+        /* If one of the terms can't be estimated, the estimates don't say 
+         * anything about which order is better. Keep the order of the terms
+         * as specified by the application. */
+        if (estimate == INT32_MAX) {
+            rule->use_estimates = false;
+        }
+
+        /* Insertion sort, so that terms with equal estimates keep the order in
+         * which they were specified */
+        for (j = i; j > 0; j --) {
+            int32_t prev = rule->term_order[j - 1];
+            if (rule->term_estimates[prev] <= estimate) {
+                break;
+            }
+            rule->term_order[j] = prev;
+        }
+        rule->term_order[j] = i;
+    }
+
+    if (!rule->use_estimates) {
+        for (i = 0; i < count; i ++) {
+            rule->term_order[i] = i;
+        }
+    }
+}
+
+/* Compute the depth of variables in the dependency tree with the provided
+ * root. Returns false if not all subject variables are reachable from root. */
+static
+bool compute_variable_depths(
+    ecs_rule_t *rule,
+    ecs_rule_var_t *root)
+{
+    ecs_term_t *terms = rule->filter.terms;
+    int32_t i, term_count = rule->filter.term_count;
+
+    for (i = 0; i < rule->var_count; i ++) {
+        rule->vars[i].depth = UINT8_MAX;
+        rule->vars[i].marked = false;
+    }
+
+    /* Variables in a term with a literal subject have depth 0 */
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &terms[i];
+
+        if (term->subj.var == EcsVarIsEntity) {
+            ecs_rule_var_t 
+            *pred = term_pred(rule, term),
+            *obj = term_obj(rule, term);
+
+            if (pred) {
+                pred->depth = 0;
+            }
+            if (obj) {
+                obj->depth = 0;
+            }
+        }
+    }
+
+    if (!root) {
+        return true;
+    }
+
+    root->depth = get_variable_depth(rule, root, root, 0);
+
+    for (i = 0; i < rule->subj_var_count; i ++) {
+        if (rule->vars[i].depth == UINT8_MAX) {
+            return false;
+        } 
+    }
+
+    return true;
+}
+
 /* Scan for variables, put them in optimal dependency order. */
 static
 int scan_variables(
@@ -1457,6 +1674,17 @@ int scan_variables(
                 max_occur = subj->occurs;
                 max_occur_var = subj->id;
             }
+
+            /* The estimate of a variable is the estimate of its most selective
+             * term. Optional terms don't constrain the variable. */
+            if (rule->use_estimates && !skip_term(term) && 
+                term->oper != EcsOptional) 
+            {
+                int32_t estimate = rule->term_estimates[i];
+                if (estimate < subj->estimate) {
+                    subj->estimate = estimate;
+                }
+            }
         }
     }
 
@@ -1464,24 +1692,6 @@ int scan_variables(
 
     ensure_all_variables(rule);
 
-    /* Variables in a term with a literal subject have depth 0 */
-    for (i = 0; i < term_count; i ++) {
-        ecs_term_t *term = &terms[i];
-
-        if (term->subj.var == EcsVarIsEntity) {
-            ecs_rule_var_t 
-            *pred = term_pred(rule, term),
-            *obj = term_obj(rule, term);
-
-            if (pred) {
-                pred->depth = 0;
-            }
-            if (obj) {
-                obj->depth = 0;
-            }
-        }
-    }
-
     /* Elect a root. This is either this (.) or the variable with the most
      * occurrences. */
     int32_t root_var = this_var;
@@ -1491,12 +1701,27 @@ int scan_variables(
             /* If no subject variables have been found, the rule expression only
              * operates on a fixed set of entities, in which case no root 
              * election is required. */
+            compute_variable_depths(rule, NULL);
             goto done;
         }
     }
 
-    ecs_rule_var_t *root = &rule->vars[root_var];
-    root->depth = get_variable_depth(rule, root, root, 0);
+    /* If another variable matches fewer entities than the elected root, start
+     * evaluating from that variable instead. This prevents the rule from first
+     * iterating a large set of entities that is then narrowed down by a term
+     * for a different variable. */
+    int32_t cost_root_var = root_var;
+    for (i = 0; i < rule->subj_var_count; i ++) {
+        if (rule->vars[i].estimate < rule->vars[cost_root_var].estimate) {
+            cost_root_var = i;
+        }
+    }
+
+    if (!compute_variable_depths(rule, &rule->vars[cost_root_var])) {
+        /* Not all variables can be reached from the cheapest variable, fall
+         * back to root election without estimates. */
+        compute_variable_depths(rule, &rule->vars[root_var]);
+    }
 
     /* Verify that there are no unconstrained variables. Unconstrained variables
      * are variables that are unreachable from the root. */
@@ -2516,7 +2741,7 @@ void compile_program(
     bool written[ECS_RULE_MAX_VAR_COUNT] = { false };
 
     ecs_term_t *terms = rule->filter.terms;
-    int32_t v, c, term_count = rule->filter.term_count;
+    int32_t v, c, t, term_count = rule->filter.term_count;
     ecs_rule_op_t *op;
 
     /* Insert input, which is always the first instruction */
@@ -2525,7 +2750,8 @@ void compile_program(
     /* First insert all instructions that do not have a variable subject. Such
      * instructions iterate the type of an entity literal and are usually good
      * candidates for quickly narrowing down the set of potential results. */
-    for (c = 0; c < term_count; c ++) {
+    for (t = 0; t < term_count; t ++) {
+        c = rule->term_order[t];
         ecs_term_t *term = &terms[c];
         if (skip_term(term)) {
             continue;
@@ -2549,7 +2775,10 @@ void compile_program(
 
         ecs_assert(var->kind == EcsRuleVarKindTable, ECS_INTERNAL_ERROR, NULL);
 
-        for (c = 0; c < term_count; c ++) {
+        /* Terms are inserted in order of estimated entity count, so that the
+         * term that selects the tables for the variable is the smallest */
+        for (t = 0; t < term_count; t ++) {
+            c = rule->term_order[t];
             ecs_term_t *term = &terms[c];
             if (skip_term(term)) {
                 continue;
@@ -2749,12 +2978,19 @@ ecs_rule_t* ecs_rule_init(
 {
     ecs_rule_t *result = ecs_poly_new(ecs_rule_t);
 
+    /* Rules cache their results instead of the tables matched by the filter,
+     * so the filter doesn't have to be cacheable */
+    ecs_filter_desc_t filter_desc = *desc;
+    filter_desc.cached = false;
+
     /* Parse the signature expression. This initializes the columns array which
      * contains the information about which components/pairs are requested. */
-    if (ecs_filter_init(world, &result->filter, desc)) {
+    if (ecs_filter_init(world, &result->filter, &filter_desc)) {
         goto error;
     }
 
+    result->filter.cached = desc->cached;
+
     result->world = world;
 
     /* Rule has no terms */
@@ -2778,6 +3014,11 @@ ecs_rule_t* ecs_rule_init(
         goto error;
     }
 
+    /* Estimate number of entities matched by terms, used to order operations.
+     * Make sure that tables are registered as (non) empty before estimating. */
+    flecs_process_pending_tables(world);
+    estimate_terms(result);
+
     /* Find all variables & resolve dependencies */
     if (scan_variables(result) != 0) {
         goto error;
@@ -2795,6 +3036,16 @@ ecs_rule_t* ecs_rule_init(
     /* Generate the opcode array */
     compile_program(result);
 
+    /* The first select operation is used to divide work between workers. Each
+     * worker evaluates the remainder of the program for its own tables. */
+    result->partition_op = -1;
+    for (i = 0; i < result->operation_count; i ++) {
+        if (result->operations[i].kind == EcsRuleSelect) {
+            result->partition_op = i;
+            break;
+        }
+    }
+
     /* Create array with variable names so this can be easily accessed by 
      * iterators without requiring access to the ecs_rule_t */
     create_variable_name_array(result);
@@ -2811,6 +3062,17 @@ error:
     return NULL;
 }
 
+static
+void rule_cache_fini(
+    ecs_rule_cache_t *cache)
+{
+    ecs_vector_free(cache->results);
+    ecs_vector_free(cache->variables);
+    ecs_vector_free(cache->ids);
+    ecs_vector_free(cache->subjects);
+    ecs_vector_free(cache->columns);
+}
+
 void ecs_rule_fini(
     ecs_rule_t *rule)
 {
@@ -2820,6 +3082,7 @@ void ecs_rule_fini(
     }
 
     ecs_filter_fini(&rule->filter);
+    rule_cache_fini(&rule->cache);
 
     ecs_os_free(rule->operations);
     ecs_os_free(rule);
@@ -2844,13 +3107,13 @@ ecs_rule_var_t* get_variable(
     return (ecs_rule_var_t*)&rule->vars[var_id];
 }
 
-/* Convert the program to a string. This can be useful to analyze how a rule is
- * being evaluated. */
-char* ecs_rule_str(
-    ecs_rule_t *rule)
+/* Convert the program to a string. If rows is provided, the string includes
+ * the estimated and actual number of rows for each operation. */
+static
+char* rule_str(
+    ecs_rule_t *rule,
+    const int64_t *rows)
 {
-    ecs_check(rule != NULL, ECS_INVALID_PARAMETER, NULL);
-    
     ecs_world_t *world = rule->world;
     ecs_strbuf_t buf = ECS_STRBUF_INIT;
     char filter_expr[256];
@@ -2887,6 +3150,25 @@ char* ecs_rule_str(
         ecs_strbuf_append(&buf, "%2d: [S:%2d, P:%2d, F:%2d, T:%2d] ", i, 
             op->frame, op->on_pass, op->on_fail, op->term);
 
+        if (rows) {
+            /* Only operations that evaluate a term have an estimate */
+            char estimate[16] = "-";
+            bool has_estimate = op->term != -1 && (
+                op->kind == EcsRuleSelect || op->kind == EcsRuleWith ||
+                op->kind == EcsRuleSubSet || op->kind == EcsRuleSuperSet);
+            if (has_estimate) {
+                int32_t e = rule->term_estimates[op->term];
+                if (e != INT32_MAX) {
+                    ecs_os_sprintf(estimate, "%d", e);
+                } else {
+                    ecs_os_strcpy(estimate, "?");
+                }
+            }
+
+            ecs_strbuf_append(&buf, "[E:%8s, A:%8lld] ", estimate, 
+                (long long)rows[i]);
+        }
+
         bool has_filter = false;
 
         switch(op->kind) {
@@ -2982,6 +3264,42 @@ char* ecs_rule_str(
     }
 
     return ecs_strbuf_get(&buf);
+}
+
+/* Convert the program to a string. This can be useful to analyze how a rule is
+ * being evaluated. */
+char* ecs_rule_str(
+    ecs_rule_t *rule)
+{
+    ecs_check(rule != NULL, ECS_INVALID_PARAMETER, NULL);
+    return rule_str(rule, NULL);
+error:
+    return NULL;
+}
+
+static
+ecs_iter_t rule_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule);
+
+/* Evaluate the rule and convert the program to a string that includes for each
+ * operation the estimated and the actual number of rows. This can be used to
+ * find out whether the estimates picked a good order for the operations. */
+char* ecs_rule_plan_str(
+    ecs_rule_t *rule)
+{
+    ecs_check(rule != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int64_t *rows = ecs_os_calloc_n(int64_t, rule->operation_count);
+
+    /* Always evaluate program, even if rule is cached */
+    ecs_iter_t it = rule_iter(rule->world, rule);
+    it.priv.iter.rule.profile = rows;
+    while (ecs_rule_next_instanced(&it)) { }
+
+    char *result = rule_str(rule, rows);
+    ecs_os_free(rows);
+    return result;
 error:
     return NULL;
 }
@@ -3034,6 +3352,12 @@ ecs_entity_t ecs_rule_get_var(
 
     /* We can only return entity variables */
     if (rule->vars[var_id].kind == EcsRuleVarKindEntity) {
+        if (it->cached) {
+            /* Registers aren't used when returning cached results */
+            ecs_entity_t e = iter->variables[var_id];
+            return e ? e : EcsWildcard;
+        }
+
         ecs_rule_reg_t *regs = get_register_frame(it, rule->frame_count - 1);
         return entity_reg_get(rule, regs, var_id);
     } else {
@@ -3060,6 +3384,10 @@ void ecs_rule_set_var(
     const ecs_rule_t *r = iter->rule;
     ecs_check(var_id < r->var_count, ECS_INVALID_PARAMETER, NULL);
 
+    /* Cache contains results for unconstrained variables, so the program must
+     * be evaluated when a variable is set */
+    iter->cached = false;
+
     entity_reg_set(r, iter->registers, var_id, value);
 
     /* Also set table variable if it exists */
@@ -3090,8 +3418,9 @@ void ecs_rule_iter_free(
     it->op_ctx = NULL;
 }
 
-/* Create rule iterator */
-ecs_iter_t ecs_rule_iter(
+/* Create rule iterator that evaluates the rule program */
+static
+ecs_iter_t rule_iter(
     const ecs_world_t *world,
     const ecs_rule_t *rule)
 {
@@ -3151,6 +3480,244 @@ ecs_iter_t ecs_rule_iter(
     return result;
 }
 
+/* Compute sum of the dirty state of all tables that can contribute to the rule
+ * results. Because dirty state only increases, the sum changes when entities 
+ * are added to or removed from any of these tables. Returns false if the state
+ * could not be determined without modifying tables in readonly mode. */
+static
+bool rule_cache_dirty_state(
+    ecs_rule_t *rule,
+    bool readonly,
+    int64_t *dirty_state_out)
+{
+    ecs_world_t *world = rule->world;
+    int64_t dirty_state = 0;
+    int32_t i, count = rule->filter.term_count;
+
+    for (i = 0; i <= count; i ++) {
+        ecs_id_t id;
+        if (i == count) {
+            /* Predicates and objects can match through IsA relations */
+            id = ecs_pair(EcsIsA, EcsWildcard);
+        } else {
+            ecs_term_t *term = &rule->filter.terms[i];
+
+            /* Transitive terms can match tables with any object */
+            bool transitive = !term_id_is_variable(&term->pred) && 
+                obj_is_set(term) && ecs_has_id(
+                    world, term->pred.entity, EcsTransitive);
+
+            id = term_match_id(term, transitive);
+        }
+
+        ecs_id_record_t *idr = flecs_get_id_record(world, id);
+        if (!idr) {
+            continue;
+        }
+
+        ecs_table_cache_iter_t it;
+        int32_t empty;
+        for (empty = 0; empty < 2; empty ++) {
+            if (empty) {
+                if (!flecs_table_cache_empty_iter(&idr->cache, &it)) {
+                    continue;
+                }
+            } else if (!flecs_table_cache_iter(&idr->cache, &it)) {
+                continue;
+            }
+
+            const ecs_table_record_t *tr;
+            while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+                ecs_table_t *table = tr->hdr.table;
+                if (!table->dirty_state && readonly) {
+                    return false;
+                }
+
+                dirty_state += flecs_table_get_dirty_state(table)[0];
+            }
+        }
+    }
+
+    *dirty_state_out = dirty_state;
+
+    return true;
+}
+
+/* Evaluate rule program and store results in cache */
+static
+void rule_cache_fill(
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = &rule->cache;
+    int32_t var_count = rule->var_count;
+    int32_t term_count = rule->filter.term_count;
+
+    ecs_vector_clear(cache->results);
+    ecs_vector_clear(cache->variables);
+    ecs_vector_clear(cache->ids);
+    ecs_vector_clear(cache->subjects);
+    ecs_vector_clear(cache->columns);
+
+    ecs_iter_t it = rule_iter(rule->world, rule);
+    while (ecs_rule_next_instanced(&it)) {
+        ecs_rule_result_t *result = ecs_vector_add(
+            &cache->results, ecs_rule_result_t);
+        result->table = it.table;
+        result->offset = it.offset;
+        result->count = it.count;
+
+        if (var_count) {
+            ecs_entity_t *variables = ecs_vector_addn(
+                &cache->variables, ecs_entity_t, var_count);
+            ecs_os_memcpy_n(variables, it.variables, ecs_entity_t, var_count);
+        }
+
+        ecs_id_t *ids = ecs_vector_addn(&cache->ids, ecs_id_t, term_count);
+        ecs_os_memcpy_n(ids, it.ids, ecs_id_t, term_count);
+
+        ecs_entity_t *subjects = ecs_vector_addn(
+            &cache->subjects, ecs_entity_t, term_count);
+        ecs_os_memcpy_n(subjects, it.subjects, ecs_entity_t, term_count);
+
+        int32_t *columns = ecs_vector_addn(
+            &cache->columns, int32_t, term_count);
+        ecs_os_memcpy_n(columns, it.columns, int32_t, term_count);
+    }
+
+    cache->version ++;
+    cache->valid = true;
+}
+
+/* Make sure cache is up to date. Returns false if the cache can't be used. */
+static
+bool rule_cache_update(
+    ecs_rule_t *rule)
+{
+    ecs_world_t *world = (ecs_world_t*)ecs_get_world(rule->world);
+    ecs_rule_cache_t *cache = &rule->cache;
+    int32_t table_generation = world->filter_cache.generation;
+    int64_t dirty_state;
+
+    /* The cache can't be refilled while iterators on other threads may be
+     * using it. When the world is readonly with a single stage, the only
+     * iterators are on the current thread. */
+    bool readonly = world->is_readonly && ecs_get_stage_count(world) > 1;
+
+    if (!rule_cache_dirty_state(rule, readonly, &dirty_state)) {
+        return false;
+    }
+
+    if (cache->valid && cache->table_generation == table_generation &&
+        cache->dirty_state == dirty_state)
+    {
+        return true;
+    }
+
+    if (readonly) {
+        return false;
+    }
+
+    rule_cache_fill(rule);
+    cache->table_generation = table_generation;
+    cache->dirty_state = dirty_state;
+
+    return true;
+}
+
+/* Return next result from rule cache */
+static
+bool rule_cache_next(
+    ecs_iter_t *it)
+{
+    ecs_rule_iter_t *iter = &it->priv.iter.rule;
+    const ecs_rule_t *rule = iter->rule;
+    const ecs_rule_cache_t *cache = &rule->cache;
+    ecs_check(cache->version == iter->cache_version, ECS_INVALID_OPERATION,
+        "rule cache was refilled while iterating");
+
+    int32_t i = iter->cache_index ++;
+
+    /* Cached results are distributed round-robin across workers */
+    if (iter->partition_count > 1) {
+        while (i % iter->partition_count != iter->partition_index) {
+            i = iter->cache_index ++;
+        }
+    }
+
+    if (i >= ecs_vector_count(cache->results)) {
+        iter->op = -1;
+        ecs_iter_fini(it);
+        return false;
+    }
+
+    int32_t var_count = rule->var_count;
+    int32_t term_count = rule->filter.term_count;
+    ecs_rule_result_t *result = ecs_vector_get(
+        cache->results, ecs_rule_result_t, i);
+
+    it->variables = iter->variables;
+    if (var_count) {
+        ecs_os_memcpy_n(it->variables, ecs_vector_get(cache->variables, 
+            ecs_entity_t, i * var_count), ecs_entity_t, var_count);
+    }
+
+    ecs_os_memcpy_n(it->ids, ecs_vector_get(cache->ids, 
+        ecs_id_t, i * term_count), ecs_id_t, term_count);
+    ecs_os_memcpy_n(it->subjects, ecs_vector_get(cache->subjects, 
+        ecs_entity_t, i * term_count), ecs_entity_t, term_count);
+
+    it->columns = rule_get_columns_frame(iter, 0);
+    ecs_os_memcpy_n(it->columns, ecs_vector_get(cache->columns, 
+        int32_t, i * term_count), int32_t, term_count);
+
+    flecs_iter_populate_data(rule->world, it, result->table, result->offset, 
+        result->count, it->ptrs, it->sizes);
+
+    return true;
+error:
+    return false;
+}
+
+/* Create rule iterator */
+ecs_iter_t ecs_rule_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    ecs_iter_t result = rule_iter(world, rule);
+
+    /* If rule is cached, iterator returns results from cache. The cache is
+     * logically part of the rule state, which is why it may be updated here */
+    if (rule->filter.cached && rule_cache_update((ecs_rule_t*)rule)) {
+        ecs_rule_iter_t *it = &result.priv.iter.rule;
+        it->cached = true;
+        it->cache_index = 0;
+        it->cache_version = rule->cache.version;
+    }
+
+    return result;
+}
+
+/* Create rule iterator for worker */
+ecs_iter_t ecs_rule_worker_iter(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule,
+    int32_t index,
+    int32_t count)
+{
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t result = ecs_rule_iter(world, rule);
+    ecs_rule_iter_t *it = &result.priv.iter.rule;
+    it->partition_index = index;
+    it->partition_count = count;
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
 /* Edge case: if the filter has the same variable for both predicate and
  * object, they are both resolved at the same time but at the time of 
  * evaluating the filter they're still wildcards which would match columns
@@ -3255,6 +3822,33 @@ ecs_table_record_t find_next_table(
 }
 
 
+/* Same as find_next_table, but skips tables that belong to other workers if
+ * the operation is used for partitioning. */
+static
+ecs_table_record_t find_next_partition_table(
+    ecs_rule_iter_t *iter,
+    int32_t op_index,
+    ecs_rule_filter_t *filter,
+    ecs_rule_with_ctx_t *op_ctx)
+{
+    bool partition = iter->partition_count > 1 && 
+        op_index == iter->rule->partition_op;
+
+    do {
+        ecs_table_record_t tr = find_next_table(filter, op_ctx);
+        if (!partition || !tr.hdr.table) {
+            return tr;
+        }
+
+        /* Tables are distributed round-robin across workers */
+        if ((op_ctx->table_index ++ % iter->partition_count) == 
+            iter->partition_index) 
+        {
+            return tr;
+        }
+    } while (true);
+}
+
 static
 ecs_id_record_t* find_tables(
     ecs_world_t *world,
@@ -3343,6 +3937,27 @@ bool eval_input(
     }
 }
 
+/* Yield next superset from closure index */
+static
+bool superset_closure_next(
+    const ecs_rule_t *rule,
+    ecs_rule_reg_t *regs,
+    int32_t r,
+    ecs_rule_superset_ctx_t *op_ctx)
+{
+    ecs_closure_elem_t *elem = op_ctx->closure;
+    int32_t index = op_ctx->closure_index;
+    if (index >= ecs_vector_count(elem->nodes)) {
+        return false;
+    }
+
+    ecs_closure_node_t *node = ecs_vector_get(
+        elem->nodes, ecs_closure_node_t, index);
+    reg_set_entity(rule, regs, r, node->entity);
+
+    return true;
+}
+
 static
 bool eval_superset(
     ecs_iter_t *it,
@@ -3399,6 +4014,16 @@ bool eval_superset(
             table = table_from_entity(world, obj).table;
         }
 
+        /* If the relation is indexed, iterate supersets from the closure */
+        op_ctx->closure = NULL;
+        if (!output_is_input && table) {
+            op_ctx->closure = flecs_closure_get_supersets(world, rel, table);
+            if (op_ctx->closure) {
+                op_ctx->closure_index = 0;
+                return superset_closure_next(rule, regs, r, op_ctx);
+            }
+        }
+
         int32_t column;
 
         /* If output variable is already set, check if it matches */
@@ -3434,6 +4059,9 @@ bool eval_superset(
         return true;
     } else if (output_is_input) {
         return false;
+    } else if (op_ctx->closure) {
+        op_ctx->closure_index ++;
+        return superset_closure_next(rule, regs, r, op_ctx);
     }
 
     sp = op_ctx->sp;
@@ -3473,6 +4101,30 @@ bool eval_superset(
     return false;
 }
 
+/* Yield next table with subsets from closure index */
+static
+bool subset_closure_next(
+    const ecs_rule_t *rule,
+    ecs_rule_reg_t *regs,
+    int32_t r,
+    int32_t term,
+    ecs_rule_subset_ctx_t *op_ctx)
+{
+    ecs_closure_elem_t *elem = op_ctx->closure;
+    int32_t index = op_ctx->closure_index;
+    if (index >= ecs_vector_count(elem->nodes)) {
+        return false;
+    }
+
+    ecs_closure_table_t *node = ecs_vector_get(
+        elem->nodes, ecs_closure_table_t, index);
+    table_reg_set(rule, regs, r, node->table);
+    set_term_vars(rule, regs, term, ecs_vector_get(node->table->type,
+        ecs_id_t, node->column)[0]);
+
+    return true;
+}
+
 static
 bool eval_subset(
     ecs_iter_t *it,
@@ -3500,6 +4152,19 @@ bool eval_subset(
     ecs_table_t *table = NULL;
 
     if (!redo) {
+        /* If the relation is indexed, iterate subsets from the closure */
+        op_ctx->closure = NULL;
+        if (!filter.same_var && ECS_HAS_ROLE(filter.mask, PAIR) && 
+            !ecs_id_is_wildcard(filter.mask)) 
+        {
+            op_ctx->closure = flecs_closure_get_subsets(world, 
+                ECS_PAIR_FIRST(filter.mask), ECS_PAIR_SECOND(filter.mask));
+            if (op_ctx->closure) {
+                op_ctx->closure_index = 0;
+                return subset_closure_next(rule, regs, r, op->term, op_ctx);
+            }
+        }
+
         op_ctx->stack = op_ctx->storage;
         sp = op_ctx->sp = 0;
         frame = &op_ctx->stack[sp];
@@ -3520,6 +4185,9 @@ bool eval_subset(
         frame->column = table_record.column;
         table_reg_set(rule, regs, r, (frame->table = table_record.hdr.table));
         goto yield;
+    } else if (op_ctx->closure) {
+        op_ctx->closure_index ++;
+        return subset_closure_next(rule, regs, r, op->term, op_ctx);
     }
 
     do {
@@ -3679,6 +4347,12 @@ bool eval_select(
         ecs_assert(regs[r].table.table == iter->registers[r].table.table, 
             ECS_INTERNAL_ERROR, NULL);
 
+        /* A table set by the application can't be divided across workers, so
+         * only the first worker evaluates it */
+        if (iter->partition_index && op_index == rule->partition_op) {
+            return false;
+        }
+
         table = iter->registers[r].table.table;
 
         /* Check if table can be found in the id record. If not, the provided 
@@ -3695,9 +4369,11 @@ bool eval_select(
     if (!redo) {
         if (!table) {
             flecs_table_cache_iter(&idr->cache, &op_ctx->it);
+            op_ctx->table_index = 0;
 
             /* Return the first table_record in the table set. */
-            table_record = find_next_table(&filter, op_ctx);
+            table_record = find_next_partition_table(
+                iter, op_index, &filter, op_ctx);
         
             /* If no table record was found, there are no results. */
             if (!table_record.hdr.table) {
@@ -3732,7 +4408,8 @@ bool eval_select(
                 return false;
             }
 
-            table_record = find_next_table(&filter, op_ctx);
+            table_record = find_next_partition_table(
+                iter, op_index, &filter, op_ctx);
             if (!table_record.hdr.table) {
                 return false;
             }
@@ -4392,6 +5069,35 @@ void populate_iterator(
         iter->ptrs, iter->sizes);
 }
 
+/* Number of rows produced by an operation, used for profiling */
+static
+int64_t op_row_count(
+    const ecs_rule_t *rule,
+    ecs_rule_iter_t *it,
+    ecs_rule_op_t *op)
+{
+    int32_t r = UINT8_MAX;
+    if (op->has_out) {
+        r = op->r_out;
+    } else if (op->has_in) {
+        r = op->r_in;
+    }
+
+    if (r == UINT8_MAX || rule->vars[r].kind != EcsRuleVarKindTable) {
+        return 1;
+    }
+
+    ecs_rule_reg_t *regs = get_register_frame(it, op->frame);
+    ecs_table_slice_t slice = table_reg_get(rule, regs, r);
+    if (slice.count) {
+        return slice.count;
+    } else if (slice.table) {
+        return ecs_table_count(slice.table);
+    }
+
+    return 0;
+}
+
 static
 bool is_control_flow(
     ecs_rule_op_t *op)
@@ -4441,6 +5147,18 @@ bool ecs_rule_next_instanced(
 
     flecs_iter_init(it);
 
+    if (iter->cached) {
+        return rule_cache_next(it);
+    }
+
+    /* If the program has no operation that can be divided across workers, the
+     * first worker evaluates the entire program */
+    if (iter->partition_index && rule->partition_op == -1) {
+        iter->op = -1;
+        ecs_iter_fini(it);
+        return false;
+    }
+
     /* Make sure that if there are any terms with literal subjects, they're
      * initialized in the subjects array */
     if (init_subjects) {
@@ -4489,6 +5207,11 @@ bool ecs_rule_next_instanced(
         bool result = eval_op(it, op, op_index, redo);
         iter->op = result ? op->on_pass : op->on_fail;
 
+        /* Yield returns false to make the program backtrack */
+        if (iter->profile && (result || op->kind == EcsRuleYield)) {
+            iter->profile[op_index] += op_row_count(rule, iter, op);
+        }
+
         /* If the current operation is yield, return results */
         if (op->kind == EcsRuleYield) {
             populate_iterator(rule, it, iter, op);
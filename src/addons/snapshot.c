@@ -32,6 +32,10 @@ ecs_data_t* duplicate_data(
 
     ecs_data_t *result = ecs_os_calloc(ECS_SIZEOF(ecs_data_t));
 
+    /* Columns are allocated from the world, as restoring the snapshot moves
+     * them into the table */
+    ecs_allocator_t *a = &((ecs_world_t*)world)->allocator;
+
     ecs_type_t storage_type = table->storage_type;
     int32_t i, column_count = ecs_vector_count(storage_type);
     ecs_entity_t *components = ecs_vector_first(storage_type, ecs_entity_t);
@@ -60,8 +64,9 @@ ecs_data_t* duplicate_data(
 
         if (cdata && (copy = cdata->lifecycle.copy)) {
             int32_t count = ecs_vector_count(column->data);
-            ecs_vector_t *dst_vec = ecs_vector_new_t(size, alignment, count);
-            ecs_vector_set_count_t(&dst_vec, size, alignment, count);
+            ecs_vector_t *dst_vec = flecs_vector_new_t(
+                a, size, alignment, count);
+            flecs_vector_set_count_t(a, &dst_vec, size, alignment, count);
             void *dst_ptr = ecs_vector_first_t(dst_vec, size, alignment);
             void *ctx = cdata->lifecycle.ctx;
             
@@ -77,7 +82,8 @@ ecs_data_t* duplicate_data(
 
             column->data = dst_vec;
         } else {
-            column->data = ecs_vector_copy_t(column->data, size, alignment);
+            column->data = flecs_vector_copy_t(
+                a, column->data, size, alignment);
         }
     }
 
@@ -317,6 +323,9 @@ void restore_filtered(
             ecs_entity_t e = entities[i];
             ecs_record_t *r = ecs_eis_get(world, e);
             if (r && r->table) {
+                if (r->table->flags & EcsTableHasClosure) {
+                    flecs_closure_table_dirty(world, r->table);
+                }
                 flecs_table_delete(world, r->table, &r->table->storage, 
                     ECS_RECORD_TO_ROW(r->row), true);
             } else {
@@ -331,6 +340,11 @@ void restore_filtered(
 
         flecs_table_merge(world, table, table, &table->storage, snapshot_table->data);
 
+        /* Restored entities can be pair objects */
+        if (table->flags & EcsTableHasClosure) {
+            flecs_closure_table_dirty(world, table);
+        }
+
         /* Run OnSet systems for merged entities */
         if (new_count) {
             flecs_notify_on_set(
@@ -136,6 +136,12 @@ void ecs_get_world_stats(
     record_counter(&s->merge_count_total, t, world->stats.merge_count_total);
     record_counter(&s->pipeline_build_count_total, t, world->stats.pipeline_build_count_total);
     record_counter(&s->systems_ran_frame, t, world->stats.systems_ran_frame);
+    record_gauge(&s->stack_page_count, t, world->stats.stack_page_count);
+    record_counter(&s->stack_alloc_count_total, t, 
+        world->stats.stack_alloc_count_total);
+    record_gauge(&s->pool_block_count, t, world->stats.pool_block_count);
+    record_counter(&s->pool_alloc_count_total, t, 
+        world->stats.pool_alloc_count_total);
 
     if (delta_world_time != 0.0f && delta_frame_count != 0.0f) {
         record_gauge(
@@ -162,6 +168,9 @@ void ecs_get_world_stats(
     int32_t empty_table_count = 0;
     int32_t singleton_table_count = 0;
     int32_t matched_table_count = 0, matched_entity_count = 0;
+    int32_t edge_count = 0, edge_memory = 0;
+
+    flecs_table_graph_memory(&world->store.root, &edge_count, &edge_memory);
 
     int32_t i, count = flecs_sparse_count(&world->store.tables);
     for (i = 0; i < count; i ++) {
@@ -169,6 +178,8 @@ void ecs_get_world_stats(
             ecs_table_t, i);
         int32_t entity_count = ecs_table_count(table);
 
+        flecs_table_graph_memory(table, &edge_count, &edge_memory);
+
         if (!entity_count) {
             empty_table_count ++;
         }
@@ -192,6 +203,8 @@ void ecs_get_world_stats(
     record_gauge(&s->table_count, t, count);
     record_gauge(&s->empty_table_count, t, empty_table_count);
     record_gauge(&s->singleton_table_count, t, singleton_table_count);
+    record_gauge(&s->table_edge_count, t, edge_count);
+    record_gauge(&s->table_edge_memory, t, edge_memory);
 
 error:
     return;
@@ -407,6 +420,8 @@ void ecs_dump_world_stats(
     print_gauge("table count", t, &s->table_count);
     print_gauge("singleton table count", t, &s->singleton_table_count);
     print_gauge("empty table count", t, &s->empty_table_count);
+    print_gauge("table edge count", t, &s->table_edge_count);
+    print_gauge("table edge memory", t, &s->table_edge_memory);
     printf("\n");
     print_counter("deferred new operations", t, &s->new_count);
     print_counter("deferred bulk_new operations", t, &s->bulk_new_count);
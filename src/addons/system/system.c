@@ -100,7 +100,8 @@ ecs_entity_t ecs_run_intern(
     ecs_entity_t system,
     EcsSystem *system_data,
     int32_t stage_current,
-    int32_t stage_count,    
+    int32_t stage_count,
+    int32_t *chunk_cursor,
     FLECS_FLOAT delta_time,
     int32_t offset,
     int32_t limit,
@@ -149,7 +150,17 @@ ecs_entity_t ecs_run_intern(
     ecs_defer_begin(thread_ctx);
 
     /* Prepare the query iterator */
-    ecs_iter_t pit, wit, qit = ecs_query_iter(thread_ctx, system_data->query);
+    ecs_iter_t pit, wit, qit;
+    bool multi_threaded = stage_count > 1 && system_data->multi_threaded;
+    if (multi_threaded && system_data->partition_groups) {
+        /* Each worker iterates its own groups of the query */
+        qit = ecs_query_group_worker_iter(thread_ctx, system_data->query,
+            stage_current, stage_count);
+        multi_threaded = false;
+    } else {
+        qit = ecs_query_iter(thread_ctx, system_data->query);
+    }
+
     ecs_iter_t *it = &qit;
 
     if (offset || limit) {
@@ -157,8 +168,14 @@ ecs_entity_t ecs_run_intern(
         it = &pit;
     }
 
-    if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_current, stage_count);
+    bool chunked = false;
+    if (multi_threaded) {
+        if (system_data->chunk_size && chunk_cursor) {
+            wit = ecs_chunk_iter(it, chunk_cursor, system_data->chunk_size);
+            chunked = true;
+        } else {
+            wit = ecs_worker_iter(it, stage_current, stage_count);
+        }
         it = &wit;
     }
 
@@ -189,6 +206,11 @@ ecs_entity_t ecs_run_intern(
         }
     }
 
+    /* A run callback may stop before all chunks are iterated */
+    if (chunked && wit.is_valid) {
+        ecs_iter_fini(&wit);
+    }
+
     if (measure_time) {
         system_data->time_spent += (float)ecs_time_measure(&time_start);
     }
@@ -216,8 +238,8 @@ ecs_entity_t ecs_run_w_filter(
         world, system, EcsSystem);
     assert(system_data != NULL);
 
-    return ecs_run_intern(world, stage, system, system_data, 0, 0, delta_time, 
-        offset, limit, param);
+    return ecs_run_intern(world, stage, system, system_data, 0, 0, NULL, 
+        delta_time, offset, limit, param);
 }
 
 ecs_entity_t ecs_run_worker(
@@ -235,7 +257,7 @@ ecs_entity_t ecs_run_worker(
     assert(system_data != NULL);
 
     return ecs_run_intern(
-        world, stage, system, system_data, stage_current, stage_count, 
+        world, stage, system, system_data, stage_current, stage_count, NULL,
         delta_time, 0, 0, param);
 }
 
@@ -416,6 +438,9 @@ ecs_entity_t ecs_system_init(
             return 0;
         }
 
+        ecs_check(!desc->partition_groups || query->group_by, 
+            ECS_INVALID_PARAMETER, "partition_groups requires group_by");
+
         /* Re-obtain pointer, as query may have added components */
         system = ecs_get_mut(world, result, EcsSystem, &added);
         ecs_assert(added == false, ECS_INTERNAL_ERROR, NULL);
@@ -443,6 +468,8 @@ ecs_entity_t ecs_system_init(
 
         system->multi_threaded = desc->multi_threaded;
         system->no_staging = desc->no_staging;
+        system->chunk_size = desc->chunk_size;
+        system->partition_groups = desc->partition_groups;
 
         /* If tables have been matched with this system it is active, and we
          * should activate the in terms, if any. This will ensure that any
@@ -544,6 +571,12 @@ ecs_entity_t ecs_system_init(
         if (desc->no_staging) {
             system->no_staging = desc->no_staging;
         }
+        if (desc->chunk_size) {
+            system->chunk_size = desc->chunk_size;
+        }
+        if (desc->partition_groups) {
+            system->partition_groups = desc->partition_groups;
+        }
     }
 
     return result;
@@ -17,6 +17,8 @@ typedef struct EcsSystem {
     /* Schedule parameters */
     bool multi_threaded;
     bool no_staging;
+    int32_t chunk_size;             /* See ecs_system_desc_t */
+    bool partition_groups;          /* See ecs_system_desc_t */
 
     int32_t invoke_count;           /* Number of times system is invoked */
     float time_spent;               /* Time spent on running system */
@@ -41,7 +43,9 @@ void ecs_system_activate(
     bool activate,
     const EcsSystem *system_data);
 
-/* Internal function to run a system */
+/* Internal function to run a system. If chunk_cursor is provided, multi threaded
+ * systems with a chunk size claim chunks from the cursor. The caller must reset
+ * the cursor after all workers finished running the system. */
 ecs_entity_t ecs_run_intern(
     ecs_world_t *world,
     ecs_stage_t *stage,
@@ -49,6 +53,7 @@ ecs_entity_t ecs_run_intern(
     EcsSystem *system_data,
     int32_t stage_current,
     int32_t stage_count,
+    int32_t *chunk_cursor,
     FLECS_FLOAT delta_time,
     int32_t offset,
     int32_t limit,
@@ -452,7 +452,8 @@ void _bootstrap_component(
         entity, record, false);
     record->row = ECS_ROW_TO_RECORD(index, 0);
 
-    EcsComponent *component = ecs_vector_first(columns[0].data, EcsComponent);
+    EcsComponent *component = ecs_vector_first_t(
+        columns[0].data, columns[0].size, columns[0].alignment);
     component[index].size = size;
     component[index].alignment = alignment;
 
@@ -460,14 +461,16 @@ void _bootstrap_component(
     ecs_size_t symbol_length = ecs_os_strlen(symbol);
     ecs_size_t name_length = symbol_length - 3;
 
-    EcsIdentifier *name_col = ecs_vector_first(columns[1].data, EcsIdentifier);
+    EcsIdentifier *name_col = ecs_vector_first_t(
+        columns[1].data, columns[1].size, columns[1].alignment);
     name_col[index].value = ecs_os_strdup(name);
     name_col[index].length = name_length;
     name_col[index].hash = flecs_hash(name, name_length);
     name_col[index].index_hash = 0;
     name_col[index].index = NULL;
 
-    EcsIdentifier *symbol_col = ecs_vector_first(columns[2].data, EcsIdentifier);
+    EcsIdentifier *symbol_col = ecs_vector_first_t(
+        columns[2].data, columns[2].size, columns[2].alignment);
     symbol_col[index].value = ecs_os_strdup(symbol);
     symbol_col[index].length = symbol_length;
     symbol_col[index].hash = flecs_hash(symbol, symbol_length);    
@@ -530,9 +533,10 @@ ecs_table_t* bootstrap_component_table(
     data->entities = ecs_vector_new(ecs_entity_t, EcsFirstUserComponentId);
     data->record_ptrs = ecs_vector_new(ecs_record_t*, EcsFirstUserComponentId);
 
-    data->columns[0].data = ecs_vector_new(EcsComponent, EcsFirstUserComponentId);
-    data->columns[1].data = ecs_vector_new(EcsIdentifier, EcsFirstUserComponentId);
-    data->columns[2].data = ecs_vector_new(EcsIdentifier, EcsFirstUserComponentId);
+    ecs_allocator_t *a = &world->allocator;
+    data->columns[0].data = flecs_vector_new(a, EcsComponent, EcsFirstUserComponentId);
+    data->columns[1].data = flecs_vector_new(a, EcsIdentifier, EcsFirstUserComponentId);
+    data->columns[2].data = flecs_vector_new(a, EcsIdentifier, EcsFirstUserComponentId);
     
     return result;
 }
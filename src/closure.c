@@ -0,0 +1,413 @@
+#include "private_api.h"
+
+static
+ecs_closure_t* closure_get(
+    const ecs_world_t *world,
+    ecs_entity_t relation)
+{
+    if (!ecs_map_count(&world->closures)) {
+        return NULL;
+    }
+
+    return ecs_map_get_ptr(&world->closures, ecs_closure_t*,
+        ecs_entity_t_lo(relation));
+}
+
+static
+void closure_elems_free(
+    ecs_map_t *elems)
+{
+    ecs_map_iter_t it = ecs_map_iter(elems);
+    ecs_closure_elem_t *elem;
+    while ((elem = ecs_map_next_ptr(&it, ecs_closure_elem_t*, NULL))) {
+        ecs_vector_free(elem->nodes);
+        ecs_os_free(elem);
+    }
+
+    ecs_map_fini(elems);
+}
+
+static
+void closure_free(
+    ecs_closure_t *closure)
+{
+    closure_elems_free(&closure->supersets);
+    closure_elems_free(&closure->subsets);
+    ecs_os_free(closure);
+}
+
+/* Get element for key. If the element doesn't exist or is out of date, it is
+ * cleared and must be filled by the caller. */
+static
+ecs_closure_elem_t* closure_elem_get(
+    const ecs_world_t *world,
+    ecs_closure_t *closure,
+    ecs_map_t *elems,
+    uint64_t key,
+    bool *fill)
+{
+    ecs_closure_elem_t *elem = ecs_map_get_ptr(elems, ecs_closure_elem_t*, key);
+    if (elem && elem->generation == closure->generation) {
+        *fill = false;
+        return elem;
+    }
+
+    /* Index can't be modified while iterating in readonly mode, as multiple
+     * threads could be accessing it. With a single stage, the only iterators
+     * are on the current thread. */
+    if (world->is_readonly && ecs_get_stage_count(world) > 1) {
+        return NULL;
+    }
+
+    if (!elem) {
+        elem = ecs_os_calloc_t(ecs_closure_elem_t);
+        ecs_map_set_ptr(elems, key, elem);
+    }
+
+    ecs_vector_clear(elem->nodes);
+    elem->generation = closure->generation;
+    elem->pruned = false;
+    *fill = true;
+
+    return elem;
+}
+
+/* Returns true if key was visited before, marks key as visited otherwise */
+static
+bool closure_visit(
+    ecs_map_t *visited,
+    uint64_t key)
+{
+    if (ecs_map_has(visited, key)) {
+        return true;
+    }
+
+    ecs_map_ensure(visited, bool, key);
+    return false;
+}
+
+/* Add supersets of table in the same order in which they are visited when
+ * walking the relation depth first. Each superset is added once, which
+ * prevents infinite recursion for cycles. Supersets that can be reached by more
+ * than one path are only added for the first path. */
+static
+void closure_fill_supersets(
+    const ecs_world_t *world,
+    ecs_closure_elem_t *elem,
+    ecs_map_t *visited,
+    ecs_closure_t *closure,
+    const ecs_table_t *table,
+    int32_t depth)
+{
+    ecs_vector_t **nodes = &elem->nodes;
+    ecs_table_record_t *tr = flecs_get_table_record(world, table,
+        ecs_pair(closure->relation, EcsWildcard));
+    if (!tr) {
+        return;
+    }
+
+    ecs_id_t *ids = ecs_vector_first(table->type, ecs_id_t);
+    int32_t i, end = tr->column + tr->count;
+
+    for (i = tr->column; i < end; i ++) {
+        ecs_entity_t obj = ECS_PAIR_SECOND(ids[i]);
+        ecs_assert(obj != 0, ECS_INTERNAL_ERROR, NULL);
+
+        if (closure_visit(visited, obj)) {
+            elem->pruned = true;
+            continue;
+        }
+
+        int32_t index = ecs_vector_count(*nodes);
+        ecs_closure_node_t *node = ecs_vector_add(nodes, ecs_closure_node_t);
+        node->entity = obj;
+        node->depth = depth;
+
+        ecs_record_t *r = ecs_eis_get_any(world, obj);
+        if (r && r->table) {
+            closure_fill_supersets(
+                world, elem, visited, closure, r->table, depth + 1);
+        }
+
+        node = ecs_vector_get(*nodes, ecs_closure_node_t, index);
+        node->end = ecs_vector_count(*nodes);
+    }
+}
+
+/* Add non-empty tables with (relation, entity), each followed by the tables
+ * of the subsets of the entities in the table. Tables and entities are visited
+ * once, which prevents infinite recursion for cycles and prevents adding a 
+ * table more than once if it has pairs for more than one entity. */
+static
+void closure_fill_subsets(
+    const ecs_world_t *world,
+    ecs_closure_elem_t *elem,
+    ecs_map_t *visited,
+    ecs_closure_t *closure,
+    ecs_entity_t entity)
+{
+    ecs_id_record_t *idr = flecs_get_id_record(world,
+        ecs_pair(closure->relation, entity));
+    if (!idr) {
+        return;
+    }
+
+    ecs_table_cache_iter_t it;
+    if (!flecs_table_cache_iter(&idr->cache, &it)) {
+        return;
+    }
+
+    const ecs_table_record_t *tr;
+    while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+        ecs_table_t *table = tr->hdr.table;
+
+        /* Table ids and entity ids can overlap, so use a key that can't be
+         * an entity id for tables */
+        if (closure_visit(visited, ecs_pair(EcsWildcard, table->id))) {
+            elem->pruned = true;
+            continue;
+        }
+
+        ecs_closure_table_t *node = ecs_vector_add(
+            &elem->nodes, ecs_closure_table_t);
+        node->table = table;
+        node->column = tr->column;
+
+        ecs_entity_t *entities = ecs_vector_first(
+            table->storage.entities, ecs_entity_t);
+        int32_t i, count = ecs_table_count(table);
+        for (i = 0; i < count; i ++) {
+            ecs_entity_t e = entities[i];
+            if (closure_visit(visited, e)) {
+                elem->pruned = true;
+                continue;
+            }
+
+            closure_fill_subsets(world, elem, visited, closure, e);
+        }
+    }
+}
+
+static
+void closure_mark_tables(
+    ecs_world_t *world,
+    ecs_entity_t relation)
+{
+    ecs_id_record_t *idr = flecs_get_id_record(world,
+        ecs_pair(relation, EcsWildcard));
+    if (!idr) {
+        return;
+    }
+
+    ecs_table_cache_iter_t it;
+    const ecs_table_record_t *tr;
+
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            tr->hdr.table->flags |= EcsTableHasClosure;
+        }
+    }
+
+    if (flecs_table_cache_empty_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            tr->hdr.table->flags |= EcsTableHasClosure;
+        }
+    }
+}
+
+void flecs_closure_init(
+    ecs_world_t *world)
+{
+    ecs_map_init(&world->closures, ecs_closure_t*, 0);
+}
+
+void flecs_closure_fini(
+    ecs_world_t *world)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->closures);
+    ecs_closure_t *closure;
+    while ((closure = ecs_map_next_ptr(&it, ecs_closure_t*, NULL))) {
+        closure_free(closure);
+    }
+
+    ecs_map_fini(&world->closures);
+}
+
+bool flecs_closure_is_indexed(
+    const ecs_world_t *world,
+    ecs_entity_t relation)
+{
+    return closure_get(world, relation) != NULL;
+}
+
+void flecs_closure_table_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->closures);
+    ecs_closure_t *closure;
+    while ((closure = ecs_map_next_ptr(&it, ecs_closure_t*, NULL))) {
+        if (flecs_get_table_record(world, table,
+            ecs_pair(closure->relation, EcsWildcard)))
+        {
+            closure->generation ++;
+        }
+    }
+}
+
+/* Returns true if ids contain a pair for an indexed relation */
+static
+bool closure_has_indexed_pair(
+    const ecs_world_t *world,
+    const ecs_ids_t *ids)
+{
+    int32_t i, count = ids->count;
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids->array[i];
+        if (ECS_HAS_ROLE(id, PAIR) && closure_get(world, ECS_PAIR_FIRST(id))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void flecs_closure_entity_move(
+    ecs_world_t *world,
+    ecs_table_t *src_table,
+    ecs_table_t *dst_table,
+    uint32_t row_flags,
+    const ecs_table_diff_t *diff)
+{
+    bool src_closure = src_table && (src_table->flags & EcsTableHasClosure);
+    bool dst_closure = dst_table && (dst_table->flags & EcsTableHasClosure);
+    if (!src_closure && !dst_closure) {
+        return;
+    }
+
+    /* Adding an entity to or removing it from a table that stays non-empty
+     * doesn't change which tables are in a closure. The closure only changes
+     * when the entity gains or loses pairs for the relation, or when it is the
+     * object of a pair, in which case tables in the closure may depend on the
+     * table of the entity. Tables that become empty or non-empty are handled
+     * when the table administration is updated. */
+    if (!(row_flags & ECS_FLAG_OBSERVED_OBJECT) && (!diff || 
+        (!closure_has_indexed_pair(world, &diff->added) && 
+         !closure_has_indexed_pair(world, &diff->removed))))
+    {
+        return;
+    }
+
+    if (src_closure) {
+        flecs_closure_table_dirty(world, src_table);
+    }
+    if (dst_closure) {
+        flecs_closure_table_dirty(world, dst_table);
+    }
+}
+
+void flecs_closure_table_free(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_map_iter_t it = ecs_map_iter(&world->closures);
+    ecs_closure_t *closure;
+    while ((closure = ecs_map_next_ptr(&it, ecs_closure_t*, NULL))) {
+        /* Table id can be recycled, so remove the supersets of the table */
+        ecs_closure_elem_t *elem = ecs_map_get_ptr(
+            &closure->supersets, ecs_closure_elem_t*, table->id);
+        if (elem) {
+            ecs_vector_free(elem->nodes);
+            ecs_os_free(elem);
+            ecs_map_remove(&closure->supersets, table->id);
+        }
+
+        /* Subsets may contain the table */
+        if (table->flags & EcsTableHasClosure) {
+            closure->generation ++;
+        }
+    }
+}
+
+ecs_closure_elem_t* flecs_closure_get_supersets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    const ecs_table_t *table)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_closure_t *closure = closure_get(world, relation);
+    if (!closure) {
+        return NULL;
+    }
+
+    bool fill;
+    ecs_closure_elem_t *elem = closure_elem_get(
+        world, closure, &closure->supersets, table->id, &fill);
+    if (elem && fill) {
+        ecs_map_t visited;
+        ecs_map_init(&visited, bool, 0);
+        closure_fill_supersets(world, elem, &visited, closure, table, 1);
+        ecs_map_fini(&visited);
+    }
+
+    return elem;
+}
+
+ecs_closure_elem_t* flecs_closure_get_subsets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    ecs_entity_t entity)
+{
+    ecs_closure_t *closure = closure_get(world, relation);
+    if (!closure) {
+        return NULL;
+    }
+
+    bool fill;
+    ecs_closure_elem_t *elem = closure_elem_get(
+        world, closure, &closure->subsets, ecs_entity_t_lo(entity), &fill);
+    if (elem && fill) {
+        ecs_map_t visited;
+        ecs_map_init(&visited, bool, 0);
+        closure_visit(&visited, entity);
+        closure_fill_subsets(world, elem, &visited, closure, entity);
+        ecs_map_fini(&visited);
+    }
+
+    return elem;
+}
+
+bool ecs_enable_closure_index(
+    ecs_world_t *world,
+    ecs_entity_t relation,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(relation != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!world->is_readonly, ECS_INVALID_OPERATION, NULL);
+
+    ecs_closure_t *closure = closure_get(world, relation);
+    bool prev = closure != NULL;
+
+    if (enable && !closure) {
+        closure = ecs_os_calloc_t(ecs_closure_t);
+        closure->relation = relation;
+        ecs_map_init(&closure->supersets, ecs_closure_elem_t*, 0);
+        ecs_map_init(&closure->subsets, ecs_closure_elem_t*, 0);
+        ecs_map_set_ptr(&world->closures, ecs_entity_t_lo(relation), closure);
+
+        /* Tables created after this are marked when they're initialized */
+        closure_mark_tables(world, relation);
+    } else if (!enable && closure) {
+        /* Table flags are not reset, as tables can have pairs for more than
+         * one indexed relation. Stale flags only add a lookup when the table
+         * changes. */
+        ecs_map_remove(&world->closures, ecs_entity_t_lo(relation));
+        closure_free(closure);
+    }
+
+    return prev;
+error:
+    return false;
+}
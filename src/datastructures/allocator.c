@@ -0,0 +1,236 @@
+#include "../private_api.h"
+
+#define ECS_BLOCK_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_block_allocator_block_t), 16)
+
+static
+void ballocator_add_block(
+    ecs_block_allocator_t *ba)
+{
+    ecs_size_t chunk_size = ba->chunk_size;
+    int32_t i, chunk_count = ba->chunks_per_block;
+
+    ecs_block_allocator_block_t *block = ecs_os_malloc(
+        ECS_BLOCK_OFFSET + chunk_size * chunk_count);
+    ecs_assert(block != NULL, ECS_OUT_OF_MEMORY, NULL);
+    block->next = ba->blocks;
+    ba->blocks = block;
+    ba->block_count ++;
+
+    /* Add chunks to free list in address order */
+    ecs_block_allocator_chunk_t *first = ECS_OFFSET(block, ECS_BLOCK_OFFSET);
+    ecs_block_allocator_chunk_t *chunk = first;
+    for (i = 0; i < chunk_count - 1; i ++) {
+        chunk->next = ECS_OFFSET(chunk, chunk_size);
+        chunk = chunk->next;
+    }
+
+    chunk->next = ba->head;
+    ba->head = first;
+}
+
+void flecs_ballocator_init(
+    ecs_block_allocator_t *ba,
+    ecs_size_t chunk_size)
+{
+    ecs_assert(ba != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_os_zeromem(ba);
+    ba->chunk_size = ECS_ALIGN(chunk_size, 16);
+    ba->chunks_per_block = ECS_MAX(
+        ECS_BLOCK_ALLOCATOR_BLOCK_SIZE / ba->chunk_size, 1);
+}
+
+void flecs_ballocator_fini(
+    ecs_block_allocator_t *ba)
+{
+    ecs_assert(ba != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_block_allocator_block_t *next, *cur = ba->blocks;
+    while (cur) {
+        next = cur->next;
+        ecs_os_free(cur);
+        cur = next;
+    }
+
+    ba->head = NULL;
+    ba->blocks = NULL;
+    ba->block_count = 0;
+    ba->alloc_count = 0;
+}
+
+void* flecs_balloc(
+    ecs_block_allocator_t *ba)
+{
+    if (!ba->head) {
+        ballocator_add_block(ba);
+    }
+
+    ecs_block_allocator_chunk_t *result = ba->head;
+    ba->head = result->next;
+    ba->alloc_count ++;
+
+    return result;
+}
+
+void flecs_bfree(
+    ecs_block_allocator_t *ba,
+    void *ptr)
+{
+    ecs_assert(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(ba->alloc_count > 0, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_block_allocator_chunk_t *chunk = ptr;
+    chunk->next = ba->head;
+    ba->head = chunk;
+    ba->alloc_count --;
+}
+
+/* Get the size class for an allocation. Sizes up to 32 bytes use a class of 16
+ * or 32 bytes, after that each power of 2 is split in two classes. */
+static
+int32_t allocator_class(
+    ecs_size_t size)
+{
+    if (size <= 32) {
+        return size > 16;
+    }
+
+    int32_t index = 2;
+    ecs_size_t pow = 64;
+    while (pow < size) {
+        pow *= 2;
+        index += 2;
+    }
+
+    return index + 1 - (size <= ((pow >> 1) + (pow >> 2)));
+}
+
+static
+ecs_size_t allocator_class_size(
+    int32_t index)
+{
+    if (index < 2) {
+        return 16 << index;
+    }
+
+    ecs_size_t pow = 64 << ((index - 2) >> 1);
+    if (index & 1) {
+        return pow;
+    } else {
+        return (pow >> 1) + (pow >> 2);
+    }
+}
+
+void flecs_allocator_init(
+    ecs_allocator_t *a)
+{
+    ecs_assert(a != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(allocator_class_size(ECS_ALLOCATOR_CLASS_COUNT - 1) ==
+        ECS_ALLOCATOR_MAX_SIZE, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i;
+    for (i = 0; i < ECS_ALLOCATOR_CLASS_COUNT; i ++) {
+        flecs_ballocator_init(&a->classes[i], allocator_class_size(i));
+    }
+
+    a->block_count = 0;
+    a->alloc_count = 0;
+}
+
+void flecs_allocator_fini(
+    ecs_allocator_t *a)
+{
+    ecs_assert(a != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t i;
+    for (i = 0; i < ECS_ALLOCATOR_CLASS_COUNT; i ++) {
+        flecs_ballocator_fini(&a->classes[i]);
+    }
+
+    a->block_count = 0;
+    a->alloc_count = 0;
+}
+
+void* flecs_alloc(
+    ecs_allocator_t *a,
+    ecs_size_t size)
+{
+    ecs_assert(size > 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!a || size > ECS_ALLOCATOR_MAX_SIZE) {
+        void *result = ecs_os_malloc(size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+        return result;
+    }
+
+    ecs_block_allocator_t *ba = &a->classes[allocator_class(size)];
+    int32_t block_count = ba->block_count;
+    void *result = flecs_balloc(ba);
+    a->block_count += ba->block_count - block_count;
+    a->alloc_count ++;
+    return result;
+}
+
+void* flecs_calloc(
+    ecs_allocator_t *a,
+    ecs_size_t size)
+{
+    if (!a || size > ECS_ALLOCATOR_MAX_SIZE) {
+        void *result = ecs_os_calloc(size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+        return result;
+    }
+
+    void *result = flecs_alloc(a, size);
+    ecs_os_memset(result, 0, size);
+    return result;
+}
+
+void flecs_free(
+    ecs_allocator_t *a,
+    ecs_size_t size,
+    void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    if (!a || size > ECS_ALLOCATOR_MAX_SIZE) {
+        ecs_os_free(ptr);
+        return;
+    }
+
+    flecs_bfree(&a->classes[allocator_class(size)], ptr);
+}
+
+void* flecs_realloc(
+    ecs_allocator_t *a,
+    ecs_size_t dst_size,
+    ecs_size_t src_size,
+    void *ptr)
+{
+    if (!ptr) {
+        return flecs_alloc(a, dst_size);
+    }
+
+    if (!a || (dst_size > ECS_ALLOCATOR_MAX_SIZE &&
+        src_size > ECS_ALLOCATOR_MAX_SIZE))
+    {
+        void *result = ecs_os_realloc(ptr, dst_size);
+        ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+        return result;
+    }
+
+    if (dst_size <= ECS_ALLOCATOR_MAX_SIZE &&
+        src_size <= ECS_ALLOCATOR_MAX_SIZE &&
+        allocator_class(dst_size) == allocator_class(src_size))
+    {
+        return ptr;
+    }
+
+    void *result = flecs_alloc(a, dst_size);
+    ecs_os_memcpy(result, ptr, ECS_MIN(dst_size, src_size));
+    flecs_free(a, src_size, ptr);
+    return result;
+}
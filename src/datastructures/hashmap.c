@@ -1,23 +1,92 @@
 #include "../private_api.h"
 
+#define HM_ELEM_ALIGN (8)
+
+static
+ecs_hm_elem_t* hm_elem(
+    const ecs_hashmap_t *map,
+    int32_t index)
+{
+    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(index < ecs_vector_count(map->elems), ECS_INTERNAL_ERROR, NULL);
+    return ECS_OFFSET(ecs_vector_first_t(map->elems, map->elem_size,
+        HM_ELEM_ALIGN), map->elem_size * index);
+}
+
+static
+void* hm_elem_key(
+    ecs_hm_elem_t *elem)
+{
+    return ECS_OFFSET(elem, ECS_SIZEOF(ecs_hm_elem_t));
+}
+
+static
+void* hm_elem_value(
+    const ecs_hashmap_t *map,
+    ecs_hm_elem_t *elem)
+{
+    return ECS_OFFSET(elem, map->value_offset);
+}
+
+/* Get index of first element with hash */
+static
+int32_t hm_first(
+    const ecs_hashmap_t *map,
+    uint64_t hash)
+{
+    int32_t *first = ecs_map_get(&map->impl, int32_t, hash);
+    if (!first) {
+        return -1;
+    }
+    return *first;
+}
+
+/* Find element for key, starting from the first element with the hash of the
+ * key. Elements with a different hash are never compared with the key. */
 static
 int32_t find_key(
     const ecs_hashmap_t *map,
-    ecs_vector_t *keys,
-    ecs_size_t key_size, 
+    int32_t index,
+    uint64_t hash,
     const void *key)
 {
-    int32_t i, count = ecs_vector_count(keys);
-    void *key_array = ecs_vector_first_t(keys, key_size, 8);
-    for (i = 0; i < count; i ++) {
-        void *key_ptr = ECS_OFFSET(key_array, key_size * i);
-        if (map->compare(key_ptr, key) == 0) {
-            return i;
+    (void)hash;
+    while (index != -1) {
+        ecs_hm_elem_t *elem = hm_elem(map, index);
+        ecs_assert(elem->hash == hash, ECS_INTERNAL_ERROR, NULL);
+        if (map->compare(hm_elem_key(elem), key) == 0) {
+            return index;
         }
+        index = elem->next;
     }
+
     return -1;
 }
 
+/* Replace reference to element in list of elements with hash */
+static
+void relink(
+    ecs_hashmap_t *map,
+    uint64_t hash,
+    int32_t from,
+    int32_t to)
+{
+    int32_t *first = ecs_map_get(&map->impl, int32_t, hash);
+    ecs_assert(first != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (*first == from) {
+        *first = to;
+        return;
+    }
+
+    ecs_hm_elem_t *prev = hm_elem(map, *first);
+    while (prev->next != from) {
+        prev = hm_elem(map, prev->next);
+    }
+
+    prev->next = to;
+}
+
 void _flecs_hashmap_init(
     ecs_hashmap_t *map,
     ecs_size_t key_size,
@@ -27,22 +96,22 @@ void _flecs_hashmap_init(
 {
     map->key_size = key_size;
     map->value_size = value_size;
+    map->value_offset = ECS_SIZEOF(ecs_hm_elem_t) +
+        ECS_ALIGN(key_size, HM_ELEM_ALIGN);
+    map->elem_size = map->value_offset +
+        ECS_ALIGN(value_size, HM_ELEM_ALIGN);
     map->hash = hash;
     map->compare = compare;
-    ecs_map_init(&map->impl, ecs_hm_bucket_t, 0);
+    map->elems = NULL;
+    ecs_map_init(&map->impl, int32_t, 0);
 }
 
 void flecs_hashmap_fini(
     ecs_hashmap_t *map)
 {
-    ecs_map_iter_t it = ecs_map_iter(&map->impl);
-    ecs_hm_bucket_t *bucket;
-    while ((bucket = ecs_map_next(&it, ecs_hm_bucket_t, NULL))) {
-        ecs_vector_free(bucket->keys);
-        ecs_vector_free(bucket->values);
-    }
-
     ecs_map_fini(&map->impl);
+    ecs_vector_free(map->elems);
+    map->elems = NULL;
 }
 
 void flecs_hashmap_copy(
@@ -52,17 +121,12 @@ void flecs_hashmap_copy(
     if (dst != src) {
         *dst = *src;
     }
-    
+
     ecs_map_t *impl = ecs_map_copy(&dst->impl);
     dst->impl = *impl;
     ecs_os_free(impl);
 
-    ecs_map_iter_t it = ecs_map_iter(&dst->impl);
-    ecs_hm_bucket_t *bucket;
-    while ((bucket = ecs_map_next(&it, ecs_hm_bucket_t, NULL))) {
-        bucket->keys = ecs_vector_copy_t(bucket->keys, dst->key_size, 8);
-        bucket->values = ecs_vector_copy_t(bucket->values, dst->value_size, 8);
-    }
+    dst->elems = ecs_vector_copy_t(dst->elems, dst->elem_size, HM_ELEM_ALIGN);
 }
 
 void* _flecs_hashmap_get(
@@ -73,19 +137,16 @@ void* _flecs_hashmap_get(
 {
     ecs_assert(map->key_size == key_size, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
+    (void)value_size;
 
     uint64_t hash = map->hash(key);
-    ecs_hm_bucket_t *bucket = ecs_map_get(&map->impl, ecs_hm_bucket_t, hash);
-    if (!bucket) {
-        return NULL;
-    }
-
-    int32_t index = find_key(map, bucket->keys, key_size, key);
+    int32_t index = find_key(map, hm_first(map, hash), hash, key);
     if (index == -1) {
         return NULL;
     }
 
-    return ecs_vector_get_t(bucket->values, value_size, 8, index);
+    return hm_elem_value(map, hm_elem(map, index));
 }
 
 flecs_hashmap_result_t _flecs_hashmap_ensure(
@@ -98,36 +159,28 @@ flecs_hashmap_result_t _flecs_hashmap_ensure(
     ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
 
     uint64_t hash = map->hash(key);
-    ecs_hm_bucket_t *bucket = ecs_map_ensure(&map->impl, ecs_hm_bucket_t, hash);
-    ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
-
-    void *value_ptr, *key_ptr;
-
-    ecs_vector_t *keys = bucket->keys;
-    if (!keys) {
-        bucket->keys = ecs_vector_new_t(key_size, 8, 1);
-        bucket->values = ecs_vector_new_t(value_size, 8, 1);
-        key_ptr = ecs_vector_add_t(&bucket->keys, key_size, 8);
-        ecs_os_memcpy(key_ptr, key, key_size);
-        value_ptr = ecs_vector_add_t(&bucket->values, value_size, 8);
-        ecs_os_memset(value_ptr, 0, value_size);
+    ecs_hm_elem_t *elem;
+
+    int32_t first = hm_first(map, hash);
+    int32_t index = find_key(map, first, hash, key);
+    if (index != -1) {
+        elem = hm_elem(map, index);
     } else {
-        int32_t index = find_key(map, keys, key_size, key);
-        if (index == -1) {
-            key_ptr = ecs_vector_add_t(&bucket->keys, key_size, 8);
-            ecs_os_memcpy(key_ptr, key, key_size);
-            value_ptr = ecs_vector_add_t(&bucket->values, value_size, 8);
-            ecs_assert(value_ptr != NULL, ECS_INTERNAL_ERROR, NULL);
-            ecs_os_memset(value_ptr, 0, value_size);
-        } else {
-            key_ptr = ecs_vector_get_t(bucket->keys, key_size, 8, index);
-            value_ptr = ecs_vector_get_t(bucket->values, value_size, 8, index);
-        }
+        /* Insert element at the start of the elements with the same hash */
+        index = ecs_vector_count(map->elems);
+        elem = ecs_vector_add_t(&map->elems, map->elem_size, HM_ELEM_ALIGN);
+        ecs_assert(elem != NULL, ECS_INTERNAL_ERROR, NULL);
+        elem->hash = hash;
+        elem->next = first;
+        ecs_os_memcpy(hm_elem_key(elem), key, key_size);
+        ecs_os_memset(hm_elem_value(map, elem), 0, value_size);
+
+        ecs_map_set(&map->impl, hash, &index);
     }
 
     return (flecs_hashmap_result_t){
-        .key = key_ptr,
-        .value = value_ptr,
+        .key = hm_elem_key(elem),
+        .value = hm_elem_value(map, elem),
         .hash = hash
     };
 }
@@ -144,28 +197,69 @@ void _flecs_hashmap_set(
     ecs_os_memcpy(value_ptr, value, value_size);
 }
 
-ecs_hm_bucket_t* flecs_hashmap_get_bucket(
+int32_t flecs_hashmap_get_index(
     const ecs_hashmap_t *map,
     uint64_t hash)
 {
     ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
-    return ecs_map_get(&map->impl, ecs_hm_bucket_t, hash);
+    return hm_first(map, hash);
+}
+
+int32_t flecs_hashmap_next_index(
+    const ecs_hashmap_t *map,
+    int32_t index)
+{
+    ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
+    return hm_elem(map, index)->next;
+}
+
+void* _flecs_hashmap_key_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t key_size,
+    int32_t index)
+{
+    ecs_assert(map->key_size == key_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
+    return hm_elem_key(hm_elem(map, index));
 }
 
-void flecs_hm_bucket_remove(
+void* _flecs_hashmap_value_at(
+    const ecs_hashmap_t *map,
+    ecs_size_t value_size,
+    int32_t index)
+{
+    ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)value_size;
+    return hm_elem_value(map, hm_elem(map, index));
+}
+
+void flecs_hashmap_remove_index(
     ecs_hashmap_t *map,
-    ecs_hm_bucket_t *bucket,
-    uint64_t hash,
     int32_t index)
 {
-    ecs_vector_remove_t(bucket->keys, map->key_size, 8, index);
-    ecs_vector_remove_t(bucket->values, map->value_size, 8, index);
+    ecs_hm_elem_t *elem = hm_elem(map, index);
+    uint64_t hash = elem->hash;
 
-    if (!ecs_vector_count(bucket->keys)) {
-        ecs_vector_free(bucket->keys);
-        ecs_vector_free(bucket->values);
+    /* Remove element from list of elements with the same hash */
+    if (hm_first(map, hash) == index && elem->next == -1) {
         ecs_map_remove(&map->impl, hash);
+    } else {
+        relink(map, hash, index, elem->next);
     }
+
+    /* The last element is moved to the index of the removed element */
+    int32_t last = ecs_vector_count(map->elems) - 1;
+    if (last != index) {
+        relink(map, hm_elem(map, last)->hash, last, index);
+    }
+
+    ecs_vector_remove_t(map->elems, map->elem_size, HM_ELEM_ALIGN, index);
+}
+
+int32_t flecs_hashmap_count(
+    const ecs_hashmap_t *map)
+{
+    return ecs_vector_count(map->elems);
 }
 
 void _flecs_hashmap_remove_w_hash(
@@ -177,19 +271,15 @@ void _flecs_hashmap_remove_w_hash(
 {
     ecs_assert(map->key_size == key_size, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
     (void)value_size;
 
-    ecs_hm_bucket_t *bucket = ecs_map_get(&map->impl, ecs_hm_bucket_t, hash);
-    if (!bucket) {
-        return;
-    }
-
-    int32_t index = find_key(map, bucket->keys, key_size, key);
+    int32_t index = find_key(map, hm_first(map, hash), hash, key);
     if (index == -1) {
         return;
     }
 
-    flecs_hm_bucket_remove(map, bucket, hash, index);
+    flecs_hashmap_remove_index(map, index);
 }
 
 void _flecs_hashmap_remove(
@@ -209,7 +299,7 @@ flecs_hashmap_iter_t flecs_hashmap_iter(
     ecs_hashmap_t *map)
 {
     return (flecs_hashmap_iter_t){
-        .it = ecs_map_iter(&map->impl)
+        .map = map
     };
 }
 
@@ -219,19 +309,24 @@ void* _flecs_hashmap_next(
     void *key_out,
     ecs_size_t value_size)
 {
-    int32_t index = ++ it->index;
-    ecs_hm_bucket_t *bucket = it->bucket;
-    while (!bucket || it->index >= ecs_vector_count(bucket->keys)) {
-        bucket = it->bucket = ecs_map_next(&it->it, ecs_hm_bucket_t, NULL);
-        if (!bucket) {
-            return NULL;
-        }
-        index = it->index = 0;
+    ecs_hashmap_t *map = it->map;
+    ecs_assert(!key_out || map->key_size == key_size,
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(map->value_size == value_size, ECS_INVALID_PARAMETER, NULL);
+    (void)key_size;
+    (void)value_size;
+
+    int32_t index = it->index;
+    if (index >= ecs_vector_count(map->elems)) {
+        return NULL;
     }
 
+    it->index = index + 1;
+
+    ecs_hm_elem_t *elem = hm_elem(map, index);
     if (key_out) {
-        *(void**)key_out = ecs_vector_get_t(bucket->keys, key_size, 8, index);
+        *(void**)key_out = hm_elem_key(elem);
     }
-    
-    return ecs_vector_get_t(bucket->values, value_size, 8, index);
+
+    return hm_elem_value(map, elem);
 }
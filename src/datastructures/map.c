@@ -1,28 +1,145 @@
 #include "../private_api.h"
-#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLECS_MAP_SSE2
+#endif
 
 /* The ratio used to determine whether the map should rehash. If
- * (element_count * LOAD_FACTOR) > bucket_count, bucket count is increased. */
+ * (element_count * LOAD_FACTOR) > slot_count, slot count is increased. */
 #define LOAD_FACTOR (1.5f)
 #define KEY_SIZE (ECS_SIZEOF(ecs_map_key_t))
 #define GET_ELEM(array, elem_size, index) \
     ECS_OFFSET(array, (elem_size) * (index))
 
+/* Number of slots for which control bytes are tested at the same time */
+#define GROUP_SIZE (16)
+
+/* Control byte values. The control byte of a slot with an element contains 7
+ * bits of the key hash, and therefore never has the high bit set. Sentinels
+ * pad the control bytes of maps with less slots than GROUP_SIZE. */
+#define CTRL_EMPTY ((uint8_t)0x80)
+#define CTRL_DELETED ((uint8_t)0xFE)
+#define CTRL_SENTINEL ((uint8_t)0xFF)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MAP_NOINLINE __attribute__((noinline))
+#else
+#define MAP_NOINLINE
+#endif
+
+#ifdef FLECS_MAP_SSE2
+
+/* Get mask with a bit set for each slot in group with control byte h2 */
+static
+uint32_t group_match(
+    const uint8_t *ctrl,
+    uint8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8((char)h2), group));
+}
+
+/* Get mask with a bit set for each empty or deleted slot in group. These are
+ * the only control bytes that are smaller than the sentinel when signed. */
+static
+uint32_t group_match_free(
+    const uint8_t *ctrl)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpgt_epi8(_mm_set1_epi8((char)CTRL_SENTINEL), group));
+}
+
+/* Get mask with a bit set for each slot in group that has an element */
 static
-uint8_t ecs_log2(uint32_t v) {
-    static const uint8_t log2table[32] = 
-        {0, 9,  1,  10, 13, 21, 2,  29, 11, 14, 16, 18, 22, 25, 3, 30,
-         8, 12, 20, 28, 15, 17, 24, 7,  19, 27, 23, 6,  26, 5,  4, 31};
+uint32_t group_match_full(
+    const uint8_t *ctrl)
+{
+    __m128i group = _mm_loadu_si128((const __m128i*)ctrl);
+    return ~(uint32_t)_mm_movemask_epi8(group) & 0xFFFF;
+}
+
+#else
 
-    v |= v >> 1;
-    v |= v >> 2;
-    v |= v >> 4;
-    v |= v >> 8;
-    v |= v >> 16;
-    return log2table[(uint32_t)(v * 0x07C4ACDDU) >> 27];
+static
+uint32_t group_match(
+    const uint8_t *ctrl,
+    uint8_t h2)
+{
+    uint32_t result = 0;
+    int32_t i;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)(ctrl[i] == h2) << i;
+    }
+    return result;
+}
+
+static
+uint32_t group_match_free(
+    const uint8_t *ctrl)
+{
+    uint32_t result = 0;
+    int32_t i;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)(ctrl[i] == CTRL_EMPTY ||
+            ctrl[i] == CTRL_DELETED) << i;
+    }
+    return result;
+}
+
+static
+uint32_t group_match_full(
+    const uint8_t *ctrl)
+{
+    uint32_t result = 0;
+    int32_t i;
+    for (i = 0; i < GROUP_SIZE; i ++) {
+        result |= (uint32_t)!(ctrl[i] & CTRL_EMPTY) << i;
+    }
+    return result;
+}
+
+#endif
+
+static
+uint32_t group_match_empty(
+    const uint8_t *ctrl)
+{
+    return group_match(ctrl, CTRL_EMPTY);
+}
+
+/* Get index of lowest bit that is set */
+static
+int32_t map_ctz(
+    uint32_t v)
+{
+    ecs_assert(v != 0, ECS_INTERNAL_ERROR, NULL);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(v);
+#else
+    int32_t result = 0;
+    while (!(v & 1)) {
+        v >>= 1;
+        result ++;
+    }
+    return result;
+#endif
+}
+
+/* Mix bits of key, as keys (like entity ids) often only differ in a few bits.
+ * The multiplication moves the entropy of the key to the upper bits. The top
+ * bits select the home slot, and 7 bits from the middle of the hash are stored
+ * in the control byte. */
+static
+uint64_t map_hash(
+    ecs_map_key_t key)
+{
+    return key * 0x9e3779b97f4a7c15ull;
 }
 
-/* Get bucket count for number of elements */
+/* Get slot count for number of elements */
 static
 int32_t get_bucket_count(
     int32_t element_count)
@@ -30,219 +147,304 @@ int32_t get_bucket_count(
     return flecs_next_pow_of_2((int32_t)((float)element_count * LOAD_FACTOR));
 }
 
-/* Get bucket shift amount for a given bucket count */
 static
-uint8_t get_bucket_shift (
-    int32_t bucket_count)
+int32_t get_group_mask(
+    const ecs_map_t *map)
 {
-    return (uint8_t)(64u - ecs_log2((uint32_t)bucket_count));
+    if (map->slot_count <= GROUP_SIZE) {
+        return 0;
+    }
+    return map->slot_count / GROUP_SIZE - 1;
 }
 
-/* Get bucket index for provided map key */
+/* Get hash bits stored in the control byte of a slot */
 static
-int32_t get_bucket_index(
-    const ecs_map_t *map,
-    uint16_t bucket_shift,
-    ecs_map_key_t key) 
+uint8_t get_h2(
+    uint64_t hash)
 {
-    ecs_assert(bucket_shift != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(map->bucket_shift == bucket_shift, ECS_INTERNAL_ERROR, NULL);
-    (void)map;
-    return (int32_t)((11400714819323198485ull * key) >> bucket_shift);
+    return (uint8_t)((hash >> 32) & 0x7F);
 }
 
-/* Get bucket for key */
+/* Get home slot of hash. Elements are stored in their home slot when it is
+ * free, which allows most lookups to test a single key. */
 static
-ecs_bucket_t* get_bucket(
+int32_t get_home_slot(
     const ecs_map_t *map,
-    ecs_map_key_t key)
+    uint64_t hash)
 {
-    ecs_assert(map->bucket_shift == get_bucket_shift(map->bucket_count), 
-        ECS_INTERNAL_ERROR, NULL);
-    int32_t bucket_id = get_bucket_index(map, map->bucket_shift, key);
-    ecs_assert(bucket_id < map->bucket_count, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
+    return (int32_t)(hash >> (64 - map_ctz((uint32_t)map->slot_count)));
 }
 
-/* Ensure that map has at least new_count buckets */
+/* Size of the control bytes, padded to a whole group */
 static
-void ensure_buckets(
-    ecs_map_t *map,
-    int32_t new_count)
+ecs_size_t get_ctrl_size(
+    int32_t slot_count)
 {
-    int32_t bucket_count = map->bucket_count;
-    new_count = flecs_next_pow_of_2(new_count);
-    if (new_count < 2) {
-        new_count = 2;
-    }
-
-    if (new_count && new_count > bucket_count) {
-        map->buckets = ecs_os_realloc(map->buckets, new_count * ECS_SIZEOF(ecs_bucket_t));
-        map->bucket_count = new_count;
-        map->bucket_shift = get_bucket_shift(new_count);
-        ecs_os_memset(
-            ECS_OFFSET(map->buckets, bucket_count * ECS_SIZEOF(ecs_bucket_t)), 
-            0, (new_count - bucket_count) * ECS_SIZEOF(ecs_bucket_t));
-    }
+    return ECS_MAX(slot_count, GROUP_SIZE);
 }
 
-/* Free contents of bucket */
+/* Size of the bitset that marks home slots for which an element is stored in
+ * another slot, padded to a multiple of 16 bytes. Flags are not cleared when
+ * elements are removed, only when the map is rehashed. */
 static
-void clear_bucket(
-    ecs_bucket_t *bucket)
+ecs_size_t get_displaced_size(
+    int32_t slot_count)
 {
-    ecs_os_free(bucket->keys);
-    ecs_os_free(bucket->payload);
-    bucket->keys = NULL;
-    bucket->payload = NULL;
-    bucket->count = 0;
+    return ECS_MAX(slot_count / 8, 16);
 }
 
-/* Clear all buckets */
+/* Get bitset with displaced flags, which is stored after the control bytes */
 static
-void clear_buckets(
-    ecs_map_t *map)
+uint8_t* get_displaced(
+    const ecs_map_t *map)
 {
-    ecs_bucket_t *buckets = map->buckets;
-    int32_t i, count = map->bucket_count;
-    for (i = 0; i < count; i ++) {
-        clear_bucket(&buckets[i]);
-    }
-    ecs_os_free(buckets);
-    map->buckets = NULL;
-    map->bucket_count = 0;
+    return &map->ctrl[get_ctrl_size(map->slot_count)];
 }
 
-/* Find or create bucket for specified key */
+/* Test if an element with this home slot was stored in another slot */
 static
-ecs_bucket_t* ensure_bucket(
-    ecs_map_t *map,
-    ecs_map_key_t key)
+bool is_displaced(
+    const ecs_map_t *map,
+    int32_t home)
 {
-    ecs_assert(map->bucket_count >= 2, ECS_INTERNAL_ERROR, NULL);
-    int32_t bucket_id = get_bucket_index(map, map->bucket_shift, key);
-    ecs_assert(bucket_id >= 0, ECS_INTERNAL_ERROR, NULL);
-    return &map->buckets[bucket_id];
+    return (get_displaced(map)[home >> 3] & (1 << (home & 7))) != 0;
 }
 
-/* Add element to bucket */
+/* Find slot for key in groups, returns -1 if the key isn't found. Groups are 
+ * probed in triangular order, starting from the group of the home slot, which
+ * visits each group once when the number of groups is a power of 2. Probing 
+ * stops at a group with an empty slot, as an element is always inserted in the
+ * first group with a free slot. */
 static
-int32_t add_to_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
+int32_t map_probe(
+    const ecs_map_t *map,
     ecs_map_key_t key,
-    const void *payload)
+    uint64_t hash)
 {
-    int32_t index = bucket->count ++;
-    int32_t bucket_count = index + 1;
+    const uint8_t *ctrl = map->ctrl;
+    const ecs_map_key_t *keys = map->keys;
+    uint8_t h2 = get_h2(hash);
+    int32_t mask = get_group_mask(map);
+    int32_t group = get_home_slot(map, hash) / GROUP_SIZE;
+    int32_t step = 0;
 
-    bucket->keys = ecs_os_realloc(bucket->keys, KEY_SIZE * bucket_count);
-    bucket->keys[index] = key;
+    do {
+        int32_t first = group * GROUP_SIZE;
+        uint32_t match = group_match(&ctrl[first], h2);
+        while (match) {
+            int32_t slot = first + map_ctz(match);
+            if (keys[slot] == key) {
+                return slot;
+            }
+            match &= match - 1;
+        }
 
-    if (elem_size) {
-        bucket->payload = ecs_os_realloc(bucket->payload, elem_size * bucket_count);
-        if (payload) {
-            void *elem = GET_ELEM(bucket->payload, elem_size, index);
-            ecs_os_memcpy(elem, payload, elem_size);
+        if (group_match_empty(&ctrl[first])) {
+            return -1;
         }
-    } else {
-        bucket->payload = NULL;
-    }
 
-    return index;
+        group = (group + (++ step)) & mask;
+    } while (step <= mask);
+
+    return -1;
 }
 
-/*  Remove element from bucket */
+/* Find slot for key, returns -1 if the key isn't found. Only keys of which the
+ * home slot is marked as displaced require probing. */
 static
-void remove_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_size_t elem_size,
+int32_t map_find(
+    const ecs_map_t *map,
     ecs_map_key_t key,
-    int32_t index)
+    uint64_t hash)
 {
-    (void)key;
+    int32_t home = get_home_slot(map, hash);
+    if (map->keys[home] == key && map->ctrl[home] == get_h2(hash)) {
+        return home;
+    }
 
-    ecs_assert(bucket->count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(index < bucket->count, ECS_INTERNAL_ERROR, NULL);
-    
-    int32_t bucket_count = -- bucket->count;
+    if (!is_displaced(map, home)) {
+        return -1;
+    }
 
-    if (index != bucket->count) {
-        ecs_assert(key == bucket->keys[index], ECS_INTERNAL_ERROR, NULL);
-        bucket->keys[index] = bucket->keys[bucket_count];
+    return map_probe(map, key, hash);
+}
 
-        ecs_map_key_t *elem = GET_ELEM(bucket->payload, elem_size, index);
-        ecs_map_key_t *last_elem = GET_ELEM(bucket->payload, elem_size, bucket->count);
+/* Find free slot for hash. This is the home slot if it is empty or deleted.
+ * Otherwise the home slot is marked as displaced, and the element is stored in
+ * the neighbour of the home slot, or in the first empty or deleted slot of the
+ * probe sequence. The neighbour is in the same group as the home slot, so it is
+ * always found by probing. */
+static
+int32_t map_find_free(
+    ecs_map_t *map,
+    uint64_t hash)
+{
+    uint8_t *ctrl = map->ctrl;
+    int32_t home = get_home_slot(map, hash);
+    if (ctrl[home] & CTRL_EMPTY) {
+        return home;
+    }
 
-        ecs_os_memcpy(elem, last_elem, elem_size);
+    get_displaced(map)[home >> 3] |= (uint8_t)(1 << (home & 7));
+    if (ctrl[home ^ 1] & CTRL_EMPTY) {
+        return home ^ 1;
     }
+
+    int32_t mask = get_group_mask(map);
+    int32_t group = home / GROUP_SIZE;
+    int32_t step = 0;
+
+    do {
+        int32_t first = group * GROUP_SIZE;
+        uint32_t match = group_match_free(&ctrl[first]);
+        if (match) {
+            return first + map_ctz(match);
+        }
+
+        group = (group + (++ step)) & mask;
+    } while (step <= mask);
+
+    /* The load factor guarantees that there always is a free slot */
+    ecs_abort(ECS_INTERNAL_ERROR, NULL);
 }
 
-/* Get payload pointer for key from bucket */
+/* Size of the block with control bytes, keys and payload */
 static
-void* get_from_bucket(
-    ecs_bucket_t *bucket,
-    ecs_map_key_t key,
-    ecs_size_t elem_size)
+ecs_size_t map_alloc_size(
+    const ecs_map_t *map,
+    int32_t slot_count)
 {
-    ecs_map_key_t *keys = bucket->keys;
-    int32_t i, count = bucket->count;
-
-    for (i = 0; i < count; i ++) {
-        if (keys[i] == key) {
-            return GET_ELEM(bucket->payload, elem_size, i);
-        }
-    }
-    return NULL;
+    return get_ctrl_size(slot_count) + get_displaced_size(slot_count) +
+        (KEY_SIZE + map->elem_size) * slot_count;
 }
 
-/* Grow number of buckets */
+/* Allocate control bytes, displaced flags, keys and payload for slots in a 
+ * single block. The control bytes are padded to a whole group, so that a group
+ * can always be loaded. The padded control bytes, displaced flags and the key
+ * array are multiples of 16 bytes, which keeps the payload aligned. */
 static
-void rehash(
+void map_alloc(
     ecs_map_t *map,
-    int32_t bucket_count)
+    int32_t slot_count)
 {
-    ecs_assert(bucket_count != 0, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(bucket_count > map->bucket_count, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(slot_count >= 2, ECS_INTERNAL_ERROR, NULL);
 
-    ensure_buckets(map, bucket_count);
+    ecs_size_t ctrl_size = get_ctrl_size(slot_count);
+    ecs_size_t displaced_size = get_displaced_size(slot_count);
+    ecs_size_t keys_size = KEY_SIZE * slot_count;
+    uint8_t *ctrl = flecs_alloc(map->allocator, 
+        map_alloc_size(map, slot_count));
+    ecs_assert(ctrl != NULL, ECS_OUT_OF_MEMORY, NULL);
 
-    ecs_bucket_t *buckets = map->buckets;
-    ecs_assert(buckets != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_size_t elem_size = map->elem_size;
-    uint16_t bucket_shift = map->bucket_shift;
-    int32_t bucket_id;
+    ecs_os_memset(ctrl, CTRL_EMPTY, slot_count);
+    ecs_os_memset(&ctrl[slot_count], CTRL_SENTINEL, ctrl_size - slot_count);
+    ecs_os_memset(&ctrl[ctrl_size], 0, displaced_size);
 
-    /* Iterate backwards as elements could otherwise be moved to existing
-     * buckets which could temporarily cause the number of elements in a
-     * bucket to exceed BUCKET_COUNT. */
-    for (bucket_id = bucket_count - 1; bucket_id >= 0; bucket_id --) {
-        ecs_bucket_t *bucket = &buckets[bucket_id];
+    map->ctrl = ctrl;
+    map->keys = ECS_OFFSET(ctrl, ctrl_size + displaced_size);
+    map->payload = map->elem_size ? ECS_OFFSET(map->keys, keys_size) : NULL;
+    map->slot_count = slot_count;
+    map->deleted = 0;
+}
 
-        int i, count = bucket->count;
-        ecs_map_key_t *key_array = bucket->keys;
-        void *payload_array = bucket->payload;
+/* Free slots */
+static
+void map_free(
+    ecs_map_t *map)
+{
+    flecs_free(map->allocator, map_alloc_size(map, map->slot_count), 
+        map->ctrl);
+    map->ctrl = NULL;
+    map->keys = NULL;
+    map->payload = NULL;
+    map->slot_count = 0;
+    map->deleted = 0;
+}
 
-        for (i = 0; i < count; i ++) {
-            ecs_map_key_t key = key_array[i];
-            void *elem = GET_ELEM(payload_array, elem_size, i);
-            int32_t new_bucket_id = get_bucket_index(map, bucket_shift, key);
+/* Reinsert elements in new slots. This also removes deleted slots. */
+static
+void rehash(
+    ecs_map_t *map,
+    int32_t slot_count)
+{
+    ecs_assert(slot_count != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(slot_count >= map->slot_count, ECS_INTERNAL_ERROR, NULL);
 
-            if (new_bucket_id != bucket_id) {
-                ecs_bucket_t *new_bucket = &buckets[new_bucket_id];
+    uint8_t *old_ctrl = map->ctrl;
+    ecs_map_key_t *old_keys = map->keys;
+    void *old_payload = map->payload;
+    int32_t i, old_count = map->slot_count;
+    ecs_size_t elem_size = map->elem_size;
+    ecs_size_t old_size = map_alloc_size(map, old_count);
 
-                add_to_bucket(new_bucket, elem_size, key, elem);
-                remove_from_bucket(bucket, elem_size, key, i);
+    map_alloc(map, slot_count);
 
-                count --;
-                i --;
-            }
+    for (i = 0; i < old_count; i ++) {
+        if (old_ctrl[i] & CTRL_EMPTY) {
+            continue;
         }
 
-        if (!bucket->count) {
-            clear_bucket(bucket);
+        ecs_map_key_t key = old_keys[i];
+        uint64_t hash = map_hash(key);
+        int32_t slot = map_find_free(map, hash);
+        map->ctrl[slot] = get_h2(hash);
+        map->keys[slot] = key;
+        if (elem_size) {
+            ecs_os_memcpy(GET_ELEM(map->payload, elem_size, slot),
+                GET_ELEM(old_payload, elem_size, i), elem_size);
         }
     }
+
+    flecs_free(map->allocator, old_size, old_ctrl);
+}
+
+/* Add key that isn't in the map yet, returns slot */
+static
+int32_t map_insert(
+    ecs_map_t *map,
+    ecs_map_key_t key,
+    uint64_t hash)
+{
+    int32_t count = map->count + 1;
+    int32_t slot_count = get_bucket_count(count);
+    if (slot_count > map->slot_count) {
+        rehash(map, slot_count);
+    }
+
+    int32_t slot = map_find_free(map, hash);
+    if (map->ctrl[slot] == CTRL_DELETED) {
+        map->deleted --;
+    } else if ((count + map->deleted) >= map->slot_count) {
+        /* Filling the last empty slot would prevent probing from terminating,
+         * so remove deleted slots first */
+        rehash(map, map->slot_count);
+        slot = map_find_free(map, hash);
+    }
+
+    map->ctrl[slot] = get_h2(hash);
+    map->keys[slot] = key;
+    map->count = count;
+
+    return slot;
+}
+
+/* Remove element from slot. If the group of the slot has an empty slot, no
+ * probe sequence continues past the group, and the slot can be marked empty.
+ * Otherwise it must be marked as deleted, so that probing continues. */
+static
+void map_erase(
+    ecs_map_t *map,
+    int32_t slot)
+{
+    int32_t first = slot & ~(GROUP_SIZE - 1);
+    if (group_match_empty(&map->ctrl[first])) {
+        map->ctrl[slot] = CTRL_EMPTY;
+    } else {
+        map->ctrl[slot] = CTRL_DELETED;
+        map->deleted ++;
+    }
+
+    map->count --;
 }
 
 void _ecs_map_init(
@@ -254,8 +456,24 @@ void _ecs_map_init(
 
     result->count = 0;
     result->elem_size = (int16_t)elem_size;
+    result->allocator = NULL;
+
+    map_alloc(result, ECS_MAX(get_bucket_count(element_count), 2));
+}
+
+void _ecs_map_init_w_allocator(
+    ecs_map_t *result,
+    ecs_size_t elem_size,
+    int32_t element_count,
+    ecs_allocator_t *allocator)
+{
+    ecs_assert(elem_size < INT16_MAX, ECS_INVALID_PARAMETER, NULL);
+
+    result->count = 0;
+    result->elem_size = (int16_t)elem_size;
+    result->allocator = allocator;
 
-    ensure_buckets(result, get_bucket_count(element_count));
+    map_alloc(result, ECS_MAX(get_bucket_count(element_count), 2));
 }
 
 ecs_map_t* _ecs_map_new(
@@ -273,14 +491,14 @@ ecs_map_t* _ecs_map_new(
 bool ecs_map_is_initialized(
     const ecs_map_t *result)
 {
-    return result != NULL && result->bucket_count != 0;
+    return result != NULL && result->ctrl != NULL;
 }
 
 void ecs_map_fini(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INTERNAL_ERROR, NULL);
-    clear_buckets(map);
+    map_free(map);
 }
 
 void ecs_map_free(
@@ -292,6 +510,24 @@ void ecs_map_free(
     }
 }
 
+/* Lookup for key that is not in its home slot. This is kept out of the
+ * lookup function, so that a lookup in the home slot doesn't have to set up a
+ * stack frame. */
+static MAP_NOINLINE
+void* map_get_displaced(
+    const ecs_map_t *map,
+    ecs_size_t elem_size,
+    ecs_map_key_t key,
+    uint64_t hash)
+{
+    int32_t slot = map_probe(map, key, hash);
+    if (slot == -1) {
+        return NULL;
+    }
+
+    return GET_ELEM(map->payload, elem_size, slot);
+}
+
 void* _ecs_map_get(
     const ecs_map_t *map,
     ecs_size_t elem_size,
@@ -305,12 +541,22 @@ void* _ecs_map_get(
 
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    uint64_t hash = map_hash(key);
+    int32_t home = get_home_slot(map, hash);
+    if (map->keys[home] == key && map->ctrl[home] == get_h2(hash)) {
+        return GET_ELEM(map->payload, elem_size, home);
+    }
+
+    if (!is_displaced(map, home)) {
         return NULL;
     }
 
-    return get_from_bucket(bucket, key, elem_size);
+    int32_t next = home ^ 1;
+    if (map->keys[next] == key && map->ctrl[next] == get_h2(hash)) {
+        return GET_ELEM(map->payload, elem_size, next);
+    }
+
+    return map_get_displaced(map, elem_size, key, hash);
 }
 
 void* _ecs_map_get_ptr(
@@ -334,12 +580,7 @@ bool ecs_map_has(
         return false;
     }
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
-        return false;
-    }
-
-    return get_from_bucket(bucket, key, 0) != NULL;
+    return map_find(map, key, map_hash(key)) != -1;
 }
 
 void* _ecs_map_ensure(
@@ -367,30 +608,20 @@ void* _ecs_map_set(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(elem_size == map->elem_size, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(ecs_map_is_initialized(map), ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t *bucket = ensure_bucket(map, key);
-    ecs_assert(bucket != NULL, ECS_INTERNAL_ERROR, NULL);
-
-    void *elem = get_from_bucket(bucket, key, elem_size);
-    if (!elem) {
-        int32_t index = add_to_bucket(bucket, elem_size, key, payload);        
-        int32_t map_count = ++map->count;
-        int32_t target_bucket_count = get_bucket_count(map_count);
-        int32_t map_bucket_count = map->bucket_count;
-
-        if (target_bucket_count > map_bucket_count) {
-            rehash(map, target_bucket_count);
-            bucket = ensure_bucket(map, key);
-            return get_from_bucket(bucket, key, elem_size);
-        } else {
-            return GET_ELEM(bucket->payload, elem_size, index);
-        }       
-    } else {
-        if (payload) {
-            ecs_os_memcpy(elem, payload, elem_size);
-        }
-        return elem;
+    uint64_t hash = map_hash(key);
+    int32_t slot = map_find(map, key, hash);
+    if (slot == -1) {
+        slot = map_insert(map, key, hash);
     }
+
+    void *elem = GET_ELEM(map->payload, elem_size, slot);
+    if (payload && elem_size) {
+        ecs_os_memcpy(elem, payload, elem_size);
+    }
+
+    return elem;
 }
 
 int32_t ecs_map_remove(
@@ -399,17 +630,13 @@ int32_t ecs_map_remove(
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_bucket_t * bucket = get_bucket(map, key);
-    if (!bucket) {
+    if (!ecs_map_is_initialized(map)) {
         return map->count;
     }
 
-    int32_t i, bucket_count = bucket->count;
-    for (i = 0; i < bucket_count; i ++) {
-        if (bucket->keys[i] == key) {
-            remove_from_bucket(bucket, map->elem_size, key, i);
-            return --map->count;
-        }
+    int32_t slot = map_find(map, key, map_hash(key));
+    if (slot != -1) {
+        map_erase(map, slot);
     }
 
     return map->count;
@@ -424,16 +651,16 @@ int32_t ecs_map_count(
 int32_t ecs_map_bucket_count(
     const ecs_map_t *map)
 {
-    return map ? map->bucket_count : 0;
+    return map ? map->slot_count : 0;
 }
 
 void ecs_map_clear(
     ecs_map_t *map)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
-    clear_buckets(map);
+    map_free(map);
     map->count = 0;
-    ensure_buckets(map, 2);
+    map_alloc(map, 2);
 }
 
 ecs_map_iter_t ecs_map_iter(
@@ -441,9 +668,7 @@ ecs_map_iter_t ecs_map_iter(
 {
     return (ecs_map_iter_t){
         .map = map,
-        .bucket = NULL,
-        .bucket_index = 0,
-        .element_index = 0
+        .index = 0
     };
 }
 
@@ -452,47 +677,42 @@ void* _ecs_map_next(
     ecs_size_t elem_size,
     ecs_map_key_t *key_out)
 {
+    (void)elem_size;
+
     const ecs_map_t *map = iter->map;
     if (!ecs_map_is_initialized(map)) {
         return NULL;
     }
-    
-    ecs_assert(!elem_size || elem_size == map->elem_size, 
+
+    ecs_assert(!elem_size || elem_size == map->elem_size,
         ECS_INVALID_PARAMETER, NULL);
- 
-    ecs_bucket_t *bucket = iter->bucket;
-    int32_t element_index = iter->element_index;
-    elem_size = map->elem_size;
 
-    do {
-        if (!bucket) {
-            int32_t bucket_index = iter->bucket_index;
-            ecs_bucket_t *buckets = map->buckets;
-            if (bucket_index < map->bucket_count) {
-                bucket = &buckets[bucket_index];
-                iter->bucket = bucket;
-
-                element_index = 0;
-                iter->element_index = 0;
-            } else {
-                return NULL;
-            }
-        }
+    const uint8_t *ctrl = map->ctrl;
+    int32_t index = iter->index, slot_count = map->slot_count;
 
-        if (element_index < bucket->count) {
-            iter->element_index = element_index + 1;
+    while (index < slot_count) {
+        int32_t first = index & ~(GROUP_SIZE - 1);
+        uint32_t match = group_match_full(&ctrl[first]) &
+            (0xFFFFu << (index - first));
+        if (match) {
+            index = first + map_ctz(match);
             break;
-        } else {
-            bucket = NULL;
-            iter->bucket_index ++;
         }
-    } while (true);
-    
+        index = first + GROUP_SIZE;
+    }
+
+    if (index >= slot_count) {
+        iter->index = slot_count;
+        return NULL;
+    }
+
+    iter->index = index + 1;
+
     if (key_out) {
-        *key_out = bucket->keys[element_index];
+        *key_out = map->keys[index];
     }
 
-    return GET_ELEM(bucket->payload, elem_size, element_index);
+    return GET_ELEM(map->payload, map->elem_size, index);
 }
 
 void* _ecs_map_next_ptr(
@@ -508,27 +728,27 @@ void* _ecs_map_next_ptr(
 }
 
 void ecs_map_grow(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
 {
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
     int32_t target_count = map->count + element_count;
-    int32_t bucket_count = get_bucket_count(target_count);
+    int32_t slot_count = get_bucket_count(target_count);
 
-    if (bucket_count > map->bucket_count) {
-        rehash(map, bucket_count);
+    if (slot_count > map->slot_count) {
+        rehash(map, slot_count);
     }
 }
 
 void ecs_map_set_size(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t element_count)
-{    
+{
     ecs_assert(map != NULL, ECS_INVALID_PARAMETER, NULL);
-    int32_t bucket_count = get_bucket_count(element_count);
+    int32_t slot_count = get_bucket_count(element_count);
 
-    if (bucket_count) {
-        rehash(map, bucket_count);
+    if (slot_count > map->slot_count) {
+        rehash(map, slot_count);
     }
 }
 
@@ -553,7 +773,7 @@ ecs_map_t* ecs_map_copy(
 }
 
 void ecs_map_memory(
-    ecs_map_t *map, 
+    ecs_map_t *map,
     int32_t *allocd,
     int32_t *used)
 {
@@ -566,13 +786,11 @@ void ecs_map_memory(
     if (allocd) {
         *allocd += ECS_SIZEOF(ecs_map_t);
 
-        int i, bucket_count = map->bucket_count;
-        for (i = 0; i < bucket_count; i ++) {
-            ecs_bucket_t *bucket = &map->buckets[i];
-            *allocd += KEY_SIZE * bucket->count;
-            *allocd += map->elem_size * bucket->count;
+        int32_t slot_count = map->slot_count;
+        if (slot_count) {
+            *allocd += get_ctrl_size(slot_count);
+            *allocd += get_displaced_size(slot_count);
+            *allocd += (KEY_SIZE + map->elem_size) * slot_count;
         }
-
-        *allocd += ECS_SIZEOF(ecs_bucket_t) * bucket_count;
     }
 }
@@ -88,16 +88,10 @@ const uint64_t* flecs_name_index_find_ptr(
 {
     ecs_hashed_string_t hs = flecs_get_hashed_string(name, length, hash);
 
-    ecs_hm_bucket_t *b = flecs_hashmap_get_bucket(map, hs.hash);
-    if (!b) {
-        return NULL;
-    }
-
-    ecs_hashed_string_t *keys = ecs_vector_first(b->keys, ecs_hashed_string_t);
-    int32_t i, count = ecs_vector_count(b->keys);
-
-    for (i = 0; i < count; i ++) {
-        ecs_hashed_string_t *key = &keys[i];
+    int32_t i = flecs_hashmap_get_index(map, hs.hash);
+    for (; i != -1; i = flecs_hashmap_next_index(map, i)) {
+        ecs_hashed_string_t *key = flecs_hashmap_key_at(
+            map, ecs_hashed_string_t, i);
         ecs_assert(key->hash == hs.hash, ECS_INTERNAL_ERROR, NULL);
 
         if (hs.length != key->length) {
@@ -105,9 +99,7 @@ const uint64_t* flecs_name_index_find_ptr(
         }
 
         if (!ecs_os_strcmp(name, key->value)) {
-            uint64_t *e = ecs_vector_get(b->values, uint64_t, i);
-            ecs_assert(e != NULL, ECS_INTERNAL_ERROR, NULL);
-            return e;
+            return flecs_hashmap_value_at(map, uint64_t, i);
         }
     }
 
@@ -132,17 +124,10 @@ void flecs_name_index_remove(
     uint64_t e,
     uint64_t hash)
 {
-    ecs_hm_bucket_t *b = flecs_hashmap_get_bucket(map, hash);
-    if (!b) {
-        return;
-    }
-
-    uint64_t *ids = ecs_vector_first(b->values, uint64_t);
-    int32_t i, count = ecs_vector_count(b->values);
-
-    for (i = 0; i < count; i ++) {
-        if (ids[i] == e) {
-            flecs_hm_bucket_remove(map, b, hash, i);
+    int32_t i = flecs_hashmap_get_index(map, hash);
+    for (; i != -1; i = flecs_hashmap_next_index(map, i)) {
+        if (*flecs_hashmap_value_at(map, uint64_t, i) == e) {
+            flecs_hashmap_remove_index(map, i);
             break;
         }
     }
@@ -154,18 +139,15 @@ void flecs_name_index_update_name(
     uint64_t hash,
     const char *name)
 {
-    ecs_hm_bucket_t *b = flecs_hashmap_get_bucket(map, hash);
-    if (!b) {
+    int32_t i = flecs_hashmap_get_index(map, hash);
+    if (i == -1) {
         return;
     }
 
-    uint64_t *ids = ecs_vector_first(b->values, uint64_t);
-    int32_t i, count = ecs_vector_count(b->values);
-
-    for (i = 0; i < count; i ++) {
-        if (ids[i] == e) {
-            ecs_hashed_string_t *key = ecs_vector_get(
-                b->keys, ecs_hashed_string_t, i);
+    for (; i != -1; i = flecs_hashmap_next_index(map, i)) {
+        if (*flecs_hashmap_value_at(map, uint64_t, i) == e) {
+            ecs_hashed_string_t *key = flecs_hashmap_key_at(
+                map, ecs_hashed_string_t, i);
             key->value = (char*)name;
             ecs_assert(ecs_os_strlen(name) == key->length,
                 ECS_INTERNAL_ERROR, NULL);
@@ -44,12 +44,13 @@ chunk_t* chunk_new(
      * sparse element has not been paired with a dense element. Use zero
      * as this means we can take advantage of calloc having a possibly better 
      * performance than malloc + memset. */
-    result->sparse = ecs_os_calloc(ECS_SIZEOF(int32_t) * CHUNK_COUNT);
+    result->sparse = flecs_calloc(sparse->allocator, 
+        ECS_SIZEOF(int32_t) * CHUNK_COUNT);
 
     /* Initialize the data array with zero's to guarantee that data is 
      * always initialized. When an entry is removed, data is reset back to
      * zero. Initialize now, as this can take advantage of calloc. */
-    result->data = ecs_os_calloc(sparse->size * CHUNK_COUNT);
+    result->data = flecs_calloc(sparse->allocator, sparse->size * CHUNK_COUNT);
 
     ecs_assert(result->sparse != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(result->data != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -59,10 +60,12 @@ chunk_t* chunk_new(
 
 static
 void chunk_free(
+    ecs_sparse_t *sparse,
     chunk_t *chunk)
 {
-    ecs_os_free(chunk->sparse);
-    ecs_os_free(chunk->data);
+    ecs_allocator_t *a = sparse->allocator;
+    flecs_free(a, ECS_SIZEOF(int32_t) * CHUNK_COUNT, chunk->sparse);
+    flecs_free(a, sparse->size * CHUNK_COUNT, chunk->data);
 }
 
 static
@@ -309,6 +312,7 @@ void _flecs_sparse_init(
     result->size = size;
     result->max_id_local = UINT64_MAX;
     result->max_id = &result->max_id_local;
+    result->allocator = NULL;
 
     /* Consume first value in dense array as 0 is used in the sparse array to
      * indicate that a sparse element hasn't been paired yet. */
@@ -318,6 +322,15 @@ void _flecs_sparse_init(
     result->count = 1;
 }
 
+void _flecs_sparse_init_w_allocator(
+    ecs_sparse_t *result,
+    ecs_size_t size,
+    ecs_allocator_t *allocator)
+{
+    _flecs_sparse_init(result, size);
+    result->allocator = allocator;
+}
+
 ecs_sparse_t* _flecs_sparse_new(
     ecs_size_t size)
 {
@@ -342,7 +355,7 @@ void flecs_sparse_clear(
     ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
 
     ecs_vector_each(sparse->chunks, chunk_t, chunk, {
-        chunk_free(chunk);
+        chunk_free(sparse, chunk);
     });
 
     ecs_vector_free(sparse->chunks);
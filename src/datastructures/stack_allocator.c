@@ -0,0 +1,99 @@
+#include "../private_api.h"
+
+#define ECS_STACK_PAGE_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_stack_page_t), 16)
+
+static
+ecs_stack_page_t* stack_page_new(
+    ecs_stack_t *stack,
+    ecs_size_t size)
+{
+    ecs_stack_page_t *result = ecs_os_malloc(ECS_STACK_PAGE_OFFSET + size);
+    result->next = NULL;
+    result->size = size;
+    stack->page_count ++;
+    return result;
+}
+
+void flecs_stack_init(
+    ecs_stack_t *stack)
+{
+    ecs_os_zeromem(stack);
+}
+
+void flecs_stack_fini(
+    ecs_stack_t *stack)
+{
+    ecs_stack_page_t *next, *cur = stack->first;
+    while (cur) {
+        next = cur->next;
+        ecs_os_free(cur);
+        cur = next;
+    }
+    ecs_os_zeromem(stack);
+}
+
+void* flecs_stack_alloc(
+    ecs_stack_t *stack,
+    ecs_size_t size,
+    ecs_size_t align)
+{
+    ecs_assert(size > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(align > 0 && align <= 16, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_stack_page_t *page = stack->top.page;
+    ecs_size_t sp = stack->top.sp ? ECS_ALIGN(stack->top.sp, align) : 0;
+
+    if (!page || (sp + size) > page->size) {
+        /* Find next page that is large enough. Pages that are too small to
+         * hold the value are replaced, so that large values don't cause the
+         * allocator to skip over the remaining pages. */
+        ecs_stack_page_t **next_ptr = page ? &page->next : &stack->first;
+        ecs_stack_page_t *next = *next_ptr;
+        if (next && next->size < size) {
+            ecs_stack_page_t *after = next->next;
+            ecs_os_free(next);
+            stack->page_count --;
+            next = NULL;
+            *next_ptr = after;
+        }
+
+        if (!next) {
+            ecs_size_t page_size = ECS_STACK_PAGE_SIZE;
+            if (size > page_size) {
+                page_size = size;
+            }
+            next = stack_page_new(stack, page_size);
+            next->next = *next_ptr;
+            *next_ptr = next;
+        }
+
+        page = next;
+        sp = 0;
+    }
+
+    stack->top.page = page;
+    stack->top.sp = sp + size;
+    stack->alloc_count ++;
+
+    return ECS_OFFSET(page, ECS_STACK_PAGE_OFFSET + sp);
+}
+
+ecs_stack_cursor_t flecs_stack_get_cursor(
+    ecs_stack_t *stack)
+{
+    return stack->top;
+}
+
+void flecs_stack_restore_cursor(
+    ecs_stack_t *stack,
+    ecs_stack_cursor_t cursor)
+{
+    stack->top = cursor;
+}
+
+void flecs_stack_reset(
+    ecs_stack_t *stack)
+{
+    stack->top.page = NULL;
+    stack->top.sp = 0;
+}
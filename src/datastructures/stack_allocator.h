@@ -0,0 +1,54 @@
+/**
+ * @file stack_allocator.h
+ * @brief Data structure used for temporary small allocations.
+ *
+ * The stack allocator hands out memory from a list of fixed size pages. Memory
+ * is not freed per allocation, instead the allocator is reset to a previously
+ * obtained cursor, which releases everything that was allocated after it. 
+ * Pages are kept around after a reset so they can be reused.
+ */
+
+#ifndef FLECS_STACK_ALLOCATOR_H
+#define FLECS_STACK_ALLOCATOR_H
+
+#define ECS_STACK_PAGE_SIZE (4096)
+
+typedef struct ecs_stack_page_t {
+    struct ecs_stack_page_t *next;
+    ecs_size_t size;             /* Usable size of page */
+} ecs_stack_page_t;
+
+typedef struct ecs_stack_cursor_t {
+    ecs_stack_page_t *page;
+    ecs_size_t sp;
+} ecs_stack_cursor_t;
+
+typedef struct ecs_stack_t {
+    ecs_stack_page_t *first;
+    ecs_stack_cursor_t top;
+    int32_t page_count;          /* Number of allocated pages */
+    int32_t alloc_count;         /* Number of allocations served by stack */
+} ecs_stack_t;
+
+void flecs_stack_init(
+    ecs_stack_t *stack);
+
+void flecs_stack_fini(
+    ecs_stack_t *stack);
+
+void* flecs_stack_alloc(
+    ecs_stack_t *stack,
+    ecs_size_t size,
+    ecs_size_t align);
+
+ecs_stack_cursor_t flecs_stack_get_cursor(
+    ecs_stack_t *stack);
+
+void flecs_stack_restore_cursor(
+    ecs_stack_t *stack,
+    ecs_stack_cursor_t cursor);
+
+void flecs_stack_reset(
+    ecs_stack_t *stack);
+
+#endif
@@ -12,26 +12,29 @@ struct ecs_vector_t {
 /** Resize the vector buffer */
 static
 ecs_vector_t* resize(
+    ecs_allocator_t *a,
     ecs_vector_t *vector,
     int16_t offset,
+    int32_t old_size,
     int32_t size)
 {
-    ecs_vector_t *result = ecs_os_realloc(vector, offset + size);
+    ecs_vector_t *result = flecs_realloc(a, offset + size, offset + old_size, 
+        vector);
     ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, 0);
     return result;
 }
 
-/* -- Public functions -- */
+/* -- Allocator functions -- */
 
-ecs_vector_t* _ecs_vector_new(
+ecs_vector_t* _flecs_vector_new(
+    ecs_allocator_t *a,
     ecs_size_t elem_size,
     int16_t offset,
     int32_t elem_count)
 {
     ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
     
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
+    ecs_vector_t *result = flecs_alloc(a, offset + elem_size * elem_count);
     ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
 
     result->count = 0;
@@ -42,63 +45,20 @@ ecs_vector_t* _ecs_vector_new(
     return result;
 }
 
-ecs_vector_t* _ecs_vector_from_array(
-    ecs_size_t elem_size,
-    int16_t offset,
-    int32_t elem_count,
-    void *array)
-{
-    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
-    
-    ecs_vector_t *result =
-        ecs_os_malloc(offset + elem_size * elem_count);
-    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
-
-    ecs_os_memcpy(ECS_OFFSET(result, offset), array, elem_size * elem_count);
-
-    result->count = elem_count;
-    result->size = elem_count;
-#ifndef NDEBUG
-    result->elem_size = elem_size;
-#endif
-    return result;   
-}
-
-void ecs_vector_free(
-    ecs_vector_t *vector)
-{
-    ecs_os_free(vector);
-}
-
-void ecs_vector_clear(
-    ecs_vector_t *vector)
-{
-    if (vector) {
-        vector->count = 0;
-    }
-}
-
-void _ecs_vector_zero(
+void _flecs_vector_free(
+    ecs_allocator_t *a,
     ecs_vector_t *vector,
     ecs_size_t elem_size,
     int16_t offset)
 {
-    void *array = ECS_OFFSET(vector, offset);
-    ecs_os_memset(array, 0, elem_size * vector->count);
-}
-
-void ecs_vector_assert_size(
-    ecs_vector_t *vector,
-    ecs_size_t elem_size)
-{
-    (void)elem_size;
-    
     if (vector) {
         ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+        flecs_free(a, offset + elem_size * vector->size, vector);
     }
 }
 
-void* _ecs_vector_addn(
+void* _flecs_vector_addn(
+    ecs_allocator_t *a,
     ecs_vector_t **array_inout,
     ecs_size_t elem_size,
     int16_t offset,
@@ -107,12 +67,12 @@ void* _ecs_vector_addn(
     ecs_assert(array_inout != NULL, ECS_INTERNAL_ERROR, NULL);
     
     if (elem_count == 1) {
-        return _ecs_vector_add(array_inout, elem_size, offset);
+        return _flecs_vector_add(a, array_inout, elem_size, offset);
     }
     
     ecs_vector_t *vector = *array_inout;
     if (!vector) {
-        vector = _ecs_vector_new(elem_size, offset, 1);
+        vector = _flecs_vector_new(a, elem_size, offset, 1);
         *array_inout = vector;
     }
 
@@ -131,7 +91,8 @@ void* _ecs_vector_addn(
             }
         }
 
-        vector = resize(vector, offset, max_count * elem_size);
+        vector = resize(a, vector, offset, vector->size * elem_size, 
+            max_count * elem_size);
         vector->size = max_count;
         *array_inout = vector;
     }
@@ -141,7 +102,8 @@ void* _ecs_vector_addn(
     return ECS_OFFSET(vector, offset + elem_size * old_count);
 }
 
-void* _ecs_vector_add(
+void* _flecs_vector_add(
+    ecs_allocator_t *a,
     ecs_vector_t **array_inout,
     ecs_size_t elem_size,
     int16_t offset)
@@ -160,7 +122,8 @@ void* _ecs_vector_add(
             if (!size) {
                 size = 2;
             }
-            vector = resize(vector, offset, size * elem_size);
+            vector = resize(a, vector, offset, vector->size * elem_size, 
+                size * elem_size);
             *array_inout = vector;
             vector->size = size;
         }
@@ -169,13 +132,164 @@ void* _ecs_vector_add(
         return ECS_OFFSET(vector, offset + elem_size * count);
     }
 
-    vector = _ecs_vector_new(elem_size, offset, 2);
+    vector = _flecs_vector_new(a, elem_size, offset, 2);
     *array_inout = vector;
     vector->count = 1;
     vector->size = 2;
     return ECS_OFFSET(vector, offset);
 }
 
+int32_t _flecs_vector_set_size(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    ecs_vector_t *vector = *array_inout;
+
+    if (!vector) {
+        *array_inout = _flecs_vector_new(a, elem_size, offset, elem_count);
+        return elem_count;
+    } else {
+        ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+        int32_t result = vector->size;
+
+        if (elem_count < vector->count) {
+            elem_count = vector->count;
+        }
+
+        if (result < elem_count) {
+            elem_count = flecs_next_pow_of_2(elem_count);
+            vector = resize(a, vector, offset, result * elem_size, 
+                elem_count * elem_size);
+            vector->size = elem_count;
+            *array_inout = vector;
+            result = elem_count;
+        }
+
+        return result;
+    }
+}
+
+int32_t _flecs_vector_set_count(
+    ecs_allocator_t *a,
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    if (!*array_inout) {
+        *array_inout = _flecs_vector_new(a, elem_size, offset, elem_count);
+    }
+
+    ecs_dbg_assert((*array_inout)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+
+    (*array_inout)->count = elem_count;
+    ecs_size_t size = _flecs_vector_set_size(
+        a, array_inout, elem_size, offset, elem_count);
+    return size;
+}
+
+ecs_vector_t* _flecs_vector_copy(
+    ecs_allocator_t *a,
+    const ecs_vector_t *src,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    if (!src) {
+        return NULL;
+    }
+
+    ecs_vector_t *dst = _flecs_vector_new(a, elem_size, offset, src->size);
+    ecs_os_memcpy(dst, src, offset + elem_size * src->count);
+    return dst;
+}
+
+/* -- Public functions -- */
+
+ecs_vector_t* _ecs_vector_new(
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    return _flecs_vector_new(NULL, elem_size, offset, elem_count);
+}
+
+ecs_vector_t* _ecs_vector_from_array(
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count,
+    void *array)
+{
+    ecs_assert(elem_size != 0, ECS_INTERNAL_ERROR, NULL);
+    
+    ecs_vector_t *result =
+        ecs_os_malloc(offset + elem_size * elem_count);
+    ecs_assert(result != NULL, ECS_OUT_OF_MEMORY, NULL);
+
+    ecs_os_memcpy(ECS_OFFSET(result, offset), array, elem_size * elem_count);
+
+    result->count = elem_count;
+    result->size = elem_count;
+#ifndef NDEBUG
+    result->elem_size = elem_size;
+#endif
+    return result;   
+}
+
+void ecs_vector_free(
+    ecs_vector_t *vector)
+{
+    ecs_os_free(vector);
+}
+
+void ecs_vector_clear(
+    ecs_vector_t *vector)
+{
+    if (vector) {
+        vector->count = 0;
+    }
+}
+
+void _ecs_vector_zero(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    void *array = ECS_OFFSET(vector, offset);
+    ecs_os_memset(array, 0, elem_size * vector->count);
+}
+
+void ecs_vector_assert_size(
+    ecs_vector_t *vector,
+    ecs_size_t elem_size)
+{
+    (void)elem_size;
+    
+    if (vector) {
+        ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+void* _ecs_vector_addn(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset,
+    int32_t elem_count)
+{
+    return _flecs_vector_addn(NULL, array_inout, elem_size, offset, elem_count);
+}
+
+void* _ecs_vector_add(
+    ecs_vector_t **array_inout,
+    ecs_size_t elem_size,
+    int16_t offset)
+{
+    return _flecs_vector_add(NULL, array_inout, elem_size, offset);
+}
+
 void* _ecs_vector_insert_at(
     ecs_vector_t **vec,
     ecs_size_t elem_size,
@@ -292,7 +406,8 @@ void _ecs_vector_reclaim(
 
     if (count < size) {
         size = count;
-        vector = resize(vector, offset, size * elem_size);
+        vector = resize(NULL, vector, offset, vector->size * elem_size, 
+            size * elem_size);
         vector->size = size;
         *array_inout = vector;
     }
@@ -322,30 +437,8 @@ int32_t _ecs_vector_set_size(
     int16_t offset,
     int32_t elem_count)
 {
-    ecs_vector_t *vector = *array_inout;
-
-    if (!vector) {
-        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
-        return elem_count;
-    } else {
-        ecs_dbg_assert(vector->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-
-        int32_t result = vector->size;
-
-        if (elem_count < vector->count) {
-            elem_count = vector->count;
-        }
-
-        if (result < elem_count) {
-            elem_count = flecs_next_pow_of_2(elem_count);
-            vector = resize(vector, offset, elem_count * elem_size);
-            vector->size = elem_count;
-            *array_inout = vector;
-            result = elem_count;
-        }
-
-        return result;
-    }
+    return _flecs_vector_set_size(
+        NULL, array_inout, elem_size, offset, elem_count);
 }
 
 int32_t _ecs_vector_grow(
@@ -364,15 +457,8 @@ int32_t _ecs_vector_set_count(
     int16_t offset,
     int32_t elem_count)
 {
-    if (!*array_inout) {
-        *array_inout = _ecs_vector_new(elem_size, offset, elem_count);
-    }
-
-    ecs_dbg_assert((*array_inout)->elem_size == elem_size, ECS_INTERNAL_ERROR, NULL);
-
-    (*array_inout)->count = elem_count;
-    ecs_size_t size = _ecs_vector_set_size(array_inout, elem_size, offset, elem_count);
-    return size;
+    return _flecs_vector_set_count(
+        NULL, array_inout, elem_size, offset, elem_count);
 }
 
 void* _ecs_vector_first(
@@ -497,11 +583,5 @@ ecs_vector_t* _ecs_vector_copy(
     ecs_size_t elem_size,
     int16_t offset)
 {
-    if (!src) {
-        return NULL;
-    }
-
-    ecs_vector_t *dst = _ecs_vector_new(elem_size, offset, src->size);
-    ecs_os_memcpy(dst, src, offset + elem_size * src->count);
-    return dst;
+    return _flecs_vector_copy(NULL, src, elem_size, offset);
 }
@@ -272,6 +272,22 @@ error:
     return NULL;
 }
 
+static
+ecs_table_t* table_remove(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_id_t id,
+    ecs_table_diff_t *diff)
+{
+    ecs_table_diff_t temp_diff;
+    table = flecs_table_traverse_remove(world, table, &id, &temp_diff);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    diff_append(diff, &temp_diff);
+    return table;
+error:
+    return NULL;
+}
+
 static
 void notify(
     ecs_world_t *world,
@@ -416,15 +432,30 @@ void instantiate_children(
 
         /* Create children */
         int32_t child_row; 
-        new_w_data(world, i_table, NULL, &components, child_count, 
-            component_data, false, &child_row, &diff);
+        const ecs_entity_t *i_children = new_w_data(world, i_table, NULL, 
+            &components, child_count, component_data, false, &child_row, 
+            &diff);
         diff_free(&diff);
 
         /* If prefab child table has children itself, recursively instantiate */
-        ecs_data_t *i_data = &i_table->storage;
-        for (j = 0; j < child_count; j ++) {
-            ecs_entity_t child = children[j];
-            instantiate(world, child, i_table, i_data, child_row + j, 1);
+        if (!i_table->chunk_capacity) {
+            ecs_data_t *i_data = &i_table->storage;
+            for (j = 0; j < child_count; j ++) {
+                ecs_entity_t child = children[j];
+                instantiate(world, child, i_table, i_data, child_row + j, 1);
+            }
+        } else {
+            /* Children of a chunked table can be stored in different chunks.
+             * Copy the ids, as instantiating can create new entities. */
+            ecs_entity_t *i_ids = ecs_os_memdup_n(
+                i_children, ecs_entity_t, child_count);
+            for (j = 0; j < child_count; j ++) {
+                ecs_record_t *r = ecs_eis_get(world, i_ids[j]);
+                ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+                instantiate(world, children[j], r->table, &r->table->storage,
+                    (int32_t)ECS_RECORD_TO_ROW(r->row), 1);
+            }
+            ecs_os_free(i_ids);
         }
     }   
 error:
@@ -892,9 +923,16 @@ static
 void update_component_monitors(
     ecs_world_t *world,
     ecs_entity_t entity,
+    uint32_t row_flags,
     ecs_ids_t *added,
     ecs_ids_t *removed)
 {
+    /* If the entity is used as pair object, tables with the pair can start or
+     * stop matching cached filters that match components of supersets */
+    if (row_flags & ECS_FLAG_OBSERVED_OBJECT) {
+        flecs_filter_cache_invalidate_supersets(world);
+    }
+
     update_component_monitor_w_array(world, entity, 0, added);
     update_component_monitor_w_array(world, entity, 0, removed);
 }
@@ -927,9 +965,15 @@ void commit(
         return;
     }
 
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Entities are added to a chunk with space if the table is chunked */
+    if (dst_table->chunk_capacity) {
+        dst_table = flecs_table_chunk_for_append(world, dst_table, NULL);
+    }
+
     if (src_table) {
         ecs_data_t *src_data = info->data;
-        ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
 
         if (dst_table->type) { 
             info->row = move_entity(world, entity, info, src_table, 
@@ -950,13 +994,17 @@ void commit(
         }        
     }
 
+    flecs_closure_entity_move(
+        world, src_table, dst_table, info->row_flags, diff);
+
     /* If the entity is being watched, it is being monitored for changes and
      * requires rematching systems when components are added or removed. This
      * ensures that systems that rely on components from containers or prefabs
      * update the matched tables when the application adds or removes a 
      * component from, for example, a container. */
     if (info->row_flags) {
-        update_component_monitors(world, entity, &diff->added, &diff->removed);
+        update_component_monitors(world, entity, info->row_flags, 
+            &diff->added, &diff->removed);
     }
 
     if ((!src_table || !src_table->type) && world->range_check_enabled) {
@@ -984,47 +1032,32 @@ void new(
         table = table_append(world, table, to_add->array[i], &diff);
     }
 
+    if (table->chunk_capacity) {
+        table = flecs_table_chunk_for_append(world, table, NULL);
+    }
+
     new_entity(world, entity, &info, table, &diff, true, true);
 
     diff_free(&diff);
 }
 
+/* Add entities with component data to a table. The offset is the index of the
+ * first entity in the component data arrays. */
 static
-const ecs_entity_t* new_w_data(
+int32_t append_w_data(
     ecs_world_t *world,
     ecs_table_t *table,
     const ecs_entity_t *entities,
     ecs_ids_t *component_ids,
     int32_t count,
     void **component_data,
+    int32_t offset,
     bool is_move,
-    int32_t *row_out,
     ecs_table_diff_t *diff)
 {
-    int32_t sparse_count = 0;
-    if (!entities) {
-        sparse_count = ecs_eis_count(world);
-        entities = flecs_sparse_new_ids(ecs_eis(world), count);
-    }
-
-    if (!table) {
-        return entities;
-    }
-
-    ecs_type_t type = table->type;   
-    if (!type) {
-        return entities;        
-    }
-
-    ecs_ids_t component_array = { 0 };
-    if (!component_ids) {
-        component_ids = &component_array;
-        component_array.array = ecs_vector_first(type, ecs_entity_t);
-        component_array.count = ecs_vector_count(type);
-    }
-
     ecs_data_t *data = &table->storage;
-    int32_t row = flecs_table_appendn(world, table, data, count, entities);
+    int32_t row = flecs_table_appendn(
+        world, table, data, count, entities, true);
     
     /* Update entity index. */
     int i;
@@ -1037,6 +1070,8 @@ const ecs_entity_t* new_w_data(
             });
     }
 
+    flecs_closure_entity_move(world, NULL, table, 0, diff);
+
     flecs_defer_none(world, &world->stage);
 
     flecs_notify_on_add(world, table, NULL, data, row, count, diff, 
@@ -1064,6 +1099,7 @@ const ecs_entity_t* new_w_data(
             int16_t alignment = column->alignment;
             void *ptr = ecs_vector_first_t(column->data, size, alignment);
             ptr = ECS_OFFSET(ptr, size * row);
+            src_ptr = ECS_OFFSET(src_ptr, size * offset);
 
             const ecs_type_info_t *cdata = get_c_info(world, id);
             ecs_copy_t copy;
@@ -1087,8 +1123,64 @@ const ecs_entity_t* new_w_data(
 
     flecs_defer_flush(world, &world->stage);
 
-    if (row_out) {
-        *row_out = row;
+    return row;
+}
+
+static
+const ecs_entity_t* new_w_data(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const ecs_entity_t *entities,
+    ecs_ids_t *component_ids,
+    int32_t count,
+    void **component_data,
+    bool is_move,
+    int32_t *row_out,
+    ecs_table_diff_t *diff)
+{
+    int32_t sparse_count = 0;
+    if (!entities) {
+        sparse_count = ecs_eis_count(world);
+        entities = flecs_sparse_new_ids(ecs_eis(world), count);
+    }
+
+    if (!table) {
+        return entities;
+    }
+
+    ecs_type_t type = table->type;   
+    if (!type) {
+        return entities;        
+    }
+
+    ecs_ids_t component_array = { 0 };
+    if (!component_ids) {
+        component_ids = &component_array;
+        component_array.array = ecs_vector_first(type, ecs_entity_t);
+        component_array.count = ecs_vector_count(type);
+    }
+
+    /* If the table is chunked, add the entities in as many chunks as needed */
+    int32_t offset = 0;
+    while (offset < count) {
+        int32_t n = count - offset;
+        ecs_table_t *dst_table = table;
+        if (table->chunk_capacity) {
+            dst_table = flecs_table_chunk_for_append(world, table, &n);
+        }
+
+        /* Reobtain ids, as observers may have created entities */
+        if (sparse_count && offset) {
+            entities = &flecs_sparse_ids(ecs_eis(world))[sparse_count];
+        }
+
+        int32_t row = append_w_data(world, dst_table, &entities[offset], 
+            component_ids, n, component_data, offset, is_move, diff);
+        if (row_out && !offset) {
+            *row_out = row;
+        }
+
+        offset += n;
     }
 
     if (sparse_count) {
@@ -2322,6 +2414,7 @@ void ecs_clear(
         };
 
         delete_entity(world, table, &table->storage, info.row, &diff);
+        flecs_closure_entity_move(world, table, NULL, info.row_flags, &diff);
         info.record->table = NULL;
         info.record->row = 0;
     }    
@@ -2413,6 +2506,14 @@ void remove_from_table(
             }
             flecs_table_merge(world, dst_table, src_table, 
                 &dst_table->storage, src_data);
+
+            /* Entities in the table can be pair objects */
+            if (src_table->flags & EcsTableHasClosure) {
+                flecs_closure_table_dirty(world, src_table);
+            }
+            if (dst_table->flags & EcsTableHasClosure) {
+                flecs_closure_table_dirty(world, dst_table);
+            }
         }
     }
 
@@ -2706,13 +2807,14 @@ void ecs_delete(
             table_id = table->id;
         }
 
-        if (info.row_flags) {
+        uint32_t row_flags = info.row_flags;
+        if (row_flags) {
             /* Prevent infinite recursion in case of cyclic delete actions */
             r->row &= ECS_ROW_MASK;
 
             /* Ensure that the store contains no dangling references to the
              * deleted entity (as a component, or as part of a relation) */
-            on_delete_any_w_entity(world, entity, 0, info.row_flags);
+            on_delete_any_w_entity(world, entity, 0, row_flags);
 
             /* Refetch data. In case of circular relations, the entity may have
              * moved to a different table. */
@@ -2727,7 +2829,8 @@ void ecs_delete(
 
             if (r->table) {
                 ecs_ids_t to_remove = flecs_type_to_ids(r->table->type);
-                update_component_monitors(world, entity, NULL, &to_remove);
+                update_component_monitors(
+                    world, entity, row_flags, NULL, &to_remove);
             }
         }
 
@@ -2742,6 +2845,7 @@ void ecs_delete(
             };
 
             delete_entity(world, table, info.data, info.row, &diff);
+            flecs_closure_entity_move(world, table, NULL, row_flags, &diff);
             r->table = NULL;
         }
 
@@ -2783,137 +2887,525 @@ error:
     return;
 }
 
-ecs_entity_t ecs_clone(
+/* Move entities that are stored next to each other in the same table to the
+ * destination table. Entities that are not yet stored in a table are appended
+ * to the destination table. Returns the row of the first entity in the 
+ * destination table. */
+static
+int32_t bulk_move(
     ecs_world_t *world,
-    ecs_entity_t dst,
-    ecs_entity_t src,
-    bool copy_value)
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_table_t *src_table,
+    int32_t src_row,
+    ecs_table_t *dst_table,
+    ecs_table_diff_t *diff,
+    bool construct,
+    bool notify_on_set)
 {
-    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
-    ecs_check(src != 0, ECS_INVALID_PARAMETER, NULL);
-    ecs_check(ecs_is_valid(world, src), ECS_INVALID_PARAMETER, NULL);
-    ecs_check(!dst || !ecs_get_table(world, dst), ECS_INVALID_PARAMETER, NULL);
-
-    ecs_stage_t *stage = flecs_stage_from_world(&world);
-    if (!dst) {
-        dst = ecs_new_id(world);
-    }
+    ecs_data_t *dst_data = &dst_table->storage;
+    ecs_record_t **dst_records;
+    uint32_t all_row_flags = 0;
+    int32_t i, dst_row = 0;
 
-    if (flecs_defer_clone(world, stage, dst, src, copy_value)) {
-        return dst;
-    }
+    if (!src_table) {
+        ecs_assert(dst_table->type != NULL, ECS_INTERNAL_ERROR, NULL);
 
-    ecs_entity_info_t src_info;
-    bool found = flecs_get_info(world, src, &src_info);
-    ecs_table_t *src_table = src_info.table;
+        dst_row = flecs_table_appendn(
+            world, dst_table, dst_data, count, entities, construct);
+        dst_records = ecs_vector_first(dst_data->record_ptrs, ecs_record_t*);
 
-    if (!found || !src_table) {
-        goto done;
-    }
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = ecs_eis_ensure(world, entities[i]);
+            uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+            r->table = dst_table;
+            r->row = ECS_ROW_TO_RECORD(dst_row + i, row_flags);
+            dst_records[dst_row + i] = r;
+            all_row_flags |= row_flags;
+        }
 
-    ecs_type_t src_type = src_table->type;
-    ecs_table_diff_t diff = {.added = flecs_type_to_ids(src_type)};
+        if (dst_table->flags & EcsTableHasAddActions) {
+            flecs_notify_on_add(world, dst_table, NULL, dst_data, dst_row, 
+                count, diff, notify_on_set);
+        }
+    } else {
+        ecs_data_t *src_data = &src_table->storage;
+        ecs_record_t **src_records = ecs_vector_first(
+            src_data->record_ptrs, ecs_record_t*);
+
+        if (!dst_table->type) {
+            if (src_table->flags & EcsTableHasRemoveActions) {
+                flecs_notify_on_remove(
+                    world, src_table, NULL, src_row, count, diff);
+            }
 
-    ecs_entity_info_t dst_info = {0};
-    dst_info.row = new_entity(world, dst, &dst_info, src_table, &diff, 
-        true, true);
+            for (i = 0; i < count; i ++) {
+                ecs_record_t *r = src_records[src_row + i];
+                uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+                r->table = NULL;
+                r->row = row_flags;
+                all_row_flags |= row_flags;
+            }
 
-    if (copy_value) {
-        flecs_table_move(world, dst, src, src_table, dst_info.data, 
-            dst_info.row, src_table, src_info.data, src_info.row, true);
+            flecs_table_delete_range(
+                world, src_table, src_data, src_row, count, true);
+        } else {
+            ecs_entity_t *src_entities = ecs_vector_first(
+                src_data->entities, ecs_entity_t);
+            dst_row = flecs_table_appendn(world, dst_table, dst_data, count, 
+                &src_entities[src_row], false);
 
-        flecs_notify_on_set(world, src_table, dst_info.row, 1, NULL, true);
-    }
+            flecs_notify_on_remove(
+                world, src_table, dst_table, src_row, count, diff);
 
-done:
-    flecs_defer_flush(world, stage);
-    return dst;
-error:
-    return 0;
-}
+            flecs_table_move_range(world, dst_table, dst_data, dst_row, 
+                src_table, src_data, src_row, count, construct);
 
-const void* ecs_get_id(
-    const ecs_world_t *world,
-    ecs_entity_t entity,
-    ecs_id_t id)
-{
-    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
-    ecs_check(ecs_is_valid(world, entity), ECS_INVALID_PARAMETER, NULL);
-    ecs_check(flecs_stage_from_readonly_world(world)->asynchronous == false, 
-        ECS_INVALID_PARAMETER, NULL);
+            /* Update entity index & delete old data after running remove 
+             * actions */
+            dst_records = ecs_vector_first(
+                dst_data->record_ptrs, ecs_record_t*);
+            for (i = 0; i < count; i ++) {
+                ecs_record_t *r = src_records[src_row + i];
+                uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+                r->table = dst_table;
+                r->row = ECS_ROW_TO_RECORD(dst_row + i, row_flags);
+                dst_records[dst_row + i] = r;
+                all_row_flags |= row_flags;
+            }
 
-    world = ecs_get_world(world);
+            flecs_table_delete_range(
+                world, src_table, src_data, src_row, count, false);
 
-    ecs_record_t *r = ecs_eis_get(world, entity);
-    if (!r) {
-        return NULL;
+            if (diff->added.count && 
+               (dst_table->flags & EcsTableHasAddActions)) 
+            {
+                flecs_notify_on_add(world, dst_table, src_table, dst_data, 
+                    dst_row, count, diff, notify_on_set);
+            }
+        }
     }
 
-    ecs_table_t *table = r->table;
-    if (!table) {
-        return NULL;
-    }
+    flecs_closure_entity_move(
+        world, src_table, dst_table, all_row_flags, diff);
 
-    ecs_id_record_t *idr = flecs_get_id_record(world, id);
-    if (!idr) {
-        return NULL;
+    /* Update component monitors for entities that are being watched */
+    if (all_row_flags) {
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = ecs_eis_get(world, entities[i]);
+            uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(r->row);
+            if (row_flags) {
+                update_component_monitors(world, entities[i], row_flags, 
+                    &diff->added, &diff->removed);
+            }
+        }
     }
 
-    const ecs_table_record_t *tr = NULL;
-    ecs_table_t *storage_table = table->storage_table;
-    if (storage_table) {
-        tr = flecs_id_record_table(idr, storage_table);
+    return dst_row;
+}
+
+/* Copy component values for a range of entities & invoke OnSet. If move_values
+ * is set, values are moved from the pointers in the array instead. */
+static
+void bulk_assign(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_table_t *table,
+    int32_t row,
+    ecs_id_t id,
+    ecs_size_t size,
+    const void *values,
+    void **move_values)
+{
+    ecs_column_t *column = ecs_table_column_for_id(world, table, id);
+    ecs_check(column != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(column->size == size, ECS_INVALID_PARAMETER, NULL);
+
+    void *ptr = ecs_vector_get_t(column->data, size, column->alignment, row);
+    ecs_assert(ptr != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_entity_t real_id = ecs_get_typeid(world, id);
+    const ecs_type_info_t *cdata = get_c_info(world, real_id);
+    if (move_values) {
+        ecs_move_t move = cdata ? cdata->lifecycle.move : NULL;
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            void *dst = ECS_OFFSET(ptr, size * i);
+            if (move) {
+                move(world, real_id, &entities[i], &entities[i], dst, 
+                    move_values[i], flecs_itosize(size), 1, 
+                    cdata->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, move_values[i], size);
+            }
+        }
     } else {
-        /* If the entity does not have a storage table (has no data) but it does
-         * have the id, the id must be a tag, and getting a tag is illegal. */
-        ecs_check(!ecs_owns_id(world, entity, id), ECS_NOT_A_COMPONENT, NULL);
+        ecs_copy_t copy;
+        if (cdata && (copy = cdata->lifecycle.copy)) {
+            copy(world, real_id, entities, entities, ptr, values, 
+                flecs_itosize(size), count, cdata->lifecycle.ctx);
+        } else {
+            ecs_os_memcpy(ptr, values, size * count);
+        }
     }
 
-    if (!tr) {
-       return get_base_component(world, table, id, idr, 0);
-    }
+    flecs_table_mark_rows_dirty(world, table, 
+        (int32_t)(column - table->storage.columns), row, count);
 
-    int32_t row = ECS_RECORD_TO_ROW(r->row);
-    return get_component_w_index(table, tr->column, row);
+    ecs_ids_t ids = { .array = &id, .count = 1 };
+    flecs_notify_on_set(world, table, row, count, &ids, true);
 error:
-    return NULL;
+    return;
 }
 
-const void* ecs_get_ref_id(
-    const ecs_world_t *world,
-    ecs_ref_t *ref,
-    ecs_entity_t entity,
-    ecs_id_t id)
+static
+void bulk_commit(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    bool remove,
+    ecs_size_t size,
+    const void *values,
+    void **move_values)
 {
-    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
-    ecs_check(ref != NULL, ECS_INVALID_PARAMETER, NULL);
-    ecs_check(!entity || !ref->entity || entity == ref->entity, 
-        ECS_INVALID_PARAMETER, NULL);
-    ecs_check(!id || !ref->component || id == ref->component, 
-        ECS_INVALID_PARAMETER, NULL);
-    ecs_record_t *record = ref->record;
-
-    /* Make sure we're not working with a stage */
-    world = ecs_get_world(world);
-
-    entity |= ref->entity;
-
-    if (!record) {
-        record = ecs_eis_get(world, entity);
-    }
+    ecs_world_t *stage_world = world;
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    bool has_values = values || move_values;
 
-    if (!record || !record->table) {
-        goto error;
+    /* If operations are deferred, enqueue an operation for each entity */
+    if (stage->defer) {
+        ecs_assert(move_values == NULL, ECS_INTERNAL_ERROR, NULL);
+        int32_t i;
+        for (i = 0; i < count; i ++) {
+            if (remove) {
+                ecs_remove_id(stage_world, entities[i], id);
+            } else if (values) {
+                ecs_set_id(stage_world, entities[i], id, flecs_itosize(size),
+                    ECS_OFFSET(values, size * i));
+            } else {
+                ecs_add_id(stage_world, entities[i], id);
+            }
+        }
+        return;
     }
 
-    ecs_table_t *table = record->table;
+    flecs_defer_none(world, stage);
 
-    if (ref->record == record &&
-        ref->table == table &&
-        ref->row == record->row &&
-        ref->alloc_count == table->alloc_count)
-    {
-        return ref->ptr;
+    ecs_table_t *root = &world->store.root;
+    int32_t i = 0;
+    while (i < count) {
+        ecs_entity_t e = entities[i];
+        ecs_check(ecs_is_valid(world, e), ECS_INVALID_PARAMETER, NULL);
+
+        ecs_record_t *r = ecs_eis_get(world, e);
+        ecs_table_t *src_table = r ? r->table : NULL;
+        int32_t src_row = src_table ? (int32_t)ECS_RECORD_TO_ROW(r->row) : 0;
+
+        /* Find entities that are stored next to each other in the same 
+         * table, or that are not stored in a table */
+        int32_t n;
+        for (n = 1; (i + n) < count; n ++) {
+            ecs_record_t *next = ecs_eis_get(world, entities[i + n]);
+            if (src_table) {
+                if (!next || next->table != src_table || 
+                    (int32_t)ECS_RECORD_TO_ROW(next->row) != (src_row + n)) 
+                {
+                    break;
+                }
+            } else {
+                if (next && next->table) {
+                    break;
+                }
+                ecs_check(ecs_is_valid(world, entities[i + n]), 
+                    ECS_INVALID_PARAMETER, NULL);
+            }
+        }
+
+        if (!src_table && world->range_check_enabled) {
+            int32_t j;
+            for (j = i; j < (i + n); j ++) {
+                ecs_check(!world->stats.max_id || 
+                    entities[j] <= world->stats.max_id, ECS_OUT_OF_RANGE, 0);
+                ecs_check(entities[j] >= world->stats.min_id, 
+                    ECS_OUT_OF_RANGE, 0);
+            }
+        }
+
+        ecs_table_diff_t diff;
+        ecs_table_t *table = src_table ? src_table : root;
+        ecs_table_t *dst_table;
+        if (remove) {
+            dst_table = flecs_table_traverse_remove(world, table, &id, &diff);
+        } else {
+            dst_table = flecs_table_traverse_add(world, table, &id, &diff);
+        }
+        ecs_check(dst_table != NULL, ECS_INVALID_PARAMETER, NULL);
+
+        /* Only move as many entities as fit in a chunk */
+        if (dst_table != table && dst_table->chunk_capacity) {
+            dst_table = flecs_table_chunk_for_append(world, dst_table, &n);
+        }
+
+        int32_t row = src_row;
+        if (dst_table != table) {
+            row = bulk_move(world, &entities[i], n, src_table, src_row, 
+                dst_table, &diff, true, !has_values);
+        } else if (src_table && (src_table->flags & EcsTableHasSwitch) &&
+            (diff.added.count || diff.removed.count))
+        {
+            ecs_components_switch(world, src_table, &src_table->storage, 
+                src_row, n, &diff.added, &diff.removed);
+        }
+
+        if (has_values && dst_table->type) {
+            bulk_assign(world, &entities[i], n, dst_table, row, id, size, 
+                values ? ECS_OFFSET(values, size * i) : NULL, 
+                move_values ? &move_values[i] : NULL);
+        }
+
+        i += n;
+    }
+
+error:
+    flecs_defer_flush(world, stage);
+}
+
+static
+void bulk_commit_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id,
+    bool remove)
+{
+    /* Collect entities before moving them, as moving entities invalidates
+     * the iterator. Entities of the same table are stored next to each other,
+     * so that each table is moved in a single operation. */
+    ecs_vector_t *entities = NULL;
+    ecs_iter_t it = ecs_filter_iter(world, filter);
+    while (ecs_filter_next(&it)) {
+        ecs_entity_t *ids = ecs_vector_addn(&entities, ecs_entity_t, it.count);
+        ecs_os_memcpy_n(ids, it.entities, ecs_entity_t, it.count);
+    }
+
+    bulk_commit(world, ecs_vector_first(entities, ecs_entity_t), 
+        ecs_vector_count(entities), id, remove, 0, NULL, NULL);
+
+    ecs_vector_free(entities);
+}
+
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || entities != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit(world, entities, count, id, false, 0, NULL, NULL);
+error:
+    return;
+}
+
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || entities != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit(world, entities, count, id, true, 0, NULL, NULL);
+error:
+    return;
+}
+
+void ecs_bulk_set_id(
+    ecs_world_t *world,
+    const ecs_entity_t *entities,
+    int32_t count,
+    ecs_id_t id,
+    size_t size,
+    const void *values)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || entities != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!count || values != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit(world, entities, count, id, false, flecs_utosize(size), 
+        values, NULL);
+error:
+    return;
+}
+
+void ecs_bulk_add_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit_w_filter(world, filter, id, false);
+error:
+    return;
+}
+
+void ecs_bulk_remove_id_w_filter(
+    ecs_world_t *world,
+    const ecs_filter_t *filter,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(filter != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+    bulk_commit_w_filter(world, filter, id, true);
+error:
+    return;
+}
+
+ecs_entity_t ecs_clone(
+    ecs_world_t *world,
+    ecs_entity_t dst,
+    ecs_entity_t src,
+    bool copy_value)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(src != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, src), ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!dst || !ecs_get_table(world, dst), ECS_INVALID_PARAMETER, NULL);
+
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    if (!dst) {
+        dst = ecs_new_id(world);
+    }
+
+    if (flecs_defer_clone(world, stage, dst, src, copy_value)) {
+        return dst;
+    }
+
+    ecs_entity_info_t src_info;
+    bool found = flecs_get_info(world, src, &src_info);
+    ecs_table_t *src_table = src_info.table;
+
+    if (!found || !src_table) {
+        goto done;
+    }
+
+    ecs_type_t src_type = src_table->type;
+    ecs_table_diff_t diff = {.added = flecs_type_to_ids(src_type)};
+
+    /* If the table is chunked the clone can be stored in another chunk */
+    ecs_table_t *dst_table = src_table;
+    if (dst_table->chunk_capacity) {
+        dst_table = flecs_table_chunk_for_append(world, dst_table, NULL);
+    }
+
+    ecs_entity_info_t dst_info = {0};
+    dst_info.row = new_entity(world, dst, &dst_info, dst_table, &diff, 
+        true, true);
+    flecs_closure_entity_move(world, NULL, dst_table, 0, &diff);
+
+    if (copy_value) {
+        flecs_table_move(world, dst, src, dst_table, dst_info.data, 
+            dst_info.row, src_table, src_info.data, src_info.row, true);
+
+        flecs_notify_on_set(world, dst_table, dst_info.row, 1, NULL, true);
+    }
+
+done:
+    flecs_defer_flush(world, stage);
+    return dst;
+error:
+    return 0;
+}
+
+const void* ecs_get_id(
+    const ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_is_valid(world, entity), ECS_INVALID_PARAMETER, NULL);
+    ecs_check(flecs_stage_from_readonly_world(world)->asynchronous == false, 
+        ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    ecs_record_t *r = ecs_eis_get(world, entity);
+    if (!r) {
+        return NULL;
+    }
+
+    ecs_table_t *table = r->table;
+    if (!table) {
+        return NULL;
+    }
+
+    ecs_id_record_t *idr = flecs_get_id_record(world, id);
+    if (!idr) {
+        return NULL;
+    }
+
+    const ecs_table_record_t *tr = NULL;
+    ecs_table_t *storage_table = table->storage_table;
+    if (storage_table) {
+        tr = flecs_id_record_table(idr, storage_table);
+    } else {
+        /* If the entity does not have a storage table (has no data) but it does
+         * have the id, the id must be a tag, and getting a tag is illegal. */
+        ecs_check(!ecs_owns_id(world, entity, id), ECS_NOT_A_COMPONENT, NULL);
+    }
+
+    if (!tr) {
+       return get_base_component(world, table, id, idr, 0);
+    }
+
+    int32_t row = ECS_RECORD_TO_ROW(r->row);
+    return get_component_w_index(table, tr->column, row);
+error:
+    return NULL;
+}
+
+const void* ecs_get_ref_id(
+    const ecs_world_t *world,
+    ecs_ref_t *ref,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ref != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!entity || !ref->entity || entity == ref->entity, 
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!id || !ref->component || id == ref->component, 
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_record_t *record = ref->record;
+
+    /* Make sure we're not working with a stage */
+    world = ecs_get_world(world);
+
+    entity |= ref->entity;
+
+    if (!record) {
+        record = ecs_eis_get(world, entity);
+    }
+
+    if (!record || !record->table) {
+        goto error;
+    }
+
+    ecs_table_t *table = record->table;
+
+    if (ref->record == record &&
+        ref->table == table &&
+        ref->row == record->row &&
+        ref->alloc_count == table->alloc_count)
+    {
+        return ref->ptr;
     }
 
     id |= ref->component;
@@ -3052,7 +3544,7 @@ void ecs_modified_id(
         flecs_notify_on_set(world, info.table, info.row, 1, &ids, true);
     }
 
-    flecs_table_mark_dirty(world, info.table, id);
+    flecs_table_mark_dirty(world, info.table, id, info.row);
     flecs_defer_flush(world, stage);
 error:
     return;
@@ -3117,7 +3609,7 @@ ecs_entity_t assign_ptr_w_id(
         memset(dst, 0, size);
     }
 
-    flecs_table_mark_dirty(world, info.table, id);
+    flecs_table_mark_dirty(world, info.table, id, info.row);
 
     if (notify) {
         ecs_ids_t ids = { .array = &id, .count = 1 };
@@ -3973,14 +4465,13 @@ void flush_bulk_new(
 {
     ecs_entity_t *entities = op->is._n.entities;
 
+    /* Entities are not yet stored in a table, so they can be moved to the
+     * destination table with a single operation, which emits OnAdd once for 
+     * the entire range instead of for each entity. */
     if (op->id) {
-        int i, count = op->is._n.count;
-        for (i = 0; i < count; i ++) {
-            add_id(world, entities[i], op->id);
-        }
+        bulk_commit(world, entities, op->is._n.count, op->id, false, 0, NULL,
+            NULL);
     }
-
-    ecs_os_free(entities);
 }
 
 static
@@ -4015,10 +4506,7 @@ void discard_op(
         void *value = op->is._1.value;
         if (value) {
             free_value(world, &op->is._1.entity, op->id, op->is._1.value, 1);
-            ecs_os_free(value);
         }
-    } else {
-        ecs_os_free(op->is._n.entities);
     }
 }
 
@@ -4085,6 +4573,427 @@ bool remove_invalid(
     return true;
 }
 
+static
+bool is_add_op(
+    ecs_defer_op_t *op)
+{
+    return op->kind == EcsOpNew || op->kind == EcsOpAdd;
+}
+
+/* Apply a sequence of add or remove operations for the same entity with a 
+ * single table move, instead of moving the entity for each operation. Returns
+ * the number of operations that were consumed from the queue. */
+static
+int32_t flush_add_remove(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    ecs_entity_t e = ops[0].is._1.entity;
+    bool is_add = is_add_op(&ops[0]);
+
+    ecs_entity_info_t info;
+    flecs_get_info(world, e, &info);
+
+    ecs_table_t *table = info.table;
+    ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+    bool deleted = false;
+    int32_t i;
+
+    for (i = 0; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        if (op->is._1.entity != e) {
+            break;
+        }
+
+        if (is_add) {
+            if (!is_add_op(op)) {
+                break;
+            }
+
+            ecs_assert(op->id != 0, ECS_INTERNAL_ERROR, NULL);
+            if (!remove_invalid(world, &op->id)) {
+                if (!i) {
+                    /* Entity should be deleted */
+                    ecs_delete(world, e);
+                    deleted = true;
+                    i ++;
+                }
+
+                /* Apply collected operations before the entity is deleted */
+                break;
+            }
+
+            if (op->id) {
+                world->add_count ++;
+                table = table_append(world, table, op->id, &diff);
+            }
+        } else {
+            if (op->kind != EcsOpRemove) {
+                break;
+            }
+
+            table = table_remove(world, table, op->id, &diff);
+        }
+    }
+
+    if (!deleted) {
+        flecs_defer_none(world, stage);
+        commit(world, e, &info, table, &diff, true, true);
+        flecs_defer_flush(world, stage);
+    }
+
+    diff_free(&diff);
+
+    return i;
+}
+
+/* Count operations that apply the same add, remove or set to different
+ * entities, like the operations that are enqueued when adding a component to
+ * all entities of a query while deferred. */
+static
+int32_t batch_count(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_defer_op_t *first = &ops[0];
+    bool is_add = is_add_op(first);
+    int32_t i;
+
+    for (i = 1; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        if (op->id != first->id) {
+            break;
+        }
+
+        if (is_add) {
+            if (!is_add_op(op)) {
+                break;
+            }
+        } else if (op->kind != first->kind) {
+            break;
+        }
+
+        ecs_entity_t e = op->is._1.entity;
+        if (e == ops[i - 1].is._1.entity) {
+            break;
+        }
+
+        /* Operations for deleted entities are discarded by the flush */
+        if (!ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            break;
+        }
+    }
+
+    /* If the next operation is for the last entity, leave it to
+     * flush_add_remove so that both are applied with a single commit */
+    if (i < count && ops[i].is._1.entity == ops[i - 1].is._1.entity) {
+        i --;
+    }
+
+    return i;
+}
+
+/* Apply a sequence of operations that add, remove or set the same id for 
+ * different entities with a single bulk operation. Entities that are stored
+ * next to each other are moved together, and observers are notified once for 
+ * each table range. Returns the number of operations that were consumed from 
+ * the queue, or 0 if the operations should be applied one by one. */
+static
+int32_t flush_batch(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    int32_t i, n = batch_count(world, ops, count);
+    if (n < 2) {
+        return 0;
+    }
+
+    ecs_id_t id = ops[0].id;
+    bool remove = ops[0].kind == EcsOpRemove;
+    bool set = ops[0].kind == EcsOpSet;
+    ecs_size_t size = 0;
+    void **values = NULL;
+
+    if (is_add_op(&ops[0])) {
+        ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
+        if (!remove_invalid(world, &id)) {
+            /* Entities should be deleted, which is done for each operation */
+            return 0;
+        }
+
+        if (!id) {
+            /* Id is no longer valid, ignore the operations */
+            return n;
+        }
+
+        world->add_count += n;
+    }
+
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, n);
+    for (i = 0; i < n; i ++) {
+        entities[i] = ops[i].is._1.entity;
+    }
+
+    if (set) {
+        /* Values are moved from where they are stored in the queue, the same 
+         * as when the operations are applied one by one. Values can't be 
+         * copied to a contiguous array, as components are not guaranteed to 
+         * be trivially relocatable. */
+        size = ops[0].is._1.size;
+        values = ecs_os_malloc_n(void*, n);
+        for (i = 0; i < n; i ++) {
+            ecs_assert(ops[i].is._1.size == size, ECS_INTERNAL_ERROR, NULL);
+            values[i] = ops[i].is._1.value;
+        }
+    }
+
+    bulk_commit(world, entities, n, id, remove, size, NULL, values);
+
+    ecs_os_free(values);
+    ecs_os_free(entities);
+
+    return n;
+}
+
+/* Count operations of a sequence of add or remove operations for the same
+ * entity, which flush_add_remove applies with a single table move. */
+static
+int32_t add_remove_count(
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_entity_t e = ops[0].is._1.entity;
+    bool is_add = is_add_op(&ops[0]);
+    int32_t i;
+
+    for (i = 1; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        if (op->is._1.entity != e) {
+            break;
+        }
+        if (is_add ? !is_add_op(op) : (op->kind != EcsOpRemove)) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/* Apply sequences of add or remove operations for different entities that add
+ * or remove the same ids with a single bulk operation. Queues that are sorted
+ * by entity contain such sequences, for example when a stage added a tag to the
+ * entities of a table and another stage added a different tag to the same 
+ * entities. Returns the number of operations that were consumed from the 
+ * queue, or 0 if the operations should be applied one entity at a time. */
+static
+int32_t flush_add_remove_batch(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    int32_t i, n = add_remove_count(ops, count);
+    if (n < 2) {
+        /* Single operations are batched by flush_batch */
+        return 0;
+    }
+
+    ecs_record_t *r = ecs_eis_get(world, ops[0].is._1.entity);
+    ecs_table_t *src_table = r ? r->table : NULL;
+    int32_t src_row = src_table ? (int32_t)ECS_RECORD_TO_ROW(r->row) : 0;
+
+    /* Find entities with the same sequence of operations that are stored next
+     * to each other in the same table, or that are not stored in a table */
+    int32_t entity_count;
+    for (entity_count = 1; (entity_count + 1) * n <= count; entity_count ++) {
+        ecs_defer_op_t *first = &ops[entity_count * n];
+        ecs_entity_t e = first->is._1.entity;
+        if (e == first[-1].is._1.entity) {
+            break;
+        }
+
+        if (add_remove_count(first, count - entity_count * n) != n) {
+            break;
+        }
+
+        for (i = 0; i < n; i ++) {
+            if (first[i].kind != ops[i].kind || first[i].id != ops[i].id) {
+                break;
+            }
+        }
+        if (i != n) {
+            break;
+        }
+
+        /* Operations for deleted entities are discarded by the flush */
+        if (!ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            break;
+        }
+
+        ecs_record_t *next = ecs_eis_get(world, e);
+        if (src_table) {
+            if (!next || next->table != src_table || 
+                (int32_t)ECS_RECORD_TO_ROW(next->row) != 
+                    (src_row + entity_count)) 
+            {
+                break;
+            }
+        } else if (next && next->table) {
+            break;
+        }
+    }
+
+    if (entity_count < 2) {
+        return 0;
+    }
+
+    ecs_table_t *table = src_table ? src_table : &world->store.root;
+    ecs_table_t *dst_table = table;
+    ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+    bool is_add = is_add_op(&ops[0]);
+    int32_t add_count = 0;
+
+    for (i = 0; i < n; i ++) {
+        ecs_id_t id = ops[i].id;
+        if (is_add) {
+            ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
+            if (!remove_invalid(world, &id)) {
+                /* Entities should be deleted, which is done for each entity */
+                diff_free(&diff);
+                return 0;
+            }
+
+            if (id) {
+                add_count ++;
+                dst_table = table_append(world, dst_table, id, &diff);
+            }
+        } else {
+            dst_table = table_remove(world, dst_table, id, &diff);
+        }
+    }
+
+    /* Only move as many entities as fit in a chunk */
+    if (dst_table != table && dst_table->chunk_capacity) {
+        dst_table = flecs_table_chunk_for_append(
+            world, dst_table, &entity_count);
+    }
+
+    world->add_count += add_count * entity_count;
+
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, entity_count);
+    for (i = 0; i < entity_count; i ++) {
+        entities[i] = ops[i * n].is._1.entity;
+    }
+
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    flecs_defer_none(world, stage);
+
+    if (dst_table != table) {
+        bulk_move(world, entities, entity_count, src_table, src_row, 
+            dst_table, &diff, true, true);
+    } else if (src_table && (src_table->flags & EcsTableHasSwitch) &&
+        (diff.added.count || diff.removed.count))
+    {
+        ecs_components_switch(world, src_table, &src_table->storage, 
+            src_row, entity_count, &diff.added, &diff.removed);
+    }
+
+    flecs_defer_flush(world, stage);
+
+    ecs_os_free(entities);
+    diff_free(&diff);
+
+    return entity_count * n;
+}
+
+/* Apply deferred commands */
+static
+void flush_ops(
+    ecs_world_t *world,
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_defer_op_t *op = &ops[i];
+        ecs_entity_t e = op->is._1.entity;
+        if (op->kind == EcsOpBulkNew) {
+            e = 0;
+        }
+
+        /* If entity is no longer alive, this could be because the queue
+         * contained both a delete and a subsequent add/remove/set which
+         * should be ignored. */
+        if (e && !ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
+            ecs_assert(op->kind != EcsOpNew && op->kind != EcsOpClone, 
+                ECS_INTERNAL_ERROR, NULL);
+            world->discard_count ++;
+            discard_op(world, op);
+            continue;
+        }
+
+        switch(op->kind) {
+        case EcsOpNew:
+        case EcsOpAdd:
+        case EcsOpRemove: {
+            int32_t n = flush_batch(world, op, count - i);
+            if (!n) {
+                n = flush_add_remove_batch(world, op, count - i);
+            }
+            if (!n) {
+                n = flush_add_remove(world, op, count - i);
+            }
+            i += n - 1;
+            break;
+        }
+        case EcsOpClone:
+            ecs_clone(world, e, op->id, op->is._1.clone_value);
+            break;
+        case EcsOpSet: {
+            int32_t n = flush_batch(world, op, count - i);
+            if (n) {
+                i += n - 1;
+                break;
+            }
+            assign_ptr_w_id(world, e, 
+                op->id, flecs_itosize(op->is._1.size), 
+                op->is._1.value, true, true);
+            break;
+        }
+        case EcsOpMut:
+            assign_ptr_w_id(world, e, 
+                op->id, flecs_itosize(op->is._1.size), 
+                op->is._1.value, true, false);
+            break;
+        case EcsOpModified:
+            ecs_modified_id(world, e, op->id);
+            break;
+        case EcsOpDelete: {
+            ecs_delete(world, e);
+            break;
+        }
+        case EcsOpClear:
+            ecs_clear(world, e);
+            break;
+        case EcsOpOnDeleteAction:
+            on_delete_action(world, op->id, e);
+            break;
+        case EcsOpEnable:
+            ecs_enable_component_w_id(world, e, op->id, true);
+            break;
+        case EcsOpDisable:
+            ecs_enable_component_w_id(world, e, op->id, false);
+            break;
+        case EcsOpBulkNew:
+            flush_bulk_new(world, op);
+            continue;
+        }
+    }
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool flecs_defer_flush(
     ecs_world_t *world,
@@ -4103,88 +5012,25 @@ bool flecs_defer_flush(
 
         if (defer_queue) {
             ecs_defer_op_t *ops = ecs_vector_first(defer_queue, ecs_defer_op_t);
-            int32_t i, count = ecs_vector_count(defer_queue);
+            int32_t count = ecs_vector_count(defer_queue);
+
+            /* Values of the queue are stored in the stage stack. Values for
+             * commands that are enqueued while processing the queue are 
+             * allocated after the current top, so the memory of the queue
+             * that's being processed remains valid until it is done. */
+            ecs_stack_cursor_t defer_cursor = stage->defer_cursor;
+            stage->defer_cursor = flecs_stack_get_cursor(&stage->defer_stack);
             
-            for (i = 0; i < count; i ++) {
-                ecs_defer_op_t *op = &ops[i];
-                ecs_entity_t e = op->is._1.entity;
-                if (op->kind == EcsOpBulkNew) {
-                    e = 0;
-                }
-
-                /* If entity is no longer alive, this could be because the queue
-                 * contained both a delete and a subsequent add/remove/set which
-                 * should be ignored. */
-                if (e && !ecs_is_alive(world, e) && ecs_eis_exists(world, e)) {
-                    ecs_assert(op->kind != EcsOpNew && op->kind != EcsOpClone, 
-                        ECS_INTERNAL_ERROR, NULL);
-                    world->discard_count ++;
-                    discard_op(world, op);
-                    continue;
-                }
-
-                switch(op->kind) {
-                case EcsOpNew:
-                case EcsOpAdd:
-                    ecs_assert(op->id != 0, ECS_INTERNAL_ERROR, NULL);
-                    if (remove_invalid(world, &op->id)) {
-                        if (op->id) {
-                            world->add_count ++;
-                            add_id(world, e, op->id);
-                        }
-                    } else {
-                        ecs_delete(world, e);
-                    }
-                    break;
-                case EcsOpRemove:
-                    remove_id(world, e, op->id);
-                    break;
-                case EcsOpClone:
-                    ecs_clone(world, e, op->id, op->is._1.clone_value);
-                    break;
-                case EcsOpSet:
-                    assign_ptr_w_id(world, e, 
-                        op->id, flecs_itosize(op->is._1.size), 
-                        op->is._1.value, true, true);
-                    break;
-                case EcsOpMut:
-                    assign_ptr_w_id(world, e, 
-                        op->id, flecs_itosize(op->is._1.size), 
-                        op->is._1.value, true, false);
-                    break;
-                case EcsOpModified:
-                    ecs_modified_id(world, e, op->id);
-                    break;
-                case EcsOpDelete: {
-                    ecs_delete(world, e);
-                    break;
-                }
-                case EcsOpClear:
-                    ecs_clear(world, e);
-                    break;
-                case EcsOpOnDeleteAction:
-                    on_delete_action(world, op->id, e);
-                    break;
-                case EcsOpEnable:
-                    ecs_enable_component_w_id(world, e, op->id, true);
-                    break;
-                case EcsOpDisable:
-                    ecs_enable_component_w_id(world, e, op->id, false);
-                    break;
-                case EcsOpBulkNew:
-                    flush_bulk_new(world, op);
-                    continue;
-                }
-
-                if (op->is._1.value) {
-                    ecs_os_free(op->is._1.value);
-                }                  
-            }
+            flush_ops(world, ops, count);
 
             if (stage->defer_queue) {
                 ecs_vector_free(stage->defer_queue);
             }
 
+            /* Release memory of values for processed queue */
+            flecs_stack_restore_cursor(&stage->defer_stack, defer_cursor);
+            stage->defer_cursor = defer_cursor;
+
             /* Restore defer queue */
             ecs_vector_clear(defer_queue);
             stage->defer_queue = defer_queue;
@@ -4197,6 +5043,85 @@ error:
     return false;
 }
 
+/* Leave safe section of multiple stages. The command queues of the stages must
+ * be sorted by entity (see flecs_defer_sort), and are merged into a single 
+ * queue that is applied at once. Commands for the same entity are applied in
+ * stage order, so that the result does not depend on which stage enqueued a
+ * command first. */
+void flecs_defer_flush_stages(
+    ecs_world_t *world,
+    ecs_stage_t **stages,
+    int32_t count)
+{
+    ecs_vector_t **queues = ecs_os_malloc_n(ecs_vector_t*, count);
+    ecs_stack_cursor_t *cursors = ecs_os_malloc_n(ecs_stack_cursor_t, count);
+    int32_t *heads = ecs_os_calloc_n(int32_t, count);
+    int32_t i, op_count = 0;
+
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *stage = stages[i];
+        ecs_assert(stage->defer == 1, ECS_INTERNAL_ERROR, NULL);
+        stage->defer --;
+
+        /* Same as flecs_defer_flush, values of the queues must remain valid
+         * until all queues are processed. */
+        queues[i] = stage->defer_queue;
+        stage->defer_queue = NULL;
+        cursors[i] = stage->defer_cursor;
+        stage->defer_cursor = flecs_stack_get_cursor(&stage->defer_stack);
+        op_count += ecs_vector_count(queues[i]);
+    }
+
+    if (op_count) {
+        ecs_defer_op_t *ops = ecs_os_malloc_n(ecs_defer_op_t, op_count);
+        int32_t op;
+
+        for (op = 0; op < op_count; op ++) {
+            ecs_defer_op_t *next = NULL;
+            int32_t next_stage = 0;
+
+            /* Take the command with the lowest entity. For equal entities the 
+             * command from the first stage is taken. */
+            for (i = 0; i < count; i ++) {
+                if (heads[i] == ecs_vector_count(queues[i])) {
+                    continue;
+                }
+
+                ecs_defer_op_t *head = ecs_vector_get(
+                    queues[i], ecs_defer_op_t, heads[i]);
+                if (!next || head->is._1.entity < next->is._1.entity) {
+                    next = head;
+                    next_stage = i;
+                }
+            }
+
+            ecs_assert(next != NULL, ECS_INTERNAL_ERROR, NULL);
+            ops[op] = *next;
+            heads[next_stage] ++;
+        }
+
+        flush_ops(world, ops, op_count);
+        ecs_os_free(ops);
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *stage = stages[i];
+        if (stage->defer_queue) {
+            ecs_vector_free(stage->defer_queue);
+        }
+
+        flecs_stack_restore_cursor(&stage->defer_stack, cursors[i]);
+        stage->defer_cursor = cursors[i];
+
+        ecs_vector_clear(queues[i]);
+        stage->defer_queue = queues[i];
+    }
+
+    ecs_os_free(heads);
+    ecs_os_free(cursors);
+    ecs_os_free(queues);
+}
+
 /* Delete operations from queue without executing them. */
 bool flecs_defer_purge(
     ecs_world_t *world,
@@ -4220,6 +5145,9 @@ bool flecs_defer_purge(
                 ecs_vector_free(stage->defer_queue);
             }
 
+            flecs_stack_restore_cursor(&stage->defer_stack, 
+                stage->defer_cursor);
+
             /* Restore defer queue */
             ecs_vector_clear(defer_queue);
             stage->defer_queue = defer_queue;
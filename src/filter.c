@@ -876,6 +876,7 @@ int ecs_filter_init(
     f.filter = desc->filter;
     f.instanced = desc->instanced;
     f.match_empty_tables = desc->match_empty_tables;
+    f.cached = desc->cached;
     f.match_anything = true;
 
     if (terms) {
@@ -971,6 +972,13 @@ int ecs_filter_init(
         goto error;
     }
 
+    if (f.cached && !flecs_filter_is_cacheable(&f)) {
+        char *filter_str = ecs_filter_str(world, &f);
+        ecs_warn("cannot cache filter '%s': only terms that match This or "
+            "supersets of This can be cached", filter_str);
+        ecs_os_free(filter_str);
+    }
+
     *filter_out = f;
     if (f.term_cache_used) {
         filter_out->terms = filter_out->term_cache;
@@ -1525,13 +1533,25 @@ void term_iter_init_no_data(
 static
 void term_iter_init_wildcard(
     const ecs_world_t *world,
-    ecs_term_iter_t *iter)
+    ecs_term_iter_t *iter,
+    bool empty_tables)
 {
     iter->term = (ecs_term_t){ .index = -1 };
     iter->self_index = flecs_get_id_record(world, EcsAny);
     iter->cur = iter->self_index;
-    flecs_table_cache_iter(&iter->self_index->cache, &iter->it);
     iter->index = 0;
+
+    if (empty_tables) {
+        if ((empty_tables = flecs_table_cache_empty_iter(
+            &iter->self_index->cache, &iter->it)))
+        {
+            iter->empty_tables = true;
+        }
+    }
+
+    if (!empty_tables) {
+        flecs_table_cache_iter(&iter->self_index->cache, &iter->it);
+    }
 }
 
 static
@@ -1915,8 +1935,20 @@ ecs_iter_t ecs_filter_iter(
 
     filter = init_filter_iter(world, &it, filter);
 
+    ecs_filter_cache_elem_t *cache_elem = NULL;
+    if (filter->cached && flecs_filter_is_cacheable(filter)) {
+        cache_elem = flecs_filter_cache_get((ecs_world_t*)world, filter);
+    }
+
+    if (cache_elem) {
+        /* Tables matching the filter were found by a previous iterator */
+        iter->kind = EcsIterEvalCache;
+        iter->cache_elem = cache_elem;
+        iter->cache_version = cache_elem->version;
+        iter->cache_index = 0;
+
     /* Find term that represents smallest superset */
-    if (filter->match_this) {
+    } else if (filter->match_this) {
         ecs_term_t *terms = filter->terms;
         int32_t pivot_term = -1;
         ecs_check(terms != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -1932,14 +1964,13 @@ ecs_iter_t ecs_filter_iter(
         } else if (pivot_term == -1) {
             /* No terms meet the criteria to be a pivot term, evaluate filter
              * against all tables */
-            term_iter_init_wildcard(world, &iter->term_iter);
+            term_iter_init_wildcard(world, &iter->term_iter, 
+                filter->match_empty_tables);
         } else {
             ecs_assert(pivot_term >= 0, ECS_INTERNAL_ERROR, NULL);
             term_iter_init(world, &terms[pivot_term], &iter->term_iter,
                 filter->match_empty_tables);
         }
-
-        iter->term_iter.empty_tables = filter->match_empty_tables;
     } else {
         if (!filter->match_anything) {
             iter->kind = EcsIterEvalCondition;
@@ -2042,17 +2073,28 @@ bool ecs_filter_next_instanced(
         } while (!match);
 
         goto yield;
-    } else if (kind == EcsIterEvalIndex || kind == EcsIterEvalCondition) {
+    } else if (kind == EcsIterEvalIndex || kind == EcsIterEvalCondition ||
+        kind == EcsIterEvalCache) 
+    {
         ecs_term_iter_t *term_iter = &iter->term_iter;
         ecs_term_t *term = &term_iter->term;
-        int32_t pivot_term = term->index;
+        int32_t pivot_term = kind == EcsIterEvalCache ? -1 : term->index;
         bool first;
 
         do {
             first = iter->matches_left == 0;
 
             if (first) {
-                if (kind != EcsIterEvalCondition) {
+                if (kind == EcsIterEvalCache) {
+                    /* Cached tables are known to match the filter, but the
+                     * columns for the terms still need to be resolved */
+                    table = flecs_filter_cache_next(iter);
+                    if (!table) {
+                        goto done;
+                    }
+
+                    iter->matches_left = 1;
+                } else if (kind != EcsIterEvalCondition) {
                     /* Find new match, starting with the leading term */
                     if (!term_iter_next(world, term_iter, 
                         filter->match_prefab, filter->match_disabled)) 
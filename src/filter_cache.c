@@ -0,0 +1,322 @@
+#include "private_api.h"
+
+/* Number of signature elements for each term */
+#define ECS_FILTER_CACHE_TERM_SIZE (4)
+
+/* Signature contains for each term the id, operator and substitution 
+ * settings, and the filter flags that affect which tables are matched */
+static
+int32_t filter_cache_signature(
+    const ecs_filter_t *filter,
+    uint64_t *signature)
+{
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        ecs_term_set_t *set = &term->subj.set;
+        uint64_t *term_sig = &signature[i * ECS_FILTER_CACHE_TERM_SIZE];
+        term_sig[0] = term->id;
+        term_sig[1] = (uint64_t)term->oper | ((uint64_t)set->mask << 32);
+        term_sig[2] = set->relation;
+        term_sig[3] = (uint64_t)(uint32_t)set->min_depth | 
+            ((uint64_t)(uint32_t)set->max_depth << 32);
+    }
+
+    signature[count * ECS_FILTER_CACHE_TERM_SIZE] = 
+        (uint64_t)filter->match_prefab |
+        ((uint64_t)filter->match_disabled << 1);
+
+    return count * ECS_FILTER_CACHE_TERM_SIZE + 1;
+}
+
+/* Test if term can match components of supersets */
+static
+bool filter_cache_match_supersets(
+    const ecs_filter_t *filter)
+{
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        if (filter->terms[i].subj.set.mask & EcsSuperSet) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static
+void filter_cache_list_remove(
+    ecs_filter_cache_t *cache,
+    int32_t index)
+{
+    ecs_filter_cache_elem_t *elem = &cache->elems[index];
+
+    if (elem->prev != -1) {
+        cache->elems[elem->prev].next = elem->next;
+    } else {
+        cache->first = elem->next;
+    }
+
+    if (elem->next != -1) {
+        cache->elems[elem->next].prev = elem->prev;
+    } else {
+        cache->last = elem->prev;
+    }
+
+    elem->prev = -1;
+    elem->next = -1;
+}
+
+static
+void filter_cache_list_insert(
+    ecs_filter_cache_t *cache,
+    int32_t index)
+{
+    ecs_filter_cache_elem_t *elem = &cache->elems[index];
+
+    elem->prev = -1;
+    elem->next = cache->first;
+
+    if (cache->first != -1) {
+        cache->elems[cache->first].prev = index;
+    } else {
+        cache->last = index;
+    }
+
+    cache->first = index;
+}
+
+/* Find all tables (including empty tables) that match the filter */
+static
+void filter_cache_fill(
+    ecs_world_t *world,
+    ecs_filter_cache_elem_t *elem,
+    const ecs_filter_t *filter)
+{
+    ecs_filter_t f = *filter;
+    if (f.term_cache_used) {
+        f.terms = f.term_cache;
+    }
+
+    f.cached = false;
+    f.match_empty_tables = true;
+    f.instanced = true;
+    f.filter = true;
+
+    ecs_vector_clear(elem->tables);
+
+    ecs_table_t *last = NULL;
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    while (ecs_filter_next_instanced(&it)) {
+        /* Wildcard filters can return the same table multiple times */
+        if (it.table != last) {
+            ecs_table_t **ptr = ecs_vector_add(&elem->tables, ecs_table_t*);
+            *ptr = last = it.table;
+        }
+    }
+
+    elem->generation = world->filter_cache.generation;
+    elem->superset_generation = world->filter_cache.superset_generation;
+}
+
+/* Test if tables were created or deleted, or if supersets of matched tables
+ * changed since element was filled */
+static
+bool filter_cache_is_valid(
+    const ecs_filter_cache_t *cache,
+    const ecs_filter_cache_elem_t *elem)
+{
+    if (elem->generation != cache->generation) {
+        return false;
+    }
+
+    if (elem->match_supersets && 
+        elem->superset_generation != cache->superset_generation) 
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void flecs_filter_cache_init(
+    ecs_filter_cache_t *cache)
+{
+    ecs_map_init(&cache->index, int32_t, 0);
+    cache->count = 0;
+    cache->first = -1;
+    cache->last = -1;
+    cache->generation = 0;
+    cache->superset_generation = 0;
+}
+
+void flecs_filter_cache_fini(
+    ecs_filter_cache_t *cache)
+{
+    int32_t i;
+    for (i = 0; i < cache->count; i ++) {
+        ecs_filter_cache_elem_t *elem = &cache->elems[i];
+        ecs_vector_free(elem->signature);
+        ecs_vector_free(elem->tables);
+    }
+
+    ecs_map_fini(&cache->index);
+}
+
+void flecs_filter_cache_invalidate(
+    ecs_world_t *world)
+{
+    world->filter_cache.generation ++;
+}
+
+void flecs_filter_cache_invalidate_supersets(
+    ecs_world_t *world)
+{
+    world->filter_cache.superset_generation ++;
+}
+
+bool flecs_filter_is_cacheable(
+    const ecs_filter_t *filter)
+{
+    if (!filter->match_this) {
+        return false;
+    }
+
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+
+        /* Terms for other entities depend on the data of those entities */
+        if (term->subj.entity != EcsThis) {
+            return false;
+        }
+
+        /* Terms that match components of supersets are cached, as the cache
+         * is invalidated when an entity used as pair object changes tables.
+         * Subsets are not tracked. */
+        if (term->subj.set.mask & ~(EcsSelf | EcsSuperSet)) {
+            return false;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper == EcsAndFrom || oper == EcsOrFrom || oper == EcsNotFrom) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+ecs_filter_cache_elem_t* flecs_filter_cache_get(
+    ecs_world_t *world,
+    const ecs_filter_t *filter)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(filter != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_filter_cache_t *cache = &world->filter_cache;
+
+    /* Elements can't be modified while iterating in readonly mode, as multiple
+     * threads could be accessing the cache. With a single stage, the only 
+     * iterators are on the current thread. */
+    bool readonly = world->is_readonly && ecs_get_stage_count(world) > 1;
+
+    uint64_t *signature = ecs_os_alloca_n(uint64_t, 
+        filter->term_count * ECS_FILTER_CACHE_TERM_SIZE + 1);
+    int32_t signature_count = filter_cache_signature(filter, signature);
+    ecs_size_t signature_size = signature_count * ECS_SIZEOF(uint64_t);
+    uint64_t hash = flecs_hash(signature, signature_size);
+
+    ecs_filter_cache_elem_t *elem = NULL;
+    int32_t *index_ptr = ecs_map_get(&cache->index, int32_t, hash);
+    int32_t index;
+
+    if (index_ptr) {
+        index = *index_ptr;
+        elem = &cache->elems[index];
+
+        if (ecs_vector_count(elem->signature) == signature_count &&
+            !ecs_os_memcmp(ecs_vector_first(elem->signature, uint64_t),
+                signature, signature_size))
+        {
+            if (!filter_cache_is_valid(cache, elem)) {
+                /* Tables were created or deleted, or supersets changed since
+                 * element was filled */
+                if (readonly) {
+                    return NULL;
+                }
+                filter_cache_fill(world, elem, filter);
+            }
+
+            if (!readonly) {
+                filter_cache_list_remove(cache, index);
+                filter_cache_list_insert(cache, index);
+            }
+
+            return elem;
+        }
+
+        /* Different filter with same hash, replace element */
+        if (readonly) {
+            return NULL;
+        }
+
+        filter_cache_list_remove(cache, index);
+    } else {
+        if (readonly) {
+            return NULL;
+        }
+
+        if (cache->count < ECS_FILTER_CACHE_SIZE) {
+            index = cache->count ++;
+            elem = &cache->elems[index];
+            ecs_os_zeromem(elem);
+        } else {
+            /* Cache is full, evict least recently used element */
+            index = cache->last;
+            elem = &cache->elems[index];
+            ecs_map_remove(&cache->index, elem->hash);
+            filter_cache_list_remove(cache, index);
+        }
+
+        ecs_map_set(&cache->index, hash, &index);
+    }
+
+    /* Iterators that still point to the element can detect that the element
+     * was reused for a different filter */
+    elem->version ++;
+    elem->hash = hash;
+    elem->match_supersets = filter_cache_match_supersets(filter);
+
+    ecs_vector_set_count(&elem->signature, uint64_t, signature_count);
+    ecs_os_memcpy(ecs_vector_first(elem->signature, uint64_t), signature,
+        signature_size);
+
+    filter_cache_fill(world, elem, filter);
+    filter_cache_list_insert(cache, index);
+
+    return elem;
+}
+
+ecs_table_t* flecs_filter_cache_next(
+    ecs_filter_iter_t *iter)
+{
+    ecs_filter_cache_elem_t *elem = iter->cache_elem;
+    ecs_assert(elem != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_check(elem->version == iter->cache_version, ECS_INVALID_OPERATION,
+        "cached filter was evicted while iterating");
+
+    bool match_empty = iter->filter.match_empty_tables;
+    int32_t count = ecs_vector_count(elem->tables);
+    ecs_table_t **tables = ecs_vector_first(elem->tables, ecs_table_t*);
+
+    while (iter->cache_index < count) {
+        ecs_table_t *table = tables[iter->cache_index ++];
+        if (match_empty || ecs_table_count(table)) {
+            return table;
+        }
+    }
+
+error:
+    return NULL;
+}
@@ -1,11 +1,16 @@
 #include "private_api.h"
 #include <stddef.h>
 
-#define INIT_CACHE(it, f, term_count)\
+#define INIT_CACHE(it, stack, f, term_count)\
     if (!it->f && term_count) {\
         if (term_count <= ECS_TERM_CACHE_SIZE) {\
             it->f = it->priv.cache.f;\
             it->priv.cache.f##_alloc = false;\
+        } else if (stack) {\
+            ecs_size_t f##_size = ECS_SIZEOF(*(it->f)) * term_count;\
+            it->f = flecs_stack_alloc(stack, f##_size, 8);\
+            ecs_os_memset((void*)it->f, 0, f##_size);\
+            it->priv.cache.f##_alloc = false;\
         } else {\
             it->f = ecs_os_calloc(ECS_SIZEOF(*(it->f)) * term_count);\
             it->priv.cache.f##_alloc = true;\
@@ -19,17 +24,47 @@
         }\
     }   
 
+/* Iterators that are created during a frame get their term arrays from the
+ * frame allocator of their stage, which is reset by ecs_frame_end. */
+static
+ecs_stack_t* iter_frame_stack(
+    ecs_iter_t *it)
+{
+    if (it->term_count <= ECS_TERM_CACHE_SIZE || !it->world) {
+        return NULL;
+    }
+
+    ecs_world_t *world = it->world;
+    ecs_stage_t *stage;
+    if (ecs_poly_is(world, ecs_stage_t)) {
+        stage = (ecs_stage_t*)world;
+        world = stage->world;
+    } else if (!world->is_readonly) {
+        stage = &world->stage;
+    } else {
+        /* Stage of thread is not known */
+        return NULL;
+    }
+
+    if (!world->is_in_frame) {
+        return NULL;
+    }
+
+    return &stage->frame_stack;
+}
+
 void flecs_iter_init(
     ecs_iter_t *it)
 {
-    INIT_CACHE(it, ids, it->term_count);
-    INIT_CACHE(it, subjects, it->term_count);
-    INIT_CACHE(it, match_indices, it->term_count);
-    INIT_CACHE(it, columns, it->term_count);
+    ecs_stack_t *stack = iter_frame_stack(it);
+    INIT_CACHE(it, stack, ids, it->term_count);
+    INIT_CACHE(it, stack, subjects, it->term_count);
+    INIT_CACHE(it, stack, match_indices, it->term_count);
+    INIT_CACHE(it, stack, columns, it->term_count);
     
     if (!it->is_filter) {
-        INIT_CACHE(it, sizes, it->term_count);
-        INIT_CACHE(it, ptrs, it->term_count);
+        INIT_CACHE(it, stack, sizes, it->term_count);
+        INIT_CACHE(it, stack, ptrs, it->term_count);
     } else {
         it->sizes = NULL;
         it->ptrs = NULL;
@@ -416,6 +451,23 @@ error:
     return false;
 }
 
+bool ecs_term_is_aligned(
+    const ecs_iter_t *it,
+    int32_t index)
+{
+    ecs_check(it->is_valid, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index > 0, ECS_INVALID_PARAMETER, NULL);
+
+    if (!it->ptrs || it->columns[index - 1] <= 0) {
+        return false;
+    }
+
+    void *ptr = it->ptrs[index - 1];
+    return ptr && !((uintptr_t)ptr & (ECS_COLUMN_ALIGNMENT - 1));
+error:
+    return false;
+}
+
 void* ecs_iter_column_w_size(
     const ecs_iter_t *it,
     size_t size,
@@ -834,3 +886,437 @@ bool ecs_worker_next(
 error:
     return false;
 }
+
+/* Free term data storage of a chunk iterator. This is also called when the
+ * iterator is finalized before it has returned all results, in which case the
+ * chained iterator is finalized as well. */
+static
+void chunk_iter_fini(
+    ecs_iter_t *it)
+{
+    ecs_chunk_iter_t *iter = &it->priv.iter.chunk;
+    ecs_os_free(iter->ptrs);
+    iter->ptrs = NULL;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    if (chain_it && chain_it->is_valid) {
+        ecs_iter_fini(chain_it);
+    }
+}
+
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t *cursor,
+    int32_t size)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(cursor != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_os_api.ainc_ != NULL, ECS_MISSING_OS_API, "ainc");
+
+    return (ecs_iter_t){
+        .real_world = it->real_world,
+        .world = it->world,
+        .priv.iter.chunk = {
+            .cursor = cursor,
+            .size = size
+        },
+        .next = ecs_chunk_next,
+        .fini = chunk_iter_fini,
+        .chain_it = (ecs_iter_t*)it,
+        .is_instanced = it->is_instanced
+    };
+
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+/* Copy term data pointers of chained iterator, so that iterators that return
+ * multiple results for a single result of the chained iterator can offset the
+ * pointers without modifying the data of the chained iterator. */
+static
+void copy_chain_ptrs(
+    ecs_iter_t *it,
+    void ***storage)
+{
+    if (!it->ptrs) {
+        return;
+    }
+
+    int32_t term_count = it->term_count;
+    void **ptrs = it->priv.cache.ptrs;
+    if (term_count > ECS_TERM_CACHE_SIZE) {
+        if (!*storage) {
+            *storage = ecs_os_malloc_n(void*, term_count);
+        }
+        ptrs = *storage;
+    }
+
+    ecs_os_memcpy_n(ptrs, it->ptrs, void*, term_count);
+    it->ptrs = ptrs;
+}
+
+static
+bool ecs_chunk_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_chunk_next, ECS_INVALID_PARAMETER, NULL);
+
+    bool instanced = it->is_instanced;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_chunk_iter_t *iter = &it->priv.iter.chunk;
+    int32_t size = iter->size;
+
+    /* Claim the next chunk. Chunk indices are global across all tables of the
+     * chained iterator, so that resources that share the cursor never claim
+     * the same entities. */
+    int32_t claimed = ecs_os_ainc(iter->cursor) - 1;
+
+    /* Skip tables until the table that contains the claimed chunk is found */
+    while (claimed >= (iter->first + iter->count)) {
+        iter->first += iter->count;
+
+        if (!ecs_iter_next(chain_it)) {
+            goto done;
+        }
+
+        if (chain_it->table) {
+            iter->count = (chain_it->count + size - 1) / size;
+        } else {
+            iter->count = 1; /* Task query */
+        }
+    }
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+    it->is_instanced = instanced;
+
+    if (!it->table) {
+        return true;
+    }
+
+    /* Multiple chunks can be returned for the same result of the chained 
+     * iterator, so don't offset the term data of the chained iterator. */
+    copy_chain_ptrs(it, &iter->ptrs);
+
+    int32_t first = (claimed - iter->first) * size;
+    int32_t count = it->count - first;
+    if (count > size) {
+        count = size;
+    }
+
+    it->frame_offset += first;
+
+    offset_iter(it, first);
+    it->count = count;
+
+    if (it->is_instanced) {
+        it->offset += first;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+done:
+    chunk_iter_fini(it);
+error:
+    return false;
+}
+
+bool ecs_chunk_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_chunk_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    it->chain_it->is_instanced = true;
+
+    if (flecs_iter_next_row(it)) {
+        return true;
+    }
+
+    return flecs_iter_next_instanced(it, ecs_chunk_next_instanced(it));
+error:
+    return false;
+}
+
+#ifdef FLECS_META
+
+/* Free term data storage of a range iterator. This is also called when the
+ * iterator is finalized before it has returned all results, in which case the
+ * chained iterator is finalized as well. */
+static
+void range_iter_fini(
+    ecs_iter_t *it)
+{
+    ecs_range_iter_t *iter = &it->priv.iter.range;
+    ecs_os_free(iter->ptrs);
+    iter->ptrs = NULL;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    if (chain_it && chain_it->is_valid) {
+        ecs_iter_fini(chain_it);
+    }
+}
+
+ecs_iter_t ecs_range_iter(
+    const ecs_iter_t *it,
+    int32_t term,
+    const char *member,
+    double min,
+    double max)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(term > 0, ECS_INVALID_PARAMETER, NULL);
+
+    return (ecs_iter_t){
+        .real_world = it->real_world,
+        .world = it->world,
+        .priv.iter.range = {
+            .member = member,
+            .min = min,
+            .max = max,
+            .term = term,
+            .offset = -1,
+            .zone_map = -1
+        },
+        .next = ecs_range_next,
+        .fini = range_iter_fini,
+        .chain_it = (ecs_iter_t*)it,
+        .is_instanced = it->is_instanced
+    };
+
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+/* Find offset and primitive kind of the member for a component */
+static
+void range_resolve_member(
+    const ecs_world_t *world,
+    ecs_range_iter_t *iter,
+    ecs_id_t id)
+{
+    iter->id = id;
+    iter->offset = -1;
+
+    ecs_entity_t type = ecs_get_typeid(world, id);
+    if (!type) {
+        return;
+    }
+
+    int32_t offset = 0;
+    if (iter->member) {
+        const EcsStruct *st = ecs_get(world, type, EcsStruct);
+        if (!st) {
+            return;
+        }
+
+        ecs_member_t *members = ecs_vector_first(st->members, ecs_member_t);
+        int32_t i, count = ecs_vector_count(st->members);
+        for (i = 0; i < count; i ++) {
+            if (!ecs_os_strcmp(members[i].name, iter->member)) {
+                break;
+            }
+        }
+
+        if (i == count || members[i].count > 1) {
+            return;
+        }
+
+        type = members[i].type;
+        offset = members[i].offset;
+    }
+
+    const EcsPrimitive *ptr = ecs_get(world, type, EcsPrimitive);
+    if (!ptr || ptr->kind == EcsString) {
+        return;
+    }
+
+    iter->offset = offset;
+    iter->kind = ptr->kind;
+}
+
+/* Get zone map for member in current result of chained iterator */
+static
+int32_t range_get_zone_map(
+    ecs_iter_t *it,
+    ecs_range_iter_t *iter)
+{
+    ecs_table_t *table = it->table;
+    int32_t t = iter->term - 1;
+    if (!table || t >= it->term_count) {
+        return -1;
+    }
+
+    /* Only owned components are stored in the table */
+    if (it->subjects[t] || it->columns[t] <= 0) {
+        return -1;
+    }
+
+    ecs_id_t id = it->ids[t];
+    if (id != iter->id) {
+        range_resolve_member(it->real_world, iter, id);
+    }
+
+    if (iter->offset == -1) {
+        return -1;
+    }
+
+    int32_t column = ecs_table_type_to_storage_index(
+        table, it->columns[t] - 1);
+    if (column < 0) {
+        return -1;
+    }
+
+    /* Zone maps can't be updated when multiple threads could be iterating the
+     * same table */
+    ecs_world_t *world = it->real_world;
+    bool can_update = !world->is_readonly || ecs_get_stage_count(world) <= 1;
+
+    ecs_zone_map_t *map = flecs_table_get_zone_map(table, column, 
+        iter->offset, (ecs_primitive_kind_t)iter->kind, can_update);
+    if (!map) {
+        return -1;
+    }
+
+    return (int32_t)(map - ecs_vector_first(table->zone_maps, ecs_zone_map_t));
+}
+
+static
+bool range_overlaps(
+    const ecs_range_iter_t *iter,
+    const ecs_zone_t *zone)
+{
+    /* If min > max the zone has no values */
+    return zone->min <= zone->max && 
+        zone->min <= iter->max && zone->max >= iter->min;
+}
+
+static
+bool ecs_range_next_instanced(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_range_next, ECS_INVALID_PARAMETER, NULL);
+
+    bool instanced = it->is_instanced;
+
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_range_iter_t *iter = &it->priv.iter.range;
+    ecs_zone_map_t *map;
+    int32_t first, end;
+
+    do {
+        if (iter->block >= iter->block_end) {
+            if (!ecs_iter_next(chain_it)) {
+                goto done;
+            }
+
+            iter->block = iter->block_end = 0;
+            iter->zone_map = range_get_zone_map(chain_it, iter);
+            if (iter->zone_map == -1) {
+                /* Values can't be tested, return result as is */
+                ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+                it->is_instanced = instanced;
+                if (!it->is_instanced) {
+                    it->offset = 0;
+                }
+                return true;
+            }
+
+            map = ecs_vector_get(chain_it->table->zone_maps, 
+                ecs_zone_map_t, iter->zone_map);
+            if (!range_overlaps(iter, &map->table)) {
+                first = iter->block; /* No blocks to return */
+                continue;
+            }
+
+            first = chain_it->offset;
+            end = first + chain_it->count;
+            iter->block = first / ECS_ZONE_BLOCK_SIZE;
+            iter->block_end = (end + ECS_ZONE_BLOCK_SIZE - 1) / 
+                ECS_ZONE_BLOCK_SIZE;
+        } else {
+            map = ecs_vector_get(chain_it->table->zone_maps, 
+                ecs_zone_map_t, iter->zone_map);
+        }
+
+        /* Find next sequence of blocks that overlap with the range */
+        ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+        int32_t b = iter->block, b_end = iter->block_end;
+        while (b < b_end && !range_overlaps(iter, &blocks[b])) {
+            b ++;
+        }
+
+        first = b;
+        while (b < b_end && range_overlaps(iter, &blocks[b])) {
+            b ++;
+        }
+
+        iter->block = b;
+    } while (first == iter->block);
+
+    /* Copy everything up to the private iterator data */
+    ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+    it->is_instanced = instanced;
+
+    /* Multiple ranges can be returned for the same result of the chained 
+     * iterator, so don't offset the term data of the chained iterator. */
+    copy_chain_ptrs(it, &iter->ptrs);
+
+    end = iter->block * ECS_ZONE_BLOCK_SIZE;
+    if (end > (chain_it->offset + chain_it->count)) {
+        end = chain_it->offset + chain_it->count;
+    }
+
+    first *= ECS_ZONE_BLOCK_SIZE;
+    if (first < chain_it->offset) {
+        first = chain_it->offset;
+    }
+
+    int32_t offset = first - chain_it->offset;
+    it->frame_offset += offset;
+
+    offset_iter(it, offset);
+    it->count = end - first;
+
+    if (it->is_instanced) {
+        it->offset += offset;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+done:
+    range_iter_fini(it);
+error:
+    return false;
+}
+
+bool ecs_range_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_range_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    it->chain_it->is_instanced = true;
+
+    if (flecs_iter_next_row(it)) {
+        return true;
+    }
+
+    return flecs_iter_next_instanced(it, ecs_range_next_instanced(it));
+error:
+    return false;
+}
+
+#endif
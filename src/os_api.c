@@ -409,7 +409,9 @@ bool ecs_os_has_threading(void) {
         (ecs_os_api.cond_signal_ != NULL) &&
         (ecs_os_api.cond_broadcast_ != NULL) &&
         (ecs_os_api.thread_new_ != NULL) &&
-        (ecs_os_api.thread_join_ != NULL);   
+        (ecs_os_api.thread_join_ != NULL) &&
+        (ecs_os_api.ainc_ != NULL) &&
+        (ecs_os_api.adec_ != NULL);   
 }
 
 bool ecs_os_has_time(void) {
@@ -238,6 +238,7 @@ typedef struct {
     ecs_entity_t scope;
     ecs_entity_t with;
     ecs_vector_t *defer_queue;
+    ecs_stack_cursor_t defer_cursor;
     ecs_stage_t *stage;
 } ecs_suspend_readonly_state_t;
 
@@ -362,6 +363,14 @@ bool flecs_defer_purge(
     ecs_world_t *world,
     ecs_stage_t *stage);
 
+bool flecs_defer_sort(
+    ecs_stage_t *stage);
+
+void flecs_defer_flush_stages(
+    ecs_world_t *world,
+    ecs_stage_t **stages,
+    int32_t count);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Notifications
@@ -393,6 +402,18 @@ ecs_table_t* flecs_table_find_or_create(
     ecs_world_t *world,
     const ecs_ids_t *type);
 
+/** Create new chunk for chunked table */
+ecs_table_t* flecs_table_new_chunk(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/** Find chunk of chunked table with space for entities. If count is not NULL,
+ * it is decreased to the number of entities that fit in the chunk. */
+ecs_table_t* flecs_table_chunk_for_append(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t *count);
+
 /* Initialize columns for data */
 void flecs_table_init_data(
     ecs_world_t *world,
@@ -440,6 +461,16 @@ void flecs_table_delete(
     int32_t index,
     bool destruct);
 
+/* Delete a range of entities from the table. Rows from the end of the table
+ * are moved to the deleted range. */
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t index,
+    int32_t count,
+    bool destruct);
+
 /* Increase refcount of table (prevents deletion) */
 void flecs_table_claim(
     ecs_world_t *world,
@@ -472,6 +503,19 @@ void flecs_table_move(
     int32_t old_index,
     bool construct);
 
+/* Move a range of rows from one table to another. The rows must already have
+ * been appended to the new table, with the same entity ids. */
+void flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    int32_t new_index,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    int32_t old_index,
+    int32_t count,
+    bool construct);
+
 /* Grow table with specified number of records. Populate table with entities,
  * starting from specified entity id. */
 int32_t flecs_table_appendn(
@@ -479,7 +523,8 @@ int32_t flecs_table_appendn(
     ecs_table_t *table,
     ecs_data_t *data,
     int32_t count,
-    const ecs_entity_t *ids);
+    const ecs_entity_t *ids,
+    bool construct);
 
 /* Set table to a fixed size. Useful for preallocating memory in advance. */
 void flecs_table_set_size(
@@ -492,6 +537,17 @@ void flecs_table_set_size(
 int32_t* flecs_table_get_dirty_state(
     ecs_table_t *table);
 
+/* Get dirty state for rows in table column (storage index). Contains for each
+ * row the column dirty state at the time the row was last marked dirty. Rows
+ * are only tracked after this function has been called for the column. Returns
+ * NULL if the rows don't contain all changes made after the 'since' column 
+ * state, or if tracking can't be enabled because workers are iterating. */
+int32_t* flecs_table_get_row_dirty_state(
+    const ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t since);
+
 /* Get monitor for monitoring table changes */
 int32_t* flecs_table_get_monitor(
     ecs_table_t *table);
@@ -535,6 +591,18 @@ void flecs_table_swap(
     int32_t row_1,
     int32_t row_2);
 
+/* Reorder count table rows starting at offset, so that row offset + i 
+ * contains the data of row rows[i]. The rows array must be a permutation of
+ * the rows in the range. It is used as scratch space and is invalid after the
+ * call. */
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t *rows,
+    int32_t offset,
+    int32_t count);
+
 ecs_table_t *flecs_table_traverse_add(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -550,7 +618,16 @@ ecs_table_t *flecs_table_traverse_remove(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component);
+    ecs_entity_t component,
+    int32_t row);
+
+/* Mark range of rows in column (storage index) dirty */
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count);
 
 const EcsComponent* flecs_component_from_id(
     const ecs_world_t *world,
@@ -570,6 +647,12 @@ void flecs_table_clear_edges(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Get number of outgoing edges of table and memory used by them */
+void flecs_table_graph_memory(
+    const ecs_table_t *table,
+    int32_t *edge_count,
+    int32_t *allocd);
+
 void flecs_table_delete_entities(
     ecs_world_t *world,
     ecs_table_t *table);
@@ -609,6 +692,104 @@ bool flecs_filter_match_table(
     bool first,
     int32_t skip_term);
 
+/* Initialize world cache with tables matched by filters */
+void flecs_filter_cache_init(
+    ecs_filter_cache_t *cache);
+
+/* Free world cache with tables matched by filters */
+void flecs_filter_cache_fini(
+    ecs_filter_cache_t *cache);
+
+/* Invalidate cached filter results when tables are created or deleted */
+void flecs_filter_cache_invalidate(
+    ecs_world_t *world);
+
+/* Invalidate cached results of filters that match components of supersets */
+void flecs_filter_cache_invalidate_supersets(
+    ecs_world_t *world);
+
+/* Test if the tables matched by the filter can be cached */
+bool flecs_filter_is_cacheable(
+    const ecs_filter_t *filter);
+
+/* Get (or populate) cache element with tables that match the filter. Returns
+ * NULL when the element can't be used, for example while in readonly mode. */
+ecs_filter_cache_elem_t* flecs_filter_cache_get(
+    ecs_world_t *world,
+    const ecs_filter_t *filter);
+
+/* Get next table from the cache element of a filter iterator */
+ecs_table_t* flecs_filter_cache_next(
+    ecs_filter_iter_t *iter);
+
+/* Initialize world closure indices */
+void flecs_closure_init(
+    ecs_world_t *world);
+
+/* Free world closure indices */
+void flecs_closure_fini(
+    ecs_world_t *world);
+
+/* Test if relation has a closure index */
+bool flecs_closure_is_indexed(
+    const ecs_world_t *world,
+    ecs_entity_t relation);
+
+/* Invalidate closures of relations in table */
+void flecs_closure_table_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Invalidate closures when an entity moves between tables, if the move can
+ * change the closure of a relation in the source or destination table */
+void flecs_closure_entity_move(
+    ecs_world_t *world,
+    ecs_table_t *src_table,
+    ecs_table_t *dst_table,
+    uint32_t row_flags,
+    const ecs_table_diff_t *diff);
+
+/* Remove table from closure indices */
+void flecs_closure_table_free(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get (or populate) supersets of table for relation. Returns NULL when the
+ * relation isn't indexed, or when the element can't be populated. */
+ecs_closure_elem_t* flecs_closure_get_supersets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    const ecs_table_t *table);
+
+/* Get (or populate) tables of subsets of entity for relation. Returns NULL when
+ * the relation isn't indexed, or when the element can't be populated. */
+ecs_closure_elem_t* flecs_closure_get_subsets(
+    const ecs_world_t *world,
+    ecs_entity_t relation,
+    ecs_entity_t entity);
+
+/* Free zone maps of table */
+void flecs_table_zone_maps_fini(
+    ecs_table_t *table);
+
+/* Mark blocks of zone maps for table column (storage index) dirty */
+void flecs_table_zone_maps_mark_dirty(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count);
+
+#ifdef FLECS_META
+/* Get (or create) up to date zone map for primitive member of table column.
+ * Returns NULL if the zone map is out of date and can't be updated. */
+ecs_zone_map_t* flecs_table_get_zone_map(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    ecs_primitive_kind_t kind,
+    bool can_update);
+#endif
+
 bool flecs_query_match(
     const ecs_world_t *world,
     const ecs_table_t *table,
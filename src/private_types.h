@@ -15,12 +15,33 @@
 
 #include "flecs.h"
 #include "datastructures/entity_index.h"
+#include "datastructures/stack_allocator.h"
+#include "flecs/private/allocator.h"
 #include "flecs/private/bitset.h"
 #include "flecs/private/switch_list.h"
 
 #define ECS_MAX_JOBS_PER_WORKER (16)
 #define ECS_MAX_ADD_REMOVE (32)
 
+/* Max number of out of order rows for which a sorted query table is fixed up
+ * with an insertion sort instead of a quicksort */
+#define ECS_SORT_INSERTION_THRESHOLD (16)
+
+/* Min number of rows for which a table is sorted with a radix sort when
+ * ordering by a primitive value */
+#define ECS_SORT_RADIX_THRESHOLD (64)
+
+/* When rows of a sorted query table changed, the changed rows are merged into
+ * the unchanged rows if at most 1 / ECS_SORT_MERGE_RATIO rows changed. 
+ * Otherwise the table is sorted again. */
+#define ECS_SORT_MERGE_RATIO (8)
+
+/* Max number of filters for which matched tables are cached by the world */
+#define ECS_FILTER_CACHE_SIZE (64)
+
+/* Number of rows for which a zone map stores the min/max of a member */
+#define ECS_ZONE_BLOCK_SIZE (256)
+
 /* Magic number for a flecs object */
 #define ECS_OBJECT_MAGIC (0x6563736f)
 
@@ -147,6 +168,7 @@ struct ecs_data_t {
 #define EcsTableHasUnSet            32768u
 #define EcsTableHasSwitch           65536u
 #define EcsTableHasDisabled         131072u
+#define EcsTableHasClosure          262144u /* Does table have pairs for relation with closure index */
 
 /* Composite constants */
 #define EcsTableHasLifecycle        (EcsTableHasCtors | EcsTableHasDtors)
@@ -177,10 +199,16 @@ typedef struct ecs_graph_edge_t {
     ecs_id_t id;             /* Id associated with edge */
 } ecs_graph_edge_t;
 
-/* Edges to other tables. */
+/* Number of words in bitmask with a bit for each low id */
+#define ECS_GRAPH_LO_MASK_COUNT (ECS_HI_COMPONENT_ID / 64)
+
+/* Edges to other tables. Low edges are stored in an array ordered by id, that
+ * only contains the ids that have a bit set in lo_mask. The index of an edge is
+ * the number of bits set in the mask before the bit of the id. */
 typedef struct ecs_graph_edges_t {
-    ecs_graph_edge_t *lo; /* Small array optimized for low edges */
-    ecs_map_t hi;  /* Map for hi edges (map<id, edge_t>) */
+    uint64_t lo_mask[ECS_GRAPH_LO_MASK_COUNT]; /* Low ids with an edge */
+    ecs_graph_edge_t **lo; /* Edges for low ids */
+    ecs_map_t hi;  /* Map for hi edges (map<id, edge_t*>) */
 } ecs_graph_edges_t;
 
 /* Table graph node */
@@ -193,6 +221,35 @@ typedef struct ecs_graph_node_t {
     ecs_graph_edge_hdr_t refs;
 } ecs_graph_node_t;
 
+/** Min/max of member values for a range of rows */
+typedef struct ecs_zone_t {
+    double min;
+    double max;
+    bool dirty;                      /* Values changed since min/max computed */
+} ecs_zone_t;
+
+/** Min/max statistics for a primitive member of a table column. Statistics are
+ * stored for the entire table, and for each block of ECS_ZONE_BLOCK_SIZE rows,
+ * so that iterators can skip tables and blocks that can't match a range. */
+typedef struct ecs_zone_map_t {
+    int32_t column;                  /* Storage column */
+    int32_t offset;                  /* Offset of member in component */
+    int32_t kind;                    /* Primitive kind of member */
+    int32_t table_state;             /* Table dirty state at last update */
+    bool dirty;                      /* Does map have dirty blocks */
+    ecs_zone_t table;                /* Min/max of all rows in table */
+    ecs_vector_t *blocks;            /* vector<ecs_zone_t> */
+} ecs_zone_map_t;
+
+/** Dirty state of the rows of a table column. Row arrays are only resized when
+ * the table gains or loses entities, which doesn't happen while the table is
+ * iterated by worker threads. */
+typedef struct ecs_row_dirty_state_t {
+    ecs_vector_t *rows;              /* vector<int32_t>, state of each row */
+    int32_t column_state;            /* Column state when rows were marked */
+    int32_t untracked_state;         /* Last column state not marked in rows */
+} ecs_row_dirty_state_t;
+
 /** A table is the Flecs equivalent of an archetype. Tables store all entities
  * with a specific set of components. Tables are automatically created when an
  * entity has a set of components not previously observed before. When a new
@@ -217,8 +274,16 @@ struct ecs_table_t {
     ecs_type_info_t **c_info;        /* Cached pointers to component info */
 
     int32_t *dirty_state;            /* Keep track of changes in columns */
+    ecs_row_dirty_state_t *row_dirty_state; /* Per column state of rows */
+    ecs_vector_t *zone_maps;         /* vector<ecs_zone_map_t> */
     int32_t alloc_count;             /* Increases when columns are reallocd */
 
+    ecs_table_t *chunk_root;         /* Table that owns chunk (NULL if root) */
+    ecs_vector_t *chunks;            /* vector<ecs_table_t*> (root only) */
+    int32_t chunk_capacity;          /* Entities per chunk (0 if not chunked) */
+    int32_t chunk_index;             /* Index of chunk (0 for root) */
+    int32_t chunk_free;              /* Lowest chunk that may have space */
+
     int32_t sw_column_count;
     int32_t sw_column_offset;
     int32_t bs_column_count;
@@ -364,6 +429,7 @@ struct ecs_query_t {
     /* Used for sorting */
     ecs_entity_t order_by_component;
     ecs_order_by_action_t order_by;
+    int32_t order_by_kind; /* Primitive kind if ordering by primitive value */
     ecs_vector_t *table_slices;     
 
     /* Used for grouping */
@@ -461,6 +527,12 @@ struct ecs_stage_t {
     /* Are operations deferred? */
     int32_t defer;
     ecs_vector_t *defer_queue;
+    ecs_stack_t defer_stack;     /* Temp memory used by deferred operations */
+    ecs_stack_cursor_t defer_cursor; /* Start of values for current queue */
+
+    ecs_stack_t frame_stack;     /* Temp memory, reset at end of frame */
+
+    int32_t job_cursor;          /* Next job in worker queue of stage */
 
     ecs_world_t *thread_ctx;     /* Points to stage when a thread stage */
     ecs_world_t *world;          /* Reference to world */
@@ -536,6 +608,61 @@ typedef struct ecs_store_t {
     ecs_graph_edge_hdr_t *first_free;
 } ecs_store_t;
 
+/** Tables matched by a filter, stored in the world filter cache */
+typedef struct ecs_filter_cache_elem_t {
+    uint64_t hash;               /* Hash of signature */
+    ecs_vector_t *signature;     /* vector<uint64_t>, filter term ids & flags */
+    ecs_vector_t *tables;        /* vector<ecs_table_t*> */
+    int32_t generation;          /* Cache generation when tables were matched */
+    int32_t superset_generation; /* Superset generation when tables were matched */
+    int32_t version;             /* Increases when element is reused */
+    bool match_supersets;        /* Does filter match components of supersets */
+    int32_t prev, next;          /* Least recently used list */
+} ecs_filter_cache_elem_t;
+
+/** World cache with matched tables for filters. The cache is invalidated when
+ * tables are created or deleted. Elements of filters that match components of
+ * supersets are also invalidated when an entity that is used as the object of
+ * a pair changes tables. */
+typedef struct ecs_filter_cache_t {
+    ecs_map_t index;             /* map<hash, elem index> */
+    ecs_filter_cache_elem_t elems[ECS_FILTER_CACHE_SIZE];
+    int32_t count;
+    int32_t first, last;         /* Most/least recently used element */
+    int32_t generation;          /* Increases when tables are created/deleted */
+    int32_t superset_generation; /* Increases when pair objects change table */
+} ecs_filter_cache_t;
+
+/** Node in the superset closure of a table. Nodes are stored in depth first
+ * order, so that the nodes of the subtree of an ancestor directly follow it. */
+typedef struct ecs_closure_node_t {
+    ecs_entity_t entity;         /* Ancestor (object of relation) */
+    int32_t depth;               /* Distance to table (1 = direct object) */
+    int32_t end;                 /* Index after last node in subtree */
+} ecs_closure_node_t;
+
+/** Table in the subset closure of an entity */
+typedef struct ecs_closure_table_t {
+    ecs_table_t *table;          /* Table with (relation, subset/entity) */
+    int32_t column;              /* Column of pair in table type */
+} ecs_closure_table_t;
+
+typedef struct ecs_closure_elem_t {
+    ecs_vector_t *nodes;         /* vector<ecs_closure_node_t|table_t> */
+    int32_t generation;          /* Closure generation when elem was filled */
+    bool pruned;                 /* Were nodes reachable by more than one path */
+} ecs_closure_elem_t;
+
+/** Closure index for a single relation. Elements are filled on demand and 
+ * are invalidated when entities are added to or removed from tables that have
+ * the relation. */
+typedef struct ecs_closure_t {
+    ecs_entity_t relation;
+    ecs_map_t supersets;         /* map<table_id, ecs_closure_elem_t*> */
+    ecs_map_t subsets;           /* map<entity, ecs_closure_elem_t*> */
+    int32_t generation;          /* Increases when relation pairs change */
+} ecs_closure_t;
+
 /** Supporting type to store looked up or derived entity data */
 typedef struct ecs_entity_info_t {
     ecs_record_t *record;       /* Main stage record in entity index */
@@ -585,6 +712,7 @@ struct ecs_world_t {
     /* --  Data storage -- */
 
     ecs_store_t store;
+    ecs_allocator_t allocator;     /* Pools for storage that grows/shrinks */
 
 
     /* --  Storages for API objects -- */
@@ -610,6 +738,12 @@ struct ecs_world_t {
      * monitors are evaluated during a merge. */
     ecs_relation_monitor_t monitors;
 
+    /* Tables matched by cached filters */
+    ecs_filter_cache_t filter_cache;
+
+    /* Closure indices for traversed relations */
+    ecs_map_t closures;          /* map<relation, ecs_closure_t*> */
+
 
     /* -- Systems -- */
 
@@ -642,6 +776,9 @@ struct ecs_world_t {
     ecs_os_mutex_t sync_mutex;   /* Mutex for job_cond */
     int32_t workers_running;     /* Number of threads running */
     int32_t workers_waiting;     /* Number of workers waiting on sync */
+    int32_t workers_parked;      /* Number of workers blocked on worker_cond */
+    int32_t sync_parked;         /* Main thread is blocked on sync_cond */
+    int32_t sync_gen;            /* Incremented each time workers are signaled */
 
 
     /* -- Time management -- */
@@ -678,12 +815,15 @@ struct ecs_world_t {
     /* -- World state -- */
 
     bool quit_workers;           /* Signals worker threads to quit */
+    bool concurrent_systems;     /* Run single threaded systems concurrently */
     bool is_readonly;            /* Is world being progressed */
+    bool is_in_frame;            /* Is world between frame begin and end */
     bool is_fini;                /* Is the world being cleaned up? */
     bool measure_frame_time;     /* Time spent on each frame */
     bool measure_system_time;    /* Time spent by each system */
     bool should_quit;            /* Did a system signal that app should quit */
     bool locking_enabled;        /* Lock world when in progress */ 
+    bool merge_by_entity;        /* Merge stages in entity order */
 
     void *context;               /* Application context */
     ecs_vector_t *fini_actions;  /* Callbacks to execute when world exits */
@@ -1441,22 +1441,481 @@ void qsort_array(
     qsort_array(world, table, data, entities, ptr, size, p + 1, hi, compare); 
 }
 
+#ifdef FLECS_META
+
+/* Comparators returned by ecs_meta_order_by. Queries that use one of these
+ * sort large tables with a radix sort. */
+#define FLECS_COMPARE_PRIMITIVE(T)\
+    static\
+    int compare_##T(\
+        ecs_entity_t e1,\
+        const void *ptr1,\
+        ecs_entity_t e2,\
+        const void *ptr2)\
+    {\
+        (void)e1; (void)e2;\
+        T v1 = *(const T*)ptr1;\
+        T v2 = *(const T*)ptr2;\
+        return (v1 > v2) - (v1 < v2);\
+    }
+
+FLECS_COMPARE_PRIMITIVE(ecs_bool_t)
+FLECS_COMPARE_PRIMITIVE(ecs_char_t)
+FLECS_COMPARE_PRIMITIVE(ecs_byte_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u8_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u16_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u32_t)
+FLECS_COMPARE_PRIMITIVE(ecs_u64_t)
+FLECS_COMPARE_PRIMITIVE(ecs_uptr_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i8_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i16_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i32_t)
+FLECS_COMPARE_PRIMITIVE(ecs_i64_t)
+FLECS_COMPARE_PRIMITIVE(ecs_iptr_t)
+FLECS_COMPARE_PRIMITIVE(ecs_f32_t)
+FLECS_COMPARE_PRIMITIVE(ecs_f64_t)
+FLECS_COMPARE_PRIMITIVE(ecs_entity_t)
+
+/* Find primitive kind of component, or of the first member of a struct */
 static
-void sort_table(
+ecs_primitive_kind_t order_by_primitive_kind(
+    const ecs_world_t *world,
+    ecs_entity_t component)
+{
+    const EcsPrimitive *ptr = ecs_get(world, component, EcsPrimitive);
+    if (!ptr) {
+        const EcsStruct *st = ecs_get(world, component, EcsStruct);
+        if (st && ecs_vector_count(st->members)) {
+            ecs_member_t *m = ecs_vector_first(st->members, ecs_member_t);
+            if (!m->offset && m->count == 1) {
+                ptr = ecs_get(world, m->type, EcsPrimitive);
+            }
+        }
+    }
+
+    if (!ptr || ptr->kind == EcsString) {
+        return 0;
+    }
+
+    return ptr->kind;
+}
+
+static
+ecs_order_by_action_t order_by_primitive_compare(
+    ecs_primitive_kind_t kind)
+{
+    switch(kind) {
+    case EcsBool: return compare_ecs_bool_t;
+    case EcsChar: return compare_ecs_char_t;
+    case EcsByte: return compare_ecs_byte_t;
+    case EcsU8: return compare_ecs_u8_t;
+    case EcsU16: return compare_ecs_u16_t;
+    case EcsU32: return compare_ecs_u32_t;
+    case EcsU64: return compare_ecs_u64_t;
+    case EcsUPtr: return compare_ecs_uptr_t;
+    case EcsI8: return compare_ecs_i8_t;
+    case EcsI16: return compare_ecs_i16_t;
+    case EcsI32: return compare_ecs_i32_t;
+    case EcsI64: return compare_ecs_i64_t;
+    case EcsIPtr: return compare_ecs_iptr_t;
+    case EcsF32: return compare_ecs_f32_t;
+    case EcsF64: return compare_ecs_f64_t;
+    case EcsEntity: return compare_ecs_entity_t;
+    default: return NULL;
+    }
+}
+
+ecs_order_by_action_t ecs_meta_order_by(
+    const ecs_world_t *world,
+    ecs_entity_t type)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(type != 0, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    return order_by_primitive_compare(order_by_primitive_kind(world, type));
+error:
+    return NULL;
+}
+
+/* Convert primitive value to unsigned key with the same ordering */
+static
+uint64_t radix_key(
+    ecs_primitive_kind_t kind,
+    const void *ptr)
+{
+    const uint64_t sign = 1ull << 63;
+
+    switch(kind) {
+    case EcsBool: return *(const ecs_bool_t*)ptr;
+    case EcsByte: return *(const ecs_byte_t*)ptr;
+    case EcsU8: return *(const ecs_u8_t*)ptr;
+    case EcsU16: return *(const ecs_u16_t*)ptr;
+    case EcsU32: return *(const ecs_u32_t*)ptr;
+    case EcsU64: return *(const ecs_u64_t*)ptr;
+    case EcsUPtr: return *(const ecs_uptr_t*)ptr;
+    case EcsEntity: return *(const ecs_entity_t*)ptr;
+    case EcsChar: return (uint64_t)(int64_t)*(const ecs_char_t*)ptr ^ sign;
+    case EcsI8: return (uint64_t)(int64_t)*(const ecs_i8_t*)ptr ^ sign;
+    case EcsI16: return (uint64_t)(int64_t)*(const ecs_i16_t*)ptr ^ sign;
+    case EcsI32: return (uint64_t)(int64_t)*(const ecs_i32_t*)ptr ^ sign;
+    case EcsI64: return (uint64_t)*(const ecs_i64_t*)ptr ^ sign;
+    case EcsIPtr: return (uint64_t)(int64_t)*(const ecs_iptr_t*)ptr ^ sign;
+    case EcsF32:
+    case EcsF64: {
+        /* Flip all bits of negative numbers, and the sign bit of positive
+         * numbers so that the bit pattern sorts like the value */
+        ecs_f64_t v;
+        if (kind == EcsF32) {
+            v = (ecs_f64_t)*(const ecs_f32_t*)ptr;
+        } else {
+            v = *(const ecs_f64_t*)ptr;
+        }
+        uint64_t bits;
+        ecs_os_memcpy(&bits, &v, ECS_SIZEOF(uint64_t));
+        if (bits & sign) {
+            return ~bits;
+        } else {
+            return bits | sign;
+        }
+    }
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+/* Sort table with an LSD radix sort on the primitive value of the order_by
+ * component. The sort computes a permutation of row indices first, so that
+ * table rows only have to be moved once. */
+static
+void radix_sort_table(
     ecs_world_t *world,
     ecs_table_t *table,
-    int32_t column_index,
+    ecs_data_t *data,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_primitive_kind_t kind)
+{
+    uint64_t *keys = ecs_os_malloc_n(uint64_t, count * 2);
+    int32_t *rows = ecs_os_malloc_n(int32_t, count * 2);
+    uint64_t *keys_tmp = &keys[count];
+    int32_t *rows_tmp = &rows[count];
+    int32_t i, shift;
+
+    /* Compute histograms for all digits in a single pass over the keys */
+    int32_t histogram[8][256] = {{0}};
+    for (i = 0; i < count; i ++) {
+        uint64_t key = keys[i] = radix_key(kind, ECS_ELEM(ptr, size, i));
+        rows[i] = i;
+        for (shift = 0; shift < 8; shift ++) {
+            histogram[shift][(key >> (shift * 8)) & 0xFF] ++;
+        }
+    }
+
+    for (shift = 0; shift < 64; shift += 8) {
+        int32_t *offsets = histogram[shift / 8];
+
+        /* Skip pass if all keys have the same digit */
+        if (offsets[(keys[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        int32_t b, offset = 0;
+        for (b = 0; b < 256; b ++) {
+            int32_t b_count = offsets[b];
+            offsets[b] = offset;
+            offset += b_count;
+        }
+
+        for (i = 0; i < count; i ++) {
+            int32_t dst = offsets[(keys[i] >> shift) & 0xFF] ++;
+            keys_tmp[dst] = keys[i];
+            rows_tmp[dst] = rows[i];
+        }
+
+        uint64_t *keys_swap = keys; keys = keys_tmp; keys_tmp = keys_swap;
+        int32_t *rows_swap = rows; rows = rows_tmp; rows_tmp = rows_swap;
+    }
+
+    flecs_table_permute(world, table, data, rows, 0, count);
+
+    ecs_os_free(ECS_MIN(keys, keys_tmp));
+    ecs_os_free(ECS_MIN(rows, rows_tmp));
+}
+
+#endif
+
+/* Sort all rows of a table. The radix sort and insertion sort preserve the
+ * order of rows with equal keys, the quicksort does not. The order of rows that
+ * compare equal is therefore undefined after a sort. */
+static
+void sort_table_rows(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare,
+    int32_t kind)
+{
+#ifdef FLECS_META
+    if (kind && count >= ECS_SORT_RADIX_THRESHOLD) {
+        radix_sort_table(world, table, data, ptr, size, count, 
+            (ecs_primitive_kind_t)kind);
+        return;
+    }
+#else
+    (void)kind;
+#endif
+
+    qsort_array(world, table, data, entities, ptr, size, 0, count - 1, compare);
+}
+
+static
+void insertion_sort_array(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t first,
+    int32_t count,
+    ecs_order_by_action_t compare)
+{
+    int32_t i, j;
+    for (i = first; i < count; i ++) {
+        for (j = i; j > 0; j --) {
+            void *el_1 = ECS_ELEM(ptr, size, j - 1);
+            void *el_2 = ECS_ELEM(ptr, size, j);
+            if (compare(entities[j - 1], el_1, entities[j], el_2) <= 0) {
+                break;
+            }
+
+            flecs_table_swap(world, table, data, j - 1, j);
+        }
+    }
+}
+
+/* Sort row indices by value with a merge sort */
+static
+void sort_rows(
+    const ecs_entity_t *entities,
+    const void *ptr,
+    int32_t size,
+    int32_t *rows,
+    int32_t *tmp,
+    int32_t count,
     ecs_order_by_action_t compare)
+{
+    if (count < 2) {
+        return;
+    }
+
+    int32_t half = count / 2;
+    sort_rows(entities, ptr, size, rows, tmp, half, compare);
+    sort_rows(entities, ptr, size, &rows[half], tmp, count - half, compare);
+
+    int32_t i = 0, j = half, k = 0;
+    while (i < half && j < count) {
+        int32_t r1 = rows[i], r2 = rows[j];
+        if (compare(entities[r2], ECS_ELEM(ptr, size, r2), 
+            entities[r1], ECS_ELEM(ptr, size, r1)) < 0) 
+        {
+            tmp[k ++] = r2;
+            j ++;
+        } else {
+            tmp[k ++] = r1;
+            i ++;
+        }
+    }
+
+    while (i < half) {
+        tmp[k ++] = rows[i ++];
+    }
+    while (j < count) {
+        tmp[k ++] = rows[j ++];
+    }
+
+    ecs_os_memcpy_n(rows, tmp, int32_t, count);
+}
+
+/* Find index in sorted rows before which row should be inserted */
+static
+int32_t find_insert_row(
+    const ecs_entity_t *entities,
+    const void *ptr,
+    int32_t size,
+    const int32_t *rows,
+    int32_t count,
+    int32_t row,
+    ecs_order_by_action_t compare)
+{
+    const void *el = ECS_ELEM(ptr, size, row);
+    int32_t lo = 0, hi = count;
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2, cur = rows[mid];
+        if (compare(entities[row], el, 
+            entities[cur], ECS_ELEM(ptr, size, cur)) < 0) 
+        {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
+/* Rows of a table that moved after merging changed rows into unchanged rows.
+ * Used to patch sorted table slices without comparing all rows again. */
+typedef struct sort_patch_t {
+    ecs_query_table_match_t *match;
+    int32_t *new_rows;      /* New row for each old row, -1 if row changed */
+    int32_t *changed;       /* New rows of changed rows, in sorted order */
+    int32_t changed_count;
+} sort_patch_t;
+
+/* Sort table of which only rows with a row state newer than 'since' changed
+ * since the last sort. The other rows are still in order. The algorithm is
+ * selected by the number of changed rows:
+ * - no changed rows: the table is left untouched, without comparing rows
+ * - up to count / ECS_SORT_MERGE_RATIO: the changed rows are sorted, and their
+ *   positions among the unchanged rows are found with a binary search. Only
+ *   the range of rows that moved is then reordered. The new rows are stored in
+ *   patch, which is used to patch the sorted table slices.
+ * - otherwise: the table is sorted again with sort_table_rows.
+ * Returns whether rows were moved. */
+static
+bool sort_changed_rows(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    ecs_entity_t *entities,
+    void *ptr,
+    int32_t size,
+    int32_t count,
+    ecs_order_by_action_t compare,
+    int32_t kind,
+    const int32_t *row_states,
+    int32_t since,
+    sort_patch_t *patch)
+{
+    int32_t i, changed_count = 0;
+    for (i = 0; i < count; i ++) {
+        changed_count += row_states[i] > since;
+    }
+
+    if (!changed_count) {
+        return false;
+    }
+
+    if (changed_count > count / ECS_SORT_MERGE_RATIO) {
+        sort_table_rows(
+            world, table, data, entities, ptr, size, count, compare, kind);
+        return true;
+    }
+
+    /* Split rows in unchanged rows, which are still in order, and changed 
+     * rows. The second half of the buffer holds the new order of the rows. */
+    int32_t unchanged_count = count - changed_count;
+    int32_t *rows = ecs_os_malloc_n(int32_t, count * 2);
+    int32_t *unchanged = rows, *changed = &rows[unchanged_count];
+    int32_t *order = &rows[count];
+    int32_t u = 0, c = 0;
+    for (i = 0; i < count; i ++) {
+        if (row_states[i] > since) {
+            changed[c ++] = i;
+        } else {
+            unchanged[u ++] = i;
+        }
+    }
+
+    sort_rows(entities, ptr, size, changed, order, changed_count, compare);
+
+    /* Merge changed rows into unchanged rows */
+    int32_t prev = 0, out = 0;
+    for (c = 0; c < changed_count; c ++) {
+        int32_t row = changed[c];
+        int32_t pos = prev + find_insert_row(entities, ptr, size, 
+            &unchanged[prev], unchanged_count - prev, row, compare);
+        for (; prev < pos; prev ++) {
+            order[out ++] = unchanged[prev];
+        }
+        order[out ++] = row;
+    }
+    for (; prev < unchanged_count; prev ++) {
+        order[out ++] = unchanged[prev];
+    }
+
+    /* Store new rows before order is used to permute the table */
+    patch->new_rows = ecs_os_malloc_n(int32_t, count + changed_count);
+    patch->changed = &patch->new_rows[count];
+    patch->changed_count = changed_count;
+    for (i = 0, c = 0; i < count; i ++) {
+        int32_t row = order[i];
+        if (row_states[row] > since) {
+            patch->new_rows[row] = -1;
+            patch->changed[c ++] = i;
+        } else {
+            patch->new_rows[row] = i;
+        }
+    }
+
+    /* Only reorder the range of rows that moved */
+    int32_t first = 0, last = count - 1;
+    while (first < count && order[first] == first) {
+        first ++;
+    }
+    while (last > first && order[last] == last) {
+        last --;
+    }
+
+    bool moved = first < count;
+    if (moved) {
+        flecs_table_permute(world, table, data, &order[first], first, 
+            last - first + 1);
+    }
+
+    ecs_os_free(rows);
+
+    return moved;
+}
+
+/* Sort table. When only component values changed since the last sort
+ * (incremental is true) the table is often still (almost) in order. If the
+ * table tracks which rows changed (row_states is not NULL), the algorithm is
+ * selected by sort_changed_rows, which may store the new rows in patch.
+ * Otherwise first count the number of rows that
+ * are out of order. If there are none the table is left untouched, if there 
+ * are only a few the table is fixed up with an insertion sort, which only moves
+ * the rows that are out of place. Other tables fall back to sort_table_rows,
+ * which does not preserve the order of rows with equal keys. Returns whether
+ * rows were moved. */
+static
+bool sort_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column_index,
+    ecs_order_by_action_t compare,
+    int32_t kind,
+    bool incremental,
+    const int32_t *row_states,
+    int32_t since,
+    sort_patch_t *patch)
 {
     ecs_data_t *data = &table->storage;
     if (!data->entities) {
         /* Nothing to sort */
-        return;
+        return false;
     }
 
     int32_t count = flecs_table_data_count(data);
     if (count < 2) {
-        return;
+        return false;
     }
 
     ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
@@ -1469,7 +1928,44 @@ void sort_table(
         ptr = ecs_vector_first_t(column->data, size, column->alignment);
     }
 
-    qsort_array(world, table, data, entities, ptr, size, 0, count - 1, compare);
+    if (!incremental) {
+        sort_table_rows(
+            world, table, data, entities, ptr, size, count, compare, kind);
+        return true;
+    }
+
+    if (row_states) {
+        return sort_changed_rows(world, table, data, entities, ptr, size, 
+            count, compare, kind, row_states, since, patch);
+    }
+
+    int32_t i, first = 0, unsorted = 0;
+    for (i = 1; i < count; i ++) {
+        void *el_1 = ECS_ELEM(ptr, size, i - 1);
+        void *el_2 = ECS_ELEM(ptr, size, i);
+        if (compare(entities[i - 1], el_1, entities[i], el_2) > 0) {
+            if (!unsorted) {
+                first = i;
+            }
+            if (++ unsorted > ECS_SORT_INSERTION_THRESHOLD) {
+                break;
+            }
+        }
+    }
+
+    if (!unsorted) {
+        return false;
+    }
+
+    if (unsorted <= ECS_SORT_INSERTION_THRESHOLD) {
+        insertion_sort_array(
+            world, table, data, entities, ptr, size, first, count, compare);
+    } else {
+        sort_table_rows(
+            world, table, data, entities, ptr, size, count, compare, kind);
+    }
+
+    return true;
 }
 
 /* Helper struct for building sorted table ranges */
@@ -1508,15 +2004,156 @@ ecs_entity_t e_from_helper(
     }
 }
 
+/* Initialize helper for the rows of a table match. Returns false if the table
+ * has no entities. */
 static
-void build_sorted_table_range(
+bool init_sort_helper(
     ecs_query_t *query,
-    ecs_query_table_list_t *list)
+    ecs_query_table_match_t *match,
+    sort_helper_t *helper)
 {
     ecs_world_t *world = query->world;
     ecs_entity_t id = query->order_by_component;
+    ecs_table_t *table = match->table;
+    ecs_data_t *data = &table->storage;
+    ecs_vector_t *entities;
+
+    if (!(entities = data->entities) || !ecs_table_count(table)) {
+        return false;
+    }
+
+    int32_t index = -1;
+    if (id) {
+        index = ecs_search(world, table->storage_table, id, 0);
+    }
+
+    if (index != -1) {
+        ecs_column_t *column = &data->columns[index];
+        int16_t size = column->size;
+        int16_t align = column->alignment;
+        helper->ptr = ecs_vector_first_t(column->data, size, align);
+        helper->elem_size = size;
+        helper->shared = false;
+    } else if (id) {
+        /* Find component in prefab */
+        ecs_entity_t base = 0;
+        ecs_search_relation(world, table, 0, id, 
+            EcsIsA, 1, 0, &base, NULL, NULL);
+
+        /* If a base was not found, the query should not have allowed using
+         * the component for sorting */
+        ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
+
+        const EcsComponent *cptr = ecs_get(world, id, EcsComponent);
+        ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        helper->ptr = ecs_get_id(world, base, id);
+        helper->elem_size = cptr->size;
+        helper->shared = true;
+    } else {
+        helper->ptr = NULL;
+        helper->elem_size = 0;
+        helper->shared = false;
+    }
+
+    helper->match = match;
+    helper->entities = ecs_vector_first(entities, ecs_entity_t);
+    helper->row = 0;
+    helper->count = ecs_table_count(table);
+
+    return true;
+}
+
+/* Merge the remaining rows of helpers into slices, which are appended to the
+ * vector with sorted table slices. Rows that continue the last slice in the
+ * vector are added to that slice. */
+static
+void merge_sorted_rows(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t to_sort)
+{
     ecs_order_by_action_t compare = query->order_by;
-    
+    ecs_query_table_node_t *cur = ecs_vector_last(
+        query->table_slices, ecs_query_table_node_t);
+
+    bool proceed;
+    do {
+        int32_t j, min = 0;
+        proceed = true;
+
+        ecs_entity_t e1;
+        while (!(e1 = e_from_helper(&helper[min]))) {
+            min ++;
+            if (min == to_sort) {
+                proceed = false;
+                break;
+            }
+        }
+
+        if (!proceed) {
+            break;
+        }
+
+        for (j = min + 1; j < to_sort; j++) {
+            ecs_entity_t e2 = e_from_helper(&helper[j]);
+            if (!e2) {
+                continue;
+            }
+
+            const void *ptr1 = ptr_from_helper(&helper[min]);
+            const void *ptr2 = ptr_from_helper(&helper[j]);
+
+            if (compare(e1, ptr1, e2, ptr2) > 0) {
+                min = j;
+                e1 = e_from_helper(&helper[min]);
+            }
+        }
+
+        sort_helper_t *cur_helper = &helper[min];
+        if (!cur || cur->match != cur_helper->match || 
+            (cur->offset + cur->count) != cur_helper->row) 
+        {
+            cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
+            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
+            cur->match = cur_helper->match;
+            cur->offset = cur_helper->row;
+            cur->count = 1;
+        } else {
+            cur->count ++;
+        }
+
+        cur_helper->row ++;
+    } while (proceed);
+}
+
+/* Iterate through the vector of slices to set the prev/next ptrs. This can't be
+ * done while building the vector, as reallocs may occur */
+static
+void link_sorted_slices(
+    ecs_query_t *query)
+{
+    int32_t i, count = ecs_vector_count(query->table_slices);
+    if (!count) {
+        return;
+    }
+
+    ecs_query_table_node_t *nodes = ecs_vector_first(
+        query->table_slices, ecs_query_table_node_t);
+    for (i = 0; i < count; i ++) {
+        nodes[i].prev = &nodes[i - 1];
+        nodes[i].next = &nodes[i + 1];
+    }
+
+    nodes[0].prev = NULL;
+    nodes[i - 1].next = NULL;
+}
+
+static
+void build_sorted_table_range(
+    ecs_query_t *query,
+    ecs_query_table_list_t *list)
+{
     if (!list->count) {
         return;
     }
@@ -1526,150 +2163,279 @@ void build_sorted_table_range(
     sort_helper_t *helper = ecs_os_malloc_n(sort_helper_t, list->count);
     ecs_query_table_node_t *cur, *end = list->last->next;
     for (cur = list->first; cur != end; cur = cur->next) {
-        ecs_query_table_match_t *match = cur->match;
-        ecs_table_t *table = match->table;
-        ecs_data_t *data = &table->storage;
-        ecs_vector_t *entities;
-
-        if (!(entities = data->entities) || !ecs_table_count(table)) {
-            continue;
+        if (init_sort_helper(query, cur->match, &helper[to_sort])) {
+            to_sort ++;
         }
+    }
+
+    ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
+
+    merge_sorted_rows(query, helper, to_sort);
+    link_sorted_slices(query);
+
+    ecs_os_free(helper);
+}
+
+static
+void build_sorted_tables(
+    ecs_query_t *query)
+{
+    ecs_vector_clear(query->table_slices);
+
+    if (query->group_by) {
+        /* Populate sorted node list in grouping order */
+        ecs_query_table_node_t *cur = query->list.first;
+        if (cur) {
+            do {
+                /* Find list for current group */
+                ecs_query_table_match_t *match = cur->match;
+                ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
+                uint64_t group_id = match->group_id;
+                ecs_query_table_list_t *list = ecs_map_get(&query->groups, 
+                    ecs_query_table_list_t, group_id);
+                ecs_assert(list != NULL, ECS_INTERNAL_ERROR, NULL);
 
-        int32_t index = -1;
-        if (id) {
-            index = ecs_search(world, table->storage_table, id, 0);
+                /* Sort tables in current group */
+                build_sorted_table_range(query, list);
+                
+                /* Find next group to sort */
+                cur = list->last->next;
+            } while (cur);
         }
+    } else {
+        build_sorted_table_range(query, &query->list);
+    }
+}
+
+/* Row of a table match, used when patching sorted table slices */
+typedef struct sort_row_t {
+    ecs_query_table_match_t *match;
+    int32_t row;
+} sort_row_t;
+
+/* Get helper for table match. Helpers are initialized once per match. */
+static
+void get_slice_helper(
+    ecs_query_t *query,
+    ecs_map_t *helpers,
+    ecs_query_table_match_t *match,
+    sort_helper_t *out)
+{
+    ecs_map_key_t key = (ecs_map_key_t)(uintptr_t)match;
+    sort_helper_t *helper = ecs_map_get(helpers, sort_helper_t, key);
+    if (!helper) {
+        helper = ecs_map_ensure(helpers, sort_helper_t, key);
+        bool has_rows = init_sort_helper(query, match, helper);
+        ecs_assert(has_rows, ECS_INTERNAL_ERROR, NULL);
+        (void)has_rows;
+    }
+    *out = *helper;
+}
 
-        if (index != -1) {
-            ecs_column_t *column = &data->columns[index];
-            int16_t size = column->size;
-            int16_t align = column->alignment;
-            helper[to_sort].ptr = ecs_vector_first_t(column->data, size, align);
-            helper[to_sort].elem_size = size;
-            helper[to_sort].shared = false;
-        } else if (id) {
-            /* Find component in prefab */
-            ecs_entity_t base = 0;
-            ecs_search_relation(world, table, 0, id, 
-                EcsIsA, 1, 0, &base, NULL, NULL);
+static
+int compare_sort_rows(
+    ecs_query_t *query,
+    ecs_map_t *helpers,
+    sort_row_t r1,
+    sort_row_t r2)
+{
+    sort_helper_t h1, h2;
+    get_slice_helper(query, helpers, r1.match, &h1);
+    get_slice_helper(query, helpers, r2.match, &h2);
+    h1.row = r1.row;
+    h2.row = r2.row;
+    return query->order_by(e_from_helper(&h1), ptr_from_helper(&h1), 
+        e_from_helper(&h2), ptr_from_helper(&h2));
+}
 
-            /* If a base was not found, the query should not have allowed using
-             * the component for sorting */
-            ecs_assert(base != 0, ECS_INTERNAL_ERROR, NULL);
+/* Sort rows of table matches by value with a merge sort */
+static
+void sort_match_rows(
+    ecs_query_t *query,
+    ecs_map_t *helpers,
+    sort_row_t *rows,
+    sort_row_t *tmp,
+    int32_t count)
+{
+    if (count < 2) {
+        return;
+    }
 
-            const EcsComponent *cptr = ecs_get(world, id, EcsComponent);
-            ecs_assert(cptr != NULL, ECS_INTERNAL_ERROR, NULL);
+    int32_t half = count / 2;
+    sort_match_rows(query, helpers, rows, tmp, half);
+    sort_match_rows(query, helpers, &rows[half], tmp, count - half);
 
-            helper[to_sort].ptr = ecs_get_id(world, base, id);
-            helper[to_sort].elem_size = cptr->size;
-            helper[to_sort].shared = true;
+    int32_t i = 0, j = half, k = 0;
+    while (i < half && j < count) {
+        if (compare_sort_rows(query, helpers, rows[j], rows[i]) < 0) {
+            tmp[k ++] = rows[j ++];
         } else {
-            helper[to_sort].ptr = NULL;
-            helper[to_sort].elem_size = 0;
-            helper[to_sort].shared = false;
+            tmp[k ++] = rows[i ++];
         }
+    }
 
-        helper[to_sort].match = match;
-        helper[to_sort].entities = ecs_vector_first(entities, ecs_entity_t);
-        helper[to_sort].row = 0;
-        helper[to_sort].count = ecs_table_count(table);
-        to_sort ++;      
+    while (i < half) {
+        tmp[k ++] = rows[i ++];
+    }
+    while (j < count) {
+        tmp[k ++] = rows[j ++];
     }
 
-    ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_os_memcpy_n(rows, tmp, sort_row_t, count);
+}
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
+/* Append rows to sorted table slices. Rows that continue the last slice are
+ * added to that slice. */
+static
+void add_sorted_slice(
+    ecs_vector_t **slices,
+    ecs_query_table_match_t *match,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_query_table_node_t *last = ecs_vector_last(
+        *slices, ecs_query_table_node_t);
+    if (last && last->match == match && 
+        (last->offset + last->count) == offset) 
+    {
+        last->count += count;
+    } else {
+        ecs_query_table_node_t *slice = ecs_vector_add(
+            slices, ecs_query_table_node_t);
+        slice->match = match;
+        slice->offset = offset;
+        slice->count = count;
+    }
+}
 
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
+/* Patch sorted table slices after values changed, when no entities were added
+ * or removed. Tables in patches merged their changed rows into their unchanged
+ * rows, which kept their order. The slices are patched in two steps:
+ * - rows of slices are moved to their new row in the table, and changed rows
+ *   are left out. This doesn't compare rows, as the unchanged rows of all 
+ *   tables are still in order.
+ * - the changed rows of all tables are sorted, and inserted into the slices.
+ *   The slice and row before which a row is inserted are found with a binary
+ *   search.
+ * This avoids comparing all rows of all tables, which build_sorted_tables 
+ * does. */
+static
+void patch_sorted_tables(
+    ecs_query_t *query,
+    ecs_map_t *patches)
+{
+    ecs_vector_t *slices = query->table_slices;
+    int32_t i, s, count = ecs_vector_count(slices);
+    ecs_query_table_node_t *nodes = ecs_vector_first(
+        slices, ecs_query_table_node_t);
+    ecs_vector_t *unchanged = ecs_vector_new(ecs_query_table_node_t, count);
+    int32_t changed_count = 0;
+
+    /* Move slice rows to their new rows, leave out changed rows */
+    for (s = 0; s < count; s ++) {
+        ecs_query_table_node_t *slice = &nodes[s];
+        ecs_query_table_match_t *match = slice->match;
+        sort_patch_t *patch = ecs_map_get(patches, sort_patch_t, 
+            (ecs_map_key_t)(uintptr_t)match->table);
+        if (!patch) {
+            add_sorted_slice(&unchanged, match, slice->offset, slice->count);
+            continue;
+        }
+
+        for (i = slice->offset; i < slice->offset + slice->count; i ++) {
+            int32_t row = patch->new_rows[i];
+            if (row != -1) {
+                add_sorted_slice(&unchanged, match, row, 1);
+            }
+        }
+    }
+
+    /* Collect and sort changed rows of all tables */
+    ecs_map_iter_t it = ecs_map_iter(patches);
+    sort_patch_t *patch;
+    while ((patch = ecs_map_next(&it, sort_patch_t, NULL))) {
+        changed_count += patch->changed_count;
+    }
+
+    sort_row_t *changed = ecs_os_malloc_n(sort_row_t, changed_count * 2);
+    sort_row_t *tmp = &changed[changed_count];
+    int32_t c = 0;
+    it = ecs_map_iter(patches);
+    while ((patch = ecs_map_next(&it, sort_patch_t, NULL))) {
+        for (i = 0; i < patch->changed_count; i ++) {
+            changed[c].match = patch->match;
+            changed[c].row = patch->changed[i];
+            c ++;
+        }
+    }
+
+    ecs_map_t *helpers = ecs_map_new(sort_helper_t, 0);
+    sort_match_rows(query, helpers, changed, tmp, changed_count);
+
+    /* Insert changed rows. The first row of each slice is not smaller than the
+     * last row of the slice before it, so the slice with the first row that is
+     * larger than the changed row can be found with a binary search. */
+    int32_t unchanged_count = ecs_vector_count(unchanged);
+    nodes = ecs_vector_first(unchanged, ecs_query_table_node_t);
+    query->table_slices = ecs_vector_new(ecs_query_table_node_t, 
+        unchanged_count + changed_count);
+    s = 0;
+
+    for (c = 0; c < changed_count; c ++) {
+        sort_row_t row = changed[c];
+        int32_t lo = s, hi = unchanged_count;
+        while (lo < hi) {
+            int32_t mid = (lo + hi) / 2;
+            ecs_query_table_node_t *slice = &nodes[mid];
+            sort_row_t last = { slice->match, slice->offset + slice->count - 1};
+            if (compare_sort_rows(query, helpers, row, last) < 0) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
             }
         }
 
-        if (!proceed) {
-            break;
+        for (; s < lo; s ++) {
+            add_sorted_slice(&query->table_slices, nodes[s].match, 
+                nodes[s].offset, nodes[s].count);
         }
 
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
+        if (s < unchanged_count) {
+            /* Split slice at the first row that is larger than the row */
+            ecs_query_table_node_t *slice = &nodes[s];
+            int32_t first = 0, last = slice->count - 1;
+            while (first < last) {
+                int32_t mid = (first + last) / 2;
+                sort_row_t cur = { slice->match, slice->offset + mid };
+                if (compare_sort_rows(query, helpers, row, cur) < 0) {
+                    last = mid;
+                } else {
+                    first = mid + 1;
+                }
             }
 
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
-
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
-                e1 = e_from_helper(&helper[min]);
+            if (first) {
+                add_sorted_slice(&query->table_slices, slice->match, 
+                    slice->offset, first);
+                slice->offset += first;
+                slice->count -= first;
             }
         }
 
-        sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->match != cur_helper->match) {
-            cur = ecs_vector_add(&query->table_slices, ecs_query_table_node_t);
-            ecs_assert(cur != NULL, ECS_INTERNAL_ERROR, NULL);
-            cur->match = cur_helper->match;
-            cur->offset = cur_helper->row;
-            cur->count = 1;
-        } else {
-            cur->count ++;
-        }
-
-        cur_helper->row ++;
-    } while (proceed);
-
-    /* Iterate through the vector of slices to set the prev/next ptrs. This
-     * can't be done while building the vector, as reallocs may occur */
-    int32_t i, count = ecs_vector_count(query->table_slices);    
-    ecs_query_table_node_t *nodes = ecs_vector_first(
-        query->table_slices, ecs_query_table_node_t);
-    for (i = 0; i < count; i ++) {
-        nodes[i].prev = &nodes[i - 1];
-        nodes[i].next = &nodes[i + 1];
+        add_sorted_slice(&query->table_slices, row.match, row.row, 1);
     }
 
-    nodes[0].prev = NULL;
-    nodes[i - 1].next = NULL;
-
-    ecs_os_free(helper);
-}
-
-static
-void build_sorted_tables(
-    ecs_query_t *query)
-{
-    ecs_vector_clear(query->table_slices);
+    for (; s < unchanged_count; s ++) {
+        add_sorted_slice(&query->table_slices, nodes[s].match, 
+            nodes[s].offset, nodes[s].count);
+    }
 
-    if (query->group_by) {
-        /* Populate sorted node list in grouping order */
-        ecs_query_table_node_t *cur = query->list.first;
-        if (cur) {
-            do {
-                /* Find list for current group */
-                ecs_query_table_match_t *match = cur->match;
-                ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
-                uint64_t group_id = match->group_id;
-                ecs_query_table_list_t *list = ecs_map_get(&query->groups, 
-                    ecs_query_table_list_t, group_id);
-                ecs_assert(list != NULL, ECS_INTERNAL_ERROR, NULL);
+    link_sorted_slices(query);
 
-                /* Sort tables in current group */
-                build_sorted_table_range(query, list);
-                
-                /* Find next group to sort */
-                cur = list->last->next;
-            } while (cur);
-        }
-    } else {
-        build_sorted_table_range(query, &query->list);
-    }
+    ecs_map_free(helpers);
+    ecs_os_free(changed);
+    ecs_vector_free(unchanged);
+    ecs_vector_free(slices);
 }
 
 static
@@ -1707,7 +2473,10 @@ void sort_tables(
     /* Iterate over non-empty tables. Don't bother with empty tables as they
      * have nothing to sort */
 
-    bool tables_sorted = false;
+    bool tables_sorted = false, values_changed = false;
+    bool entities_changed = false, can_patch = true;
+    int32_t table_count = 0;
+    ecs_map_t *patches = NULL;
 
     ecs_table_cache_iter_t it;
     ecs_query_table_t *qt;
@@ -1715,10 +2484,13 @@ void sort_tables(
 
     while ((qt = flecs_table_cache_next(&it, ecs_query_table_t))) {
         ecs_table_t *table = qt->hdr.table;
-        bool dirty = false;
+        bool dirty = false, incremental = true;
+        table_count ++;
 
         if (check_table_monitor(query, qt, 0)) {
+            /* Table gained or lost entities, do a full sort */
             dirty = true;
+            incremental = false;
         }
 
         int32_t column = -1;
@@ -1747,14 +2519,78 @@ void sort_tables(
             continue;
         }
 
+        /* If only values changed, find the rows that changed since the query
+         * last iterated the table. This enables row tracking for the column. */
+        const int32_t *row_states = NULL;
+        int32_t since = -1;
+        if (incremental && column != -1) {
+            int32_t *monitor = qt->first->monitor;
+            if (monitor) {
+                since = monitor[order_by_term + 1];
+            }
+            if (since != -1) {
+                row_states = flecs_table_get_row_dirty_state(
+                    world, table, column, since);
+            }
+        }
+
         /* Something has changed, sort the table */
-        sort_table(world, table, column, compare);
-        tables_sorted = true;
+        sort_patch_t patch = { .match = qt->first };
+        bool moved = sort_table(world, table, column, compare, 
+            query->order_by_kind, incremental, row_states, since, &patch);
+        if (moved || !incremental) {
+            tables_sorted = true;
+        }
+
+        if (!incremental) {
+            entities_changed = true;
+        }
+
+        if (patch.new_rows) {
+            if (!patches) {
+                patches = ecs_map_new(sort_patch_t, 0);
+            }
+            ecs_map_set(patches, (ecs_map_key_t)(uintptr_t)table, &patch);
+
+            /* Slices of tables with multiple matches can't be patched */
+            if (qt->first != qt->last) {
+                can_patch = false;
+            }
+        } else if (moved || !row_states) {
+            /* Without a patch it's not known which rows changed */
+            can_patch = false;
+        }
+
+        values_changed = true;
     }
 
-    if (tables_sorted || query->match_count != query->prev_match_count) {
+    if (entities_changed || !query->table_slices ||
+        query->match_count != query->prev_match_count) 
+    {
         build_sorted_tables(query);
         query->match_count ++; /* Increase version if tables changed */
+    } else if (values_changed && table_count > 1) {
+        /* The order between tables may have changed */
+        if (!can_patch) {
+            build_sorted_tables(query);
+            query->match_count ++;
+        } else if (patches) {
+            patch_sorted_tables(query, patches);
+            query->match_count ++;
+        } else if (tables_sorted) {
+            query->match_count ++;
+        }
+    } else if (tables_sorted) {
+        query->match_count ++;
+    }
+
+    if (patches) {
+        ecs_map_iter_t pit = ecs_map_iter(patches);
+        sort_patch_t *patch;
+        while ((patch = ecs_map_next(&pit, sort_patch_t, NULL))) {
+            ecs_os_free(patch->new_rows);
+        }
+        ecs_map_free(patches);
     }
 }
 
@@ -2364,6 +3200,19 @@ void query_order_by(
 
     query->order_by_component = order_by_component;
     query->order_by = order_by;
+    query->order_by_kind = 0;
+
+#ifdef FLECS_META
+    /* If the callback is the comparator for the primitive value of the 
+     * component, tables can be sorted with a radix sort */
+    if (order_by && order_by_component) {
+        ecs_primitive_kind_t kind = order_by_primitive_kind(
+            world, order_by_component);
+        if (order_by == order_by_primitive_compare(kind)) {
+            query->order_by_kind = kind;
+        }
+    }
+#endif
 
     ecs_vector_free(query->table_slices);
     query->table_slices = NULL;
@@ -2494,7 +3343,7 @@ ecs_query_t* ecs_query_init(
         }
     }
 
-    ecs_table_cache_init(&result->cache);
+    ecs_table_cache_init(&result->cache, &world->allocator);
 
     result->world = world;
     result->iterable.init = query_iter_init;
@@ -2708,6 +3557,205 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
+/* Find the first node after the group of the provided node */
+static
+ecs_query_table_node_t* skip_group(
+    ecs_query_t *query,
+    ecs_query_table_node_t *node)
+{
+    uint64_t group_id = node->match->group_id;
+
+    if (!query->order_by) {
+        ecs_query_table_list_t *group = get_group(query, group_id);
+        ecs_assert(group != NULL, ECS_INTERNAL_ERROR, NULL);
+        return group->last->next;
+    }
+
+    /* Sorted slices of a group are not tracked by the group list, but are
+     * stored contiguously */
+    do {
+        node = node->next;
+    } while (node && node->match->group_id == group_id);
+
+    return node;
+}
+
+/* Skip groups that are iterated by other workers */
+static
+ecs_query_table_node_t* next_partition_node(
+    ecs_query_t *query,
+    ecs_query_iter_t *iter,
+    ecs_query_table_node_t *node)
+{
+    while (node) {
+        uint64_t group_id = node->match->group_id;
+        if (iter->group_index && group_id == iter->group_id) {
+            /* Still iterating the current group */
+            return node;
+        }
+
+        int32_t index = iter->group_index ++;
+        iter->group_id = group_id;
+        if ((index % iter->partition_count) == iter->partition_index) {
+            return node;
+        }
+
+        node = skip_group(query, node);
+    }
+
+    return NULL;
+}
+
+static
+ecs_query_table_node_t* next_node(
+    ecs_query_iter_t *iter,
+    ecs_query_table_node_t *node)
+{
+    if (node == iter->last) {
+        return NULL;
+    }
+    return node->next;
+}
+
+void ecs_query_set_group(
+    ecs_iter_t *it,
+    uint64_t group_id)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_t *query = iter->query;
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(iter->prev == NULL, ECS_INVALID_OPERATION, 
+        "cannot set group after iteration has started");
+
+    ecs_query_table_list_t *group = get_group(query, group_id);
+    if (!group) {
+        iter->node = NULL;
+        iter->last = NULL;
+        return;
+    }
+
+    ecs_query_table_node_t *first = group->first, *last = group->last;
+
+    if (query->order_by) {
+        /* Find sorted slices of group */
+        first = iter->node;
+        while (first && first->match->group_id != group_id) {
+            first = first->next;
+        }
+
+        last = first;
+        while (last && last->next && last->next->match->group_id == group_id) {
+            last = last->next;
+        }
+    }
+
+    iter->node = first;
+    iter->last = last;
+error:
+    return;
+}
+
+ecs_iter_t ecs_query_group_worker_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query,
+    int32_t index,
+    int32_t count)
+{
+    ecs_poly_assert(query, ecs_query_t);
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(count > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(index < count, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, query);
+    it.priv.iter.query.partition_index = index;
+    it.priv.iter.query.partition_count = count;
+    return it;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+static
+void query_group_info(
+    const ecs_query_table_list_t *group,
+    uint64_t group_id,
+    ecs_query_group_info_t *info)
+{
+    info->id = group_id;
+    info->table_count = group->count;
+    info->entity_count = 0;
+
+    ecs_query_table_node_t *node, *end = group->last->next;
+    for (node = group->first; node != end; node = node->next) {
+        info->entity_count += ecs_table_count(node->match->table);
+    }
+}
+
+bool ecs_query_get_group_info(
+    const ecs_query_t *query,
+    uint64_t group_id,
+    ecs_query_group_info_t *info)
+{
+    ecs_poly_assert(query, ecs_query_t);
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(info != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    flecs_process_pending_tables(query->world);
+
+    const ecs_query_table_list_t *group = ecs_map_get(
+        &query->groups, ecs_query_table_list_t, group_id);
+    if (!group || !group->first) {
+        return false;
+    }
+
+    query_group_info(group, group_id, info);
+
+    return true;
+error:
+    return false;
+}
+
+int32_t ecs_query_groups(
+    const ecs_query_t *query,
+    ecs_query_group_info_t *groups,
+    int32_t count)
+{
+    ecs_poly_assert(query, ecs_query_t);
+    ecs_check(query->group_by != NULL, ECS_INVALID_PARAMETER, 
+        "query is not grouped");
+    ecs_check(!count || groups != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    flecs_process_pending_tables(query->world);
+
+    int32_t result = 0;
+    ecs_query_table_node_t *node = query->list.first;
+
+    /* Groups are stored in order, so walk the list group by group */
+    while (node) {
+        uint64_t group_id = node->match->group_id;
+        const ecs_query_table_list_t *group = ecs_map_get(
+            &query->groups, ecs_query_table_list_t, group_id);
+        ecs_assert(group != NULL, ECS_INTERNAL_ERROR, NULL);
+
+        if (result < count) {
+            query_group_info(group, group_id, &groups[result]);
+        }
+
+        result ++;
+        node = group->last->next;
+    }
+
+    return result;
+error:
+    return 0;
+}
+
 static
 int find_smallest_column(
     ecs_table_t *table,
@@ -3037,11 +4085,17 @@ done:
 static
 void mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *table_data)
+    ecs_query_table_node_t *node)
 {
+    ecs_query_table_match_t *table_data = node->match;
     ecs_table_t *table = table_data->table;
 
     if (table && table->dirty_state) {
+        int32_t offset = node->offset, row_count = node->count;
+        if (!row_count) {
+            row_count = ecs_table_count(table);
+        }
+
         ecs_term_t *terms = query->filter.terms;
         int32_t i, count = query->filter.term_count_actual;
         for (i = 0; i < count; i ++) {
@@ -3068,7 +4122,8 @@ void mark_columns_dirty(
             int32_t storage_index = ecs_table_type_to_storage_index(
                 table, index - 1);
             if (storage_index >= 0) {
-                table->dirty_state[storage_index + 1] ++;
+                flecs_table_mark_rows_dirty(query->world, table, 
+                    storage_index, offset, row_count);
             }
         }
     }
@@ -3117,17 +4172,24 @@ bool ecs_query_next_instanced(
             sync_match_monitor(query, prev->match);
         }
         if (flags & EcsQueryHasOutColumns) {
-            mark_columns_dirty(query, prev->match);
+            mark_columns_dirty(query, prev);
         }
     }
 
     iter->skip_count = 0;
 
-    for (node = iter->node; node != NULL; node = next) {     
+    for (node = iter->node; node != NULL; node = next) {
+        if (iter->partition_count > 1) {
+            node = next_partition_node(query, iter, node);
+            if (!node) {
+                break;
+            }
+        }
+
         ecs_query_table_match_t *match = node->match;
         ecs_table_t *table = match->table;
 
-        next = node->next;
+        next = next_node(iter, node);
 
         if (table) {
             cur.first = node->offset;
@@ -3168,7 +4230,7 @@ bool ecs_query_next_instanced(
                             /* No more elements in sparse column */
                             if (found) {
                                 /* Try again */
-                                next = node->next;
+                                next = next_node(iter, node);
                                 found = false;
                             } else {
                                 /* Nothing found */
@@ -3265,6 +4327,114 @@ error:
     return false;
 }
 
+/* Test if row of iterator result changed for any of the monitored terms */
+static
+bool check_row_monitor(
+    int32_t **row_states,
+    int32_t *monitor_states,
+    int32_t count,
+    int32_t row)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        if (row_states[i][row] > monitor_states[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int32_t ecs_query_changed_range(
+    const ecs_iter_t *it,
+    int32_t *row)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_query_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->is_valid, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(row != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t first = *row, count = it->count;
+    ecs_check(first >= 0, ECS_INVALID_PARAMETER, NULL);
+    if (first >= count) {
+        return 0;
+    }
+
+    ecs_query_t *query = it->priv.iter.query.query;
+    ecs_poly_assert(query, ecs_query_t);
+
+    ecs_query_table_node_t *node = it->priv.iter.query.prev;
+    ecs_assert(node != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_query_table_match_t *match = node->match;
+
+    if (get_match_monitor(query, match)) {
+        return count - first; /* Monitor didn't exist yet */
+    }
+
+    ecs_table_t *table = match->table;
+    int32_t *monitor = match->monitor;
+    int32_t *dirty_state = flecs_table_get_dirty_state(table);
+    if (monitor[0] != dirty_state[0]) {
+        return count - first; /* Table gained/lost entities */
+    }
+
+    /* Collect row dirty states for monitored terms */
+    const ecs_filter_t *f = &query->filter;
+    int32_t i, state_count = 0, term_count = f->term_count_actual;
+    int32_t **row_states = ecs_os_alloca_n(int32_t*, term_count);
+    int32_t *monitor_states = ecs_os_alloca_n(int32_t, term_count);
+    table_dirty_state_t cur;
+
+    for (i = 0; i < term_count; i ++) {
+        int32_t t = f->terms[i].index;
+        if (monitor[t + 1] == -1) {
+            continue;
+        }
+
+        get_dirty_state(query, match, t, &cur);
+        ecs_assert(cur.column != -1, ECS_INTERNAL_ERROR, NULL);
+
+        int32_t *rows = NULL;
+        if (cur.table == table) {
+            /* Always get row state, as this enables tracking for the column */
+            rows = flecs_table_get_row_dirty_state(
+                it->real_world, table, cur.column, monitor[t + 1]);
+        }
+
+        if (monitor[t + 1] == cur.dirty_state[cur.column + 1]) {
+            continue; /* Nothing changed for term */
+        }
+
+        if (!rows) {
+            /* Component is not owned or rows weren't tracked for all changes,
+             * all rows changed */
+            return count - first;
+        }
+
+        row_states[state_count] = &rows[it->offset];
+        monitor_states[state_count] = monitor[t + 1];
+        state_count ++;
+    }
+
+    /* Find first changed row, and then the first unchanged row after it */
+    for (; first < count; first ++) {
+        if (check_row_monitor(row_states, monitor_states, state_count, first)) {
+            break;
+        }
+    }
+
+    int32_t last;
+    for (last = first; last < count; last ++) {
+        if (!check_row_monitor(row_states, monitor_states, state_count, last)){
+            break;
+        }
+    }
+
+    *row = first;
+    return last - first;
+error:
+    return 0;
+}
+
 void ecs_query_skip(
     ecs_iter_t *it)
 {
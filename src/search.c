@@ -162,6 +162,123 @@ int32_t type_search_relation(
     return -1;
 }
 
+/* Search subtree of ancestor in closure. Produces the same result as
+ * type_search_relation, without having to find the relation pairs in the type
+ * of each traversed table. */
+static
+int32_t closure_search_node(
+    const ecs_world_t *world,
+    ecs_closure_node_t *nodes,
+    int32_t index,
+    int32_t offset,
+    ecs_id_t id,
+    ecs_id_record_t *idr,
+    bool is_a,
+    int32_t min_depth,
+    int32_t max_depth,
+    ecs_entity_t *subject_out,
+    ecs_id_t *id_out,
+    ecs_table_record_t **tr_out)
+{
+    ecs_closure_node_t *node = &nodes[index];
+    ecs_entity_t obj = node->entity;
+    int32_t r, depth = node->depth;
+
+    ecs_record_t *rec = ecs_eis_get_any(world, obj);
+    ecs_assert(rec != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_table_t *table = rec->table;
+    if (!table) {
+        return -1;
+    }
+
+    if (depth >= min_depth) {
+        ecs_type_t type = table->type;
+        ecs_id_t *ids = ecs_vector_first(type, ecs_id_t);
+
+        if (offset) {
+            r = type_offset_search(offset, id, ids, ecs_vector_count(type), 
+                id_out);
+        } else {
+            r = type_search(table, idr, ids, id_out, tr_out);
+        }
+
+        if (r != -1) {
+            goto found;
+        }
+    }
+
+    if (depth < max_depth && (!is_a || 
+        type_can_inherit_id(world, table, idr, id))) 
+    {
+        int32_t child = index + 1;
+        while (child < node->end) {
+            r = closure_search_node(world, nodes, child, offset, id, idr, is_a,
+                min_depth, max_depth, subject_out, id_out, tr_out);
+            if (r != -1) {
+                goto found;
+            }
+            child = nodes[child].end;
+        }
+    }
+
+    if (!is_a) {
+        r = type_search_relation(world, table, offset, id, idr, 
+            ecs_pair(EcsIsA, EcsWildcard), world->idr_isa_wildcard, 
+                1, INT_MAX, subject_out, id_out, tr_out);
+        if (r != -1) {
+            goto found;
+        }
+    }
+
+    return -1;
+found:
+    if (subject_out && !subject_out[0]) {
+        subject_out[0] = ecs_get_alive(world, obj);
+    }
+    return r;
+}
+
+static
+int32_t closure_search_relation(
+    const ecs_world_t *world,
+    const ecs_table_t *table,
+    ecs_closure_elem_t *elem,
+    int32_t offset,
+    ecs_id_t id,
+    ecs_id_record_t *idr,
+    bool is_a,
+    int32_t min_depth,
+    int32_t max_depth,
+    ecs_entity_t *subject_out,
+    ecs_id_t *id_out,
+    ecs_table_record_t **tr_out)
+{
+    int32_t r = type_search_relation(world, table, offset, id, idr, 0, NULL, 
+        min_depth, max_depth, subject_out, id_out, tr_out);
+    if (r != -1) {
+        return r;
+    }
+
+    if (is_a && !type_can_inherit_id(world, table, idr, id)) {
+        return -1;
+    }
+
+    ecs_closure_node_t *nodes = ecs_vector_first(
+        elem->nodes, ecs_closure_node_t);
+    int32_t i = 0, count = ecs_vector_count(elem->nodes);
+    while (i < count) {
+        r = closure_search_node(world, nodes, i, offset, id, idr, is_a,
+            min_depth, max_depth, subject_out, id_out, tr_out);
+        if (r != -1) {
+            return r;
+        }
+        i = nodes[i].end;
+    }
+
+    return -1;
+}
+
 int32_t ecs_search_relation(
     const ecs_world_t *world,
     const ecs_table_t *table,
@@ -189,6 +306,22 @@ int32_t ecs_search_relation(
 
     max_depth = INT_MAX * !max_depth + max_depth * !!max_depth;
 
+    if (rel && max_depth) {
+        ecs_closure_elem_t *elem = flecs_closure_get_supersets(
+            world, rel, table);
+
+        /* Supersets that can be reached by more than one path are only stored
+         * for the first path, which could be at the wrong depth when the 
+         * search is limited to a range of depths. */
+        if (elem && (!elem->pruned || (min_depth <= 1 && 
+            max_depth == INT_MAX))) 
+        {
+            return closure_search_relation(world, table, elem, offset, id, idr, 
+                rel == EcsIsA, min_depth, max_depth, subject_out, id_out, 
+                    tr_out);
+        }
+    }
+
     int32_t result = type_search_relation(world, table, offset, id, idr, 
         ecs_pair(rel, EcsWildcard), NULL, min_depth, max_depth, subject_out, 
             id_out, tr_out);
@@ -41,6 +41,138 @@ bool defer_add_remove(
     return false;
 }
 
+/* Commands that only modify the entity they were enqueued for. Applying these
+ * commands for different entities in a different order has the same result. */
+static
+bool defer_op_is_local(
+    ecs_defer_op_t *op)
+{
+    switch(op->kind) {
+    case EcsOpNew:
+    case EcsOpAdd:
+    case EcsOpRemove:
+    case EcsOpSet:
+    case EcsOpMut:
+    case EcsOpModified:
+    case EcsOpEnable:
+    case EcsOpDisable:
+        /* Adding an IsA pair copies components from the base */
+        return !ECS_HAS_RELATION(op->id, EcsIsA);
+    default:
+        return false;
+    }
+}
+
+/* Stable merge sort of commands by entity */
+static
+void defer_sort_ops(
+    ecs_defer_op_t *ops,
+    int32_t count)
+{
+    ecs_defer_op_t *buffer = ecs_os_malloc_n(ecs_defer_op_t, count);
+    ecs_defer_op_t *src = ops, *dst = buffer;
+    int32_t width;
+
+    for (width = 1; width < count; width *= 2) {
+        int32_t start;
+        for (start = 0; start < count; start += 2 * width) {
+            int32_t mid = ECS_MIN(start + width, count);
+            int32_t end = ECS_MIN(start + 2 * width, count);
+            int32_t l = start, r = mid, i = start;
+
+            while (l < mid && r < end) {
+                if (src[r].is._1.entity < src[l].is._1.entity) {
+                    dst[i ++] = src[r ++];
+                } else {
+                    dst[i ++] = src[l ++];
+                }
+            }
+            while (l < mid) {
+                dst[i ++] = src[l ++];
+            }
+            while (r < end) {
+                dst[i ++] = src[r ++];
+            }
+        }
+
+        ecs_defer_op_t *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != ops) {
+        ecs_os_memcpy_n(ops, src, ecs_defer_op_t, count);
+    }
+
+    ecs_os_free(buffer);
+}
+
+/* Sort command queue of stage by entity. Returns false if the queue contains
+ * commands that can't be reordered, in which case the queue is not modified. */
+bool flecs_defer_sort(
+    ecs_stage_t *stage)
+{
+    ecs_defer_op_t *ops = ecs_vector_first(stage->defer_queue, ecs_defer_op_t);
+    int32_t i, count = ecs_vector_count(stage->defer_queue);
+    bool is_sorted = true;
+
+    for (i = 0; i < count; i ++) {
+        if (!defer_op_is_local(&ops[i])) {
+            return false;
+        }
+        if (i && ops[i].is._1.entity < ops[i - 1].is._1.entity) {
+            is_sorted = false;
+        }
+    }
+
+    if (!is_sorted) {
+        defer_sort_ops(ops, count);
+    }
+
+    return true;
+}
+
+/* Merge stages in entity order. Returns false if the stages can't be merged in
+ * entity order, in which case they should be merged one at a time. */
+static
+bool merge_stages_by_entity(
+    ecs_world_t *world,
+    bool force_merge)
+{
+    int32_t i, merge_count = 0, count = ecs_get_stage_count(world);
+    if (count < 2) {
+        return false;
+    }
+
+    ecs_stage_t **stages = ecs_os_malloc_n(ecs_stage_t*, count);
+    bool result = true;
+
+    for (i = 0; i < count; i ++) {
+        ecs_stage_t *s = (ecs_stage_t*)ecs_get_stage(world, i);
+        ecs_poly_assert(s, ecs_stage_t);
+        if (!force_merge && !s->auto_merge) {
+            continue;
+        }
+
+        /* Queues are usually already sorted by the worker threads, in which
+         * case this only checks whether the queue is sorted. */
+        if (s->defer != 1 || !flecs_defer_sort(s)) {
+            result = false;
+            break;
+        }
+
+        stages[merge_count ++] = s;
+    }
+
+    if (result) {
+        flecs_defer_flush_stages(world, stages, merge_count);
+    }
+
+    ecs_os_free(stages);
+
+    return result;
+}
+
 static
 void merge_stages(
     ecs_world_t *world,
@@ -64,14 +196,28 @@ void merge_stages(
             ecs_defer_end((ecs_world_t*)stage);
         }
     } else {
-        /* Merge stages. Only merge if the stage has auto_merging turned on, or 
-         * if this is a forced merge (like when ecs_merge is called) */
-        int32_t i, count = ecs_get_stage_count(world);
-        for (i = 0; i < count; i ++) {
-            ecs_stage_t *s = (ecs_stage_t*)ecs_get_stage(world, i);
-            ecs_poly_assert(s, ecs_stage_t);
-            if (force_merge || s->auto_merge) {
-                ecs_defer_end((ecs_world_t*)s);
+        /* Merge stages. Only merge if the stage has auto_merging turned on, or
+         * if this is a forced merge (like when ecs_merge is called)
+         *
+         * Stages are merged one at a time in stage order. Applying commands
+         * moves entities between tables, creates tables and invokes
+         * observers, none of which can safely run on multiple threads. This
+         * also guarantees that observers are notified in a deterministic
+         * order, regardless of how systems were distributed over workers.
+         *
+         * When merging in entity order, the queues of all stages are merged
+         * into a single queue that is applied at once. This lets commands for
+         * the same entity from different stages share a table move. */
+        if (!world->merge_by_entity || 
+            !merge_stages_by_entity(world, force_merge)) 
+        {
+            int32_t i, count = ecs_get_stage_count(world);
+            for (i = 0; i < count; i ++) {
+                ecs_stage_t *s = (ecs_stage_t*)ecs_get_stage(world, i);
+                ecs_poly_assert(s, ecs_stage_t);
+                if (force_merge || s->auto_merge) {
+                    ecs_defer_end((ecs_world_t*)s);
+                }
             }
         }
     }
@@ -238,7 +384,8 @@ bool flecs_defer_bulk_new(
     const ecs_entity_t **ids_out)
 {
     if (stage->defer) {
-        ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+        ecs_entity_t *ids = flecs_stack_alloc(&stage->defer_stack, 
+            count * ECS_SIZEOF(ecs_entity_t), ECS_ALIGNOF(ecs_entity_t));
         world->bulk_new_count ++;
 
         /* Use ecs_new_id as this is thread safe */
@@ -315,7 +462,7 @@ bool flecs_defer_set(
         op->id = id;
         op->is._1.entity = entity;
         op->is._1.size = size;
-        op->is._1.value = ecs_os_malloc(size);
+        op->is._1.value = flecs_stack_alloc(&stage->defer_stack, size, 16);
 
         if (!value) {
             value = ecs_get_id(world, entity, id);
@@ -385,6 +532,9 @@ void flecs_stage_init(
     stage->thread_ctx = world;
     stage->auto_merge = true;
     stage->asynchronous = false;
+
+    flecs_stack_init(&stage->defer_stack);
+    flecs_stack_init(&stage->frame_stack);
 }
 
 void flecs_stage_deinit(
@@ -402,6 +552,8 @@ void flecs_stage_deinit(
     ecs_poly_fini(stage, ecs_stage_t);
 
     ecs_vector_free(stage->defer_queue);
+    flecs_stack_fini(&stage->defer_stack);
+    flecs_stack_fini(&stage->frame_stack);
 }
 
 void ecs_set_stages(
@@ -576,6 +728,14 @@ void ecs_set_automerge(
     }
 }
 
+void ecs_set_merge_by_entity(
+    ecs_world_t *world,
+    bool merge_by_entity)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    world->merge_by_entity = merge_by_entity;
+}
+
 bool ecs_stage_is_readonly(
     const ecs_world_t *stage)
 {
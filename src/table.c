@@ -187,6 +187,13 @@ void flecs_table_init_data(
             storage->columns[i].size = flecs_itoi16(component->size);
             storage->columns[i].alignment = flecs_itoi16(component->alignment);
         }
+
+        /* Align arrays so they can be used with aligned SIMD loads */
+        for (i = 0; i < count; i ++) {
+            if (storage->columns[i].alignment < ECS_COLUMN_ALIGNMENT) {
+                storage->columns[i].alignment = ECS_COLUMN_ALIGNMENT;
+            }
+        }
     }
 
     if (sw_count) {
@@ -583,6 +590,19 @@ void dtor_all_components(
     }
 }
 
+/* Rows were removed from a chunk, so the next append can use the chunk */
+static
+void chunk_set_free(
+    ecs_table_t *table)
+{
+    if (table->chunk_capacity) {
+        ecs_table_t *root = table->chunk_root ? table->chunk_root : table;
+        if (table->chunk_index < root->chunk_free) {
+            root->chunk_free = table->chunk_index;
+        }
+    }
+}
+
 static
 void fini_data(
     ecs_world_t *world,
@@ -609,6 +629,7 @@ void fini_data(
     if (count) {
         dtor_all_components(world, table, data, 0, count, 
             update_entity_index, is_delete);
+        chunk_set_free(table);
     }
 
     /* Sanity check */
@@ -623,7 +644,8 @@ void fini_data(
             ecs_assert(!columns[c].data || (ecs_vector_count(columns[c].data) == 
                 ecs_vector_count(data->entities)), ECS_INTERNAL_ERROR, NULL);
 
-            ecs_vector_free(columns[c].data);
+            flecs_vector_free_t(&world->allocator, columns[c].data, 
+                columns[c].size, columns[c].alignment);
         }
         ecs_os_free(columns);
         data->columns = NULL;
@@ -703,6 +725,33 @@ void flecs_table_remove_actions(
     run_on_remove(world, table, &table->storage);
 }
 
+/* Remove chunk from the table that owns it. If the table that owns the chunks
+ * is deleted, the remaining chunks become regular tables. */
+static
+void chunks_fini(
+    ecs_table_t *table)
+{
+    ecs_table_t *root = table->chunk_root;
+    if (root) {
+        ecs_table_t **chunks = ecs_vector_first(root->chunks, ecs_table_t*);
+        int32_t i, count = ecs_vector_count(root->chunks);
+        for (i = table->chunk_index; i < count; i ++) {
+            chunks[i - 1] = chunks[i];
+            chunks[i - 1]->chunk_index = i;
+        }
+        ecs_vector_remove_last(root->chunks);
+        root->chunk_free = 0;
+    } else {
+        ecs_table_t **chunks = ecs_vector_first(table->chunks, ecs_table_t*);
+        int32_t i, count = ecs_vector_count(table->chunks);
+        for (i = 0; i < count; i ++) {
+            chunks[i]->chunk_root = NULL;
+            chunks[i]->chunk_capacity = 0;
+            chunks[i]->chunk_index = 0;
+        }
+    }
+}
+
 /* Free table resources. */
 void flecs_table_free(
     ecs_world_t *world,
@@ -736,6 +785,8 @@ void flecs_table_free(
     /* Cleanup data, no OnRemove, delete from entity index, don't deactivate */
     fini_data(world, table, &table->storage, false, true, true, false);
 
+    flecs_closure_table_free(world, table);
+
     flecs_table_clear_edges(world, table);
 
     if (!is_root) {
@@ -744,12 +795,32 @@ void flecs_table_free(
             .count = ecs_vector_count(table->type)
         };
 
-        flecs_hashmap_remove(&world->store.table_map, &ids, ecs_table_t*);
+        /* Chunks aren't stored in the hashmap */
+        ecs_table_t **elem = flecs_hashmap_get(
+            &world->store.table_map, &ids, ecs_table_t*);
+        if (elem && elem[0] == table) {
+            flecs_hashmap_remove(&world->store.table_map, &ids, ecs_table_t*);
+        }
     }
 
+    if (!world->is_fini) {
+        chunks_fini(table);
+    }
+    ecs_vector_free(table->chunks);
+
     ecs_os_free(table->dirty_state);
     ecs_os_free(table->storage_map);
 
+    if (table->row_dirty_state) {
+        int32_t i, count = ecs_vector_count(table->storage_type);
+        for (i = 0; i < count; i ++) {
+            ecs_vector_free(table->row_dirty_state[i].rows);
+        }
+        ecs_os_free(table->row_dirty_state);
+    }
+
+    flecs_table_zone_maps_fini(table);
+
     if (table->c_info) {
         ecs_os_free(table->c_info);
     }
@@ -811,6 +882,40 @@ void flecs_table_reset(
     flecs_table_clear_edges(world, table);
 }
 
+/* Resize row dirty state arrays to the number of entities in the table. New
+ * rows don't need a valid state, as the table dirty state changed. */
+static
+void sync_row_dirty_state(
+    ecs_table_t *table)
+{
+    int32_t i, column_count = ecs_vector_count(table->storage_type);
+    int32_t count = ecs_table_count(table);
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_vector_t **rows_ptr = &table->row_dirty_state[i].rows;
+        if (!*rows_ptr) {
+            continue;
+        }
+
+        int32_t to_add = count - ecs_vector_count(*rows_ptr);
+        if (to_add > 0) {
+            int32_t *new_rows = ecs_vector_addn(rows_ptr, int32_t, to_add);
+            ecs_os_memset_n(new_rows, 0, int32_t, to_add);
+        } else {
+            ecs_vector_set_count(rows_ptr, int32_t, count);
+        }
+    }
+}
+
+/* Row state can't be allocated or marked while worker threads are iterating,
+ * as multiple workers may write the same table. */
+static
+bool can_track_rows(
+    const ecs_world_t *world)
+{
+    return !world->is_readonly || ecs_get_stage_count(world) <= 1;
+}
+
 static
 void mark_table_dirty(
     ecs_world_t *world,
@@ -820,13 +925,18 @@ void mark_table_dirty(
     (void)world;
     if (table->dirty_state) {
         table->dirty_state[index] ++;
+
+        if (!index && table->row_dirty_state) {
+            sync_row_dirty_state(table);
+        }
     }
 }
 
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
-    ecs_entity_t component)
+    ecs_entity_t component,
+    int32_t row)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -834,7 +944,57 @@ void flecs_table_mark_dirty(
     if (table->dirty_state) {
         int32_t index = ecs_search(world, table->storage_table, component, 0);
         ecs_assert(index != -1, ECS_INTERNAL_ERROR, NULL);
-        table->dirty_state[index + 1] ++;
+        flecs_table_mark_rows_dirty(world, table, index, row, 1);
+    }
+}
+
+void flecs_table_mark_rows_dirty(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+
+    if (!table->dirty_state) {
+        return;
+    }
+
+    int32_t state = ++ table->dirty_state[column + 1];
+    if (table->zone_maps) {
+        flecs_table_zone_maps_mark_dirty(table, column, offset, count);
+    }
+
+    if (!table->row_dirty_state) {
+        return;
+    }
+
+    ecs_row_dirty_state_t *rds = &table->row_dirty_state[column];
+    if (!rds->rows) {
+        /* Rows aren't tracked for column */
+        return;
+    }
+
+    /* Don't mark rows from worker threads. Because the column state no longer
+     * matches the state of the rows, all rows are reported as changed. */
+    if (!can_track_rows(world)) {
+        return;
+    }
+
+    if (rds->column_state != (state - 1)) {
+        /* Column changed since the last time rows were marked */
+        rds->untracked_state = state - 1;
+    }
+    rds->column_state = state;
+
+    ecs_assert(ecs_vector_count(rds->rows) >= (offset + count), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i, *rows = ecs_vector_first(rds->rows, int32_t);
+    for (i = offset; i < offset + count; i ++) {
+        rows[i] = state;
     }
 }
 
@@ -950,6 +1110,7 @@ void grow_column(
     int32_t new_size,
     bool construct)
 {
+    ecs_allocator_t *a = &world->allocator;
     ecs_vector_t *vec = column->data;
     int16_t alignment = column->alignment;
 
@@ -972,8 +1133,9 @@ void grow_column(
         ecs_assert(move_ctor != NULL, ECS_INTERNAL_ERROR, NULL);
 
         /* Create new vector */
-        ecs_vector_t *new_vec = ecs_vector_new_t(size, alignment, new_size);
-        ecs_vector_set_count_t(&new_vec, size, alignment, new_count);
+        ecs_vector_t *new_vec = flecs_vector_new_t(
+            a, size, alignment, new_size);
+        flecs_vector_set_count_t(a, &new_vec, size, alignment, new_count);
 
         void *old_buffer = ecs_vector_first_t(
             vec, size, alignment);
@@ -996,16 +1158,16 @@ void grow_column(
         }
 
         /* Free old vector */
-        ecs_vector_free(vec);
+        flecs_vector_free_t(a, vec, size, alignment);
 
         column->data = new_vec;
     } else {
         /* If array won't realloc or has no move, simply add new elements */
         if (can_realloc) {
-            ecs_vector_set_size_t(&vec, size, alignment, new_size);
+            flecs_vector_set_size_t(a, &vec, size, alignment, new_size);
         }
 
-        void *elem = ecs_vector_addn_t(&vec, size, alignment, to_add);
+        void *elem = flecs_vector_addn_t(a, &vec, size, alignment, to_add);
 
         ecs_xtor_t ctor;
         if (construct && c_info && (ctor = c_info->lifecycle.ctor)) {
@@ -1029,7 +1191,8 @@ int32_t grow_data(
     ecs_data_t *data,
     int32_t to_add,
     int32_t size,
-    const ecs_entity_t *ids)
+    const ecs_entity_t *ids,
+    bool construct)
 {
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
@@ -1041,6 +1204,7 @@ int32_t grow_data(
     ecs_column_t *columns = data->columns;
     ecs_sw_column_t *sw_columns = data->sw_columns;
     ecs_bs_column_t *bs_columns = data->bs_columns; 
+    int32_t cur_size = ecs_vector_size(data->entities);
 
     /* Add record to record ptr array */
     ecs_vector_set_size(&data->record_ptrs, ecs_record_t*, size);
@@ -1079,7 +1243,7 @@ int32_t grow_data(
             c_info = c_info_array[i];
         }
 
-        grow_column(world, entities, column, c_info, to_add, size, true);
+        grow_column(world, entities, column, c_info, to_add, size, construct);
         ecs_assert(ecs_vector_size(columns[i].data) == size, 
             ECS_INTERNAL_ERROR, NULL);
     }
@@ -1103,7 +1267,8 @@ int32_t grow_data(
         flecs_table_set_empty(world, table);
     }
 
-    table->alloc_count ++;
+    /* Columns are only reallocated when the table grows beyond its size */
+    table->alloc_count += (size != cur_size);
 
     /* Return index of first added entity */
     return cur_count;
@@ -1111,17 +1276,19 @@ int32_t grow_data(
 
 static
 void fast_append(
+    ecs_world_t *world,
     ecs_column_t *columns,
     int32_t column_count)
 {
     /* Add elements to each column array */
+    ecs_allocator_t *a = &world->allocator;
     int32_t i;
     for (i = 0; i < column_count; i ++) {
         ecs_column_t *column = &columns[i];
         int16_t size = column->size;
         if (size) {
             int16_t alignment = column->alignment;
-            ecs_vector_add_t(&column->data, size, alignment);
+            flecs_vector_add_t(a, &column->data, size, alignment);
         }
     }
 }
@@ -1165,7 +1332,7 @@ int32_t flecs_table_append(
 
     /* Fast path: no switch columns, no lifecycle actions */
     if (!(table->flags & EcsTableIsComplex)) {
-        fast_append(columns, column_count);
+        fast_append(world, columns, column_count);
         if (!count) {
             flecs_table_set_empty(world, table); /* See below */
         }
@@ -1278,6 +1445,7 @@ void flecs_table_delete(
     ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
     count --;
     ecs_assert(index <= count, ECS_INTERNAL_ERROR, NULL);
+    chunk_set_free(table);
 
     /* Move last entity id to index */
     ecs_entity_t *entities = ecs_vector_first(v_entities, ecs_entity_t);
@@ -1407,6 +1575,131 @@ void flecs_table_delete(
     }
 }
 
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t index,
+    int32_t count,
+    bool destruct)
+{
+    ecs_assert(world != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t total = ecs_vector_count(data->entities);
+    ecs_assert(index + count <= total, ECS_INTERNAL_ERROR, NULL);
+    int32_t remaining = total - count;
+    chunk_set_free(table);
+
+    /* Like deleting a single row, rows are moved from the end of the table to
+     * the deleted range. Only rows after the range have to be moved. */
+    int32_t move_count = total - index - count;
+    if (move_count > count) {
+        move_count = count;
+    }
+    int32_t move_from = total - move_count;
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+    ecs_record_t **records = ecs_vector_first(data->record_ptrs, ecs_record_t*);
+
+    /* Move component data. This happens before the entity ids are moved, so
+     * that callbacks are invoked with the entity ids that own the data. */
+    ecs_type_info_t **c_info_array = table->c_info;
+    ecs_id_t *ids = ecs_vector_first(table->storage_type, ecs_id_t);
+    ecs_column_t *columns = data->columns;
+    int32_t i, column_count = ecs_vector_count(table->storage_type);
+    bool is_complex = table->flags & EcsTableIsComplex;
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_column_t *column = &columns[i];
+        int16_t size = column->size;
+        int16_t alignment = column->alignment;
+        ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+
+        ecs_type_info_t *c_info = NULL;
+        if (is_complex && c_info_array) {
+            c_info = c_info_array[i];
+        }
+
+        if (destruct) {
+            dtor_component(world, table, c_info, column, entities, ids[i],
+                index, count, true);
+        }
+
+        if (move_count) {
+            void *dst = ecs_vector_get_t(column->data, size, alignment, index);
+            void *src = ecs_vector_get_t(
+                column->data, size, alignment, move_from);
+
+            ecs_move_ctor_t move;
+            if (c_info && (move = c_info->lifecycle.ctor_move_dtor)) {
+                move(world, c_info->component, &c_info->lifecycle, 
+                    &entities[move_from], &entities[move_from], dst, src, 
+                    flecs_itosize(size), move_count, c_info->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, src, size * move_count);
+            }
+        }
+
+        flecs_vector_set_count_t(&world->allocator, &column->data, size, 
+            alignment, remaining);
+    }
+
+    /* Move entity ids & record ptrs, update records of moved entities */
+    for (i = 0; i < move_count; i ++) {
+        ecs_record_t *record = records[move_from + i];
+        entities[index + i] = entities[move_from + i];
+        records[index + i] = record;
+
+        if (record) {
+            uint32_t row_flags = record->row & ECS_ROW_FLAGS_MASK;
+            record->row = ECS_ROW_TO_RECORD(index + i, row_flags);
+            ecs_assert(record->table == table, ECS_INTERNAL_ERROR, NULL);
+        }
+    }
+
+    ecs_vector_set_count(&data->entities, ecs_entity_t, remaining);
+    ecs_vector_set_count(&data->record_ptrs, ecs_record_t*, remaining);
+
+    /* Move elements in switch columns, then remove elements from the end */
+    ecs_sw_column_t *sw_columns = data->sw_columns;
+    int32_t j, sw_column_count = table->sw_column_count;
+    for (i = 0; i < sw_column_count; i ++) {
+        ecs_switch_t *sw = sw_columns[i].data;
+        for (j = 0; j < move_count; j ++) {
+            flecs_switch_set(sw, index + j, flecs_switch_get(sw, move_from + j));
+        }
+        for (j = total - 1; j >= remaining; j --) {
+            flecs_switch_remove(sw, j);
+        }
+    }
+
+    /* Move elements in bitset columns, then remove elements from the end */
+    ecs_bs_column_t *bs_columns = data->bs_columns;
+    int32_t bs_column_count = table->bs_column_count;
+    for (i = 0; i < bs_column_count; i ++) {
+        ecs_bitset_t *bs = &bs_columns[i].data;
+        for (j = 0; j < move_count; j ++) {
+            flecs_bitset_set(bs, index + j, flecs_bitset_get(bs, move_from + j));
+        }
+        for (j = total - 1; j >= remaining; j --) {
+            flecs_bitset_remove(bs, j);
+        }
+    }
+
+    /* If the table is monitored indicate that there has been a change */
+    mark_table_dirty(world, table, 0);
+
+    /* If table is empty, deactivate it */
+    if (!remaining) {
+        flecs_table_set_empty(world, table);
+    }
+}
+
 static
 void fast_move(
     ecs_table_t *new_table,
@@ -1575,17 +1868,136 @@ void flecs_table_move(
     }
 }
 
+void flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_data_t *new_data,
+    int32_t new_index,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data,
+    int32_t old_index,
+    int32_t count,
+    bool construct)
+{
+    ecs_assert(new_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!new_table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!old_table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(new_table != old_table, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_assert(old_index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(old_index + count <= ecs_vector_count(old_data->entities),
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(new_index + count <= ecs_vector_count(new_data->entities),
+        ECS_INTERNAL_ERROR, NULL);
+
+    bool is_complex = (new_table->flags | old_table->flags) & EcsTableIsComplex;
+    if (is_complex) {
+        move_switch_columns(new_table, new_data, new_index, 
+            old_table, old_data, old_index, count);
+
+        move_bitset_columns(new_table, new_data, new_index, 
+            old_table, old_data, old_index, count);
+    }
+
+    ecs_entity_t *new_entities = ecs_vector_first(
+        new_data->entities, ecs_entity_t);
+    ecs_entity_t *old_entities = ecs_vector_first(
+        old_data->entities, ecs_entity_t);
+
+    ecs_type_t new_type = new_table->storage_type;
+    ecs_type_t old_type = old_table->storage_type;
+
+    int32_t i_new = 0, new_column_count = ecs_vector_count(new_type);
+    int32_t i_old = 0, old_column_count = ecs_vector_count(old_type);
+    ecs_entity_t *new_components = ecs_vector_first(new_type, ecs_entity_t);
+    ecs_entity_t *old_components = ecs_vector_first(old_type, ecs_entity_t);
+
+    ecs_column_t *old_columns = old_data->columns;
+    ecs_column_t *new_columns = new_data->columns;
+
+    ecs_type_info_t **new_c_info = is_complex ? new_table->c_info : NULL;
+    ecs_type_info_t **old_c_info = is_complex ? old_table->c_info : NULL;
+
+    for (; (i_new < new_column_count) && (i_old < old_column_count);) {
+        ecs_entity_t new_component = new_components[i_new];
+        ecs_entity_t old_component = old_components[i_old];
+
+        if (new_component == old_component) {
+            ecs_column_t *new_column = &new_columns[i_new];
+            ecs_column_t *old_column = &old_columns[i_old];
+            int16_t size = new_column->size;
+            int16_t alignment = new_column->alignment;
+
+            ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+
+            void *dst = ecs_vector_get_t(
+                new_column->data, size, alignment, new_index);
+            void *src = ecs_vector_get_t(
+                old_column->data, size, alignment, old_index);
+
+            ecs_assert(dst != NULL, ECS_INTERNAL_ERROR, NULL);
+            ecs_assert(src != NULL, ECS_INTERNAL_ERROR, NULL);
+
+            /* Move the entire range of values at once */
+            ecs_type_info_t *cdata = new_c_info ? new_c_info[i_new] : NULL;
+            ecs_move_ctor_t callback;
+            if (cdata && (callback = cdata->lifecycle.ctor_move_dtor)) {
+                callback(world, new_component, &cdata->lifecycle, 
+                    &new_entities[new_index], &old_entities[old_index],
+                    dst, src, flecs_itosize(size), count, 
+                    cdata->lifecycle.ctx);
+            } else {
+                ecs_os_memcpy(dst, src, size * count);
+            }
+        } else if (is_complex) {
+            if (new_component < old_component) {
+                if (construct && new_c_info) {
+                    ctor_component(world, new_c_info[i_new], 
+                        &new_columns[i_new], &new_entities[new_index], 
+                        new_index, count);
+                }
+            } else if (old_c_info) {
+                dtor_component(world, old_table, old_c_info[i_old],
+                    &old_columns[i_old], old_entities, old_component, 
+                    old_index, count, true);
+            }
+        }
+
+        i_new += new_component <= old_component;
+        i_old += new_component >= old_component;
+    }
+
+    if (construct && new_c_info) {
+        for (; (i_new < new_column_count); i_new ++) {
+            ctor_component(world, new_c_info[i_new], &new_columns[i_new], 
+                &new_entities[new_index], new_index, count);
+        }
+    }
+
+    if (old_c_info) {
+        for (; (i_old < old_column_count); i_old ++) {
+            dtor_component(world, old_table, old_c_info[i_old],
+                &old_columns[i_old], old_entities, old_components[i_old], 
+                    old_index, count, true);
+        }
+    }
+}
+
 int32_t flecs_table_appendn(
     ecs_world_t *world,
     ecs_table_t *table,
     ecs_data_t *data,
     int32_t to_add,
-    const ecs_entity_t *ids)
+    const ecs_entity_t *ids,
+    bool construct)
 {
     ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
 
     int32_t cur_count = flecs_table_data_count(data);
-    return grow_data(world, table, data, to_add, cur_count + to_add, ids);
+    return grow_data(
+        world, table, data, to_add, cur_count + to_add, ids, construct);
 }
 
 void flecs_table_set_size(
@@ -1599,7 +2011,7 @@ void flecs_table_set_size(
     int32_t cur_count = flecs_table_data_count(data);
 
     if (cur_count < size) {
-        grow_data(world, table, data, 0, size, NULL);
+        grow_data(world, table, data, 0, size, NULL, true);
     }
 }
 
@@ -1722,6 +2134,97 @@ void flecs_table_swap(
     }  
 }
 
+static
+void permute_array(
+    void *array,
+    void *tmp,
+    ecs_size_t size,
+    const int32_t *rows,
+    int32_t offset,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy(ECS_ELEM(tmp, size, i), 
+            ECS_ELEM(array, size, rows[i]), size);
+    }
+    ecs_os_memcpy(ECS_ELEM(array, size, offset), tmp, size * count);
+}
+
+void flecs_table_permute(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_data_t *data,
+    int32_t *rows,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_assert(!table->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(rows != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(offset >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(offset + count <= flecs_table_data_count(data), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i;
+    if (!count) {
+        return;
+    }
+
+    if (table->sw_column_count || table->bs_column_count) {
+        /* Switch and bitset columns can only be swapped, so move rows into
+         * place by following the cycles of the permutation. Each row that is
+         * swapped into place is marked as done. */
+        for (i = offset; i < offset + count; i ++) {
+            int32_t cur = i, next;
+            while ((next = rows[cur - offset]) != i) {
+                flecs_table_swap(world, table, data, cur, next);
+                rows[cur - offset] = cur;
+                cur = next;
+            }
+            rows[cur - offset] = cur;
+        }
+        return;
+    }
+
+    mark_table_dirty(world, table, 0);
+
+    /* Copy rows into a scratch buffer in their new order, and copy the buffer
+     * back. Unlike swapping, this moves each row only once. */
+    ecs_column_t *columns = data->columns;
+    int32_t column_count = ecs_vector_count(table->storage_type);
+    ecs_size_t tmp_size = ECS_SIZEOF(ecs_entity_t);
+    for (i = 0; i < column_count; i ++) {
+        tmp_size = ECS_MAX(tmp_size, columns[i].size);
+    }
+
+    void *tmp = ecs_os_malloc(tmp_size * count);
+
+    ecs_entity_t *entities = ecs_vector_first(data->entities, ecs_entity_t);
+    permute_array(entities, tmp, ECS_SIZEOF(ecs_entity_t), rows, 
+        offset, count);
+
+    ecs_record_t **records = ecs_vector_first(
+        data->record_ptrs, ecs_record_t*);
+    permute_array(records, tmp, ECS_SIZEOF(ecs_record_t*), rows, 
+        offset, count);
+
+    for (i = offset; i < offset + count; i ++) {
+        ecs_record_t *r = records[i];
+        ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+        r->row = ECS_ROW_TO_RECORD(i, ECS_RECORD_TO_ROW_FLAGS(r->row));
+    }
+
+    for (i = 0; i < column_count; i ++) {
+        int16_t size = columns[i].size;
+        int16_t alignment = columns[i].alignment;
+        void *ptr = ecs_vector_first_t(columns[i].data, size, alignment);
+        permute_array(ptr, tmp, size, rows, offset, count);
+    }
+
+    ecs_os_free(tmp);
+}
+
 static
 void merge_vector(
     ecs_vector_t **dst_out,
@@ -1774,17 +2277,15 @@ void merge_column(
     int32_t dst_count = ecs_vector_count(dst);
 
     if (!dst_count) {
-        if (dst) {
-            ecs_vector_free(dst);
-        }
-
+        flecs_vector_free_t(&world->allocator, dst, size, alignment);
         column->data = src;
     
     /* If the new table is not empty, copy the contents from the
      * src into the dst. */
     } else {
         int32_t src_count = ecs_vector_count(src);
-        ecs_vector_set_count_t(&dst, size, alignment, dst_count + src_count);
+        flecs_vector_set_count_t(&world->allocator, &dst, size, alignment, 
+            dst_count + src_count);
         column->data = dst;
 
         /* Construct new values */
@@ -1808,7 +2309,7 @@ void merge_column(
             ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
         }
 
-        ecs_vector_free(src);
+        flecs_vector_free_t(&world->allocator, src, size, alignment);
     }
 }
 
@@ -1877,8 +2378,8 @@ void merge_table_data(
             /* New column does not occur in old table, make sure vector is large
              * enough. */
             ecs_column_t *column = &new_columns[i_new];
-            ecs_vector_set_count_t(&column->data, size, alignment,
-                old_count + new_count);
+            flecs_vector_set_count_t(&world->allocator, &column->data, size, 
+                alignment, old_count + new_count);
 
             /* Construct new values */
             ecs_type_info_t *c_info = new_table->c_info[i_new];
@@ -1899,7 +2400,8 @@ void merge_table_data(
             }
 
             /* Old column does not occur in new table, remove */
-            ecs_vector_free(column->data);
+            flecs_vector_free_t(&world->allocator, column->data, 
+                column->size, column->alignment);
             column->data = NULL;
 
             i_old ++;
@@ -1916,8 +2418,8 @@ void merge_table_data(
         int16_t alignment = column->alignment;
         ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
 
-        ecs_vector_set_count_t(&column->data, size, alignment,
-            old_count + new_count);
+        flecs_vector_set_count_t(&world->allocator, &column->data, size, 
+            alignment, old_count + new_count);
 
         /* Construct new values */
         ecs_type_info_t *c_info = new_table->c_info[i_new];
@@ -1939,7 +2441,8 @@ void merge_table_data(
         }
 
         /* Old column does not occur in new table, remove */
-        ecs_vector_free(column->data);
+        flecs_vector_free_t(&world->allocator, column->data, 
+            column->size, column->alignment);
         column->data = NULL;
     }    
 
@@ -1954,6 +2457,49 @@ int32_t ecs_table_count(
     return flecs_table_data_count(&table->storage);
 }
 
+/* Merge entities into chunked table. Entities are moved to chunks with space
+ * instead of growing the columns of the destination table. */
+static
+void merge_chunked(
+    ecs_world_t *world,
+    ecs_table_t *new_table,
+    ecs_table_t *old_table,
+    ecs_data_t *old_data)
+{
+    int32_t i, old_count;
+    while ((old_count = ecs_vector_count(old_data->entities))) {
+        int32_t count = old_count;
+        ecs_table_t *chunk = flecs_table_chunk_for_append(
+            world, new_table, &count);
+        ecs_data_t *new_data = &chunk->storage;
+        int32_t old_index = old_count - count;
+
+        ecs_entity_t *old_entities = ecs_vector_first(
+            old_data->entities, ecs_entity_t);
+        int32_t new_index = flecs_table_appendn(world, chunk, new_data, count,
+            &old_entities[old_index], false);
+
+        flecs_table_move_range(world, chunk, new_data, new_index, 
+            old_table, old_data, old_index, count, true);
+
+        ecs_record_t **old_records = ecs_vector_first(
+            old_data->record_ptrs, ecs_record_t*);
+        ecs_record_t **new_records = ecs_vector_first(
+            new_data->record_ptrs, ecs_record_t*);
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *record = old_records[old_index + i];
+            ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+            uint32_t flags = ECS_RECORD_TO_ROW_FLAGS(record->row);
+            record->row = ECS_ROW_TO_RECORD(new_index + i, flags);
+            record->table = chunk;
+            new_records[new_index + i] = record;
+        }
+
+        flecs_table_delete_range(
+            world, old_table, old_data, old_index, count, false);
+    }
+}
+
 void flecs_table_merge(
     ecs_world_t *world,
     ecs_table_t *new_table,
@@ -1986,6 +2532,11 @@ void flecs_table_merge(
         }
     }
 
+    if (new_table->chunk_capacity && new_table != old_table) {
+        merge_chunked(world, new_table, old_table, old_data);
+        return;
+    }
+
     ecs_entity_t *old_entities = ecs_vector_first(old_data->entities, ecs_entity_t);
     int32_t old_count = ecs_vector_count(old_data->entities);
     int32_t new_count = ecs_vector_count(new_data->entities);
@@ -2073,6 +2624,62 @@ int32_t* flecs_table_get_dirty_state(
     return table->dirty_state;
 }
 
+int32_t* flecs_table_get_row_dirty_state(
+    const ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t column,
+    int32_t since)
+{
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t *dirty_state = flecs_table_get_dirty_state(table);
+    int32_t column_count = ecs_vector_count(table->storage_type);
+    ecs_assert(column < column_count, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t count = ecs_table_count(table);
+    ecs_row_dirty_state_t *rds = NULL;
+    if (table->row_dirty_state) {
+        rds = &table->row_dirty_state[column];
+    }
+
+    if (!rds || !rds->rows) {
+        if (!can_track_rows(world)) {
+            return NULL;
+        }
+
+        if (!table->row_dirty_state) {
+            table->row_dirty_state = ecs_os_calloc_n(
+                ecs_row_dirty_state_t, column_count);
+            rds = &table->row_dirty_state[column];
+        }
+
+        /* Initialize rows with the current column state, as it's unknown 
+         * whether they changed before row tracking was enabled. */
+        int32_t i, state = dirty_state[column + 1];
+        rds->rows = ecs_vector_new(int32_t, count);
+        ecs_vector_set_count(&rds->rows, int32_t, count);
+        int32_t *rows = ecs_vector_first(rds->rows, int32_t);
+        for (i = 0; i < count; i ++) {
+            rows[i] = state;
+        }
+
+        rds->column_state = state;
+    }
+
+    ecs_assert(ecs_vector_count(rds->rows) == count, 
+        ECS_INTERNAL_ERROR, NULL);
+
+    /* If the column changed without marking rows after 'since', rows can't be
+     * used to find which rows changed */
+    if (rds->column_state != dirty_state[column + 1] || 
+        since < rds->untracked_state) 
+    {
+        return NULL;
+    }
+
+    return ecs_vector_first(rds->rows, int32_t);
+}
+
 int32_t* flecs_table_get_monitor(
     ecs_table_t *table)
 {
@@ -2127,6 +2734,128 @@ void ecs_table_unlock(
     }
 }
 
+void ecs_dim_table(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t entity_count)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity_count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!world->is_readonly, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    ecs_data_t *data = &table->storage;
+    if (ecs_vector_size(data->entities) < entity_count) {
+        flecs_table_set_size(world, table, data, entity_count);
+    }
+error:
+    return;
+}
+
+void ecs_table_set_chunk_size(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t chunk_size)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(table->type != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!world->is_readonly, ECS_INVALID_WHILE_ITERATING, NULL);
+
+    if (table->chunk_root) {
+        table = table->chunk_root;
+    }
+
+    /* The largest column determines how many entities fit in a chunk */
+    ecs_size_t elem_size = ECS_SIZEOF(ecs_entity_t);
+    ecs_column_t *columns = table->storage.columns;
+    int32_t i, column_count = ecs_vector_count(table->storage_type);
+    for (i = 0; i < column_count; i ++) {
+        if (columns[i].size > elem_size) {
+            elem_size = columns[i].size;
+        }
+    }
+
+    /* Vectors grow in powers of two, round down so chunks don't exceed the
+     * specified size */
+    int32_t capacity = chunk_size / elem_size;
+    if (!capacity) {
+        capacity = 1;
+    }
+    while (capacity & (capacity - 1)) {
+        capacity &= capacity - 1;
+    }
+
+    table->chunk_capacity = capacity;
+    table->chunk_free = 0;
+
+    ecs_table_t **chunks = ecs_vector_first(table->chunks, ecs_table_t*);
+    int32_t count = ecs_vector_count(table->chunks);
+    for (i = 0; i < count; i ++) {
+        chunks[i]->chunk_capacity = capacity;
+    }
+error:
+    return;
+}
+
+/* A chunk has space if entities can be added without reallocating its columns.
+ * Empty chunks are dimensioned for the chunk capacity. */
+static
+int32_t chunk_space(
+    ecs_world_t *world,
+    ecs_table_t *chunk)
+{
+    ecs_data_t *data = &chunk->storage;
+    int32_t count = ecs_vector_count(data->entities);
+    if (!count && ecs_vector_size(data->entities) < chunk->chunk_capacity) {
+        flecs_table_set_size(world, chunk, data, chunk->chunk_capacity);
+    }
+
+    return ecs_vector_size(data->entities) - count;
+}
+
+ecs_table_t* flecs_table_chunk_for_append(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t *count)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (!table->chunk_capacity) {
+        return table;
+    }
+
+    ecs_table_t *root = table->chunk_root ? table->chunk_root : table;
+    ecs_table_t **chunks = ecs_vector_first(root->chunks, ecs_table_t*);
+    int32_t i, chunk_count = ecs_vector_count(root->chunks);
+    ecs_table_t *result = NULL;
+    int32_t space = 0;
+
+    /* Chunks before chunk_free are full, start searching from there */
+    for (i = root->chunk_free; i <= chunk_count; i ++) {
+        result = i ? chunks[i - 1] : root;
+        if ((space = chunk_space(world, result))) {
+            break;
+        }
+    }
+
+    root->chunk_free = i;
+
+    if (!space) {
+        result = flecs_table_new_chunk(world, root);
+        space = chunk_space(world, result);
+    }
+
+    ecs_assert(space > 0, ECS_INTERNAL_ERROR, NULL);
+
+    if (count && *count > space) {
+        *count = space;
+    }
+
+    return result;
+}
+
 bool ecs_table_has_module(
     ecs_table_t *table)
 {
@@ -60,10 +60,12 @@ void table_cache_list_insert(
 }
 
 void ecs_table_cache_init(
-    ecs_table_cache_t *cache)
+    ecs_table_cache_t *cache,
+    ecs_allocator_t *allocator)
 {
     ecs_assert(cache != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_map_init(&cache->index, ecs_table_cache_hdr_t*, 0);
+    ecs_map_init_w_allocator(&cache->index, ecs_table_cache_hdr_t*, 0, 
+        allocator);
 }
 
 void ecs_table_cache_fini(
@@ -11,7 +11,8 @@ extern "C" {
 #endif
 
 void ecs_table_cache_init(
-    ecs_table_cache_t *cache);
+    ecs_table_cache_t *cache,
+    ecs_allocator_t *allocator);
 
 void ecs_table_cache_fini(
     ecs_table_cache_t *cache);
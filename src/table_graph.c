@@ -153,6 +153,94 @@ void graph_edge_free(
     }
 }
 
+/* Count number of bits set in value */
+static
+int32_t edge_popcount(
+    uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (int32_t)((v * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* Get index of low edge in array, which is the number of edges with a lower id */
+static
+int32_t lo_edge_index(
+    const ecs_graph_edges_t *edges,
+    ecs_id_t id)
+{
+    int32_t i, word = (int32_t)(id >> 6), result = 0;
+    for (i = 0; i < word; i ++) {
+        result += edge_popcount(edges->lo_mask[i]);
+    }
+
+    return result + edge_popcount(
+        edges->lo_mask[word] & ((1ull << (id & 63)) - 1));
+}
+
+static
+int32_t lo_edge_count(
+    const ecs_graph_edges_t *edges)
+{
+    int32_t i, result = 0;
+    for (i = 0; i < ECS_GRAPH_LO_MASK_COUNT; i ++) {
+        result += edge_popcount(edges->lo_mask[i]);
+    }
+    return result;
+}
+
+static
+ecs_graph_edge_t* ensure_lo_edge(
+    ecs_world_t *world,
+    ecs_graph_edges_t *edges,
+    ecs_id_t id)
+{
+    int32_t index = lo_edge_index(edges, id);
+    uint64_t *word = &edges->lo_mask[id >> 6];
+    uint64_t bit = 1ull << (id & 63);
+    if (*word & bit) {
+        return edges->lo[index];
+    }
+
+    /* Edges are not often added, so grow array by one to keep it small */
+    int32_t count = lo_edge_count(edges);
+    edges->lo = ecs_os_realloc_n(edges->lo, ecs_graph_edge_t*, count + 1);
+    ecs_os_memmove(&edges->lo[index + 1], &edges->lo[index],
+        (count - index) * ECS_SIZEOF(ecs_graph_edge_t*));
+
+    ecs_graph_edge_t *edge = graph_edge_new(world);
+    edges->lo[index] = edge;
+    *word |= bit;
+
+    return edge;
+}
+
+static
+void remove_lo_edge(
+    ecs_graph_edges_t *edges,
+    ecs_id_t id)
+{
+    uint64_t *word = &edges->lo_mask[id >> 6];
+    uint64_t bit = 1ull << (id & 63);
+    ecs_assert(*word & bit, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t index = lo_edge_index(edges, id);
+    int32_t count = lo_edge_count(edges);
+    ecs_os_memmove(&edges->lo[index], &edges->lo[index + 1],
+        (count - index - 1) * ECS_SIZEOF(ecs_graph_edge_t*));
+    *word &= ~bit;
+
+    if (count == 1) {
+        ecs_os_free(edges->lo);
+        edges->lo = NULL;
+    }
+}
+
 static
 ecs_graph_edge_t* ensure_hi_edge(
     ecs_world_t *world,
@@ -160,22 +248,16 @@ ecs_graph_edge_t* ensure_hi_edge(
     ecs_id_t id)
 {
     if (!ecs_map_is_initialized(&edges->hi)) {
-        ecs_map_init(&edges->hi, ecs_graph_edge_t*, 1);
+        ecs_map_init_w_allocator(&edges->hi, ecs_graph_edge_t*, 1, 
+            &world->allocator);
     }
 
     ecs_graph_edge_t **ep = ecs_map_ensure(&edges->hi, ecs_graph_edge_t*, id);
     ecs_graph_edge_t *edge = ep[0];
-    if (edge) {
-        return edge;
+    if (!edge) {
+        edge = ep[0] = graph_edge_new(world);
     }
 
-    if (id < ECS_HI_COMPONENT_ID) {
-        edge = &edges->lo[id];
-    } else {
-        edge = graph_edge_new(world);
-    }
-
-    ep[0] = edge;
     return edge;
 }
 
@@ -185,21 +267,11 @@ ecs_graph_edge_t* ensure_edge(
     ecs_graph_edges_t *edges,
     ecs_id_t id)
 {
-    ecs_graph_edge_t *edge;
-    
     if (id < ECS_HI_COMPONENT_ID) {
-        if (!edges->lo) {
-            edges->lo = ecs_os_calloc_n(ecs_graph_edge_t, ECS_HI_COMPONENT_ID);
-        }
-        edge = &edges->lo[id];
+        return ensure_lo_edge(world, edges, id);
     } else {
-        if (!ecs_map_is_initialized(&edges->hi)) {
-            ecs_map_init(&edges->hi, ecs_graph_edge_t*, 1);
-        }
-        edge = ensure_hi_edge(world, edges, id);
+        return ensure_hi_edge(world, edges, id);
     }
-
-    return edge;
 }
 
 static
@@ -229,12 +301,7 @@ void disconnect_edge(
         table_diff_free(diff);
     }
 
-    /* If edge id is low, clear it from fast lookup array */
-    if (id < ECS_HI_COMPONENT_ID) {
-        edge->from = NULL;
-    } else {
-        graph_edge_free(world, edge);
-    }
+    graph_edge_free(world, edge);
 }
 
 static
@@ -245,17 +312,22 @@ void remove_edge(
     ecs_graph_edge_t *edge)
 {
     ecs_assert(edges != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(ecs_map_is_initialized(&edges->hi), ECS_INTERNAL_ERROR, NULL);
     disconnect_edge(world, id, edge);
-    ecs_map_remove(&edges->hi, id);
+
+    if (id < ECS_HI_COMPONENT_ID) {
+        remove_lo_edge(edges, id);
+    } else {
+        ecs_assert(ecs_map_is_initialized(&edges->hi), 
+            ECS_INTERNAL_ERROR, NULL);
+        ecs_map_remove(&edges->hi, id);
+    }
 }
 
 static
 void init_edges(
     ecs_graph_edges_t *edges)
 {
-    edges->lo = NULL;
-    ecs_os_zeromem(&edges->hi);
+    ecs_os_zeromem(edges);
 }
 
 static
@@ -266,6 +338,47 @@ void init_node(
     init_edges(&node->remove);
 }
 
+static
+void edge_memory(
+    ecs_graph_edge_t *edge,
+    int32_t *edge_count,
+    int32_t *allocd)
+{
+    *allocd += ECS_SIZEOF(ecs_graph_edge_t);
+    (*edge_count) ++;
+
+    ecs_table_diff_t *diff = edge->diff;
+    if (diff && diff != &ecs_table_edge_is_component) {
+        *allocd += ECS_SIZEOF(ecs_table_diff_t) + ECS_SIZEOF(ecs_id_t) * (
+            diff->added.size + diff->removed.size + 
+            diff->on_set.size + diff->un_set.size);
+    }
+}
+
+static
+void edges_memory(
+    const ecs_graph_edges_t *edges,
+    int32_t *edge_count,
+    int32_t *allocd)
+{
+    int32_t i, count = lo_edge_count(edges);
+    for (i = 0; i < count; i ++) {
+        edge_memory(edges->lo[i], edge_count, allocd);
+    }
+
+    *allocd += count * ECS_SIZEOF(ecs_graph_edge_t*);
+
+    if (ecs_map_is_initialized(&edges->hi)) {
+        ecs_map_iter_t it = ecs_map_iter(&edges->hi);
+        ecs_graph_edge_t *edge;
+        while ((edge = ecs_map_next_ptr(&it, ecs_graph_edge_t*, NULL))) {
+            edge_memory(edge, edge_count, allocd);
+        }
+
+        ecs_map_memory((ecs_map_t*)&edges->hi, allocd, NULL);
+    }
+}
+
 typedef struct {
     int32_t first;
     int32_t count;
@@ -536,6 +649,13 @@ void init_flags(
             table->flags |= EcsTableHasPairs;
         }
 
+        /* Does table have pairs for a relation with a closure index */
+        if (ECS_HAS_ROLE(id, PAIR) && 
+            flecs_closure_is_indexed(world, ECS_PAIR_FIRST(id))) 
+        {
+            table->flags |= EcsTableHasClosure;
+        }
+
         /* Does table have IsA relations */
         if (ECS_HAS_RELATION(id, EcsIsA)) {
             table->flags |= EcsTableHasIsA;
@@ -581,6 +701,7 @@ void init_table(
     table->c_info = NULL;
     table->flags = 0;
     table->dirty_state = NULL;
+    table->row_dirty_state = NULL;
     table->alloc_count = 0;
     table->lock = 0;
     table->refcount = 1;
@@ -613,6 +734,18 @@ ecs_table_t *create_table(
     result->id = flecs_sparse_last_id(&world->store.tables);
     result->type = type;
 
+    /* Store table in table hashmap. This must happen before the table is
+     * initialized, which can add elements to the hashmap and invalidate the
+     * pointers in table_elem. */
+    *(ecs_table_t**)table_elem.value = result;
+
+    /* Set keyvalue to one that has the same lifecycle as the table */
+    ecs_ids_t key = {
+        .array = ecs_vector_first(result->type, ecs_id_t),
+        .count = ecs_vector_count(result->type)
+    };
+    *(ecs_ids_t*)table_elem.key = key;
+
     init_table(world, result);
 
     if (ecs_should_log_2()) {
@@ -625,16 +758,6 @@ ecs_table_t *create_table(
 
     ecs_log_push_2();
 
-    /* Store table in table hashmap */
-    *(ecs_table_t**)table_elem.value = result;
-
-    /* Set keyvalue to one that has the same lifecycle as the table */
-    ecs_ids_t key = {
-        .array = ecs_vector_first(result->type, ecs_id_t),
-        .count = ecs_vector_count(result->type)
-    };
-    *(ecs_ids_t*)table_elem.key = key;
-
     flecs_notify_queries(world, &(ecs_query_event_t) {
         .kind = EcsQueryTableMatch,
         .table = result
@@ -1207,8 +1330,6 @@ void init_add_edge(
 {
     init_edge(table, edge, id, to);
 
-    ensure_hi_edge(world, &table->node.add, id);
-
     if (table != to) {
         /* Add edges are appended to refs.next */
         ecs_graph_edge_hdr_t *to_refs = &to->node.refs;
@@ -1236,8 +1357,6 @@ void init_remove_edge(
 {
     init_edge(table, edge, id, to);
 
-    ensure_hi_edge(world, &table->node.remove, id);
-
     if (table != to) {
         /* Remove edges are appended to refs.prev */
         ecs_graph_edge_hdr_t *to_refs = &to->node.refs;
@@ -1345,6 +1464,12 @@ ecs_table_t* flecs_table_traverse_remove(
     ecs_check(id_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(id_ptr[0] != 0, ECS_INVALID_PARAMETER, NULL);
 
+    /* Chunks share the graph node of the table that owns them */
+    ecs_table_t *chunk = node;
+    if (node->chunk_root) {
+        node = node->chunk_root;
+    }
+
     ecs_id_t id = id_ptr[0];
     ecs_graph_edge_t *edge = ensure_edge(world, &node->node.remove, id);
     ecs_table_t *to = edge->to;
@@ -1357,6 +1482,11 @@ ecs_table_t* flecs_table_traverse_remove(
 
     populate_diff(edge, NULL, id_ptr, diff);
 
+    /* If the type doesn't change the entity stays in its chunk */
+    if (to == node) {
+        return chunk;
+    }
+
     return to;
 error:
     return NULL;
@@ -1376,6 +1506,12 @@ ecs_table_t* flecs_table_traverse_add(
     ecs_check(id_ptr != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_check(id_ptr[0] != 0, ECS_INVALID_PARAMETER, NULL);
 
+    /* Chunks share the graph node of the table that owns them */
+    ecs_table_t *chunk = node;
+    if (node->chunk_root) {
+        node = node->chunk_root;
+    }
+
     ecs_id_t id = id_ptr[0];
     ecs_graph_edge_t *edge = ensure_edge(world, &node->node.add, id);
     ecs_table_t *to = edge->to;
@@ -1388,6 +1524,11 @@ ecs_table_t* flecs_table_traverse_add(
 
     populate_diff(edge, id_ptr, NULL, diff);
 
+    /* If the type doesn't change the entity stays in its chunk */
+    if (to == node) {
+        return chunk;
+    }
+
     return to;
 error:
     return NULL;
@@ -1401,6 +1542,51 @@ ecs_table_t* flecs_table_find_or_create(
     return find_or_create(world, ids, NULL);
 }
 
+ecs_table_t* flecs_table_new_chunk(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table->chunk_root == NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table->chunk_capacity != 0, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_table_t *result = flecs_sparse_add(&world->store.tables, ecs_table_t);
+    ecs_assert(result != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Chunks are not stored in the table hashmap, so that lookups by type
+     * always return the table that owns the chunks */
+    result->id = flecs_sparse_last_id(&world->store.tables);
+    result->type = ecs_vector_copy(table->type, ecs_id_t);
+    result->chunk_root = table;
+    result->chunk_capacity = table->chunk_capacity;
+    result->chunk_index = ecs_vector_count(table->chunks) + 1;
+
+    init_table(world, result);
+
+    ecs_table_t **elem = ecs_vector_add(&table->chunks, ecs_table_t*);
+    *elem = result;
+
+    if (ecs_should_log_2()) {
+        char *expr = ecs_type_str(world, result->type);
+        ecs_dbg_2(
+            "#[green]chunk#[normal] [%s] #[green]created#[normal] with id %d",
+            expr, result->id);
+        ecs_os_free(expr);
+    }
+
+    ecs_log_push_2();
+
+    flecs_notify_queries(world, &(ecs_query_event_t) {
+        .kind = EcsQueryTableMatch,
+        .table = result
+    });
+
+    ecs_log_pop_2();
+
+    return result;
+}
+
 void flecs_init_root_table(
     ecs_world_t *world)
 {
@@ -1438,8 +1624,21 @@ void flecs_table_clear_edges(
     ecs_graph_edge_hdr_t *node_refs = &table_node->refs;
     ecs_graph_edge_t *edge;
     uint64_t key;
+    int32_t i, count;
 
     /* Cleanup outgoing edges */
+    count = lo_edge_count(node_add);
+    for (i = 0; i < count; i ++) {
+        edge = node_add->lo[i];
+        disconnect_edge(world, edge->id, edge);
+    }
+
+    count = lo_edge_count(node_remove);
+    for (i = 0; i < count; i ++) {
+        edge = node_remove->lo[i];
+        disconnect_edge(world, edge->id, edge);
+    }
+
     it = ecs_map_iter(add_hi);
     while ((edge = ecs_map_next_ptr(&it, ecs_graph_edge_t*, &key))) {
         disconnect_edge(world, key, edge);
@@ -1478,12 +1677,21 @@ void flecs_table_clear_edges(
     ecs_os_free(node_remove->lo);
     ecs_map_fini(add_hi);
     ecs_map_fini(remove_hi);
-    table_node->add.lo = NULL;
-    table_node->remove.lo = NULL;
+    init_edges(node_add);
+    init_edges(node_remove);
 
     ecs_log_pop_1();
 }
 
+void flecs_table_graph_memory(
+    const ecs_table_t *table,
+    int32_t *edge_count,
+    int32_t *allocd)
+{
+    edges_memory(&table->node.add, edge_count, allocd);
+    edges_memory(&table->node.remove, edge_count, allocd);
+}
+
 /* Public convenience functions for traversing table graph */
 ecs_table_t* ecs_table_add_id(
     ecs_world_t *world,
@@ -225,10 +225,12 @@ ecs_world_t* flecs_suspend_readonly(
     ecs_stage_t *stage = flecs_stage_from_world(&temp_world);
     state->defer_count = stage->defer;
     state->defer_queue = stage->defer_queue;
+    state->defer_cursor = stage->defer_cursor;
     state->scope = world->stage.scope;
     state->with = world->stage.with;
     stage->defer = 0;
     stage->defer_queue = NULL;
+    stage->defer_cursor = flecs_stack_get_cursor(&stage->defer_stack);
 
     if (&world->stage != (ecs_stage_t*)stage_world) {
         world->stage.scope = stage->scope;
@@ -257,6 +259,7 @@ void flecs_resume_readonly(
         world->is_readonly = state->is_readonly;
         stage->defer = state->defer_count;
         stage->defer_queue = state->defer_queue;
+        stage->defer_cursor = state->defer_cursor;
         world->stage.scope = state->scope;
         world->stage.with = state->with;
     }
@@ -438,12 +441,14 @@ void init_store(
     ecs_os_memset(&world->store, 0, ECS_SIZEOF(ecs_store_t));
     
     /* Initialize entity index */
-    flecs_sparse_init(&world->store.entity_index, ecs_record_t);
+    flecs_sparse_init_w_allocator(&world->store.entity_index, ecs_record_t,
+        &world->allocator);
     flecs_sparse_set_id_source(&world->store.entity_index, 
         &world->stats.last_id);
 
     /* Initialize root table */
-    flecs_sparse_init(&world->store.tables, ecs_table_t);
+    flecs_sparse_init_w_allocator(&world->store.tables, ecs_table_t,
+        &world->allocator);
 
     /* Initialize table map */
     flecs_table_hashmap_init(&world->store.table_map);
@@ -656,8 +661,10 @@ ecs_world_t *ecs_mini(void) {
     ecs_poly_init(world, ecs_world_t);
 
     world->self = world;
+    flecs_allocator_init(&world->allocator);
     world->type_info = flecs_sparse_new(ecs_type_info_t);
-    ecs_map_init(&world->id_index, ecs_id_record_t*, ECS_HI_COMPONENT_ID);
+    ecs_map_init_w_allocator(&world->id_index, ecs_id_record_t*, 
+        ECS_HI_COMPONENT_ID, &world->allocator);
     flecs_observable_init(&world->observable);
     world->iterable.init = world_iter_init;
 
@@ -676,6 +683,8 @@ ecs_world_t *ecs_mini(void) {
     world->stats.time_scale = 1.0;
     
     monitors_init(&world->monitors);
+    flecs_filter_cache_init(&world->filter_cache);
+    flecs_closure_init(world);
 
     if (ecs_os_has_time()) {
         ecs_os_get_time(&world->world_start_time);
@@ -1172,7 +1181,7 @@ ecs_id_record_t* new_id_record(
     ecs_id_t id)
 {
     ecs_id_record_t *idr = ecs_os_calloc_t(ecs_id_record_t);
-    ecs_table_cache_init(&idr->cache);
+    ecs_table_cache_init(&idr->cache, &world->allocator);
 
     ecs_entity_t rel = 0, obj = 0;
     if (ECS_HAS_ROLE(id, PAIR)) {
@@ -1309,6 +1318,8 @@ void fini_misc(
 {
     ecs_map_fini(&world->type_handles);
     ecs_vector_free(world->fini_tasks);
+    flecs_filter_cache_fini(&world->filter_cache);
+    flecs_closure_fini(world);
 }
 
 /* The destroyer of worlds */
@@ -1374,6 +1385,9 @@ int ecs_fini(
     
     fini_misc(world);
 
+    /* Storage allocated from the pools has been freed at this point */
+    flecs_allocator_fini(&world->allocator);
+
     ecs_os_enable_high_timer_resolution(false);
 
     /* End of the world */
@@ -1718,11 +1732,33 @@ FLECS_FLOAT ecs_frame_begin(
 
     ecs_force_aperiodic(world);
 
+    world->is_in_frame = true;
+
     return world->stats.delta_time;
 error:
     return (FLECS_FLOAT)0;
 }
 
+static
+void stage_collect_stack_stats(
+    ecs_world_t *world,
+    ecs_stack_t *stack)
+{
+    world->stats.stack_page_count += stack->page_count;
+    world->stats.stack_alloc_count_total += stack->alloc_count;
+    stack->alloc_count = 0;
+}
+
+static
+void stage_frame_end(
+    ecs_world_t *world,
+    ecs_stage_t *stage)
+{
+    stage_collect_stack_stats(world, &stage->defer_stack);
+    stage_collect_stack_stats(world, &stage->frame_stack);
+    flecs_stack_reset(&stage->frame_stack);
+}
+
 void ecs_frame_end(
     ecs_world_t *world)
 {
@@ -1733,7 +1769,18 @@ void ecs_frame_end(
 
     ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
         flecs_stage_merge_post_frame(world, stage);
-    });        
+    });
+
+    /* Collect allocator statistics from stages, release frame memory */
+    world->stats.stack_page_count = 0;
+    stage_frame_end(world, &world->stage);
+    ecs_vector_each(world->worker_stages, ecs_stage_t, stage, {
+        stage_frame_end(world, stage);
+    });
+
+    world->is_in_frame = false;
+    world->stats.pool_block_count = world->allocator.block_count;
+    world->stats.pool_alloc_count_total = world->allocator.alloc_count;
 
     if (world->locking_enabled) {
         ecs_unlock(world);
@@ -1761,6 +1808,12 @@ void flecs_notify_queries(
 {
     ecs_poly_assert(world, ecs_world_t); 
 
+    if (event->kind == EcsQueryTableMatch || 
+        event->kind == EcsQueryTableUnmatch) 
+    {
+        flecs_filter_cache_invalidate(world);
+    }
+
     int32_t i, count = flecs_sparse_count(world->queries);
     for (i = 0; i < count; i ++) {
         ecs_query_t *query = flecs_sparse_get_dense(
@@ -1834,6 +1887,11 @@ void flecs_process_pending_tables(
             /* For each id in the table, add it to the empty/non empty list
              * based on its current state */
             if (flecs_table_records_update_empty(table)) {
+                /* Closures only contain non-empty tables */
+                if (table->flags & EcsTableHasClosure) {
+                    flecs_closure_table_dirty(world, table);
+                }
+
                 /* Only emit an event when there was a change in the 
                  * administration. It is possible that a table ended up in the
                  * pending_tables list by going from empty->non-empty, but then
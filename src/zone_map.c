@@ -0,0 +1,239 @@
+#include "private_api.h"
+
+void flecs_table_zone_maps_fini(
+    ecs_table_t *table)
+{
+    ecs_zone_map_t *maps = ecs_vector_first(table->zone_maps, ecs_zone_map_t);
+    int32_t i, count = ecs_vector_count(table->zone_maps);
+    for (i = 0; i < count; i ++) {
+        ecs_vector_free(maps[i].blocks);
+    }
+
+    ecs_vector_free(table->zone_maps);
+    table->zone_maps = NULL;
+}
+
+void flecs_table_zone_maps_mark_dirty(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count)
+{
+    ecs_zone_map_t *maps = ecs_vector_first(table->zone_maps, ecs_zone_map_t);
+    int32_t i, map_count = ecs_vector_count(table->zone_maps);
+    for (i = 0; i < map_count; i ++) {
+        ecs_zone_map_t *map = &maps[i];
+        if (map->column != column) {
+            continue;
+        }
+
+        map->dirty = true;
+
+        /* Rows past the last block were added after the map was updated, which
+         * changed the table dirty state, so they don't need to be marked. */
+        ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+        int32_t b = offset / ECS_ZONE_BLOCK_SIZE;
+        int32_t end = (offset + count + ECS_ZONE_BLOCK_SIZE - 1) /
+            ECS_ZONE_BLOCK_SIZE;
+        int32_t block_count = ecs_vector_count(map->blocks);
+        if (end > block_count) {
+            end = block_count;
+        }
+
+        for (; b < end; b ++) {
+            blocks[b].dirty = true;
+        }
+    }
+}
+
+#ifdef FLECS_META
+
+/* Compute min/max of a primitive member for a range of rows. NaN values are
+ * ignored, as they never match a range. If no values are found, min is larger
+ * than max. */
+#define FLECS_ZONE_COMPUTE(T)\
+    static\
+    void zone_compute_##T(\
+        ecs_zone_t *zone,\
+        const void *ptr,\
+        ecs_size_t size,\
+        int32_t count)\
+    {\
+        double min = 1, max = 0;\
+        int32_t i;\
+        for (i = 0; i < count; i ++) {\
+            double v = (double)*(const T*)ECS_OFFSET(ptr, i * size);\
+            if (v != v) {\
+                continue;\
+            }\
+            if (min > max) {\
+                min = max = v;\
+            } else if (v < min) {\
+                min = v;\
+            } else if (v > max) {\
+                max = v;\
+            }\
+        }\
+        zone->min = min;\
+        zone->max = max;\
+    }
+
+FLECS_ZONE_COMPUTE(ecs_bool_t)
+FLECS_ZONE_COMPUTE(ecs_char_t)
+FLECS_ZONE_COMPUTE(ecs_byte_t)
+FLECS_ZONE_COMPUTE(ecs_u8_t)
+FLECS_ZONE_COMPUTE(ecs_u16_t)
+FLECS_ZONE_COMPUTE(ecs_u32_t)
+FLECS_ZONE_COMPUTE(ecs_u64_t)
+FLECS_ZONE_COMPUTE(ecs_uptr_t)
+FLECS_ZONE_COMPUTE(ecs_i8_t)
+FLECS_ZONE_COMPUTE(ecs_i16_t)
+FLECS_ZONE_COMPUTE(ecs_i32_t)
+FLECS_ZONE_COMPUTE(ecs_i64_t)
+FLECS_ZONE_COMPUTE(ecs_iptr_t)
+FLECS_ZONE_COMPUTE(ecs_f32_t)
+FLECS_ZONE_COMPUTE(ecs_f64_t)
+FLECS_ZONE_COMPUTE(ecs_entity_t)
+
+static
+void zone_compute(
+    ecs_zone_t *zone,
+    const void *ptr,
+    ecs_size_t size,
+    int32_t count,
+    ecs_primitive_kind_t kind)
+{
+    switch(kind) {
+    case EcsBool: zone_compute_ecs_bool_t(zone, ptr, size, count); break;
+    case EcsChar: zone_compute_ecs_char_t(zone, ptr, size, count); break;
+    case EcsByte: zone_compute_ecs_byte_t(zone, ptr, size, count); break;
+    case EcsU8: zone_compute_ecs_u8_t(zone, ptr, size, count); break;
+    case EcsU16: zone_compute_ecs_u16_t(zone, ptr, size, count); break;
+    case EcsU32: zone_compute_ecs_u32_t(zone, ptr, size, count); break;
+    case EcsU64: zone_compute_ecs_u64_t(zone, ptr, size, count); break;
+    case EcsUPtr: zone_compute_ecs_uptr_t(zone, ptr, size, count); break;
+    case EcsI8: zone_compute_ecs_i8_t(zone, ptr, size, count); break;
+    case EcsI16: zone_compute_ecs_i16_t(zone, ptr, size, count); break;
+    case EcsI32: zone_compute_ecs_i32_t(zone, ptr, size, count); break;
+    case EcsI64: zone_compute_ecs_i64_t(zone, ptr, size, count); break;
+    case EcsIPtr: zone_compute_ecs_iptr_t(zone, ptr, size, count); break;
+    case EcsF32: zone_compute_ecs_f32_t(zone, ptr, size, count); break;
+    case EcsF64: zone_compute_ecs_f64_t(zone, ptr, size, count); break;
+    case EcsEntity: zone_compute_ecs_entity_t(zone, ptr, size, count); break;
+    default: ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+
+    zone->dirty = false;
+}
+
+static
+void zone_map_update(
+    ecs_table_t *table,
+    ecs_zone_map_t *map,
+    int32_t table_state)
+{
+    int32_t i, count = ecs_table_count(table);
+    int32_t block_count = (count + ECS_ZONE_BLOCK_SIZE - 1) /
+        ECS_ZONE_BLOCK_SIZE;
+
+    /* If entities were added, removed or moved all blocks must be updated */
+    if (map->table_state != table_state) {
+        ecs_vector_set_count(&map->blocks, ecs_zone_t, block_count);
+        ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+        for (i = 0; i < block_count; i ++) {
+            blocks[i].dirty = true;
+        }
+        map->table_state = table_state;
+    }
+
+    ecs_column_t *column = &table->storage.columns[map->column];
+    ecs_size_t size = column->size;
+    void *ptr = ECS_OFFSET(ecs_vector_first_t(
+        column->data, size, column->alignment), map->offset);
+
+    ecs_zone_t *blocks = ecs_vector_first(map->blocks, ecs_zone_t);
+    ecs_zone_t *zone = &map->table;
+    zone->min = 1;
+    zone->max = 0;
+
+    for (i = 0; i < block_count; i ++) {
+        ecs_zone_t *block = &blocks[i];
+        if (block->dirty) {
+            int32_t first = i * ECS_ZONE_BLOCK_SIZE;
+            int32_t block_rows = count - first;
+            if (block_rows > ECS_ZONE_BLOCK_SIZE) {
+                block_rows = ECS_ZONE_BLOCK_SIZE;
+            }
+
+            zone_compute(block, ECS_OFFSET(ptr, first * size), size,
+                block_rows, (ecs_primitive_kind_t)map->kind);
+        }
+
+        if (block->min > block->max) {
+            continue;
+        }
+
+        if (zone->min > zone->max) {
+            zone->min = block->min;
+            zone->max = block->max;
+        } else {
+            if (block->min < zone->min) {
+                zone->min = block->min;
+            }
+            if (block->max > zone->max) {
+                zone->max = block->max;
+            }
+        }
+    }
+
+    map->dirty = false;
+}
+
+ecs_zone_map_t* flecs_table_get_zone_map(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    ecs_primitive_kind_t kind,
+    bool can_update)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column >= 0, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_zone_map_t *map = NULL, *maps = ecs_vector_first(
+        table->zone_maps, ecs_zone_map_t);
+    int32_t i, count = ecs_vector_count(table->zone_maps);
+    for (i = 0; i < count; i ++) {
+        if (maps[i].column == column && maps[i].offset == offset) {
+            map = &maps[i];
+            break;
+        }
+    }
+
+    if (!map) {
+        if (!can_update) {
+            return NULL;
+        }
+
+        map = ecs_vector_add(&table->zone_maps, ecs_zone_map_t);
+        map->column = column;
+        map->offset = offset;
+        map->kind = kind;
+        map->table_state = 0; /* Dirty state starts at 1, forces update */
+        map->dirty = true;
+        map->blocks = NULL;
+    }
+
+    /* Ensure the table tracks changes, so that blocks are marked dirty */
+    int32_t table_state = flecs_table_get_dirty_state(table)[0];
+    if (map->table_state != table_state || map->dirty) {
+        if (!can_update) {
+            return NULL;
+        }
+
+        zone_map_update(table, map, table_state);
+    }
+
+    return map;
+}
+
+#endif
@@ -0,0 +1,624 @@
+#include <api.h>
+
+static
+const ecs_entity_t* bulk_new_w_position(
+    ecs_world_t *world,
+    ecs_entity_t ecs_id(Position),
+    int32_t count)
+{
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, count);
+    test_assert(ids != NULL);
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_set(world, ids[i], Position, {i, i * 2});
+    }
+
+    return ids;
+}
+
+static
+void test_positions(
+    ecs_world_t *world,
+    ecs_entity_t ecs_id(Position),
+    const ecs_entity_t *ids,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+}
+
+void Bulk_add_id() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    ecs_bulk_add(world, entities, 100, Velocity);
+
+    test_int(ecs_count(world, Velocity), 100);
+    test_int(ecs_count(world, Position), 100);
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        test_assert(ecs_has(world, entities[i], Velocity));
+    }
+
+    test_positions(world, ecs_id(Position), entities, 100);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_middle_range() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    ecs_bulk_add(world, &entities[10], 10, Velocity);
+
+    test_int(ecs_count(world, Velocity), 10);
+    test_int(ecs_count(world, Position), 100);
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        test_bool(ecs_has(world, entities[i], Velocity), i >= 10 && i < 20);
+    }
+
+    test_positions(world, ecs_id(Position), entities, 100);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_range_w_short_tail() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    /* Fewer rows after the range than in the range */
+    ecs_bulk_add(world, &entities[50], 40, Velocity);
+
+    test_int(ecs_count(world, Velocity), 40);
+    test_int(ecs_count(world, Position), 100);
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        test_bool(ecs_has(world, entities[i], Velocity), i >= 50 && i < 90);
+    }
+
+    test_positions(world, ecs_id(Position), entities, 100);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_reverse_order() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10], reversed[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        entities[i] = ids[i];
+        reversed[9 - i] = ids[i];
+    }
+
+    ecs_bulk_add(world, reversed, 10, Velocity);
+
+    test_int(ecs_count(world, Velocity), 10);
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_has(world, entities[i], Velocity));
+    }
+
+    test_positions(world, ecs_id(Position), entities, 10);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_multiple_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t entities[4] = {
+        ecs_new(world, Position),
+        ecs_new(world, Position),
+        ecs_new_w_id(world, TagB),
+        ecs_new_w_id(world, TagB)
+    };
+
+    ecs_set(world, entities[0], Position, {10, 20});
+    ecs_set(world, entities[1], Position, {30, 40});
+
+    ecs_bulk_add_id(world, entities, 4, Tag);
+
+    test_int(ecs_count_id(world, Tag), 4);
+    test_assert(ecs_has(world, entities[0], Position));
+    test_assert(ecs_has(world, entities[1], Position));
+    test_assert(ecs_has_id(world, entities[2], TagB));
+    test_assert(ecs_has_id(world, entities[3], TagB));
+
+    const Position *p = ecs_get(world, entities[0], Position);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get(world, entities[1], Position);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_existing() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    ecs_table_t *table = ecs_get_table(world, entities[0]);
+    ecs_bulk_add(world, entities, 10, Position);
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_get_table(world, entities[i]) == table);
+    }
+
+    test_int(ecs_count(world, Position), 10);
+    test_positions(world, ecs_id(Position), entities, 10);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_empty_entities() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t entities[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        entities[i] = ecs_new_id(world);
+    }
+
+    ecs_bulk_add(world, entities, 10, Position);
+
+    test_int(ecs_count(world, Position), 10);
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_is_alive(world, entities[i]));
+        test_assert(ecs_has(world, entities[i], Position));
+    }
+
+    ecs_fini(world);
+}
+
+void Bulk_remove_id() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    ecs_bulk_add(world, entities, 100, Velocity);
+    test_int(ecs_count(world, Velocity), 100);
+
+    ecs_bulk_remove(world, &entities[20], 30, Velocity);
+    test_int(ecs_count(world, Velocity), 70);
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        test_bool(ecs_has(world, entities[i], Velocity), i < 20 || i >= 50);
+    }
+
+    test_positions(world, ecs_id(Position), entities, 100);
+
+    ecs_fini(world);
+}
+
+void Bulk_remove_last_id() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    ecs_bulk_remove(world, &entities[2], 5, Position);
+    test_int(ecs_count(world, Position), 5);
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_is_alive(world, entities[i]));
+        if (i >= 2 && i < 7) {
+            test_assert(ecs_get_type(world, entities[i]) == NULL);
+        } else {
+            const Position *p = ecs_get(world, entities[i], Position);
+            test_assert(p != NULL);
+            test_int(p->x, i);
+            test_int(p->y, i * 2);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void Bulk_remove_id_not_added() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    ecs_bulk_remove(world, entities, 10, Velocity);
+    test_int(ecs_count(world, Position), 10);
+    test_positions(world, ecs_id(Position), entities, 10);
+
+    ecs_fini(world);
+}
+
+void Bulk_set_id() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    Velocity v[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        v[i] = (Velocity){i * 3, i * 4};
+    }
+
+    ecs_bulk_set(world, entities, 10, Velocity, v);
+    test_int(ecs_count(world, Velocity), 10);
+
+    for (i = 0; i < 10; i ++) {
+        const Velocity *ptr = ecs_get(world, entities[i], Velocity);
+        test_assert(ptr != NULL);
+        test_int(ptr->x, i * 3);
+        test_int(ptr->y, i * 4);
+    }
+
+    test_positions(world, ecs_id(Position), entities, 10);
+
+    ecs_fini(world);
+}
+
+void Bulk_set_id_existing() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    Position p[5];
+    int32_t i;
+    for (i = 0; i < 5; i ++) {
+        p[i] = (Position){i + 100, i + 200};
+    }
+
+    ecs_bulk_set(world, &entities[5], 5, Position, p);
+    test_int(ecs_count(world, Position), 10);
+
+    for (i = 0; i < 10; i ++) {
+        const Position *ptr = ecs_get(world, entities[i], Position);
+        test_assert(ptr != NULL);
+        if (i < 5) {
+            test_int(ptr->x, i);
+            test_int(ptr->y, i * 2);
+        } else {
+            test_int(ptr->x, i - 5 + 100);
+            test_int(ptr->y, i - 5 + 200);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_on_add_trigger() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = Tag,
+        .events = {EcsOnAdd},
+        .callback = probe_iter,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    ecs_bulk_add_id(world, entities, 100, Tag);
+
+    /* Entities are moved in a single operation */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+    test_int(ctx.event, EcsOnAdd);
+    test_int(ctx.event_id, Tag);
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        test_int(ctx.e[i], entities[i]);
+    }
+
+    ecs_fini(world);
+}
+
+void Bulk_remove_id_on_remove_trigger() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    ecs_bulk_add_id(world, entities, 100, Tag);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = Tag,
+        .events = {EcsOnRemove},
+        .callback = probe_iter,
+        .ctx = &ctx
+    });
+
+    ecs_bulk_remove_id(world, &entities[25], 50, Tag);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 50);
+    test_int(ctx.event, EcsOnRemove);
+
+    int32_t i;
+    for (i = 0; i < 50; i ++) {
+        test_int(ctx.e[i], entities[25 + i]);
+    }
+
+    test_int(ecs_count_id(world, Tag), 50);
+
+    ecs_fini(world);
+}
+
+void Bulk_set_id_on_set_trigger() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = ecs_id(Velocity),
+        .events = {EcsOnSet},
+        .callback = probe_iter,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    Velocity v[10] = {{0}};
+    ecs_bulk_set(world, entities, 10, Velocity, v);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 10);
+    test_int(ctx.event, EcsOnSet);
+
+    ecs_fini(world);
+}
+
+static int ctor_count = 0;
+static int dtor_count = 0;
+
+static ECS_CTOR(Velocity, ptr, {
+    ptr->x = 1;
+    ptr->y = 2;
+    ctor_count ++;
+})
+
+static ECS_DTOR(Velocity, ptr, {
+    dtor_count ++;
+})
+
+void Bulk_add_remove_w_lifecycle() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_component_actions(world, Velocity, {
+        .ctor = ecs_ctor(Velocity),
+        .dtor = ecs_dtor(Velocity)
+    });
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 20);
+    ecs_entity_t entities[20];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 20);
+
+    ecs_bulk_add(world, entities, 20, Velocity);
+    test_int(ctor_count, 20);
+    test_int(dtor_count, 0);
+
+    int32_t i;
+    for (i = 0; i < 20; i ++) {
+        const Velocity *v = ecs_get(world, entities[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, 1);
+        test_int(v->y, 2);
+    }
+
+    ctor_count = 0;
+
+    ecs_bulk_remove(world, &entities[5], 10, Velocity);
+    test_int(dtor_count, 10);
+    test_int(ecs_count(world, Velocity), 10);
+
+    test_positions(world, ecs_id(Position), entities, 20);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_w_filter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e3, Velocity);
+    ecs_entity_t e4 = ecs_new(world, Velocity);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_bulk_add_id_w_filter(world, &f, Tag);
+
+    test_assert(ecs_has_id(world, e1, Tag));
+    test_assert(ecs_has_id(world, e2, Tag));
+    test_assert(ecs_has_id(world, e3, Tag));
+    test_assert(!ecs_has_id(world, e4, Tag));
+    test_assert(ecs_has(world, e3, Velocity));
+    test_int(ecs_count_id(world, Tag), 3);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Bulk_remove_id_w_filter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_entity_t e4 = ecs_new(world, Position);
+    ecs_add(world, e1, Tag);
+    ecs_add(world, e2, Tag);
+    ecs_add(world, e3, Tag);
+    ecs_add(world, e3, Velocity);
+    ecs_add(world, e4, Velocity);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Velocity) }}
+    });
+
+    ecs_bulk_remove_id_w_filter(world, &f, Tag);
+
+    test_assert(ecs_has_id(world, e1, Tag));
+    test_assert(ecs_has_id(world, e2, Tag));
+    test_assert(!ecs_has_id(world, e3, Tag));
+    test_assert(!ecs_has_id(world, e4, Tag));
+    test_assert(ecs_has(world, e3, Velocity));
+    test_assert(ecs_has(world, e3, Position));
+    test_int(ecs_count_id(world, Tag), 2);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Bulk_add_id_deferred() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    ecs_defer_begin(world);
+    ecs_bulk_add(world, entities, 10, Velocity);
+    test_int(ecs_count(world, Velocity), 0);
+    ecs_defer_end(world);
+
+    test_int(ecs_count(world, Velocity), 10);
+    test_positions(world, ecs_id(Position), entities, 10);
+
+    ecs_fini(world);
+}
+
+void Bulk_set_id_deferred() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    const ecs_entity_t *ids = bulk_new_w_position(world, ecs_id(Position), 10);
+    ecs_entity_t entities[10];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 10);
+
+    Velocity v[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        v[i] = (Velocity){i, i + 1};
+    }
+
+    ecs_defer_begin(world);
+    ecs_bulk_set(world, entities, 10, Velocity, v);
+    test_int(ecs_count(world, Velocity), 0);
+    ecs_defer_end(world);
+
+    test_int(ecs_count(world, Velocity), 10);
+    for (i = 0; i < 10; i ++) {
+        const Velocity *ptr = ecs_get(world, entities[i], Velocity);
+        test_assert(ptr != NULL);
+        test_int(ptr->x, i);
+        test_int(ptr->y, i + 1);
+    }
+
+    ecs_fini(world);
+}
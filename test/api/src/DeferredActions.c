@@ -1846,3 +1846,684 @@ void DeferredActions_defer_remove_all() {
 
     ecs_fini(world);
 }
+
+typedef struct LargeValue {
+    int32_t values[4096];
+} LargeValue;
+
+void DeferredActions_defer_set_large_value() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, LargeValue);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+
+    LargeValue *v = ecs_get_mut(world, e, LargeValue, NULL);
+    test_assert(v != NULL);
+    int32_t i;
+    for (i = 0; i < 4096; i ++) {
+        v->values[i] = i;
+    }
+
+    ecs_set(world, e, Position, {30, 40});
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, LargeValue));
+    ecs_defer_end(world);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    const LargeValue *lv = ecs_get(world, e, LargeValue);
+    test_assert(lv != NULL);
+    for (i = 0; i < 4096; i ++) {
+        test_int(lv->values[i], i);
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_get_mut_many() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t entities[1000];
+    Position *ptrs[1000];
+    int32_t i;
+
+    for (i = 0; i < 1000; i ++) {
+        entities[i] = ecs_new_id(world);
+    }
+
+    for (int32_t f = 0; f < 2; f ++) {
+        ecs_defer_begin(world);
+        for (i = 0; i < 1000; i ++) {
+            ptrs[i] = ecs_get_mut(world, entities[i], Position, NULL);
+            test_assert(ptrs[i] != NULL);
+            ptrs[i]->x = i + f;
+            ptrs[i]->y = i * 2 + f;
+        }
+
+        /* Pointers must remain stable while the queue grows */
+        for (i = 0; i < 1000; i ++) {
+            test_int(ptrs[i]->x, i + f);
+            test_int(ptrs[i]->y, i * 2 + f);
+        }
+        ecs_defer_end(world);
+
+        for (i = 0; i < 1000; i ++) {
+            const Position *p = ecs_get(world, entities[i], Position);
+            test_assert(p != NULL);
+            test_int(p->x, i + f);
+            test_int(p->y, i * 2 + f);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+static
+void OnSetPositionDeferSet(ecs_iter_t *it) {
+    Position *p = ecs_term(it, Position, 1);
+    ecs_id_t ecs_id(Velocity) = ecs_term_id(it, 2);
+
+    ecs_defer_begin(it->world);
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_set(it->world, it->entities[i], Velocity, {p[i].x, p[i].y});
+    }
+    ecs_defer_end(it->world);
+}
+
+void DeferredActions_defer_set_in_nested_flush() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ECS_OBSERVER(world, OnSetPositionDeferSet, EcsOnSet, 
+        Position, !Velocity(Velocity));
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_set(world, e3, Position, {50, 60});
+    ecs_defer_end(world);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    const Velocity *v = ecs_get(world, e1, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 10);
+    test_int(v->y, 20);
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    v = ecs_get(world, e2, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 30);
+    test_int(v->y, 40);
+
+    p = ecs_get(world, e3, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+    v = ecs_get(world, e3, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 50);
+    test_int(v->y, 60);
+
+    ecs_fini(world);
+}
+
+static int32_t add_batch_invoked = 0;
+
+static
+void OnAddPositionHasVelocity(ecs_iter_t *it) {
+    ecs_id_t ecs_id(Velocity) = ecs_term_id(it, 2);
+    ecs_id_t ecs_id(Mass) = ecs_term_id(it, 3);
+
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        test_assert(ecs_has(it->world, it->entities[i], Velocity));
+        test_assert(ecs_has(it->world, it->entities[i], Mass));
+    }
+
+    add_batch_invoked += it->count;
+}
+
+void DeferredActions_defer_add_batch_single_move() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ECS_OBSERVER(world, OnAddPositionHasVelocity, EcsOnAdd, 
+        Position, !Velocity(Velocity), !Mass(Mass));
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, Position);
+    ecs_add(world, e, Velocity);
+    ecs_add(world, e, Mass);
+    ecs_defer_end(world);
+
+    test_int(add_batch_invoked, 1);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+    test_assert(ecs_has(world, e, Mass));
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_remove_batch_same_entity() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_entity_t e = ecs_new(world, Mass);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e, Position);
+    ecs_add(world, e, Velocity);
+    ecs_remove(world, e, Position);
+    ecs_remove(world, e, Mass);
+    ecs_defer_end(world);
+
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+    test_assert(!ecs_has(world, e, Mass));
+
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    test_assert(ecs_get_table(world, e) == ecs_get_table(world, e2));
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batch_interleaved_entities() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e1, Position);
+    ecs_add(world, e1, Velocity);
+    ecs_add(world, e2, Position);
+    ecs_add(world, e1, Mass);
+    ecs_add(world, e2, Mass);
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e1, Position));
+    test_assert(ecs_has(world, e1, Velocity));
+    test_assert(ecs_has(world, e1, Mass));
+
+    test_assert(ecs_has(world, e2, Position));
+    test_assert(!ecs_has(world, e2, Velocity));
+    test_assert(ecs_has(world, e2, Mass));
+
+    ecs_fini(world);
+}
+
+static
+void TriggerBatch(ecs_iter_t *it) {
+    probe_system_w_ctx(it, it->ctx);
+}
+
+void DeferredActions_defer_bulk_new_batch_trigger() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = ecs_id(Position),
+        .events = {EcsOnAdd},
+        .callback = TriggerBatch,
+        .ctx = &ctx
+    });
+
+    ecs_defer_begin(world);
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 100);
+    test_assert(ids != NULL);
+    test_int(ctx.invoked, 0);
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        test_assert(ecs_has(world, ids[i], Position));
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batch_trigger() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = ecs_id(Velocity),
+        .events = {EcsOnAdd},
+        .callback = TriggerBatch,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    int i;
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i ++) {
+        ecs_add(world, entities[i], Velocity);
+    }
+    test_int(ctx.invoked, 0);
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+
+    for (i = 0; i < 100; i ++) {
+        test_assert(ecs_has(world, entities[i], Position));
+        test_assert(ecs_has(world, entities[i], Velocity));
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_remove_batch_trigger() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = ecs_id(Velocity),
+        .events = {EcsOnRemove},
+        .callback = TriggerBatch,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+    ecs_bulk_add(world, entities, 100, Velocity);
+
+    int i;
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i ++) {
+        ecs_remove(world, entities[i], Velocity);
+    }
+    test_int(ctx.invoked, 0);
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+
+    for (i = 0; i < 100; i ++) {
+        test_assert(ecs_has(world, entities[i], Position));
+        test_assert(!ecs_has(world, entities[i], Velocity));
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_set_batch_trigger() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = ecs_id(Velocity),
+        .events = {EcsOnSet},
+        .callback = TriggerBatch,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    int i;
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, entities[i], Velocity, {i, i * 2});
+    }
+    test_int(ctx.invoked, 0);
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+
+    for (i = 0; i < 100; i ++) {
+        const Velocity *v = ecs_get(world, entities[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i);
+        test_int(v->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+static int move_velocity = 0;
+static
+ECS_MOVE(Velocity, dst, src, {
+    *dst = *src;
+    move_velocity ++;
+})
+
+void DeferredActions_defer_set_batch_w_move() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set(world, ecs_id(Velocity), EcsComponentLifecycle, {
+        .move = ecs_move(Velocity)
+    });
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_set(world, e3, Velocity, {5, 6});
+    ecs_defer_end(world);
+
+    test_int(move_velocity, 3);
+
+    const Velocity *v = ecs_get(world, e1, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    v = ecs_get(world, e2, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 3);
+    test_int(v->y, 4);
+
+    v = ecs_get(world, e3, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 5);
+    test_int(v->y, 6);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batch_observer() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    Probe ctx = {0};
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{ecs_id(Position)}, {ecs_id(Velocity)}},
+        .events = {EcsOnAdd},
+        .callback = TriggerBatch,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    int i;
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i ++) {
+        ecs_add(world, entities[i], Velocity);
+    }
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batch_w_deleted_entity() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_delete(world, e2);
+    ecs_add(world, e1, Tag);
+    ecs_add(world, e2, Tag);
+    ecs_add(world, e3, Tag);
+    ecs_defer_end(world);
+
+    test_assert(ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+    test_assert(ecs_is_alive(world, e3));
+    test_assert(ecs_has(world, e1, Tag));
+    test_assert(ecs_has(world, e3, Tag));
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batch_w_same_entity_ops() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_add(world, e1, Position);
+    ecs_add(world, e2, Position);
+    ecs_add(world, e3, Position);
+    ecs_add(world, e3, Velocity);
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e1, Position));
+    test_assert(!ecs_has(world, e1, Velocity));
+    test_assert(ecs_has(world, e2, Position));
+    test_assert(!ecs_has(world, e2, Velocity));
+    test_assert(ecs_has(world, e3, Position));
+    test_assert(ecs_has(world, e3, Velocity));
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_add_batch_entity_sequences() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = ecs_id(Velocity),
+        .events = {EcsOnAdd},
+        .callback = TriggerBatch,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = ecs_bulk_new(world, Position, 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    int i;
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i ++) {
+        ecs_add(world, entities[i], Velocity);
+        ecs_add(world, entities[i], Mass);
+    }
+    ecs_defer_end(world);
+
+    /* Entities are moved to the new table with a single bulk operation */
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+
+    for (i = 0; i < 100; i ++) {
+        test_assert(ecs_has(world, entities[i], Position));
+        test_assert(ecs_has(world, entities[i], Velocity));
+        test_assert(ecs_has(world, entities[i], Mass));
+    }
+
+    ecs_fini(world);
+}
+
+void DeferredActions_defer_remove_batch_entity_sequences() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_TYPE(world, Type, Position, Velocity, Mass);
+
+    Probe ctx = {0};
+    ecs_trigger_init(world, &(ecs_trigger_desc_t){
+        .term.id = ecs_id(Velocity),
+        .events = {EcsOnRemove},
+        .callback = TriggerBatch,
+        .ctx = &ctx
+    });
+
+    const ecs_entity_t *ids = bulk_new_w_type(world, Type, 100);
+    ecs_entity_t entities[100];
+    ecs_os_memcpy_n(entities, ids, ecs_entity_t, 100);
+
+    int i;
+    ecs_defer_begin(world);
+    for (i = 0; i < 100; i ++) {
+        ecs_remove(world, entities[i], Velocity);
+        ecs_remove(world, entities[i], Mass);
+    }
+    ecs_add(world, entities[99], Velocity);
+    ecs_defer_end(world);
+
+    test_int(ctx.invoked, 1);
+    test_int(ctx.count, 100);
+
+    for (i = 0; i < 100; i ++) {
+        test_assert(ecs_has(world, entities[i], Position));
+        test_assert(!ecs_has(world, entities[i], Mass));
+        if (i == 99) {
+            test_assert(ecs_has(world, entities[i], Velocity));
+        } else {
+            test_assert(!ecs_has(world, entities[i], Velocity));
+        }
+    }
+
+    ecs_fini(world);
+}
+
+typedef struct SelfRef {
+    void *self;
+    int32_t value;
+} SelfRef;
+
+static
+ECS_CTOR(SelfRef, ptr, {
+    ptr->self = ptr;
+    ptr->value = 0;
+})
+
+static
+ECS_DTOR(SelfRef, ptr, {
+    test_assert(ptr->self == ptr);
+})
+
+static
+ECS_COPY(SelfRef, dst, src, {
+    test_assert(dst->self == dst);
+    test_assert(src->self == src);
+    dst->value = src->value;
+})
+
+static int move_self_ref = 0;
+static
+ECS_MOVE(SelfRef, dst, src, {
+    test_assert(dst->self == dst);
+    test_assert(src->self == src);
+    dst->value = src->value;
+    move_self_ref ++;
+})
+
+void DeferredActions_defer_set_batch_not_relocatable() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, SelfRef);
+
+    ecs_set(world, ecs_id(SelfRef), EcsComponentLifecycle, {
+        .ctor = ecs_ctor(SelfRef),
+        .dtor = ecs_dtor(SelfRef),
+        .copy = ecs_copy(SelfRef),
+        .move = ecs_move(SelfRef)
+    });
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+
+    SelfRef v1 = {&v1, 10}, v2 = {&v2, 20}, v3 = {&v3, 30};
+
+    ecs_defer_begin(world);
+    ecs_set_ptr(world, e1, SelfRef, &v1);
+    ecs_set_ptr(world, e2, SelfRef, &v2);
+    ecs_set_ptr(world, e3, SelfRef, &v3);
+    ecs_defer_end(world);
+
+    test_assert(move_self_ref >= 3);
+
+    const SelfRef *ptr = ecs_get(world, e1, SelfRef);
+    test_assert(ptr != NULL);
+    test_assert(ptr->self == ptr);
+    test_int(ptr->value, 10);
+
+    ptr = ecs_get(world, e2, SelfRef);
+    test_assert(ptr != NULL);
+    test_assert(ptr->self == ptr);
+    test_int(ptr->value, 20);
+
+    ptr = ecs_get(world, e3, SelfRef);
+    test_assert(ptr != NULL);
+    test_assert(ptr->self == ptr);
+    test_int(ptr->value, 30);
+
+    ecs_fini(world);
+}
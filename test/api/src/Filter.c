@@ -6022,3 +6022,597 @@ void Filter_iter_while_creating_components() {
 
     ecs_fini(world);
 }
+
+void Filter_filter_cached() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e_2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e_2, TagA);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Position), .subj.set.mask = EcsSelf }},
+        .cached = true
+    });
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_filter_iter(world, &f);
+
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], e_1);
+        test_int(ecs_term_id(&it, 1), ecs_id(Position));
+        Position *p = ecs_term(&it, Position, 1);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], e_2);
+        test_int(ecs_term_id(&it, 1), ecs_id(Position));
+        p = ecs_term(&it, Position, 1);
+        test_assert(p != NULL);
+        test_int(p->x, 30);
+        test_int(p->y, 40);
+
+        test_bool(ecs_filter_next(&it), false);
+    }
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_after_new_table() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new(world, TagA);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ TagA, .subj.set.mask = EcsSelf }},
+        .cached = true
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_1);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_entity_t e_2 = ecs_new(world, TagA);
+    ecs_add(world, e_2, TagB);
+
+    it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_1);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_2);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_after_delete_table() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new(world, TagA);
+    ecs_entity_t e_2 = ecs_new(world, TagA);
+    ecs_add(world, e_2, TagB);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ TagA, .subj.set.mask = EcsSelf }},
+        .cached = true
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.entities[0], e_1);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.entities[0], e_2);
+    test_bool(ecs_filter_next(&it), false);
+
+    /* Deletes table with TagB */
+    ecs_delete(world, TagB);
+
+    it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e_1);
+    test_int(it.entities[1], e_2);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_skip_empty_table() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new(world, TagA);
+    ecs_entity_t e_2 = ecs_new(world, TagA);
+    ecs_add(world, e_2, TagB);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ TagA, .subj.set.mask = EcsSelf }},
+        .cached = true
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.entities[0], e_1);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.entities[0], e_2);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_remove(world, e_2, TagB);
+
+    it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e_1);
+    test_int(it.entities[1], e_2);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_w_not() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new(world, TagA);
+    ecs_entity_t e_2 = ecs_new(world, TagA);
+    ecs_add(world, e_2, TagB);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {
+            { TagA, .subj.set.mask = EcsSelf },
+            { TagB, .subj.set.mask = EcsSelf, .oper = EcsNot }
+        },
+        .cached = true
+    });
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_filter_iter(world, &f);
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], e_1);
+        test_bool(ecs_filter_next(&it), false);
+    }
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_w_wildcard() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Rel);
+    ECS_TAG(world, ObjA);
+    ECS_TAG(world, ObjB);
+
+    ecs_entity_t e_1 = ecs_new_w_pair(world, Rel, ObjA);
+    ecs_add_pair(world, e_1, Rel, ObjB);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_pair(Rel, EcsWildcard), .subj.set.mask = EcsSelf }},
+        .cached = true
+    });
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_filter_iter(world, &f);
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], e_1);
+        test_int(ecs_term_id(&it, 1), ecs_pair(Rel, ObjA));
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], e_1);
+        test_int(ecs_term_id(&it, 1), ecs_pair(Rel, ObjB));
+        test_bool(ecs_filter_next(&it), false);
+    }
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_w_superset() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+
+    ecs_entity_t base = ecs_new(world, TagA);
+    ecs_entity_t e_1 = ecs_new_w_pair(world, EcsIsA, base);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ TagA }},
+        .cached = true
+    });
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_filter_iter(world, &f);
+        test_int(it.priv.iter.filter.kind, EcsIterEvalCache);
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], base);
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], e_1);
+        test_int(ecs_term_source(&it, 1), base);
+        test_bool(ecs_filter_next(&it), false);
+    }
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_default_term() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e_1 = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Position) }},
+        .cached = true
+    });
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_filter_iter(world, &f);
+        test_int(it.priv.iter.filter.kind, EcsIterEvalCache);
+        test_bool(ecs_filter_next(&it), true);
+        test_int(it.count, 1);
+        test_int(it.entities[0], e_1);
+        Position *p = ecs_term(&it, Position, 1);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+        test_bool(ecs_filter_next(&it), false);
+    }
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_w_superset_after_base_change() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+
+    ecs_new(world, TagA);
+    ecs_entity_t base = ecs_new_id(world);
+    ecs_entity_t e_1 = ecs_new_w_pair(world, EcsIsA, base);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ TagA, .subj.set.mask = EcsSuperSet }},
+        .cached = true
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_int(it.priv.iter.filter.kind, EcsIterEvalCache);
+    test_bool(ecs_filter_next(&it), false);
+
+    /* Base moves to existing table, which doesn't create or delete tables */
+    ecs_add(world, base, TagA);
+
+    it = ecs_filter_iter(world, &f);
+    test_int(it.priv.iter.filter.kind, EcsIterEvalCache);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_1);
+    test_int(ecs_term_source(&it, 1), base);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_remove(world, base, TagA);
+
+    it = ecs_filter_iter(world, &f);
+    test_int(it.priv.iter.filter.kind, EcsIterEvalCache);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_w_fixed_subject() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new(world, TagA);
+    ecs_entity_t e_2 = ecs_new(world, TagB);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {
+            { TagB },
+            { TagA, .subj.entity = e_1 }
+        },
+        .cached = true
+    });
+
+    /* Result depends on entity that's not in matched table, iterator should
+     * ignore the cache */
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_assert(it.priv.iter.filter.kind != EcsIterEvalCache);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_2);
+    test_int(ecs_term_source(&it, 2), e_1);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_remove(world, e_1, TagA);
+
+    it = ecs_filter_iter(world, &f);
+    test_assert(it.priv.iter.filter.kind != EcsIterEvalCache);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_cached_evict() {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_entity_t tags[80];
+    ecs_filter_t filters[80];
+
+    int i, j;
+    for (i = 0; i < 80; i ++) {
+        tags[i] = ecs_new_id(world);
+        ecs_add_id(world, ecs_new_id(world), tags[i]);
+        ecs_filter_init(world, &filters[i], &(ecs_filter_desc_t) {
+            .terms = {{ tags[i], .subj.set.mask = EcsSelf }},
+            .cached = true
+        });
+    }
+
+    /* More filters than the cache can store, elements will be evicted */
+    for (j = 0; j < 2; j ++) {
+        for (i = 0; i < 80; i ++) {
+            ecs_iter_t it = ecs_filter_iter(world, &filters[i]);
+            test_bool(ecs_filter_next(&it), true);
+            test_int(it.count, 1);
+            test_assert(ecs_has_id(world, it.entities[0], tags[i]));
+            test_bool(ecs_filter_next(&it), false);
+        }
+    }
+
+    for (i = 0; i < 80; i ++) {
+        ecs_filter_fini(&filters[i]);
+    }
+
+    ecs_fini(world);
+}
+
+typedef struct {
+    ecs_filter_t *filter;
+    int32_t count;
+    bool cached;
+} FilterFromSystemCtx;
+
+static
+void IterCachedFilter(ecs_iter_t *it) {
+    FilterFromSystemCtx *ctx = it->ctx;
+    ctx->count = 0;
+
+    ecs_iter_t fit = ecs_filter_iter(it->world, ctx->filter);
+    ctx->cached = fit.priv.iter.filter.cache_elem != NULL;
+    while (ecs_filter_next(&fit)) {
+        ctx->count += fit.count;
+    }
+}
+
+void Filter_filter_cached_from_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_new(world, TagA);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ TagA, .subj.set.mask = EcsSelf }},
+        .cached = true
+    });
+
+    FilterFromSystemCtx ctx = { .filter = &f };
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity = { .add = { EcsOnUpdate } },
+        .callback = IterCachedFilter,
+        .ctx = &ctx
+    });
+
+    /* Cache element is added while the world is readonly */
+    ecs_progress(world, 0);
+    test_bool(ctx.cached, true);
+    test_int(ctx.count, 1);
+
+    /* Cache element is refilled after a table is created between frames */
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+
+    ecs_progress(world, 0);
+    test_bool(ctx.cached, true);
+    test_int(ctx.count, 2);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_match_empty_tables_w_no_empty_tables() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e_1 = ecs_new(world, TagA);
+    ecs_entity_t e_2 = ecs_new(world, TagA);
+    ecs_add(world, e_2, TagB);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ TagA }},
+        .match_empty_tables = true
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_1);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e_2);
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_iter_superset_closure_index() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+
+    test_bool(ecs_enable_closure_index(world, EcsIsA, true), false);
+
+    ecs_entity_t base = ecs_new(world, TagA);
+    ecs_entity_t p_1 = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_entity_t p_2 = ecs_new_w_pair(world, EcsIsA, p_1);
+    ecs_entity_t e = ecs_new_w_pair(world, EcsIsA, p_2);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {
+            { TagA, .subj.set = {.mask = EcsSuperSet} }
+        }
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_assert(ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], p_1);
+    test_int(ecs_term_source(&it, 1), base);
+    test_assert(ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], p_2);
+    test_int(ecs_term_source(&it, 1), base);
+    test_assert(ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e);
+    test_int(ecs_term_source(&it, 1), base);
+    test_assert(!ecs_filter_next(&it));
+
+    /* Closest base with component should be the new source */
+    ecs_add(world, p_1, TagA);
+
+    int32_t count = 0;
+    it = ecs_filter_iter(world, &f);
+    while (ecs_filter_next(&it)) {
+        test_int(it.count, 1);
+        if (it.entities[0] == p_1) {
+            test_int(ecs_term_source(&it, 1), base);
+        } else {
+            test_assert(it.entities[0] == p_2 || it.entities[0] == e);
+            test_int(ecs_term_source(&it, 1), p_1);
+        }
+        count ++;
+    }
+    test_int(count, 3);
+
+    /* Removing the IsA relation must remove the base from the index */
+    ecs_remove_pair(world, p_2, EcsIsA, p_1);
+
+    it = ecs_filter_iter(world, &f);
+    test_assert(ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], p_1);
+    test_int(ecs_term_source(&it, 1), base);
+    test_assert(!ecs_filter_next(&it));
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_iter_superset_closure_index_depth() {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+
+    test_bool(ecs_enable_closure_index(world, EcsChildOf, true), false);
+
+    ecs_entity_t root = ecs_new(world, TagA);
+    ecs_entity_t c_1 = ecs_new_w_pair(world, EcsChildOf, root);
+    ecs_entity_t c_2 = ecs_new_w_pair(world, EcsChildOf, c_1);
+    ecs_new_w_pair(world, EcsChildOf, c_2);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {
+            { TagA, .subj.set = {
+                .mask = EcsSuperSet, 
+                .relation = EcsChildOf, 
+                .min_depth = 2, 
+                .max_depth = 2
+            }}
+        }
+    });
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_assert(ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], c_2);
+    test_int(ecs_term_source(&it, 1), root);
+    test_assert(!ecs_filter_next(&it));
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
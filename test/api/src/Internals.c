@@ -261,3 +261,60 @@ void Internals_override_os_api_w_addon() {
     ecs_world_t *world = ecs_init();
     ecs_fini(world);
 }
+
+void Internals_delete_table_w_low_edges() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_COMPONENT(world, Rotation);
+    ECS_TAG(world, Tag);
+
+    /* Adding Velocity also adds Tag, so that deleting Tag deletes the tables
+     * that low edges for Velocity point to */
+    ecs_add_pair(world, ecs_id(Velocity), EcsWith, Tag);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_add(world, e1, Mass);
+    ecs_add(world, e1, Velocity);
+    test_assert(ecs_has(world, e1, Tag));
+
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_add(world, e2, Velocity);
+    ecs_add(world, e2, Rotation);
+    ecs_remove(world, e2, Position);
+    test_assert(ecs_has(world, e2, Tag));
+
+    ecs_delete(world, Tag);
+
+    test_assert(ecs_has(world, e1, Position));
+    test_assert(ecs_has(world, e1, Mass));
+    test_assert(ecs_has(world, e1, Velocity));
+    test_assert(ecs_has(world, e2, Velocity));
+    test_assert(ecs_has(world, e2, Rotation));
+    test_assert(!ecs_has(world, e2, Position));
+
+    /* Traverse edges from tables that had edges to the deleted tables */
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e3, Mass);
+    ecs_add(world, e3, Velocity);
+    ecs_add(world, e3, Rotation);
+    test_assert(ecs_has(world, e3, Position));
+    test_assert(ecs_has(world, e3, Mass));
+    test_assert(ecs_has(world, e3, Velocity));
+    test_assert(ecs_has(world, e3, Rotation));
+    test_int(ecs_vector_count(ecs_get_type(world, e3)), 4);
+
+    ecs_remove(world, e3, Mass);
+    test_assert(ecs_has(world, e3, Position));
+    test_assert(!ecs_has(world, e3, Mass));
+    test_assert(ecs_has(world, e3, Velocity));
+
+    ecs_remove(world, e3, Position);
+    test_assert(!ecs_has(world, e3, Position));
+    test_assert(ecs_has(world, e3, Velocity));
+    test_assert(ecs_has(world, e3, Rotation));
+
+    ecs_fini(world);
+}
@@ -1390,3 +1390,254 @@ void Iter_paged_iter_w_singleton_instanced() {
 
     ecs_fini(world);
 }
+
+void Iter_chunk_iter_1() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Self);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e1 = ecs_new_id(world); ecs_set(world, e1, Self, {e1});
+    ecs_entity_t e2 = ecs_new_id(world); ecs_set(world, e2, Self, {e2});
+    ecs_entity_t e3 = ecs_new_id(world); ecs_set(world, e3, Self, {e3});
+    ecs_entity_t e4 = ecs_new_id(world); ecs_set(world, e4, Self, {e4});
+    ecs_entity_t e5 = ecs_new_id(world); ecs_set(world, e5, Self, {e5});
+
+    ecs_add(world, e3, TagA);
+    ecs_add(world, e4, TagA);
+    ecs_add(world, e5, TagB);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Self) }}
+    });
+
+    int32_t cursor = 0;
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    ecs_iter_t cit = ecs_chunk_iter(&it, &cursor, 2);
+
+    {
+        test_bool(ecs_chunk_next(&cit), true);
+        test_int(cit.count, 2);
+        test_int(cit.entities[0], e1);
+        test_int(cit.entities[1], e2);
+
+        Self *ptr = ecs_term(&cit, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e1);
+        test_int(ptr[1].value, e2);
+    }
+
+    {
+        test_bool(ecs_chunk_next(&cit), true);
+        test_int(cit.count, 2);
+        test_int(cit.entities[0], e3);
+        test_int(cit.entities[1], e4);
+
+        Self *ptr = ecs_term(&cit, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e3);
+        test_int(ptr[1].value, e4);
+    }
+
+    {
+        test_bool(ecs_chunk_next(&cit), true);
+        test_int(cit.count, 1);
+        test_int(cit.entities[0], e5);
+
+        Self *ptr = ecs_term(&cit, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e5);
+    }
+
+    test_bool(ecs_chunk_next(&cit), false);
+
+    ecs_fini(world);
+}
+
+void Iter_chunk_iter_2() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Self);
+    ECS_TAG(world, TagA);
+
+    ecs_entity_t e1 = ecs_new_id(world); ecs_set(world, e1, Self, {e1});
+    ecs_entity_t e2 = ecs_new_id(world); ecs_set(world, e2, Self, {e2});
+    ecs_entity_t e3 = ecs_new_id(world); ecs_set(world, e3, Self, {e3});
+    ecs_entity_t e4 = ecs_new_id(world); ecs_set(world, e4, Self, {e4});
+    ecs_entity_t e5 = ecs_new_id(world); ecs_set(world, e5, Self, {e5});
+
+    ecs_add(world, e5, TagA);
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Self) }}
+    });
+
+    int32_t cursor = 0;
+    ecs_iter_t it_1 = ecs_filter_iter(world, &f);
+    ecs_iter_t cit_1 = ecs_chunk_iter(&it_1, &cursor, 3);
+    ecs_iter_t it_2 = ecs_filter_iter(world, &f);
+    ecs_iter_t cit_2 = ecs_chunk_iter(&it_2, &cursor, 3);
+
+    {
+        test_bool(ecs_chunk_next(&cit_1), true);
+        test_int(cit_1.count, 3);
+        test_int(cit_1.entities[0], e1);
+        test_int(cit_1.entities[1], e2);
+        test_int(cit_1.entities[2], e3);
+
+        Self *ptr = ecs_term(&cit_1, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e1);
+        test_int(ptr[2].value, e3);
+    }
+
+    {
+        test_bool(ecs_chunk_next(&cit_2), true);
+        test_int(cit_2.count, 1);
+        test_int(cit_2.entities[0], e4);
+
+        Self *ptr = ecs_term(&cit_2, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e4);
+    }
+
+    {
+        test_bool(ecs_chunk_next(&cit_1), true);
+        test_int(cit_1.count, 1);
+        test_int(cit_1.entities[0], e5);
+
+        Self *ptr = ecs_term(&cit_1, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e5);
+    }
+
+    test_bool(ecs_chunk_next(&cit_2), false);
+    test_bool(ecs_chunk_next(&cit_1), false);
+
+    ecs_fini(world);
+}
+
+void Iter_chunk_iter_w_task_query() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Self);
+
+    ecs_entity_t foo = ecs_new_id(world); ecs_set(world, foo, Self, {foo});
+
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Self), .subj.entity = foo }}
+    });
+
+    int32_t cursor = 0;
+    ecs_iter_t it_1 = ecs_filter_iter(world, &f);
+    ecs_iter_t cit_1 = ecs_chunk_iter(&it_1, &cursor, 2);
+    ecs_iter_t it_2 = ecs_filter_iter(world, &f);
+    ecs_iter_t cit_2 = ecs_chunk_iter(&it_2, &cursor, 2);
+
+    {
+        test_bool(ecs_chunk_next(&cit_1), true);
+        test_int(cit_1.count, 0);
+        test_int(cit_1.ids[0], ecs_id(Self));
+        test_int(cit_1.subjects[0], foo);
+
+        Self *ptr = ecs_term(&cit_1, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, foo);
+    }
+
+    test_bool(ecs_chunk_next(&cit_2), false);
+    test_bool(ecs_chunk_next(&cit_1), false);
+
+    ecs_fini(world);
+}
+
+void Iter_chunk_iter_fini_before_end() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_COMPONENT(world, Rotation);
+    ECS_COMPONENT(world, Color);
+
+    int32_t i;
+    for (i = 0; i < 4; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {i, i});
+        ecs_set(world, e, Velocity, {1, 1});
+        ecs_set(world, e, Mass, {1});
+        ecs_set(world, e, Rotation, {1});
+        ecs_set(world, e, Color, {1, 1, 1, 1});
+    }
+
+    /* More terms than fit in the iterator cache, so that the chunk iterator
+     * allocates storage for the term data */
+    ecs_filter_t f;
+    ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {
+            { ecs_id(Position) }, { ecs_id(Velocity) }, { ecs_id(Mass) },
+            { ecs_id(Rotation) }, { ecs_id(Color) }
+        }
+    });
+
+    int32_t cursor = 0;
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    ecs_iter_t cit = ecs_chunk_iter(&it, &cursor, 2);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 2);
+
+    Position *p = ecs_term(&cit, Position, 1);
+    test_assert(p != NULL);
+    test_int(p[0].x, 0);
+    test_int(p[1].x, 1);
+
+    ecs_iter_fini(&cit);
+    test_assert(cit.priv.iter.chunk.ptrs == NULL);
+    test_bool(it.is_valid, false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void Iter_term_is_aligned() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Mass);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t base = ecs_set(world, 0, Mass, {10});
+    
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {i, i});
+        ecs_add_pair(world, e, EcsIsA, base);
+        if (i > 5) {
+            ecs_add(world, e, Tag);
+        }
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position, Mass(super)",
+        .filter.instanced = true
+    });
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    int32_t count = 0;
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_term(&it, Position, 1);
+        test_assert(ecs_term_is_aligned(&it, 1));
+        test_assert(((uintptr_t)p % ECS_COLUMN_ALIGNMENT) == 0);
+        test_assert(!ecs_term_is_aligned(&it, 2));
+        count += it.count;
+    }
+
+    test_int(count, 10);
+
+    ecs_fini(world);
+}
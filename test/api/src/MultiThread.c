@@ -1086,3 +1086,599 @@ void MultiThread_2_threads_single_threaded_system() {
 
     ecs_fini(world);
 }
+
+static
+void test_chunked_100_entity(int THREADS, int CHUNK_SIZE) {
+    ecs_world_t *world = init_world();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t system = ecs_lookup(world, "Progress");
+    test_assert(system != 0);
+
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = system,
+        .chunk_size = CHUNK_SIZE
+    });
+
+    int i, ENTITIES = 100;
+    ecs_entity_t handles[100];
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+
+        /* Spread entities across tables of different sizes */
+        if ((i % 3) == 1) {
+            ecs_add(world, handles[i], TagA);
+        } else if ((i % 7) == 2) {
+            ecs_add(world, handles[i], TagB);
+        }
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 1);
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 2);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_2_thread_chunked_100_entity() {
+    test_chunked_100_entity(2, 8);
+}
+
+void MultiThread_6_thread_chunked_100_entity() {
+    test_chunked_100_entity(6, 8);
+}
+
+void MultiThread_6_thread_chunked_1_entity_chunks() {
+    test_chunked_100_entity(6, 1);
+}
+
+static
+void StoreStage(ecs_iter_t *it) {
+    Position *pos = ecs_term(it, Position, 1);
+    int32_t stage_id = ecs_get_stage_id(it->world);
+    int row;
+    for (row = 0; row < it->count; row ++) {
+        pos[row].x = stage_id;
+        pos[row].y ++;
+    }
+}
+
+void MultiThread_chunked_table_lt_chunk_size() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ECS_SYSTEM(world, StoreStage, EcsOnUpdate, Position);
+
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = StoreStage,
+        .multi_threaded = true,
+        .chunk_size = 16
+    });
+
+    int i, ENTITIES = 10, THREADS = 4;
+    ecs_entity_t handles_a[10], handles_b[10];
+
+    for (i = 0; i < ENTITIES; i ++) {
+        handles_a[i] = ecs_set(world, 0, Position, {0});
+        ecs_add(world, handles_a[i], TagA);
+        handles_b[i] = ecs_set(world, 0, Position, {0});
+        ecs_add(world, handles_b[i], TagB);
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_progress(world, 0);
+
+    /* Tables are smaller than the chunk size, so each table should have been
+     * iterated by a single thread */
+    float stage_a = ecs_get(world, handles_a[0], Position)->x;
+    float stage_b = ecs_get(world, handles_b[0], Position)->x;
+
+    for (i = 0; i < ENTITIES; i ++) {
+        const Position *p = ecs_get(world, handles_a[i], Position);
+        test_int(p->x, stage_a);
+        test_int(p->y, 1);
+
+        p = ecs_get(world, handles_b[i], Position);
+        test_int(p->x, stage_b);
+        test_int(p->y, 1);
+    }
+
+    ecs_fini(world);
+}
+
+static
+void ChunkAction(ecs_iter_t *it) { }
+
+/* Claims a single chunk and stops */
+static
+void RunFirstChunk(ecs_iter_t *it) {
+    if (ecs_iter_next(it)) {
+        Position *p = ecs_term(it, Position, 1);
+        int i;
+        for (i = 0; i < it->count; i ++) {
+            p[i].x ++;
+        }
+    }
+
+    ecs_iter_fini(it);
+}
+
+void MultiThread_chunked_run_stop_early() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity = { .name = "RunFirstChunk", .add = {EcsOnUpdate} },
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .run = RunFirstChunk,
+        .callback = ChunkAction,
+        .multi_threaded = true,
+        .chunk_size = 30
+    });
+
+    int i, ENTITIES = 100, THREADS = 4;
+    ecs_entity_t handles[100];
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+    }
+
+    ecs_set_threads(world, THREADS);
+
+    /* Each thread claims one of the four chunks. Claimed chunks are reset at
+     * the sync point, so every frame visits all entities once. */
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 1);
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 2);
+    }
+
+    ecs_fini(world);
+}
+
+static
+uint64_t group_by_object(
+    ecs_world_t *world,
+    ecs_type_t type,
+    ecs_id_t id,
+    void *ctx)
+{
+    ecs_id_t *ids = ecs_vector_first(type, ecs_id_t);
+    int32_t i, count = ecs_vector_count(type);
+    for (i = 0; i < count; i ++) {
+        if (ECS_HAS_RELATION(ids[i], id)) {
+            return ECS_PAIR_SECOND(ids[i]);
+        }
+    }
+
+    return 0;
+}
+
+void MultiThread_partition_groups() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, Cell);
+    ECS_TAG(world, CellA);
+    ECS_TAG(world, CellB);
+    ECS_TAG(world, CellC);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t system = ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.add = {EcsOnUpdate},
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .query.group_by = group_by_object,
+        .query.group_by_id = Cell,
+        .callback = StoreStage,
+        .multi_threaded = true,
+        .partition_groups = true
+    });
+    test_assert(system != 0);
+
+    int i, ENTITIES = 10, THREADS = 3;
+    ecs_entity_t cells[] = {CellA, CellB, CellC};
+    ecs_entity_t handles[3][10];
+
+    for (i = 0; i < ENTITIES; i ++) {
+        int c;
+        for (c = 0; c < 3; c ++) {
+            ecs_entity_t e = handles[c][i] = ecs_set(world, 0, Position, {0});
+            ecs_add_pair(world, e, Cell, cells[c]);
+
+            /* Spread group across multiple tables */
+            if (i % 2) {
+                ecs_add(world, e, Tag);
+            }
+        }
+    }
+
+    ecs_set_threads(world, THREADS);
+    ecs_progress(world, 0);
+
+    /* Each group should have been iterated by a single thread, in order */
+    for (i = 0; i < ENTITIES; i ++) {
+        int c;
+        for (c = 0; c < 3; c ++) {
+            const Position *p = ecs_get(world, handles[c][i], Position);
+            test_int(p->x, c);
+            test_int(p->y, 1);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+static
+void MoveX(ecs_iter_t *it) {
+    Position *p = ecs_term(it, Position, 1);
+    int32_t *stage_out = it->ctx;
+    *stage_out = ecs_get_stage_id(it->world);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+void MoveY(ecs_iter_t *it) {
+    Velocity *v = ecs_term(it, Velocity, 1);
+    int32_t *stage_out = it->ctx;
+    *stage_out = ecs_get_stage_id(it->world);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        v[i].y ++;
+    }
+}
+
+static
+void ReadX(ecs_iter_t *it) {
+    Position *p = ecs_term(it, Position, 1);
+    Mass *m = ecs_term(it, Mass, 2);
+    int32_t *stage_out = it->ctx;
+    *stage_out = ecs_get_stage_id(it->world);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        m[i] = p[i].x;
+    }
+}
+
+void MultiThread_concurrent_systems_no_conflict() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    int32_t stage_x = -1, stage_y = -1;
+
+    ECS_SYSTEM(world, MoveX, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, MoveY, EcsOnUpdate, Velocity);
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveX, .ctx = &stage_x
+    });
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveY, .ctx = &stage_y
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {0, 0});
+
+    ecs_set_threads(world, 2);
+    ecs_set_concurrent_systems(world, true);
+
+    ecs_progress(world, 0);
+
+    test_int(stage_x, 0);
+    test_int(stage_y, 1);
+    test_int(ecs_get(world, e1, Position)->x, 1);
+    test_int(ecs_get(world, e2, Velocity)->y, 1);
+
+    ecs_progress(world, 0);
+
+    test_int(stage_x, 0);
+    test_int(stage_y, 1);
+    test_int(ecs_get(world, e1, Position)->x, 2);
+    test_int(ecs_get(world, e2, Velocity)->y, 2);
+
+    ecs_fini(world);
+}
+
+void MultiThread_concurrent_systems_w_conflict() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    int32_t stage_x = -1, stage_y = -1, stage_read = -1;
+
+    ECS_SYSTEM(world, MoveX, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, MoveY, EcsOnUpdate, Velocity);
+    ECS_SYSTEM(world, ReadX, EcsOnUpdate, [in] Position, [out] Mass);
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveX, .ctx = &stage_x
+    });
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveY, .ctx = &stage_y
+    });
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = ReadX, .ctx = &stage_read
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, e1, Mass, {0});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {0, 0});
+
+    ecs_set_threads(world, 3);
+    ecs_set_concurrent_systems(world, true);
+
+    ecs_progress(world, 0);
+
+    /* ReadX reads Position, so it must run after MoveX on the same thread */
+    test_int(stage_x, 0);
+    test_int(stage_y, 1);
+    test_int(stage_read, 0);
+    test_int(ecs_get(world, e1, Position)->x, 1);
+    test_int(*ecs_get(world, e1, Mass), 1);
+    test_int(ecs_get(world, e2, Velocity)->y, 1);
+
+    ecs_fini(world);
+}
+
+static
+void WriteMass(ecs_iter_t *it) {
+    Mass *m = ecs_term(it, Mass, 1);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        m[i] ++;
+    }
+}
+
+void MultiThread_concurrent_systems_two_pipelines() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+
+    int32_t stage_x = -1, stage_y = -1;
+
+    ECS_SYSTEM(world, WriteMass, EcsPreUpdate, Mass);
+    ECS_SYSTEM(world, MoveX, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, MoveY, EcsOnUpdate, Velocity);
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveX, .ctx = &stage_x
+    });
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveY, .ctx = &stage_y
+    });
+
+    ECS_PIPELINE(world, P1, flecs.pipeline.OnUpdate);
+    ECS_PIPELINE(world, P2, flecs.pipeline.PreUpdate, flecs.pipeline.OnUpdate);
+
+    ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, 0, Velocity, {0, 0});
+    ecs_set(world, 0, Mass, {0});
+
+    ecs_set_threads(world, 2);
+    ecs_set_concurrent_systems(world, true);
+
+    /* In P2 MoveX is in the second group, in P1 it is in the first group */
+    ecs_set_pipeline(world, P2);
+    ecs_progress(world, 0);
+    test_int(stage_x, 1);
+    test_int(stage_y, 0);
+
+    ecs_set_pipeline(world, P1);
+    ecs_progress(world, 0);
+    test_int(stage_x, 0);
+    test_int(stage_y, 1);
+
+    /* Building P1 must not change the groups of P2 */
+    ecs_set_pipeline(world, P2);
+    ecs_progress(world, 0);
+    test_int(stage_x, 1);
+    test_int(stage_y, 0);
+
+    ecs_fini(world);
+}
+
+void MultiThread_concurrent_systems_disabled() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    int32_t stage_x = -1, stage_y = -1;
+
+    ECS_SYSTEM(world, MoveX, EcsOnUpdate, Position);
+    ECS_SYSTEM(world, MoveY, EcsOnUpdate, Velocity);
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveX, .ctx = &stage_x
+    });
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity.entity = MoveY, .ctx = &stage_y
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {0, 0});
+
+    ecs_set_threads(world, 2);
+
+    ecs_progress(world, 0);
+
+    test_int(stage_x, 0);
+    test_int(stage_y, 0);
+    test_int(ecs_get(world, e1, Position)->x, 1);
+    test_int(ecs_get(world, e2, Velocity)->y, 1);
+
+    ecs_fini(world);
+}
+
+static
+void IncX(ecs_iter_t *it) {
+    Position *p = ecs_term(it, Position, 1);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+static
+void CopyX(ecs_iter_t *it) {
+    Position *p = ecs_term(it, Position, 1);
+    Velocity *v = ecs_term(it, Velocity, 2);
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        v[i].x = p[i].x;
+    }
+}
+
+void MultiThread_jobs_system_order() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity = { .name = "IncX", .add = {EcsOnUpdate} },
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = IncX,
+        .multi_threaded = true
+    });
+
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity = { .name = "CopyX", .add = {EcsOnUpdate} },
+        .query.filter.terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }},
+        .callback = CopyX,
+        .multi_threaded = true
+    });
+
+    int i, ENTITIES = 1000, THREADS = 4;
+    ecs_entity_t handles[1000];
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+        ecs_set(world, handles[i], Velocity, {0});
+        if (i % 3) {
+            ecs_add(world, handles[i], Tag);
+        }
+    }
+
+    ecs_set_threads(world, THREADS);
+
+    /* Both systems are in the same op. Jobs run the systems of an op in order
+     * for the same slice of entities, so CopyX always sees the value that was
+     * written by IncX in the same frame. */
+    int f;
+    for (f = 1; f <= 10; f ++) {
+        ecs_progress(world, 0);
+
+        for (i = 0; i < ENTITIES; i ++) {
+            test_int(ecs_get(world, handles[i], Position)->x, f);
+            test_int(ecs_get(world, handles[i], Velocity)->x, f);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+static ecs_entity_t blocking_entity;
+static int32_t blocked_processed;
+
+/* The job that processes blocking_entity waits until all entities have been
+ * processed, which requires the other workers to steal the remaining jobs from
+ * the queue of the blocked worker. */
+static
+void BlockJob(ecs_iter_t *it) {
+    Position *p = ecs_term(it, Position, 1);
+    bool block = false;
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x = ecs_get_stage_id(it->world);
+        p[i].y ++;
+        if (it->entities[i] == blocking_entity) {
+            block = true;
+        }
+        ecs_os_ainc(&blocked_processed);
+    }
+
+    if (block) {
+        int32_t *ctx = it->ctx;
+        int t;
+        for (t = 0; t < 5000; t ++) {
+            if (*(volatile int32_t*)&blocked_processed >= *ctx) {
+                break;
+            }
+            ecs_os_sleep(0, 1000 * 1000);
+        }
+    }
+}
+
+void MultiThread_jobs_steal() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+
+    int32_t i, ENTITIES = 100, THREADS = 4;
+
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity = { .name = "BlockJob", .add = {EcsOnUpdate} },
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .callback = BlockJob,
+        .ctx = &ENTITIES,
+        .multi_threaded = true
+    });
+
+    ecs_entity_t handles[100];
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0});
+    }
+
+    blocking_entity = handles[0];
+    blocked_processed = 0;
+
+    ecs_set_threads(world, THREADS);
+    ecs_progress(world, 0);
+
+    /* Each entity is processed once. The job that blocked does not keep the
+     * other jobs in the queue of its worker from running. */
+    int32_t stages = 0;
+    for (i = 0; i < ENTITIES; i ++) {
+        const Position *p = ecs_get(world, handles[i], Position);
+        test_int(p->y, 1);
+        stages |= 1 << (int32_t)p->x;
+    }
+
+    /* More than one worker processed entities */
+    test_assert(stages != 1 && stages != 2 && stages != 4 && stages != 8);
+
+    ecs_fini(world);
+}
@@ -499,3 +499,191 @@ void MultiThreadStaging_custom_thread_partial_manual_merge() {
 
     ecs_fini(world);
 }
+
+void MultiThreadStaging_custom_thread_merge_by_entity() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    Probe ctx = {0};
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{TagA}},
+        .events = {EcsOnAdd},
+        .callback = probe_iter,
+        .ctx = &ctx
+    });
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{TagB}},
+        .events = {EcsOnAdd},
+        .callback = probe_iter,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_set_merge_by_entity(world, true);
+    ecs_set_stages(world, 2);
+
+    ecs_world_t *ctx_1 = ecs_get_stage(world, 0);
+    ecs_world_t *ctx_2 = ecs_get_stage(world, 1);
+
+    ecs_frame_begin(world, 0);
+    ecs_staging_begin(world);
+
+    /* thread 1 */
+    ecs_defer_begin(ctx_1);
+    ecs_add(ctx_1, e2, TagA);
+    ecs_add(ctx_1, e1, TagA);
+    ecs_defer_end(ctx_1);
+
+    /* thread 2 */
+    ecs_defer_begin(ctx_2);
+    ecs_add(ctx_2, e1, TagB);
+    ecs_set(ctx_2, e2, Position, {10, 20});
+    ecs_defer_end(ctx_2);
+
+    test_int(ctx.invoked, 0);
+
+    ecs_staging_end(world);
+    ecs_frame_end(world);
+
+    /* Commands are applied in entity order, and commands for the same entity
+     * are applied in stage order */
+    test_int(ctx.invoked, 3);
+    test_int(ctx.e[0], e1);
+    test_int(ctx.c[0][0], TagA);
+    test_int(ctx.e[1], e1);
+    test_int(ctx.c[1][0], TagB);
+    test_int(ctx.e[2], e2);
+    test_int(ctx.c[2][0], TagA);
+
+    test_assert(ecs_has(world, e1, TagA));
+    test_assert(ecs_has(world, e1, TagB));
+    test_assert(ecs_has(world, e2, TagA));
+
+    const Position *p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void MultiThreadStaging_custom_thread_merge_by_entity_w_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+
+    Probe ctx = {0};
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{TagA}},
+        .events = {EcsOnAdd},
+        .callback = probe_iter,
+        .ctx = &ctx
+    });
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_set_merge_by_entity(world, true);
+    ecs_set_stages(world, 2);
+
+    ecs_world_t *ctx_1 = ecs_get_stage(world, 0);
+    ecs_world_t *ctx_2 = ecs_get_stage(world, 1);
+
+    ecs_frame_begin(world, 0);
+    ecs_staging_begin(world);
+
+    /* thread 1 */
+    ecs_defer_begin(ctx_1);
+    ecs_add(ctx_1, e2, TagA);
+    ecs_defer_end(ctx_1);
+
+    /* thread 2 */
+    ecs_defer_begin(ctx_2);
+    ecs_add(ctx_2, e1, TagA);
+    ecs_delete(ctx_2, e3);
+    ecs_defer_end(ctx_2);
+
+    ecs_staging_end(world);
+    ecs_frame_end(world);
+
+    /* Delete can't be reordered, stages are merged in stage order */
+    test_int(ctx.invoked, 2);
+    test_int(ctx.e[0], e2);
+    test_int(ctx.e[1], e1);
+
+    test_assert(ecs_has(world, e1, TagA));
+    test_assert(ecs_has(world, e2, TagA));
+    test_assert(!ecs_is_alive(world, e3));
+
+    ecs_fini(world);
+}
+
+static
+void Add_tag_set_velocity(ecs_iter_t *it) {
+    IterData *ctx = it->ctx;
+
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_add_id(it->world, it->entities[i], ctx->component);
+        ecs_set_id(it->world, it->entities[i], ctx->component_2, 
+            sizeof(Velocity), &(Velocity){i, 1});
+    }
+}
+
+void MultiThreadStaging_4_threads_merge_by_entity() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_COMPONENT(world, Mass);
+    ECS_TAG(world, TagA);
+
+    IterData sys_ctx = {.component = TagA, .component_2 = ecs_id(Velocity)};
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity = {.name = "Add_tag_set_velocity", .add = {EcsOnUpdate}},
+        .query.filter.expr = "Position",
+        .callback = Add_tag_set_velocity,
+        .ctx = &sys_ctx,
+        .multi_threaded = true
+    });
+
+    Probe ctx = {0};
+    ecs_observer_init(world, &(ecs_observer_desc_t){
+        .filter.terms = {{TagA}},
+        .events = {EcsOnAdd},
+        .callback = probe_iter,
+        .ctx = &ctx
+    });
+
+    /* Alternate entities between tables, so that each stage enqueues commands
+     * for entities that are not adjacent */
+    ecs_entity_t entities[100];
+    int i;
+    for (i = 0; i < 100; i ++) {
+        entities[i] = ecs_new(world, Position);
+        if (i % 2) {
+            ecs_set(world, entities[i], Mass, {1});
+        }
+    }
+
+    ecs_set_merge_by_entity(world, true);
+    ecs_set_threads(world, 4);
+
+    ecs_progress(world, 1);
+
+    test_int(ctx.invoked, 100);
+    test_int(ctx.count, 100);
+    for (i = 0; i < 100; i ++) {
+        test_int(ctx.e[i], entities[i]);
+        test_assert(ecs_has(world, entities[i], TagA));
+        test_assert(ecs_has(world, entities[i], Velocity));
+    }
+
+    ecs_fini(world);
+}
@@ -1817,6 +1817,291 @@ void Query_group_by_w_sort_reverse_group_creation() {
     ecs_fini(world);
 }
 
+void Query_group_by_set_group() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagX);
+    ECS_TAG(world, TagY);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{TagX}},
+        .group_by = group_by_first_id
+    });
+
+    ecs_entity_t e1 = ecs_new(world, TagX);
+    ecs_entity_t e2 = ecs_new(world, TagX);
+    ecs_entity_t e3 = ecs_new(world, TagX);
+    ecs_entity_t e4 = ecs_new(world, TagX);
+
+    ecs_add_id(world, e1, TagC);
+    ecs_add_id(world, e2, TagB);
+    ecs_add_id(world, e3, TagA);
+    ecs_add_id(world, e4, TagB);
+    ecs_add_id(world, e4, TagY);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_query_set_group(&it, TagB);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e4);
+
+    test_bool(ecs_query_next(&it), false);
+
+    it = ecs_query_iter(world, q);
+    ecs_query_set_group(&it, TagC);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e1);
+
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Query_group_by_set_group_not_found() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagX);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{TagX}},
+        .group_by = group_by_first_id
+    });
+
+    ecs_entity_t e1 = ecs_new(world, TagX);
+    ecs_add_id(world, e1, TagA);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_query_set_group(&it, TagB);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Query_group_by_set_group_w_sort() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t TagA = ecs_new_id(world);
+    ecs_entity_t TagB = ecs_new_id(world);
+    ecs_entity_t TagC = ecs_new_id(world);
+    ecs_entity_t TagX = ecs_new_id(world);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{TagX}},
+        .order_by = order_by_entity,
+        .group_by = group_by_first_id
+    });
+
+    ecs_entity_t e1 = ecs_new_w_id(world, TagX);
+    ecs_entity_t e2 = ecs_new_w_id(world, TagX);
+    ecs_entity_t e3 = ecs_new_w_id(world, TagX);
+    ecs_entity_t e4 = ecs_new_w_id(world, TagX);
+
+    ecs_add_id(world, e4, TagB);
+    ecs_add_id(world, e1, TagC);
+    ecs_add_id(world, e2, TagB);
+    ecs_add_id(world, e3, TagA);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_query_set_group(&it, TagB);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e2);
+    test_int(it.entities[1], e4);
+
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Query_group_by_worker_iter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagX);
+    ECS_TAG(world, TagY);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{TagX}},
+        .group_by = group_by_first_id
+    });
+
+    ecs_entity_t e1 = ecs_new(world, TagX);
+    ecs_entity_t e2 = ecs_new(world, TagX);
+    ecs_entity_t e3 = ecs_new(world, TagX);
+    ecs_entity_t e4 = ecs_new(world, TagX);
+
+    ecs_add_id(world, e1, TagC);
+    ecs_add_id(world, e2, TagB);
+    ecs_add_id(world, e3, TagA);
+    ecs_add_id(world, e4, TagB);
+    ecs_add_id(world, e4, TagY);
+
+    /* Worker 0 iterates groups TagA and TagC, worker 1 iterates TagB */
+    ecs_iter_t it = ecs_query_group_worker_iter(world, q, 0, 2);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e3);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e1);
+
+    test_bool(ecs_query_next(&it), false);
+
+    it = ecs_query_group_worker_iter(world, q, 1, 2);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e4);
+
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Query_group_by_worker_iter_more_workers_than_groups() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagX);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{TagX}},
+        .group_by = group_by_first_id
+    });
+
+    ecs_entity_t e1 = ecs_new(world, TagX);
+    ecs_entity_t e2 = ecs_new(world, TagX);
+
+    ecs_add_id(world, e1, TagB);
+    ecs_add_id(world, e2, TagA);
+
+    ecs_iter_t it = ecs_query_group_worker_iter(world, q, 0, 3);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+    test_bool(ecs_query_next(&it), false);
+
+    it = ecs_query_group_worker_iter(world, q, 1, 3);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e1);
+    test_bool(ecs_query_next(&it), false);
+
+    it = ecs_query_group_worker_iter(world, q, 2, 3);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Query_group_by_get_group_info() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagX);
+    ECS_TAG(world, TagY);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{TagX}},
+        .group_by = group_by_first_id
+    });
+
+    ecs_bulk_new(world, TagX, 3);
+    ecs_entity_t e1 = ecs_new(world, TagX);
+    ecs_entity_t e2 = ecs_new(world, TagX);
+    ecs_entity_t e3 = ecs_new(world, TagX);
+
+    ecs_add_id(world, e1, TagB);
+    ecs_add_id(world, e2, TagB);
+    ecs_add_id(world, e3, TagB);
+    ecs_add_id(world, e3, TagY);
+
+    ecs_query_group_info_t info;
+    test_bool(ecs_query_get_group_info(q, TagB, &info), true);
+    test_int(info.id, TagB);
+    test_int(info.table_count, 2);
+    test_int(info.entity_count, 3);
+
+    test_bool(ecs_query_get_group_info(q, TagA, &info), false);
+    test_bool(ecs_query_get_group_info(q, TagC, &info), false);
+
+    ecs_fini(world);
+}
+
+void Query_group_by_groups() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagX);
+    ECS_TAG(world, TagY);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{TagX}},
+        .group_by = group_by_first_id
+    });
+
+    test_int(ecs_query_groups(q, NULL, 0), 0);
+
+    ecs_entity_t e1 = ecs_new(world, TagX);
+    ecs_entity_t e2 = ecs_new(world, TagX);
+    ecs_entity_t e3 = ecs_new(world, TagX);
+    ecs_entity_t e4 = ecs_new(world, TagX);
+
+    ecs_add_id(world, e1, TagC);
+    ecs_add_id(world, e2, TagB);
+    ecs_add_id(world, e3, TagA);
+    ecs_add_id(world, e4, TagB);
+    ecs_add_id(world, e4, TagY);
+
+    test_int(ecs_query_groups(q, NULL, 0), 3);
+
+    ecs_query_group_info_t groups[3];
+    test_int(ecs_query_groups(q, groups, 3), 3);
+
+    test_int(groups[0].id, TagA);
+    test_int(groups[0].table_count, 1);
+    test_int(groups[0].entity_count, 1);
+
+    test_int(groups[1].id, TagB);
+    test_int(groups[1].table_count, 2);
+    test_int(groups[1].entity_count, 2);
+
+    test_int(groups[2].id, TagC);
+    test_int(groups[2].table_count, 1);
+    test_int(groups[2].entity_count, 1);
+
+    /* Only first group is written if array is too small */
+    groups[1].id = 0;
+    test_int(ecs_query_groups(q, groups, 1), 3);
+    test_int(groups[0].id, TagA);
+    test_int(groups[1].id, 0);
+
+    ecs_fini(world);
+}
+
 void Query_iter_valid() {
     ecs_world_t *world = ecs_init();
 
@@ -2924,3 +3209,220 @@ void Query_create_query_while_pending() {
     
     ecs_fini(world);
 }
+
+void Query_query_changed_range_after_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[10];
+    for (int i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    /* Changes were not tracked yet, all rows are changed */
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 10);
+    int32_t row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 10);
+    test_int(row, 0);
+    test_bool(ecs_query_next(&it), false);
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 0);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_set(world, e[2], Position, {20, 20});
+    ecs_set(world, e[3], Position, {30, 30});
+    ecs_modified(world, e[7], Position);
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 2);
+    test_int(row, 2);
+    test_int(it.entities[row], e[2]);
+    row += 2;
+    test_int(ecs_query_changed_range(&it, &row), 1);
+    test_int(row, 7);
+    test_int(it.entities[row], e[7]);
+    row += 1;
+    test_int(ecs_query_changed_range(&it, &row), 0);
+    test_bool(ecs_query_next(&it), false);
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 0);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_range_after_new() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {20, 30});
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { 
+        int32_t row = 0;
+        test_int(ecs_query_changed_range(&it, &row), 2);
+    }
+
+    /* Table gained entity, all rows are changed */
+    ecs_set(world, 0, Position, {30, 40});
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 3);
+    int32_t row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 3);
+    test_int(row, 0);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+static
+void SetPositionSys(ecs_iter_t *it) {
+    Position *p = ecs_term(it, Position, 1);
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].x ++;
+    }
+}
+
+void Query_query_changed_range_after_out_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ECS_SYSTEM(world, SetPositionSys, EcsOnUpdate, [out] Position, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 30});
+    ecs_add(world, e2, Tag);
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        int32_t row = 0;
+        test_int(ecs_query_changed_range(&it, &row), 1);
+    }
+
+    ecs_progress(world, 0);
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e1);
+    int32_t row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 0);
+
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+    row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 1);
+    test_int(row, 0);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Query_query_changed_range_after_mt_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_system_init(world, &(ecs_system_desc_t){
+        .entity.add = {EcsOnUpdate},
+        .callback = SetPositionSys,
+        .query.filter.expr = "[out] Position",
+        .multi_threaded = true
+    });
+
+    ecs_entity_t e[20];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    /* Create monitor, then enable row tracking */
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        while (ecs_query_next(&it)) {
+            int32_t row = 0;
+            test_int(ecs_query_changed_range(&it, &row), i ? 0 : 10);
+        }
+    }
+
+    /* Rows aren't marked by worker threads, so all rows should be changed */
+    ecs_set_threads(world, 4);
+    ecs_progress(world, 0);
+    ecs_set(world, e[3], Position, {30, 0});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 10);
+    int32_t row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 10);
+    test_int(row, 0);
+    test_bool(ecs_query_next(&it), false);
+
+    /* Row tracking should resume after the query observed the changes */
+    ecs_set(world, e[5], Position, {50, 0});
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 1);
+    test_int(row, 5);
+    test_bool(ecs_query_next(&it), false);
+
+    /* Rows added after tracking was enabled must have a state before the 
+     * table is iterated by workers */
+    for (i = 10; i < 20; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+    }
+
+    ecs_progress(world, 0);
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 20);
+    row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 20);
+    test_int(row, 0);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_set(world, e[15], Position, {150, 0});
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    row = 0;
+    test_int(ecs_query_changed_range(&it, &row), 1);
+    test_int(row, 15);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
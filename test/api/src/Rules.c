@@ -6254,3 +6254,604 @@ void Rules_rule_w_inout_filter() {
 
     ecs_fini(world);
 }
+
+void Rules_select_smallest_term_first() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ecs_add_id(world, TagA, EcsFinal);
+    ecs_add_id(world, TagB, EcsFinal);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_new(world, TagA);
+    }
+
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+
+    ecs_rule_t *r = ecs_rule_new(world, "TagA, TagB");
+    test_assert(r != NULL);
+
+    /* TagB matches fewer entities, so it should be selected first */
+    char *str = ecs_rule_str(r);
+    test_assert(str != NULL);
+    test_assert(strstr(str, "select   O:t. F:(TagB)") != NULL);
+    test_assert(strstr(str, "with     I:t. F:(TagA)") != NULL);
+    ecs_os_free(str);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e);
+    test_uint(ecs_term_id(&it, 1), TagA);
+    test_uint(ecs_term_id(&it, 2), TagB);
+    test_assert(!ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_root_var_w_smallest_estimate() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Planet);
+    ecs_add_id(world, Likes, EcsFinal);
+    ecs_add_id(world, Planet, EcsFinal);
+
+    ecs_entity_t earth = ecs_new_entity(world, "Earth");
+    ecs_add(world, earth, Planet);
+    ecs_entity_t apples = ecs_new_entity(world, "Apples");
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_new_w_pair(world, Likes, apples);
+    }
+
+    ecs_entity_t bob = ecs_new_entity(world, "Bob");
+    ecs_add_pair(world, bob, Likes, earth);
+
+    ecs_rule_t *r = ecs_rule_new(world, "Likes(., _X), Planet(_X)");
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    /* Planet matches fewer entities than Likes, so X should be resolved first */
+    char *str = ecs_rule_str(r);
+    test_assert(str != NULL);
+    char *select_x = strstr(str, "select   O:tX");
+    char *select_this = strstr(str, "O:t.");
+    test_assert(select_x != NULL);
+    test_assert(select_this != NULL);
+    test_assert(select_x < select_this);
+    ecs_os_free(str);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], bob);
+    test_uint(ecs_term_id(&it, 1), ecs_pair(Likes, earth));
+    test_uint(ecs_term_id(&it, 2), Planet);
+    test_uint(ecs_rule_get_var(&it, x_var), earth);
+    test_assert(!ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_plan_str() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ecs_add_id(world, TagA, EcsFinal);
+    ecs_add_id(world, TagB, EcsFinal);
+
+    ecs_new(world, TagA);
+    ecs_new(world, TagA);
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add(world, e, TagB);
+
+    ecs_rule_t *r = ecs_rule_new(world, "TagA, TagB");
+    test_assert(r != NULL);
+
+    char *str = ecs_rule_plan_str(r);
+    test_assert(str != NULL);
+    test_assert(strstr(str, 
+        "[E:       1, A:       1] select   O:t. F:(TagB)") != NULL);
+    test_assert(strstr(str, 
+        "[E:       3, A:       1] with     I:t. F:(TagA)") != NULL);
+    test_assert(strstr(str, 
+        "[E:       -, A:       1] yield    I:t.") != NULL);
+    ecs_os_free(str);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_cached() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "Position",
+        .cached = true
+    });
+    test_assert(r != NULL);
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_assert(ecs_rule_next(&it));
+        test_int(it.count, 2);
+        test_uint(ecs_id(Position), ecs_term_id(&it, 1));
+        test_int(it.entities[0], e1);
+        test_int(it.entities[1], e2);
+
+        Position *p = ecs_term(&it, Position, 1);
+        test_assert(p != NULL);
+        test_int(p[0].x, 10 + i);
+        test_int(p[0].y, 20);
+        test_int(p[1].x, 30);
+        test_int(p[1].y, 40);
+
+        test_assert(!ecs_rule_next(&it));
+
+        /* Changing a value does not invalidate the cache */
+        ecs_set(world, e1, Position, {11, 20});
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_cached_w_var() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Likes);
+    ecs_add_id(world, Likes, EcsFinal);
+
+    ecs_entity_t apples = ecs_new_entity(world, "Apples");
+    ecs_entity_t pears = ecs_new_entity(world, "Pears");
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Likes, apples);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Likes, pears);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "Likes(., _X)",
+        .cached = true
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    int i;
+    for (i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_assert(ecs_rule_next(&it));
+        test_int(it.count, 1);
+        test_int(it.entities[0], e1);
+        test_uint(ecs_term_id(&it, 1), ecs_pair(Likes, apples));
+        test_uint(ecs_rule_get_var(&it, x_var), apples);
+
+        test_assert(ecs_rule_next(&it));
+        test_int(it.count, 1);
+        test_int(it.entities[0], e2);
+        test_uint(ecs_term_id(&it, 1), ecs_pair(Likes, pears));
+        test_uint(ecs_rule_get_var(&it, x_var), pears);
+
+        test_assert(!ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_cached_after_add() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Likes);
+    ecs_add_id(world, Likes, EcsFinal);
+
+    ecs_entity_t apples = ecs_new_entity(world, "Apples");
+    ecs_entity_t e1 = ecs_new_w_pair(world, Likes, apples);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "Likes(., _X)",
+        .cached = true
+    });
+    test_assert(r != NULL);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e1);
+    test_assert(!ecs_rule_next(&it));
+
+    /* Entity is added to existing table */
+    ecs_entity_t e2 = ecs_new_w_pair(world, Likes, apples);
+
+    it = ecs_rule_iter(world, r);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.count, 2);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e2);
+    test_assert(!ecs_rule_next(&it));
+
+    /* Entity is added to new table */
+    ecs_entity_t pears = ecs_new_entity(world, "Pears");
+    ecs_entity_t e3 = ecs_new_w_pair(world, Likes, pears);
+
+    it = ecs_rule_iter(world, r);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.count, 2);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e2);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e3);
+    test_uint(ecs_term_id(&it, 1), ecs_pair(Likes, pears));
+    test_assert(!ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_cached_after_remove() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Fruit);
+    ecs_add_id(world, Likes, EcsFinal);
+    ecs_add_id(world, Fruit, EcsFinal);
+
+    ecs_entity_t apples = ecs_new_entity(world, "Apples");
+    ecs_entity_t pears = ecs_new_entity(world, "Pears");
+    ecs_add(world, apples, Fruit);
+    ecs_add(world, pears, Fruit);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Likes, apples);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Likes, pears);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "Likes(., _X), Fruit(_X)",
+        .cached = true
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.entities[0], e1);
+    test_uint(ecs_rule_get_var(&it, x_var), apples);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.entities[0], e2);
+    test_uint(ecs_rule_get_var(&it, x_var), pears);
+    test_assert(!ecs_rule_next(&it));
+
+    /* Remove component from variable, which invalidates the cache */
+    ecs_remove(world, pears, Fruit);
+
+    it = ecs_rule_iter(world, r);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.entities[0], e1);
+    test_uint(ecs_rule_get_var(&it, x_var), apples);
+    test_assert(!ecs_rule_next(&it));
+
+    /* Remove relationship */
+    ecs_remove_pair(world, e1, Likes, apples);
+
+    it = ecs_rule_iter(world, r);
+    test_assert(!ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_cached_set_var() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Likes);
+    ecs_add_id(world, Likes, EcsFinal);
+
+    ecs_entity_t apples = ecs_new_entity(world, "Apples");
+    ecs_entity_t pears = ecs_new_entity(world, "Pears");
+
+    ecs_new_w_pair(world, Likes, apples);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Likes, pears);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "Likes(., _X)",
+        .cached = true
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    /* Setting a variable bypasses the cache */
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    ecs_rule_set_var(&it, x_var, pears);
+    test_assert(ecs_rule_next(&it));
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+    test_uint(ecs_rule_get_var(&it, x_var), pears);
+    test_assert(!ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+static
+void test_rule_workers(
+    ecs_world_t *world,
+    ecs_rule_t *r,
+    int32_t worker_count)
+{
+    int32_t count = 0, worker_total = 0;
+    ecs_entity_t entities[64] = {0};
+    ecs_entity_t vars[64] = {0};
+    int32_t x_var = ecs_rule_find_var(r, "X");
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        int i;
+        for (i = 0; i < it.count; i ++) {
+            test_assert(count < 64);
+            entities[count] = it.entities[i];
+            if (x_var != -1) {
+                vars[count] = ecs_rule_get_var(&it, x_var);
+            }
+            count ++;
+        }
+    }
+
+    int w;
+    for (w = 0; w < worker_count; w ++) {
+        it = ecs_rule_worker_iter(world, r, w, worker_count);
+        while (ecs_rule_next(&it)) {
+            int i;
+            for (i = 0; i < it.count; i ++) {
+                ecs_entity_t x = 0;
+                if (x_var != -1) {
+                    x = ecs_rule_get_var(&it, x_var);
+                }
+
+                /* Each result must be returned by exactly one worker */
+                int j;
+                for (j = 0; j < count; j ++) {
+                    if (entities[j] == it.entities[i] && vars[j] == x) {
+                        break;
+                    }
+                }
+                test_assert(j != count);
+                entities[j] = 0;
+                worker_total ++;
+            }
+        }
+    }
+
+    test_int(worker_total, count);
+}
+
+typedef struct {
+    ecs_rule_t *rule;
+    int32_t count;
+    bool cached;
+} RuleFromSystemCtx;
+
+static
+void IterCachedRule(ecs_iter_t *it) {
+    RuleFromSystemCtx *ctx = it->ctx;
+    ctx->count = 0;
+
+    ecs_iter_t rit = ecs_rule_iter(it->world, ctx->rule);
+    ctx->cached = rit.priv.iter.rule.cached;
+    while (ecs_rule_next(&rit)) {
+        ctx->count += rit.count;
+    }
+}
+
+void Rules_rule_cached_from_system() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ecs_add_id(world, TagA, EcsFinal);
+
+    ecs_new(world, TagA);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA",
+        .cached = true
+    });
+    test_assert(r != NULL);
+
+    RuleFromSystemCtx ctx = { .rule = r };
+    ecs_system_init(world, &(ecs_system_desc_t) {
+        .entity = { .add = { EcsOnUpdate } },
+        .callback = IterCachedRule,
+        .ctx = &ctx
+    });
+
+    /* The cache is filled while the world is readonly */
+    ecs_progress(world, 0);
+    test_bool(ctx.cached, true);
+    test_int(ctx.count, 1);
+
+    /* Cache is refilled after entities are added between frames */
+    ecs_new(world, TagA);
+    ecs_entity_t e = ecs_new(world, TagA);
+    ecs_add_id(world, e, ecs_new_id(world));
+
+    ecs_progress(world, 0);
+    test_bool(ctx.cached, true);
+    test_int(ctx.count, 3);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_worker_iter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ecs_add_id(world, TagA, EcsFinal);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_new(world, TagA);
+        ecs_add_id(world, e, ecs_new_id(world)); /* Create new table */
+    }
+
+    ecs_rule_t *r = ecs_rule_new(world, "TagA");
+    test_assert(r != NULL);
+
+    test_rule_workers(world, r, 1);
+    test_rule_workers(world, r, 2);
+    test_rule_workers(world, r, 3);
+    test_rule_workers(world, r, 12);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_worker_iter_w_var() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Fruit);
+    ecs_add_id(world, Likes, EcsFinal);
+    ecs_add_id(world, Fruit, EcsFinal);
+
+    ecs_entity_t fruits[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        fruits[i] = ecs_new(world, Fruit);
+    }
+
+    for (i = 0; i < 12; i ++) {
+        ecs_entity_t e = ecs_new_id(world);
+        ecs_add_pair(world, e, Likes, fruits[i % 4]);
+        ecs_add_pair(world, e, Likes, fruits[(i + 1) % 4]);
+    }
+
+    ecs_rule_t *r = ecs_rule_new(world, "Likes(., _X), Fruit(_X)");
+    test_assert(r != NULL);
+
+    test_rule_workers(world, r, 2);
+    test_rule_workers(world, r, 3);
+    test_rule_workers(world, r, 5);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_worker_iter_cached() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+    ecs_add_id(world, TagA, EcsFinal);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_new(world, TagA);
+        ecs_add_id(world, e, ecs_new_id(world));
+    }
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "TagA",
+        .cached = true
+    });
+    test_assert(r != NULL);
+
+    test_rule_workers(world, r, 2);
+    test_rule_workers(world, r, 3);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_worker_iter_no_this() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Likes);
+    ecs_add_id(world, Likes, EcsFinal);
+
+    ecs_entity_t bob = ecs_new_entity(world, "Bob");
+    ecs_entity_t apples = ecs_new_entity(world, "Apples");
+    ecs_add_pair(world, bob, Likes, apples);
+
+    ecs_rule_t *r = ecs_rule_new(world, "Likes(Bob, Apples)");
+    test_assert(r != NULL);
+
+    /* Program can't be divided, only first worker returns the result */
+    ecs_iter_t it = ecs_rule_worker_iter(world, r, 0, 2);
+    test_assert(ecs_rule_next(&it));
+    test_assert(!ecs_rule_next(&it));
+
+    it = ecs_rule_worker_iter(world, r, 1, 2);
+    test_assert(!ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void Rules_rule_worker_iter_w_set_var() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Foo);
+    ecs_add_id(world, Foo, EcsFinal);
+
+    ecs_entity_t e[10];
+    int i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_new(world, Foo);
+        ecs_add_id(world, e[i], ecs_new_id(world)); /* Create new table */
+    }
+
+    ecs_rule_t *r = ecs_rule_new(world, "Foo(_X)");
+    test_assert(r != NULL);
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    /* Table of variable is set, only first worker returns the result */
+    int32_t count = 0, w;
+    for (w = 0; w < 4; w ++) {
+        ecs_iter_t it = ecs_rule_worker_iter(world, r, w, 4);
+        ecs_rule_set_var(&it, x_var, e[3]);
+        while (ecs_rule_next(&it)) {
+            test_int(w, 0);
+            test_int(ecs_rule_get_var(&it, x_var), e[3]);
+            count ++;
+        }
+    }
+    test_int(count, 1);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
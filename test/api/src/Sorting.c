@@ -1739,3 +1739,199 @@ void Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term() {
 
     ecs_fini(world);
 }
+
+void Sorting_sort_1000_entities_few_out_of_order() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t e[1000];
+    for (int i = 0; i < 1000; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i * 2});
+    }
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) { }
+
+    ecs_set(world, e[10], Position, {1501});
+    ecs_set(world, e[500], Position, {-1});
+    ecs_set(world, e[999], Position, {251});
+
+    int32_t count = 0, x = -1;
+    it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_term(&it, Position, 1);
+
+        int32_t j;
+        for (j = 0; j < it.count; j ++) {
+            test_assert(x <= p[j].x);
+            x = p[j].x;
+
+            const Position *ptr = ecs_get(world, it.entities[j], Position);
+            test_assert(ptr == &p[j]);
+        }
+
+        count += it.count;
+    }
+
+    test_int(count, 1000);
+    test_int(x, 1996);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_2_tables_after_set_in_order() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {3, 0});
+    ecs_set(world, e2, Velocity, {0, 0});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e1);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e3);
+    test_bool(ecs_query_next(&it), false);
+
+    /* Order within table doesn't change, but order between tables does */
+    ecs_set(world, e2, Position, {5, 0});
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e3);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e2);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+static
+void test_sorted_query(
+    ecs_world_t *world,
+    ecs_query_t *q,
+    int32_t expect_count)
+{
+    int32_t count = 0;
+    float x = -1;
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_term(&it, Position, 1);
+
+        int32_t j;
+        for (j = 0; j < it.count; j ++) {
+            test_assert(x <= p[j].x);
+            x = p[j].x;
+
+            const void *ptr = ecs_get_id(
+                world, it.entities[j], ecs_term_id(&it, 1));
+            test_assert(ptr == &p[j]);
+        }
+
+        count += it.count;
+    }
+
+    test_int(count, expect_count);
+}
+
+void Sorting_sort_after_set_few_rows() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.expr = "[in] Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t e[1000];
+    for (int i = 0; i < 1000; i ++) {
+        e[i] = ecs_set(world, 0, Position, {(float)(rand() % 1000), 0});
+    }
+
+    test_sorted_query(world, q, 1000);
+
+    /* Few changed rows are merged into the rows that didn't change */
+    for (int i = 0; i < 100; i ++) {
+        for (int j = 0; j < 5; j ++) {
+            ecs_set(world, e[rand() % 1000], Position, 
+                {(float)(rand() % 1000), 0});
+        }
+
+        test_sorted_query(world, q, 1000);
+    }
+
+    /* Many changed rows sort the table again */
+    for (int i = 0; i < 500; i ++) {
+        ecs_set(world, e[rand() % 1000], Position, {(float)(rand() % 1000), 0});
+    }
+
+    test_sorted_query(world, q, 1000);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_after_set_few_rows_3_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.expr = "[in] Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t e[300];
+    for (int i = 0; i < 300; i ++) {
+        e[i] = ecs_set(world, 0, Position, {(float)(rand() % 100), 0});
+        if (i % 3 == 1) {
+            ecs_add(world, e[i], TagA);
+        } else if (i % 3 == 2) {
+            ecs_add(world, e[i], TagB);
+        }
+    }
+
+    test_sorted_query(world, q, 300);
+
+    /* Order between tables changes, slices are patched */
+    for (int i = 0; i < 100; i ++) {
+        for (int j = 0; j < 3; j ++) {
+            ecs_set(world, e[rand() % 300], Position, 
+                {(float)(rand() % 100), 0});
+        }
+
+        test_sorted_query(world, q, 300);
+    }
+
+    ecs_fini(world);
+}
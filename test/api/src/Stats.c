@@ -237,3 +237,176 @@ void Stats_get_pipeline_stats_after_progress_2_systems_one_merge() {
 
     ecs_fini(world);
 }
+
+void Stats_get_world_info_stack_stats() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_progress(world, 0);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int32_t page_count = info->stack_page_count;
+    int32_t alloc_count = info->stack_alloc_count_total;
+    test_assert(page_count > 0);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Position, {20, 30});
+    ecs_set(world, e, Position, {30, 40});
+    ecs_defer_end(world);
+
+    ecs_progress(world, 0);
+
+    test_int(info->stack_page_count, page_count);
+    test_int(info->stack_alloc_count_total, alloc_count + 3);
+
+    ecs_progress(world, 0);
+
+    test_int(info->stack_page_count, page_count);
+    test_int(info->stack_alloc_count_total, alloc_count + 3);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+static
+void FiveTerms(ecs_iter_t *it) {
+    probe_system_w_ctx(it, it->ctx);
+}
+
+void Stats_get_world_info_frame_stack_stats() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagD);
+
+    Probe ctx = {0};
+    ecs_entity_t s = ecs_system_init(world, &(ecs_system_desc_t){
+        .entity.add = {EcsOnUpdate},
+        .query.filter.expr = "Position, TagA, TagB, TagC, TagD",
+        .callback = FiveTerms,
+        .ctx = &ctx
+    });
+    test_assert(s != 0);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_add(world, e, TagA);
+    ecs_add(world, e, TagB);
+    ecs_add(world, e, TagC);
+    ecs_add(world, e, TagD);
+
+    ecs_progress(world, 0);
+    test_int(ctx.invoked, 1);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int32_t page_count = info->stack_page_count;
+    int32_t alloc_count = info->stack_alloc_count_total;
+
+    /* The ptrs and match_indices arrays of the system iterator come from the 
+     * frame allocator, which is reset at the end of each frame */
+    ecs_progress(world, 0);
+    test_int(ctx.invoked, 2);
+    test_int(info->stack_page_count, page_count);
+    test_int(info->stack_alloc_count_total, alloc_count + 2);
+
+    ecs_progress(world, 0);
+    test_int(ctx.invoked, 3);
+    test_int(info->stack_page_count, page_count);
+    test_int(info->stack_alloc_count_total, alloc_count + 4);
+
+    /* Iterators created outside of a frame don't use the frame allocator */
+    ecs_query_t *q = ecs_query_new(world, "Position, TagA, TagB, TagC, TagD");
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], e);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_progress(world, 0);
+    test_int(ctx.invoked, 4);
+    test_int(info->stack_alloc_count_total, alloc_count + 6);
+
+    ecs_fini(world);
+}
+
+void Stats_get_world_info_pool_stats() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_progress(world, 0);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int32_t alloc_count = info->pool_alloc_count_total;
+    test_assert(info->pool_block_count > 0);
+    test_assert(alloc_count > 0);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {10, 20});
+    }
+
+    ecs_progress(world, 0);
+
+    test_assert(info->pool_alloc_count_total > alloc_count);
+    int32_t block_count = info->pool_block_count;
+
+    /* Storage released by deleting the entities is reused */
+    ecs_delete_with(world, ecs_id(Position));
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {10, 20});
+    }
+
+    ecs_progress(world, 0);
+
+    test_int(info->pool_block_count, block_count);
+
+    ecs_fini(world);
+}
+
+void Stats_get_world_stats_table_edges() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_world_stats_t stats = {0};
+    ecs_get_world_stats(world, &stats);
+
+    float edge_count = stats.table_edge_count.avg[stats.t];
+    float edge_memory = stats.table_edge_memory.avg[stats.t];
+    test_assert(edge_count > 0);
+    test_assert(edge_memory > 0);
+
+    ecs_entity_t e = ecs_new(world, Position);
+    ecs_add(world, e, Velocity);
+    ecs_add(world, e, Tag);
+
+    ecs_get_world_stats(world, &stats);
+    test_assert(stats.table_edge_count.avg[stats.t] >= edge_count + 2);
+    test_assert(stats.table_edge_memory.avg[stats.t] > edge_memory);
+
+    edge_count = stats.table_edge_count.avg[stats.t];
+    edge_memory = stats.table_edge_memory.avg[stats.t];
+
+    /* Deleting the tables with Tag removes their edges */
+    ecs_delete(world, e);
+    ecs_delete(world, Tag);
+
+    ecs_get_world_stats(world, &stats);
+    test_assert(stats.table_edge_count.avg[stats.t] < edge_count);
+    test_assert(stats.table_edge_memory.avg[stats.t] < edge_memory);
+
+    ecs_fini(world);
+}
@@ -1144,3 +1144,419 @@ void TransitiveRules_rule_iter_set_transitive_self_2_variables_set_both() {
 
     ecs_fini(world);
 }
+
+static
+char* rule_results_str(
+    ecs_world_t *world,
+    ecs_rule_t *r)
+{
+    ecs_strbuf_t buf = ECS_STRBUF_INIT;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        char *str = ecs_iter_str(&it);
+        ecs_strbuf_appendstr(&buf, str);
+        ecs_os_free(str);
+    }
+    return ecs_strbuf_get(&buf);
+}
+
+/* Rule must return the same results with and without closure index */
+static
+void test_closure_index(
+    ecs_world_t *world,
+    ecs_entity_t rel,
+    const char *expr)
+{
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = expr
+    });
+    test_assert(r != NULL);
+
+    char *expect = rule_results_str(world, r);
+    test_assert(expect != NULL);
+
+    test_bool(ecs_enable_closure_index(world, rel, true), false);
+    char *result = rule_results_str(world, r);
+    test_str(result, expect);
+    ecs_os_free(result);
+
+    /* Second iteration reuses index */
+    result = rule_results_str(world, r);
+    test_str(result, expect);
+    ecs_os_free(result);
+
+    test_bool(ecs_enable_closure_index(world, rel, false), true);
+    ecs_os_free(expect);
+
+    ecs_rule_fini(r);
+}
+
+void TransitiveRules_closure_index_superset() {
+    ecs_world_t *world = ecs_init();
+
+    const char *ruleset = 
+    HEAD "Transitive(LocatedIn)"
+    LINE "Final(LocatedIn)"
+    LINE "LocatedIn(Earth, Universe)"
+    LINE "LocatedIn(NorthAmerica, Earth)"
+    LINE "LocatedIn(UnitedStates, NorthAmerica)"
+    LINE "LocatedIn(California, UnitedStates)"
+    LINE "LocatedIn(SanFrancisco, California)"
+    LINE "LocatedIn(SanFrancisco, BayArea)";
+    test_int(ecs_plecs_from_str(world, NULL, ruleset), 0);
+
+    test_closure_index(world, ecs_lookup(world, "LocatedIn"), 
+        "LocatedIn(SanFrancisco, _X)");
+    test_closure_index(world, ecs_lookup(world, "LocatedIn"), 
+        "LocatedIn(SanFrancisco, UnitedStates)");
+    test_closure_index(world, ecs_lookup(world, "LocatedIn"), 
+        "LocatedIn(_X, _Y)");
+
+    ecs_fini(world);
+}
+
+void TransitiveRules_closure_index_subset() {
+    ecs_world_t *world = ecs_init();
+
+    const char *ruleset = 
+    HEAD "Transitive(LocatedIn)"
+    LINE "Final(LocatedIn)"
+    LINE "LocatedIn(Earth, Universe)"
+    LINE "LocatedIn(NorthAmerica, Earth)"
+    LINE "LocatedIn(Europe, Earth)"
+    LINE "LocatedIn(UnitedStates, NorthAmerica)"
+    LINE "LocatedIn(Netherlands, Europe)"
+    LINE "LocatedIn(California, UnitedStates)"
+    LINE "LocatedIn(SanFrancisco, California)"
+    LINE "LocatedIn(Amsterdam, Netherlands)";
+    test_int(ecs_plecs_from_str(world, NULL, ruleset), 0);
+
+    test_closure_index(world, ecs_lookup(world, "LocatedIn"), 
+        "LocatedIn(_X, Earth)");
+    test_closure_index(world, ecs_lookup(world, "LocatedIn"), 
+        "LocatedIn(_X, Europe)");
+    test_closure_index(world, ecs_lookup(world, "LocatedIn"), 
+        "LocatedIn(., NorthAmerica)");
+
+    ecs_fini(world);
+}
+
+void TransitiveRules_closure_index_after_add() {
+    ecs_world_t *world = ecs_init();
+
+    const char *ruleset = 
+    HEAD "Transitive(LocatedIn)"
+    LINE "Final(LocatedIn)"
+    LINE "LocatedIn(UnitedStates, NorthAmerica)"
+    LINE "LocatedIn(California, UnitedStates)"
+    LINE "LocatedIn(SanFrancisco, California)";
+    test_int(ecs_plecs_from_str(world, NULL, ruleset), 0);
+
+    ecs_entity_t LocatedIn = ecs_lookup(world, "LocatedIn");
+    ecs_entity_t NorthAmerica = ecs_lookup(world, "NorthAmerica");
+    ecs_entity_t California = ecs_lookup(world, "California");
+    test_bool(ecs_enable_closure_index(world, LocatedIn, true), false);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn(_X, NorthAmerica)"
+    });
+    test_assert(r != NULL);
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        count ++;
+    }
+    test_int(count, 3);
+
+    ecs_entity_t Oakland = ecs_new_entity(world, "Oakland");
+    ecs_add_pair(world, Oakland, LocatedIn, California);
+
+    bool oakland_found = false;
+    count = 0;
+    it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        if (ecs_rule_get_var(&it, x_var) == Oakland) {
+            oakland_found = true;
+        }
+        count ++;
+    }
+    test_int(count, 4);
+    test_bool(oakland_found, true);
+
+    ecs_rule_t *s = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn(Oakland, NorthAmerica)"
+    });
+    test_assert(s != NULL);
+
+    it = ecs_rule_iter(world, s);
+    test_bool(ecs_rule_next(&it), true);
+    test_bool(ecs_rule_next(&it), false);
+
+    ecs_add_pair(world, Oakland, LocatedIn, NorthAmerica);
+    ecs_remove_pair(world, Oakland, LocatedIn, California);
+
+    it = ecs_rule_iter(world, s);
+    test_bool(ecs_rule_next(&it), true);
+    test_bool(ecs_rule_next(&it), false);
+
+    ecs_rule_fini(r);
+    ecs_rule_fini(s);
+
+    ecs_fini(world);
+}
+
+void TransitiveRules_closure_index_after_remove() {
+    ecs_world_t *world = ecs_init();
+
+    const char *ruleset = 
+    HEAD "Transitive(LocatedIn)"
+    LINE "Final(LocatedIn)"
+    LINE "LocatedIn(UnitedStates, NorthAmerica)"
+    LINE "LocatedIn(California, UnitedStates)"
+    LINE "LocatedIn(SanFrancisco, California)";
+    test_int(ecs_plecs_from_str(world, NULL, ruleset), 0);
+
+    ecs_entity_t LocatedIn = ecs_lookup(world, "LocatedIn");
+    ecs_entity_t UnitedStates = ecs_lookup(world, "UnitedStates");
+    ecs_entity_t California = ecs_lookup(world, "California");
+    test_bool(ecs_enable_closure_index(world, LocatedIn, true), false);
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = "LocatedIn(SanFrancisco, _X)"
+    });
+    test_assert(r != NULL);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        count ++;
+    }
+    test_int(count, 3);
+
+    ecs_remove_pair(world, California, LocatedIn, UnitedStates);
+
+    count = 0;
+    it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        test_int(ecs_rule_get_var(&it, ecs_rule_find_var(r, "X")), California);
+        count ++;
+    }
+    test_int(count, 1);
+
+    ecs_delete(world, California);
+
+    it = ecs_rule_iter(world, r);
+    test_bool(ecs_rule_next(&it), false);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void TransitiveRules_closure_index_deep() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, LocatedIn);
+    ecs_add_id(world, LocatedIn, EcsTransitive);
+    ecs_add_id(world, LocatedIn, EcsFinal);
+    test_bool(ecs_enable_closure_index(world, LocatedIn, true), false);
+
+    /* Deeper than the number of frames the rule stores inline */
+    ecs_entity_t levels[64];
+    levels[0] = ecs_new_id(world);
+    int i;
+    for (i = 1; i < 64; i ++) {
+        levels[i] = ecs_new_w_pair(world, LocatedIn, levels[i - 1]);
+    }
+
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .terms = {{ 
+            .pred.entity = LocatedIn, 
+            .subj.entity = levels[63],
+            .obj.name = "X", .obj.var = EcsVarIsVariable
+        }}
+    });
+    test_assert(r != NULL);
+    int32_t x_var = ecs_rule_find_var(r, "X");
+    test_assert(x_var != -1);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        test_int(ecs_rule_get_var(&it, x_var), levels[62 - count]);
+        count ++;
+    }
+    test_int(count, 63);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+/* Test values of variable in order in which rule returns them */
+static
+void test_rule_var(
+    ecs_world_t *world,
+    const char *expr,
+    const char *var,
+    const char *expect[])
+{
+    ecs_rule_t *r = ecs_rule_init(world, &(ecs_filter_desc_t){
+        .expr = expr
+    });
+    test_assert(r != NULL);
+    int32_t var_id = ecs_rule_find_var(r, var);
+    test_assert(var_id != -1);
+
+    int32_t count = 0;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        test_assert(expect[count] != NULL);
+        test_str(ecs_get_name(world, ecs_rule_get_var(&it, var_id)), 
+            expect[count]);
+        count ++;
+    }
+    test_assert(expect[count] == NULL);
+
+    ecs_rule_fini(r);
+}
+
+void TransitiveRules_closure_index_cycle() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, LocatedIn);
+
+    /* Create cycle before relation is made transitive, as observers don't
+     * expect cycles for acyclic relations */
+    ecs_entity_t a = ecs_set_name(world, 0, "a");
+    ecs_entity_t b = ecs_set_name(world, 0, "b");
+    ecs_add_pair(world, a, LocatedIn, b);
+    ecs_add_pair(world, b, LocatedIn, a);
+    ecs_add_id(world, LocatedIn, EcsTransitive);
+
+    test_bool(ecs_enable_closure_index(world, LocatedIn, true), false);
+
+    test_rule_var(world, "LocatedIn(a, _X)", "X", 
+        (const char*[]){"b", "a", NULL});
+    test_rule_var(world, "LocatedIn(_X, a)", "X", 
+        (const char*[]){"b", "a", NULL});
+    test_rule_var(world, "LocatedIn(_X, _Y)", "X", 
+        (const char*[]){"a", "a", "a", "b", "b", "b", NULL});
+
+    ecs_fini(world);
+}
+
+void TransitiveRules_closure_index_cycle_w_depth() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, Tag);
+    ECS_TAG(world, Rel);
+
+    ecs_entity_t a = ecs_new_id(world);
+    ecs_entity_t b = ecs_new_id(world);
+    ecs_entity_t c = ecs_new(world, Tag);
+    ecs_add_pair(world, a, Rel, b);
+    ecs_add_pair(world, b, Rel, a);
+    ecs_add_pair(world, b, Rel, c);
+
+    test_bool(ecs_enable_closure_index(world, Rel, true), false);
+
+    ecs_filter_t f;
+    test_int(ecs_filter_init(world, &f, &(ecs_filter_desc_t){
+        .terms = {{ Tag, .subj.set = {
+            .mask = EcsSuperSet, .relation = Rel, .max_depth = 3
+        }}}
+    }), 0);
+
+    ecs_iter_t it = ecs_filter_iter(world, &f);
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], a);
+    test_int(ecs_term_source(&it, 1), c);
+
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], b);
+    test_int(ecs_term_source(&it, 1), c);
+
+    /* Table of b is matched for each of its (Rel, *) pairs */
+    test_bool(ecs_filter_next(&it), true);
+    test_int(it.count, 1);
+    test_int(it.entities[0], b);
+    test_int(ecs_term_source(&it, 1), c);
+
+    test_bool(ecs_filter_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void TransitiveRules_closure_index_diamond() {
+    ecs_world_t *world = ecs_init();
+
+    const char *ruleset = 
+    HEAD "Transitive(LocatedIn)"
+    LINE "LocatedIn(B, A)"
+    LINE "LocatedIn(C, A)"
+    LINE "LocatedIn(D, B)"
+    LINE "LocatedIn(D, C)";
+    test_int(ecs_plecs_from_str(world, NULL, ruleset), 0);
+
+    ecs_entity_t LocatedIn = ecs_lookup(world, "LocatedIn");
+    test_bool(ecs_enable_closure_index(world, LocatedIn, true), false);
+
+    /* A can be reached through B and C, but is only returned once */
+    test_rule_var(world, "LocatedIn(D, _X)", "X", 
+        (const char*[]){"B", "A", "C", NULL});
+    test_rule_var(world, "LocatedIn(_X, A)", "X", 
+        (const char*[]){"B", "C", "D", NULL});
+
+    ecs_fini(world);
+}
+
+void TransitiveRules_closure_index_after_move() {
+    ecs_world_t *world = ecs_init();
+
+    const char *ruleset = 
+    HEAD "Transitive(LocatedIn)"
+    LINE "LocatedIn(X, Y)"
+    LINE "LocatedIn(Y, Z)"
+    LINE "LocatedIn(P, Z)"
+    LINE "LocatedIn(Q, W)";
+    test_int(ecs_plecs_from_str(world, NULL, ruleset), 0);
+
+    ecs_entity_t LocatedIn = ecs_lookup(world, "LocatedIn");
+    ecs_entity_t Y = ecs_lookup(world, "Y");
+    ecs_entity_t Z = ecs_lookup(world, "Z");
+    ecs_entity_t W = ecs_lookup(world, "W");
+    ecs_entity_t P = ecs_lookup(world, "P");
+    test_bool(ecs_enable_closure_index(world, LocatedIn, true), false);
+
+    test_rule_var(world, "LocatedIn(X, _V)", "V", 
+        (const char*[]){"Y", "Z", NULL});
+    test_rule_var(world, "LocatedIn(_V, W)", "V", 
+        (const char*[]){"Q", NULL});
+    test_rule_var(world, "LocatedIn(_V, Z)", "V", 
+        (const char*[]){"Y", "P", "X", NULL});
+
+    /* Y moves between tables that stay non-empty */
+    ecs_remove_pair(world, Y, LocatedIn, Z);
+    ecs_add_pair(world, Y, LocatedIn, W);
+    test_rule_var(world, "LocatedIn(X, _V)", "V", 
+        (const char*[]){"Y", "W", NULL});
+    test_rule_var(world, "LocatedIn(_V, W)", "V", 
+        (const char*[]){"Q", "Y", "X", NULL});
+    test_rule_var(world, "LocatedIn(_V, Z)", "V", 
+        (const char*[]){"P", NULL});
+
+    /* Table with (LocatedIn, Z) becomes empty */
+    ecs_remove_pair(world, P, LocatedIn, Z);
+    test_rule_var(world, "LocatedIn(_V, Z)", "V", 
+        (const char*[]){NULL});
+
+    ecs_fini(world);
+}
@@ -316,12 +316,15 @@ void World_dim() {
 
     malloc_count = 0;
 
+    /* Grows entity & record ptr arrays. The Position column is allocated from
+     * the world's storage pool, which has a free chunk of the right size. */
     ecs_bulk_new(world, Position, 500);
 
-    test_int(malloc_count, 3);
+    test_int(malloc_count, 2);
 
     malloc_count = 0;
 
+    /* Column moves to a larger size class, which allocates a new pool block */
     ecs_bulk_new(world, Position, 500);
 
     test_int(malloc_count, 3);
@@ -1082,3 +1085,380 @@ void World_redefine_component() {
 
     ecs_fini(world);
 }
+
+void World_dim_table() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    test_assert(table != NULL);
+
+    ecs_dim_table(world, table, 1000);
+    test_int(ecs_table_count(table), 0);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    test_assert(ecs_get_table(world, e) == table);
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+
+    int32_t i;
+    for (i = 0; i < 999; i ++) {
+        ecs_set(world, 0, Position, {i, i});
+    }
+
+    test_int(ecs_table_count(table), 1000);
+    test_assert(p == ecs_get(world, e, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_dim_table_lt_count() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, 0, Position, {20, 30});
+    ecs_set(world, 0, Position, {30, 40});
+
+    ecs_table_t *table = ecs_get_table(world, e);
+    test_assert(table != NULL);
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+
+    ecs_dim_table(world, table, 1);
+    test_int(ecs_table_count(table), 3);
+    test_assert(p == ecs_get(world, e, Position));
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    test_assert(table != NULL);
+
+    /* 4 Positions per chunk */
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    ecs_entity_t e[10];
+    const Position *p[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+        p[i] = ecs_get(world, e[i], Position);
+        test_assert(p[i] != NULL);
+    }
+
+    test_int(ecs_table_count(table), 4);
+
+    ecs_table_t *chunk_1 = ecs_get_table(world, e[4]);
+    ecs_table_t *chunk_2 = ecs_get_table(world, e[8]);
+    test_assert(chunk_1 != table);
+    test_assert(chunk_2 != table);
+    test_assert(chunk_1 != chunk_2);
+    test_int(ecs_table_count(chunk_1), 4);
+    test_int(ecs_table_count(chunk_2), 2);
+
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_get(world, e[i], Position) == p[i]);
+        test_int(p[i]->x, i);
+        test_int(p[i]->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_query() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_query_t *q = ecs_query_new(world, "Position");
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    int32_t table_count = 0, count = 0;
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_term(&it, Position, 1);
+        test_assert(it.count <= 4);
+        for (i = 0; i < it.count; i ++) {
+            test_int(p[i].y, p[i].x * 2);
+        }
+        count += it.count;
+        table_count ++;
+    }
+
+    test_int(count, 10);
+    test_int(table_count, 3);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_ref() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_ref_t ref = {0};
+    const Position *p = ecs_get_ref(world, &ref, e, Position);
+    test_assert(p != NULL);
+    int32_t alloc_count = ref.alloc_count;
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {i, i});
+    }
+
+    test_assert(ecs_get_ref(world, &ref, e, Position) == p);
+    test_int(ref.alloc_count, alloc_count);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    ecs_entity_t e[8];
+    int32_t i;
+    for (i = 0; i < 8; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_table_t *chunk = ecs_get_table(world, e[4]);
+    test_assert(chunk != table);
+    test_int(ecs_table_count(table), 4);
+
+    /* New entity is added to the chunk with space */
+    ecs_delete(world, e[1]);
+    test_int(ecs_table_count(table), 3);
+
+    ecs_entity_t e_new = ecs_set(world, 0, Position, {10, 20});
+    test_assert(ecs_get_table(world, e_new) == table);
+    test_int(ecs_table_count(table), 4);
+    test_int(ecs_table_count(chunk), 4);
+
+    /* Adding a component the entity already has doesn't change its chunk */
+    ecs_add(world, e[5], Position);
+    test_assert(ecs_get_table(world, e[5]) == chunk);
+
+    const Position *p = ecs_get(world, e_new, Position);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_bulk_init() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    Position data[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        data[i].x = i;
+        data[i].y = i * 2;
+    }
+
+    const ecs_entity_t *ids = ecs_bulk_init(world, &(ecs_bulk_desc_t){
+        .count = 10,
+        .ids = {ecs_id(Position)},
+        .data = (void*[]){data}
+    });
+    test_assert(ids != NULL);
+
+    ecs_entity_t e[10];
+    ecs_os_memcpy_n(e, ids, ecs_entity_t, 10);
+
+    test_int(ecs_table_count(table), 4);
+    test_assert(ecs_get_table(world, e[4]) != table);
+    test_assert(ecs_get_table(world, e[8]) != table);
+    test_assert(ecs_get_table(world, e[4]) != ecs_get_table(world, e[8]));
+
+    for (i = 0; i < 10; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_remove_all() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    ecs_entity_t e[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+        ecs_add(world, e[i], Tag);
+    }
+
+    test_int(ecs_table_count(table), 0);
+
+    ecs_remove_all(world, Tag);
+
+    test_int(ecs_table_count(table), 4);
+
+    for (i = 0; i < 10; i ++) {
+        test_assert(!ecs_has(world, e[i], Tag));
+        ecs_table_t *chunk = ecs_get_table(world, e[i]);
+        test_assert(chunk != NULL);
+        test_assert(ecs_table_count(chunk) <= 4);
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_defer_add() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    table = ecs_table_add_id(world, table, ecs_id(Velocity));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    ecs_entity_t e[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        ecs_add(world, e[i], Velocity);
+    }
+    ecs_defer_end(world);
+
+    test_int(ecs_table_count(table), 4);
+
+    for (i = 0; i < 10; i ++) {
+        test_assert(ecs_has(world, e[i], Velocity));
+        ecs_table_t *chunk = ecs_get_table(world, e[i]);
+        test_assert(ecs_table_count(chunk) <= 4);
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_clone() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    ecs_entity_t e[4];
+    int32_t i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i + 10, i + 20});
+    }
+
+    test_int(ecs_table_count(table), 4);
+
+    ecs_entity_t clone = ecs_clone(world, 0, e[1], true);
+    test_assert(clone != 0);
+    test_assert(ecs_get_table(world, clone) != table);
+    test_int(ecs_table_count(table), 4);
+
+    const Position *p = ecs_get(world, clone, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 11);
+    test_int(p->y, 21);
+
+    ecs_fini(world);
+}
+
+void World_table_chunk_size_instantiate() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    int32_t i;
+    for (i = 0; i < 6; i ++) {
+        ecs_entity_t child = ecs_new_w_pair(world, EcsChildOf, base);
+        ecs_set(world, child, Position, {i, i * 2});
+    }
+
+    /* Chunk the table for the children of the instance before instantiating */
+    ecs_entity_t inst = ecs_new_id(world);
+    ecs_table_t *table = ecs_table_add_id(world, NULL, ecs_id(Position));
+    table = ecs_table_add_id(world, table, ecs_pair(EcsChildOf, inst));
+    ecs_table_set_chunk_size(world, table, 4 * ECS_SIZEOF(Position));
+
+    ecs_add_pair(world, inst, EcsIsA, base);
+
+    test_int(ecs_table_count(table), 4);
+
+    ecs_iter_t it = ecs_term_iter(world, &(ecs_term_t) {
+        .id = ecs_pair(EcsChildOf, inst)
+    });
+
+    int32_t table_count = 0, count = 0, sum = 0;
+    while (ecs_term_next(&it)) {
+        for (i = 0; i < it.count; i ++) {
+            const Position *p = ecs_get(world, it.entities[i], Position);
+            test_assert(p != NULL);
+            test_int(p->y, p->x * 2);
+            sum += (int32_t)p->x;
+        }
+        count += it.count;
+        table_count ++;
+    }
+
+    test_int(count, 6);
+    test_int(table_count, 2);
+    test_int(sum, 0 + 1 + 2 + 3 + 4 + 5);
+
+    ecs_fini(world);
+}
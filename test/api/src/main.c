@@ -142,6 +142,28 @@ void New_w_Count_bulk_init_1_component_w_value(void);
 void New_w_Count_bulk_init_2_components_w_value(void);
 void New_w_Count_bulk_init_2_components_tag_w_value(void);
 
+// Testsuite 'Bulk'
+void Bulk_add_id(void);
+void Bulk_add_id_middle_range(void);
+void Bulk_add_id_range_w_short_tail(void);
+void Bulk_add_id_reverse_order(void);
+void Bulk_add_id_multiple_tables(void);
+void Bulk_add_id_existing(void);
+void Bulk_add_id_empty_entities(void);
+void Bulk_remove_id(void);
+void Bulk_remove_last_id(void);
+void Bulk_remove_id_not_added(void);
+void Bulk_set_id(void);
+void Bulk_set_id_existing(void);
+void Bulk_add_id_on_add_trigger(void);
+void Bulk_remove_id_on_remove_trigger(void);
+void Bulk_set_id_on_set_trigger(void);
+void Bulk_add_remove_w_lifecycle(void);
+void Bulk_add_id_w_filter(void);
+void Bulk_remove_id_w_filter(void);
+void Bulk_add_id_deferred(void);
+void Bulk_set_id_deferred(void);
+
 // Testsuite 'Add'
 void Add_zero(void);
 void Add_component(void);
@@ -1110,6 +1132,10 @@ void Sorting_sort_relation_marked(void);
 void Sorting_dont_resort_after_set_unsorted_component(void);
 void Sorting_dont_resort_after_set_unsorted_component_w_tag(void);
 void Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term(void);
+void Sorting_sort_1000_entities_few_out_of_order(void);
+void Sorting_sort_2_tables_after_set_in_order(void);
+void Sorting_sort_after_set_few_rows(void);
+void Sorting_sort_after_set_few_rows_3_tables(void);
 
 // Testsuite 'Filter'
 void Filter_filter_1_term(void);
@@ -1251,6 +1277,21 @@ void Filter_match_switch_w_case_2_terms(void);
 void Filter_and_term(void);
 void Filter_or_term(void);
 void Filter_iter_while_creating_components(void);
+void Filter_filter_cached(void);
+void Filter_filter_cached_after_new_table(void);
+void Filter_filter_cached_after_delete_table(void);
+void Filter_filter_cached_skip_empty_table(void);
+void Filter_filter_cached_w_not(void);
+void Filter_filter_cached_w_wildcard(void);
+void Filter_filter_cached_w_superset(void);
+void Filter_filter_cached_default_term(void);
+void Filter_filter_cached_w_superset_after_base_change(void);
+void Filter_filter_cached_w_fixed_subject(void);
+void Filter_filter_cached_evict(void);
+void Filter_filter_cached_from_system(void);
+void Filter_match_empty_tables_w_no_empty_tables(void);
+void Filter_filter_iter_superset_closure_index(void);
+void Filter_filter_iter_superset_closure_index_depth(void);
 
 // Testsuite 'FilterStr'
 void FilterStr_one_term(void);
@@ -1308,6 +1349,13 @@ void Query_get_filter(void);
 void Query_group_by(void);
 void Query_group_by_w_ctx(void);
 void Query_group_by_w_sort_reverse_group_creation(void);
+void Query_group_by_set_group(void);
+void Query_group_by_set_group_not_found(void);
+void Query_group_by_set_group_w_sort(void);
+void Query_group_by_worker_iter(void);
+void Query_group_by_worker_iter_more_workers_than_groups(void);
+void Query_group_by_get_group_info(void);
+void Query_group_by_groups(void);
 void Query_iter_valid(void);
 void Query_query_optional_tag(void);
 void Query_query_optional_shared_tag(void);
@@ -1327,6 +1375,10 @@ void Query_query_iter_frame_offset(void);
 void Query_add_singleton_after_query(void);
 void Query_query_w_component_from_parent_from_non_this(void);
 void Query_create_query_while_pending(void);
+void Query_query_changed_range_after_set(void);
+void Query_query_changed_range_after_new(void);
+void Query_query_changed_range_after_out_system(void);
+void Query_query_changed_range_after_mt_system(void);
 
 // Testsuite 'Iter'
 void Iter_page_iter_0_0(void);
@@ -1352,6 +1404,11 @@ void Iter_paged_iter_w_singleton_instanced(void);
 void Iter_iter_1_term_no_alloc(void);
 void Iter_iter_cache_size_terms_no_alloc(void);
 void Iter_iter_lt_cache_size_terms_alloc(void);
+void Iter_chunk_iter_1(void);
+void Iter_chunk_iter_2(void);
+void Iter_chunk_iter_w_task_query(void);
+void Iter_chunk_iter_fini_before_end(void);
+void Iter_term_is_aligned(void);
 
 // Testsuite 'Pairs'
 void Pairs_type_w_one_pair(void);
@@ -1602,6 +1659,20 @@ void Rules_test_this_w_wildcard_w_isa(void);
 void Rules_test_this_w_wildcard_w_isa_2_lvls(void);
 void Rules_test_this_w_wildcard_w_2_isa(void);
 void Rules_rule_w_inout_filter(void);
+void Rules_select_smallest_term_first(void);
+void Rules_root_var_w_smallest_estimate(void);
+void Rules_plan_str(void);
+void Rules_rule_cached(void);
+void Rules_rule_cached_w_var(void);
+void Rules_rule_cached_after_add(void);
+void Rules_rule_cached_after_remove(void);
+void Rules_rule_cached_set_var(void);
+void Rules_rule_cached_from_system(void);
+void Rules_rule_worker_iter(void);
+void Rules_rule_worker_iter_w_var(void);
+void Rules_rule_worker_iter_cached(void);
+void Rules_rule_worker_iter_no_this(void);
+void Rules_rule_worker_iter_w_set_var(void);
 
 // Testsuite 'TransitiveRules'
 void TransitiveRules_trans_X_X(void);
@@ -1628,6 +1699,15 @@ void TransitiveRules_rule_iter_set_transitive_self_variable(void);
 void TransitiveRules_rule_iter_set_transitive_2_variables_set_one(void);
 void TransitiveRules_rule_iter_set_transitive_2_variables_set_both(void);
 void TransitiveRules_rule_iter_set_transitive_self_2_variables_set_both(void);
+void TransitiveRules_closure_index_superset(void);
+void TransitiveRules_closure_index_subset(void);
+void TransitiveRules_closure_index_after_add(void);
+void TransitiveRules_closure_index_after_remove(void);
+void TransitiveRules_closure_index_deep(void);
+void TransitiveRules_closure_index_cycle(void);
+void TransitiveRules_closure_index_cycle_w_depth(void);
+void TransitiveRules_closure_index_diamond(void);
+void TransitiveRules_closure_index_after_move(void);
 
 // Testsuite 'Trigger'
 void Trigger_on_add_trigger_before_table(void);
@@ -2165,6 +2245,17 @@ void World_ensure_empty_root(void);
 void World_register_alias_twice_same_entity(void);
 void World_register_alias_twice_different_entity(void);
 void World_redefine_component(void);
+void World_dim_table(void);
+void World_dim_table_lt_count(void);
+void World_table_chunk_size(void);
+void World_table_chunk_size_query(void);
+void World_table_chunk_size_ref(void);
+void World_table_chunk_size_delete(void);
+void World_table_chunk_size_bulk_init(void);
+void World_table_chunk_size_remove_all(void);
+void World_table_chunk_size_defer_add(void);
+void World_table_chunk_size_clone(void);
+void World_table_chunk_size_instantiate(void);
 
 // Testsuite 'Stats'
 void Stats_get_world_stats(void);
@@ -2175,6 +2266,10 @@ void Stats_get_pipeline_stats_after_progress_1_system(void);
 void Stats_get_pipeline_stats_after_progress_1_inactive_system(void);
 void Stats_get_pipeline_stats_after_progress_2_systems(void);
 void Stats_get_pipeline_stats_after_progress_2_systems_one_merge(void);
+void Stats_get_world_info_stack_stats(void);
+void Stats_get_world_info_frame_stack_stats(void);
+void Stats_get_world_info_pool_stats(void);
+void Stats_get_world_stats_table_edges(void);
 
 // Testsuite 'Type'
 void Type_setup(void);
@@ -2285,6 +2380,18 @@ void MultiThread_schedule_w_tasks(void);
 void MultiThread_reactive_system(void);
 void MultiThread_fini_after_set_threads(void);
 void MultiThread_2_threads_single_threaded_system(void);
+void MultiThread_2_thread_chunked_100_entity(void);
+void MultiThread_6_thread_chunked_100_entity(void);
+void MultiThread_6_thread_chunked_1_entity_chunks(void);
+void MultiThread_chunked_table_lt_chunk_size(void);
+void MultiThread_chunked_run_stop_early(void);
+void MultiThread_partition_groups(void);
+void MultiThread_concurrent_systems_no_conflict(void);
+void MultiThread_concurrent_systems_w_conflict(void);
+void MultiThread_concurrent_systems_disabled(void);
+void MultiThread_concurrent_systems_two_pipelines(void);
+void MultiThread_jobs_system_order(void);
+void MultiThread_jobs_steal(void);
 
 // Testsuite 'DeferredActions'
 void DeferredActions_defer_new(void);
@@ -2349,6 +2456,23 @@ void DeferredActions_defer_enable(void);
 void DeferredActions_defer_disable(void);
 void DeferredActions_defer_delete_with(void);
 void DeferredActions_defer_remove_all(void);
+void DeferredActions_defer_set_large_value(void);
+void DeferredActions_defer_get_mut_many(void);
+void DeferredActions_defer_set_in_nested_flush(void);
+void DeferredActions_defer_add_batch_single_move(void);
+void DeferredActions_defer_add_remove_batch_same_entity(void);
+void DeferredActions_defer_add_batch_interleaved_entities(void);
+void DeferredActions_defer_bulk_new_batch_trigger(void);
+void DeferredActions_defer_add_batch_trigger(void);
+void DeferredActions_defer_remove_batch_trigger(void);
+void DeferredActions_defer_set_batch_trigger(void);
+void DeferredActions_defer_set_batch_w_move(void);
+void DeferredActions_defer_add_batch_observer(void);
+void DeferredActions_defer_add_batch_w_deleted_entity(void);
+void DeferredActions_defer_add_batch_w_same_entity_ops(void);
+void DeferredActions_defer_add_batch_entity_sequences(void);
+void DeferredActions_defer_remove_batch_entity_sequences(void);
+void DeferredActions_defer_set_batch_not_relocatable(void);
 
 // Testsuite 'SingleThreadStaging'
 void SingleThreadStaging_setup(void);
@@ -2429,6 +2553,9 @@ void MultiThreadStaging_new_w_count(void);
 void MultiThreadStaging_custom_thread_auto_merge(void);
 void MultiThreadStaging_custom_thread_manual_merge(void);
 void MultiThreadStaging_custom_thread_partial_manual_merge(void);
+void MultiThreadStaging_custom_thread_merge_by_entity(void);
+void MultiThreadStaging_custom_thread_merge_by_entity_w_delete(void);
+void MultiThreadStaging_4_threads_merge_by_entity(void);
 
 // Testsuite 'Stresstests'
 void Stresstests_setup(void);
@@ -2521,6 +2648,7 @@ void Internals_recreate_deleted_table(void);
 void Internals_create_65k_tables(void);
 void Internals_no_duplicate_root_table_id(void);
 void Internals_override_os_api_w_addon(void);
+void Internals_delete_table_w_low_edges(void);
 
 // Testsuite 'Error'
 void Error_setup(void);
@@ -3067,6 +3195,89 @@ bake_test_case New_w_Count_testcases[] = {
     }
 };
 
+bake_test_case Bulk_testcases[] = {
+    {
+        "add_id",
+        Bulk_add_id
+    },
+    {
+        "add_id_middle_range",
+        Bulk_add_id_middle_range
+    },
+    {
+        "add_id_range_w_short_tail",
+        Bulk_add_id_range_w_short_tail
+    },
+    {
+        "add_id_reverse_order",
+        Bulk_add_id_reverse_order
+    },
+    {
+        "add_id_multiple_tables",
+        Bulk_add_id_multiple_tables
+    },
+    {
+        "add_id_existing",
+        Bulk_add_id_existing
+    },
+    {
+        "add_id_empty_entities",
+        Bulk_add_id_empty_entities
+    },
+    {
+        "remove_id",
+        Bulk_remove_id
+    },
+    {
+        "remove_last_id",
+        Bulk_remove_last_id
+    },
+    {
+        "remove_id_not_added",
+        Bulk_remove_id_not_added
+    },
+    {
+        "set_id",
+        Bulk_set_id
+    },
+    {
+        "set_id_existing",
+        Bulk_set_id_existing
+    },
+    {
+        "add_id_on_add_trigger",
+        Bulk_add_id_on_add_trigger
+    },
+    {
+        "remove_id_on_remove_trigger",
+        Bulk_remove_id_on_remove_trigger
+    },
+    {
+        "set_id_on_set_trigger",
+        Bulk_set_id_on_set_trigger
+    },
+    {
+        "add_remove_w_lifecycle",
+        Bulk_add_remove_w_lifecycle
+    },
+    {
+        "add_id_w_filter",
+        Bulk_add_id_w_filter
+    },
+    {
+        "remove_id_w_filter",
+        Bulk_remove_id_w_filter
+    },
+    {
+        "add_id_deferred",
+        Bulk_add_id_deferred
+    },
+    {
+        "set_id_deferred",
+        Bulk_set_id_deferred
+    }
+};
+
 bake_test_case Add_testcases[] = {
     {
         "zero",
@@ -6797,6 +7008,22 @@ bake_test_case Sorting_testcases[] = {
     {
         "dont_resort_after_set_unsorted_component_w_tag_w_out_term",
         Sorting_dont_resort_after_set_unsorted_component_w_tag_w_out_term
+    },
+    {
+        "sort_1000_entities_few_out_of_order",
+        Sorting_sort_1000_entities_few_out_of_order
+    },
+    {
+        "sort_2_tables_after_set_in_order",
+        Sorting_sort_2_tables_after_set_in_order
+    },
+    {
+        "sort_after_set_few_rows",
+        Sorting_sort_after_set_few_rows
+    },
+    {
+        "sort_after_set_few_rows_3_tables",
+        Sorting_sort_after_set_few_rows_3_tables
     }
 };
 
@@ -7356,6 +7583,66 @@ bake_test_case Filter_testcases[] = {
     {
         "iter_while_creating_components",
         Filter_iter_while_creating_components
+    },
+    {
+        "filter_cached",
+        Filter_filter_cached
+    },
+    {
+        "filter_cached_after_new_table",
+        Filter_filter_cached_after_new_table
+    },
+    {
+        "filter_cached_after_delete_table",
+        Filter_filter_cached_after_delete_table
+    },
+    {
+        "filter_cached_skip_empty_table",
+        Filter_filter_cached_skip_empty_table
+    },
+    {
+        "filter_cached_w_not",
+        Filter_filter_cached_w_not
+    },
+    {
+        "filter_cached_w_wildcard",
+        Filter_filter_cached_w_wildcard
+    },
+    {
+        "filter_cached_w_superset",
+        Filter_filter_cached_w_superset
+    },
+    {
+        "filter_cached_default_term",
+        Filter_filter_cached_default_term
+    },
+    {
+        "filter_cached_w_superset_after_base_change",
+        Filter_filter_cached_w_superset_after_base_change
+    },
+    {
+        "filter_cached_w_fixed_subject",
+        Filter_filter_cached_w_fixed_subject
+    },
+    {
+        "filter_cached_evict",
+        Filter_filter_cached_evict
+    },
+    {
+        "filter_cached_from_system",
+        Filter_filter_cached_from_system
+    },
+    {
+        "match_empty_tables_w_no_empty_tables",
+        Filter_match_empty_tables_w_no_empty_tables
+    },
+    {
+        "filter_iter_superset_closure_index",
+        Filter_filter_iter_superset_closure_index
+    },
+    {
+        "filter_iter_superset_closure_index_depth",
+        Filter_filter_iter_superset_closure_index_depth
     }
 };
 
@@ -7575,6 +7862,34 @@ bake_test_case Query_testcases[] = {
         "group_by_w_sort_reverse_group_creation",
         Query_group_by_w_sort_reverse_group_creation
     },
+    {
+        "group_by_set_group",
+        Query_group_by_set_group
+    },
+    {
+        "group_by_set_group_not_found",
+        Query_group_by_set_group_not_found
+    },
+    {
+        "group_by_set_group_w_sort",
+        Query_group_by_set_group_w_sort
+    },
+    {
+        "group_by_worker_iter",
+        Query_group_by_worker_iter
+    },
+    {
+        "group_by_worker_iter_more_workers_than_groups",
+        Query_group_by_worker_iter_more_workers_than_groups
+    },
+    {
+        "group_by_get_group_info",
+        Query_group_by_get_group_info
+    },
+    {
+        "group_by_groups",
+        Query_group_by_groups
+    },
     {
         "iter_valid",
         Query_iter_valid
@@ -7650,6 +7965,22 @@ bake_test_case Query_testcases[] = {
     {
         "create_query_while_pending",
         Query_create_query_while_pending
+    },
+    {
+        "query_changed_range_after_set",
+        Query_query_changed_range_after_set
+    },
+    {
+        "query_changed_range_after_new",
+        Query_query_changed_range_after_new
+    },
+    {
+        "query_changed_range_after_out_system",
+        Query_query_changed_range_after_out_system
+    },
+    {
+        "query_changed_range_after_mt_system",
+        Query_query_changed_range_after_mt_system
     }
 };
 
@@ -7745,6 +8076,26 @@ bake_test_case Iter_testcases[] = {
     {
         "iter_lt_cache_size_terms_alloc",
         Iter_iter_lt_cache_size_terms_alloc
+    },
+    {
+        "chunk_iter_1",
+        Iter_chunk_iter_1
+    },
+    {
+        "chunk_iter_2",
+        Iter_chunk_iter_2
+    },
+    {
+        "chunk_iter_w_task_query",
+        Iter_chunk_iter_w_task_query
+    },
+    {
+        "chunk_iter_fini_before_end",
+        Iter_chunk_iter_fini_before_end
+    },
+    {
+        "term_is_aligned",
+        Iter_term_is_aligned
     }
 };
 
@@ -8735,6 +9086,62 @@ bake_test_case Rules_testcases[] = {
     {
         "rule_w_inout_filter",
         Rules_rule_w_inout_filter
+    },
+    {
+        "select_smallest_term_first",
+        Rules_select_smallest_term_first
+    },
+    {
+        "root_var_w_smallest_estimate",
+        Rules_root_var_w_smallest_estimate
+    },
+    {
+        "plan_str",
+        Rules_plan_str
+    },
+    {
+        "rule_cached",
+        Rules_rule_cached
+    },
+    {
+        "rule_cached_w_var",
+        Rules_rule_cached_w_var
+    },
+    {
+        "rule_cached_after_add",
+        Rules_rule_cached_after_add
+    },
+    {
+        "rule_cached_after_remove",
+        Rules_rule_cached_after_remove
+    },
+    {
+        "rule_cached_set_var",
+        Rules_rule_cached_set_var
+    },
+    {
+        "rule_cached_from_system",
+        Rules_rule_cached_from_system
+    },
+    {
+        "rule_worker_iter",
+        Rules_rule_worker_iter
+    },
+    {
+        "rule_worker_iter_w_var",
+        Rules_rule_worker_iter_w_var
+    },
+    {
+        "rule_worker_iter_cached",
+        Rules_rule_worker_iter_cached
+    },
+    {
+        "rule_worker_iter_no_this",
+        Rules_rule_worker_iter_no_this
+    },
+    {
+        "rule_worker_iter_w_set_var",
+        Rules_rule_worker_iter_w_set_var
     }
 };
 
@@ -8834,6 +9241,42 @@ bake_test_case TransitiveRules_testcases[] = {
     {
         "rule_iter_set_transitive_self_2_variables_set_both",
         TransitiveRules_rule_iter_set_transitive_self_2_variables_set_both
+    },
+    {
+        "closure_index_superset",
+        TransitiveRules_closure_index_superset
+    },
+    {
+        "closure_index_subset",
+        TransitiveRules_closure_index_subset
+    },
+    {
+        "closure_index_after_add",
+        TransitiveRules_closure_index_after_add
+    },
+    {
+        "closure_index_after_remove",
+        TransitiveRules_closure_index_after_remove
+    },
+    {
+        "closure_index_deep",
+        TransitiveRules_closure_index_deep
+    },
+    {
+        "closure_index_cycle",
+        TransitiveRules_closure_index_cycle
+    },
+    {
+        "closure_index_cycle_w_depth",
+        TransitiveRules_closure_index_cycle_w_depth
+    },
+    {
+        "closure_index_diamond",
+        TransitiveRules_closure_index_diamond
+    },
+    {
+        "closure_index_after_move",
+        TransitiveRules_closure_index_after_move
     }
 };
 
@@ -10872,6 +11315,50 @@ bake_test_case World_testcases[] = {
     {
         "redefine_component",
         World_redefine_component
+    },
+    {
+        "dim_table",
+        World_dim_table
+    },
+    {
+        "dim_table_lt_count",
+        World_dim_table_lt_count
+    },
+    {
+        "table_chunk_size",
+        World_table_chunk_size
+    },
+    {
+        "table_chunk_size_query",
+        World_table_chunk_size_query
+    },
+    {
+        "table_chunk_size_ref",
+        World_table_chunk_size_ref
+    },
+    {
+        "table_chunk_size_delete",
+        World_table_chunk_size_delete
+    },
+    {
+        "table_chunk_size_bulk_init",
+        World_table_chunk_size_bulk_init
+    },
+    {
+        "table_chunk_size_remove_all",
+        World_table_chunk_size_remove_all
+    },
+    {
+        "table_chunk_size_defer_add",
+        World_table_chunk_size_defer_add
+    },
+    {
+        "table_chunk_size_clone",
+        World_table_chunk_size_clone
+    },
+    {
+        "table_chunk_size_instantiate",
+        World_table_chunk_size_instantiate
     }
 };
 
@@ -10907,6 +11394,22 @@ bake_test_case Stats_testcases[] = {
     {
         "get_pipeline_stats_after_progress_2_systems_one_merge",
         Stats_get_pipeline_stats_after_progress_2_systems_one_merge
+    },
+    {
+        "get_world_info_stack_stats",
+        Stats_get_world_info_stack_stats
+    },
+    {
+        "get_world_info_frame_stack_stats",
+        Stats_get_world_info_frame_stack_stats
+    },
+    {
+        "get_world_info_pool_stats",
+        Stats_get_world_info_pool_stats
+    },
+    {
+        "get_world_stats_table_edges",
+        Stats_get_world_stats_table_edges
     }
 };
 
@@ -11320,6 +11823,54 @@ bake_test_case MultiThread_testcases[] = {
     {
         "2_threads_single_threaded_system",
         MultiThread_2_threads_single_threaded_system
+    },
+    {
+        "2_thread_chunked_100_entity",
+        MultiThread_2_thread_chunked_100_entity
+    },
+    {
+        "6_thread_chunked_100_entity",
+        MultiThread_6_thread_chunked_100_entity
+    },
+    {
+        "6_thread_chunked_1_entity_chunks",
+        MultiThread_6_thread_chunked_1_entity_chunks
+    },
+    {
+        "chunked_table_lt_chunk_size",
+        MultiThread_chunked_table_lt_chunk_size
+    },
+    {
+        "chunked_run_stop_early",
+        MultiThread_chunked_run_stop_early
+    },
+    {
+        "partition_groups",
+        MultiThread_partition_groups
+    },
+    {
+        "concurrent_systems_no_conflict",
+        MultiThread_concurrent_systems_no_conflict
+    },
+    {
+        "concurrent_systems_w_conflict",
+        MultiThread_concurrent_systems_w_conflict
+    },
+    {
+        "concurrent_systems_disabled",
+        MultiThread_concurrent_systems_disabled
+    },
+    {
+        "concurrent_systems_two_pipelines",
+        MultiThread_concurrent_systems_two_pipelines
+    },
+    {
+        "jobs_system_order",
+        MultiThread_jobs_system_order
+    },
+    {
+        "jobs_steal",
+        MultiThread_jobs_steal
     }
 };
 
@@ -11571,6 +12122,74 @@ bake_test_case DeferredActions_testcases[] = {
     {
         "defer_remove_all",
         DeferredActions_defer_remove_all
+    },
+    {
+        "defer_set_large_value",
+        DeferredActions_defer_set_large_value
+    },
+    {
+        "defer_get_mut_many",
+        DeferredActions_defer_get_mut_many
+    },
+    {
+        "defer_set_in_nested_flush",
+        DeferredActions_defer_set_in_nested_flush
+    },
+    {
+        "defer_add_batch_single_move",
+        DeferredActions_defer_add_batch_single_move
+    },
+    {
+        "defer_add_remove_batch_same_entity",
+        DeferredActions_defer_add_remove_batch_same_entity
+    },
+    {
+        "defer_add_batch_interleaved_entities",
+        DeferredActions_defer_add_batch_interleaved_entities
+    },
+    {
+        "defer_bulk_new_batch_trigger",
+        DeferredActions_defer_bulk_new_batch_trigger
+    },
+    {
+        "defer_add_batch_trigger",
+        DeferredActions_defer_add_batch_trigger
+    },
+    {
+        "defer_remove_batch_trigger",
+        DeferredActions_defer_remove_batch_trigger
+    },
+    {
+        "defer_set_batch_trigger",
+        DeferredActions_defer_set_batch_trigger
+    },
+    {
+        "defer_set_batch_w_move",
+        DeferredActions_defer_set_batch_w_move
+    },
+    {
+        "defer_add_batch_observer",
+        DeferredActions_defer_add_batch_observer
+    },
+    {
+        "defer_add_batch_w_deleted_entity",
+        DeferredActions_defer_add_batch_w_deleted_entity
+    },
+    {
+        "defer_add_batch_w_same_entity_ops",
+        DeferredActions_defer_add_batch_w_same_entity_ops
+    },
+    {
+        "defer_add_batch_entity_sequences",
+        DeferredActions_defer_add_batch_entity_sequences
+    },
+    {
+        "defer_remove_batch_entity_sequences",
+        DeferredActions_defer_remove_batch_entity_sequences
+    },
+    {
+        "defer_set_batch_not_relocatable",
+        DeferredActions_defer_set_batch_not_relocatable
     }
 };
 
@@ -11873,6 +12492,18 @@ bake_test_case MultiThreadStaging_testcases[] = {
     {
         "custom_thread_partial_manual_merge",
         MultiThreadStaging_custom_thread_partial_manual_merge
+    },
+    {
+        "custom_thread_merge_by_entity",
+        MultiThreadStaging_custom_thread_merge_by_entity
+    },
+    {
+        "custom_thread_merge_by_entity_w_delete",
+        MultiThreadStaging_custom_thread_merge_by_entity_w_delete
+    },
+    {
+        "4_threads_merge_by_entity",
+        MultiThreadStaging_4_threads_merge_by_entity
     }
 };
 
@@ -12204,6 +12835,10 @@ bake_test_case Internals_testcases[] = {
     {
         "override_os_api_w_addon",
         Internals_override_os_api_w_addon
+    },
+    {
+        "delete_table_w_low_edges",
+        Internals_delete_table_w_low_edges
     }
 };
 
@@ -12344,6 +12979,13 @@ static bake_test_suite suites[] = {
         13,
         New_w_Count_testcases
     },
+    {
+        "Bulk",
+        NULL,
+        NULL,
+        20,
+        Bulk_testcases
+    },
     {
         "Add",
         NULL,
@@ -12502,14 +13144,14 @@ static bake_test_suite suites[] = {
         "Sorting",
         NULL,
         NULL,
-        33,
+        37,
         Sorting_testcases
     },
     {
         "Filter",
         NULL,
         NULL,
-        139,
+        154,
         Filter_testcases
     },
     {
@@ -12523,14 +13165,14 @@ static bake_test_suite suites[] = {
         "Query",
         NULL,
         NULL,
-        65,
+        76,
         Query_testcases
     },
     {
         "Iter",
         NULL,
         NULL,
-        23,
+        28,
         Iter_testcases
     },
     {
@@ -12544,14 +13186,14 @@ static bake_test_suite suites[] = {
         "Rules",
         NULL,
         NULL,
-        153,
+        167,
         Rules_testcases
     },
     {
         "TransitiveRules",
         NULL,
         NULL,
-        24,
+        33,
         TransitiveRules_testcases
     },
     {
@@ -12677,14 +13319,14 @@ static bake_test_suite suites[] = {
         "World",
         World_setup,
         NULL,
-        36,
+        47,
         World_testcases
     },
     {
         "Stats",
         NULL,
         NULL,
-        8,
+        12,
         Stats_testcases
     },
     {
@@ -12705,14 +13347,14 @@ static bake_test_suite suites[] = {
         "MultiThread",
         MultiThread_setup,
         NULL,
-        40,
+        52,
         MultiThread_testcases
     },
     {
         "DeferredActions",
         NULL,
         NULL,
-        62,
+        79,
         DeferredActions_testcases
     },
     {
@@ -12726,7 +13368,7 @@ static bake_test_suite suites[] = {
         "MultiThreadStaging",
         MultiThreadStaging_setup,
         NULL,
-        10,
+        13,
         MultiThreadStaging_testcases
     },
     {
@@ -12761,7 +13403,7 @@ static bake_test_suite suites[] = {
         "Internals",
         Internals_setup,
         NULL,
-        10,
+        11,
         Internals_testcases
     },
     {
@@ -12795,5 +13437,5 @@ static bake_test_suite suites[] = {
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("api", argc, argv, suites, 68);
+    return bake_test_run("api", argc, argv, suites, 69);
 }
@@ -0,0 +1,373 @@
+#include <collections.h>
+#include <flecs/private/allocator.h>
+#include <flecs/private/sparse.h>
+
+void Allocator_setup() {
+    ecs_os_set_api_defaults();
+}
+
+static
+int32_t outstanding(
+    ecs_allocator_t *a)
+{
+    int32_t i, result = 0;
+    for (i = 0; i < ECS_ALLOCATOR_CLASS_COUNT; i ++) {
+        result += a->classes[i].alloc_count;
+    }
+    return result;
+}
+
+void Allocator_balloc_free_reuse() {
+    ecs_block_allocator_t ba;
+    flecs_ballocator_init(&ba, 24);
+    test_int(ba.chunk_size, 32);
+    test_int(ba.block_count, 0);
+
+    void *ptr = flecs_balloc(&ba);
+    test_assert(ptr != NULL);
+    test_int(ba.block_count, 1);
+    test_int(ba.alloc_count, 1);
+
+    flecs_bfree(&ba, ptr);
+    test_int(ba.alloc_count, 0);
+
+    void *ptr2 = flecs_balloc(&ba);
+    test_assert(ptr2 == ptr);
+    test_int(ba.block_count, 1);
+    test_int(ba.alloc_count, 1);
+
+    flecs_bfree(&ba, ptr2);
+    flecs_ballocator_fini(&ba);
+}
+
+void Allocator_balloc_multiple_blocks() {
+    ecs_block_allocator_t ba;
+    flecs_ballocator_init(&ba, 64);
+
+    int32_t i, count = ba.chunks_per_block + 1;
+    test_assert(count > 2);
+
+    void **ptrs = ecs_os_malloc_n(void*, count);
+    for (i = 0; i < count; i ++) {
+        ptrs[i] = flecs_balloc(&ba);
+        test_assert(ptrs[i] != NULL);
+        ecs_os_memset(ptrs[i], i, 64);
+    }
+
+    test_int(ba.block_count, 2);
+    test_int(ba.alloc_count, count);
+
+    /* Chunks must not overlap */
+    for (i = 0; i < count; i ++) {
+        uint8_t *bytes = ptrs[i];
+        test_int(bytes[0], (uint8_t)i);
+        test_int(bytes[63], (uint8_t)i);
+    }
+
+    for (i = 0; i < count; i ++) {
+        flecs_bfree(&ba, ptrs[i]);
+    }
+
+    test_int(ba.block_count, 2);
+    test_int(ba.alloc_count, 0);
+
+    ecs_os_free(ptrs);
+    flecs_ballocator_fini(&ba);
+}
+
+void Allocator_alloc_size_classes() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    void *p1 = flecs_alloc(&a, 10);
+    void *p2 = flecs_alloc(&a, 16);
+    void *p3 = flecs_alloc(&a, 17);
+    test_assert(p1 != p2);
+    test_assert(p2 != p3);
+    test_int(a.classes[0].alloc_count, 2);
+    test_int(a.classes[1].alloc_count, 1);
+    test_int(a.alloc_count, 3);
+
+    flecs_free(&a, 10, p1);
+    flecs_free(&a, 16, p2);
+    flecs_free(&a, 17, p3);
+    test_int(outstanding(&a), 0);
+    test_int(a.alloc_count, 3);
+
+    flecs_allocator_fini(&a);
+    test_int(a.block_count, 0);
+    test_int(a.alloc_count, 0);
+}
+
+void Allocator_alloc_large() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    void *ptr = flecs_alloc(&a, ECS_ALLOCATOR_MAX_SIZE + 1);
+    test_assert(ptr != NULL);
+    test_int(a.block_count, 0);
+    test_int(outstanding(&a), 0);
+    flecs_free(&a, ECS_ALLOCATOR_MAX_SIZE + 1, ptr);
+
+    ptr = flecs_alloc(&a, ECS_ALLOCATOR_MAX_SIZE);
+    test_assert(ptr != NULL);
+    test_int(a.block_count, 1);
+    test_int(outstanding(&a), 1);
+    flecs_free(&a, ECS_ALLOCATOR_MAX_SIZE, ptr);
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_alloc_null_allocator() {
+    int32_t *ptr = flecs_calloc(NULL, 100);
+    test_assert(ptr != NULL);
+    test_int(ptr[0], 0);
+    test_int(ptr[24], 0);
+
+    ptr = flecs_realloc(NULL, 200, 100, ptr);
+    test_assert(ptr != NULL);
+    test_int(ptr[0], 0);
+    flecs_free(NULL, 200, ptr);
+}
+
+void Allocator_calloc() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    uint8_t *ptr = flecs_alloc(&a, 32);
+    ecs_os_memset(ptr, 0xFF, 32);
+    flecs_free(&a, 32, ptr);
+
+    uint8_t *ptr2 = flecs_calloc(&a, 32);
+    test_assert(ptr2 == ptr);
+
+    int i;
+    for (i = 0; i < 32; i ++) {
+        test_int(ptr2[i], 0);
+    }
+
+    flecs_free(&a, 32, ptr2);
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_realloc_same_class() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    void *ptr = flecs_alloc(&a, 65);
+    void *ptr2 = flecs_realloc(&a, 96, 65, ptr);
+    test_assert(ptr2 == ptr);
+    test_int(outstanding(&a), 1);
+
+    flecs_free(&a, 96, ptr2);
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_realloc_other_class() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    int32_t i, *ptr = flecs_alloc(&a, 16 * ECS_SIZEOF(int32_t));
+    for (i = 0; i < 16; i ++) {
+        ptr[i] = i;
+    }
+
+    int32_t *ptr2 = flecs_realloc(
+        &a, 64 * ECS_SIZEOF(int32_t), 16 * ECS_SIZEOF(int32_t), ptr);
+    test_assert(ptr2 != ptr);
+    test_int(outstanding(&a), 1);
+    for (i = 0; i < 16; i ++) {
+        test_int(ptr2[i], i);
+    }
+
+    /* Shrink */
+    int32_t *ptr3 = flecs_realloc(
+        &a, 8 * ECS_SIZEOF(int32_t), 64 * ECS_SIZEOF(int32_t), ptr2);
+    test_assert(ptr3 != ptr2);
+    test_int(outstanding(&a), 1);
+    for (i = 0; i < 8; i ++) {
+        test_int(ptr3[i], i);
+    }
+
+    flecs_free(&a, 8 * ECS_SIZEOF(int32_t), ptr3);
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_vector_add() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    ecs_vector_t *v = NULL;
+    int32_t i;
+    for (i = 0; i < 1000; i ++) {
+        int32_t *elem = flecs_vector_add_t(&a, &v,
+            ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t));
+        *elem = i;
+    }
+
+    test_int(ecs_vector_count(v), 1000);
+    test_int(outstanding(&a), 1);
+
+    int32_t *array = ecs_vector_first(v, int32_t);
+    for (i = 0; i < 1000; i ++) {
+        test_int(array[i], i);
+    }
+
+    flecs_vector_free_t(&a, v, ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t));
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_vector_addn() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    ecs_vector_t *v = NULL;
+    int32_t *elems = flecs_vector_addn_t(&a, &v,
+        ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t), 3);
+    elems[0] = 10; elems[1] = 20; elems[2] = 30;
+
+    elems = flecs_vector_addn_t(&a, &v,
+        ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t), 100);
+    elems[99] = 40;
+
+    test_int(ecs_vector_count(v), 103);
+    int32_t *array = ecs_vector_first(v, int32_t);
+    test_int(array[0], 10);
+    test_int(array[1], 20);
+    test_int(array[2], 30);
+    test_int(array[102], 40);
+    test_int(outstanding(&a), 1);
+
+    flecs_vector_free_t(&a, v, ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t));
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_vector_set_count() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    ecs_vector_t *v = flecs_vector_new_t(&a,
+        ECS_SIZEOF(int64_t), ECS_ALIGNOF(int64_t), 4);
+    test_int(ecs_vector_size(v), 4);
+
+    flecs_vector_set_count_t(&a, &v,
+        ECS_SIZEOF(int64_t), ECS_ALIGNOF(int64_t), 50);
+    test_int(ecs_vector_count(v), 50);
+    test_int(ecs_vector_size(v), 64);
+
+    flecs_vector_set_count_t(&a, &v,
+        ECS_SIZEOF(int64_t), ECS_ALIGNOF(int64_t), 10);
+    test_int(ecs_vector_count(v), 10);
+    test_int(ecs_vector_size(v), 64);
+
+    flecs_vector_set_size_t(&a, &v,
+        ECS_SIZEOF(int64_t), ECS_ALIGNOF(int64_t), 100);
+    test_int(ecs_vector_count(v), 10);
+    test_int(ecs_vector_size(v), 128);
+    test_int(outstanding(&a), 1);
+
+    flecs_vector_free_t(&a, v, ECS_SIZEOF(int64_t), ECS_ALIGNOF(int64_t));
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_vector_copy() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    ecs_vector_t *v = NULL;
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        int32_t *elem = flecs_vector_add_t(&a, &v,
+            ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t));
+        *elem = i;
+    }
+
+    ecs_vector_t *copy = flecs_vector_copy_t(&a, v,
+        ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t));
+    test_assert(copy != v);
+    test_int(ecs_vector_count(copy), 10);
+    test_int(outstanding(&a), 2);
+
+    int32_t *array = ecs_vector_first(copy, int32_t);
+    for (i = 0; i < 10; i ++) {
+        test_int(array[i], i);
+    }
+
+    flecs_vector_free_t(&a, v, ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t));
+    flecs_vector_free_t(&a, copy, ECS_SIZEOF(int32_t), ECS_ALIGNOF(int32_t));
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_map_w_allocator() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    ecs_map_t map;
+    ecs_map_init_w_allocator(&map, int32_t, 0, &a);
+    test_int(outstanding(&a), 1);
+
+    int32_t i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_map_set(&map, i + 1, &i);
+    }
+
+    test_int(ecs_map_count(&map), 1000);
+    test_int(outstanding(&a), 1);
+
+    for (i = 0; i < 1000; i ++) {
+        int32_t *v = ecs_map_get(&map, int32_t, i + 1);
+        test_assert(v != NULL);
+        test_int(*v, i);
+    }
+
+    ecs_map_clear(&map);
+    test_int(ecs_map_count(&map), 0);
+    test_int(outstanding(&a), 1);
+
+    ecs_map_fini(&map);
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
+
+void Allocator_sparse_w_allocator() {
+    ecs_allocator_t a;
+    flecs_allocator_init(&a);
+
+    ecs_sparse_t sp;
+    flecs_sparse_init_w_allocator(&sp, int32_t, &a);
+
+    int32_t i;
+    for (i = 0; i < 5000; i ++) {
+        int32_t *elem = flecs_sparse_add(&sp, int32_t);
+        *elem = i;
+    }
+
+    /* Two chunks, each with a sparse and a data array */
+    test_int(outstanding(&a), 4);
+
+    const uint64_t *ids = flecs_sparse_ids(&sp);
+    for (i = 0; i < 5000; i ++) {
+        int32_t *elem = flecs_sparse_get(&sp, int32_t, ids[i]);
+        test_assert(elem != NULL);
+        test_int(*elem, i);
+    }
+
+    flecs_sparse_fini(&sp);
+    test_int(outstanding(&a), 0);
+
+    flecs_allocator_fini(&a);
+}
@@ -0,0 +1,244 @@
+#include <collections.h>
+
+/* Hash that maps keys to a small number of values, so that keys share hashes */
+static
+uint64_t key_hash(
+    const void *ptr)
+{
+    return *(const uint64_t*)ptr % 4 + 1;
+}
+
+static
+int key_compare(
+    const void *ptr1,
+    const void *ptr2)
+{
+    uint64_t v1 = *(const uint64_t*)ptr1;
+    uint64_t v2 = *(const uint64_t*)ptr2;
+    return (v1 > v2) - (v1 < v2);
+}
+
+static
+void fill_map(
+    ecs_hashmap_t *map,
+    int32_t count)
+{
+    uint64_t i;
+    for (i = 0; i < (uint64_t)count; i ++) {
+        uint64_t value = i * 10;
+        flecs_hashmap_set(map, &i, &value);
+    }
+}
+
+static
+void test_map(
+    ecs_hashmap_t *map,
+    int32_t count)
+{
+    test_int(flecs_hashmap_count(map), count);
+
+    uint64_t i;
+    for (i = 0; i < (uint64_t)count; i ++) {
+        uint64_t *v = flecs_hashmap_get(map, &i, uint64_t);
+        test_assert(v != NULL);
+        test_int(*v, i * 10);
+    }
+}
+
+void Hashmap_setup() {
+    ecs_os_set_api_defaults();
+}
+
+void Hashmap_set_get() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    fill_map(&map, 3);
+    test_map(&map, 3);
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_get_unknown() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    uint64_t key = 1;
+    test_assert(flecs_hashmap_get(&map, &key, uint64_t) == NULL);
+
+    fill_map(&map, 2);
+
+    /* Same hash as existing key */
+    key = 5;
+    test_assert(flecs_hashmap_get(&map, &key, uint64_t) == NULL);
+
+    /* Hash that isn't in the map */
+    key = 3;
+    test_assert(flecs_hashmap_get(&map, &key, uint64_t) == NULL);
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_ensure() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    uint64_t key = 10;
+    flecs_hashmap_result_t r = flecs_hashmap_ensure(&map, &key, uint64_t);
+    test_assert(r.key != NULL);
+    test_assert(r.value != NULL);
+    test_int(*(uint64_t*)r.key, 10);
+    test_int(*(uint64_t*)r.value, 0);
+    test_int(r.hash, key_hash(&key));
+    *(uint64_t*)r.value = 20;
+
+    r = flecs_hashmap_ensure(&map, &key, uint64_t);
+    test_int(*(uint64_t*)r.value, 20);
+    test_int(flecs_hashmap_count(&map), 1);
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_set_overwrite() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    uint64_t key = 1, value = 10;
+    flecs_hashmap_set(&map, &key, &value);
+    value = 20;
+    flecs_hashmap_set(&map, &key, &value);
+
+    test_int(flecs_hashmap_count(&map), 1);
+    test_int(*flecs_hashmap_get(&map, &key, uint64_t), 20);
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_remove() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    fill_map(&map, 16);
+
+    /* Remove keys from the start, middle and end of elements with the same
+     * hash, and keys that are moved when removing other keys */
+    uint64_t remove[] = {0, 8, 12, 1, 15, 6};
+    int32_t i, remove_count = sizeof(remove) / sizeof(uint64_t);
+    for (i = 0; i < remove_count; i ++) {
+        flecs_hashmap_remove(&map, &remove[i], uint64_t);
+        test_assert(flecs_hashmap_get(&map, &remove[i], uint64_t) == NULL);
+    }
+
+    test_int(flecs_hashmap_count(&map), 16 - remove_count);
+
+    uint64_t k;
+    for (k = 0; k < 16; k ++) {
+        uint64_t *v = flecs_hashmap_get(&map, &k, uint64_t);
+        bool removed = false;
+        for (i = 0; i < remove_count; i ++) {
+            removed |= remove[i] == k;
+        }
+
+        if (removed) {
+            test_assert(v == NULL);
+        } else {
+            test_assert(v != NULL);
+            test_int(*v, k * 10);
+        }
+    }
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_remove_unknown() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    fill_map(&map, 3);
+
+    uint64_t key = 7;
+    flecs_hashmap_remove(&map, &key, uint64_t);
+    test_map(&map, 3);
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_remove_all() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    fill_map(&map, 8);
+
+    uint64_t i;
+    for (i = 0; i < 8; i ++) {
+        flecs_hashmap_remove(&map, &i, uint64_t);
+    }
+
+    test_int(flecs_hashmap_count(&map), 0);
+    test_int(flecs_hashmap_get_index(&map, key_hash(&i)), -1);
+
+    fill_map(&map, 8);
+    test_map(&map, 8);
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_iter_hash() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    fill_map(&map, 12);
+
+    /* Keys 1, 5 and 9 have the same hash */
+    uint64_t key = 1;
+    int32_t count = 0, found = 0;
+    int32_t i = flecs_hashmap_get_index(&map, key_hash(&key));
+    for (; i != -1; i = flecs_hashmap_next_index(&map, i)) {
+        uint64_t k = *flecs_hashmap_key_at(&map, uint64_t, i);
+        test_int(*flecs_hashmap_value_at(&map, uint64_t, i), k * 10);
+        test_int(k % 4, 1);
+        found |= 1 << k;
+        count ++;
+    }
+
+    test_int(count, 3);
+    test_int(found, (1 << 1) | (1 << 5) | (1 << 9));
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_iter() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    fill_map(&map, 10);
+
+    int32_t count = 0, found = 0;
+    flecs_hashmap_iter_t it = flecs_hashmap_iter(&map);
+    uint64_t *key, *value;
+    while ((value = flecs_hashmap_next_w_key(&it, uint64_t, &key, uint64_t))) {
+        test_int(*value, *key * 10);
+        found |= 1 << *key;
+        count ++;
+    }
+
+    test_int(count, 10);
+    test_int(found, (1 << 10) - 1);
+
+    flecs_hashmap_fini(&map);
+}
+
+void Hashmap_copy() {
+    ecs_hashmap_t map;
+    flecs_hashmap_init(&map, uint64_t, uint64_t, key_hash, key_compare);
+
+    fill_map(&map, 10);
+
+    ecs_hashmap_t copy;
+    flecs_hashmap_copy(&map, &copy);
+    flecs_hashmap_fini(&map);
+
+    test_map(&copy, 10);
+
+    flecs_hashmap_fini(&copy);
+}
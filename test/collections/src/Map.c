@@ -184,12 +184,22 @@ void Map_iter() {
     ecs_map_t *map = ecs_map_new(char*, 16);
     fill_map(map);
 
+    /* Iteration order is not defined, so test that all keys are returned */
+    bool found[4] = {0};
     ecs_map_iter_t it = ecs_map_iter(map);
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "world");
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "bar");
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "hello");
-    test_str(ecs_map_next_ptr(&it, char*, NULL), "foo");
-    test_assert(ecs_map_next_ptr(&it, char*, NULL) == NULL);
+    ecs_map_key_t key;
+    char *value;
+    while ((value = ecs_map_next_ptr(&it, char*, &key))) {
+        test_assert(key >= 1 && key <= 4);
+        test_assert(!found[key - 1]);
+        test_str(value, elems[key - 1].value);
+        found[key - 1] = true;
+    }
+
+    test_bool(found[0], true);
+    test_bool(found[1], true);
+    test_bool(found[2], true);
+    test_bool(found[3], true);
 
     ecs_map_free(map);
 }
@@ -285,7 +295,7 @@ void Map_grow() {
         ecs_map_set(map, i, &v);
     }
 
-    test_int(malloc_count, 20);
+    test_int(malloc_count, 0);
 
     ecs_map_free(map);
 }
@@ -310,3 +320,105 @@ void Map_ensure() {
 
     ecs_map_free(map);
 }
+
+void Map_remove_while_iter() {
+    ecs_map_t *map = ecs_map_new(int32_t, 0);
+
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        ecs_map_set(map, i, &i);
+    }
+
+    ecs_map_iter_t it = ecs_map_iter(map);
+    ecs_map_key_t key;
+    int32_t *v, count = 0;
+    while ((v = ecs_map_next(&it, int32_t, &key))) {
+        test_int(*v, (int32_t)key);
+        if (key % 2) {
+            ecs_map_remove(map, key);
+        }
+        count ++;
+    }
+
+    test_int(count, 100);
+    test_int(ecs_map_count(map), 50);
+
+    for (i = 0; i < 100; i ++) {
+        if (i % 2) {
+            test_assert(!ecs_map_has(map, i));
+        } else {
+            v = ecs_map_get(map, int32_t, i);
+            test_assert(v != NULL);
+            test_int(*v, i);
+        }
+    }
+
+    ecs_map_free(map);
+}
+
+void Map_remove_reinsert() {
+    ecs_map_t *map = ecs_map_new(int32_t, 16);
+    int32_t bucket_count = ecs_map_bucket_count(map);
+
+    /* Repeatedly removing and adding keys should not grow the map */
+    int32_t i, j;
+    for (i = 0; i < 1000; i ++) {
+        for (j = 0; j < 10; j ++) {
+            int32_t v = i * 10 + j;
+            ecs_map_set(map, v, &v);
+        }
+
+        test_int(ecs_map_count(map), 10);
+
+        for (j = 0; j < 10; j ++) {
+            int32_t v = i * 10 + j;
+            int32_t *ptr = ecs_map_get(map, int32_t, v);
+            test_assert(ptr != NULL);
+            test_int(*ptr, v);
+            ecs_map_remove(map, v);
+        }
+
+        test_int(ecs_map_count(map), 0);
+    }
+
+    test_int(ecs_map_bucket_count(map), bucket_count);
+
+    ecs_map_free(map);
+}
+
+void Map_many_keys() {
+    ecs_map_t *map = ecs_map_new(uint64_t, 0);
+
+    /* Use keys that only differ in the upper bits, like entity ids with a
+     * generation, to test that the key hash uses all bits */
+    uint64_t i;
+    for (i = 0; i < 10000; i ++) {
+        uint64_t key = (i << 32) | 10;
+        ecs_map_set(map, key, &i);
+    }
+
+    test_int(ecs_map_count(map), 10000);
+
+    for (i = 0; i < 10000; i ++) {
+        uint64_t key = (i << 32) | 10;
+        uint64_t *v = ecs_map_get(map, uint64_t, key);
+        test_assert(v != NULL);
+        test_int(*v, i);
+    }
+
+    test_assert(!ecs_map_has(map, 11));
+    test_assert(!ecs_map_has(map, (10000ull << 32) | 10));
+
+    int32_t count = 0;
+    ecs_map_iter_t it = ecs_map_iter(map);
+    ecs_map_key_t key;
+    uint64_t *v;
+    while ((v = ecs_map_next(&it, uint64_t, &key))) {
+        test_int(key, (*v << 32) | 10);
+        count ++;
+    }
+
+    test_int(count, 10000);
+
+    ecs_map_free(map);
+}
@@ -63,6 +63,22 @@ void Map_remove_unknown(void);
 void Map_grow(void);
 void Map_set_size_0(void);
 void Map_ensure(void);
+void Map_remove_while_iter(void);
+void Map_remove_reinsert(void);
+void Map_many_keys(void);
+
+// Testsuite 'Hashmap'
+void Hashmap_setup(void);
+void Hashmap_set_get(void);
+void Hashmap_get_unknown(void);
+void Hashmap_ensure(void);
+void Hashmap_set_overwrite(void);
+void Hashmap_remove(void);
+void Hashmap_remove_unknown(void);
+void Hashmap_remove_all(void);
+void Hashmap_iter_hash(void);
+void Hashmap_iter(void);
+void Hashmap_copy(void);
 
 // Testsuite 'Sparse'
 void Sparse_setup(void);
@@ -116,6 +132,23 @@ void Strbuf_append_inf(void);
 void Strbuf_append_nan_delim(void);
 void Strbuf_append_inf_delim(void);
 
+// Testsuite 'Allocator'
+void Allocator_setup(void);
+void Allocator_balloc_free_reuse(void);
+void Allocator_balloc_multiple_blocks(void);
+void Allocator_alloc_size_classes(void);
+void Allocator_alloc_large(void);
+void Allocator_alloc_null_allocator(void);
+void Allocator_calloc(void);
+void Allocator_realloc_same_class(void);
+void Allocator_realloc_other_class(void);
+void Allocator_vector_add(void);
+void Allocator_vector_addn(void);
+void Allocator_vector_set_count(void);
+void Allocator_vector_copy(void);
+void Allocator_map_w_allocator(void);
+void Allocator_sparse_w_allocator(void);
+
 bake_test_case Vector_testcases[] = {
     {
         "free_empty",
@@ -319,6 +352,61 @@ bake_test_case Map_testcases[] = {
     {
         "ensure",
         Map_ensure
+    },
+    {
+        "remove_while_iter",
+        Map_remove_while_iter
+    },
+    {
+        "remove_reinsert",
+        Map_remove_reinsert
+    },
+    {
+        "many_keys",
+        Map_many_keys
+    }
+};
+
+bake_test_case Hashmap_testcases[] = {
+    {
+        "set_get",
+        Hashmap_set_get
+    },
+    {
+        "get_unknown",
+        Hashmap_get_unknown
+    },
+    {
+        "ensure",
+        Hashmap_ensure
+    },
+    {
+        "set_overwrite",
+        Hashmap_set_overwrite
+    },
+    {
+        "remove",
+        Hashmap_remove
+    },
+    {
+        "remove_unknown",
+        Hashmap_remove_unknown
+    },
+    {
+        "remove_all",
+        Hashmap_remove_all
+    },
+    {
+        "iter_hash",
+        Hashmap_iter_hash
+    },
+    {
+        "iter",
+        Hashmap_iter
+    },
+    {
+        "copy",
+        Hashmap_copy
     }
 };
 
@@ -512,6 +600,65 @@ bake_test_case Strbuf_testcases[] = {
     }
 };
 
+bake_test_case Allocator_testcases[] = {
+    {
+        "balloc_free_reuse",
+        Allocator_balloc_free_reuse
+    },
+    {
+        "balloc_multiple_blocks",
+        Allocator_balloc_multiple_blocks
+    },
+    {
+        "alloc_size_classes",
+        Allocator_alloc_size_classes
+    },
+    {
+        "alloc_large",
+        Allocator_alloc_large
+    },
+    {
+        "alloc_null_allocator",
+        Allocator_alloc_null_allocator
+    },
+    {
+        "calloc",
+        Allocator_calloc
+    },
+    {
+        "realloc_same_class",
+        Allocator_realloc_same_class
+    },
+    {
+        "realloc_other_class",
+        Allocator_realloc_other_class
+    },
+    {
+        "vector_add",
+        Allocator_vector_add
+    },
+    {
+        "vector_addn",
+        Allocator_vector_addn
+    },
+    {
+        "vector_set_count",
+        Allocator_vector_set_count
+    },
+    {
+        "vector_copy",
+        Allocator_vector_copy
+    },
+    {
+        "map_w_allocator",
+        Allocator_map_w_allocator
+    },
+    {
+        "sparse_w_allocator",
+        Allocator_sparse_w_allocator
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "Vector",
@@ -524,9 +671,16 @@ static bake_test_suite suites[] = {
         "Map",
         Map_setup,
         NULL,
-        19,
+        22,
         Map_testcases
     },
+    {
+        "Hashmap",
+        Hashmap_setup,
+        NULL,
+        10,
+        Hashmap_testcases
+    },
     {
         "Sparse",
         Sparse_setup,
@@ -540,9 +694,16 @@ static bake_test_suite suites[] = {
         NULL,
         23,
         Strbuf_testcases
+    },
+    {
+        "Allocator",
+        Allocator_setup,
+        NULL,
+        14,
+        Allocator_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("collections", argc, argv, suites, 4);
+    return bake_test_run("collections", argc, argv, suites, 6);
 }
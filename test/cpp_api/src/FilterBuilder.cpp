@@ -899,6 +899,39 @@ void FilterBuilder_isa_superset_min_depth_2_max_depth_3() {
     test_int(count, 4);
 }
 
+void FilterBuilder_isa_superset_closure_index() {
+    flecs::world ecs;
+
+    test_bool(ecs.enable_closure_index(flecs::IsA), false);
+
+    auto q = ecs.filter_builder<Self, Other>()
+        .arg(2).super().min_depth(2).max_depth(3)
+        .build();
+
+    auto base_1 = ecs.entity().set<Other>({10});
+    auto base_2 = ecs.entity().is_a(base_1);
+    auto base_3 = ecs.entity().is_a(base_2);
+    auto base_4 = ecs.entity().is_a(base_3);
+
+    auto 
+    e = ecs.entity().is_a(base_1); e.set<Self>({0});
+    e = ecs.entity().is_a(base_2); e.set<Self>({e});
+    e = ecs.entity().is_a(base_3); e.set<Self>({e});
+    e = ecs.entity().is_a(base_4); e.set<Self>({0});
+
+    int32_t count = 0;
+
+    q.each([&](flecs::entity e, Self& s, Other& o) {
+        test_assert(e == s.value);
+        test_int(o.value, 10);
+        count ++;
+    });
+    
+    test_int(count, 2);
+
+    test_bool(ecs.enable_closure_index(flecs::IsA, false), true);
+}
+
 void FilterBuilder_relation() {
     flecs::world ecs;
 
@@ -1878,3 +1878,121 @@ void Query_change_tracking() {
     test_int(count, 2);
     test_int(change_count, 1);
 }
+
+void Query_batch() {
+    flecs::world w;
+
+    auto e1 = w.entity().set<Position>({10, 20}).set<Velocity>({1, 2});
+    auto e2 = w.entity().set<Position>({20, 30}).set<Velocity>({3, 4});
+    auto e3 = w.entity().add<Tag>()
+        .set<Position>({30, 40}).set<Velocity>({5, 6});
+
+    auto q = w.query<Position, const Velocity>();
+
+    int32_t invoked = 0, count = 0;
+    q.batch([&](size_t n, Position *p, const Velocity *v) {
+        for (size_t i = 0; i < n; i ++) {
+            p[i].x += v[i].x;
+            p[i].y += v[i].y;
+        }
+        count += static_cast<int32_t>(n);
+        invoked ++;
+    });
+
+    test_int(invoked, 2);
+    test_int(count, 3);
+
+    const Position *ptr = e1.get<Position>();
+    test_int(ptr->x, 11);
+    test_int(ptr->y, 22);
+
+    ptr = e2.get<Position>();
+    test_int(ptr->x, 23);
+    test_int(ptr->y, 34);
+
+    ptr = e3.get<Position>();
+    test_int(ptr->x, 35);
+    test_int(ptr->y, 46);
+}
+
+void Query_batch_shared() {
+    flecs::world w;
+
+    auto base = w.entity().set<Velocity>({1, 2});
+
+    flecs::entity e[600];
+    for (int i = 0; i < 600; i ++) {
+        e[i] = w.entity().set<Position>({static_cast<float>(i), 0}).is_a(base);
+    }
+
+    auto q = w.query_builder<Position, const Velocity>()
+        .arg(2).set(flecs::Self | flecs::SuperSet)
+        .build();
+
+    int32_t invoked = 0, count = 0;
+    q.batch([&](size_t n, Position *p, const Velocity *v) {
+        for (size_t i = 0; i < n; i ++) {
+            p[i].x += v[i].x;
+            p[i].y += v[i].y;
+        }
+        count += static_cast<int32_t>(n);
+        invoked ++;
+    });
+
+    /* Entities are passed in ranges that fit the buffer for shared values */
+    test_assert(invoked > 1);
+    test_assert(invoked < 600);
+    test_int(count, 600);
+
+    for (int i = 0; i < 600; i ++) {
+        const Position *p = e[i].get<Position>();
+        test_int(p->x, i + 1);
+        test_int(p->y, 2);
+    }
+}
+
+void Query_batch_lanes() {
+    flecs::world w;
+
+    const size_t N = flecs::lanes<float>::value;
+    test_int(N, FLECS_BATCH_WIDTH / sizeof(float));
+
+    flecs::entity e[37];
+    for (int i = 0; i < 37; i ++) {
+        e[i] = w.entity().set<Position>({static_cast<float>(i), static_cast<float>(i * 2)}).set<Velocity>({1, 2});
+    }
+
+    auto q = w.query<Position, const Velocity>();
+
+    q.batch([&](size_t count, Position *p, const Velocity *v) {
+        size_t i = 0;
+        for (; i + N <= count; i += N) {
+            float x[N], vx[N];
+            flecs::load_lanes(x, &p[i], &Position::x);
+            flecs::load_lanes(vx, &v[i], &Velocity::x);
+            for (size_t l = 0; l < N; l ++) {
+                x[l] += vx[l];
+            }
+            flecs::store_lanes(&p[i], &Position::x, x);
+        }
+
+        float y[N], vy[N];
+        flecs::load_lanes(y, &p[i], &Position::y, count - i);
+        flecs::load_lanes(vy, &v[i], &Velocity::y, count - i);
+        for (size_t l = 0; l < count - i; l ++) {
+            y[l] += vy[l];
+        }
+        flecs::store_lanes(&p[i], &Position::y, y, count - i);
+    });
+
+    for (int i = 0; i < 37; i ++) {
+        const Position *p = e[i].get<Position>();
+        if (i < 37 - (37 % static_cast<int>(N))) {
+            test_int(p->x, i + 1);
+            test_int(p->y, i * 2);
+        } else {
+            test_int(p->x, i);
+            test_int(p->y, i * 2 + 2);
+        }
+    }
+}
@@ -1790,3 +1790,129 @@ void System_system_w_type_kind_type_pipeline() {
     test_int(s1_count, 1);
     test_int(s2_count, 1);
 }
+
+void System_batch() {
+    flecs::world world;
+
+    auto e1 = world.entity()
+        .set<Position>({10, 20})
+        .set<Velocity>({1, 2});
+
+    auto e2 = world.entity()
+        .set<Position>({30, 40})
+        .set<Velocity>({3, 4});
+
+    int32_t invoked = 0;
+
+    world.system<Position, const Velocity>()
+        .batch([&](size_t count, Position *p, const Velocity *v) {
+            for (size_t i = 0; i < count; i ++) {
+                p[i].x += v[i].x;
+                p[i].y += v[i].y;
+            }
+            invoked ++;
+        });
+
+    world.progress();
+
+    test_int(invoked, 1);
+
+    const Position *p = e1.get<Position>();
+    test_int(p->x, 11);
+    test_int(p->y, 22);
+
+    p = e2.get<Position>();
+    test_int(p->x, 33);
+    test_int(p->y, 44);
+}
+
+void System_batch_shared() {
+    flecs::world world;
+
+    auto base = world.entity()
+        .set<Velocity>({1, 2});
+
+    auto e1 = world.entity()
+        .set<Position>({10, 20})
+        .add(flecs::IsA, base);
+
+    auto e2 = world.entity()
+        .set<Position>({30, 40})
+        .add(flecs::IsA, base);
+
+    auto e3 = world.entity()
+        .set<Position>({50, 60})
+        .set<Velocity>({3, 4});
+
+    int32_t invoked = 0;
+
+    world.system<Position, const Velocity>()
+        .arg(2).set(flecs::Self | flecs::SuperSet)
+        .batch([&](size_t count, Position *p, const Velocity *v) {
+            for (size_t i = 0; i < count; i ++) {
+                p[i].x += v[i].x;
+                p[i].y += v[i].y;
+            }
+            invoked ++;
+        });
+
+    world.progress();
+
+    /* Shared component is passed as array, one call per table */
+    test_int(invoked, 2);
+
+    const Position *p = e1.get<Position>();
+    test_int(p->x, 11);
+    test_int(p->y, 22);
+
+    p = e2.get<Position>();
+    test_int(p->x, 31);
+    test_int(p->y, 42);
+
+    p = e3.get<Position>();
+    test_int(p->x, 53);
+    test_int(p->y, 64);
+}
+
+void System_batch_shared_mutable() {
+    flecs::world world;
+
+    auto base = world.entity()
+        .set<Velocity>({1, 2});
+
+    auto e1 = world.entity()
+        .set<Position>({10, 20})
+        .add(flecs::IsA, base);
+
+    auto e2 = world.entity()
+        .set<Position>({30, 40})
+        .add(flecs::IsA, base);
+
+    int32_t invoked = 0;
+
+    world.system<Position, Velocity>()
+        .arg(2).set(flecs::Self | flecs::SuperSet)
+        .batch([&](size_t count, Position *p, Velocity *v) {
+            test_int(count, 1);
+            p->x += v->x;
+            p->y += v->y;
+            v->x ++;
+            invoked ++;
+        });
+
+    world.progress();
+
+    /* Shared component is not const, one call per entity */
+    test_int(invoked, 2);
+
+    const Position *p = e1.get<Position>();
+    test_int(p->x, 11);
+    test_int(p->y, 22);
+
+    p = e2.get<Position>();
+    test_int(p->x, 32);
+    test_int(p->y, 42);
+
+    const Velocity *v = base.get<Velocity>();
+    test_int(v->x, 3);
+}
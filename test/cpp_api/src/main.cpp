@@ -365,6 +365,9 @@ void System_un_instanced_query_w_base_iter(void);
 void System_create_w_no_template_args(void);
 void System_system_w_type_kind(void);
 void System_system_w_type_kind_type_pipeline(void);
+void System_batch(void);
+void System_batch_shared(void);
+void System_batch_shared_mutable(void);
 
 // Testsuite 'Event'
 void Event_evt_1_id_entity(void);
@@ -463,6 +466,9 @@ void Query_query_each_w_func_no_ptr(void);
 void Query_query_iter_w_func_no_ptr(void);
 void Query_query_each_w_iter(void);
 void Query_change_tracking(void);
+void Query_batch(void);
+void Query_batch_shared(void);
+void Query_batch_lanes(void);
 
 // Testsuite 'QueryBuilder'
 void QueryBuilder_builder_assign_same_type(void);
@@ -562,6 +568,7 @@ void FilterBuilder_isa_superset_max_depth_1(void);
 void FilterBuilder_isa_superset_max_depth_2(void);
 void FilterBuilder_isa_superset_min_depth_2(void);
 void FilterBuilder_isa_superset_min_depth_2_max_depth_3(void);
+void FilterBuilder_isa_superset_closure_index(void);
 void FilterBuilder_relation(void);
 void FilterBuilder_relation_w_object_wildcard(void);
 void FilterBuilder_relation_w_predicate_wildcard(void);
@@ -2282,6 +2289,18 @@ bake_test_case System_testcases[] = {
     {
         "system_w_type_kind_type_pipeline",
         System_system_w_type_kind_type_pipeline
+    },
+    {
+        "batch",
+        System_batch
+    },
+    {
+        "batch_shared",
+        System_batch_shared
+    },
+    {
+        "batch_shared_mutable",
+        System_batch_shared_mutable
     }
 };
 
@@ -2654,6 +2673,18 @@ bake_test_case Query_testcases[] = {
     {
         "change_tracking",
         Query_change_tracking
+    },
+    {
+        "batch",
+        Query_batch
+    },
+    {
+        "batch_shared",
+        Query_batch_shared
+    },
+    {
+        "batch_lanes",
+        Query_batch_lanes
     }
 };
 
@@ -3041,6 +3072,10 @@ bake_test_case FilterBuilder_testcases[] = {
         "isa_superset_min_depth_2_max_depth_3",
         FilterBuilder_isa_superset_min_depth_2_max_depth_3
     },
+    {
+        "isa_superset_closure_index",
+        FilterBuilder_isa_superset_closure_index
+    },
     {
         "relation",
         FilterBuilder_relation
@@ -4316,7 +4351,7 @@ static bake_test_suite suites[] = {
         "System",
         NULL,
         NULL,
-        52,
+        55,
         System_testcases
     },
     {
@@ -4344,7 +4379,7 @@ static bake_test_suite suites[] = {
         "Query",
         NULL,
         NULL,
-        62,
+        65,
         Query_testcases
     },
     {
@@ -4358,7 +4393,7 @@ static bake_test_suite suites[] = {
         "FilterBuilder",
         NULL,
         NULL,
-        69,
+        70,
         FilterBuilder_testcases
     },
     {
@@ -0,0 +1,381 @@
+#include <meta.h>
+
+ECS_STRUCT(Health, {
+    int32_t other;
+    float value;
+});
+
+static
+int32_t range_iter_count(
+    ecs_iter_t *qit,
+    const char *member,
+    double min,
+    double max,
+    int32_t *result_count)
+{
+    int32_t count = 0, results = 0;
+
+    ecs_iter_t it = ecs_range_iter(qit, 1, member, min, max);
+    while (ecs_range_next(&it)) {
+        count += it.count;
+        results ++;
+    }
+
+    if (result_count) {
+        *result_count = results;
+    }
+
+    return count;
+}
+
+void RangeIter_skip_tables() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_query_t *q = ecs_query_new(world, "Health");
+    test_assert(q != NULL);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Health, {0, 10 + i});
+        ecs_add(world, e, TagA);
+    }
+
+    ecs_entity_t b_first = 0;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Health, {0, -5 + i});
+        ecs_add(world, e, TagB);
+        if (!b_first) {
+            b_first = e;
+        }
+    }
+
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Health, {0, 50});
+        ecs_add(world, e, TagC);
+    }
+
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    ecs_iter_t it = ecs_range_iter(&qit, 1, "value", -100, 0);
+    test_bool(ecs_range_next(&it), true);
+    test_int(it.count, 10);
+    test_int(it.entities[0], b_first);
+    test_assert(ecs_has(world, it.entities[0], TagB));
+    
+    Health *h = ecs_term(&it, Health, 1);
+    test_int(h[0].value, -5);
+
+    test_bool(ecs_range_next(&it), false);
+
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", 15, 60, NULL), 20);
+
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", 100, 200, NULL), 0);
+
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", 50, 50, NULL), 10);
+
+    ecs_fini(world);
+}
+
+void RangeIter_skip_blocks() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+
+    ecs_query_t *q = ecs_query_new(world, "Health");
+    test_assert(q != NULL);
+
+    int i;
+    ecs_entity_t entities[1000];
+    for (i = 0; i < 1000; i ++) {
+        entities[i] = ecs_set(world, 0, Health, {0, i});
+    }
+
+    /* Blocks are 256 rows, so only the second block can match */
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    ecs_iter_t it = ecs_range_iter(&qit, 1, "value", 300, 310);
+    test_bool(ecs_range_next(&it), true);
+    test_int(it.count, 256);
+    test_int(it.entities[0], entities[256]);
+
+    Health *h = ecs_term(&it, Health, 1);
+    test_int(h[0].value, 256);
+    test_int(h[255].value, 511);
+
+    test_bool(ecs_range_next(&it), false);
+
+    /* Adjacent blocks are returned as a single result */
+    qit = ecs_query_iter(world, q);
+    int32_t results;
+    test_int(range_iter_count(&qit, "value", 500, 900, &results), 1000 - 256);
+    test_int(results, 1);
+
+    /* Last block is partially filled */
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", 999, 1000, &results), 1000 - 768);
+    test_int(results, 1);
+
+    ecs_fini(world);
+}
+
+void RangeIter_after_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+
+    ecs_query_t *q = ecs_query_new(world, "Health");
+    test_assert(q != NULL);
+
+    int i;
+    ecs_entity_t entities[1000];
+    for (i = 0; i < 1000; i ++) {
+        entities[i] = ecs_set(world, 0, Health, {0, 10});
+    }
+
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", -100, 0, NULL), 0);
+
+    ecs_set(world, entities[600], Health, {0, -10});
+
+    qit = ecs_query_iter(world, q);
+    ecs_iter_t it = ecs_range_iter(&qit, 1, "value", -100, 0);
+    test_bool(ecs_range_next(&it), true);
+    test_int(it.count, 256);
+    test_int(it.entities[0], entities[512]);
+    test_bool(ecs_range_next(&it), false);
+
+    ecs_set(world, entities[600], Health, {0, 10});
+
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", -100, 0, NULL), 0);
+
+    ecs_fini(world);
+}
+
+void RangeIter_after_query_write() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+
+    ecs_query_t *q = ecs_query_new(world, "Health");
+    test_assert(q != NULL);
+
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_set(world, 0, Health, {0, 10});
+    }
+
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", -100, 0, NULL), 0);
+
+    /* Writing to a term that's not readonly marks the rows as changed */
+    qit = ecs_query_iter(world, q);
+    while (ecs_query_next(&qit)) {
+        Health *h = ecs_term(&qit, Health, 1);
+        for (i = 0; i < qit.count; i ++) {
+            h[i].value = -1;
+        }
+    }
+
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", -100, 0, NULL), 1000);
+
+    ecs_fini(world);
+}
+
+void RangeIter_after_delete() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+
+    ecs_query_t *q = ecs_query_new(world, "Health");
+    test_assert(q != NULL);
+
+    int i;
+    ecs_entity_t entities[300];
+    for (i = 0; i < 300; i ++) {
+        entities[i] = ecs_set(world, 0, Health, {0, i < 299 ? 10 : -10});
+    }
+
+    /* Only the last block has the negative value */
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", -100, 0, NULL), 300 - 256);
+
+    /* Deleting moves the last entity into the first block */
+    ecs_delete(world, entities[0]);
+
+    ecs_iter_t it;
+    qit = ecs_query_iter(world, q);
+    it = ecs_range_iter(&qit, 1, "value", -100, 0);
+    test_bool(ecs_range_next(&it), true);
+    test_int(it.count, 256);
+    test_int(it.entities[0], entities[299]);
+    test_bool(ecs_range_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void RangeIter_primitive_component() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_TAG(world, TagA);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{ ecs_id(ecs_i32_t) }}
+    });
+    test_assert(q != NULL);
+
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set_id(world, 0, ecs_id(ecs_i32_t), 
+            sizeof(int32_t), &i);
+        if (i >= 5) {
+            ecs_add(world, e, TagA);
+        }
+    }
+
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    ecs_iter_t it = ecs_range_iter(&qit, 1, NULL, 7, 8);
+    test_bool(ecs_range_next(&it), true);
+    test_int(it.count, 5);
+    test_assert(ecs_has(world, it.entities[0], TagA));
+    test_bool(ecs_range_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void RangeIter_unknown_member() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+
+    ecs_query_t *q = ecs_query_new(world, "Health");
+    test_assert(q != NULL);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Health, {0, 10});
+    }
+
+    /* Results are not skipped if the member can't be tested */
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "foo", -100, 0, NULL), 10);
+
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, NULL, -100, 0, NULL), 10);
+
+    ecs_fini(world);
+}
+
+void RangeIter_nan() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+
+    ecs_query_t *q = ecs_query_new(world, "Health");
+    test_assert(q != NULL);
+
+    float nan = 0.0f;
+    nan = nan / nan;
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Health, {0, i ? 10 : nan});
+    }
+
+    /* NaN does not prevent min/max from being computed */
+    ecs_iter_t qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", -100, 0, NULL), 0);
+
+    qit = ecs_query_iter(world, q);
+    test_int(range_iter_count(&qit, "value", 10, 10, NULL), 10);
+
+    ecs_fini(world);
+}
+
+void RangeIter_filter() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+    ECS_TAG(world, TagA);
+
+    ecs_filter_t f;
+    test_int(ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {{ ecs_id(Health) }}
+    }), 0);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Health, {0, i});
+        if (i >= 5) {
+            ecs_add(world, e, TagA);
+        }
+    }
+
+    ecs_iter_t fit = ecs_filter_iter(world, &f);
+    ecs_iter_t it = ecs_range_iter(&fit, 1, "value", 0, 2);
+    test_bool(ecs_range_next(&it), true);
+    test_int(it.count, 5);
+    test_assert(!ecs_has(world, it.entities[0], TagA));
+    test_bool(ecs_range_next(&it), false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
+
+void RangeIter_fini_before_end() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Health);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+    ECS_TAG(world, TagD);
+    ECS_TAG(world, TagE);
+
+    /* More terms than fit in the iterator cache, so that the range iterator
+     * allocates storage for the term data */
+    ecs_filter_t f;
+    test_int(ecs_filter_init(world, &f, &(ecs_filter_desc_t) {
+        .terms = {
+            { ecs_id(Health) }, { TagA }, { TagB }, { TagC }, { TagD }
+        }
+    }), 0);
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Health, {0, i});
+        ecs_add(world, e, TagA);
+        ecs_add(world, e, TagB);
+        ecs_add(world, e, TagC);
+        ecs_add(world, e, TagD);
+        if (i >= 5) {
+            ecs_add(world, e, TagE);
+        }
+    }
+
+    ecs_iter_t fit = ecs_filter_iter(world, &f);
+    ecs_iter_t it = ecs_range_iter(&fit, 1, "value", 0, 10);
+    test_bool(ecs_range_next(&it), true);
+    test_int(it.count, 5);
+    test_assert(it.priv.iter.range.ptrs != NULL);
+
+    Health *h = ecs_term(&it, Health, 1);
+    test_assert(h != NULL);
+    test_int(h[0].value, 0);
+
+    ecs_iter_fini(&it);
+    test_assert(it.priv.iter.range.ptrs == NULL);
+    test_bool(fit.is_valid, false);
+
+    ecs_filter_fini(&f);
+
+    ecs_fini(world);
+}
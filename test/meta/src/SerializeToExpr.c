@@ -636,7 +636,7 @@ void SerializeToExpr_bitmask() {
     uint32_t value = Lettuce | Bacon;
     char *expr = ecs_ptr_to_expr(world, t, &value);
     test_assert(expr != NULL);
-    test_str(expr, "Bacon|Lettuce");
+    test_str(expr, "Lettuce|Bacon");
     ecs_os_free(expr);
     }
 
@@ -644,7 +644,7 @@ void SerializeToExpr_bitmask() {
     uint32_t value = Lettuce | Bacon | Tomato | Cheese;
     char *expr = ecs_ptr_to_expr(world, t, &value);
     test_assert(expr != NULL);
-    test_str(expr, "Bacon|Tomato|Lettuce|Cheese");
+    test_str(expr, "Lettuce|Bacon|Tomato|Cheese");
     ecs_os_free(expr);
     }
 
@@ -658,6 +658,36 @@ void SerializeToExpr_bitmask() {
     ecs_fini(world);
 }
 
+void SerializeToExpr_bitmask_value_order() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_entity_t t = ecs_bitmask_init(world, &(ecs_bitmask_desc_t) {
+        .constants = {
+            {"D", 0x1 << 20}, {"C", 0x1 << 12}, {"B", 0x1 << 3}, {"A", 0x1}
+        }
+    });
+
+    test_assert(t != 0);
+
+    {
+    uint32_t value = (0x1 << 20) | 0x1;
+    char *expr = ecs_ptr_to_expr(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "A|D");
+    ecs_os_free(expr);
+    }
+
+    {
+    uint32_t value = (0x1 << 20) | (0x1 << 12) | (0x1 << 3) | 0x1;
+    char *expr = ecs_ptr_to_expr(world, t, &value);
+    test_assert(expr != NULL);
+    test_str(expr, "A|B|C|D");
+    ecs_os_free(expr);
+    }
+
+    ecs_fini(world);
+}
+
 void SerializeToExpr_struct_enum() {
     typedef enum {
         Red, Blue, Green
@@ -777,7 +807,7 @@ void SerializeToExpr_struct_bitmask() {
     T value = {Lettuce | Bacon};
     char *expr = ecs_ptr_to_expr(world, t, &value);
     test_assert(expr != NULL);
-    test_str(expr, "{x: Bacon|Lettuce}");
+    test_str(expr, "{x: Lettuce|Bacon}");
     ecs_os_free(expr);
     }
 
@@ -785,7 +815,7 @@ void SerializeToExpr_struct_bitmask() {
     T value = {Lettuce | Bacon | Tomato | Cheese};
     char *expr = ecs_ptr_to_expr(world, t, &value);
     test_assert(expr != NULL);
-    test_str(expr, "{x: Bacon|Tomato|Lettuce|Cheese}");
+    test_str(expr, "{x: Lettuce|Bacon|Tomato|Cheese}");
     ecs_os_free(expr);
     }
 
@@ -680,7 +680,7 @@ void SerializeToJson_struct_bitmask() {
     T value = {Lettuce | Bacon};
     char *expr = ecs_ptr_to_json(world, t, &value);
     test_assert(expr != NULL);
-    test_str(expr, "{\"x\":\"Bacon|Lettuce\"}");
+    test_str(expr, "{\"x\":\"Lettuce|Bacon\"}");
     ecs_os_free(expr);
     }
 
@@ -688,7 +688,7 @@ void SerializeToJson_struct_bitmask() {
     T value = {Lettuce | Bacon | Tomato | Cheese};
     char *expr = ecs_ptr_to_json(world, t, &value);
     test_assert(expr != NULL);
-    test_str(expr, "{\"x\":\"Bacon|Tomato|Lettuce|Cheese\"}");
+    test_str(expr, "{\"x\":\"Lettuce|Bacon|Tomato|Cheese\"}");
     ecs_os_free(expr);
     }
 
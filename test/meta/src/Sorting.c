@@ -0,0 +1,213 @@
+#include <meta.h>
+#include <stdlib.h>
+#include <float.h>
+
+ECS_STRUCT(Depth, {
+    float value;
+    float other;
+});
+
+ECS_STRUCT(Priority, {
+    int64_t value;
+});
+
+ECS_STRUCT(Label, {
+    char *value;
+});
+
+void Sorting_sort_by_i32() {
+    ecs_world_t *world = ecs_init();
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{ ecs_id(ecs_i32_t) }},
+        .order_by_component = ecs_id(ecs_i32_t),
+        .order_by = ecs_meta_order_by(world, ecs_id(ecs_i32_t))
+    });
+    test_assert(q != NULL);
+
+    for (int i = 0; i < 1000; i ++) {
+        int32_t v = rand() - RAND_MAX / 2;
+        ecs_set_id(world, 0, ecs_id(ecs_i32_t), sizeof(int32_t), &v);
+    }
+
+    int32_t count = 0, v = INT32_MIN;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        ecs_i32_t *ptr = ecs_term(&it, ecs_i32_t, 1);
+
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            test_assert(v <= ptr[i]);
+            v = ptr[i];
+            test_assert(ecs_get_id(world, it.entities[i], 
+                ecs_id(ecs_i32_t)) == &ptr[i]);
+        }
+
+        count += it.count;
+    }
+
+    test_int(count, 1000);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_struct_f32() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Depth);
+    ECS_TAG(world, Tag);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{ ecs_id(Depth) }},
+        .order_by_component = ecs_id(Depth),
+        .order_by = ecs_meta_order_by(world, ecs_id(Depth))
+    });
+    test_assert(q != NULL);
+
+    for (int i = 0; i < 1000; i ++) {
+        float v = (float)(rand() - RAND_MAX / 2) / 1000.0f;
+        ecs_entity_t e = ecs_set(world, 0, Depth, {v, (float)i});
+        if (i % 3) {
+            ecs_add(world, e, Tag);
+        }
+    }
+
+    int32_t count = 0;
+    float v = -FLT_MAX;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    while (ecs_query_next(&it)) {
+        Depth *ptr = ecs_term(&it, Depth, 1);
+
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            test_assert(v <= ptr[i].value);
+            v = ptr[i].value;
+        }
+
+        count += it.count;
+    }
+
+    test_int(count, 1000);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_struct_i64_few_entities() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Priority);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{ ecs_id(Priority) }},
+        .order_by_component = ecs_id(Priority),
+        .order_by = ecs_meta_order_by(world, ecs_id(Priority))
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Priority, {30});
+    ecs_entity_t e2 = ecs_set(world, 0, Priority, {-20});
+    ecs_entity_t e3 = ecs_set(world, 0, Priority, {INT64_MAX});
+    ecs_entity_t e4 = ecs_set(world, 0, Priority, {INT64_MIN});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 4);
+    test_int(it.entities[0], e4);
+    test_int(it.entities[1], e2);
+    test_int(it.entities[2], e1);
+    test_int(it.entities[3], e3);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_struct_resort_after_set() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Priority);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{ ecs_id(Priority) }},
+        .order_by_component = ecs_id(Priority),
+        .order_by = ecs_meta_order_by(world, ecs_id(Priority))
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e[100];
+    for (int i = 0; i < 100; i ++) {
+        e[i] = ecs_set(world, 0, Priority, {100 - i});
+    }
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 100);
+    test_int(it.entities[0], e[99]);
+    test_int(it.entities[99], e[0]);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_set(world, e[0], Priority, {0});
+
+    it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 100);
+    test_int(it.entities[0], e[0]);
+    test_int(it.entities[1], e[99]);
+    test_int(it.entities[99], e[1]);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_non_primitive_struct() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Label);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{ ecs_id(Label) }},
+        .order_by_component = ecs_id(Label)
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Label, {NULL});
+    ecs_entity_t e2 = ecs_set(world, 0, Label, {NULL});
+
+    /* Component can't be ordered by value, results are not sorted */
+    test_assert(ecs_meta_order_by(world, ecs_id(Label)) == NULL);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 2);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e2);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_primitive_no_callback() {
+    ecs_world_t *world = ecs_init();
+
+    ECS_META_COMPONENT(world, Priority);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t) {
+        .filter.terms = {{ ecs_id(Priority) }},
+        .order_by_component = ecs_id(Priority)
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Priority, {30});
+    ecs_entity_t e2 = ecs_set(world, 0, Priority, {-20});
+    ecs_entity_t e3 = ecs_set(world, 0, Priority, {10});
+
+    /* Without callback results are not sorted */
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(ecs_query_next(&it), true);
+    test_int(it.count, 3);
+    test_int(it.entities[0], e1);
+    test_int(it.entities[1], e2);
+    test_int(it.entities[2], e3);
+    test_bool(ecs_query_next(&it), false);
+
+    ecs_fini(world);
+}
@@ -362,6 +362,7 @@ void SerializeToExpr_string(void);
 void SerializeToExpr_entity(void);
 void SerializeToExpr_enum(void);
 void SerializeToExpr_bitmask(void);
+void SerializeToExpr_bitmask_value_order(void);
 void SerializeToExpr_float_nan(void);
 void SerializeToExpr_float_inf(void);
 void SerializeToExpr_double_nan(void);
@@ -559,6 +560,26 @@ void MetaUtils_struct_w_nested(void);
 void MetaUtils_enum_nospace(void);
 void MetaUtils_struct_nospace(void);
 
+// Testsuite 'Sorting'
+void Sorting_sort_by_i32(void);
+void Sorting_sort_by_struct_f32(void);
+void Sorting_sort_by_struct_i64_few_entities(void);
+void Sorting_sort_by_struct_resort_after_set(void);
+void Sorting_sort_by_non_primitive_struct(void);
+void Sorting_sort_by_primitive_no_callback(void);
+
+// Testsuite 'RangeIter'
+void RangeIter_skip_tables(void);
+void RangeIter_skip_blocks(void);
+void RangeIter_after_set(void);
+void RangeIter_after_query_write(void);
+void RangeIter_after_delete(void);
+void RangeIter_primitive_component(void);
+void RangeIter_unknown_member(void);
+void RangeIter_nan(void);
+void RangeIter_filter(void);
+void RangeIter_fini_before_end(void);
+
 bake_test_case PrimitiveTypes_testcases[] = {
     {
         "bool",
@@ -1917,6 +1938,10 @@ bake_test_case SerializeToExpr_testcases[] = {
         "bitmask",
         SerializeToExpr_bitmask
     },
+    {
+        "bitmask_value_order",
+        SerializeToExpr_bitmask_value_order
+    },
     {
         "float_nan",
         SerializeToExpr_float_nan
@@ -2683,6 +2708,76 @@ bake_test_case MetaUtils_testcases[] = {
     }
 };
 
+bake_test_case Sorting_testcases[] = {
+    {
+        "sort_by_i32",
+        Sorting_sort_by_i32
+    },
+    {
+        "sort_by_struct_f32",
+        Sorting_sort_by_struct_f32
+    },
+    {
+        "sort_by_struct_i64_few_entities",
+        Sorting_sort_by_struct_i64_few_entities
+    },
+    {
+        "sort_by_struct_resort_after_set",
+        Sorting_sort_by_struct_resort_after_set
+    },
+    {
+        "sort_by_non_primitive_struct",
+        Sorting_sort_by_non_primitive_struct
+    },
+    {
+        "sort_by_primitive_no_callback",
+        Sorting_sort_by_primitive_no_callback
+    }
+};
+
+bake_test_case RangeIter_testcases[] = {
+    {
+        "skip_tables",
+        RangeIter_skip_tables
+    },
+    {
+        "skip_blocks",
+        RangeIter_skip_blocks
+    },
+    {
+        "after_set",
+        RangeIter_after_set
+    },
+    {
+        "after_query_write",
+        RangeIter_after_query_write
+    },
+    {
+        "after_delete",
+        RangeIter_after_delete
+    },
+    {
+        "primitive_component",
+        RangeIter_primitive_component
+    },
+    {
+        "unknown_member",
+        RangeIter_unknown_member
+    },
+    {
+        "nan",
+        RangeIter_nan
+    },
+    {
+        "filter",
+        RangeIter_filter
+    },
+    {
+        "fini_before_end",
+        RangeIter_fini_before_end
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "PrimitiveTypes",
@@ -2765,7 +2860,7 @@ static bake_test_suite suites[] = {
         "SerializeToExpr",
         NULL,
         NULL,
-        44,
+        45,
         SerializeToExpr_testcases
     },
     {
@@ -2795,9 +2890,23 @@ static bake_test_suite suites[] = {
         NULL,
         15,
         MetaUtils_testcases
+    },
+    {
+        "Sorting",
+        NULL,
+        NULL,
+        6,
+        Sorting_testcases
+    },
+    {
+        "RangeIter",
+        NULL,
+        NULL,
+        10,
+        RangeIter_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("meta", argc, argv, suites, 16);
+    return bake_test_run("meta", argc, argv, suites, 18);
 }